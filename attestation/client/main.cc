@@ -17,12 +17,19 @@
 #include <stdio.h>
 #include <sysexits.h>
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <base/command_line.h>
 #include <base/files/file_util.h>
+#include <base/json/json_writer.h>
 #include <base/message_loop/message_loop.h>
+#include <base/strings/string_number_conversions.h>
+#include <base/strings/string_split.h>
+#include <base/time/time.h>
+#include <base/values.h>
 #include <brillo/bind_lambda.h>
 #include <brillo/daemons/daemon.h>
 #include <brillo/syslog_logging.h>
@@ -47,8 +54,17 @@ const char kDecryptCommand[] = "decrypt";
 const char kSignCommand[] = "sign";
 const char kVerifyCommand[] = "verify";
 const char kRegisterCommand[] = "register";
+const char kBatchSwitch[] = "batch";
+const char kInFlightSwitch[] = "in_flight";
 const char kUsage[] = R"(
 Usage: attestation_client <command> [<args>]
+       attestation_client --batch[=<command_file>] [--in_flight=<count>]
+Batch mode:
+  Reads one command with its arguments per line from |command_file|, or from
+  stdin if no file is given, and sends up to |count| (default 1) at a time.
+  Arguments may not contain whitespace. Empty lines and lines starting with '#'
+  are ignored. Each result is printed as a JSON line with the command, its
+  exit code, latency and either the reply or an error.
 Commands:
   create_and_certify [--user=<email>] [--label=<keylabel>]
       Creates a key and requests certification by the Google Attestation CA.
@@ -107,7 +123,16 @@ class ClientLoop : public ClientLoopBase {
     if (!attestation_->Initialize()) {
       return EX_UNAVAILABLE;
     }
-    exit_code = ScheduleCommand();
+    base::CommandLine* command_line = base::CommandLine::ForCurrentProcess();
+    if (command_line->HasSwitch(kBatchSwitch)) {
+      exit_code = ScheduleBatch(*command_line);
+    } else {
+      std::string error;
+      exit_code = ScheduleCommand(*command_line, 0, &error);
+      if (exit_code != EX_OK) {
+        LOG(ERROR) << error;
+      }
+    }
     if (exit_code == EX_USAGE) {
       printf("%s", kUsage);
     }
@@ -120,158 +145,294 @@ class ClientLoop : public ClientLoopBase {
   }
 
  private:
-  // Posts tasks according to the command line options.
-  int ScheduleCommand() {
+  // Posts a task to run the command given by |command_line|. The command is
+  // identified by |command_id| when it finishes. On failure, returns the exit
+  // code and sets |error| to the cause.
+  int ScheduleCommand(const base::CommandLine& command_line,
+                      int command_id,
+                      std::string* error) {
     base::Closure task;
-    base::CommandLine* command_line = base::CommandLine::ForCurrentProcess();
-    const auto& args = command_line->GetArgs();
-    if (command_line->HasSwitch("help") || command_line->HasSwitch("h") ||
+    const auto& args = command_line.GetArgs();
+    if (command_line.HasSwitch("help") || command_line.HasSwitch("h") ||
         (!args.empty() && args.front() == "help")) {
+      *error = "Help requested.";
       return EX_USAGE;
     }
     if (args.empty() || args.front() == kCreateAndCertifyCommand) {
       task = base::Bind(&ClientLoop::CallCreateGoogleAttestedKey,
-                        weak_factory_.GetWeakPtr(),
-                        command_line->GetSwitchValueASCII("label"),
-                        command_line->GetSwitchValueASCII("user"));
+                        weak_factory_.GetWeakPtr(), command_id,
+                        command_line.GetSwitchValueASCII("label"),
+                        command_line.GetSwitchValueASCII("user"));
     } else if (args.front() == kCreateCommand) {
-      std::string usage_str = command_line->GetSwitchValueASCII("usage");
+      std::string usage_str = command_line.GetSwitchValueASCII("usage");
       KeyUsage usage;
       if (usage_str.empty() || usage_str == "sign") {
         usage = KEY_USAGE_SIGN;
       } else if (usage_str == "decrypt") {
         usage = KEY_USAGE_DECRYPT;
       } else {
+        *error = "Unknown key usage: " + usage_str;
         return EX_USAGE;
       }
       task = base::Bind(&ClientLoop::CallCreateCertifiableKey,
-                        weak_factory_.GetWeakPtr(),
-                        command_line->GetSwitchValueASCII("label"),
-                        command_line->GetSwitchValueASCII("user"), usage);
+                        weak_factory_.GetWeakPtr(), command_id,
+                        command_line.GetSwitchValueASCII("label"),
+                        command_line.GetSwitchValueASCII("user"), usage);
     } else if (args.front() == kInfoCommand) {
       task = base::Bind(&ClientLoop::CallGetKeyInfo, weak_factory_.GetWeakPtr(),
-                        command_line->GetSwitchValueASCII("label"),
-                        command_line->GetSwitchValueASCII("user"));
+                        command_id, command_line.GetSwitchValueASCII("label"),
+                        command_line.GetSwitchValueASCII("user"));
     } else if (args.front() == kEndorsementCommand) {
       task = base::Bind(&ClientLoop::CallGetEndorsementInfo,
-                        weak_factory_.GetWeakPtr());
+                        weak_factory_.GetWeakPtr(), command_id);
     } else if (args.front() == kAttestationKeyCommand) {
       task = base::Bind(&ClientLoop::CallGetAttestationKeyInfo,
-                        weak_factory_.GetWeakPtr());
+                        weak_factory_.GetWeakPtr(), command_id);
     } else if (args.front() == kActivateCommand) {
-      if (!command_line->HasSwitch("input")) {
+      if (!command_line.HasSwitch("input")) {
+        *error = args.front() + " requires --input.";
         return EX_USAGE;
       }
       std::string input;
-      base::FilePath filename(command_line->GetSwitchValueASCII("input"));
+      base::FilePath filename(command_line.GetSwitchValueASCII("input"));
       if (!base::ReadFileToString(filename, &input)) {
-        LOG(ERROR) << "Failed to read file: " << filename.value();
+        *error = "Failed to read file: " + filename.value();
         return EX_NOINPUT;
       }
       task = base::Bind(&ClientLoop::CallActivateAttestationKey,
-                        weak_factory_.GetWeakPtr(), input);
+                        weak_factory_.GetWeakPtr(), command_id, input);
     } else if (args.front() == kEncryptForActivateCommand) {
-      if (!command_line->HasSwitch("input") ||
-          !command_line->HasSwitch("output")) {
+      if (!command_line.HasSwitch("input") ||
+          !command_line.HasSwitch("output")) {
+        *error = args.front() + " requires --input and --output.";
         return EX_USAGE;
       }
       std::string input;
-      base::FilePath filename(command_line->GetSwitchValueASCII("input"));
+      base::FilePath filename(command_line.GetSwitchValueASCII("input"));
       if (!base::ReadFileToString(filename, &input)) {
-        LOG(ERROR) << "Failed to read file: " << filename.value();
+        *error = "Failed to read file: " + filename.value();
         return EX_NOINPUT;
       }
       task = base::Bind(&ClientLoop::EncryptForActivate,
-                        weak_factory_.GetWeakPtr(), input);
+                        weak_factory_.GetWeakPtr(), command_id, input,
+                        command_line.GetSwitchValueASCII("output"));
     } else if (args.front() == kEncryptCommand) {
-      if (!command_line->HasSwitch("input") ||
-          !command_line->HasSwitch("output")) {
+      if (!command_line.HasSwitch("input") ||
+          !command_line.HasSwitch("output")) {
+        *error = args.front() + " requires --input and --output.";
         return EX_USAGE;
       }
       std::string input;
-      base::FilePath filename(command_line->GetSwitchValueASCII("input"));
+      base::FilePath filename(command_line.GetSwitchValueASCII("input"));
       if (!base::ReadFileToString(filename, &input)) {
-        LOG(ERROR) << "Failed to read file: " << filename.value();
+        *error = "Failed to read file: " + filename.value();
         return EX_NOINPUT;
       }
       task = base::Bind(&ClientLoop::Encrypt, weak_factory_.GetWeakPtr(),
-                        command_line->GetSwitchValueASCII("label"),
-                        command_line->GetSwitchValueASCII("user"), input);
+                        command_id, command_line.GetSwitchValueASCII("label"),
+                        command_line.GetSwitchValueASCII("user"), input,
+                        command_line.GetSwitchValueASCII("output"));
     } else if (args.front() == kDecryptCommand) {
-      if (!command_line->HasSwitch("input")) {
+      if (!command_line.HasSwitch("input")) {
+        *error = args.front() + " requires --input.";
         return EX_USAGE;
       }
       std::string input;
-      base::FilePath filename(command_line->GetSwitchValueASCII("input"));
+      base::FilePath filename(command_line.GetSwitchValueASCII("input"));
       if (!base::ReadFileToString(filename, &input)) {
-        LOG(ERROR) << "Failed to read file: " << filename.value();
+        *error = "Failed to read file: " + filename.value();
         return EX_NOINPUT;
       }
       task = base::Bind(&ClientLoop::CallDecrypt, weak_factory_.GetWeakPtr(),
-                        command_line->GetSwitchValueASCII("label"),
-                        command_line->GetSwitchValueASCII("user"), input);
+                        command_id, command_line.GetSwitchValueASCII("label"),
+                        command_line.GetSwitchValueASCII("user"), input);
     } else if (args.front() == kSignCommand) {
-      if (!command_line->HasSwitch("input")) {
+      if (!command_line.HasSwitch("input")) {
+        *error = args.front() + " requires --input.";
         return EX_USAGE;
       }
       std::string input;
-      base::FilePath filename(command_line->GetSwitchValueASCII("input"));
+      base::FilePath filename(command_line.GetSwitchValueASCII("input"));
       if (!base::ReadFileToString(filename, &input)) {
-        LOG(ERROR) << "Failed to read file: " << filename.value();
+        *error = "Failed to read file: " + filename.value();
         return EX_NOINPUT;
       }
       task = base::Bind(&ClientLoop::CallSign, weak_factory_.GetWeakPtr(),
-                        command_line->GetSwitchValueASCII("label"),
-                        command_line->GetSwitchValueASCII("user"), input);
+                        command_id, command_line.GetSwitchValueASCII("label"),
+                        command_line.GetSwitchValueASCII("user"), input,
+                        command_line.GetSwitchValueASCII("output"));
     } else if (args.front() == kVerifyCommand) {
-      if (!command_line->HasSwitch("input") ||
-          !command_line->HasSwitch("signature")) {
+      if (!command_line.HasSwitch("input") ||
+          !command_line.HasSwitch("signature")) {
+        *error = args.front() + " requires --input and --signature.";
         return EX_USAGE;
       }
       std::string input;
-      base::FilePath filename(command_line->GetSwitchValueASCII("input"));
+      base::FilePath filename(command_line.GetSwitchValueASCII("input"));
       if (!base::ReadFileToString(filename, &input)) {
-        LOG(ERROR) << "Failed to read file: " << filename.value();
+        *error = "Failed to read file: " + filename.value();
         return EX_NOINPUT;
       }
       std::string signature;
-      base::FilePath filename2(command_line->GetSwitchValueASCII("signature"));
+      base::FilePath filename2(command_line.GetSwitchValueASCII("signature"));
       if (!base::ReadFileToString(filename2, &signature)) {
-        LOG(ERROR) << "Failed to read file: " << filename2.value();
+        *error = "Failed to read file: " + filename2.value();
         return EX_NOINPUT;
       }
-      task = base::Bind(
-          &ClientLoop::VerifySignature, weak_factory_.GetWeakPtr(),
-          command_line->GetSwitchValueASCII("label"),
-          command_line->GetSwitchValueASCII("user"), input, signature);
+      task = base::Bind(&ClientLoop::VerifySignature,
+                        weak_factory_.GetWeakPtr(), command_id,
+                        command_line.GetSwitchValueASCII("label"),
+                        command_line.GetSwitchValueASCII("user"), input,
+                        signature);
     } else if (args.front() == kRegisterCommand) {
       task = base::Bind(&ClientLoop::CallRegister, weak_factory_.GetWeakPtr(),
-                        command_line->GetSwitchValueASCII("label"),
-                        command_line->GetSwitchValueASCII("user"));
+                        command_id, command_line.GetSwitchValueASCII("label"),
+                        command_line.GetSwitchValueASCII("user"));
     } else {
+      *error = "Unknown command: " + args.front();
       return EX_USAGE;
     }
     base::MessageLoop::current()->PostTask(FROM_HERE, task);
     return EX_OK;
   }
 
+  // Reads the commands for --batch and posts a task to start them.
+  int ScheduleBatch(const base::CommandLine& command_line) {
+    base::FilePath filename(command_line.GetSwitchValueASCII(kBatchSwitch));
+    if (filename.empty() || filename.value() == "-") {
+      filename = base::FilePath("/dev/stdin");
+    }
+    std::string input;
+    if (!base::ReadFileToString(filename, &input)) {
+      LOG(ERROR) << "Failed to read file: " << filename.value();
+      return EX_NOINPUT;
+    }
+    for (const std::string& line : base::SplitString(
+             input, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+      if (line[0] != '#') {
+        batch_commands_.push_back(line);
+      }
+    }
+    if (command_line.HasSwitch(kInFlightSwitch) &&
+        (!base::StringToSizeT(command_line.GetSwitchValueASCII(kInFlightSwitch),
+                              &max_in_flight_) ||
+         max_in_flight_ == 0)) {
+      return EX_USAGE;
+    }
+    batch_mode_ = true;
+    base::MessageLoop::current()->PostTask(
+        FROM_HERE, base::Bind(&ClientLoop::StartBatchCommands,
+                              weak_factory_.GetWeakPtr()));
+    return EX_OK;
+  }
+
+  // Starts batch commands until |max_in_flight_| are in flight, or quits if
+  // all commands have finished.
+  void StartBatchCommands() {
+    while (commands_in_flight_ < max_in_flight_ &&
+           next_batch_command_ < batch_commands_.size()) {
+      int command_id = next_batch_command_++;
+      ++commands_in_flight_;
+      start_times_[command_id] = base::TimeTicks::Now();
+      std::vector<std::string> argv = base::SplitString(
+          batch_commands_[command_id], " \t", base::TRIM_WHITESPACE,
+          base::SPLIT_WANT_NONEMPTY);
+      argv.insert(argv.begin(),
+                  base::CommandLine::ForCurrentProcess()->GetProgram().value());
+      std::string error;
+      int exit_code =
+          ScheduleCommand(base::CommandLine(argv), command_id, &error);
+      if (exit_code != EX_OK) {
+        FailCommand(command_id, exit_code, error);
+      }
+    }
+    if (commands_in_flight_ == 0) {
+      QuitWithExitCode(batch_exit_code_);
+    }
+  }
+
+  // Prints the result of batch command |command_id| as a JSON line and starts
+  // the next command. Exactly one of |output| and |error| should be set.
+  void FinishBatchCommand(int command_id,
+                          int exit_code,
+                          const std::string& output,
+                          const std::string& error) {
+    base::TimeDelta latency = base::TimeTicks::Now() - start_times_[command_id];
+    start_times_.erase(command_id);
+    base::DictionaryValue result;
+    result.SetInteger("id", command_id);
+    result.SetString("command", batch_commands_[command_id]);
+    result.SetInteger("exit_code", exit_code);
+    result.SetDouble("latency_ms", latency.InMillisecondsF());
+    if (error.empty()) {
+      result.SetString("reply", output);
+    } else {
+      result.SetString("error", error);
+    }
+    std::string json;
+    base::JSONWriter::Write(result, &json);
+    printf("%s\n", json.c_str());
+    fflush(stdout);
+    if (exit_code != EX_OK) {
+      batch_exit_code_ = exit_code;
+    }
+    --commands_in_flight_;
+    base::MessageLoop::current()->PostTask(
+        FROM_HERE, base::Bind(&ClientLoop::StartBatchCommands,
+                              weak_factory_.GetWeakPtr()));
+  }
+
+  // Prints |output|, if any, and finishes command |command_id| with
+  // |exit_code|.
+  void PrintAndFinish(int command_id,
+                      int exit_code,
+                      const std::string& output) {
+    if (batch_mode_) {
+      FinishBatchCommand(command_id, exit_code, output, "");
+      return;
+    }
+    if (!output.empty()) {
+      printf("%s\n", output.c_str());
+    }
+    QuitWithExitCode(exit_code);
+  }
+
+  // Prints |reply| and finishes command |command_id|, failing it unless the
+  // reply's status is STATUS_SUCCESS.
   template <typename ProtobufType>
-  void PrintReplyAndQuit(const ProtobufType& reply) {
-    printf("%s\n", GetProtoDebugString(reply).c_str());
-    Quit();
+  void PrintReplyAndFinish(int command_id, const ProtobufType& reply) {
+    PrintAndFinish(command_id,
+                   reply.status() == STATUS_SUCCESS ? EX_OK : EX_SOFTWARE,
+                   GetProtoDebugString(reply));
+  }
+
+  // Finishes command |command_id| without a result because of |error|.
+  void FailCommand(int command_id, int exit_code, const std::string& error) {
+    if (batch_mode_) {
+      FinishBatchCommand(command_id, exit_code, "", error);
+      return;
+    }
+    LOG(ERROR) << error;
+    QuitWithExitCode(exit_code);
   }
 
-  void WriteOutput(const std::string& output) {
-    base::FilePath filename(
-        base::CommandLine::ForCurrentProcess()->GetSwitchValueASCII("output"));
+  // Writes |output| to |output_file|. On failure, finishes command
+  // |command_id| and returns false.
+  bool WriteOutput(int command_id,
+                   const std::string& output,
+                   const std::string& output_file) {
+    base::FilePath filename(output_file);
     if (base::WriteFile(filename, output.data(), output.size()) !=
         static_cast<int>(output.size())) {
-      LOG(ERROR) << "Failed to write file: " << filename.value();
-      QuitWithExitCode(EX_IOERR);
+      FailCommand(command_id, EX_IOERR,
+                  "Failed to write file: " + filename.value());
+      return false;
     }
+    return true;
   }
 
-  void CallCreateGoogleAttestedKey(const std::string& label,
+  void CallCreateGoogleAttestedKey(int command_id,
+                                   const std::string& label,
                                    const std::string& username) {
     CreateGoogleAttestedKeyRequest request;
     request.set_key_label(label);
@@ -281,90 +442,106 @@ class ClientLoop : public ClientLoopBase {
     request.set_username(username);
     attestation_->CreateGoogleAttestedKey(
         request,
-        base::Bind(&ClientLoop::PrintReplyAndQuit<CreateGoogleAttestedKeyReply>,
-                   weak_factory_.GetWeakPtr()));
+        base::Bind(
+            &ClientLoop::PrintReplyAndFinish<CreateGoogleAttestedKeyReply>,
+            weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void CallGetKeyInfo(const std::string& label, const std::string& username) {
+  void CallGetKeyInfo(int command_id,
+                      const std::string& label,
+                      const std::string& username) {
     GetKeyInfoRequest request;
     request.set_key_label(label);
     request.set_username(username);
     attestation_->GetKeyInfo(
-        request, base::Bind(&ClientLoop::PrintReplyAndQuit<GetKeyInfoReply>,
-                            weak_factory_.GetWeakPtr()));
+        request, base::Bind(&ClientLoop::PrintReplyAndFinish<GetKeyInfoReply>,
+                            weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void CallGetEndorsementInfo() {
+  void CallGetEndorsementInfo(int command_id) {
     GetEndorsementInfoRequest request;
     request.set_key_type(KEY_TYPE_RSA);
     attestation_->GetEndorsementInfo(
         request,
-        base::Bind(&ClientLoop::PrintReplyAndQuit<GetEndorsementInfoReply>,
-                   weak_factory_.GetWeakPtr()));
+        base::Bind(&ClientLoop::PrintReplyAndFinish<GetEndorsementInfoReply>,
+                   weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void CallGetAttestationKeyInfo() {
+  void CallGetAttestationKeyInfo(int command_id) {
     GetAttestationKeyInfoRequest request;
     request.set_key_type(KEY_TYPE_RSA);
     attestation_->GetAttestationKeyInfo(
         request,
-        base::Bind(&ClientLoop::PrintReplyAndQuit<GetAttestationKeyInfoReply>,
-                   weak_factory_.GetWeakPtr()));
+        base::Bind(&ClientLoop::PrintReplyAndFinish<GetAttestationKeyInfoReply>,
+                   weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void CallActivateAttestationKey(const std::string& input) {
+  void CallActivateAttestationKey(int command_id, const std::string& input) {
     ActivateAttestationKeyRequest request;
     request.set_key_type(KEY_TYPE_RSA);
     request.mutable_encrypted_certificate()->ParseFromString(input);
     request.set_save_certificate(true);
     attestation_->ActivateAttestationKey(
         request,
-        base::Bind(&ClientLoop::PrintReplyAndQuit<ActivateAttestationKeyReply>,
-                   weak_factory_.GetWeakPtr()));
+        base::Bind(
+            &ClientLoop::PrintReplyAndFinish<ActivateAttestationKeyReply>,
+            weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void EncryptForActivate(const std::string& input) {
+  void EncryptForActivate(int command_id,
+                          const std::string& input,
+                          const std::string& output_file) {
     GetEndorsementInfoRequest request;
     request.set_key_type(KEY_TYPE_RSA);
     attestation_->GetEndorsementInfo(
-        request, base::Bind(&ClientLoop::EncryptForActivate2,
-                            weak_factory_.GetWeakPtr(), input));
+        request,
+        base::Bind(&ClientLoop::EncryptForActivate2, weak_factory_.GetWeakPtr(),
+                   command_id, input, output_file));
   }
 
-  void EncryptForActivate2(const std::string& input,
+  void EncryptForActivate2(int command_id,
+                           const std::string& input,
+                           const std::string& output_file,
                            const GetEndorsementInfoReply& endorsement_info) {
     if (endorsement_info.status() != STATUS_SUCCESS) {
-      PrintReplyAndQuit(endorsement_info);
+      PrintReplyAndFinish(command_id, endorsement_info);
+      return;
     }
     GetAttestationKeyInfoRequest request;
     request.set_key_type(KEY_TYPE_RSA);
     attestation_->GetAttestationKeyInfo(
         request,
         base::Bind(&ClientLoop::EncryptForActivate3, weak_factory_.GetWeakPtr(),
-                   input, endorsement_info));
+                   command_id, input, output_file, endorsement_info));
   }
 
   void EncryptForActivate3(
+      int command_id,
       const std::string& input,
+      const std::string& output_file,
       const GetEndorsementInfoReply& endorsement_info,
       const GetAttestationKeyInfoReply& attestation_key_info) {
     if (attestation_key_info.status() != STATUS_SUCCESS) {
-      PrintReplyAndQuit(attestation_key_info);
+      PrintReplyAndFinish(command_id, attestation_key_info);
+      return;
     }
     CryptoUtilityImpl crypto(nullptr);
     EncryptedIdentityCredential encrypted;
     if (!crypto.EncryptIdentityCredential(
             input, endorsement_info.ek_public_key(),
             attestation_key_info.public_key_tpm_format(), &encrypted)) {
-      QuitWithExitCode(EX_SOFTWARE);
+      FailCommand(command_id, EX_SOFTWARE, "Failed to encrypt credential.");
+      return;
     }
     std::string output;
     encrypted.SerializeToString(&output);
-    WriteOutput(output);
-    Quit();
+    if (WriteOutput(command_id, output, output_file)) {
+      PrintAndFinish(command_id, EX_OK, "");
+    }
   }
 
-  void CallCreateCertifiableKey(const std::string& label,
+  void CallCreateCertifiableKey(int command_id,
+                                const std::string& label,
                                 const std::string& username,
                                 KeyUsage usage) {
     CreateCertifiableKeyRequest request;
@@ -374,32 +551,40 @@ class ClientLoop : public ClientLoopBase {
     request.set_key_usage(usage);
     attestation_->CreateCertifiableKey(
         request,
-        base::Bind(&ClientLoop::PrintReplyAndQuit<CreateCertifiableKeyReply>,
-                   weak_factory_.GetWeakPtr()));
+        base::Bind(&ClientLoop::PrintReplyAndFinish<CreateCertifiableKeyReply>,
+                   weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void Encrypt(const std::string& label,
+  void Encrypt(int command_id,
+               const std::string& label,
                const std::string& username,
-               const std::string& input) {
+               const std::string& input,
+               const std::string& output_file) {
     GetKeyInfoRequest request;
     request.set_key_label(label);
     request.set_username(username);
     attestation_->GetKeyInfo(
-        request,
-        base::Bind(&ClientLoop::Encrypt2, weak_factory_.GetWeakPtr(), input));
+        request, base::Bind(&ClientLoop::Encrypt2, weak_factory_.GetWeakPtr(),
+                            command_id, input, output_file));
   }
 
-  void Encrypt2(const std::string& input, const GetKeyInfoReply& key_info) {
+  void Encrypt2(int command_id,
+                const std::string& input,
+                const std::string& output_file,
+                const GetKeyInfoReply& key_info) {
     CryptoUtilityImpl crypto(nullptr);
     std::string output;
     if (!crypto.EncryptForUnbind(key_info.public_key(), input, &output)) {
-      QuitWithExitCode(EX_SOFTWARE);
+      FailCommand(command_id, EX_SOFTWARE, "Failed to encrypt data.");
+      return;
+    }
+    if (WriteOutput(command_id, output, output_file)) {
+      PrintAndFinish(command_id, EX_OK, "");
     }
-    WriteOutput(output);
-    Quit();
   }
 
-  void CallDecrypt(const std::string& label,
+  void CallDecrypt(int command_id,
+                   const std::string& label,
                    const std::string& username,
                    const std::string& input) {
     DecryptRequest request;
@@ -407,30 +592,37 @@ class ClientLoop : public ClientLoopBase {
     request.set_username(username);
     request.set_encrypted_data(input);
     attestation_->Decrypt(
-        request, base::Bind(&ClientLoop::PrintReplyAndQuit<DecryptReply>,
-                            weak_factory_.GetWeakPtr()));
+        request, base::Bind(&ClientLoop::PrintReplyAndFinish<DecryptReply>,
+                            weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void CallSign(const std::string& label,
+  void CallSign(int command_id,
+                const std::string& label,
                 const std::string& username,
-                const std::string& input) {
+                const std::string& input,
+                const std::string& output_file) {
     SignRequest request;
     request.set_key_label(label);
     request.set_username(username);
     request.set_data_to_sign(input);
-    attestation_->Sign(request, base::Bind(&ClientLoop::OnSignComplete,
-                                           weak_factory_.GetWeakPtr()));
+    attestation_->Sign(request,
+                       base::Bind(&ClientLoop::OnSignComplete,
+                                  weak_factory_.GetWeakPtr(), command_id,
+                                  output_file));
   }
 
-  void OnSignComplete(const SignReply& reply) {
-    if (reply.status() == STATUS_SUCCESS &&
-        base::CommandLine::ForCurrentProcess()->HasSwitch("output")) {
-      WriteOutput(reply.signature());
+  void OnSignComplete(int command_id,
+                      const std::string& output_file,
+                      const SignReply& reply) {
+    if (reply.status() == STATUS_SUCCESS && !output_file.empty() &&
+        !WriteOutput(command_id, reply.signature(), output_file)) {
+      return;
     }
-    PrintReplyAndQuit<SignReply>(reply);
+    PrintReplyAndFinish<SignReply>(command_id, reply);
   }
 
-  void VerifySignature(const std::string& label,
+  void VerifySignature(int command_id,
+                       const std::string& label,
                        const std::string& username,
                        const std::string& input,
                        const std::string& signature) {
@@ -438,35 +630,48 @@ class ClientLoop : public ClientLoopBase {
     request.set_key_label(label);
     request.set_username(username);
     attestation_->GetKeyInfo(
-        request, base::Bind(&ClientLoop::VerifySignature2,
-                            weak_factory_.GetWeakPtr(), input, signature));
+        request,
+        base::Bind(&ClientLoop::VerifySignature2, weak_factory_.GetWeakPtr(),
+                   command_id, input, signature));
   }
 
-  void VerifySignature2(const std::string& input,
+  void VerifySignature2(int command_id,
+                        const std::string& input,
                         const std::string& signature,
                         const GetKeyInfoReply& key_info) {
     CryptoUtilityImpl crypto(nullptr);
     if (crypto.VerifySignature(key_info.public_key(), input, signature)) {
-      printf("Signature is OK!\n");
+      PrintAndFinish(command_id, EX_OK, "Signature is OK!");
     } else {
-      printf("Signature is BAD!\n");
+      PrintAndFinish(command_id, EX_DATAERR, "Signature is BAD!");
     }
-    Quit();
   }
 
-  void CallRegister(const std::string& label, const std::string& username) {
+  void CallRegister(int command_id,
+                    const std::string& label,
+                    const std::string& username) {
     RegisterKeyWithChapsTokenRequest request;
     request.set_key_label(label);
     request.set_username(username);
     attestation_->RegisterKeyWithChapsToken(
         request,
         base::Bind(
-            &ClientLoop::PrintReplyAndQuit<RegisterKeyWithChapsTokenReply>,
-            weak_factory_.GetWeakPtr()));
+            &ClientLoop::PrintReplyAndFinish<RegisterKeyWithChapsTokenReply>,
+            weak_factory_.GetWeakPtr(), command_id));
   }
 
   std::unique_ptr<attestation::AttestationInterface> attestation_;
 
+  // Batch mode state. Commands are identified by their index in
+  // |batch_commands_|.
+  bool batch_mode_ = false;
+  std::vector<std::string> batch_commands_;
+  size_t next_batch_command_ = 0;
+  size_t max_in_flight_ = 1;
+  size_t commands_in_flight_ = 0;
+  int batch_exit_code_ = EX_OK;
+  std::map<int, base::TimeTicks> start_times_;
+
   // Declare this last so weak pointers will be destroyed first.
   base::WeakPtrFactory<ClientLoop> weak_factory_{this};
 
@@ -38,6 +38,8 @@ namespace {
 
 const size_t kAesKeySize = 32;
 const size_t kAesBlockSize = 16;
+const size_t kAesGcmIvSize = 12;
+const size_t kAesGcmTagSize = 16;
 
 std::string GetOpenSSLError() {
   BIO* bio = BIO_new(BIO_s_mem());
@@ -96,21 +98,20 @@ bool CryptoUtilityImpl::EncryptData(const std::string& data,
                                     const std::string& aes_key,
                                     const std::string& sealed_key,
                                     std::string* encrypted_data) {
-  std::string iv;
-  if (!GetRandom(kAesBlockSize, &iv)) {
+  EncryptedData encrypted_pb;
+  if (!GetRandom(kAesGcmIvSize, encrypted_pb.mutable_iv())) {
     LOG(ERROR) << __func__ << ": GetRandom failed.";
     return false;
   }
-  std::string raw_encrypted_data;
-  if (!AesEncrypt(data, aes_key, iv, &raw_encrypted_data)) {
+  // Encrypt and authenticate directly into the protobuf fields.
+  if (!AesGcmEncrypt(data, aes_key, encrypted_pb.iv(),
+                     encrypted_pb.mutable_encrypted_data(),
+                     encrypted_pb.mutable_mac())) {
     LOG(ERROR) << __func__ << ": AES encryption failed.";
     return false;
   }
-  EncryptedData encrypted_pb;
   encrypted_pb.set_wrapped_key(sealed_key);
-  encrypted_pb.set_iv(iv);
-  encrypted_pb.set_encrypted_data(raw_encrypted_data);
-  encrypted_pb.set_mac(HmacSha512(iv + raw_encrypted_data, aes_key));
+  encrypted_pb.set_format(ENCRYPTION_FORMAT_AES_GCM);
   if (!encrypted_pb.SerializeToString(encrypted_data)) {
     LOG(ERROR) << __func__ << ": Failed to serialize protobuf.";
     return false;
@@ -142,8 +143,16 @@ bool CryptoUtilityImpl::DecryptData(const std::string& encrypted_data,
     LOG(ERROR) << __func__ << ": Failed to parse protobuf.";
     return false;
   }
+  if (encrypted_pb.format() == ENCRYPTION_FORMAT_AES_GCM) {
+    if (!AesGcmDecrypt(encrypted_pb.encrypted_data(), aes_key,
+                       encrypted_pb.iv(), encrypted_pb.mac(), data)) {
+      LOG(ERROR) << __func__ << ": AES-GCM decryption failed.";
+      return false;
+    }
+    return true;
+  }
   std::string mac =
-      HmacSha512(encrypted_pb.iv() + encrypted_pb.encrypted_data(), aes_key);
+      HmacSha512(encrypted_pb.iv(), encrypted_pb.encrypted_data(), aes_key);
   if (mac.length() != encrypted_pb.mac().length()) {
     LOG(ERROR) << __func__ << ": Corrupted data in encrypted pb.";
     return false;
@@ -407,13 +416,129 @@ bool CryptoUtilityImpl::AesDecrypt(const std::string& encrypted_data,
   return true;
 }
 
-std::string CryptoUtilityImpl::HmacSha512(const std::string& data,
+bool CryptoUtilityImpl::AesGcmEncrypt(const std::string& data,
+                                      const std::string& key,
+                                      const std::string& iv,
+                                      std::string* encrypted_data,
+                                      std::string* tag) {
+  if (key.size() != kAesKeySize || iv.size() != kAesGcmIvSize) {
+    return false;
+  }
+  if (data.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+    // EVP_EncryptUpdate takes a signed int.
+    return false;
+  }
+  auto input_buffer = reinterpret_cast<const unsigned char*>(data.data());
+  auto key_buffer = reinterpret_cast<const unsigned char*>(key.data());
+  auto iv_buffer = reinterpret_cast<const unsigned char*>(iv.data());
+  // GCM does not pad so the output is the same size as the input.
+  encrypted_data->resize(data.size());
+  unsigned char* output_buffer = StringAsOpenSSLBuffer(encrypted_data);
+  int output_size = 0;
+  EVP_CIPHER_CTX encryption_context;
+  EVP_CIPHER_CTX_init(&encryption_context);
+  if (!EVP_EncryptInit_ex(&encryption_context, EVP_aes_256_gcm(), nullptr,
+                          nullptr, nullptr) ||
+      !EVP_CIPHER_CTX_ctrl(&encryption_context, EVP_CTRL_GCM_SET_IVLEN,
+                           iv.size(), nullptr) ||
+      !EVP_EncryptInit_ex(&encryption_context, nullptr, nullptr, key_buffer,
+                          iv_buffer)) {
+    LOG(ERROR) << __func__ << ": " << GetOpenSSLError();
+    EVP_CIPHER_CTX_cleanup(&encryption_context);
+    return false;
+  }
+  if (!data.empty() &&
+      !EVP_EncryptUpdate(&encryption_context, output_buffer, &output_size,
+                         input_buffer, data.size())) {
+    LOG(ERROR) << __func__ << ": " << GetOpenSSLError();
+    EVP_CIPHER_CTX_cleanup(&encryption_context);
+    return false;
+  }
+  // Nothing is buffered in GCM mode, this only finalizes the tag.
+  unsigned char final_buffer[kAesBlockSize];
+  int final_size = 0;
+  tag->resize(kAesGcmTagSize);
+  if (!EVP_EncryptFinal_ex(&encryption_context, final_buffer, &final_size) ||
+      final_size != 0 ||
+      !EVP_CIPHER_CTX_ctrl(&encryption_context, EVP_CTRL_GCM_GET_TAG,
+                           kAesGcmTagSize, StringAsOpenSSLBuffer(tag))) {
+    LOG(ERROR) << __func__ << ": " << GetOpenSSLError();
+    EVP_CIPHER_CTX_cleanup(&encryption_context);
+    return false;
+  }
+  EVP_CIPHER_CTX_cleanup(&encryption_context);
+  return true;
+}
+
+bool CryptoUtilityImpl::AesGcmDecrypt(const std::string& encrypted_data,
+                                      const std::string& key,
+                                      const std::string& iv,
+                                      const std::string& tag,
+                                      std::string* data) {
+  if (key.size() != kAesKeySize || iv.size() != kAesGcmIvSize ||
+      tag.size() != kAesGcmTagSize) {
+    return false;
+  }
+  if (encrypted_data.size() >
+      static_cast<size_t>(std::numeric_limits<int>::max())) {
+    // EVP_DecryptUpdate takes a signed int.
+    return false;
+  }
+  auto input_buffer =
+      reinterpret_cast<const unsigned char*>(encrypted_data.data());
+  auto key_buffer = reinterpret_cast<const unsigned char*>(key.data());
+  auto iv_buffer = reinterpret_cast<const unsigned char*>(iv.data());
+  std::string mutable_tag(tag);
+  data->resize(encrypted_data.size());
+  unsigned char* output_buffer = StringAsOpenSSLBuffer(data);
+  int output_size = 0;
+  EVP_CIPHER_CTX decryption_context;
+  EVP_CIPHER_CTX_init(&decryption_context);
+  if (!EVP_DecryptInit_ex(&decryption_context, EVP_aes_256_gcm(), nullptr,
+                          nullptr, nullptr) ||
+      !EVP_CIPHER_CTX_ctrl(&decryption_context, EVP_CTRL_GCM_SET_IVLEN,
+                           iv.size(), nullptr) ||
+      !EVP_DecryptInit_ex(&decryption_context, nullptr, nullptr, key_buffer,
+                          iv_buffer) ||
+      (!encrypted_data.empty() &&
+       !EVP_DecryptUpdate(&decryption_context, output_buffer, &output_size,
+                          input_buffer, encrypted_data.size())) ||
+      !EVP_CIPHER_CTX_ctrl(&decryption_context, EVP_CTRL_GCM_SET_TAG,
+                           kAesGcmTagSize, string_as_array(&mutable_tag))) {
+    LOG(ERROR) << __func__ << ": " << GetOpenSSLError();
+    EVP_CIPHER_CTX_cleanup(&decryption_context);
+    data->clear();
+    return false;
+  }
+  // This is where the tag is verified.
+  unsigned char final_buffer[kAesBlockSize];
+  int final_size = 0;
+  if (!EVP_DecryptFinal_ex(&decryption_context, final_buffer, &final_size)) {
+    LOG(ERROR) << __func__ << ": Authentication failed.";
+    EVP_CIPHER_CTX_cleanup(&decryption_context);
+    data->clear();
+    return false;
+  }
+  EVP_CIPHER_CTX_cleanup(&decryption_context);
+  return true;
+}
+
+std::string CryptoUtilityImpl::HmacSha512(const std::string& data1,
+                                          const std::string& data2,
                                           const std::string& key) {
   unsigned char mac[SHA512_DIGEST_LENGTH];
-  std::string mutable_data(data);
-  unsigned char* data_buffer = StringAsOpenSSLBuffer(&mutable_data);
-  HMAC(EVP_sha512(), key.data(), key.size(), data_buffer, data.size(), mac,
-       nullptr);
+  unsigned int mac_length = 0;
+  HMAC_CTX hmac_context;
+  HMAC_CTX_init(&hmac_context);
+  HMAC_Init_ex(&hmac_context, key.data(), key.size(), EVP_sha512(), nullptr);
+  HMAC_Update(&hmac_context,
+              reinterpret_cast<const unsigned char*>(data1.data()),
+              data1.size());
+  HMAC_Update(&hmac_context,
+              reinterpret_cast<const unsigned char*>(data2.data()),
+              data2.size());
+  HMAC_Final(&hmac_context, mac, &mac_length);
+  HMAC_CTX_cleanup(&hmac_context);
   return std::string(std::begin(mac), std::end(mac));
 }
 
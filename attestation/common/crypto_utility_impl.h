@@ -78,8 +78,28 @@ class CryptoUtilityImpl : public CryptoUtility {
                   const std::string& iv,
                   std::string* data);
 
-  // Computes and returns an HMAC of |data| using |key| and SHA-512.
-  std::string HmacSha512(const std::string& data, const std::string& key);
+  // Encrypts |data| using |key| and a 96-bit |iv| for AES in GCM mode. The
+  // ciphertext is written to |encrypted_data| in a single pass and the
+  // authentication tag to |tag|. Returns true on success.
+  bool AesGcmEncrypt(const std::string& data,
+                     const std::string& key,
+                     const std::string& iv,
+                     std::string* encrypted_data,
+                     std::string* tag);
+
+  // Decrypts |encrypted_data| using |key| and |iv| for AES in GCM mode and
+  // verifies the authentication |tag|. Returns true on success.
+  bool AesGcmDecrypt(const std::string& encrypted_data,
+                     const std::string& key,
+                     const std::string& iv,
+                     const std::string& tag,
+                     std::string* data);
+
+  // Computes and returns an HMAC of (|data1| || |data2|) using |key| and
+  // SHA-512.
+  std::string HmacSha512(const std::string& data1,
+                         const std::string& data2,
+                         const std::string& key);
 
   // Encrypt like trousers does. This is like AesEncrypt but a random IV is
   // included in the output.
@@ -22,6 +22,9 @@
 #include <base/strings/string_number_conversions.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
 
 #include "attestation/common/crypto_utility_impl.h"
 #include "attestation/common/mock_tpm_utility.h"
@@ -51,6 +54,41 @@ std::string HexDecode(const std::string hex) {
   return std::string(reinterpret_cast<char*>(output.data()), output.size());
 }
 
+// Encrypts |data| in the original AES-256-CBC + HMAC-SHA512 EncryptedData
+// format.
+std::string LegacyEncrypt(const std::string& data,
+                          const std::string& key,
+                          const std::string& iv) {
+  std::string encrypted(data.size() + 16, 0);
+  auto output = reinterpret_cast<unsigned char*>(&encrypted[0]);
+  int output_size = 0;
+  int final_size = 0;
+  EVP_CIPHER_CTX context;
+  EVP_CIPHER_CTX_init(&context);
+  CHECK(EVP_EncryptInit_ex(&context, EVP_aes_256_cbc(), nullptr,
+                           reinterpret_cast<const unsigned char*>(key.data()),
+                           reinterpret_cast<const unsigned char*>(iv.data())));
+  CHECK(EVP_EncryptUpdate(&context, output, &output_size,
+                          reinterpret_cast<const unsigned char*>(data.data()),
+                          data.size()));
+  CHECK(EVP_EncryptFinal_ex(&context, output + output_size, &final_size));
+  EVP_CIPHER_CTX_cleanup(&context);
+  encrypted.resize(output_size + final_size);
+  std::string mac_input = iv + encrypted;
+  unsigned char mac[SHA512_DIGEST_LENGTH];
+  HMAC(EVP_sha512(), key.data(), key.size(),
+       reinterpret_cast<const unsigned char*>(mac_input.data()),
+       mac_input.size(), mac, nullptr);
+  attestation::EncryptedData encrypted_pb;
+  encrypted_pb.set_wrapped_key("sealed_key");
+  encrypted_pb.set_iv(iv);
+  encrypted_pb.set_encrypted_data(encrypted);
+  encrypted_pb.set_mac(std::string(std::begin(mac), std::end(mac)));
+  std::string output_pb;
+  CHECK(encrypted_pb.SerializeToString(&output_pb));
+  return output_pb;
+}
+
 }  // namespace
 
 namespace attestation {
@@ -97,6 +135,49 @@ TEST_F(CryptoUtilityImplTest, PairwiseSealedEncryption) {
   EXPECT_EQ("test", data);
 }
 
+TEST_F(CryptoUtilityImplTest, EncryptDataUsesGcm) {
+  std::string key(32, 'k');
+  std::string encrypted_data;
+  EXPECT_TRUE(
+      crypto_utility_->EncryptData("data", key, "sealed", &encrypted_data));
+  EncryptedData encrypted_pb;
+  ASSERT_TRUE(encrypted_pb.ParseFromString(encrypted_data));
+  EXPECT_EQ(ENCRYPTION_FORMAT_AES_GCM, encrypted_pb.format());
+  EXPECT_EQ("sealed", encrypted_pb.wrapped_key());
+  EXPECT_EQ(12u, encrypted_pb.iv().size());
+  EXPECT_EQ(16u, encrypted_pb.mac().size());
+  EXPECT_EQ(4u, encrypted_pb.encrypted_data().size());
+}
+
+TEST_F(CryptoUtilityImplTest, DecryptTamperedData) {
+  std::string key(32, 'k');
+  std::string encrypted_data;
+  EXPECT_TRUE(
+      crypto_utility_->EncryptData("data", key, "sealed", &encrypted_data));
+  EncryptedData encrypted_pb;
+  ASSERT_TRUE(encrypted_pb.ParseFromString(encrypted_data));
+  (*encrypted_pb.mutable_encrypted_data())[0] ^= 1;
+  ASSERT_TRUE(encrypted_pb.SerializeToString(&encrypted_data));
+  std::string data;
+  EXPECT_FALSE(crypto_utility_->DecryptData(encrypted_data, key, &data));
+  EXPECT_TRUE(data.empty());
+}
+
+TEST_F(CryptoUtilityImplTest, DecryptLegacyFormat) {
+  std::string key(32, 'k');
+  std::string iv(16, 'i');
+  std::string encrypted_data = LegacyEncrypt("legacy data", key, iv);
+  std::string data;
+  EXPECT_TRUE(crypto_utility_->DecryptData(encrypted_data, key, &data));
+  EXPECT_EQ("legacy data", data);
+  // A bad MAC is still detected.
+  EncryptedData encrypted_pb;
+  ASSERT_TRUE(encrypted_pb.ParseFromString(encrypted_data));
+  (*encrypted_pb.mutable_mac())[0] ^= 1;
+  ASSERT_TRUE(encrypted_pb.SerializeToString(&encrypted_data));
+  EXPECT_FALSE(crypto_utility_->DecryptData(encrypted_data, key, &data));
+}
+
 TEST_F(CryptoUtilityImplTest, SealFailure) {
   EXPECT_CALL(mock_tpm_utility_, SealToPCR0(_, _))
       .WillRepeatedly(Return(false));
@@ -80,6 +80,21 @@ std::string GetProtoDebugStringWithIndent(CertificateProfile value,
   return "<unknown>";
 }
 
+std::string GetProtoDebugString(EncryptionFormat value) {
+  return GetProtoDebugStringWithIndent(value, 0);
+}
+
+std::string GetProtoDebugStringWithIndent(EncryptionFormat value,
+                                          int indent_size) {
+  if (value == ENCRYPTION_FORMAT_AES_CBC_HMAC_SHA512) {
+    return "ENCRYPTION_FORMAT_AES_CBC_HMAC_SHA512";
+  }
+  if (value == ENCRYPTION_FORMAT_AES_GCM) {
+    return "ENCRYPTION_FORMAT_AES_GCM";
+  }
+  return "<unknown>";
+}
+
 std::string GetProtoDebugString(const Quote& value) {
   return GetProtoDebugStringWithIndent(value, 0);
 }
@@ -172,6 +187,13 @@ std::string GetProtoDebugStringWithIndent(const EncryptedData& value,
                             .c_str());
     output += "\n";
   }
+  if (value.has_format()) {
+    output += indent + "  format: ";
+    base::StringAppendF(&output, "%s", GetProtoDebugStringWithIndent(
+                                           value.format(), indent_size + 2)
+                                           .c_str());
+    output += "\n";
+  }
   output += indent + "}\n";
   return output;
 }
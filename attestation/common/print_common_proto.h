@@ -32,6 +32,9 @@ std::string GetProtoDebugString(KeyUsage value);
 std::string GetProtoDebugStringWithIndent(CertificateProfile value,
                                           int indent_size);
 std::string GetProtoDebugString(CertificateProfile value);
+std::string GetProtoDebugStringWithIndent(EncryptionFormat value,
+                                          int indent_size);
+std::string GetProtoDebugString(EncryptionFormat value);
 std::string GetProtoDebugStringWithIndent(const Quote& value, int indent_size);
 std::string GetProtoDebugString(const Quote& value);
 std::string GetProtoDebugStringWithIndent(const EncryptedData& value,
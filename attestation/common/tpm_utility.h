@@ -53,7 +53,9 @@ class TpmUtility {
   // be included in the |key_info|. On success, returns true and populates
   // |public_key_tpm_format| with the public key of |key_blob| in TPM_PUBKEY
   // format, |key_info| with the TPM_CERTIFY_INFO that was signed, and |proof|
-  // with the signature of |key_info| by the identity key.
+  // with the signature of |key_info| by the identity key. The |public_key| of
+  // an RSA key is a PKCS #1 RSAPublicKey and that of an ECC key is an X.509
+  // SubjectPublicKeyInfo. Backends without ECC support fail for KEY_TYPE_ECC.
   virtual bool CreateCertifiedKey(KeyType key_type,
                                   KeyUsage key_usage,
                                   const std::string& identity_key_blob,
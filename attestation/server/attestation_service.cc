@@ -39,12 +39,17 @@ const char kACAWebOrigin[] = "https://asbestos-qa.corp.google.com";
 const size_t kNonceSize = 20;  // As per TPM_NONCE definition.
 const int kNumTemporalValues = 5;
 
+// The number of recently used keys kept decoded in memory.
+const size_t kKeyCacheSize = 32;
+
 }  // namespace
 
 namespace attestation {
 
 AttestationService::AttestationService()
-    : attestation_ca_origin_(kACAWebOrigin), weak_factory_(this) {}
+    : attestation_ca_origin_(kACAWebOrigin),
+      key_cache_(kKeyCacheSize),
+      weak_factory_(this) {}
 
 bool AttestationService::Initialize() {
   LOG(INFO) << "Attestation service started.";
@@ -171,28 +176,33 @@ void AttestationService::GetKeyInfo(const GetKeyInfoRequest& request,
 void AttestationService::GetKeyInfoTask(
     const GetKeyInfoRequest& request,
     const std::shared_ptr<GetKeyInfoReply>& result) {
-  CertifiedKey key;
-  if (!FindKeyByLabel(request.username(), request.key_label(), &key)) {
+  CachedKey* cached_key =
+      FindCachedKey(request.username(), request.key_label());
+  if (!cached_key) {
     result->set_status(STATUS_INVALID_PARAMETER);
     return;
   }
-  std::string public_key_info;
-  if (!GetSubjectPublicKeyInfo(key.key_type(), key.public_key(),
-                               &public_key_info)) {
+  const CertifiedKey& key = cached_key->key;
+  if (cached_key->public_key_info.empty() &&
+      !GetSubjectPublicKeyInfo(key.key_type(), key.public_key(),
+                               &cached_key->public_key_info)) {
     LOG(ERROR) << __func__ << ": Bad public key.";
     result->set_status(STATUS_UNEXPECTED_DEVICE_ERROR);
     return;
   }
+  if (cached_key->certificate_chain.empty()) {
+    if (key.has_intermediate_ca_cert()) {
+      cached_key->certificate_chain = CreatePEMCertificateChain(key);
+    } else {
+      cached_key->certificate_chain = key.certified_key_credential();
+    }
+  }
   result->set_key_type(key.key_type());
   result->set_key_usage(key.key_usage());
-  result->set_public_key(public_key_info);
+  result->set_public_key(cached_key->public_key_info);
   result->set_certify_info(key.certified_key_info());
   result->set_certify_info_signature(key.certified_key_proof());
-  if (key.has_intermediate_ca_cert()) {
-    result->set_certificate(CreatePEMCertificateChain(key));
-  } else {
-    result->set_certificate(key.certified_key_credential());
-  }
+  result->set_certificate(cached_key->certificate_chain);
 }
 
 void AttestationService::GetEndorsementInfo(
@@ -384,13 +394,15 @@ void AttestationService::Decrypt(const DecryptRequest& request,
 void AttestationService::DecryptTask(
     const DecryptRequest& request,
     const std::shared_ptr<DecryptReply>& result) {
-  CertifiedKey key;
-  if (!FindKeyByLabel(request.username(), request.key_label(), &key)) {
+  const CachedKey* cached_key =
+      FindCachedKey(request.username(), request.key_label());
+  if (!cached_key) {
     result->set_status(STATUS_INVALID_PARAMETER);
     return;
   }
   std::string data;
-  if (!tpm_utility_->Unbind(key.key_blob(), request.encrypted_data(), &data)) {
+  if (!tpm_utility_->Unbind(cached_key->key.key_blob(),
+                            request.encrypted_data(), &data)) {
     result->set_status(STATUS_UNEXPECTED_DEVICE_ERROR);
     return;
   }
@@ -410,13 +422,15 @@ void AttestationService::Sign(const SignRequest& request,
 
 void AttestationService::SignTask(const SignRequest& request,
                                   const std::shared_ptr<SignReply>& result) {
-  CertifiedKey key;
-  if (!FindKeyByLabel(request.username(), request.key_label(), &key)) {
+  const CachedKey* cached_key =
+      FindCachedKey(request.username(), request.key_label());
+  if (!cached_key) {
     result->set_status(STATUS_INVALID_PARAMETER);
     return;
   }
   std::string signature;
-  if (!tpm_utility_->Sign(key.key_blob(), request.data_to_sign(), &signature)) {
+  if (!tpm_utility_->Sign(cached_key->key.key_blob(), request.data_to_sign(),
+                          &signature)) {
     result->set_status(STATUS_UNEXPECTED_DEVICE_ERROR);
     return;
   }
@@ -439,11 +453,13 @@ void AttestationService::RegisterKeyWithChapsToken(
 void AttestationService::RegisterKeyWithChapsTokenTask(
     const RegisterKeyWithChapsTokenRequest& request,
     const std::shared_ptr<RegisterKeyWithChapsTokenReply>& result) {
-  CertifiedKey key;
-  if (!FindKeyByLabel(request.username(), request.key_label(), &key)) {
+  const CachedKey* cached_key =
+      FindCachedKey(request.username(), request.key_label());
+  if (!cached_key) {
     result->set_status(STATUS_INVALID_PARAMETER);
     return;
   }
+  const CertifiedKey& key = cached_key->key;
   if (!key_store_->Register(request.username(), request.key_label(),
                             key.key_type(), key.key_usage(), key.key_blob(),
                             key.public_key(), key.certified_key_credential())) {
@@ -669,6 +685,42 @@ bool AttestationService::FindKeyByLabel(const std::string& username,
   return false;
 }
 
+AttestationService::CachedKey* AttestationService::FindCachedKey(
+    const std::string& username,
+    const std::string& key_label) {
+  uint64_t reload_count = database_->GetReloadCount();
+  if (reload_count != key_cache_reload_count_) {
+    key_cache_.Clear();
+    key_cache_reload_count_ = reload_count;
+  }
+  auto cache_key = std::make_pair(username, key_label);
+  auto iter = key_cache_.Get(cache_key);
+  if (iter != key_cache_.end()) {
+    if (username.empty() || key_store_->IsAvailable(username)) {
+      return &iter->second;
+    }
+    // The user has logged out; their keys must not outlive the token.
+    LOG(INFO) << __func__ << ": Token gone, dropping cached user keys.";
+    EvictCachedUserKeys(username);
+    return nullptr;
+  }
+  CachedKey cached_key;
+  if (!FindKeyByLabel(username, key_label, &cached_key.key)) {
+    return nullptr;
+  }
+  return &key_cache_.Put(cache_key, cached_key)->second;
+}
+
+void AttestationService::EvictCachedUserKeys(const std::string& username) {
+  for (auto iter = key_cache_.begin(); iter != key_cache_.end();) {
+    if (iter->first.first == username) {
+      iter = key_cache_.Erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
 bool AttestationService::CreateKey(const std::string& username,
                                    const std::string& key_label,
                                    KeyType key_type,
@@ -703,6 +755,10 @@ bool AttestationService::CreateKey(const std::string& username,
 bool AttestationService::SaveKey(const std::string& username,
                                  const std::string& key_label,
                                  const CertifiedKey& key) {
+  auto iter = key_cache_.Peek(std::make_pair(username, key_label));
+  if (iter != key_cache_.end()) {
+    key_cache_.Erase(iter);
+  }
   if (!username.empty()) {
     std::string key_data;
     if (!key.SerializeToString(&key_data)) {
@@ -724,6 +780,10 @@ bool AttestationService::SaveKey(const std::string& username,
 
 void AttestationService::DeleteKey(const std::string& username,
                                    const std::string& key_label) {
+  auto iter = key_cache_.Peek(std::make_pair(username, key_label));
+  if (iter != key_cache_.end()) {
+    key_cache_.Erase(iter);
+  }
   if (!username.empty()) {
     key_store_->Delete(username, key_label);
   } else {
@@ -858,7 +918,14 @@ bool AttestationService::GetSubjectPublicKeyInfo(
     KeyType key_type,
     const std::string& public_key,
     std::string* public_key_info) const {
-  // Only RSA is supported currently.
+  if (key_type == KEY_TYPE_ECC) {
+    // ECC public keys are already in SubjectPublicKeyInfo format.
+    if (public_key.empty()) {
+      return false;
+    }
+    *public_key_info = public_key;
+    return true;
+  }
   if (key_type != KEY_TYPE_RSA) {
     return false;
   }
@@ -21,8 +21,10 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
 #include <base/callback.h>
+#include <base/containers/mru_cache.h>
 #include <base/macros.h>
 #include <base/memory/weak_ptr.h>
 #include <base/threading/thread.h>
@@ -116,6 +118,14 @@ class AttestationService : public AttestationInterface {
     kGetCertificate,  // Issues a certificate for a TPM-backed key.
   };
 
+  // A key loaded by FindKeyByLabel along with the data GetKeyInfo derives from
+  // it. The derived fields are filled in on first use.
+  struct CachedKey {
+    CertifiedKey key;
+    std::string public_key_info;
+    std::string certificate_chain;
+  };
+
   // A relay callback which allows the use of weak pointer semantics for a reply
   // to TaskRunner::PostTaskAndReply.
   template <typename ReplyProtobufType>
@@ -229,6 +239,16 @@ class AttestationService : public AttestationInterface {
                       const std::string& key_label,
                       CertifiedKey* key);
 
+  // Returns the key associated with |username| and |key_label| from
+  // |key_cache_|, loading it with FindKeyByLabel on a miss. Returns nullptr if
+  // such a key does not exist or if the user's key store is no longer
+  // available. The pointer is valid until the cache is next modified.
+  CachedKey* FindCachedKey(const std::string& username,
+                           const std::string& key_label);
+
+  // Removes every entry for |username| from |key_cache_|.
+  void EvictCachedUserKeys(const std::string& username);
+
   // Saves the |key| associated with |username| and |key_label|. Returns true on
   // success.
   bool SaveKey(const std::string& username,
@@ -277,6 +297,13 @@ class AttestationService : public AttestationInterface {
   KeyStore* key_store_{nullptr};
   TpmUtility* tpm_utility_{nullptr};
 
+  // Recently used keys keyed by username and label. Entries are removed by
+  // SaveKey() and DeleteKey(), a user's entries are removed once their key
+  // store is no longer available, and the cache is cleared when |database_|
+  // has been reloaded since |key_cache_reload_count_| was recorded.
+  base::MRUCache<std::pair<std::string, std::string>, CachedKey> key_cache_;
+  uint64_t key_cache_reload_count_{0};
+
   // Default implementations for the above interfaces. These will be setup
   // during Initialize() if the corresponding interface has not been set with a
   // mutator.
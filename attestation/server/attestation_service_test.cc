@@ -502,6 +502,29 @@ TEST_F(AttestationServiceTest, GetKeyInfoSuccessNoUser) {
   Run();
 }
 
+TEST_F(AttestationServiceTest, GetKeyInfoECC) {
+  CertifiedKey& key = *mock_database_.GetMutableProtobuf()->add_device_keys();
+  key.set_public_key("ecc_public_key_info");
+  key.set_certified_key_credential("fake_cert");
+  key.set_key_name("label");
+  key.set_key_type(KEY_TYPE_ECC);
+  key.set_key_usage(KEY_USAGE_SIGN);
+  // ECC public keys are stored in SubjectPublicKeyInfo format already.
+  EXPECT_CALL(mock_crypto_utility_, GetRSASubjectPublicKeyInfo(_, _)).Times(0);
+
+  // Set expectations on the outputs.
+  auto callback = [this](const GetKeyInfoReply& reply) {
+    EXPECT_EQ(STATUS_SUCCESS, reply.status());
+    EXPECT_EQ(KEY_TYPE_ECC, reply.key_type());
+    EXPECT_EQ("ecc_public_key_info", reply.public_key());
+    Quit();
+  };
+  GetKeyInfoRequest request;
+  request.set_key_label("label");
+  service_->GetKeyInfo(request, base::Bind(callback));
+  Run();
+}
+
 TEST_F(AttestationServiceTest, GetKeyInfoNoKey) {
   EXPECT_CALL(mock_key_store_, Read("user", "label", _))
       .WillRepeatedly(Return(false));
@@ -534,6 +557,77 @@ TEST_F(AttestationServiceTest, GetKeyInfoBadPublicKey) {
   Run();
 }
 
+TEST_F(AttestationServiceTest, GetKeyInfoCached) {
+  CertifiedKey key;
+  key.set_public_key("public_key");
+  key.set_certified_key_credential("fake_cert");
+  key.set_key_name("label");
+  key.set_key_type(KEY_TYPE_RSA);
+  key.set_key_usage(KEY_USAGE_SIGN);
+  std::string key_bytes;
+  key.SerializeToString(&key_bytes);
+  // The second request is served from the cache. The third reads the key again
+  // because the database has been reloaded.
+  EXPECT_CALL(mock_key_store_, Read("user", "label", _))
+      .Times(2)
+      .WillRepeatedly(DoAll(SetArgumentPointee<2>(key_bytes), Return(true)));
+  EXPECT_CALL(mock_database_, GetReloadCount())
+      .WillOnce(Return(0))
+      .WillOnce(Return(0))
+      .WillRepeatedly(Return(1));
+
+  int replies = 0;
+  auto callback = [this, &replies](const GetKeyInfoReply& reply) {
+    EXPECT_EQ(STATUS_SUCCESS, reply.status());
+    EXPECT_EQ("public_key", reply.public_key());
+    EXPECT_EQ("fake_cert", reply.certificate());
+    if (++replies == 3) {
+      Quit();
+    }
+  };
+  GetKeyInfoRequest request;
+  request.set_key_label("label");
+  request.set_username("user");
+  service_->GetKeyInfo(request, base::Bind(callback));
+  service_->GetKeyInfo(request, base::Bind(callback));
+  service_->GetKeyInfo(request, base::Bind(callback));
+  Run();
+}
+
+TEST_F(AttestationServiceTest, CachedKeyDroppedAfterLogout) {
+  // The key is read once for the first two requests. After logout the cached
+  // key is not used, and after the next login the key is read again.
+  EXPECT_CALL(mock_key_store_, Read("user", "label", _))
+      .Times(2)
+      .WillRepeatedly(Return(true));
+  EXPECT_CALL(mock_key_store_, IsAvailable("user"))
+      .WillOnce(Return(true))
+      .WillOnce(Return(false));
+  EXPECT_CALL(mock_tpm_utility_, Sign(_, _, _)).Times(3);
+
+  int replies = 0;
+  auto callback = [this, &replies](const SignReply& reply) {
+    if (++replies == 3) {
+      EXPECT_NE(STATUS_SUCCESS, reply.status());
+      EXPECT_FALSE(reply.has_signature());
+    } else {
+      EXPECT_EQ(STATUS_SUCCESS, reply.status());
+    }
+    if (replies == 4) {
+      Quit();
+    }
+  };
+  SignRequest request;
+  request.set_key_label("label");
+  request.set_username("user");
+  request.set_data_to_sign("data");
+  service_->Sign(request, base::Bind(callback));
+  service_->Sign(request, base::Bind(callback));
+  service_->Sign(request, base::Bind(callback));
+  service_->Sign(request, base::Bind(callback));
+  Run();
+}
+
 TEST_F(AttestationServiceTest, GetEndorsementInfoSuccess) {
   AttestationDatabase* database = mock_database_.GetMutableProtobuf();
   database->mutable_credentials()->set_endorsement_public_key("public_key");
@@ -39,6 +39,10 @@ class Database {
 
   // Reloads the database protobuf from disk.
   virtual bool Reload() = 0;
+
+  // Returns a count that changes every time Reload() is called, so callers can
+  // tell when data derived from the protobuf may be stale.
+  virtual uint64_t GetReloadCount() const = 0;
 };
 
 }  // namespace attestation
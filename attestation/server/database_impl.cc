@@ -88,6 +88,7 @@ bool DatabaseImpl::SaveChanges() {
 bool DatabaseImpl::Reload() {
   DCHECK(thread_checker_.CalledOnValidThread());
   LOG(INFO) << "Loading attestation database.";
+  ++reload_count_;
   std::string buffer;
   if (!io_->Read(&buffer)) {
     return false;
@@ -95,6 +96,11 @@ bool DatabaseImpl::Reload() {
   return DecryptProtobuf(buffer);
 }
 
+uint64_t DatabaseImpl::GetReloadCount() const {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  return reload_count_;
+}
+
 bool DatabaseImpl::Read(std::string* data) {
   const int kMask = base::FILE_PERMISSION_OTHERS_MASK;
   FilePath path(kDatabasePath);
@@ -57,6 +57,7 @@ class DatabaseImpl : public Database, public DatabaseIO {
   AttestationDatabase* GetMutableProtobuf() override;
   bool SaveChanges() override;
   bool Reload() override;
+  uint64_t GetReloadCount() const override;
 
   // DatabaseIO methods.
   bool Read(std::string* data) override;
@@ -75,6 +76,7 @@ class DatabaseImpl : public Database, public DatabaseIO {
   bool DecryptProtobuf(const std::string& encrypted_input);
 
   AttestationDatabase protobuf_;
+  uint64_t reload_count_{0};
   DatabaseIO* io_;
   CryptoUtility* crypto_;
   std::string database_key_;
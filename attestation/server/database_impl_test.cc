@@ -146,9 +146,11 @@ TEST_F(DatabaseImplTest, Reload) {
   proto.SerializeToString(&fake_persistent_data_);
   EXPECT_EQ(std::string(),
             database_->GetProtobuf().credentials().platform_credential());
+  uint64_t reload_count = database_->GetReloadCount();
   EXPECT_TRUE(database_->Reload());
   EXPECT_EQ(std::string(kFakeCredential),
             database_->GetProtobuf().credentials().platform_credential());
+  EXPECT_NE(reload_count, database_->GetReloadCount());
 }
 
 TEST_F(DatabaseImplTest, AutoReload) {
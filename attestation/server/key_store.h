@@ -57,7 +57,8 @@ class KeyStore {
   // Registers a key to be associated with |username|.
   // The provided |label| will be associated with all registered objects.
   // |private_key_blob| holds the private key in some opaque format and
-  // |public_key_der| holds the public key in PKCS #1 RSAPublicKey format.
+  // |public_key_der| holds the public key in PKCS #1 RSAPublicKey format for
+  // RSA keys and in X.509 SubjectPublicKeyInfo format for ECC keys.
   // If a non-empty |certificate| is provided it will be registered along with
   // the key. Returns true on success.
   virtual bool Register(const std::string& username,
@@ -73,6 +74,11 @@ class KeyStore {
   virtual bool RegisterCertificate(const std::string& username,
                                    const std::string& certificate) = 0;
 
+  // Returns true if the store holding keys for |username| is currently
+  // available, e.g. false once the user has logged out. Callers which keep key
+  // data outside the store must check this before using it.
+  virtual bool IsAvailable(const std::string& username) = 0;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(KeyStore);
 };
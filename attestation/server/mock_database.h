@@ -32,6 +32,7 @@ class MockDatabase : public Database {
   MOCK_METHOD0(GetMutableProtobuf, AttestationDatabase*());
   MOCK_METHOD0(SaveChanges, bool());
   MOCK_METHOD0(Reload, bool());
+  MOCK_CONST_METHOD0(GetReloadCount, uint64_t());
 
  private:
   AttestationDatabase fake_;
@@ -28,6 +28,7 @@ MockKeyStore::MockKeyStore() {
   ON_CALL(*this, DeleteByPrefix(_, _)).WillByDefault(Return(true));
   ON_CALL(*this, Register(_, _, _, _, _, _, _)).WillByDefault(Return(true));
   ON_CALL(*this, RegisterCertificate(_, _)).WillByDefault(Return(true));
+  ON_CALL(*this, IsAvailable(_)).WillByDefault(Return(true));
 }
 
 MockKeyStore::~MockKeyStore() {}
@@ -55,6 +55,7 @@ class MockKeyStore : public KeyStore {
   MOCK_METHOD2(RegisterCertificate,
                bool(const std::string& username,
                     const std::string& certificate));
+  MOCK_METHOD1(IsAvailable, bool(const std::string& username));
 
  private:
   DISALLOW_COPY_AND_ASSIGN(MockKeyStore);
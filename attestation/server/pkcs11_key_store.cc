@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <base/bind.h>
 #include <base/callback.h>
@@ -30,6 +31,7 @@
 #include <chaps/token_manager_client.h>
 #include <brillo/cryptohome.h>
 #include <crypto/scoped_openssl_types.h>
+#include <openssl/ec.h>
 #include <openssl/rsa.h>
 #include <openssl/sha.h>
 #include <openssl/x509.h>
@@ -48,31 +50,31 @@ std::string Sha1(const std::string& input) {
 namespace attestation {
 
 typedef crypto::ScopedOpenSSL<X509, X509_free> ScopedX509;
+typedef crypto::ScopedOpenSSL<EC_KEY, EC_KEY_free> ScopedECKey;
+typedef crypto::ScopedOpenSSL<ASN1_OCTET_STRING, ASN1_OCTET_STRING_free>
+    ScopedOctetString;
 
 // An arbitrary application ID to identify PKCS #11 objects.
 const char kApplicationID[] = "CrOS_d5bbc079d2497110feadfc97c40d718ae46f4658";
 
-// A helper class to scope a PKCS #11 session.
+// The maximum number of idle sessions kept open per slot.
+const size_t kMaxIdleSessionsPerSlot = 2;
+
+// An upper bound on slot events handled in one PollSlotEvents() call.
+const int kMaxSlotEvents = 16;
+
+// A helper class to scope a PKCS #11 session. The session is borrowed from the
+// key store's pool and returned to it when the scope ends.
 class ScopedSession {
  public:
-  explicit ScopedSession(CK_SLOT_ID slot) : handle_(CK_INVALID_HANDLE) {
-    CK_RV rv = C_Initialize(nullptr);
-    if (rv != CKR_OK && rv != CKR_CRYPTOKI_ALREADY_INITIALIZED) {
-      // This may be normal in a test environment.
-      LOG(INFO) << "PKCS #11 is not available.";
-      return;
-    }
-    CK_FLAGS flags = CKF_RW_SESSION | CKF_SERIAL_SESSION;
-    if (C_OpenSession(slot, flags, nullptr, nullptr, &handle_) != CKR_OK) {
-      LOG(ERROR) << "Failed to open PKCS #11 session.";
-      return;
-    }
+  ScopedSession(Pkcs11KeyStore* key_store, CK_SLOT_ID slot)
+      : key_store_(key_store), slot_(slot), reusable_(true) {
+    handle_ = key_store_->AcquireSession(slot_);
   }
 
   ~ScopedSession() {
-    if (IsValid() && (C_CloseSession(handle_) != CKR_OK)) {
-      LOG(WARNING) << "Failed to close PKCS #11 session.";
-      handle_ = CK_INVALID_HANDLE;
+    if (IsValid()) {
+      key_store_->ReleaseSession(slot_, handle_, reusable_);
     }
   }
 
@@ -80,16 +82,34 @@ class ScopedSession {
 
   bool IsValid() const { return (handle_ != CK_INVALID_HANDLE); }
 
+  // Marks the session as unfit for reuse, e.g. after a PKCS #11 failure. It
+  // will be closed instead of being returned to the pool.
+  void Discard() { reusable_ = false; }
+
+  // Forgets a session which has already been closed.
+  void Detach() { handle_ = CK_INVALID_HANDLE; }
+
  private:
+  Pkcs11KeyStore* key_store_;
+  CK_SLOT_ID slot_;
   CK_SESSION_HANDLE handle_;
+  bool reusable_;
 
   DISALLOW_COPY_AND_ASSIGN(ScopedSession);
 };
 
 Pkcs11KeyStore::Pkcs11KeyStore(chaps::TokenManagerClient* token_manager)
-    : token_manager_(token_manager) {}
-
-Pkcs11KeyStore::~Pkcs11KeyStore() {}
+    : token_manager_(token_manager),
+      is_initialized_(false),
+      slot_events_supported_(true) {}
+
+Pkcs11KeyStore::~Pkcs11KeyStore() {
+  for (const auto& item : session_pool_) {
+    for (CK_SESSION_HANDLE session_handle : item.second) {
+      C_CloseSession(session_handle);
+    }
+  }
+}
 
 bool Pkcs11KeyStore::Read(const std::string& username,
                           const std::string& key_name,
@@ -99,12 +119,16 @@ bool Pkcs11KeyStore::Read(const std::string& username,
     LOG(ERROR) << "Pkcs11KeyStore: No token for user.";
     return false;
   }
-  ScopedSession session(slot);
+  ScopedSession session(this, slot);
   if (!session.IsValid()) {
     LOG(ERROR) << "Pkcs11KeyStore: Failed to open token session.";
     return false;
   }
-  CK_OBJECT_HANDLE key_handle = FindObject(session.handle(), key_name);
+  CK_OBJECT_HANDLE key_handle = CK_INVALID_HANDLE;
+  if (!FindObject(session.handle(), key_name, &key_handle)) {
+    session.Discard();
+    return false;
+  }
   if (key_handle == CK_INVALID_HANDLE) {
     LOG(WARNING) << "Pkcs11KeyStore: Key does not exist: " << key_name;
     return false;
@@ -114,6 +138,7 @@ bool Pkcs11KeyStore::Read(const std::string& username,
   if (C_GetAttributeValue(session.handle(), key_handle, &attribute, 1) !=
       CKR_OK) {
     LOG(ERROR) << "Pkcs11KeyStore: Failed to read key data: " << key_name;
+    session.Discard();
     return false;
   }
   key_data->resize(attribute.ulValueLen);
@@ -121,6 +146,7 @@ bool Pkcs11KeyStore::Read(const std::string& username,
   if (C_GetAttributeValue(session.handle(), key_handle, &attribute, 1) !=
       CKR_OK) {
     LOG(ERROR) << "Pkcs11KeyStore: Failed to read key data: " << key_name;
+    session.Discard();
     return false;
   }
   key_data->resize(attribute.ulValueLen);
@@ -130,20 +156,29 @@ bool Pkcs11KeyStore::Read(const std::string& username,
 bool Pkcs11KeyStore::Write(const std::string& username,
                            const std::string& key_name,
                            const std::string& key_data) {
-  // Delete any existing key with the same name.
-  if (!Delete(username, key_name)) {
-    return false;
-  }
   CK_SLOT_ID slot;
   if (!GetUserSlot(username, &slot)) {
     LOG(ERROR) << "Pkcs11KeyStore: No token for user.";
     return false;
   }
-  ScopedSession session(slot);
+  ScopedSession session(this, slot);
   if (!session.IsValid()) {
     LOG(ERROR) << "Pkcs11KeyStore: Failed to open token session.";
     return false;
   }
+  // Delete any existing key with the same name.
+  CK_OBJECT_HANDLE key_handle = CK_INVALID_HANDLE;
+  if (!FindObject(session.handle(), key_name, &key_handle)) {
+    LOG(ERROR) << "Pkcs11KeyStore: Failed to search for key data.";
+    session.Discard();
+    return false;
+  }
+  if (key_handle != CK_INVALID_HANDLE &&
+      C_DestroyObject(session.handle(), key_handle) != CKR_OK) {
+    LOG(ERROR) << "Pkcs11KeyStore: Failed to delete key data.";
+    session.Discard();
+    return false;
+  }
   std::string mutable_key_name(key_name);
   std::string mutable_key_data(key_data);
   std::string mutable_application_id(kApplicationID);
@@ -160,10 +195,10 @@ bool Pkcs11KeyStore::Write(const std::string& username,
       {CKA_TOKEN, &true_value, sizeof(true_value)},
       {CKA_PRIVATE, &true_value, sizeof(true_value)},
       {CKA_MODIFIABLE, &false_value, sizeof(false_value)}};
-  CK_OBJECT_HANDLE key_handle = CK_INVALID_HANDLE;
   if (C_CreateObject(session.handle(), attributes, arraysize(attributes),
                      &key_handle) != CKR_OK) {
     LOG(ERROR) << "Pkcs11KeyStore: Failed to write key data: " << key_name;
+    session.Discard();
     return false;
   }
   return true;
@@ -176,15 +211,21 @@ bool Pkcs11KeyStore::Delete(const std::string& username,
     LOG(ERROR) << "Pkcs11KeyStore: No token for user.";
     return false;
   }
-  ScopedSession session(slot);
+  ScopedSession session(this, slot);
   if (!session.IsValid()) {
     LOG(ERROR) << "Pkcs11KeyStore: Failed to open token session.";
     return false;
   }
-  CK_OBJECT_HANDLE key_handle = FindObject(session.handle(), key_name);
+  CK_OBJECT_HANDLE key_handle = CK_INVALID_HANDLE;
+  if (!FindObject(session.handle(), key_name, &key_handle)) {
+    LOG(ERROR) << "Pkcs11KeyStore: Failed to search for key data.";
+    session.Discard();
+    return false;
+  }
   if (key_handle != CK_INVALID_HANDLE) {
     if (C_DestroyObject(session.handle(), key_handle) != CKR_OK) {
       LOG(ERROR) << "Pkcs11KeyStore: Failed to delete key data.";
+      session.Discard();
       return false;
     }
   }
@@ -198,7 +239,7 @@ bool Pkcs11KeyStore::DeleteByPrefix(const std::string& username,
     LOG(ERROR) << "Pkcs11KeyStore: No token for user.";
     return false;
   }
-  ScopedSession session(slot);
+  ScopedSession session(this, slot);
   if (!session.IsValid()) {
     LOG(ERROR) << "Pkcs11KeyStore: Failed to open token session.";
     return false;
@@ -208,6 +249,7 @@ bool Pkcs11KeyStore::DeleteByPrefix(const std::string& username,
                  session.handle(), key_prefix);
   if (!EnumObjects(session.handle(), callback)) {
     LOG(ERROR) << "Pkcs11KeyStore: Failed to delete key data.";
+    session.Discard();
     return false;
   }
   return true;
@@ -222,8 +264,8 @@ bool Pkcs11KeyStore::Register(const std::string& username,
                               const std::string& certificate) {
   const CK_ATTRIBUTE_TYPE kKeyBlobAttribute = CKA_VENDOR_DEFINED + 1;
 
-  if (key_type != KEY_TYPE_RSA) {
-    LOG(ERROR) << "Pkcs11KeyStore: Only RSA supported.";
+  if (key_type != KEY_TYPE_RSA && key_type != KEY_TYPE_ECC) {
+    LOG(ERROR) << "Pkcs11KeyStore: Only RSA and ECC supported.";
     return false;
   }
   CK_SLOT_ID slot;
@@ -231,43 +273,43 @@ bool Pkcs11KeyStore::Register(const std::string& username,
     LOG(ERROR) << "Pkcs11KeyStore: No token for user.";
     return false;
   }
-  ScopedSession session(slot);
+  ScopedSession session(this, slot);
   if (!session.IsValid()) {
     LOG(ERROR) << "Pkcs11KeyStore: Failed to open token session.";
     return false;
   }
 
-  // Extract the modulus from the public key.
-  const unsigned char* asn1_ptr =
-      reinterpret_cast<const unsigned char*>(public_key_der.data());
-  crypto::ScopedRSA public_key(
-      d2i_RSAPublicKey(nullptr, &asn1_ptr, public_key_der.size()));
-  if (!public_key.get()) {
-    LOG(ERROR) << "Pkcs11KeyStore: Failed to decode public key.";
-    return false;
-  }
-  std::string modulus(BN_num_bytes(public_key.get()->n), 0);
-  int length =
-      BN_bn2bin(public_key.get()->n,
-                reinterpret_cast<unsigned char*>(string_as_array(&modulus)));
-  if (length <= 0) {
-    LOG(ERROR) << "Pkcs11KeyStore: Failed to extract public key modulus.";
-    return false;
+  // Extract the key material from the public key. RSA keys are identified by
+  // a hash of the modulus and ECC keys by a hash of the public point.
+  std::string modulus;
+  std::string ec_params;
+  std::string ec_point;
+  std::string id;
+  CK_KEY_TYPE p11_key_type;
+  if (key_type == KEY_TYPE_RSA) {
+    if (!GetRSAModulus(public_key_der, &modulus)) {
+      return false;
+    }
+    p11_key_type = CKK_RSA;
+    id = Sha1(modulus);
+  } else {
+    if (!GetECCParameters(public_key_der, &ec_params, &ec_point)) {
+      return false;
+    }
+    p11_key_type = CKK_EC;
+    id = Sha1(ec_point);
   }
-  modulus.resize(length);
 
   // Construct a PKCS #11 template for the public key object.
   CK_BBOOL true_value = CK_TRUE;
   CK_BBOOL false_value = CK_FALSE;
-  CK_KEY_TYPE p11_key_type = CKK_RSA;
   CK_OBJECT_CLASS public_key_class = CKO_PUBLIC_KEY;
-  std::string id = Sha1(modulus);
   std::string mutable_label(label);
   CK_ULONG modulus_bits = modulus.size() * 8;
   CK_BBOOL sign_usage = (key_usage == KEY_USAGE_SIGN);
   CK_BBOOL decrypt_usage = (key_usage == KEY_USAGE_DECRYPT);
   unsigned char public_exponent[] = {1, 0, 1};
-  CK_ATTRIBUTE public_key_attributes[] = {
+  std::vector<CK_ATTRIBUTE> public_key_attributes = {
       {CKA_CLASS, &public_key_class, sizeof(public_key_class)},
       {CKA_TOKEN, &true_value, sizeof(true_value)},
       {CKA_DERIVE, &false_value, sizeof(false_value)},
@@ -277,23 +319,34 @@ bool Pkcs11KeyStore::Register(const std::string& username,
       {CKA_ENCRYPT, &decrypt_usage, sizeof(decrypt_usage)},
       {CKA_KEY_TYPE, &p11_key_type, sizeof(p11_key_type)},
       {CKA_ID, string_as_array(&id), id.size()},
-      {CKA_LABEL, string_as_array(&mutable_label), mutable_label.size()},
-      {CKA_MODULUS_BITS, &modulus_bits, sizeof(modulus_bits)},
-      {CKA_PUBLIC_EXPONENT, public_exponent, arraysize(public_exponent)},
-      {CKA_MODULUS, string_as_array(&modulus), modulus.size()}};
+      {CKA_LABEL, string_as_array(&mutable_label), mutable_label.size()}};
+  if (key_type == KEY_TYPE_RSA) {
+    public_key_attributes.push_back(
+        {CKA_MODULUS_BITS, &modulus_bits, sizeof(modulus_bits)});
+    public_key_attributes.push_back(
+        {CKA_PUBLIC_EXPONENT, public_exponent, arraysize(public_exponent)});
+    public_key_attributes.push_back(
+        {CKA_MODULUS, string_as_array(&modulus), modulus.size()});
+  } else {
+    public_key_attributes.push_back(
+        {CKA_EC_PARAMS, string_as_array(&ec_params), ec_params.size()});
+    public_key_attributes.push_back(
+        {CKA_EC_POINT, string_as_array(&ec_point), ec_point.size()});
+  }
 
   CK_OBJECT_HANDLE object_handle = CK_INVALID_HANDLE;
-  if (C_CreateObject(session.handle(), public_key_attributes,
-                     arraysize(public_key_attributes),
+  if (C_CreateObject(session.handle(), public_key_attributes.data(),
+                     public_key_attributes.size(),
                      &object_handle) != CKR_OK) {
     LOG(ERROR) << "Pkcs11KeyStore: Failed to create public key object.";
+    session.Discard();
     return false;
   }
 
   // Construct a PKCS #11 template for the private key object.
   std::string mutable_private_key_blob(private_key_blob);
   CK_OBJECT_CLASS private_key_class = CKO_PRIVATE_KEY;
-  CK_ATTRIBUTE private_key_attributes[] = {
+  std::vector<CK_ATTRIBUTE> private_key_attributes = {
       {CKA_CLASS, &private_key_class, sizeof(private_key_class)},
       {CKA_TOKEN, &true_value, sizeof(true_value)},
       {CKA_PRIVATE, &true_value, sizeof(true_value)},
@@ -307,15 +360,23 @@ bool Pkcs11KeyStore::Register(const std::string& username,
       {CKA_KEY_TYPE, &p11_key_type, sizeof(p11_key_type)},
       {CKA_ID, string_as_array(&id), id.size()},
       {CKA_LABEL, string_as_array(&mutable_label), mutable_label.size()},
-      {CKA_PUBLIC_EXPONENT, public_exponent, arraysize(public_exponent)},
-      {CKA_MODULUS, string_as_array(&modulus), modulus.size()},
       {kKeyBlobAttribute, string_as_array(&mutable_private_key_blob),
        mutable_private_key_blob.size()}};
-
-  if (C_CreateObject(session.handle(), private_key_attributes,
-                     arraysize(private_key_attributes),
+  if (key_type == KEY_TYPE_RSA) {
+    private_key_attributes.push_back(
+        {CKA_PUBLIC_EXPONENT, public_exponent, arraysize(public_exponent)});
+    private_key_attributes.push_back(
+        {CKA_MODULUS, string_as_array(&modulus), modulus.size()});
+  } else {
+    private_key_attributes.push_back(
+        {CKA_EC_PARAMS, string_as_array(&ec_params), ec_params.size()});
+  }
+
+  if (C_CreateObject(session.handle(), private_key_attributes.data(),
+                     private_key_attributes.size(),
                      &object_handle) != CKR_OK) {
     LOG(ERROR) << "Pkcs11KeyStore: Failed to create private key object.";
+    session.Discard();
     return false;
   }
 
@@ -348,13 +409,16 @@ bool Pkcs11KeyStore::Register(const std::string& username,
                        arraysize(certificate_attributes),
                        &object_handle) != CKR_OK) {
       LOG(ERROR) << "Pkcs11KeyStore: Failed to create certificate object.";
+      session.Discard();
       return false;
     }
   }
 
   // Close all sessions in an attempt to trigger other modules to find the new
-  // objects.
+  // objects. This includes our own idle sessions.
   C_CloseAllSessions(slot);
+  session.Detach();
+  session_pool_.erase(slot);
 
   return true;
 }
@@ -366,7 +430,7 @@ bool Pkcs11KeyStore::RegisterCertificate(const std::string& username,
     LOG(ERROR) << "Pkcs11KeyStore: No token for user.";
     return false;
   }
-  ScopedSession session(slot);
+  ScopedSession session(this, slot);
   if (!session.IsValid()) {
     LOG(ERROR) << "Pkcs11KeyStore: Failed to open token session.";
     return false;
@@ -404,13 +468,20 @@ bool Pkcs11KeyStore::RegisterCertificate(const std::string& username,
                      arraysize(certificate_attributes),
                      &object_handle) != CKR_OK) {
     LOG(ERROR) << "Pkcs11KeyStore: Failed to create certificate object.";
+    session.Discard();
     return false;
   }
   return true;
 }
 
-CK_OBJECT_HANDLE Pkcs11KeyStore::FindObject(CK_SESSION_HANDLE session_handle,
-                                            const std::string& key_name) {
+bool Pkcs11KeyStore::IsAvailable(const std::string& username) {
+  CK_SLOT_ID slot;
+  return GetUserSlot(username, &slot);
+}
+
+bool Pkcs11KeyStore::FindObject(CK_SESSION_HANDLE session_handle,
+                                const std::string& key_name,
+                                CK_OBJECT_HANDLE* object_handle) {
   // Assemble a search template.
   std::string mutable_key_name(key_name);
   std::string mutable_application_id(kApplicationID);
@@ -427,16 +498,17 @@ CK_OBJECT_HANDLE Pkcs11KeyStore::FindObject(CK_SESSION_HANDLE session_handle,
       {CKA_MODIFIABLE, &false_value, sizeof(false_value)}};
   CK_OBJECT_HANDLE key_handle = CK_INVALID_HANDLE;
   CK_ULONG count = 0;
+  *object_handle = CK_INVALID_HANDLE;
   if ((C_FindObjectsInit(session_handle, attributes, arraysize(attributes)) !=
        CKR_OK) ||
       (C_FindObjects(session_handle, &key_handle, 1, &count) != CKR_OK) ||
       (C_FindObjectsFinal(session_handle) != CKR_OK)) {
     LOG(ERROR) << "Key search failed: " << key_name;
-    return CK_INVALID_HANDLE;
+    return false;
   }
   if (count == 1)
-    return key_handle;
-  return CK_INVALID_HANDLE;
+    *object_handle = key_handle;
+  return true;
 }
 
 bool Pkcs11KeyStore::GetUserSlot(const std::string& username,
@@ -448,10 +520,27 @@ bool Pkcs11KeyStore::GetUserSlot(const std::string& username,
           ? base::FilePath(kChapsSystemToken)
           : brillo::cryptohome::home::GetDaemonPath(username, kChapsDaemonName);
   CK_RV rv;
-  rv = C_Initialize(nullptr);
-  if (rv != CKR_OK && rv != CKR_CRYPTOKI_ALREADY_INITIALIZED) {
-    LOG(WARNING) << __func__ << ": C_Initialize failed.";
-    return false;
+  if (!is_initialized_) {
+    rv = C_Initialize(nullptr);
+    if (rv != CKR_OK && rv != CKR_CRYPTOKI_ALREADY_INITIALIZED) {
+      LOG(WARNING) << __func__ << ": C_Initialize failed.";
+      return false;
+    }
+    is_initialized_ = true;
+  }
+  PollSlotEvents();
+  auto cache_iter = slot_cache_.find(username);
+  if (cache_iter != slot_cache_.end()) {
+    // Unloading a token closes its sessions, so an idle session that is still
+    // open means the token has not been swapped since the slot was cached.
+    // Otherwise confirm the token is still in the slot with a single lookup.
+    CK_SLOT_ID cached_slot = cache_iter->second;
+    if (HasOpenIdleSession(cached_slot) ||
+        IsTokenInSlot(token_path, cached_slot)) {
+      *slot = cached_slot;
+      return true;
+    }
+    slot_cache_.erase(cache_iter);
   }
   CK_ULONG num_slots = 0;
   rv = C_GetSlotList(CK_TRUE, nullptr, &num_slots);
@@ -467,12 +556,9 @@ bool Pkcs11KeyStore::GetUserSlot(const std::string& username,
   }
   // Look through all slots for |token_path|.
   for (CK_ULONG i = 0; i < num_slots; ++i) {
-    base::FilePath slot_path;
-    if (token_manager_->GetTokenPath(
-            chaps::IsolateCredentialManager::GetDefaultIsolateCredential(),
-            slot_list[i], &slot_path) &&
-        (token_path == slot_path)) {
+    if (IsTokenInSlot(token_path, slot_list[i])) {
       *slot = slot_list[i];
+      slot_cache_[username] = slot_list[i];
       return true;
     }
   }
@@ -480,6 +566,104 @@ bool Pkcs11KeyStore::GetUserSlot(const std::string& username,
   return false;
 }
 
+bool Pkcs11KeyStore::IsTokenInSlot(const base::FilePath& token_path,
+                                   CK_SLOT_ID slot) {
+  base::FilePath slot_path;
+  return (token_manager_->GetTokenPath(
+              chaps::IsolateCredentialManager::GetDefaultIsolateCredential(),
+              slot, &slot_path) &&
+          (token_path == slot_path));
+}
+
+bool Pkcs11KeyStore::HasOpenIdleSession(CK_SLOT_ID slot) {
+  auto pool_iter = session_pool_.find(slot);
+  if (pool_iter == session_pool_.end() || pool_iter->second.empty()) {
+    return false;
+  }
+  CK_SESSION_INFO session_info;
+  if (C_GetSessionInfo(pool_iter->second.back(), &session_info) == CKR_OK) {
+    return true;
+  }
+  // The token was unloaded, taking the pooled sessions with it.
+  VLOG(1) << __func__ << ": Dropping stale sessions for slot " << slot;
+  for (CK_SESSION_HANDLE session_handle : pool_iter->second) {
+    C_CloseSession(session_handle);
+  }
+  session_pool_.erase(pool_iter);
+  return false;
+}
+
+void Pkcs11KeyStore::PollSlotEvents() {
+  if (!slot_events_supported_) {
+    return;
+  }
+  for (int i = 0; i < kMaxSlotEvents; ++i) {
+    CK_SLOT_ID slot = 0;
+    CK_RV rv = C_WaitForSlotEvent(CKF_DONT_BLOCK, &slot, nullptr);
+    if (rv == CKR_NO_EVENT) {
+      return;
+    }
+    if (rv != CKR_OK) {
+      // Without events, stale slots are only noticed when operations fail.
+      VLOG(1) << __func__ << ": Slot events not available.";
+      slot_events_supported_ = false;
+      return;
+    }
+    InvalidateSlot(slot);
+  }
+}
+
+void Pkcs11KeyStore::InvalidateSlot(CK_SLOT_ID slot) {
+  for (auto iter = slot_cache_.begin(); iter != slot_cache_.end();) {
+    if (iter->second == slot) {
+      iter = slot_cache_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  auto pool_iter = session_pool_.find(slot);
+  if (pool_iter == session_pool_.end()) {
+    return;
+  }
+  for (CK_SESSION_HANDLE session_handle : pool_iter->second) {
+    C_CloseSession(session_handle);
+  }
+  session_pool_.erase(pool_iter);
+}
+
+CK_SESSION_HANDLE Pkcs11KeyStore::AcquireSession(CK_SLOT_ID slot) {
+  std::vector<CK_SESSION_HANDLE>& idle_sessions = session_pool_[slot];
+  if (!idle_sessions.empty()) {
+    CK_SESSION_HANDLE session_handle = idle_sessions.back();
+    idle_sessions.pop_back();
+    return session_handle;
+  }
+  CK_SESSION_HANDLE session_handle = CK_INVALID_HANDLE;
+  CK_FLAGS flags = CKF_RW_SESSION | CKF_SERIAL_SESSION;
+  if (C_OpenSession(slot, flags, nullptr, nullptr, &session_handle) !=
+      CKR_OK) {
+    LOG(ERROR) << "Failed to open PKCS #11 session.";
+    InvalidateSlot(slot);
+    return CK_INVALID_HANDLE;
+  }
+  return session_handle;
+}
+
+void Pkcs11KeyStore::ReleaseSession(CK_SLOT_ID slot,
+                                    CK_SESSION_HANDLE session_handle,
+                                    bool reusable) {
+  if (reusable && session_pool_[slot].size() < kMaxIdleSessionsPerSlot) {
+    session_pool_[slot].push_back(session_handle);
+    return;
+  }
+  if (C_CloseSession(session_handle) != CKR_OK) {
+    LOG(WARNING) << "Failed to close PKCS #11 session.";
+  }
+  if (!reusable) {
+    InvalidateSlot(slot);
+  }
+}
+
 bool Pkcs11KeyStore::EnumObjects(
     CK_SESSION_HANDLE session_handle,
     const Pkcs11KeyStore::EnumObjectsCallback& callback) {
@@ -557,6 +741,82 @@ bool Pkcs11KeyStore::DeleteIfMatchesPrefix(CK_SESSION_HANDLE session_handle,
   return true;
 }
 
+bool Pkcs11KeyStore::GetRSAModulus(const std::string& public_key_der,
+                                   std::string* modulus) {
+  const unsigned char* asn1_ptr =
+      reinterpret_cast<const unsigned char*>(public_key_der.data());
+  crypto::ScopedRSA public_key(
+      d2i_RSAPublicKey(nullptr, &asn1_ptr, public_key_der.size()));
+  if (!public_key.get()) {
+    LOG(ERROR) << "Pkcs11KeyStore: Failed to decode public key.";
+    return false;
+  }
+  modulus->assign(BN_num_bytes(public_key.get()->n), 0);
+  int length =
+      BN_bn2bin(public_key.get()->n,
+                reinterpret_cast<unsigned char*>(string_as_array(modulus)));
+  if (length <= 0) {
+    LOG(ERROR) << "Pkcs11KeyStore: Failed to extract public key modulus.";
+    return false;
+  }
+  modulus->resize(length);
+  return true;
+}
+
+bool Pkcs11KeyStore::GetECCParameters(const std::string& public_key_der,
+                                      std::string* ec_params,
+                                      std::string* ec_point) {
+  const unsigned char* asn1_ptr =
+      reinterpret_cast<const unsigned char*>(public_key_der.data());
+  ScopedECKey public_key(
+      d2i_EC_PUBKEY(nullptr, &asn1_ptr, public_key_der.size()));
+  if (!public_key.get()) {
+    LOG(ERROR) << "Pkcs11KeyStore: Failed to decode public key.";
+    return false;
+  }
+  const EC_GROUP* group = EC_KEY_get0_group(public_key.get());
+  unsigned char* params_buffer = nullptr;
+  int length = i2d_ECPKParameters(group, &params_buffer);
+  crypto::ScopedOpenSSLBytes scoped_params_buffer(params_buffer);
+  if (length <= 0) {
+    LOG(ERROR) << "Pkcs11KeyStore: Failed to encode curve parameters.";
+    return false;
+  }
+  ec_params->assign(reinterpret_cast<char*>(params_buffer), length);
+
+  // CKA_EC_POINT holds the uncompressed point wrapped in an OCTET STRING.
+  std::string point(
+      EC_POINT_point2oct(group, EC_KEY_get0_public_key(public_key.get()),
+                         POINT_CONVERSION_UNCOMPRESSED, nullptr, 0, nullptr),
+      0);
+  if (point.empty() ||
+      EC_POINT_point2oct(
+          group, EC_KEY_get0_public_key(public_key.get()),
+          POINT_CONVERSION_UNCOMPRESSED,
+          reinterpret_cast<unsigned char*>(string_as_array(&point)),
+          point.size(), nullptr) != point.size()) {
+    LOG(ERROR) << "Pkcs11KeyStore: Failed to extract public point.";
+    return false;
+  }
+  ScopedOctetString octet_string(ASN1_OCTET_STRING_new());
+  if (!octet_string.get() ||
+      !ASN1_OCTET_STRING_set(
+          octet_string.get(),
+          reinterpret_cast<const unsigned char*>(point.data()), point.size())) {
+    LOG(ERROR) << "Pkcs11KeyStore: Failed to wrap public point.";
+    return false;
+  }
+  unsigned char* point_buffer = nullptr;
+  length = i2d_ASN1_OCTET_STRING(octet_string.get(), &point_buffer);
+  crypto::ScopedOpenSSLBytes scoped_point_buffer(point_buffer);
+  if (length <= 0) {
+    LOG(ERROR) << "Pkcs11KeyStore: Failed to encode public point.";
+    return false;
+  }
+  ec_point->assign(reinterpret_cast<char*>(point_buffer), length);
+  return true;
+}
+
 bool Pkcs11KeyStore::GetCertificateFields(const std::string& certificate,
                                           std::string* subject,
                                           std::string* issuer,
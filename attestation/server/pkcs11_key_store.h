@@ -19,9 +19,12 @@
 
 #include "attestation/server/key_store.h"
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include <base/callback_forward.h>
+#include <base/files/file_path.h>
 #include <base/macros.h>
 #include <chaps/pkcs11/cryptoki.h>
 #include <chaps/token_manager_client.h>
@@ -41,6 +44,12 @@ namespace attestation {
 // objects residing in the same token.  In practice, this means that any
 // component with access to the PKCS #11 token also has access to read or delete
 // key data.
+//
+// The slot holding each user's token is cached, and sessions are kept open in a
+// per-slot pool, so that repeated operations for a user do not have to
+// enumerate slots or open a new session each time. Cached slots are dropped
+// when the PKCS #11 module reports a slot event or when an operation in the
+// slot fails. This class is not thread-safe.
 class Pkcs11KeyStore : public KeyStore {
  public:
   // Does not take ownership of pointers.
@@ -67,21 +76,49 @@ class Pkcs11KeyStore : public KeyStore {
                 const std::string& certificate) override;
   bool RegisterCertificate(const std::string& username,
                            const std::string& certificate) override;
+  bool IsAvailable(const std::string& username) override;
 
  private:
+  friend class ScopedSession;
+
   using EnumObjectsCallback =
       base::Callback<bool(const std::string& key_name,
                           CK_OBJECT_HANDLE object_handle)>;
 
   // Searches for a PKCS #11 object for a given key name.  If one exists, the
-  // object handle is returned, otherwise CK_INVALID_HANDLE is returned.
-  CK_OBJECT_HANDLE FindObject(CK_SESSION_HANDLE session_handle,
-                              const std::string& key_name);
+  // object handle is assigned to |object_handle|, otherwise CK_INVALID_HANDLE
+  // is assigned. Returns false if the search itself failed.
+  bool FindObject(CK_SESSION_HANDLE session_handle,
+                  const std::string& key_name,
+                  CK_OBJECT_HANDLE* object_handle);
 
   // Gets a slot for the given |username| if |is_user_specific| or the system
   // slot otherwise. Returns false if no appropriate slot is found.
   bool GetUserSlot(const std::string& username, CK_SLOT_ID_PTR slot);
 
+  // Checks whether |slot| holds the token at |token_path|.
+  bool IsTokenInSlot(const base::FilePath& token_path, CK_SLOT_ID slot);
+
+  // Checks whether |slot| has a pooled idle session that is still open in the
+  // PKCS #11 module. Stale pooled sessions are dropped.
+  bool HasOpenIdleSession(CK_SLOT_ID slot);
+
+  // Drops cached slots for which the PKCS #11 module reports an event.
+  void PollSlotEvents();
+
+  // Forgets the cached slot assignment and closes the idle sessions of |slot|.
+  void InvalidateSlot(CK_SLOT_ID slot);
+
+  // Takes an idle session for |slot| from the pool, or opens a new read-write
+  // session. Returns CK_INVALID_HANDLE on failure.
+  CK_SESSION_HANDLE AcquireSession(CK_SLOT_ID slot);
+
+  // Returns |session_handle| to the pool for |slot| if it is |reusable|,
+  // otherwise closes it and invalidates the slot.
+  void ReleaseSession(CK_SLOT_ID slot,
+                      CK_SESSION_HANDLE session_handle,
+                      bool reusable);
+
   // Enumerates all PKCS #11 objects associated with keys.  The |callback| is
   // called once for each object.
   bool EnumObjects(CK_SESSION_HANDLE session_handle,
@@ -108,11 +145,31 @@ class Pkcs11KeyStore : public KeyStore {
                             std::string* issuer,
                             std::string* serial_number);
 
+  // Extracts the |modulus| from a PKCS #1 RSAPublicKey. Returns false if the
+  // key cannot be decoded.
+  bool GetRSAModulus(const std::string& public_key_der, std::string* modulus);
+
+  // Extracts the DER-encoded curve parameters and the DER-encoded OCTET STRING
+  // holding the uncompressed public point from an X.509 SubjectPublicKeyInfo.
+  // These are the CKA_EC_PARAMS and CKA_EC_POINT values. Returns false if the
+  // key cannot be decoded.
+  bool GetECCParameters(const std::string& public_key_der,
+                        std::string* ec_params,
+                        std::string* ec_point);
+
   // Returns true iff the given certificate already exists in the token.
   bool DoesCertificateExist(CK_SESSION_HANDLE session_handle,
                             const std::string& certificate);
 
   chaps::TokenManagerClient* token_manager_;
+  // Whether C_Initialize has succeeded.
+  bool is_initialized_;
+  // Whether the module supports non-blocking C_WaitForSlotEvent.
+  bool slot_events_supported_;
+  // Maps a username to the slot holding its token.
+  std::map<std::string, CK_SLOT_ID> slot_cache_;
+  // Idle read-write sessions for each slot.
+  std::map<CK_SLOT_ID, std::vector<CK_SESSION_HANDLE>> session_pool_;
 
   DISALLOW_COPY_AND_ASSIGN(Pkcs11KeyStore);
 };
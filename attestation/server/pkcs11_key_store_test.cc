@@ -55,6 +55,12 @@ const char kValidPublicKeyHex[] =
     "0203"
     "010001";
 
+// A NIST P-256 public key in X.509 SubjectPublicKeyInfo format.
+const char kValidECCPublicKeyHex[] =
+    "3059301306072A8648CE3D020106082A8648CE3D03010703420004"
+    "7B636AF187CACFF4AE833A92B92D79282969F1BBAEA9311936DDAC0ADE36937E"
+    "22A4397CACB91571B5F41A23BD48A1E350E339B4FE823B2083DA3B0506BD1959";
+
 const char kValidCertificateHex[] =
     "3082040f308202f7a003020102020900bd0f8fd6bf496b67300d06092a864886"
     "f70d01010b050030819d310b3009060355040613025553311330110603550408"
@@ -319,6 +325,7 @@ TEST(KeyStoreTest_NoMock, Pkcs11NotAvailable) {
 // non-error-handling code paths.
 TEST_F(KeyStoreTest, Pkcs11Success) {
   Pkcs11KeyStore key_store(&token_manager_);
+  EXPECT_TRUE(key_store.IsAvailable(kDefaultUser));
   std::string blob;
   EXPECT_FALSE(key_store.Read(kDefaultUser, "test", &blob));
   EXPECT_TRUE(key_store.Write(kDefaultUser, "test", "test_data"));
@@ -367,6 +374,62 @@ TEST_F(KeyStoreTest, Pkcs11Success_NoUser) {
   EXPECT_TRUE(key_store.Read("", "test", &blob));
 }
 
+// Tests that the user's slot is resolved and a session is opened only once
+// across operations.
+TEST_F(KeyStoreTest, SlotAndSessionAreReused) {
+  // The first lookup enumerates both slots; the user token is in slot 1.
+  EXPECT_CALL(pkcs11_, GetSlotList(_, _, _)).Times(2);
+  EXPECT_CALL(token_manager_, GetTokenPath(_, _, _)).Times(2);
+  EXPECT_CALL(pkcs11_, OpenSession(_, _, _, _)).Times(1);
+  EXPECT_CALL(pkcs11_, CloseSession(_, _)).Times(0);
+  Pkcs11KeyStore key_store(&token_manager_);
+  std::string blob;
+  EXPECT_TRUE(key_store.Write(kDefaultUser, "test", "test_data"));
+  EXPECT_TRUE(key_store.Read(kDefaultUser, "test", &blob));
+  EXPECT_EQ("test_data", blob);
+  EXPECT_TRUE(key_store.Write(kDefaultUser, "test", "test_data2"));
+  EXPECT_TRUE(key_store.Read(kDefaultUser, "test", &blob));
+  EXPECT_EQ("test_data2", blob);
+  EXPECT_TRUE(key_store.Delete(kDefaultUser, "test"));
+  EXPECT_FALSE(key_store.Read(kDefaultUser, "test", &blob));
+  testing::Mock::VerifyAndClearExpectations(&pkcs11_);
+}
+
+// Tests that a session is not reused after a PKCS #11 failure and that the
+// slot is looked up again.
+TEST_F(KeyStoreTest, FailedSessionIsNotReused) {
+  Pkcs11KeyStore key_store(&token_manager_);
+  EXPECT_TRUE(key_store.Write(kDefaultUser, "test", "test_data"));
+  // The failed session is closed, and later the pooled one at destruction.
+  EXPECT_CALL(pkcs11_, CloseSession(_, kSession)).Times(2);
+  EXPECT_CALL(pkcs11_, FindObjectsInit(_, _, _))
+      .WillOnce(Return(CKR_GENERAL_ERROR))
+      .WillRepeatedly(Invoke(this, &KeyStoreTest::FindObjectsInit));
+  std::string blob;
+  EXPECT_FALSE(key_store.Read(kDefaultUser, "test", &blob));
+  EXPECT_CALL(token_manager_, GetTokenPath(_, _, _)).Times(2);
+  EXPECT_CALL(pkcs11_, OpenSession(_, _, _, _)).Times(1);
+  EXPECT_TRUE(key_store.Read(kDefaultUser, "test", &blob));
+  EXPECT_EQ("test_data", blob);
+}
+
+// Tests that pooled sessions closed by a token swap are not trusted and that
+// the slot is checked again before it is reused.
+TEST_F(KeyStoreTest, SwappedTokenIsDetected) {
+  Pkcs11KeyStore key_store(&token_manager_);
+  EXPECT_TRUE(key_store.Write(kDefaultUser, "test", "test_data"));
+  EXPECT_CALL(pkcs11_, GetSessionInfo(_, kSession, _, _, _, _))
+      .WillOnce(Return(CKR_SESSION_HANDLE_INVALID));
+  // The stale session is closed, and later the new one at destruction.
+  EXPECT_CALL(pkcs11_, CloseSession(_, kSession)).Times(2);
+  // The cached slot is confirmed with a single lookup.
+  EXPECT_CALL(token_manager_, GetTokenPath(_, 1, _)).Times(1);
+  EXPECT_CALL(pkcs11_, OpenSession(_, _, _, _)).Times(1);
+  std::string blob;
+  EXPECT_TRUE(key_store.Read(kDefaultUser, "test", &blob));
+  EXPECT_EQ("test_data", blob);
+}
+
 // Tests the key store when PKCS #11 has no token for the given user.
 TEST_F(KeyStoreTest, TokenNotAvailable) {
   EXPECT_CALL(token_manager_, GetTokenPath(_, _, _))
@@ -377,6 +440,7 @@ TEST_F(KeyStoreTest, TokenNotAvailable) {
   EXPECT_FALSE(key_store.Write(kDefaultUser, "test", blob));
   EXPECT_FALSE(key_store.Read("", "test", &blob));
   EXPECT_FALSE(key_store.Write("", "test", blob));
+  EXPECT_FALSE(key_store.IsAvailable(kDefaultUser));
 }
 
 // Tests the key store when PKCS #11 fails to open a session.
@@ -422,24 +486,31 @@ TEST_F(KeyStoreTest, DeleteValueFail) {
 // Tests the key store when PKCS #11 fails to find objects.  Tests each part of
 // the multi-part find operation individually.
 TEST_F(KeyStoreTest, FindFail) {
-  EXPECT_CALL(pkcs11_, FindObjectsInit(_, _, _))
-      .WillRepeatedly(Return(CKR_GENERAL_ERROR));
   Pkcs11KeyStore key_store(&token_manager_);
   std::string blob;
   EXPECT_TRUE(key_store.Write(kDefaultUser, "test", "test_data"));
+
+  // A failed search must not go on to create objects with the failed session.
+  EXPECT_CALL(pkcs11_, CreateObject(_, _, _, _)).Times(0);
+  EXPECT_CALL(pkcs11_, FindObjectsInit(_, _, _))
+      .WillRepeatedly(Return(CKR_GENERAL_ERROR));
   EXPECT_FALSE(key_store.Read(kDefaultUser, "test", &blob));
+  EXPECT_FALSE(key_store.Write(kDefaultUser, "test", "test_data2"));
+  EXPECT_FALSE(key_store.Delete(kDefaultUser, "test"));
 
   EXPECT_CALL(pkcs11_, FindObjectsInit(_, _, _)).WillRepeatedly(Return(CKR_OK));
   EXPECT_CALL(pkcs11_, FindObjects(_, _, _, _))
       .WillRepeatedly(Return(CKR_GENERAL_ERROR));
-  EXPECT_TRUE(key_store.Write(kDefaultUser, "test", "test_data"));
   EXPECT_FALSE(key_store.Read(kDefaultUser, "test", &blob));
+  EXPECT_FALSE(key_store.Write(kDefaultUser, "test", "test_data2"));
+  EXPECT_FALSE(key_store.Delete(kDefaultUser, "test"));
 
   EXPECT_CALL(pkcs11_, FindObjects(_, _, _, _)).WillRepeatedly(Return(CKR_OK));
   EXPECT_CALL(pkcs11_, FindObjectsFinal(_, _))
       .WillRepeatedly(Return(CKR_GENERAL_ERROR));
-  EXPECT_TRUE(key_store.Write(kDefaultUser, "test", "test_data"));
   EXPECT_FALSE(key_store.Read(kDefaultUser, "test", &blob));
+  EXPECT_FALSE(key_store.Write(kDefaultUser, "test", "test_data2"));
+  EXPECT_FALSE(key_store.Delete(kDefaultUser, "test"));
 }
 
 // Tests the key store when PKCS #11 successfully finds zero objects.
@@ -507,6 +578,16 @@ TEST_F(KeyStoreTest, RegisterWithUnsupportedKeyType) {
                                   public_key_der, ""));
 }
 
+TEST_F(KeyStoreTest, RegisterECCKey) {
+  Pkcs11KeyStore key_store(&token_manager_);
+  EXPECT_CALL(pkcs11_, CreateObject(_, _, _, _))
+      .Times(2)  // Public, private (no certificate).
+      .WillRepeatedly(Return(CKR_OK));
+  EXPECT_TRUE(key_store.Register(kDefaultUser, "test_label", KEY_TYPE_ECC,
+                                 KEY_USAGE_SIGN, "private_key_blob",
+                                 HexDecode(kValidECCPublicKeyHex), ""));
+}
+
 TEST_F(KeyStoreTest, RegisterDecryptionKey) {
   EXPECT_CALL(pkcs11_, CreateObject(_, _, _, _)).WillRepeatedly(Return(CKR_OK));
   Pkcs11KeyStore key_store(&token_manager_);
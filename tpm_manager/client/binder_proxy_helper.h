@@ -82,6 +82,12 @@ class BinderProxyHelper {
       return android::binder::Status::ok();
     }
 
+    android::binder::Status OnTpmStatusChanged(
+        const std::vector<uint8_t>& snapshot_proto_data) override {
+      // Only sent to clients that subscribe to status changes.
+      return android::binder::Status::ok();
+    }
+
    private:
     CallbackType callback_;
     GetErrorResponseCallbackType get_error_response_;
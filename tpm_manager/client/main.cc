@@ -18,14 +18,21 @@
 #include <stdlib.h>
 #include <sysexits.h>
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <base/command_line.h>
 #include <base/files/file_util.h>
+#include <base/json/json_writer.h>
 #include <base/logging.h>
 #include <base/memory/ptr_util.h>
 #include <base/message_loop/message_loop.h>
+#include <base/strings/string_split.h>
+#include <base/strings/string_util.h>
+#include <base/time/time.h>
+#include <base/values.h>
 #include <brillo/bind_lambda.h>
 #if defined(USE_BINDER_IPC)
 #include <brillo/binder_watcher.h>
@@ -68,9 +75,19 @@ constexpr char kFileSwitch[] = "file";
 constexpr char kUseOwnerSwitch[] = "use_owner_authorization";
 constexpr char kLockRead[] = "lock_read";
 constexpr char kLockWrite[] = "lock_write";
+constexpr char kBatchSwitch[] = "batch";
+constexpr char kInFlightSwitch[] = "in_flight";
 
 constexpr char kUsage[] = R"(
 Usage: tpm_manager_client <command> [<arguments>]
+       tpm_manager_client --batch[=<command_file>] [--in_flight=<count>]
+Batch mode:
+  Reads one command with its arguments per line from |command_file|, or from
+  stdin if no file is given, and sends up to |count| (default 1) at a time.
+  Arguments may not contain whitespace. Empty lines and lines starting with '#'
+  are ignored. Each result is printed as a JSON line with the command, its
+  exit code, latency and either the reply or an error. Passwords are not
+  printed.
 Commands:
   status
       Prints TPM status information.
@@ -153,6 +170,23 @@ uint32_t StringToNvramIndex(const std::string& s) {
   return trunks::HR_HANDLE_MASK & StringToUint32(s);
 }
 
+// Returns the batch command |line| with the value of any --password switch
+// replaced, so that batch output doesn't reveal passwords.
+std::string RedactPassword(const std::string& line) {
+  const std::string password_switch = std::string(kPasswordSwitch) + "=";
+  std::vector<std::string> args = base::SplitString(
+      line, " \t", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  for (std::string& arg : args) {
+    size_t start = arg.find_first_not_of('-');
+    if (start > 0 && start <= 2 &&
+        arg.compare(start, password_switch.size(), password_switch) == 0) {
+      arg.replace(start + password_switch.size(), std::string::npos,
+                  "<redacted>");
+    }
+  }
+  return base::JoinString(args, " ");
+}
+
 using ClientLoopBase = brillo::Daemon;
 class ClientLoop : public ClientLoopBase {
  public:
@@ -191,7 +225,16 @@ class ClientLoop : public ClientLoopBase {
     }
     tpm_nvram_ = std::move(nvram_proxy);
     tpm_ownership_ = std::move(ownership_proxy);
-    exit_code = ScheduleCommand();
+    base::CommandLine* command_line = base::CommandLine::ForCurrentProcess();
+    if (command_line->HasSwitch(kBatchSwitch)) {
+      exit_code = ScheduleBatch(*command_line);
+    } else {
+      std::string error;
+      exit_code = ScheduleCommand(*command_line, 0, &error);
+      if (exit_code != EX_OK) {
+        LOG(ERROR) << error;
+      }
+    }
     if (exit_code == EX_USAGE) {
       printf("%s%s", kUsage, kKnownNVRAMSpaces);
     }
@@ -205,126 +248,269 @@ class ClientLoop : public ClientLoopBase {
   }
 
  private:
-  // Posts tasks on to the message loop based on command line flags.
-  int ScheduleCommand() {
+  // Posts a task on to the message loop to run the command given by
+  // |command_line|. The command is identified by |command_id| when it finishes.
+  // On failure, returns the exit code and sets |error| to the cause.
+  int ScheduleCommand(const base::CommandLine& command_line,
+                      int command_id,
+                      std::string* error) {
     base::Closure task;
-    base::CommandLine* command_line = base::CommandLine::ForCurrentProcess();
-    if (command_line->HasSwitch("help") || command_line->HasSwitch("h") ||
-        command_line->GetArgs().size() == 0) {
+    if (command_line.HasSwitch("help") || command_line.HasSwitch("h")) {
+      *error = "Help requested.";
+      return EX_USAGE;
+    }
+    if (command_line.GetArgs().size() == 0) {
+      *error = "No command given.";
       return EX_USAGE;
     }
-    std::string command = command_line->GetArgs()[0];
+    std::string command = command_line.GetArgs()[0];
     if (command == kGetTpmStatusCommand) {
       task = base::Bind(&ClientLoop::HandleGetTpmStatus,
-                        weak_factory_.GetWeakPtr());
+                        weak_factory_.GetWeakPtr(), command_id);
     } else if (command == kTakeOwnershipCommand) {
       task = base::Bind(&ClientLoop::HandleTakeOwnership,
-                        weak_factory_.GetWeakPtr());
+                        weak_factory_.GetWeakPtr(), command_id);
     } else if (command == kRemoveOwnerDependencyCommand) {
-      if (!command_line->HasSwitch(kDependencySwitch)) {
+      if (!command_line.HasSwitch(kDependencySwitch)) {
+        *error = command + " requires --dependency.";
         return EX_USAGE;
       }
       task = base::Bind(&ClientLoop::HandleRemoveOwnerDependency,
-                        weak_factory_.GetWeakPtr(),
-                        command_line->GetSwitchValueASCII(kDependencySwitch));
+                        weak_factory_.GetWeakPtr(), command_id,
+                        command_line.GetSwitchValueASCII(kDependencySwitch));
     } else if (command == kDefineSpaceCommand) {
-      if (!command_line->HasSwitch(kIndexSwitch) ||
-          !command_line->HasSwitch(kSizeSwitch)) {
+      if (!command_line.HasSwitch(kIndexSwitch) ||
+          !command_line.HasSwitch(kSizeSwitch)) {
+        *error = command + " requires --index and --size.";
         return EX_USAGE;
       }
       task = base::Bind(
           &ClientLoop::HandleDefineSpace, weak_factory_.GetWeakPtr(),
-          StringToNvramIndex(command_line->GetSwitchValueASCII(kIndexSwitch)),
-          StringToUint32(command_line->GetSwitchValueASCII(kSizeSwitch)),
-          command_line->GetSwitchValueASCII(kAttributesSwitch),
-          command_line->GetSwitchValueASCII(kPasswordSwitch),
-          command_line->HasSwitch(kBindToPCR0Switch));
+          command_id,
+          StringToNvramIndex(command_line.GetSwitchValueASCII(kIndexSwitch)),
+          StringToUint32(command_line.GetSwitchValueASCII(kSizeSwitch)),
+          command_line.GetSwitchValueASCII(kAttributesSwitch),
+          command_line.GetSwitchValueASCII(kPasswordSwitch),
+          command_line.HasSwitch(kBindToPCR0Switch));
     } else if (command == kDestroySpaceCommand) {
-      if (!command_line->HasSwitch(kIndexSwitch)) {
+      if (!command_line.HasSwitch(kIndexSwitch)) {
+        *error = command + " requires --index.";
         return EX_USAGE;
       }
       task = base::Bind(
           &ClientLoop::HandleDestroySpace, weak_factory_.GetWeakPtr(),
-          StringToNvramIndex(command_line->GetSwitchValueASCII(kIndexSwitch)));
+          command_id,
+          StringToNvramIndex(command_line.GetSwitchValueASCII(kIndexSwitch)));
     } else if (command == kWriteSpaceCommand) {
-      if (!command_line->HasSwitch(kIndexSwitch) ||
-          !command_line->HasSwitch(kFileSwitch)) {
+      if (!command_line.HasSwitch(kIndexSwitch) ||
+          !command_line.HasSwitch(kFileSwitch)) {
+        *error = command + " requires --index and --file.";
         return EX_USAGE;
       }
       task = base::Bind(
-          &ClientLoop::HandleWriteSpace, weak_factory_.GetWeakPtr(),
-          StringToNvramIndex(command_line->GetSwitchValueASCII(kIndexSwitch)),
-          command_line->GetSwitchValueASCII(kFileSwitch),
-          command_line->GetSwitchValueASCII(kPasswordSwitch),
-          command_line->HasSwitch(kUseOwnerSwitch));
+          &ClientLoop::HandleWriteSpace, weak_factory_.GetWeakPtr(), command_id,
+          StringToNvramIndex(command_line.GetSwitchValueASCII(kIndexSwitch)),
+          command_line.GetSwitchValueASCII(kFileSwitch),
+          command_line.GetSwitchValueASCII(kPasswordSwitch),
+          command_line.HasSwitch(kUseOwnerSwitch));
     } else if (command == kReadSpaceCommand) {
-      if (!command_line->HasSwitch(kIndexSwitch) ||
-          !command_line->HasSwitch(kFileSwitch)) {
+      if (!command_line.HasSwitch(kIndexSwitch) ||
+          !command_line.HasSwitch(kFileSwitch)) {
+        *error = command + " requires --index and --file.";
         return EX_USAGE;
       }
       task = base::Bind(
-          &ClientLoop::HandleReadSpace, weak_factory_.GetWeakPtr(),
-          StringToNvramIndex(command_line->GetSwitchValueASCII(kIndexSwitch)),
-          command_line->GetSwitchValueASCII(kFileSwitch),
-          command_line->GetSwitchValueASCII(kPasswordSwitch),
-          command_line->HasSwitch(kUseOwnerSwitch));
+          &ClientLoop::HandleReadSpace, weak_factory_.GetWeakPtr(), command_id,
+          StringToNvramIndex(command_line.GetSwitchValueASCII(kIndexSwitch)),
+          command_line.GetSwitchValueASCII(kFileSwitch),
+          command_line.GetSwitchValueASCII(kPasswordSwitch),
+          command_line.HasSwitch(kUseOwnerSwitch));
     } else if (command == kLockSpaceCommand) {
-      if (!command_line->HasSwitch(kIndexSwitch)) {
+      if (!command_line.HasSwitch(kIndexSwitch)) {
+        *error = command + " requires --index.";
         return EX_USAGE;
       }
       task = base::Bind(
-          &ClientLoop::HandleLockSpace, weak_factory_.GetWeakPtr(),
-          StringToNvramIndex(command_line->GetSwitchValueASCII(kIndexSwitch)),
-          command_line->HasSwitch(kLockRead),
-          command_line->HasSwitch(kLockWrite),
-          command_line->GetSwitchValueASCII(kPasswordSwitch),
-          command_line->HasSwitch(kUseOwnerSwitch));
+          &ClientLoop::HandleLockSpace, weak_factory_.GetWeakPtr(), command_id,
+          StringToNvramIndex(command_line.GetSwitchValueASCII(kIndexSwitch)),
+          command_line.HasSwitch(kLockRead),
+          command_line.HasSwitch(kLockWrite),
+          command_line.GetSwitchValueASCII(kPasswordSwitch),
+          command_line.HasSwitch(kUseOwnerSwitch));
     } else if (command == kListSpacesCommand) {
-      task =
-          base::Bind(&ClientLoop::HandleListSpaces, weak_factory_.GetWeakPtr());
+      task = base::Bind(&ClientLoop::HandleListSpaces,
+                        weak_factory_.GetWeakPtr(), command_id);
     } else if (command == kGetSpaceInfoCommand) {
-      if (!command_line->HasSwitch(kIndexSwitch)) {
+      if (!command_line.HasSwitch(kIndexSwitch)) {
+        *error = command + " requires --index.";
         return EX_USAGE;
       }
       task = base::Bind(
           &ClientLoop::HandleGetSpaceInfo, weak_factory_.GetWeakPtr(),
-          StringToNvramIndex(command_line->GetSwitchValueASCII(kIndexSwitch)));
+          command_id,
+          StringToNvramIndex(command_line.GetSwitchValueASCII(kIndexSwitch)));
     } else {
       // Command line arguments did not match any valid commands.
+      *error = "Unknown command: " + command;
       return EX_USAGE;
     }
     base::MessageLoop::current()->task_runner()->PostTask(FROM_HERE, task);
     return EX_OK;
   }
 
-  // Template to print reply protobuf.
+  // Reads the commands for --batch and posts a task to start them.
+  int ScheduleBatch(const base::CommandLine& command_line) {
+    std::string path = command_line.GetSwitchValueASCII(kBatchSwitch);
+    if (path.empty() || path == "-") {
+      path = "/dev/stdin";
+    }
+    std::string input;
+    if (!ReadFileToString(path, &input)) {
+      LOG(ERROR) << "Failed to read batch file: " << path;
+      return EX_NOINPUT;
+    }
+    for (const std::string& line : base::SplitString(
+             input, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+      if (line[0] != '#') {
+        batch_commands_.push_back(line);
+      }
+    }
+    if (command_line.HasSwitch(kInFlightSwitch)) {
+      max_in_flight_ =
+          StringToUint32(command_line.GetSwitchValueASCII(kInFlightSwitch));
+      if (max_in_flight_ == 0) {
+        return EX_USAGE;
+      }
+    }
+    batch_mode_ = true;
+    base::MessageLoop::current()->task_runner()->PostTask(
+        FROM_HERE, base::Bind(&ClientLoop::StartBatchCommands,
+                              weak_factory_.GetWeakPtr()));
+    return EX_OK;
+  }
+
+  // Starts batch commands until |max_in_flight_| are in flight, or quits if
+  // all commands have finished.
+  void StartBatchCommands() {
+    while (commands_in_flight_ < max_in_flight_ &&
+           next_batch_command_ < batch_commands_.size()) {
+      int command_id = next_batch_command_++;
+      ++commands_in_flight_;
+      start_times_[command_id] = base::TimeTicks::Now();
+      std::vector<std::string> argv = base::SplitString(
+          batch_commands_[command_id], " \t", base::TRIM_WHITESPACE,
+          base::SPLIT_WANT_NONEMPTY);
+      argv.insert(argv.begin(),
+                  base::CommandLine::ForCurrentProcess()->GetProgram().value());
+      std::string error;
+      int exit_code =
+          ScheduleCommand(base::CommandLine(argv), command_id, &error);
+      if (exit_code != EX_OK) {
+        FailCommand(command_id, exit_code, error);
+      }
+    }
+    if (commands_in_flight_ == 0) {
+      QuitWithExitCode(batch_exit_code_);
+    }
+  }
+
+  // Prints the result of batch command |command_id| as a JSON line and starts
+  // the next command. Exactly one of |reply| and |error| should be set.
+  void FinishBatchCommand(int command_id,
+                          int exit_code,
+                          const std::string& reply,
+                          const std::string& error) {
+    base::TimeDelta latency = base::TimeTicks::Now() - start_times_[command_id];
+    start_times_.erase(command_id);
+    base::DictionaryValue result;
+    result.SetInteger("id", command_id);
+    result.SetString("command", RedactPassword(batch_commands_[command_id]));
+    result.SetInteger("exit_code", exit_code);
+    result.SetDouble("latency_ms", latency.InMillisecondsF());
+    if (error.empty()) {
+      result.SetString("reply", reply);
+    } else {
+      result.SetString("error", error);
+    }
+    std::string json;
+    base::JSONWriter::Write(result, &json);
+    printf("%s\n", json.c_str());
+    fflush(stdout);
+    if (exit_code != EX_OK) {
+      batch_exit_code_ = exit_code;
+    }
+    --commands_in_flight_;
+    base::MessageLoop::current()->task_runner()->PostTask(
+        FROM_HERE, base::Bind(&ClientLoop::StartBatchCommands,
+                              weak_factory_.GetWeakPtr()));
+  }
+
+  // Template to print reply protobuf and finish command |command_id| with
+  // |exit_code|.
   template <typename ProtobufType>
-  void PrintReplyAndQuit(const ProtobufType& reply) {
+  void PrintReplyAndFinish(int command_id,
+                           int exit_code,
+                           const ProtobufType& reply) {
+    if (batch_mode_) {
+      FinishBatchCommand(command_id, exit_code, GetProtoDebugString(reply), "");
+      return;
+    }
     LOG(INFO) << "Message Reply: " << GetProtoDebugString(reply);
-    Quit();
+    QuitWithExitCode(exit_code);
+  }
+
+  // Prints a reply with a TpmManagerStatus |status| and finishes command
+  // |command_id|, failing it unless the status is STATUS_SUCCESS.
+  template <typename ProtobufType>
+  void FinishWithStatus(int command_id, const ProtobufType& reply) {
+    PrintReplyAndFinish(
+        command_id, reply.status() == STATUS_SUCCESS ? EX_OK : EX_SOFTWARE,
+        reply);
   }
 
-  void HandleGetTpmStatus() {
+  // Prints a reply with a NvramResult |result| and finishes command
+  // |command_id|, failing it unless the result is NVRAM_RESULT_SUCCESS.
+  template <typename ProtobufType>
+  void FinishWithResult(int command_id, const ProtobufType& reply) {
+    PrintReplyAndFinish(
+        command_id,
+        reply.result() == NVRAM_RESULT_SUCCESS ? EX_OK : EX_SOFTWARE, reply);
+  }
+
+  // Finishes command |command_id| without a reply because of |error|.
+  void FailCommand(int command_id, int exit_code, const std::string& error) {
+    if (batch_mode_) {
+      FinishBatchCommand(command_id, exit_code, "", error);
+      return;
+    }
+    LOG(ERROR) << error;
+    QuitWithExitCode(exit_code);
+  }
+
+  void HandleGetTpmStatus(int command_id) {
     GetTpmStatusRequest request;
     tpm_ownership_->GetTpmStatus(
-        request, base::Bind(&ClientLoop::PrintReplyAndQuit<GetTpmStatusReply>,
-                            weak_factory_.GetWeakPtr()));
+        request,
+        base::Bind(&ClientLoop::FinishWithStatus<GetTpmStatusReply>,
+                   weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void HandleTakeOwnership() {
+  void HandleTakeOwnership(int command_id) {
     TakeOwnershipRequest request;
     tpm_ownership_->TakeOwnership(
-        request, base::Bind(&ClientLoop::PrintReplyAndQuit<TakeOwnershipReply>,
-                            weak_factory_.GetWeakPtr()));
+        request,
+        base::Bind(&ClientLoop::FinishWithStatus<TakeOwnershipReply>,
+                   weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void HandleRemoveOwnerDependency(const std::string& owner_dependency) {
+  void HandleRemoveOwnerDependency(int command_id,
+                                   const std::string& owner_dependency) {
     RemoveOwnerDependencyRequest request;
     request.set_owner_dependency(owner_dependency);
     tpm_ownership_->RemoveOwnerDependency(
         request,
-        base::Bind(&ClientLoop::PrintReplyAndQuit<RemoveOwnerDependencyReply>,
-                   weak_factory_.GetWeakPtr()));
+        base::Bind(&ClientLoop::FinishWithStatus<RemoveOwnerDependencyReply>,
+                   weak_factory_.GetWeakPtr(), command_id));
   }
 
   bool DecodeAttribute(const std::string& attribute_str,
@@ -373,7 +559,8 @@ class ClientLoop : public ClientLoopBase {
     return false;
   }
 
-  void HandleDefineSpace(uint32_t index,
+  void HandleDefineSpace(int command_id,
+                         uint32_t index,
                          size_t size,
                          const std::string& attributes,
                          const std::string& password,
@@ -394,7 +581,7 @@ class ClientLoop : public ClientLoopBase {
       if (!attribute_str.empty()) {
         NvramSpaceAttribute attribute;
         if (!DecodeAttribute(attribute_str, &attribute)) {
-          Quit();
+          FailCommand(command_id, EX_USAGE, "Invalid attributes.");
           return;
         }
         request.add_attributes(attribute);
@@ -404,19 +591,20 @@ class ClientLoop : public ClientLoopBase {
     request.set_authorization_value(crypto::SHA256HashString(password));
     request.set_policy(bind_to_pcr0 ? NVRAM_POLICY_PCR0 : NVRAM_POLICY_NONE);
     tpm_nvram_->DefineSpace(
-        request, base::Bind(&ClientLoop::PrintReplyAndQuit<DefineSpaceReply>,
-                            weak_factory_.GetWeakPtr()));
+        request, base::Bind(&ClientLoop::FinishWithResult<DefineSpaceReply>,
+                            weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void HandleDestroySpace(uint32_t index) {
+  void HandleDestroySpace(int command_id, uint32_t index) {
     DestroySpaceRequest request;
     request.set_index(index);
     tpm_nvram_->DestroySpace(
-        request, base::Bind(&ClientLoop::PrintReplyAndQuit<DestroySpaceReply>,
-                            weak_factory_.GetWeakPtr()));
+        request, base::Bind(&ClientLoop::FinishWithResult<DestroySpaceReply>,
+                            weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void HandleWriteSpace(uint32_t index,
+  void HandleWriteSpace(int command_id,
+                        uint32_t index,
                         const std::string& input_file,
                         const std::string& password,
                         bool use_owner_authorization) {
@@ -424,28 +612,28 @@ class ClientLoop : public ClientLoopBase {
     request.set_index(index);
     std::string data;
     if (!ReadFileToString(input_file, &data)) {
-      LOG(ERROR) << "Failed to read input file.";
-      Quit();
+      FailCommand(command_id, EX_NOINPUT, "Failed to read input file.");
       return;
     }
     request.set_data(data);
     request.set_authorization_value(crypto::SHA256HashString(password));
     request.set_use_owner_authorization(use_owner_authorization);
     tpm_nvram_->WriteSpace(
-        request, base::Bind(&ClientLoop::PrintReplyAndQuit<WriteSpaceReply>,
-                            weak_factory_.GetWeakPtr()));
+        request, base::Bind(&ClientLoop::FinishWithResult<WriteSpaceReply>,
+                            weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void HandleReadSpaceReply(const std::string& output_file,
+  void HandleReadSpaceReply(int command_id,
+                            const std::string& output_file,
                             const ReadSpaceReply& reply) {
     if (!WriteStringToFile(reply.data(), output_file)) {
       LOG(ERROR) << "Failed to write output file.";
     }
-    LOG(INFO) << "Message Reply: " << GetProtoDebugString(reply);
-    Quit();
+    FinishWithResult(command_id, reply);
   }
 
-  void HandleReadSpace(uint32_t index,
+  void HandleReadSpace(int command_id,
+                       uint32_t index,
                        const std::string& output_file,
                        const std::string& password,
                        bool use_owner_authorization) {
@@ -453,12 +641,14 @@ class ClientLoop : public ClientLoopBase {
     request.set_index(index);
     request.set_authorization_value(crypto::SHA256HashString(password));
     request.set_use_owner_authorization(use_owner_authorization);
-    tpm_nvram_->ReadSpace(request,
-                          base::Bind(&ClientLoop::HandleReadSpaceReply,
-                                     weak_factory_.GetWeakPtr(), output_file));
+    tpm_nvram_->ReadSpace(
+        request, base::Bind(&ClientLoop::HandleReadSpaceReply,
+                            weak_factory_.GetWeakPtr(), command_id,
+                            output_file));
   }
 
-  void HandleLockSpace(uint32_t index,
+  void HandleLockSpace(int command_id,
+                       uint32_t index,
                        bool lock_read,
                        bool lock_write,
                        const std::string& password,
@@ -470,24 +660,26 @@ class ClientLoop : public ClientLoopBase {
     request.set_authorization_value(crypto::SHA256HashString(password));
     request.set_use_owner_authorization(use_owner_authorization);
     tpm_nvram_->LockSpace(
-        request, base::Bind(&ClientLoop::PrintReplyAndQuit<LockSpaceReply>,
-                            weak_factory_.GetWeakPtr()));
+        request, base::Bind(&ClientLoop::FinishWithResult<LockSpaceReply>,
+                            weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void HandleListSpaces() {
-    printf("%s\n", kKnownNVRAMSpaces);
+  void HandleListSpaces(int command_id) {
+    if (!batch_mode_) {
+      printf("%s\n", kKnownNVRAMSpaces);
+    }
     ListSpacesRequest request;
     tpm_nvram_->ListSpaces(
-        request, base::Bind(&ClientLoop::PrintReplyAndQuit<ListSpacesReply>,
-                            weak_factory_.GetWeakPtr()));
+        request, base::Bind(&ClientLoop::FinishWithResult<ListSpacesReply>,
+                            weak_factory_.GetWeakPtr(), command_id));
   }
 
-  void HandleGetSpaceInfo(uint32_t index) {
+  void HandleGetSpaceInfo(int command_id, uint32_t index) {
     GetSpaceInfoRequest request;
     request.set_index(index);
     tpm_nvram_->GetSpaceInfo(
-        request, base::Bind(&ClientLoop::PrintReplyAndQuit<GetSpaceInfoReply>,
-                            weak_factory_.GetWeakPtr()));
+        request, base::Bind(&ClientLoop::FinishWithResult<GetSpaceInfoReply>,
+                            weak_factory_.GetWeakPtr(), command_id));
   }
 
   // IPC proxy interfaces.
@@ -498,6 +690,16 @@ class ClientLoop : public ClientLoopBase {
   brillo::BinderWatcher binder_watcher_;
 #endif
 
+  // Batch mode state. Commands are identified by their index in
+  // |batch_commands_|.
+  bool batch_mode_ = false;
+  std::vector<std::string> batch_commands_;
+  size_t next_batch_command_ = 0;
+  size_t max_in_flight_ = 1;
+  size_t commands_in_flight_ = 0;
+  int batch_exit_code_ = EX_OK;
+  std::map<int, base::TimeTicks> start_times_;
+
   // Declared last so that weak pointers will be destroyed first.
   base::WeakPtrFactory<ClientLoop> weak_factory_{this};
 
@@ -35,6 +35,40 @@ void CreateErrorResponse(ResponseProtobufType* response) {
   response->set_status(tpm_manager::STATUS_DEVICE_ERROR);
 }
 
+// Runs a TpmStatusChangedCallback with each snapshot sent by the service.
+class TpmStatusObserver : public android::tpm_manager::BnTpmManagerClient {
+ public:
+  using CallbackType =
+      tpm_manager::TpmOwnershipInterface::TpmStatusChangedCallback;
+
+  explicit TpmStatusObserver(const CallbackType& callback)
+      : callback_(callback) {}
+  ~TpmStatusObserver() override = default;
+
+  // ITpmManagerClient interface.
+  android::binder::Status OnCommandResponse(
+      const std::vector<uint8_t>& response_proto_data) override {
+    // Not used for command responses.
+    return android::binder::Status::ok();
+  }
+
+  android::binder::Status OnTpmStatusChanged(
+      const std::vector<uint8_t>& snapshot_proto_data) override {
+    VLOG(2) << __func__;
+    tpm_manager::TpmStatusSnapshot snapshot;
+    if (!snapshot.ParseFromArray(snapshot_proto_data.data(),
+                                 snapshot_proto_data.size())) {
+      LOG(ERROR) << "TpmOwnershipBinderProxy: Bad status data.";
+      return android::binder::Status::ok();
+    }
+    callback_.Run(snapshot);
+    return android::binder::Status::ok();
+  }
+
+ private:
+  CallbackType callback_;
+};
+
 }  // namespace
 
 namespace tpm_manager {
@@ -93,4 +127,17 @@ void TpmOwnershipBinderProxy::RemoveOwnerDependency(
   helper.SendRequest(request);
 }
 
+void TpmOwnershipBinderProxy::SubscribeTpmStatus(
+    const TpmStatusChangedCallback& callback) {
+  android::sp<android::tpm_manager::ITpmManagerClient> observer(
+      new TpmStatusObserver(callback));
+  android::binder::Status status = binder_->SubscribeTpmStatus(observer);
+  if (!status.isOk()) {
+    LOG(ERROR) << "TpmOwnershipBinderProxy: Binder error: "
+               << status.toString8();
+    return;
+  }
+  status_observers_.push_back(observer);
+}
+
 }  // namespace tpm_manager
@@ -17,6 +17,8 @@
 #ifndef TPM_MANAGER_CLIENT_TPM_OWNERSHIP_BINDER_PROXY_H_
 #define TPM_MANAGER_CLIENT_TPM_OWNERSHIP_BINDER_PROXY_H_
 
+#include <vector>
+
 #include <base/macros.h>
 
 #include "android/tpm_manager/ITpmOwnership.h"
@@ -46,10 +48,13 @@ class TPM_MANAGER_EXPORT TpmOwnershipBinderProxy
   void RemoveOwnerDependency(
       const RemoveOwnerDependencyRequest& request,
       const RemoveOwnerDependencyCallback& callback) override;
+  void SubscribeTpmStatus(const TpmStatusChangedCallback& callback) override;
 
  private:
   android::sp<android::tpm_manager::ITpmOwnership> default_binder_;
   android::tpm_manager::ITpmOwnership* binder_ = nullptr;
+  std::vector<android::sp<android::tpm_manager::ITpmManagerClient>>
+      status_observers_;
 
   DISALLOW_COPY_AND_ASSIGN(TpmOwnershipBinderProxy);
 };
@@ -18,6 +18,7 @@
 
 #include <brillo/bind_lambda.h>
 #include <brillo/dbus/dbus_method_invoker.h>
+#include <brillo/dbus/dbus_signal_handler.h>
 
 #include "tpm_manager/common/tpm_manager_constants.h"
 #include "tpm_manager/common/tpm_ownership_dbus_interface.h"
@@ -66,6 +67,20 @@ void TpmOwnershipDBusProxy::RemoveOwnerDependency(
                                          request, callback);
 }
 
+void TpmOwnershipDBusProxy::SubscribeTpmStatus(
+    const TpmStatusChangedCallback& callback) {
+  auto on_connected = [](const std::string& interface_name,
+                         const std::string& signal_name, bool success) {
+    if (!success) {
+      LOG(ERROR) << "Failed to connect to signal " << interface_name << "."
+                 << signal_name;
+    }
+  };
+  brillo::dbus_utils::ConnectToSignal(
+      object_proxy_, tpm_manager::kTpmOwnershipInterface,
+      tpm_manager::kTpmStatusChanged, callback, base::Bind(on_connected));
+}
+
 template <typename ReplyProtobufType,
           typename RequestProtobufType,
           typename CallbackType>
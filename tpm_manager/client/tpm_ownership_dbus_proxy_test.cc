@@ -22,9 +22,11 @@
 #include <gtest/gtest.h>
 
 #include "tpm_manager/client/tpm_ownership_dbus_proxy.h"
+#include "tpm_manager/common/tpm_ownership_dbus_interface.h"
 
 using testing::_;
 using testing::Invoke;
+using testing::SaveArg;
 using testing::StrictMock;
 using testing::WithArgs;
 
@@ -150,4 +152,36 @@ TEST_F(TpmOwnershipDBusProxyTest, RemoveOwnerDependency) {
   EXPECT_EQ(1, callback_count);
 }
 
+TEST_F(TpmOwnershipDBusProxyTest, SubscribeTpmStatus) {
+  dbus::ObjectProxy::SignalCallback signal_callback;
+  EXPECT_CALL(*mock_object_proxy_,
+              ConnectToSignal(kTpmOwnershipInterface, kTpmStatusChanged, _, _))
+      .WillOnce(SaveArg<2>(&signal_callback));
+
+  // Set expectations on the outputs.
+  int callback_count = 0;
+  auto callback = [&callback_count](const TpmStatusSnapshot& snapshot) {
+    callback_count++;
+    EXPECT_EQ(2, snapshot.version());
+    EXPECT_TRUE(snapshot.status().owned());
+    EXPECT_EQ(3, snapshot.status().dictionary_attack_counter());
+    ASSERT_EQ(1, snapshot.nvram_index_size());
+    EXPECT_EQ(5, snapshot.nvram_index(0));
+  };
+  proxy_.SubscribeTpmStatus(base::Bind(callback));
+  ASSERT_FALSE(signal_callback.is_null());
+
+  // Emit a signal carrying a snapshot.
+  dbus::Signal signal(kTpmOwnershipInterface, kTpmStatusChanged);
+  dbus::MessageWriter writer(&signal);
+  TpmStatusSnapshot snapshot;
+  snapshot.set_version(2);
+  snapshot.mutable_status()->set_owned(true);
+  snapshot.mutable_status()->set_dictionary_attack_counter(3);
+  snapshot.add_nvram_index(5);
+  writer.AppendProtoAsArrayOfBytes(snapshot);
+  signal_callback.Run(&signal);
+  EXPECT_EQ(1, callback_count);
+}
+
 }  // namespace tpm_manager
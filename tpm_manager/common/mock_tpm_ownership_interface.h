@@ -37,6 +37,8 @@ class MockTpmOwnershipInterface : public TpmOwnershipInterface {
   MOCK_METHOD2(RemoveOwnerDependency,
                void(const RemoveOwnerDependencyRequest& request,
                     const RemoveOwnerDependencyCallback& callback));
+  MOCK_METHOD1(SubscribeTpmStatus,
+               void(const TpmStatusChangedCallback& callback));
 };
 
 }  // namespace tpm_manager
@@ -800,4 +800,46 @@ std::string GetProtoDebugStringWithIndent(
   return output;
 }
 
+std::string GetProtoDebugString(const TpmStatusSnapshot& value) {
+  return GetProtoDebugStringWithIndent(value, 0);
+}
+
+std::string GetProtoDebugStringWithIndent(const TpmStatusSnapshot& value,
+                                          int indent_size) {
+  std::string indent(indent_size, ' ');
+  std::string output =
+      base::StringPrintf("[%s] {\n", value.GetTypeName().c_str());
+
+  if (value.has_version()) {
+    output += indent + "  version: ";
+    base::StringAppendF(&output, "%u (0x%08X)", value.version(),
+                        value.version());
+    output += "\n";
+  }
+  if (value.has_status()) {
+    output += indent + "  status: ";
+    base::StringAppendF(
+        &output, "%s",
+        GetProtoDebugStringWithIndent(value.status(), indent_size + 2).c_str());
+    output += "\n";
+  }
+  output += indent + "  nvram_index: {";
+  for (int i = 0; i < value.nvram_index_size(); ++i) {
+    if (i > 0) {
+      base::StringAppendF(&output, ", ");
+    }
+    base::StringAppendF(&output, "%u (0x%08X)", value.nvram_index(i),
+                        value.nvram_index(i));
+  }
+  output += "}\n";
+  if (value.has_instance_id()) {
+    output += indent + "  instance_id: ";
+    base::StringAppendF(&output, "%lu (0x%016X)",
+                        value.instance_id(), value.instance_id());
+    output += "\n";
+  }
+  output += indent + "}\n";
+  return output;
+}
+
 }  // namespace tpm_manager
@@ -92,6 +92,9 @@ std::string GetProtoDebugStringWithIndent(
     const RemoveOwnerDependencyReply& value,
     int indent_size);
 std::string GetProtoDebugString(const RemoveOwnerDependencyReply& value);
+std::string GetProtoDebugStringWithIndent(const TpmStatusSnapshot& value,
+                                          int indent_size);
+std::string GetProtoDebugString(const TpmStatusSnapshot& value);
 
 }  // namespace tpm_manager
 
@@ -26,6 +26,9 @@ constexpr char kGetTpmStatus[] = "GetTpmStatus";
 constexpr char kTakeOwnership[] = "TakeOwnership";
 constexpr char kRemoveOwnerDependency[] = "RemoveOwnerDependency";
 
+// Signals emitted by tpm_manager ownership D-Bus interface.
+constexpr char kTpmStatusChanged[] = "TpmStatusChanged";
+
 }  // namespace tpm_manager
 
 #endif  // TPM_MANAGER_COMMON_TPM_OWNERSHIP_DBUS_INTERFACE_H_
@@ -48,6 +48,15 @@ class TPM_MANAGER_EXPORT TpmOwnershipInterface {
   virtual void RemoveOwnerDependency(
       const RemoveOwnerDependencyRequest& request,
       const RemoveOwnerDependencyCallback& callback) = 0;
+
+  // Registers |callback| to be run with a TpmStatusSnapshot each time the TPM
+  // status changes, so a caller can keep a local copy instead of polling
+  // GetTpmStatus. Snapshots are not sent for changes that happened before
+  // subscribing. Snapshot versions restart when tpm_managerd does; a client
+  // must replace its copy when the snapshot's instance_id changes.
+  using TpmStatusChangedCallback =
+      base::Callback<void(const TpmStatusSnapshot&)>;
+  virtual void SubscribeTpmStatus(const TpmStatusChangedCallback& callback) = 0;
 };
 
 }  // namespace tpm_manager
@@ -44,6 +44,19 @@ void ResponseHandler(
   }
 }
 
+// Sends a serialized TpmStatusSnapshot to |client|. Returns true on success.
+bool SendTpmStatusSnapshot(
+    const android::sp<android::tpm_manager::ITpmManagerClient>& client,
+    const std::vector<uint8_t>& snapshot) {
+  android::binder::Status status = client->OnTpmStatusChanged(snapshot);
+  if (!status.isOk()) {
+    LOG(ERROR) << "BinderService: Failed to send status to client: "
+               << status.toString8();
+    return false;
+  }
+  return true;
+}
+
 // Creates an error protobuf for NVRAM commands.
 template <typename ResponseProtobufType>
 void CreateNvramErrorResponse(ResponseProtobufType* proto) {
@@ -93,6 +106,9 @@ BinderService::BinderService(TpmNvramInterface* nvram_service,
 void BinderService::InitForTesting() {
   nvram_binder_ = new NvramServiceInternal(nvram_service_);
   ownership_binder_ = new OwnershipServiceInternal(ownership_service_);
+  ownership_service_->SubscribeTpmStatus(
+      base::Bind(&OwnershipServiceInternal::OnTpmStatusChanged,
+                 base::Unretained(ownership_binder_.get())));
 }
 
 int BinderService::OnInit() {
@@ -102,6 +118,9 @@ int BinderService::OnInit() {
   }
   nvram_binder_ = new NvramServiceInternal(nvram_service_);
   ownership_binder_ = new OwnershipServiceInternal(ownership_service_);
+  ownership_service_->SubscribeTpmStatus(
+      base::Bind(&OwnershipServiceInternal::OnTpmStatusChanged,
+                 base::Unretained(ownership_binder_.get())));
   if (!android::BinderWrapper::GetOrCreateInstance()->RegisterService(
           kTpmNvramBinderName, android::IInterface::asBinder(nvram_binder_))) {
     LOG(ERROR) << "BinderService: RegisterService failed (nvram).";
@@ -235,4 +254,31 @@ BinderService::OwnershipServiceInternal::RemoveOwnerDependency(
   return android::binder::Status::ok();
 }
 
+android::binder::Status
+BinderService::OwnershipServiceInternal::SubscribeTpmStatus(
+    const android::sp<android::tpm_manager::ITpmManagerClient>& client) {
+  if (!last_snapshot_.empty() &&
+      !SendTpmStatusSnapshot(client, last_snapshot_)) {
+    return android::binder::Status::ok();
+  }
+  subscribers_.push_back(client);
+  return android::binder::Status::ok();
+}
+
+void BinderService::OwnershipServiceInternal::OnTpmStatusChanged(
+    const TpmStatusSnapshot& snapshot) {
+  VLOG(2) << __func__;
+  last_snapshot_.resize(snapshot.ByteSize());
+  CHECK(snapshot.SerializeToArray(last_snapshot_.data(), last_snapshot_.size()))
+      << "BinderService: Failed to serialize protobuf.";
+  auto iter = subscribers_.begin();
+  while (iter != subscribers_.end()) {
+    if (SendTpmStatusSnapshot(*iter, last_snapshot_)) {
+      ++iter;
+    } else {
+      iter = subscribers_.erase(iter);
+    }
+  }
+}
+
 }  // namespace tpm_manager
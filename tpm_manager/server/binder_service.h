@@ -17,6 +17,8 @@
 #ifndef TPM_MANAGER_SERVER_BINDER_SERVICE_H_
 #define TPM_MANAGER_SERVER_BINDER_SERVICE_H_
 
+#include <vector>
+
 #include <brillo/binder_watcher.h>
 #include <brillo/daemons/daemon.h>
 
@@ -111,9 +113,21 @@ class BinderService : public brillo::Daemon {
         const std::vector<uint8_t>& command_proto,
         const android::sp<android::tpm_manager::ITpmManagerClient>& client)
         override;
+    android::binder::Status SubscribeTpmStatus(
+        const android::sp<android::tpm_manager::ITpmManagerClient>& client)
+        override;
+
+    // Sends |snapshot| to all subscribed clients.
+    void OnTpmStatusChanged(const TpmStatusSnapshot& snapshot);
 
    private:
     TpmOwnershipInterface* ownership_service_;
+    // Clients are removed when a snapshot cannot be sent to them.
+    std::vector<android::sp<android::tpm_manager::ITpmManagerClient>>
+        subscribers_;
+    // The last snapshot received, sent to new subscribers so they start with
+    // a current copy.
+    std::vector<uint8_t> last_snapshot_;
   };
 
   brillo::BinderWatcher watcher_;
@@ -15,6 +15,7 @@
 //
 
 #include <string>
+#include <vector>
 
 #include <brillo/bind_lambda.h>
 #include <gmock/gmock.h>
@@ -31,6 +32,7 @@ using testing::_;
 using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
+using testing::SaveArg;
 using testing::StrictMock;
 using testing::WithArgs;
 
@@ -42,6 +44,8 @@ class BinderServiceTest : public testing::Test {
  public:
   ~BinderServiceTest() override = default;
   void SetUp() override {
+    EXPECT_CALL(mock_ownership_service_, SubscribeTpmStatus(_))
+        .WillOnce(SaveArg<0>(&tpm_status_callback_));
     binder_service_.reset(
         new BinderService(&mock_nvram_service_, &mock_ownership_service_));
     binder_service_->InitForTesting();
@@ -64,6 +68,7 @@ class BinderServiceTest : public testing::Test {
  protected:
   StrictMock<MockTpmNvramInterface> mock_nvram_service_;
   StrictMock<MockTpmOwnershipInterface> mock_ownership_service_;
+  TpmOwnershipInterface::TpmStatusChangedCallback tpm_status_callback_;
   std::unique_ptr<BinderService> binder_service_;
   std::unique_ptr<TpmNvramBinderProxy> nvram_proxy_;
   std::unique_ptr<TpmOwnershipBinderProxy> ownership_proxy_;
@@ -149,6 +154,32 @@ TEST_F(BinderServiceTest, RemoveOwnerDependency) {
   EXPECT_EQ(STATUS_SUCCESS, reply.status());
 }
 
+TEST_F(BinderServiceTest, SubscribeTpmStatus) {
+  ASSERT_FALSE(tpm_status_callback_.is_null());
+  TpmStatusSnapshot snapshot;
+  snapshot.set_version(1);
+  snapshot.mutable_status()->set_owned(false);
+  tpm_status_callback_.Run(snapshot);
+  // A new subscriber first receives the last snapshot.
+  std::vector<TpmStatusSnapshot> received;
+  ownership_proxy_->SubscribeTpmStatus(base::Bind(
+      [](std::vector<TpmStatusSnapshot>* received,
+         const TpmStatusSnapshot& snapshot) { received->push_back(snapshot); },
+      base::Unretained(&received)));
+  ASSERT_EQ(1, received.size());
+  EXPECT_EQ(1, received[0].version());
+  EXPECT_FALSE(received[0].status().owned());
+  snapshot.set_version(2);
+  snapshot.mutable_status()->set_owned(true);
+  snapshot.add_nvram_index(5);
+  tpm_status_callback_.Run(snapshot);
+  ASSERT_EQ(2, received.size());
+  EXPECT_EQ(2, received[1].version());
+  EXPECT_TRUE(received[1].status().owned());
+  ASSERT_EQ(1, received[1].nvram_index_size());
+  EXPECT_EQ(5, received[1].nvram_index(0));
+}
+
 TEST_F(BinderServiceTest, DefineSpace) {
   uint32_t nvram_index = 5;
   size_t nvram_length = 32;
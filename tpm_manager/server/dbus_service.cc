@@ -78,6 +78,12 @@ void DBusService::RegisterDBusObjectsAsync(
           RemoveOwnerDependencyRequest, RemoveOwnerDependencyReply,
           &TpmOwnershipInterface::RemoveOwnerDependency>);
 
+  tpm_status_changed_signal_ =
+      ownership_dbus_interface->RegisterSignal<TpmStatusSnapshot>(
+          kTpmStatusChanged);
+  ownership_service_->SubscribeTpmStatus(base::Bind(
+      &DBusService::SendTpmStatusChangedSignal, base::Unretained(this)));
+
   brillo::dbus_utils::DBusInterface* nvram_dbus_interface =
       dbus_object_->AddOrGetInterface(kTpmNvramInterface);
 
@@ -122,6 +128,14 @@ void DBusService::RegisterDBusObjectsAsync(
       sequencer->GetHandler("Failed to register D-Bus object.", true));
 }
 
+void DBusService::SendTpmStatusChangedSignal(
+    const TpmStatusSnapshot& snapshot) {
+  auto signal = tpm_status_changed_signal_.lock();
+  if (!signal || !signal->Send(snapshot)) {
+    LOG(ERROR) << __func__ << ": Failed to send TpmStatusChanged signal.";
+  }
+}
+
 template <typename RequestProtobufType,
           typename ReplyProtobufType,
           DBusService::HandlerFunction<RequestProtobufType,
@@ -22,6 +22,7 @@
 #include <brillo/daemons/dbus_daemon.h>
 #include <brillo/dbus/dbus_method_response.h>
 #include <brillo/dbus/dbus_object.h>
+#include <brillo/dbus/dbus_signal.h>
 #include <dbus/bus.h>
 
 #include "tpm_manager/common/tpm_nvram_interface.h"
@@ -78,7 +79,12 @@ class DBusService : public brillo::DBusServiceDaemon {
       std::unique_ptr<DBusMethodResponse<const ReplyProtobufType&>> response,
       const RequestProtobufType& request);
 
+  // Emits |snapshot| as a TpmStatusChanged signal.
+  void SendTpmStatusChangedSignal(const TpmStatusSnapshot& snapshot);
+
   std::unique_ptr<brillo::dbus_utils::DBusObject> dbus_object_;
+  std::weak_ptr<brillo::dbus_utils::DBusSignal<TpmStatusSnapshot>>
+      tpm_status_changed_signal_;
   TpmNvramInterface* nvram_service_;
   TpmOwnershipInterface* ownership_service_;
   DISALLOW_COPY_AND_ASSIGN(DBusService);
@@ -34,6 +34,7 @@ using testing::_;
 using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
+using testing::SaveArg;
 using testing::StrictMock;
 using testing::WithArgs;
 
@@ -50,6 +51,8 @@ class DBusServiceTest : public testing::Test {
         new NiceMock<dbus::MockExportedObject>(mock_bus_.get(), path);
     ON_CALL(*mock_bus_, GetExportedObject(path))
         .WillByDefault(Return(mock_exported_object_.get()));
+    EXPECT_CALL(mock_ownership_service_, SubscribeTpmStatus(_))
+        .WillOnce(SaveArg<0>(&tpm_status_callback_));
     dbus_service_.reset(new DBusService(mock_bus_, &mock_nvram_service_,
                                         &mock_ownership_service_));
     scoped_refptr<brillo::dbus_utils::AsyncEventSequencer> sequencer(
@@ -86,6 +89,7 @@ class DBusServiceTest : public testing::Test {
   scoped_refptr<dbus::MockExportedObject> mock_exported_object_;
   StrictMock<MockTpmNvramInterface> mock_nvram_service_;
   StrictMock<MockTpmOwnershipInterface> mock_ownership_service_;
+  TpmOwnershipInterface::TpmStatusChangedCallback tpm_status_callback_;
   std::unique_ptr<DBusService> dbus_service_;
 };
 
@@ -166,6 +170,24 @@ TEST_F(DBusServiceTest, RemoveOwnerDependency) {
   EXPECT_EQ(STATUS_SUCCESS, reply.status());
 }
 
+TEST_F(DBusServiceTest, TpmStatusChangedSignal) {
+  EXPECT_CALL(*mock_exported_object_, SendSignal(_))
+      .WillOnce(Invoke([](dbus::Signal* signal) {
+        EXPECT_EQ(kTpmOwnershipInterface, signal->GetInterface());
+        EXPECT_EQ(kTpmStatusChanged, signal->GetMember());
+        dbus::MessageReader reader(signal);
+        TpmStatusSnapshot snapshot;
+        EXPECT_TRUE(reader.PopArrayOfBytesAsProto(&snapshot));
+        EXPECT_EQ(1, snapshot.version());
+        EXPECT_TRUE(snapshot.status().owned());
+      }));
+  ASSERT_FALSE(tpm_status_callback_.is_null());
+  TpmStatusSnapshot snapshot;
+  snapshot.set_version(1);
+  snapshot.mutable_status()->set_owned(true);
+  tpm_status_callback_.Run(snapshot);
+}
+
 TEST_F(DBusServiceTest, DefineSpace) {
   uint32_t nvram_index = 5;
   size_t nvram_length = 32;
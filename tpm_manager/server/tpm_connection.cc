@@ -16,6 +16,8 @@
 
 #include "tpm_manager/server/tpm_connection.h"
 
+#include <algorithm>
+
 #include <base/logging.h>
 #include <base/stl_util.h>
 #include <base/threading/platform_thread.h>
@@ -29,6 +31,7 @@ namespace {
 
 const int kTpmConnectRetries = 10;
 const int kTpmConnectIntervalMs = 100;
+const int kTpmReconnectMaxBackoffMs = 5000;
 
 }  // namespace
 
@@ -58,33 +61,53 @@ TSS_HTPM TpmConnection::GetTpm() {
   return tpm_handle;
 }
 
+void TpmConnection::Reset() {
+  context_.reset();
+}
+
 bool TpmConnection::ConnectContextIfNeeded() {
   if (context_.value() != 0) {
     return true;
   }
+  base::TimeTicks now = base::TimeTicks::Now();
+  if (has_connected_ && now < next_connect_time_) {
+    return false;
+  }
   TSS_RESULT result;
   if (TPM_ERROR(result = Tspi_Context_Create(context_.ptr()))) {
     TPM_LOG(ERROR, result) << "Error connecting to TPM.";
     return false;
   }
-  // We retry on failure. It might be that tcsd is starting up.
-  for (int i = 0; i < kTpmConnectRetries; i++) {
+  // Before the first connection we retry on failure. It might be that tcsd is
+  // starting up.
+  int attempts = has_connected_ ? 1 : kTpmConnectRetries;
+  for (int i = 0; i < attempts; i++) {
     if (TPM_ERROR(result = Tspi_Context_Connect(context_, nullptr))) {
-      if (ERROR_CODE(result) == TSS_E_COMM_FAILURE) {
-        base::PlatformThread::Sleep(
-            base::TimeDelta::FromMilliseconds(kTpmConnectIntervalMs));
-      } else {
+      if (ERROR_CODE(result) != TSS_E_COMM_FAILURE) {
         TPM_LOG(ERROR, result) << "Error connecting to TPM.";
+        context_.reset();
         return false;
       }
+      if (i + 1 < attempts) {
+        base::PlatformThread::Sleep(
+            base::TimeDelta::FromMilliseconds(kTpmConnectIntervalMs));
+      }
     } else {
       break;
     }
   }
-  if (context_.value() == 0) {
-    LOG(ERROR) << "Unexpected NULL context.";
+  if (TPM_ERROR(result)) {
+    TPM_LOG(ERROR, result) << "Error connecting to TPM.";
+    context_.reset();
+    connect_backoff_ = std::min(
+        std::max(connect_backoff_ * 2,
+                 base::TimeDelta::FromMilliseconds(kTpmConnectIntervalMs)),
+        base::TimeDelta::FromMilliseconds(kTpmReconnectMaxBackoffMs));
+    next_connect_time_ = now + connect_backoff_;
     return false;
   }
+  has_connected_ = true;
+  connect_backoff_ = base::TimeDelta();
   // If we don't need to set an authorization value, we're done.
   if (authorization_value_.empty()) {
     return true;
@@ -20,6 +20,7 @@
 #include <string>
 
 #include <base/macros.h>
+#include <base/time/time.h>
 #include <trousers/scoped_tss_type.h>
 
 namespace tpm_manager {
@@ -40,12 +41,23 @@ class TpmConnection {
   // This method tries to get a handle to the TPM. Returns 0 on failure.
   TSS_HTPM GetTpm();
 
+  // Closes the current context, e.g. after tcsd went away. All objects created
+  // in the context become invalid. The next call to GetContext() or GetTpm()
+  // reconnects.
+  void Reset();
+
  private:
-  // This method connects to the Tpm. Returns true on success.
+  // This method connects to the Tpm. Returns true on success. Until the first
+  // connection succeeds this waits for tcsd to start; after that a failed
+  // connect returns immediately and later attempts are backed off, so a tcsd
+  // restart does not stall the caller.
   bool ConnectContextIfNeeded();
 
   trousers::ScopedTssContext context_;
   std::string authorization_value_;
+  bool has_connected_ = false;
+  base::TimeDelta connect_backoff_;
+  base::TimeTicks next_connect_time_;
 
   DISALLOW_COPY_AND_ASSIGN(TpmConnection);
 };
@@ -18,8 +18,46 @@
 
 #include <base/callback.h>
 #include <base/command_line.h>
+#include <base/rand_util.h>
+#include <base/threading/thread_task_runner_handle.h>
+#include <base/time/time.h>
 #include <brillo/bind_lambda.h>
 
+namespace {
+
+// How long to wait for further changes before taking a TpmStatusSnapshot.
+constexpr int kTpmStatusCoalesceDelayMS = 100;
+
+// Returns a copy of |snapshot| without the fields that change without the TPM
+// status changing.
+tpm_manager::TpmStatusSnapshot GetComparableSnapshot(
+    const tpm_manager::TpmStatusSnapshot& snapshot) {
+  tpm_manager::TpmStatusSnapshot copy = snapshot;
+  copy.clear_version();
+  copy.mutable_status()->clear_dictionary_attack_lockout_seconds_remaining();
+  return copy;
+}
+
+// Returns true if |a| and |b| hold different TPM status.
+bool IsTpmStatusChanged(const tpm_manager::TpmStatusSnapshot& a,
+                        const tpm_manager::TpmStatusSnapshot& b) {
+  return GetComparableSnapshot(a).SerializeAsString() !=
+         GetComparableSnapshot(b).SerializeAsString();
+}
+
+// Removes the passwords from |status| so that it can be sent to subscribers.
+void ClearPasswords(tpm_manager::GetTpmStatusReply* status) {
+  if (!status->has_local_data()) {
+    return;
+  }
+  tpm_manager::LocalData* local_data = status->mutable_local_data();
+  local_data->clear_owner_password();
+  local_data->clear_endorsement_password();
+  local_data->clear_lockout_password();
+}
+
+}  // namespace
+
 namespace tpm_manager {
 
 TpmManagerService::TpmManagerService(bool wait_for_ownership,
@@ -32,9 +70,14 @@ TpmManagerService::TpmManagerService(bool wait_for_ownership,
       tpm_initializer_(tpm_initializer),
       tpm_nvram_(tpm_nvram),
       wait_for_ownership_(wait_for_ownership),
+      tpm_status_instance_id_(base::RandUint64()),
+      tpm_status_updates_enabled_(false),
+      tpm_status_update_pending_(false),
       weak_factory_(this) {}
 
 bool TpmManagerService::Initialize() {
+  main_task_runner_ = base::ThreadTaskRunnerHandle::Get();
+  main_thread_weak_ptr_ = weak_factory_.GetWeakPtr();
   worker_thread_.reset(new base::Thread("TpmManager Service Worker"));
   worker_thread_->StartWithOptions(
       base::Thread::Options(base::MessageLoop::TYPE_IO, 0));
@@ -71,6 +114,18 @@ void TpmManagerService::GetTpmStatusTask(
     const GetTpmStatusRequest& request,
     const std::shared_ptr<GetTpmStatusReply>& reply) {
   VLOG(1) << __func__;
+  ReadTpmStatus(reply.get());
+  // Catch changes that no task reported, like a dictionary attack counter
+  // increment caused by another TPM client.
+  TpmStatusSnapshot snapshot = last_tpm_status_;
+  *snapshot.mutable_status() = *reply;
+  ClearPasswords(snapshot.mutable_status());
+  if (IsTpmStatusChanged(snapshot, last_tpm_status_)) {
+    ScheduleTpmStatusUpdate();
+  }
+}
+
+void TpmManagerService::ReadTpmStatus(GetTpmStatusReply* reply) {
   reply->set_enabled(tpm_status_->IsTpmEnabled());
   reply->set_owned(tpm_status_->IsTpmOwned());
   LocalData local_data;
@@ -106,6 +161,8 @@ void TpmManagerService::TakeOwnershipTask(
     reply->set_status(STATUS_NOT_AVAILABLE);
     return;
   }
+  // The TPM may be partially initialized even on failure.
+  ScheduleTpmStatusUpdate();
   if (!tpm_initializer_->InitializeTpm()) {
     reply->set_status(STATUS_DEVICE_ERROR);
     return;
@@ -134,6 +191,7 @@ void TpmManagerService::RemoveOwnerDependencyTask(
     reply->set_status(STATUS_DEVICE_ERROR);
     return;
   }
+  ScheduleTpmStatusUpdate();
   reply->set_status(STATUS_SUCCESS);
 }
 
@@ -156,6 +214,16 @@ void TpmManagerService::RemoveOwnerDependency(
   }
 }
 
+void TpmManagerService::SubscribeTpmStatus(
+    const TpmStatusChangedCallback& callback) {
+  tpm_status_callbacks_.push_back(callback);
+  if (tpm_status_callbacks_.size() == 1) {
+    base::Closure task = base::Bind(
+        &TpmManagerService::EnableTpmStatusUpdatesTask, base::Unretained(this));
+    worker_thread_->task_runner()->PostTask(FROM_HERE, task);
+  }
+}
+
 void TpmManagerService::DefineSpace(const DefineSpaceRequest& request,
                                     const DefineSpaceCallback& callback) {
   PostTaskToWorkerThread<DefineSpaceReply>(request, callback,
@@ -173,6 +241,9 @@ void TpmManagerService::DefineSpaceTask(
   reply->set_result(
       tpm_nvram_->DefineSpace(request.index(), request.size(), attributes,
                               request.authorization_value(), request.policy()));
+  if (reply->result() == NVRAM_RESULT_SUCCESS) {
+    ScheduleTpmStatusUpdate();
+  }
 }
 
 void TpmManagerService::DestroySpace(const DestroySpaceRequest& request,
@@ -186,6 +257,9 @@ void TpmManagerService::DestroySpaceTask(
     const std::shared_ptr<DestroySpaceReply>& reply) {
   VLOG(1) << __func__;
   reply->set_result(tpm_nvram_->DestroySpace(request.index()));
+  if (reply->result() == NVRAM_RESULT_SUCCESS) {
+    ScheduleTpmStatusUpdate();
+  }
 }
 
 void TpmManagerService::WriteSpace(const WriteSpaceRequest& request,
@@ -208,6 +282,10 @@ void TpmManagerService::WriteSpaceTask(
   }
   reply->set_result(tpm_nvram_->WriteSpace(request.index(), request.data(),
                                            authorization_value));
+  if (reply->result() == NVRAM_RESULT_ACCESS_DENIED) {
+    // A bad authorization value increments the dictionary attack counter.
+    ScheduleTpmStatusUpdate();
+  }
 }
 
 void TpmManagerService::ReadSpace(const ReadSpaceRequest& request,
@@ -230,6 +308,10 @@ void TpmManagerService::ReadSpaceTask(
   }
   reply->set_result(tpm_nvram_->ReadSpace(
       request.index(), reply->mutable_data(), authorization_value));
+  if (reply->result() == NVRAM_RESULT_ACCESS_DENIED) {
+    // A bad authorization value increments the dictionary attack counter.
+    ScheduleTpmStatusUpdate();
+  }
 }
 
 void TpmManagerService::LockSpace(const LockSpaceRequest& request,
@@ -253,6 +335,10 @@ void TpmManagerService::LockSpaceTask(
   reply->set_result(tpm_nvram_->LockSpace(request.index(), request.lock_read(),
                                           request.lock_write(),
                                           authorization_value));
+  if (reply->result() == NVRAM_RESULT_ACCESS_DENIED) {
+    // A bad authorization value increments the dictionary attack counter.
+    ScheduleTpmStatusUpdate();
+  }
 }
 
 void TpmManagerService::ListSpaces(const ListSpacesRequest& request,
@@ -312,6 +398,65 @@ std::string TpmManagerService::GetOwnerPassword() {
   return std::string();
 }
 
+void TpmManagerService::EnableTpmStatusUpdatesTask() {
+  VLOG(1) << __func__;
+  tpm_status_updates_enabled_ = true;
+  // Give subscribers an initial snapshot.
+  ScheduleTpmStatusUpdate();
+}
+
+void TpmManagerService::ScheduleTpmStatusUpdate() {
+  if (!tpm_status_updates_enabled_ || tpm_status_update_pending_) {
+    return;
+  }
+  tpm_status_update_pending_ = true;
+  worker_thread_->task_runner()->PostDelayedTask(
+      FROM_HERE, base::Bind(&TpmManagerService::UpdateTpmStatusTask,
+                            base::Unretained(this)),
+      base::TimeDelta::FromMilliseconds(kTpmStatusCoalesceDelayMS));
+}
+
+void TpmManagerService::UpdateTpmStatusTask() {
+  VLOG(1) << __func__;
+  tpm_status_update_pending_ = false;
+  TpmStatusSnapshot snapshot;
+  snapshot.set_instance_id(tpm_status_instance_id_);
+  GetTpmStatusReply* status = snapshot.mutable_status();
+  ReadTpmStatus(status);
+  ClearPasswords(status);
+  std::vector<uint32_t> index_list;
+  if (status->enabled() &&
+      tpm_nvram_->ListSpaces(&index_list) == NVRAM_RESULT_SUCCESS) {
+    for (auto index : index_list) {
+      snapshot.add_nvram_index(index);
+    }
+  }
+  if (status->dictionary_attack_lockout_in_effect() &&
+      status->dictionary_attack_lockout_seconds_remaining() > 0) {
+    worker_thread_->task_runner()->PostDelayedTask(
+        FROM_HERE, base::Bind(&TpmManagerService::ScheduleTpmStatusUpdate,
+                              base::Unretained(this)),
+        base::TimeDelta::FromSeconds(
+            status->dictionary_attack_lockout_seconds_remaining()));
+  }
+  if (last_tpm_status_.has_version() &&
+      !IsTpmStatusChanged(snapshot, last_tpm_status_)) {
+    return;
+  }
+  snapshot.set_version(last_tpm_status_.version() + 1);
+  last_tpm_status_ = snapshot;
+  main_task_runner_->PostTask(
+      FROM_HERE, base::Bind(&TpmManagerService::NotifyTpmStatusChanged,
+                            main_thread_weak_ptr_, snapshot));
+}
+
+void TpmManagerService::NotifyTpmStatusChanged(
+    const TpmStatusSnapshot& snapshot) {
+  for (const auto& callback : tpm_status_callbacks_) {
+    callback.Run(snapshot);
+  }
+}
+
 template <typename ReplyProtobufType>
 void TpmManagerService::TaskRelayCallback(
     const base::Callback<void(const ReplyProtobufType&)> callback,
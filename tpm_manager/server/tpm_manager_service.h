@@ -18,10 +18,13 @@
 #define TPM_MANAGER_SERVER_TPM_MANAGER_SERVICE_H_
 
 #include <memory>
+#include <vector>
 
 #include <base/callback.h>
 #include <base/macros.h>
+#include <base/memory/ref_counted.h>
 #include <base/memory/weak_ptr.h>
+#include <base/single_thread_task_runner.h>
 #include <base/threading/thread.h>
 #include <brillo/bind_lambda.h>
 
@@ -53,6 +56,12 @@ namespace tpm_manager {
 // safe because the thread is owned by this class (so it is guaranteed not to
 // process a task after destruction). Weak pointers are used to post replies
 // back to the main thread.
+//
+// STATUS NOTIFICATIONS:
+// Tasks that may change the TPM status schedule a TpmStatusSnapshot to be
+// taken on the worker thread a short time later, so a burst of changes results
+// in a single snapshot. The snapshot is sent to subscribers on the main thread
+// only if it differs from the last one sent.
 class TpmManagerService : public TpmNvramInterface,
                           public TpmOwnershipInterface {
  public:
@@ -78,6 +87,7 @@ class TpmManagerService : public TpmNvramInterface,
   void RemoveOwnerDependency(
       const RemoveOwnerDependencyRequest& request,
       const RemoveOwnerDependencyCallback& callback) override;
+  void SubscribeTpmStatus(const TpmStatusChangedCallback& callback) override;
 
   // TpmNvramInterface methods.
   void DefineSpace(const DefineSpaceRequest& request,
@@ -181,6 +191,28 @@ class TpmManagerService : public TpmNvramInterface,
   // owner password is not available.
   std::string GetOwnerPassword();
 
+  // Reads the current TPM status into |reply|. Must be called on the worker
+  // thread.
+  void ReadTpmStatus(GetTpmStatusReply* reply);
+
+  // Starts taking TpmStatusSnapshots once the first subscriber is registered.
+  // The D-Bus and Binder services subscribe at startup, so this only holds
+  // snapshots back until one of them is ready to forward them.
+  void EnableTpmStatusUpdatesTask();
+
+  // Schedules UpdateTpmStatusTask after a change to the TPM status. Calls made
+  // while an update is pending are coalesced into that update. Must be called
+  // on the worker thread.
+  void ScheduleTpmStatusUpdate();
+
+  // Takes a TpmStatusSnapshot and, if it differs from the last snapshot taken,
+  // posts it to the main thread for subscribers. Also schedules an update for
+  // when a dictionary attack lockout is expected to end.
+  void UpdateTpmStatusTask();
+
+  // Runs all TpmStatusChangedCallbacks with |snapshot| on the main thread.
+  void NotifyTpmStatusChanged(const TpmStatusSnapshot& snapshot);
+
   LocalDataStore* local_data_store_;
   TpmStatus* tpm_status_;
   TpmInitializer* tpm_initializer_;
@@ -191,6 +223,21 @@ class TpmManagerService : public TpmNvramInterface,
   // Background thread to allow processing of potentially lengthy TPM requests
   // in the background.
   std::unique_ptr<base::Thread> worker_thread_;
+  // The thread that called Initialize(), on which subscribers are notified.
+  scoped_refptr<base::SingleThreadTaskRunner> main_task_runner_;
+  // A weak pointer to this instance that may be copied on the worker thread
+  // and dereferenced only on the main thread.
+  base::WeakPtr<TpmManagerService> main_thread_weak_ptr_;
+  // Subscribers to TPM status changes. Accessed only on the main thread.
+  std::vector<TpmStatusChangedCallback> tpm_status_callbacks_;
+  // The last snapshot taken, whether there are subscribers and whether an
+  // update is pending. Accessed only on the worker thread.
+  TpmStatusSnapshot last_tpm_status_;
+  // Set on every snapshot so clients can tell this instance's versions apart
+  // from those of an earlier tpm_managerd.
+  const uint64_t tpm_status_instance_id_;
+  bool tpm_status_updates_enabled_;
+  bool tpm_status_update_pending_;
   // Declared last so any weak pointers are destroyed first.
   base::WeakPtrFactory<TpmManagerService> weak_factory_;
 
@@ -338,6 +338,55 @@ TEST_F(TpmManagerServiceTest, RemoveOwnerDependencyNotPresent) {
   Run();
 }
 
+TEST_F(TpmManagerServiceTest, SubscribeTpmStatus) {
+  LocalData& local_data = mock_local_data_store_.GetMutableFakeData();
+  local_data.set_owner_password(kOwnerPassword);
+  local_data.add_owner_dependency(kOwnerDependency);
+  auto callback = [](decltype(this) test, const TpmStatusSnapshot& snapshot) {
+    EXPECT_EQ(1, snapshot.version());
+    EXPECT_TRUE(snapshot.status().enabled());
+    EXPECT_TRUE(snapshot.status().owned());
+    EXPECT_EQ(0, snapshot.status().dictionary_attack_counter());
+    EXPECT_EQ(10, snapshot.status().dictionary_attack_threshold());
+    EXPECT_FALSE(snapshot.status().dictionary_attack_lockout_in_effect());
+    const LocalData& local_data = snapshot.status().local_data();
+    EXPECT_FALSE(local_data.has_owner_password());
+    ASSERT_EQ(1, local_data.owner_dependency_size());
+    EXPECT_EQ(kOwnerDependency, local_data.owner_dependency(0));
+    EXPECT_EQ(0, snapshot.nvram_index_size());
+    test->Quit();
+  };
+  service_->SubscribeTpmStatus(base::Bind(callback, base::Unretained(this)));
+  Run();
+}
+
+TEST_F(TpmManagerServiceTest, SubscribeTpmStatusCoalesced) {
+  auto callback = [](decltype(this) test, const TpmStatusSnapshot& snapshot) {
+    static uint64_t instance_id = 0;
+    EXPECT_TRUE(snapshot.has_instance_id());
+    if (snapshot.version() == 1) {
+      instance_id = snapshot.instance_id();
+      // Both spaces should be reported by a single snapshot.
+      auto define_callback = [](const DefineSpaceReply& reply) {
+        EXPECT_EQ(NVRAM_RESULT_SUCCESS, reply.result());
+      };
+      DefineSpaceRequest request;
+      request.set_index(5);
+      request.set_size(32);
+      test->service_->DefineSpace(request, base::Bind(define_callback));
+      request.set_index(6);
+      test->service_->DefineSpace(request, base::Bind(define_callback));
+      return;
+    }
+    EXPECT_EQ(2, snapshot.version());
+    EXPECT_EQ(instance_id, snapshot.instance_id());
+    EXPECT_EQ(2, snapshot.nvram_index_size());
+    test->Quit();
+  };
+  service_->SubscribeTpmStatus(base::Bind(callback, base::Unretained(this)));
+  Run();
+}
+
 TEST_F(TpmManagerServiceTest, DefineSpaceFailure) {
   uint32_t nvram_index = 5;
   size_t nvram_size = 32;
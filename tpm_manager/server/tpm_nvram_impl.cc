@@ -19,10 +19,12 @@
 #include <arpa/inet.h>
 
 #include <string>
+#include <utility>
 
 #include <base/logging.h>
 #include <base/stl_util.h>
 #include <trousers/scoped_tss_type.h>
+#include <trousers/trousers.h>  // NOLINT(build/include_alpha)
 
 #include "tpm_manager/common/tpm_manager.pb.h"
 #include "tpm_manager/server/local_data_store.h"
@@ -103,6 +105,14 @@ TPM_NV_PER_ATTRIBUTES MapAttributesToTpm(
   return tpm_flags;
 }
 
+NvramSpacePolicy MapPolicyFromTpm(const TPM_NV_DATA_PUBLIC& info) {
+  if (info.pcrInfoWrite.pcrSelection.sizeOfSelect > 0 &&
+      (info.pcrInfoWrite.pcrSelection.pcrSelect[0] & 1) != 0) {
+    return NVRAM_POLICY_PCR0;
+  }
+  return NVRAM_POLICY_NONE;
+}
+
 NvramResult MapTpmError(TSS_RESULT tpm_error) {
   switch (TPM_ERROR(tpm_error)) {
     case TPM_SUCCESS:
@@ -142,6 +152,7 @@ NvramResult TpmNvramImpl::DefineSpace(
     const std::vector<NvramSpaceAttribute>& attributes,
     const std::string& authorization_value,
     NvramSpacePolicy policy) {
+  spaces_.erase(index);
   std::string owner_password;
   if (!GetOwnerPassword(&owner_password)) {
     return NVRAM_RESULT_OPERATION_DISABLED;
@@ -188,6 +199,7 @@ NvramResult TpmNvramImpl::DefineSpace(
 }
 
 NvramResult TpmNvramImpl::DestroySpace(uint32_t index) {
+  spaces_.erase(index);
   std::string owner_password;
   if (!GetOwnerPassword(&owner_password)) {
     return NVRAM_RESULT_OPERATION_DISABLED;
@@ -208,35 +220,21 @@ NvramResult TpmNvramImpl::DestroySpace(uint32_t index) {
 NvramResult TpmNvramImpl::WriteSpace(uint32_t index,
                                      const std::string& data,
                                      const std::string& authorization_value) {
-  std::vector<NvramSpaceAttribute> attributes;
-  NvramResult result =
-      GetSpaceInfo(index, nullptr, nullptr, nullptr, &attributes, nullptr);
-  if (result != NVRAM_RESULT_SUCCESS) {
+  NvramResult result;
+  NvramSpace* space = GetSpace(index, &result);
+  if (!space) {
     return result;
   }
-  ScopedTssNvStore nv_handle(tpm_connection_.GetContext());
-  if (!InitializeNvramHandle(index, &nv_handle, &tpm_connection_)) {
-    return NVRAM_RESULT_DEVICE_ERROR;
-  }
-  for (const auto& attribute : attributes) {
-    if (attribute == NVRAM_OWNER_WRITE) {
-      if (!SetOwnerPolicy(&nv_handle)) {
-        return NVRAM_RESULT_OPERATION_DISABLED;
-      }
-      break;
-    }
-    if (attribute == NVRAM_WRITE_AUTHORIZATION) {
-      if (!SetUsagePolicy(authorization_value, &nv_handle, &tpm_connection_)) {
-        return NVRAM_RESULT_DEVICE_ERROR;
-      }
-      break;
-    }
+  result = AuthorizeSpace(space, true /* write */, authorization_value);
+  if (result != NVRAM_RESULT_SUCCESS) {
+    return result;
   }
   TSS_RESULT tpm_result = Tspi_NV_WriteValue(
-      nv_handle, 0 /* offset */, data.size(),
+      space->nv_handle, 0 /* offset */, data.size(),
       reinterpret_cast<BYTE*>(const_cast<char*>(data.data())));
   if (TPM_ERROR(tpm_result)) {
     TPM_LOG(ERROR, tpm_result) << "Could not write to NVRAM space: " << index;
+    HandleSpaceError(index, tpm_result);
     return MapTpmError(tpm_result);
   }
   return NVRAM_RESULT_SUCCESS;
@@ -246,45 +244,32 @@ NvramResult TpmNvramImpl::ReadSpace(uint32_t index,
                                     std::string* data,
                                     const std::string& authorization_value) {
   CHECK(data);
-  size_t nvram_size;
-  std::vector<NvramSpaceAttribute> attributes;
-  NvramResult result =
-      GetSpaceInfo(index, &nvram_size, nullptr, nullptr, &attributes, nullptr);
-  if (result != NVRAM_RESULT_SUCCESS) {
+  NvramResult result;
+  NvramSpace* space = GetSpace(index, &result);
+  if (!space) {
     return result;
   }
-  ScopedTssNvStore nv_handle(tpm_connection_.GetContext());
-  if (!InitializeNvramHandle(index, &nv_handle, &tpm_connection_)) {
-    return NVRAM_RESULT_DEVICE_ERROR;
-  }
-  for (const auto& attribute : attributes) {
-    if (attribute == NVRAM_OWNER_READ) {
-      if (!SetOwnerPolicy(&nv_handle)) {
-        return NVRAM_RESULT_OPERATION_DISABLED;
-      }
-      break;
-    }
-    if (attribute == NVRAM_READ_AUTHORIZATION) {
-      if (!SetUsagePolicy(authorization_value, &nv_handle, &tpm_connection_)) {
-        return NVRAM_RESULT_DEVICE_ERROR;
-      }
-      break;
-    }
+  result = AuthorizeSpace(space, false /* write */, authorization_value);
+  if (result != NVRAM_RESULT_SUCCESS) {
+    return result;
   }
+  const size_t nvram_size = space->size;
   data->resize(nvram_size);
   // The Tpm1.2 Specification defines the maximum read size of 128 bytes.
-  // Therefore we have to loop through the data returned.
+  // Therefore we have to loop through the data returned. Every chunk is read
+  // through the same authorized handle.
   const size_t kMaxDataSize = 128;
   uint32_t offset = 0;
   while (offset < nvram_size) {
     uint32_t chunk_size = std::min(nvram_size - offset, kMaxDataSize);
     ScopedTssMemory space_data(tpm_connection_.GetContext());
-    TSS_RESULT tpm_result =
-        Tspi_NV_ReadValue(nv_handle, offset, &chunk_size, space_data.ptr());
+    TSS_RESULT tpm_result = Tspi_NV_ReadValue(space->nv_handle, offset,
+                                              &chunk_size, space_data.ptr());
     if (TPM_ERROR(tpm_result)) {
       TPM_LOG(ERROR, tpm_result) << "Could not read from NVRAM space: "
                                  << index;
       data->clear();
+      HandleSpaceError(index, tpm_result);
       return MapTpmError(tpm_result);
     }
     if (!space_data.value()) {
@@ -304,67 +289,39 @@ NvramResult TpmNvramImpl::LockSpace(uint32_t index,
                                     bool lock_read,
                                     bool lock_write,
                                     const std::string& authorization_value) {
-  std::vector<NvramSpaceAttribute> attributes;
-  NvramResult result =
-      GetSpaceInfo(index, nullptr, nullptr, nullptr, &attributes, nullptr);
-  if (result != NVRAM_RESULT_SUCCESS) {
+  NvramResult result;
+  NvramSpace* space = GetSpace(index, &result);
+  if (!space) {
     return result;
   }
   if (lock_read) {
-    ScopedTssNvStore nv_handle(tpm_connection_.GetContext());
-    if (!InitializeNvramHandle(index, &nv_handle, &tpm_connection_)) {
-      return NVRAM_RESULT_DEVICE_ERROR;
-    }
-    for (const auto& attribute : attributes) {
-      if (attribute == NVRAM_OWNER_READ) {
-        if (!SetOwnerPolicy(&nv_handle)) {
-          return NVRAM_RESULT_OPERATION_DISABLED;
-        }
-        break;
-      }
-      if (attribute == NVRAM_READ_AUTHORIZATION) {
-        if (!SetUsagePolicy(authorization_value, &nv_handle,
-                            &tpm_connection_)) {
-          return NVRAM_RESULT_DEVICE_ERROR;
-        }
-        break;
-      }
+    result = AuthorizeSpace(space, false /* write */, authorization_value);
+    if (result != NVRAM_RESULT_SUCCESS) {
+      return result;
     }
     uint32_t size = 0;
     ScopedTssMemory space_data(tpm_connection_.GetContext());
     TSS_RESULT tpm_result =
-        Tspi_NV_ReadValue(nv_handle, 0, &size, space_data.ptr());
+        Tspi_NV_ReadValue(space->nv_handle, 0, &size, space_data.ptr());
     if (TPM_ERROR(tpm_result)) {
       TPM_LOG(ERROR, tpm_result) << "Could not lock read for NVRAM space: "
                                  << index;
+      HandleSpaceError(index, tpm_result);
       return MapTpmError(tpm_result);
     }
   }
   if (lock_write) {
-    ScopedTssNvStore nv_handle(tpm_connection_.GetContext());
-    if (!InitializeNvramHandle(index, &nv_handle, &tpm_connection_)) {
-      return NVRAM_RESULT_DEVICE_ERROR;
-    }
-    for (const auto& attribute : attributes) {
-      if (attribute == NVRAM_OWNER_WRITE) {
-        if (!SetOwnerPolicy(&nv_handle)) {
-          return NVRAM_RESULT_OPERATION_DISABLED;
-        }
-        break;
-      }
-      if (attribute == NVRAM_WRITE_AUTHORIZATION) {
-        if (!SetUsagePolicy(authorization_value, &nv_handle,
-                            &tpm_connection_)) {
-          return NVRAM_RESULT_DEVICE_ERROR;
-        }
-        break;
-      }
+    result = AuthorizeSpace(space, true /* write */, authorization_value);
+    if (result != NVRAM_RESULT_SUCCESS) {
+      return result;
     }
     BYTE not_used;
-    TSS_RESULT tpm_result = Tspi_NV_WriteValue(nv_handle, 0, 0, &not_used);
+    TSS_RESULT tpm_result =
+        Tspi_NV_WriteValue(space->nv_handle, 0, 0, &not_used);
     if (TPM_ERROR(tpm_result)) {
       TPM_LOG(ERROR, tpm_result) << "Could not lock write for NVRAM space: "
                                  << index;
+      HandleSpaceError(index, tpm_result);
       return MapTpmError(tpm_result);
     }
   }
@@ -398,6 +355,64 @@ NvramResult TpmNvramImpl::GetSpaceInfo(
     bool* is_write_locked,
     std::vector<NvramSpaceAttribute>* attributes,
     NvramSpacePolicy* policy) {
+  NvramResult result;
+  if (is_read_locked || is_write_locked) {
+    // The lock state changes at runtime so it always comes from the TPM.
+    TPM_NV_DATA_PUBLIC info;
+    result = ReadSpacePublic(index, &info);
+    if (result != NVRAM_RESULT_SUCCESS) {
+      return result;
+    }
+    if (is_read_locked) {
+      *is_read_locked = info.bReadSTClear;
+    }
+    if (is_write_locked) {
+      *is_write_locked = info.bWriteSTClear || info.bWriteDefine;
+    }
+  }
+  NvramSpace* space = GetSpace(index, &result);
+  if (!space) {
+    return result;
+  }
+  if (size) {
+    *size = space->size;
+  }
+  if (attributes) {
+    MapAttributesFromTpm(space->attributes, attributes);
+  }
+  if (policy) {
+    *policy = space->policy;
+  }
+  return NVRAM_RESULT_SUCCESS;
+}
+
+TpmNvramImpl::NvramSpace* TpmNvramImpl::GetSpace(uint32_t index,
+                                                 NvramResult* result) {
+  auto iter = spaces_.find(index);
+  if (iter != spaces_.end()) {
+    return iter->second.get();
+  }
+  TPM_NV_DATA_PUBLIC info;
+  *result = ReadSpacePublic(index, &info);
+  if (*result != NVRAM_RESULT_SUCCESS) {
+    return nullptr;
+  }
+  std::unique_ptr<NvramSpace> space(
+      new NvramSpace(tpm_connection_.GetContext()));
+  if (!InitializeNvramHandle(index, &space->nv_handle, &tpm_connection_)) {
+    *result = NVRAM_RESULT_DEVICE_ERROR;
+    return nullptr;
+  }
+  space->size = info.dataSize;
+  space->attributes = info.permission.attributes;
+  space->policy = MapPolicyFromTpm(info);
+  NvramSpace* space_ptr = space.get();
+  spaces_[index] = std::move(space);
+  return space_ptr;
+}
+
+NvramResult TpmNvramImpl::ReadSpacePublic(uint32_t index,
+                                          TPM_NV_DATA_PUBLIC* info) {
   UINT32 nv_index_data_length = 0;
   ScopedTssMemory nv_index_data(tpm_connection_.GetContext());
   TSS_RESULT result =
@@ -406,6 +421,7 @@ NvramResult TpmNvramImpl::GetSpaceInfo(
                              &nv_index_data_length, nv_index_data.ptr());
   if (TPM_ERROR(result)) {
     TPM_LOG(ERROR, result) << "Error calling Tspi_TPM_GetCapability";
+    HandleSpaceError(index, result);
     return MapTpmError(result);
   }
   UINT64 offset = 0;
@@ -414,37 +430,75 @@ NvramResult TpmNvramImpl::GetSpaceInfo(
     LOG(ERROR) << "Not enough data from Tspi_TPM_GetCapability.";
     return NVRAM_RESULT_DEVICE_ERROR;
   }
-  TPM_NV_DATA_PUBLIC info;
   offset = 0;
   result =
-      Trspi_UnloadBlob_NV_DATA_PUBLIC(&offset, nv_index_data.value(), &info);
+      Trspi_UnloadBlob_NV_DATA_PUBLIC(&offset, nv_index_data.value(), info);
   if (TPM_ERROR(result)) {
     TPM_LOG(ERROR, result) << "Error calling Trspi_UnloadBlob_NV_DATA_PUBLIC";
     return NVRAM_RESULT_DEVICE_ERROR;
   }
-  if (size) {
-    *size = info.dataSize;
-  }
-  if (is_read_locked) {
-    *is_read_locked = info.bReadSTClear;
-  }
-  if (is_write_locked) {
-    *is_write_locked = info.bWriteSTClear || info.bWriteDefine;
-  }
-  if (attributes) {
-    MapAttributesFromTpm(info.permission.attributes, attributes);
+  return NVRAM_RESULT_SUCCESS;
+}
+
+NvramResult TpmNvramImpl::AuthorizeSpace(
+    NvramSpace* space,
+    bool write,
+    const std::string& authorization_value) {
+  TPM_NV_PER_ATTRIBUTES auth_flag =
+      write ? TPM_NV_PER_AUTHWRITE : TPM_NV_PER_AUTHREAD;
+  TPM_NV_PER_ATTRIBUTES owner_flag =
+      write ? TPM_NV_PER_OWNERWRITE : TPM_NV_PER_OWNERREAD;
+  std::string secret;
+  if (space->attributes & auth_flag) {
+    secret = authorization_value;
+  } else if (space->attributes & owner_flag) {
+    if (!GetOwnerPassword(&secret)) {
+      return NVRAM_RESULT_OPERATION_DISABLED;
+    }
+  } else {
+    return NVRAM_RESULT_SUCCESS;
   }
-  if (policy) {
-    if (info.pcrInfoWrite.pcrSelection.sizeOfSelect > 0 &&
-        (info.pcrInfoWrite.pcrSelection.pcrSelect[0] & 1) != 0) {
-      *policy = NVRAM_POLICY_PCR0;
-    } else {
-      *policy = NVRAM_POLICY_NONE;
+  TSS_RESULT result;
+  if (space->policy_handle.value() == 0) {
+    result = Tspi_Context_CreateObject(
+        tpm_connection_.GetContext(), TSS_OBJECT_TYPE_POLICY,
+        TSS_POLICY_USAGE, space->policy_handle.ptr());
+    if (TPM_ERROR(result)) {
+      TPM_LOG(ERROR, result) << "Error calling Tspi_Context_CreateObject";
+      return NVRAM_RESULT_DEVICE_ERROR;
+    }
+    result = Tspi_Policy_AssignToObject(space->policy_handle.value(),
+                                        space->nv_handle.value());
+    if (TPM_ERROR(result)) {
+      TPM_LOG(ERROR, result) << "Could not set NVRAM object policy.";
+      space->policy_handle.reset(tpm_connection_.GetContext(), 0);
+      return NVRAM_RESULT_DEVICE_ERROR;
     }
+  } else if (secret == space->policy_secret) {
+    return NVRAM_RESULT_SUCCESS;
+  }
+  result = Tspi_Policy_SetSecret(
+      space->policy_handle, TSS_SECRET_MODE_PLAIN, secret.size(),
+      reinterpret_cast<BYTE*>(const_cast<char*>(secret.data())));
+  if (TPM_ERROR(result)) {
+    TPM_LOG(ERROR, result) << "Error calling Tspi_Policy_SetSecret";
+    space->policy_handle.reset(tpm_connection_.GetContext(), 0);
+    return NVRAM_RESULT_DEVICE_ERROR;
   }
+  space->policy_secret = secret;
   return NVRAM_RESULT_SUCCESS;
 }
 
+void TpmNvramImpl::HandleSpaceError(uint32_t index, TSS_RESULT result) {
+  spaces_.erase(index);
+  if (ERROR_CODE(result) == TSS_E_COMM_FAILURE) {
+    // Objects in the old context are gone along with tcsd, so drop them before
+    // the context itself.
+    spaces_.clear();
+    tpm_connection_.Reset();
+  }
+}
+
 bool TpmNvramImpl::InitializeNvramHandle(uint32_t index,
                                          ScopedTssNvStore* nv_handle,
                                          TpmConnection* connection) {
@@ -463,14 +517,6 @@ bool TpmNvramImpl::InitializeNvramHandle(uint32_t index,
   return true;
 }
 
-bool TpmNvramImpl::SetOwnerPolicy(ScopedTssNvStore* nv_handle) {
-  std::string owner_password;
-  if (!GetOwnerPassword(&owner_password)) {
-    return false;
-  }
-  return SetUsagePolicy(owner_password, nv_handle, &tpm_connection_);
-}
-
 bool TpmNvramImpl::SetUsagePolicy(const std::string& authorization_value,
                                   trousers::ScopedTssNvStore* nv_handle,
                                   TpmConnection* connection) {
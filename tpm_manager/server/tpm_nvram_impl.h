@@ -21,6 +21,8 @@
 
 #include <stdint.h>
 
+#include <map>
+#include <memory>
 #include <string>
 
 #include <base/macros.h>
@@ -65,16 +67,46 @@ class TpmNvramImpl : public TpmNvram {
       NvramSpacePolicy* policy) override;
 
  private:
+  // Tspi objects and public data for an NVRAM space, created in the context of
+  // |tpm_connection_|. The size, attributes and policy of a space cannot change
+  // while it exists, so they are read from the TPM once.
+  struct NvramSpace {
+    explicit NvramSpace(TSS_HCONTEXT context)
+        : nv_handle(context), policy_handle(context) {}
+
+    trousers::ScopedTssNvStore nv_handle;
+    // The usage policy assigned to |nv_handle| and the secret it holds.
+    trousers::ScopedTssPolicy policy_handle;
+    std::string policy_secret;
+    size_t size = 0;
+    TPM_NV_PER_ATTRIBUTES attributes = 0;
+    NvramSpacePolicy policy = NVRAM_POLICY_NONE;
+  };
+
+  // Returns the cached space for |index|, setting it up on first use. Returns
+  // nullptr and sets |result| on failure.
+  NvramSpace* GetSpace(uint32_t index, NvramResult* result);
+
+  // Reads the public data of the space at |index| from the TPM.
+  NvramResult ReadSpacePublic(uint32_t index, TPM_NV_DATA_PUBLIC* info);
+
+  // Sets the secret needed to write |space| if |write| is true, or to read it
+  // otherwise, on the usage policy of |space|. The secret is the owner password
+  // or |authorization_value| depending on the space attributes.
+  NvramResult AuthorizeSpace(NvramSpace* space,
+                             bool write,
+                             const std::string& authorization_value);
+
+  // Drops the cached space for |index| after |result| was returned for it. If
+  // tcsd went away, all cached objects and the connection are dropped.
+  void HandleSpaceError(uint32_t index, TSS_RESULT result);
+
   // This method creates and initializes the nvram object associated with
   // |handle| at |index|. Returns true on success, else false.
   bool InitializeNvramHandle(uint32_t index,
                              trousers::ScopedTssNvStore* nv_handle,
                              TpmConnection* connection);
 
-  // This method injects a tpm policy with the owner password. Returns true
-  // on success.
-  bool SetOwnerPolicy(trousers::ScopedTssNvStore* nv_handle);
-
   // Set a usage policy for the handle with the given authorization_value.
   bool SetUsagePolicy(const std::string& authorization_value,
                       trousers::ScopedTssNvStore* nv_handle,
@@ -93,6 +125,8 @@ class TpmNvramImpl : public TpmNvram {
   LocalDataStore* local_data_store_;
   // A default non-owner connection.
   TpmConnection tpm_connection_;
+  // Spaces used through |tpm_connection_|, keyed by index.
+  std::map<uint32_t, std::unique_ptr<NvramSpace>> spaces_;
 
   DISALLOW_COPY_AND_ASSIGN(TpmNvramImpl);
 };
@@ -18,6 +18,7 @@
 #define TRUNKS_COMMAND_TRANSCEIVER_H_
 
 #include <string>
+#include <vector>
 
 #include <base/callback_forward.h>
 
@@ -43,6 +44,19 @@ class CommandTransceiver {
   // with a well-formed error response.
   virtual std::string SendCommandAndWait(const std::string& command) = 0;
 
+  // Sends each of |commands| synchronously and returns the responses in the
+  // same order. Transceivers that can keep several commands in flight override
+  // this, so the commands must not depend on each other's responses. By
+  // default each command waits for the previous response.
+  virtual std::vector<std::string> SendCommandsAndWait(
+      const std::vector<std::string>& commands) {
+    std::vector<std::string> responses;
+    for (const auto& command : commands) {
+      responses.push_back(SendCommandAndWait(command));
+    }
+    return responses;
+  }
+
   // Initializes the actual interface, replaced by the derived classes, where
   // needed.
   virtual bool Init() { return true; }
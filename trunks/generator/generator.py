@@ -108,13 +108,16 @@ _HEADER_FILE_GUARD_FOOTER = """
 """
 _HEADER_FILE_INCLUDES = """
 #include <string>
+#include <vector>
 
 #include <base/callback_forward.h>
 #include <base/macros.h>
+#include <base/time/time.h>
 
 #include "trunks/trunks_export.h"
 """
 _IMPLEMENTATION_FILE_INCLUDES = """
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -123,7 +126,6 @@ _IMPLEMENTATION_FILE_INCLUDES = """
 #include <base/logging.h>
 #include <base/macros.h>
 #include <base/stl_util.h>
-#include <base/strings/string_number_conversions.h>
 #include <base/sys_byteorder.h>
 #include <crypto/secure_hash.h>
 
@@ -131,6 +133,14 @@ _IMPLEMENTATION_FILE_INCLUDES = """
 #include "trunks/command_transceiver.h"
 #include "trunks/error_codes.h"
 
+// The marshaling functions run for every field of every command, so their
+// per-function traces are compiled in only when TRUNKS_MARSHALING_VLOG is
+// defined. Use SetTpmTraceHook() to trace whole commands.
+#if defined(TRUNKS_MARSHALING_VLOG)
+#define MARSHALING_VLOG(verbose_level) VLOG(verbose_level)
+#else
+#define MARSHALING_VLOG(verbose_level) EAT_STREAM_PARAMETERS
+#endif
 """
 _LOCAL_INCLUDE = """
 #include "trunks/%(filename)s"
@@ -146,8 +156,69 @@ class AuthorizationDelegate;
 class CommandTransceiver;
 """
 _FUNCTION_DECLARATIONS = """
+// How long a command typically keeps the TPM busy.
+enum class TpmCommandLatency : uint8_t {
+  // Bookkeeping, reads and symmetric operations on small inputs.
+  kShort,
+  // Operations with a loaded asymmetric key, and everything else that is
+  // neither short nor long, e.g. HierarchyControl and NV writes.
+  kMedium,
+  // Key generation, seed changes (Clear, ChangeEPS, ChangePPS), self tests,
+  // Startup and field upgrades.
+  kLong,
+};
+
+// Static facts about a TPM command.
+struct TpmCommandInfo {
+  TPM_CC code;
+  uint8_t request_handles;
+  uint8_t response_handles;
+  // Whether the first command or response parameter is a TPM2B, i.e. whether
+  // it can be encrypted by a session.
+  bool command_encryption_possible;
+  bool response_encryption_possible;
+  // Whether the command leaves objects, NV indexes, PCRs, the clock and
+  // hierarchy settings unchanged. Session state may still change.
+  bool read_only;
+  // Bit i is set if request handle i is flushed when the command succeeds.
+  uint8_t invalidated_handles;
+  TpmCommandLatency latency;
+};
+
+// Returns the entry for |command_code| or nullptr if the command is unknown.
+TRUNKS_EXPORT const TpmCommandInfo* GetCommandInfo(TPM_CC command_code);
 TRUNKS_EXPORT size_t GetNumberOfRequestHandles(TPM_CC command_code);
 TRUNKS_EXPORT size_t GetNumberOfResponseHandles(TPM_CC command_code);
+
+// Describes the marshaling of one command or response by the Tpm class.
+struct TpmTraceEvent {
+  enum Stage {
+    // Tpm::SerializeCommand_*.
+    kSerializeCommand,
+    // Tpm::ParseResponse_*.
+    kParseResponse,
+  };
+  Stage stage;
+  TPM_CC command_code;
+  // The serialized command or the response, or nullptr if the command could
+  // not be serialized. Valid only while the hook runs.
+  const std::string* data;
+  // The size of |data| in bytes, or zero if |data| is nullptr.
+  size_t size;
+  // The response code in the response header, or TPM_RC_SUCCESS if it could
+  // not be parsed or |stage| is kSerializeCommand.
+  TPM_RC response_code;
+  // Time spent in the serialize or parse function.
+  base::TimeDelta elapsed;
+};
+
+typedef void (*TpmTraceHook)(const TpmTraceEvent& event);
+
+// Installs |hook| to be called after every command is serialized and every
+// response is parsed, or removes the hook if |hook| is nullptr. The hook runs
+// on the calling thread. Without a hook, tracing costs one atomic load per
+// serialize or parse call.
+TRUNKS_EXPORT void SetTpmTraceHook(TpmTraceHook hook);
 """
 _CLASS_BEGIN = """
 class TRUNKS_EXPORT Tpm {
@@ -156,6 +227,20 @@ class TRUNKS_EXPORT Tpm {
   explicit Tpm(CommandTransceiver* transceiver) : transceiver_(transceiver) {}
   virtual ~Tpm() {}
 
+  // Sends each of the serialized |commands| and returns the responses in the
+  // same order. The transceiver may keep several commands in flight, so the
+  // commands must not depend on each other's responses, e.g. through session
+  // nonces.
+  virtual std::vector<std::string> SendCommandsAndWait(
+      const std::vector<std::string>& commands);
+
+"""
+_SEND_COMMANDS_FUNCTION = """
+std::vector<std::string> Tpm::SendCommandsAndWait(
+    const std::vector<std::string>& commands) {
+  VLOG(1) << __func__ << ": " << commands.size() << " commands";
+  return transceiver_->SendCommandsAndWait(commands);
+}
 """
 _CLASS_END = """
  private:
@@ -166,7 +251,7 @@ _CLASS_END = """
 """
 _SERIALIZE_BASIC_TYPE = """
 TPM_RC Serialize_%(type)s(const %(type)s& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   %(type)s value_net = value;
   switch (sizeof(%(type)s)) {
     case 2:
@@ -190,7 +275,7 @@ TPM_RC Parse_%(type)s(
     std::string* buffer,
     %(type)s* value,
     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   if (buffer->size() < sizeof(%(type)s))
     return TPM_RC_INSUFFICIENT;
   %(type)s value_net = 0;
@@ -237,17 +322,148 @@ TRUNKS_EXPORT %(type)s Make_%(type)s(
     const %(inner_type)s& inner);
 """
 
-_HANDLE_COUNT_FUNCTION_START = """
+_COMMAND_INFO_TABLE_START = """
+namespace {
+
+// Indexed by |command_code - TPM_CC_FIRST|. Entries for unassigned command
+// codes are zero.
+constexpr TpmCommandInfo kCommandInfo[] = {"""
+_COMMAND_INFO_TABLE_ENTRY = """
+    {%(command_code)s, %(request_handles)d, %(response_handles)d,
+     %(command_encryption)s, %(response_encryption)s, %(read_only)s,
+     0x%(invalidated_handles)02X, TpmCommandLatency::%(latency)s},"""
+_COMMAND_INFO_TABLE_GAP = """
+    {},"""
+_COMMAND_INFO_TABLE_END = """
+};
+static_assert(arraysize(kCommandInfo) == TPM_CC_LAST - TPM_CC_FIRST + 1,
+              "kCommandInfo must cover every command code.");
+
+}  // namespace
+
+const TpmCommandInfo* GetCommandInfo(TPM_CC command_code) {
+  if (command_code < TPM_CC_FIRST || command_code > TPM_CC_LAST) {
+    return nullptr;
+  }
+  const TpmCommandInfo* info = &kCommandInfo[command_code - TPM_CC_FIRST];
+  if (info->code != command_code) {
+    return nullptr;
+  }
+  return info;
+}
+"""
+_TRACE_IMPLEMENTATION = """
+namespace {
+
+std::atomic<TpmTraceHook> g_trace_hook(nullptr);
+
+// Reports a TpmTraceEvent when it goes out of scope if a trace hook was
+// installed when it was constructed.
+class ScopedTpmTrace {
+ public:
+  ScopedTpmTrace(TpmTraceEvent::Stage stage, TPM_CC command_code)
+      : hook_(g_trace_hook.load(std::memory_order_relaxed)) {
+    if (hook_) {
+      event_.stage = stage;
+      event_.command_code = command_code;
+      start_time_ = base::TimeTicks::Now();
+    }
+  }
+
+  ~ScopedTpmTrace() {
+    if (hook_) {
+      event_.elapsed = base::TimeTicks::Now() - start_time_;
+      hook_(event_);
+    }
+  }
+
+  void set_data(const std::string* data) {
+    event_.data = data;
+    event_.size = data->size();
+  }
+
+  void set_response_code(TPM_RC response_code) {
+    event_.response_code = response_code;
+  }
+
+ private:
+  const TpmTraceHook hook_;
+  TpmTraceEvent event_ = {};
+  base::TimeTicks start_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedTpmTrace);
+};
+
+}  // namespace
+
+void SetTpmTraceHook(TpmTraceHook hook) {
+  g_trace_hook.store(hook, std::memory_order_relaxed);
+}
+"""
+_HANDLE_COUNT_FUNCTION = """
 size_t GetNumberOf%(handle_type)sHandles(TPM_CC command_code) {
-  switch (command_code) {"""
-_HANDLE_COUNT_FUNCTION_CASE = """
-    case %(command_code)s: return %(handle_count)s;"""
-_HANDLE_COUNT_FUNCTION_END = """
-    default: LOG(WARNING) << "Unknown command code: " << command_code;
+  const TpmCommandInfo* info = GetCommandInfo(command_code);
+  if (!info) {
+    LOG(WARNING) << "Unknown command code: " << command_code;
+    return 0;
   }
-  return 0;
+  return info->%(handle_field)s;
 }
 """
+# Commands which leave objects, NV indexes, PCRs, the clock and hierarchy
+# settings unchanged. These facts are not part of the command syntax so they
+# are maintained by hand.
+_READ_ONLY_COMMANDS = set([
+    'TPM_CC_ActivateCredential', 'TPM_CC_Certify', 'TPM_CC_CertifyCreation',
+    'TPM_CC_Create', 'TPM_CC_Duplicate', 'TPM_CC_ECC_Parameters',
+    'TPM_CC_ECDH_KeyGen', 'TPM_CC_ECDH_ZGen', 'TPM_CC_EncryptDecrypt',
+    'TPM_CC_FirmwareRead', 'TPM_CC_GetCapability', 'TPM_CC_GetRandom',
+    'TPM_CC_GetSessionAuditDigest', 'TPM_CC_GetTestResult', 'TPM_CC_GetTime',
+    'TPM_CC_HMAC', 'TPM_CC_Hash', 'TPM_CC_Import', 'TPM_CC_MakeCredential',
+    'TPM_CC_NV_Certify', 'TPM_CC_NV_Read', 'TPM_CC_NV_ReadPublic',
+    'TPM_CC_PCR_Read', 'TPM_CC_PolicyAuthValue', 'TPM_CC_PolicyAuthorize',
+    'TPM_CC_PolicyCommandCode', 'TPM_CC_PolicyCounterTimer',
+    'TPM_CC_PolicyCpHash', 'TPM_CC_PolicyDuplicationSelect',
+    'TPM_CC_PolicyGetDigest', 'TPM_CC_PolicyLocality', 'TPM_CC_PolicyNV',
+    'TPM_CC_PolicyNameHash', 'TPM_CC_PolicyNvWritten', 'TPM_CC_PolicyOR',
+    'TPM_CC_PolicyPCR', 'TPM_CC_PolicyPassword',
+    'TPM_CC_PolicyPhysicalPresence', 'TPM_CC_PolicyRestart',
+    'TPM_CC_PolicySecret', 'TPM_CC_PolicySigned', 'TPM_CC_PolicyTicket',
+    'TPM_CC_Quote', 'TPM_CC_RSA_Decrypt', 'TPM_CC_RSA_Encrypt',
+    'TPM_CC_ReadClock', 'TPM_CC_ReadPublic', 'TPM_CC_Rewrap', 'TPM_CC_Sign',
+    'TPM_CC_TestParms', 'TPM_CC_Unseal', 'TPM_CC_VerifySignature',
+])
+# Commands which typically take hundreds of milliseconds or more.
+_LONG_LATENCY_COMMANDS = set([
+    'TPM_CC_ChangeEPS', 'TPM_CC_ChangePPS', 'TPM_CC_Clear', 'TPM_CC_Create',
+    'TPM_CC_CreatePrimary', 'TPM_CC_FieldUpgradeData',
+    'TPM_CC_FieldUpgradeStart', 'TPM_CC_IncrementalSelfTest',
+    'TPM_CC_SelfTest', 'TPM_CC_Startup',
+])
+# Commands which do not use an asymmetric key. Anything that is neither short
+# nor long is medium.
+_SHORT_LATENCY_COMMANDS = set([
+    'TPM_CC_ContextLoad', 'TPM_CC_ContextSave', 'TPM_CC_EncryptDecrypt',
+    'TPM_CC_EventSequenceComplete', 'TPM_CC_FlushContext',
+    'TPM_CC_GetCapability', 'TPM_CC_GetRandom', 'TPM_CC_GetTestResult',
+    'TPM_CC_HMAC', 'TPM_CC_HMAC_Start', 'TPM_CC_Hash',
+    'TPM_CC_HashSequenceStart', 'TPM_CC_NV_Read', 'TPM_CC_NV_ReadPublic',
+    'TPM_CC_PCR_Event', 'TPM_CC_PCR_Extend', 'TPM_CC_PCR_Read',
+    'TPM_CC_PolicyAuthValue', 'TPM_CC_PolicyCommandCode',
+    'TPM_CC_PolicyCpHash', 'TPM_CC_PolicyGetDigest', 'TPM_CC_PolicyLocality',
+    'TPM_CC_PolicyNameHash', 'TPM_CC_PolicyOR', 'TPM_CC_PolicyPCR',
+    'TPM_CC_PolicyPassword', 'TPM_CC_PolicyRestart', 'TPM_CC_ReadClock',
+    'TPM_CC_ReadPublic', 'TPM_CC_SequenceComplete', 'TPM_CC_SequenceUpdate',
+    'TPM_CC_StirRandom', 'TPM_CC_TestParms', 'TPM_CC_Unseal',
+])
+# Request handle positions which are flushed by a successful command. The
+# handle of TPM2_FlushContext is a parameter and is not listed here.
+_INVALIDATED_HANDLES = {
+    'TPM_CC_EventSequenceComplete': [1],
+    'TPM_CC_NV_UndefineSpace': [1],
+    'TPM_CC_NV_UndefineSpaceSpecial': [0],
+    'TPM_CC_SequenceComplete': [0],
+}
 
 def FixName(name):
   """Fixes names to conform to Chromium style."""
@@ -283,7 +499,7 @@ class Typedef(object):
 TPM_RC Serialize_%(new)s(
     const %(new)s& value,
     std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_%(old)s(value, buffer);
 }
 """
@@ -292,7 +508,7 @@ TPM_RC Parse_%(new)s(
     std::string* buffer,
     %(new)s* value,
     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_%(old)s(buffer, value, value_bytes);
 }
 """
@@ -426,7 +642,7 @@ TPM_RC Serialize_%(type)s(
     const %(type)s& value,
     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 """
   _SERIALIZE_FIELD = """
   result = Serialize_%(type)s(value.%(name)s, buffer);
@@ -473,7 +689,7 @@ TPM_RC Parse_%(type)s(
     %(type)s* value,
     std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 """
   _PARSE_FIELD = """
   result = Parse_%(type)s(
@@ -518,7 +734,7 @@ TPM_RC Serialize_%(union_type)s(
     %(selector_type)s selector,
     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 """
   _SERIALIZE_UNION_FIELD = """
   if (selector == %(selector_value)s) {
@@ -548,7 +764,7 @@ TPM_RC Parse_%(union_type)s(
     %(union_type)s* value,
     std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 """
   _PARSE_UNION_FIELD = """
   if (selector == %(selector_value)s) {
@@ -1226,7 +1442,8 @@ class Command(object):
       const std::string& response"""
   _SERIALIZE_FUNCTION_START = """
 TPM_RC Tpm::SerializeCommand_%(method_name)s(%(method_args)s) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, %(command_code)s);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -1299,15 +1516,15 @@ TPM_RC Tpm::SerializeCommand_%(method_name)s(%(method_args)s) {
                         authorization_section_bytes +
                         parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 """
   _RESPONSE_PARSER_START = """
 TPM_RC Tpm::ParseResponse_%(method_name)s(%(method_args)s) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, %(command_code)s);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);"""
   _PARSE_LOCAL_VAR = """
@@ -1330,6 +1547,7 @@ TPM_RC Tpm::ParseResponse_%(method_name)s(%(method_args)s) {
     return rc;
   }"""
   _RESPONSE_ERROR_CHECK = """
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -1487,7 +1705,8 @@ TPM_RC Tpm::%(method_name)sSync(%(method_args)s) {
     response_parameters = self._SplitArgs(self.response_args)[1]
     out_file.write(self._SERIALIZE_FUNCTION_START % {
         'method_name': self._MethodName(),
-        'method_args': self._SerializeArgs()})
+        'method_args': self._SerializeArgs(),
+        'command_code': self.command_code})
     out_file.write(self._DECLARE_COMMAND_CODE % {'command_code':
                                                  self.command_code})
     out_file.write(self._DECLARE_BOOLEAN % {
@@ -1538,7 +1757,8 @@ TPM_RC Tpm::%(method_name)sSync(%(method_args)s) {
     """
     out_file.write(self._RESPONSE_PARSER_START % {
         'method_name': self._MethodName(),
-        'method_args': self._ParseArgs()})
+        'method_args': self._ParseArgs(),
+        'command_code': self.command_code})
     # Parse the header -- this should always exist.
     out_file.write(self._PARSE_LOCAL_VAR % {'var_name': 'tag',
                                             'var_type': 'TPM_ST'})
@@ -1649,6 +1869,30 @@ TPM_RC Tpm::%(method_name)sSync(%(method_args)s) {
     """Returns the number of output handles for this command."""
     return len(self._SplitArgs(self.response_args)[0])
 
+  def GetInfo(self):
+    """Returns a dict describing this command for the command info table."""
+    parameters = self._SplitArgs(self.request_args)[1]
+    response_parameters = self._SplitArgs(self.response_args)[1]
+    invalidated_handles = 0
+    for position in _INVALIDATED_HANDLES.get(self.command_code, []):
+      invalidated_handles |= 1 << position
+    latency = 'kMedium'
+    if self.command_code in _LONG_LATENCY_COMMANDS:
+      latency = 'kLong'
+    elif self.command_code in _SHORT_LATENCY_COMMANDS:
+      latency = 'kShort'
+    return {
+        'command_code': self.command_code,
+        'request_handles': self.GetNumberOfRequestHandles(),
+        'response_handles': self.GetNumberOfResponseHandles(),
+        'command_encryption': GetCppBool(
+            parameters and IsTPM2B(parameters[0]['type'])),
+        'response_encryption': GetCppBool(
+            response_parameters and IsTPM2B(response_parameters[0]['type'])),
+        'read_only': GetCppBool(self.command_code in _READ_ONLY_COMMANDS),
+        'invalidated_handles': invalidated_handles,
+        'latency': latency}
+
   def _OutputMethodSignatures(self, out_file):
     """Prints method declaration statements for this command.
 
@@ -1949,25 +2193,34 @@ class CommandParser(object):
     return args
 
 
-def GenerateHandleCountFunctions(commands, out_file):
-  """Generates the GetNumberOf*Handles functions given a list of commands.
+def GenerateCommandInfo(constants, commands, out_file):
+  """Generates the command info table and lookup functions.
 
   Args:
+    constants: A list of Constant objects, used to order commands by code.
     commands: A list of Command objects.
     out_file: The output file.
   """
-  out_file.write(_HANDLE_COUNT_FUNCTION_START % {'handle_type': 'Request'})
-  for command in commands:
-    out_file.write(_HANDLE_COUNT_FUNCTION_CASE %
-                   {'command_code': command.command_code,
-                    'handle_count': command.GetNumberOfRequestHandles()})
-  out_file.write(_HANDLE_COUNT_FUNCTION_END)
-  out_file.write(_HANDLE_COUNT_FUNCTION_START % {'handle_type': 'Response'})
+  values = {}
+  for constant in constants:
+    if constant.const_type == 'TPM_CC':
+      values[constant.name] = int(constant.value, 16)
+  commands_by_value = {}
   for command in commands:
-    out_file.write(_HANDLE_COUNT_FUNCTION_CASE %
-                   {'command_code': command.command_code,
-                    'handle_count': command.GetNumberOfResponseHandles()})
-  out_file.write(_HANDLE_COUNT_FUNCTION_END)
+    commands_by_value[values[command.command_code]] = command
+  out_file.write(_COMMAND_INFO_TABLE_START)
+  for value in range(values['TPM_CC_FIRST'], values['TPM_CC_LAST'] + 1):
+    command = commands_by_value.get(value)
+    if not command:
+      out_file.write(_COMMAND_INFO_TABLE_GAP)
+      continue
+    out_file.write(_COMMAND_INFO_TABLE_ENTRY % command.GetInfo())
+  out_file.write(_COMMAND_INFO_TABLE_END)
+  out_file.write(_HANDLE_COUNT_FUNCTION % {'handle_type': 'Request',
+                                           'handle_field': 'request_handles'})
+  out_file.write(_HANDLE_COUNT_FUNCTION % {'handle_type': 'Response',
+                                           'handle_field': 'response_handles'})
+  out_file.write(_TRACE_IMPLEMENTATION)
 
 
 def GenerateHeader(types, constants, structs, defines, typemap, commands):
@@ -2037,11 +2290,12 @@ def GenerateHeader(types, constants, structs, defines, typemap, commands):
   out_file.close()
 
 
-def GenerateImplementation(types, structs, typemap, commands):
+def GenerateImplementation(types, constants, structs, typemap, commands):
   """Generates implementation code for each command.
 
   Args:
     types: A list of Typedef objects.
+    constants: A list of Constant objects.
     structs: A list of Structure objects.
     typemap: A dict mapping type names to the corresponding object.
     commands: A list of Command objects.
@@ -2051,7 +2305,7 @@ def GenerateImplementation(types, structs, typemap, commands):
   out_file.write(_LOCAL_INCLUDE % {'filename': _OUTPUT_FILE_H})
   out_file.write(_IMPLEMENTATION_FILE_INCLUDES)
   out_file.write(_NAMESPACE_BEGIN)
-  GenerateHandleCountFunctions(commands, out_file)
+  GenerateCommandInfo(constants, commands, out_file)
   serialized_types = set(_BASIC_TYPES)
   for basic_type in _BASIC_TYPES:
     out_file.write(_SERIALIZE_BASIC_TYPE % {'type': basic_type})
@@ -2065,6 +2319,7 @@ def GenerateImplementation(types, structs, typemap, commands):
     command.OutputErrorCallback(out_file)
     command.OutputResponseCallback(out_file)
     command.OutputMethodImplementation(out_file)
+  out_file.write(_SEND_COMMANDS_FUNCTION)
   out_file.write(_NAMESPACE_END)
   out_file.close()
 
@@ -2092,7 +2347,7 @@ def main():
   command_parser = CommandParser(open(args.commands_file))
   commands = command_parser.Parse()
   GenerateHeader(types, constants, structs, defines, typemap, commands)
-  GenerateImplementation(types, structs, typemap, commands)
+  GenerateImplementation(types, constants, structs, typemap, commands)
   FormatFile(_OUTPUT_FILE_H)
   FormatFile(_OUTPUT_FILE_CC)
   print('Processed %d commands.' % len(commands))
@@ -167,6 +167,28 @@ class TestGenerators(unittest.TestCase):
     self.assertIn(expected_sync, out_file.getvalue())
     out_file.close()
 
+  def testCommandInfo(self):
+    """Test generation of the command info table."""
+    command = generator.Command('TPM2_SequenceComplete')
+    command.command_code = 'TPM_CC_SequenceComplete'
+    command.request_args = [self._MakeArg('TPMI_DH_OBJECT', 'sequenceHandle'),
+                            self._MakeArg('TPM2B_MAX_BUFFER', 'buffer')]
+    command.response_args = [self._MakeArg('TPM2B_DIGEST', 'result')]
+    constants = [generator.Constant('TPM_CC', 'TPM_CC_FIRST', '0x0000013D'),
+                 generator.Constant('TPM_CC', 'TPM_CC_SequenceComplete',
+                                    '0x0000013E'),
+                 generator.Constant('TPM_CC', 'TPM_CC_LAST', '0x0000013E')]
+    out_file = StringIO.StringIO()
+    generator.GenerateCommandInfo(constants, [command], out_file)
+    expected_table = """constexpr TpmCommandInfo kCommandInfo[] = {
+    {},
+    {TPM_CC_SequenceComplete, 1, 0,
+     true, true, false,
+     0x01, TpmCommandLatency::kShort},
+};"""
+    self.assertIn(expected_table, out_file.getvalue())
+    out_file.close()
+
 
 class TestParsers(unittest.TestCase):
   """Test parser classes."""
@@ -27,23 +27,70 @@ namespace trunks {
 
 namespace {
 
-const uint32_t kDigestBits = 256;
 const uint16_t kNonceMinSize = 16;
 const uint16_t kNonceMaxSize = 32;
 const uint8_t kDecryptSession = 1 << 5;
 const uint8_t kEncryptSession = 1 << 6;
 const uint8_t kLabelSize = 4;
+const char kSessionKeyLabel[] = "ATH";
+const char kEncryptionKeyLabel[] = "CFB";
 const size_t kAesIVSize = 16;
 const uint32_t kTpmBufferSize = 4096;
+// The serialized KDF counter, which is always 1 since only one block of key
+// material is needed, and the serialized size of the derived key in bits.
+const uint8_t kKdfCounter[] = {0, 0, 0, 1};
+const uint8_t kKdfKeyBits[] = {0, 0, 1, 0};
 
 }  // namespace
 
+class HmacAuthorizationDelegate::HmacContext {
+ public:
+  HmacContext() { HMAC_CTX_init(&context_); }
+  ~HmacContext() { HMAC_CTX_cleanup(&context_); }
+
+  // Starts a new HMAC keyed with |key_prefix| followed by |key_suffix|. The
+  // key schedule is reused if the key is the same as last time.
+  void Init(const std::string& key_prefix, const std::string& key_suffix) {
+    if (initialized_ && key_.size() == key_prefix.size() + key_suffix.size() &&
+        key_.compare(0, key_prefix.size(), key_prefix) == 0 &&
+        key_.compare(key_prefix.size(), std::string::npos, key_suffix) == 0) {
+      HMAC_Init_ex(&context_, nullptr, 0, nullptr, nullptr);
+      return;
+    }
+    key_ = key_prefix + key_suffix;
+    HMAC_Init_ex(&context_, key_.data(), key_.size(), EVP_sha256(), nullptr);
+    initialized_ = true;
+  }
+
+  void Update(const void* data, size_t size) {
+    HMAC_Update(&context_, static_cast<const unsigned char*>(data), size);
+  }
+
+  void Update(const std::string& data) { Update(data.data(), data.size()); }
+
+  // Finishes the HMAC and writes kHashDigestSize bytes to |digest|.
+  void Final(uint8_t* digest) {
+    unsigned int digest_length = 0;
+    HMAC_Final(&context_, digest, &digest_length);
+    CHECK_EQ(digest_length, kHashDigestSize);
+  }
+
+ private:
+  HMAC_CTX context_;
+  std::string key_;
+  bool initialized_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(HmacContext);
+};
+
 HmacAuthorizationDelegate::HmacAuthorizationDelegate()
     : session_handle_(0),
       is_parameter_encryption_enabled_(false),
       nonce_generated_(false),
       future_authorization_value_set_(false),
-      use_entity_authorization_for_encryption_only_(false) {
+      use_entity_authorization_for_encryption_only_(false),
+      authorization_hmac_(new HmacContext()),
+      encryption_hmac_(new HmacContext()) {
   tpm_nonce_.size = 0;
   caller_nonce_.size = 0;
 }
@@ -82,21 +129,18 @@ bool HmacAuthorizationDelegate::GetCommandAuthorization(
            TPM_RC_SUCCESS)
       << "Error serializing session attributes.";
 
-  std::string hmac_data;
-  std::string hmac_key;
-  if (!use_entity_authorization_for_encryption_only_) {
-    hmac_key = session_key_ + entity_authorization_value_;
-  } else {
-    hmac_key = session_key_;
-  }
-  hmac_data.append(command_hash);
-  hmac_data.append(reinterpret_cast<const char*>(caller_nonce_.buffer),
-                   caller_nonce_.size);
-  hmac_data.append(reinterpret_cast<const char*>(tpm_nonce_.buffer),
-                   tpm_nonce_.size);
-  hmac_data.append(attributes_bytes);
-  std::string digest = HmacSha256(hmac_key, hmac_data);
-  auth.hmac = Make_TPM2B_DIGEST(digest);
+  const std::string no_authorization_value;
+  const std::string& authorization_value =
+      use_entity_authorization_for_encryption_only_
+          ? no_authorization_value
+          : entity_authorization_value_;
+  authorization_hmac_->Init(session_key_, authorization_value);
+  authorization_hmac_->Update(command_hash);
+  authorization_hmac_->Update(caller_nonce_.buffer, caller_nonce_.size);
+  authorization_hmac_->Update(tpm_nonce_.buffer, tpm_nonce_.size);
+  authorization_hmac_->Update(attributes_bytes);
+  authorization_hmac_->Final(auth.hmac.buffer);
+  auth.hmac.size = kHashDigestSize;
 
   TPM_RC serialize_error = Serialize_TPMS_AUTH_COMMAND(auth, authorization);
   if (serialize_error != TPM_RC_SUCCESS) {
@@ -137,30 +181,27 @@ bool HmacAuthorizationDelegate::CheckResponseAuthorization(
            TPM_RC_SUCCESS)
       << "Error serializing session attributes.";
 
-  std::string hmac_data;
-  std::string hmac_key;
+  const std::string no_authorization_value;
+  const std::string* authorization_value = &no_authorization_value;
   if (!use_entity_authorization_for_encryption_only_) {
     // In a special case with TPM2_HierarchyChangeAuth, we need to use the
     // auth_value that was set.
     if (future_authorization_value_set_) {
-      hmac_key = session_key_ + future_authorization_value_;
+      authorization_value = &future_authorization_value_;
       future_authorization_value_set_ = false;
     } else {
-      hmac_key = session_key_ + entity_authorization_value_;
+      authorization_value = &entity_authorization_value_;
     }
-  } else {
-    hmac_key = session_key_;
   }
-  hmac_data.append(response_hash);
-  hmac_data.append(reinterpret_cast<const char*>(tpm_nonce_.buffer),
-                   tpm_nonce_.size);
-  hmac_data.append(reinterpret_cast<const char*>(caller_nonce_.buffer),
-                   caller_nonce_.size);
-  hmac_data.append(attributes_bytes);
-  std::string digest = HmacSha256(hmac_key, hmac_data);
-  CHECK_EQ(digest.size(), auth_response.hmac.size);
-  if (!crypto::SecureMemEqual(digest.data(), auth_response.hmac.buffer,
-                              digest.size())) {
+  authorization_hmac_->Init(session_key_, *authorization_value);
+  authorization_hmac_->Update(response_hash);
+  authorization_hmac_->Update(tpm_nonce_.buffer, tpm_nonce_.size);
+  authorization_hmac_->Update(caller_nonce_.buffer, caller_nonce_.size);
+  authorization_hmac_->Update(attributes_bytes);
+  uint8_t digest[kHashDigestSize];
+  authorization_hmac_->Final(digest);
+  if (!crypto::SecureMemEqual(digest, auth_response.hmac.buffer,
+                              kHashDigestSize)) {
     LOG(ERROR) << "Authorization response hash did not match expected value.";
     return false;
   }
@@ -221,15 +262,17 @@ bool HmacAuthorizationDelegate::InitSession(TPM_HANDLE session_handle,
   }
   tpm_nonce_ = tpm_nonce;
   caller_nonce_ = caller_nonce;
-  std::string session_key_label("ATH", kLabelSize);
   is_parameter_encryption_enabled_ = enable_parameter_encryption;
   if (salt.length() == 0 && bind_auth_value.length() == 0) {
     // SessionKey is set to the empty string for unsalted and
     // unbound sessions.
     session_key_ = std::string();
   } else {
-    session_key_ = CreateKey(bind_auth_value + salt, session_key_label,
-                             tpm_nonce_, caller_nonce_);
+    HmacContext hmac;
+    hmac.Init(bind_auth_value, salt);
+    uint8_t session_key[kHashDigestSize];
+    CreateKey(&hmac, kSessionKeyLabel, tpm_nonce_, caller_nonce_, session_key);
+    session_key_.assign(reinterpret_cast<char*>(session_key), kHashDigestSize);
   }
   return true;
 }
@@ -240,66 +283,37 @@ void HmacAuthorizationDelegate::set_future_authorization_value(
   future_authorization_value_set_ = true;
 }
 
-std::string HmacAuthorizationDelegate::CreateKey(
-    const std::string& hmac_key,
-    const std::string& label,
-    const TPM2B_NONCE& nonce_newer,
-    const TPM2B_NONCE& nonce_older) {
-  std::string counter;
-  std::string digest_size_bits;
-  if (Serialize_uint32_t(1, &counter) != TPM_RC_SUCCESS ||
-      Serialize_uint32_t(kDigestBits, &digest_size_bits) != TPM_RC_SUCCESS) {
-    LOG(ERROR) << "Error serializing uint32_t during session key generation.";
-    return std::string();
-  }
-  CHECK_EQ(counter.size(), sizeof(uint32_t));
-  CHECK_EQ(digest_size_bits.size(), sizeof(uint32_t));
-  CHECK_EQ(label.size(), kLabelSize);
-
-  std::string data;
-  data.append(counter);
-  data.append(label);
-  data.append(reinterpret_cast<const char*>(nonce_newer.buffer),
-              nonce_newer.size);
-  data.append(reinterpret_cast<const char*>(nonce_older.buffer),
-              nonce_older.size);
-  data.append(digest_size_bits);
-  std::string key = HmacSha256(hmac_key, data);
-  return key;
-}
-
-std::string HmacAuthorizationDelegate::HmacSha256(const std::string& key,
-                                                  const std::string& data) {
-  unsigned char digest[EVP_MAX_MD_SIZE];
-  unsigned int digest_length;
-  HMAC(EVP_sha256(), key.data(), key.size(),
-       reinterpret_cast<const unsigned char*>(data.data()), data.size(), digest,
-       &digest_length);
-  CHECK_EQ(digest_length, kHashDigestSize);
-  return std::string(reinterpret_cast<char*>(digest), digest_length);
+void HmacAuthorizationDelegate::CreateKey(HmacContext* hmac,
+                                          const char* label,
+                                          const TPM2B_NONCE& nonce_newer,
+                                          const TPM2B_NONCE& nonce_older,
+                                          uint8_t* key) {
+  hmac->Update(kKdfCounter, sizeof(kKdfCounter));
+  hmac->Update(label, kLabelSize);
+  hmac->Update(nonce_newer.buffer, nonce_newer.size);
+  hmac->Update(nonce_older.buffer, nonce_older.size);
+  hmac->Update(kKdfKeyBits, sizeof(kKdfKeyBits));
+  hmac->Final(key);
 }
 
 void HmacAuthorizationDelegate::AesOperation(std::string* parameter,
                                              const TPM2B_NONCE& nonce_newer,
                                              const TPM2B_NONCE& nonce_older,
                                              int operation_type) {
-  std::string label("CFB", kLabelSize);
-  std::string compound_key =
-      CreateKey(session_key_ + entity_authorization_value_, label, nonce_newer,
-                nonce_older);
-  CHECK_EQ(compound_key.size(), kAesKeySize + kAesIVSize);
-  unsigned char aes_key[kAesKeySize];
-  unsigned char aes_iv[kAesIVSize];
-  memcpy(aes_key, &compound_key[0], kAesKeySize);
-  memcpy(aes_iv, &compound_key[kAesKeySize], kAesIVSize);
+  static_assert(kAesKeySize + kAesIVSize == kHashDigestSize,
+                "The derived key must hold the AES key and IV.");
+  uint8_t compound_key[kHashDigestSize];
+  encryption_hmac_->Init(session_key_, entity_authorization_value_);
+  CreateKey(encryption_hmac_.get(), kEncryptionKeyLabel, nonce_newer,
+            nonce_older, compound_key);
+  uint8_t* aes_iv = compound_key + kAesKeySize;
   AES_KEY key;
   int iv_offset = 0;
-  AES_set_encrypt_key(aes_key, kAesKeySize * 8, &key);
-  unsigned char decrypted[kTpmBufferSize];
-  AES_cfb128_encrypt(reinterpret_cast<const unsigned char*>(parameter->data()),
-                     decrypted, parameter->size(), &key, aes_iv, &iv_offset,
+  AES_set_encrypt_key(compound_key, kAesKeySize * 8, &key);
+  unsigned char* data =
+      reinterpret_cast<unsigned char*>(base::string_as_array(parameter));
+  AES_cfb128_encrypt(data, data, parameter->size(), &key, aes_iv, &iv_offset,
                      operation_type);
-  memcpy(base::string_as_array(parameter), decrypted, parameter->size());
 }
 
 void HmacAuthorizationDelegate::RegenerateCallerNonce() {
@@ -17,6 +17,7 @@
 #ifndef TRUNKS_HMAC_AUTHORIZATION_DELEGATE_H_
 #define TRUNKS_HMAC_AUTHORIZATION_DELEGATE_H_
 
+#include <memory>
 #include <string>
 
 #include <base/gtest_prod_util.h>
@@ -118,15 +119,19 @@ class TRUNKS_EXPORT HmacAuthorizationDelegate : public AuthorizationDelegate {
   FRIEND_TEST(HmacAuthorizationDelegateTest, SessionKeyTest);
 
  private:
+  // An HMAC-SHA256 state that keeps the key schedule of its current key.
+  class HmacContext;
+
   // This method implements the key derivation function used in the TPM.
-  // NOTE: It only returns 32 byte keys.
-  std::string CreateKey(const std::string& hmac_key,
-                        const std::string& label,
-                        const TPM2B_NONCE& nonce_newer,
-                        const TPM2B_NONCE& nonce_older);
-  // This method performs a FIPS198 HMAC operation on |data| using |key|
-  std::string HmacSha256(const std::string& key, const std::string& data);
-  // This method performs an AES operation using a 128 bit key.
+  // |hmac| must have been started with the HMAC key. |label| must be four
+  // bytes long, including the terminating null. It writes kHashDigestSize
+  // bytes to |key|.
+  void CreateKey(HmacContext* hmac,
+                 const char* label,
+                 const TPM2B_NONCE& nonce_newer,
+                 const TPM2B_NONCE& nonce_older,
+                 uint8_t* key);
+  // This method performs an AES operation in place using a 128 bit key.
   // |operation_type| can be either AES_ENCRYPT or AES_DECRYPT and it
   // determines if the operation is an encryption or decryption.
   void AesOperation(std::string* parameter,
@@ -152,6 +157,11 @@ class TRUNKS_EXPORT HmacAuthorizationDelegate : public AuthorizationDelegate {
   // when computing the hmac_key to create the authorization hmac. Defaults
   // to false, but policy sessions may set this flag to true.
   bool use_entity_authorization_for_encryption_only_;
+  // HMAC states for authorization HMACs and for parameter encryption keys.
+  // Both are keyed with the session key and usually the entity authorization
+  // value, so the key schedule is only recomputed when one of those changes.
+  std::unique_ptr<HmacContext> authorization_hmac_;
+  std::unique_ptr<HmacContext> encryption_hmac_;
 
   DISALLOW_COPY_AND_ASSIGN(HmacAuthorizationDelegate);
 };
@@ -16,6 +16,8 @@
 
 #include <string>
 
+#include <base/logging.h>
+#include <base/time/time.h>
 #include <gtest/gtest.h>
 
 #include "trunks/hmac_authorization_delegate.h"
@@ -254,4 +256,45 @@ TEST_F(HmacAuthorizationDelegateFixture, SessionAttributes) {
             auth_command.session_attributes);
 }
 
+// Measures the cost of authorizing a command and checking the response of an
+// HMAC session with parameter encryption. Run it before and after changes to
+// the delegate with --gtest_also_run_disabled_tests.
+TEST_F(HmacAuthorizationDelegateFixture, DISABLED_AuthorizationBenchmark) {
+  const int kIterations = 10000;
+  ASSERT_TRUE(delegate_.InitSession(session_handle_,
+                                    session_nonce_,  // TPM nonce.
+                                    session_nonce_,  // Caller nonce.
+                                    "salt",          // Salt.
+                                    "bind_auth",     // Bind auth value.
+                                    true));          // Enable encryption.
+  delegate_.set_entity_authorization_value("entity_auth");
+  std::string command_hash(kHashDigestSize, 'c');
+  std::string response_hash(kHashDigestSize, 'r');
+  std::string parameter(256, 'p');
+  TPMS_AUTH_RESPONSE auth_response;
+  auth_response.session_attributes = kContinueSession;
+  auth_response.nonce = session_nonce_;
+  auth_response.hmac.size = kHashDigestSize;
+  memset(auth_response.hmac.buffer, 0, kHashDigestSize);
+  std::string response_authorization;
+  ASSERT_EQ(TPM_RC_SUCCESS, Serialize_TPMS_AUTH_RESPONSE(
+                                auth_response, &response_authorization));
+  std::string authorization;
+  // Keep the response mismatch errors out of the measurement.
+  logging::LogSeverity original_severity = logging::GetMinLogLevel();
+  logging::SetMinLogLevel(logging::LOG_FATAL);
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    delegate_.EncryptCommandParameter(&parameter);
+    delegate_.GetCommandAuthorization(command_hash, true, true, &authorization);
+    // The response HMAC does not match, but it is computed all the same.
+    delegate_.CheckResponseAuthorization(response_hash, response_authorization);
+    delegate_.DecryptResponseParameter(&parameter);
+  }
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+  logging::SetMinLogLevel(original_severity);
+  LOG(INFO) << "Authorization cost per command: "
+            << elapsed.InMicroseconds() / kIterations << " us";
+}
+
 }  // namespace trunks
@@ -0,0 +1,131 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/hmac_drbg.h"
+
+#include <algorithm>
+
+#include <base/logging.h>
+#include <openssl/hmac.h>
+
+namespace {
+
+// The output length of SHA-256, which is also the size of the key and value.
+const size_t kOutputSize = 32;
+// SP 800-90A, table 2: at most 2^19 bits per request and 2^48 requests
+// between reseeds.
+const size_t kMaxBytesPerRequest = 1 << 16;
+const uint64_t kMaxReseedInterval = 1ULL << 48;
+
+}  // namespace
+
+namespace trunks {
+
+const size_t HmacDrbg::kSeedSize;
+
+HmacDrbg::HmacDrbg() {}
+
+HmacDrbg::~HmacDrbg() {}
+
+void HmacDrbg::Configure(uint64_t reseed_interval, bool prediction_resistance) {
+  base::AutoLock lock(lock_);
+  reseed_interval_ = std::min(reseed_interval, kMaxReseedInterval);
+  prediction_resistance_ = prediction_resistance;
+  instantiated_ = false;
+  reseed_counter_ = 0;
+  key_.clear();
+  value_.clear();
+}
+
+bool HmacDrbg::IsEnabled() {
+  base::AutoLock lock(lock_);
+  return reseed_interval_ > 0;
+}
+
+bool HmacDrbg::NeedsReseed() {
+  base::AutoLock lock(lock_);
+  return !instantiated_ || prediction_resistance_ ||
+         reseed_counter_ > reseed_interval_;
+}
+
+bool HmacDrbg::Generate(size_t num_bytes,
+                        const std::string& seed,
+                        std::string* random_data) {
+  CHECK(random_data);
+  base::AutoLock lock(lock_);
+  if (reseed_interval_ == 0) {
+    return false;
+  }
+  if (!seed.empty()) {
+    if (!instantiated_) {
+      // Instantiate: K = 0x00...00, V = 0x01...01, then mix in the seed.
+      key_.assign(kOutputSize, 0);
+      value_.assign(kOutputSize, 1);
+      instantiated_ = true;
+    }
+    Update(seed);
+    reseed_counter_ = 1;
+  } else if (!instantiated_ || prediction_resistance_ ||
+             reseed_counter_ > reseed_interval_) {
+    return false;
+  }
+  random_data->clear();
+  random_data->reserve(num_bytes);
+  size_t request_bytes = 0;
+  while (random_data->size() < num_bytes) {
+    if (request_bytes == kMaxBytesPerRequest) {
+      Update(std::string());
+      request_bytes = 0;
+    }
+    value_ = Hmac(value_);
+    size_t bytes = std::min(kOutputSize, num_bytes - random_data->size());
+    random_data->append(value_, 0, bytes);
+    request_bytes += bytes;
+  }
+  Update(std::string());
+  ++reseed_counter_;
+  return true;
+}
+
+void HmacDrbg::AddInput(const std::string& input) {
+  base::AutoLock lock(lock_);
+  if (!instantiated_ || input.empty()) {
+    return;
+  }
+  Update(input);
+}
+
+void HmacDrbg::Update(const std::string& provided_data) {
+  key_ = Hmac(value_ + '\x00' + provided_data);
+  value_ = Hmac(value_);
+  if (provided_data.empty()) {
+    return;
+  }
+  key_ = Hmac(value_ + '\x01' + provided_data);
+  value_ = Hmac(value_);
+}
+
+std::string HmacDrbg::Hmac(const std::string& data) const {
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int digest_length = 0;
+  CHECK(HMAC(EVP_sha256(), key_.data(), key_.size(),
+             reinterpret_cast<const unsigned char*>(data.data()), data.size(),
+             digest, &digest_length));
+  CHECK_EQ(digest_length, kOutputSize);
+  return std::string(reinterpret_cast<char*>(digest), digest_length);
+}
+
+}  // namespace trunks
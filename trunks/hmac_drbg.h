@@ -0,0 +1,96 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef TRUNKS_HMAC_DRBG_H_
+#define TRUNKS_HMAC_DRBG_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include <base/macros.h>
+#include <base/synchronization/lock.h>
+
+#include "trunks/trunks_export.h"
+
+namespace trunks {
+
+// HmacDrbg is an HMAC_DRBG with SHA-256 as described in NIST SP 800-90A. It
+// lets TpmUtility::GenerateRandom serve requests of any size locally instead
+// of making one TPM2_GetRandom round trip per digest of output. The DRBG only
+// holds state; seed material is always supplied by the caller, and
+// TpmUtilityImpl fetches it from the TPM.
+//
+// A single instance is owned by a TrunksFactory. The DRBG is disabled until
+// Configure() is called, in which case GenerateRandom reads every byte from the
+// TPM as before. This class is thread-safe.
+class TRUNKS_EXPORT HmacDrbg {
+ public:
+  // The number of bytes of seed material to pass to Generate(): a full-entropy
+  // input of the security strength plus a nonce of half that.
+  static const size_t kSeedSize = 48;
+
+  HmacDrbg();
+  ~HmacDrbg();
+
+  // Enables the DRBG. New seed material is needed after every
+  // |reseed_interval| Generate() calls, or before every call if
+  // |prediction_resistance| is true. Any current state is discarded. A
+  // |reseed_interval| of zero disables the DRBG.
+  void Configure(uint64_t reseed_interval, bool prediction_resistance);
+
+  // Returns true if the DRBG has been enabled.
+  bool IsEnabled();
+
+  // Returns true if the next Generate() call needs seed material.
+  bool NeedsReseed();
+
+  // Writes |num_bytes| of output to |random_data|. If |seed| is not empty the
+  // DRBG is first instantiated or reseeded with it. Returns false without
+  // output if the DRBG is disabled, or if it needs seed material and |seed| is
+  // empty. Output beyond the per-request limit of SP 800-90A is produced in
+  // several internal requests, but the call counts once toward the reseed
+  // interval.
+  bool Generate(size_t num_bytes,
+                const std::string& seed,
+                std::string* random_data);
+
+  // Mixes |input| into the state as additional input, e.g. data passed to
+  // TpmUtility::StirRandom. Does nothing if the DRBG is not instantiated.
+  void AddInput(const std::string& input);
+
+ private:
+  // The HMAC_DRBG_Update function of SP 800-90A, section 10.1.2.2. Must be
+  // called with |lock_| held.
+  void Update(const std::string& provided_data);
+  // Returns HMAC-SHA256 of |data| keyed with |key_|.
+  std::string Hmac(const std::string& data) const;
+
+  base::Lock lock_;
+  uint64_t reseed_interval_ = 0;
+  bool prediction_resistance_ = false;
+  bool instantiated_ = false;
+  // The number of Generate() calls since the DRBG was last seeded, plus one.
+  uint64_t reseed_counter_ = 0;
+  std::string key_;
+  std::string value_;
+
+  DISALLOW_COPY_AND_ASSIGN(HmacDrbg);
+};
+
+}  // namespace trunks
+
+#endif  // TRUNKS_HMAC_DRBG_H_
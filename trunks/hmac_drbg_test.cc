@@ -0,0 +1,115 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/hmac_drbg.h"
+
+#include <string>
+
+#include <base/strings/string_number_conversions.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+// Seed material of 0x00, 0x01, ..., 0x2F.
+std::string GetTestSeed() {
+  std::string seed;
+  for (size_t i = 0; i < trunks::HmacDrbg::kSeedSize; ++i) {
+    seed.push_back(static_cast<char>(i));
+  }
+  return seed;
+}
+
+std::string ToHex(const std::string& data) {
+  return base::HexEncode(data.data(), data.size());
+}
+
+}  // namespace
+
+namespace trunks {
+
+TEST(HmacDrbgTest, DisabledByDefault) {
+  HmacDrbg drbg;
+  std::string random_data;
+  EXPECT_FALSE(drbg.IsEnabled());
+  EXPECT_FALSE(drbg.Generate(16, GetTestSeed(), &random_data));
+}
+
+TEST(HmacDrbgTest, KnownAnswer) {
+  HmacDrbg drbg;
+  drbg.Configure(100, false);
+  EXPECT_TRUE(drbg.IsEnabled());
+  EXPECT_TRUE(drbg.NeedsReseed());
+  std::string random_data;
+  EXPECT_FALSE(drbg.Generate(32, "", &random_data));
+  ASSERT_TRUE(drbg.Generate(32, GetTestSeed(), &random_data));
+  EXPECT_EQ("0FFB80875A3E9022A4941A3FA1B0D3611DF14E1CF651A73CE9229B9F3AD56887",
+            ToHex(random_data));
+  EXPECT_FALSE(drbg.NeedsReseed());
+  ASSERT_TRUE(drbg.Generate(32, "", &random_data));
+  EXPECT_EQ("08767656D3E9669EB668D1E1F5B80D27BB1AEE12FF719EEB83E3DCE006718C16",
+            ToHex(random_data));
+  drbg.AddInput("stir");
+  ASSERT_TRUE(drbg.Generate(16, "", &random_data));
+  EXPECT_EQ("74870E33188C253BACE65E1CA5F593DA", ToHex(random_data));
+}
+
+TEST(HmacDrbgTest, ReseedInterval) {
+  HmacDrbg drbg;
+  drbg.Configure(2, false);
+  std::string random_data;
+  EXPECT_TRUE(drbg.Generate(16, GetTestSeed(), &random_data));
+  EXPECT_TRUE(drbg.Generate(16, "", &random_data));
+  EXPECT_TRUE(drbg.NeedsReseed());
+  EXPECT_FALSE(drbg.Generate(16, "", &random_data));
+  EXPECT_TRUE(drbg.Generate(16, GetTestSeed(), &random_data));
+  EXPECT_FALSE(drbg.NeedsReseed());
+}
+
+TEST(HmacDrbgTest, PredictionResistance) {
+  HmacDrbg drbg;
+  drbg.Configure(100, true);
+  std::string random_data;
+  EXPECT_TRUE(drbg.Generate(16, GetTestSeed(), &random_data));
+  EXPECT_TRUE(drbg.NeedsReseed());
+  EXPECT_FALSE(drbg.Generate(16, "", &random_data));
+}
+
+TEST(HmacDrbgTest, LargeRequest) {
+  HmacDrbg drbg;
+  drbg.Configure(2, false);
+  std::string random_data;
+  size_t num_bytes = 200000;
+  EXPECT_TRUE(drbg.Generate(num_bytes, GetTestSeed(), &random_data));
+  EXPECT_EQ(num_bytes, random_data.size());
+  // Internal requests do not count toward the reseed interval.
+  EXPECT_FALSE(drbg.NeedsReseed());
+}
+
+TEST(HmacDrbgTest, ConfigureDiscardsState) {
+  HmacDrbg drbg;
+  drbg.Configure(100, false);
+  std::string first;
+  EXPECT_TRUE(drbg.Generate(32, GetTestSeed(), &first));
+  drbg.Configure(100, false);
+  EXPECT_TRUE(drbg.NeedsReseed());
+  std::string second;
+  EXPECT_TRUE(drbg.Generate(32, GetTestSeed(), &second));
+  EXPECT_EQ(first, second);
+  drbg.Configure(0, false);
+  EXPECT_FALSE(drbg.IsEnabled());
+}
+
+}  // namespace trunks
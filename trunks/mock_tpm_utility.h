@@ -18,6 +18,7 @@
 #define TRUNKS_MOCK_TPM_UTILITY_H_
 
 #include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 
@@ -44,6 +45,10 @@ class MockTpmUtility : public TpmUtility {
                TPM_RC(size_t, AuthorizationDelegate*, std::string*));
   MOCK_METHOD3(ExtendPCR,
                TPM_RC(int, const std::string&, AuthorizationDelegate*));
+  MOCK_METHOD3(ExtendPCRs,
+               TPM_RC(const std::vector<PCREvent>&,
+                      AuthorizationDelegate*,
+                      TpmEventLog*));
   MOCK_METHOD2(ReadPCR, TPM_RC(int, std::string*));
   MOCK_METHOD6(AsymmetricEncrypt,
                TPM_RC(TPM_HANDLE,
@@ -66,6 +71,23 @@ class MockTpmUtility : public TpmUtility {
                       const std::string&,
                       AuthorizationDelegate*,
                       std::string*));
+  MOCK_METHOD7(SignBatch,
+               TPM_RC(TPM_HANDLE,
+                      TPM_ALG_ID,
+                      TPM_ALG_ID,
+                      const std::vector<std::string>&,
+                      AuthorizationDelegate*,
+                      std::vector<std::string>*,
+                      std::vector<TPM_RC>*));
+  MOCK_METHOD6(SignStreamBegin,
+               TPM_RC(TPM_HANDLE,
+                      TPM_ALG_ID,
+                      TPM_ALG_ID,
+                      bool,
+                      AuthorizationDelegate*,
+                      std::unique_ptr<SignStream>*));
+  MOCK_METHOD2(SignStreamUpdate, TPM_RC(SignStream*, const std::string&));
+  MOCK_METHOD2(SignStreamFinish, TPM_RC(SignStream*, std::string*));
   MOCK_METHOD6(Verify,
                TPM_RC(TPM_HANDLE,
                       TPM_ALG_ID,
@@ -73,6 +95,7 @@ class MockTpmUtility : public TpmUtility {
                       const std::string&,
                       const std::string&,
                       AuthorizationDelegate*));
+  MOCK_METHOD1(SetSoftwarePublicKeyOperations, void(bool));
   MOCK_METHOD2(CertifyCreation, TPM_RC(TPM_HANDLE, const std::string&));
   MOCK_METHOD4(ChangeKeyAuthorizationData,
                TPM_RC(TPM_HANDLE,
@@ -87,6 +110,12 @@ class MockTpmUtility : public TpmUtility {
                       const std::string&,
                       AuthorizationDelegate*,
                       std::string*));
+  MOCK_METHOD5(ImportRSAKeys,
+               TPM_RC(const std::vector<RSAKeyImport>&,
+                      AuthorizationDelegate*,
+                      const ImportProgressCallback&,
+                      std::vector<TPM_RC>*,
+                      std::vector<std::string>*));
   MOCK_METHOD10(CreateRSAKeyPair,
                 TPM_RC(AsymmetricKeyUsage,
                        int,
@@ -98,6 +127,16 @@ class MockTpmUtility : public TpmUtility {
                        AuthorizationDelegate*,
                        std::string*,
                        std::string*));
+  MOCK_METHOD8(CreateECCKeyPair,
+               TPM_RC(AsymmetricKeyUsage,
+                      const std::string&,
+                      const std::string&,
+                      bool,
+                      int,
+                      AuthorizationDelegate*,
+                      std::string*,
+                      std::string*));
+  MOCK_METHOD0(FillRSAKeyPool, TPM_RC());
   MOCK_METHOD3(LoadKey,
                TPM_RC(const std::string&, AuthorizationDelegate*, TPM_HANDLE*));
   MOCK_METHOD2(GetKeyName, TPM_RC(TPM_HANDLE, std::string*));
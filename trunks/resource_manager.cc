@@ -17,12 +17,14 @@
 #include "trunks/resource_manager.h"
 
 #include <algorithm>
-#include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <base/callback.h>
+#include <base/files/file_util.h>
+#include <base/files/important_file_writer.h>
 
 #include "trunks/error_codes.h"
 
@@ -33,6 +35,51 @@ const size_t kMinimumAuthorizationSize = 9;
 const size_t kMessageHeaderSize = 10;
 const trunks::TPM_HANDLE kMaxVirtualHandle =
     (trunks::HR_TRANSIENT + trunks::HR_HANDLE_MASK);
+const size_t kNoContextMapping = static_cast<size_t>(-1);
+const uint32_t kCheckpointVersion = 2;
+
+// Computes a 64-bit FNV-1a digest of |blob|. This is only used to index
+// context blobs so it need not be collision resistant.
+uint64_t ContextDigest(const std::string& blob) {
+  uint64_t digest = 0xcbf29ce484222325ULL;
+  for (char c : blob) {
+    digest ^= static_cast<uint8_t>(c);
+    digest *= 0x100000001b3ULL;
+  }
+  return digest;
+}
+
+// Appends |blob| to |buffer| with a 32-bit size prefix.
+void SerializeBlob(const std::string& blob, std::string* buffer) {
+  trunks::Serialize_UINT32(blob.size(), buffer);
+  buffer->append(blob);
+}
+
+// Parses a blob written by SerializeBlob() from the front of |buffer|.
+bool ParseBlob(std::string* buffer, std::string* blob) {
+  trunks::UINT32 size = 0;
+  if (trunks::Parse_UINT32(buffer, &size, nullptr) != trunks::TPM_RC_SUCCESS ||
+      buffer->size() < size) {
+    return false;
+  }
+  blob->assign(*buffer, 0, size);
+  buffer->erase(0, size);
+  return true;
+}
+
+// Removes the entry mapping |digest| to |index| from |context_index|.
+void RemoveFromContextIndex(
+    uint64_t digest,
+    size_t index,
+    std::unordered_multimap<uint64_t, size_t>* context_index) {
+  auto range = context_index->equal_range(digest);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    if (iter->second == index) {
+      context_index->erase(iter);
+      return;
+    }
+  }
+}
 
 class ScopedBool {
  public:
@@ -66,8 +113,23 @@ void ResourceManager::Initialize() {
   std::unique_ptr<TpmUtility> tpm_utility = factory_.GetTpmUtility();
   CHECK_EQ(tpm_utility->Startup(), TPM_RC_SUCCESS);
   CHECK_EQ(tpm_utility->InitializeTpm(), TPM_RC_SUCCESS);
+  // A checkpoint is consumed whether or not it could be used, so that a stale
+  // one is never restored later.
+  if (!checkpoint_file_.empty()) {
+    if (RestoreCheckpoint()) {
+      LOG(INFO) << "Restored " << virtual_object_handles_.size()
+                << " objects and " << session_handles_.size()
+                << " sessions from checkpoint.";
+    }
+    base::DeleteFile(checkpoint_file_, false);
+  }
+  std::set<TPM_HANDLE> restored_sessions;
+  for (const auto& item : session_handles_) {
+    restored_sessions.insert(item.first & HR_HANDLE_MASK);
+  }
   // Full control of the TPM is assumed and required. Existing transient object
-  // and session handles are mercilessly flushed.
+  // and session handles are mercilessly flushed, except for saved sessions
+  // restored from a checkpoint.
   for (UINT32 handle_type :
        {HR_TRANSIENT, HR_HMAC_SESSION, HR_POLICY_SESSION}) {
     TPMI_YES_NO more_data = YES;
@@ -84,7 +146,12 @@ void ResourceManager::Initialize() {
       }
       const TPML_HANDLE& handle_list = data.data.handles;
       for (UINT32 i = 0; i < handle_list.count; ++i) {
-        factory_.GetTpm()->FlushContextSync(handle_list.handle[i], nullptr);
+        TPM_HANDLE handle = handle_list.handle[i];
+        if (handle_type != HR_TRANSIENT &&
+            restored_sessions.count(handle & HR_HANDLE_MASK) > 0) {
+          continue;
+        }
+        factory_.GetTpm()->FlushContextSync(handle, nullptr);
       }
       if (more_data) {
         // Adjust the range to be greater than the most recent handle so on the
@@ -95,6 +162,84 @@ void ResourceManager::Initialize() {
   }
 }
 
+void ResourceManager::Checkpoint() {
+  if (checkpoint_file_.empty()) {
+    return;
+  }
+  UINT32 reset_count = 0;
+  UINT32 restart_count = 0;
+  if (!ReadTpmCounters(&reset_count, &restart_count)) {
+    LOG(WARNING) << "Not writing checkpoint.";
+    return;
+  }
+  // Save everything that is still loaded. Saved sessions remain in the TPM but
+  // objects need to be flushed.
+  MessageInfo command_info;
+  command_info.has_sessions = false;
+  command_info.code = TPM_CC_ContextSave;
+  for (auto& item : virtual_object_handles_) {
+    HandleInfo& info = item.second;
+    if (!info.is_loaded) {
+      continue;
+    }
+    TPM_HANDLE tpm_handle = info.tpm_handle;
+    TPM_RC result = SaveContext(command_info, &info);
+    if (result != TPM_RC_SUCCESS) {
+      LOG(WARNING) << "Failed to checkpoint object: " << GetErrorString(result);
+      continue;
+    }
+    factory_.GetTpm()->FlushContextSync(tpm_handle, nullptr);
+    tpm_object_handles_.erase(tpm_handle);
+  }
+  for (auto& item : session_handles_) {
+    HandleInfo& info = item.second;
+    if (!info.is_loaded) {
+      continue;
+    }
+    TPM_RC result = SaveContext(command_info, &info);
+    if (result != TPM_RC_SUCCESS) {
+      LOG(WARNING) << "Failed to checkpoint session: "
+                   << GetErrorString(result);
+    }
+  }
+  std::string checkpoint;
+  auto serialize_handles =
+      [&checkpoint](const std::unordered_map<TPM_HANDLE, HandleInfo>& handles) {
+        UINT32 count = 0;
+        std::string entries;
+        for (const auto& item : handles) {
+          if (!item.second.is_loaded) {
+            Serialize_TPM_HANDLE(item.first, &entries);
+            SerializeBlob(item.second.context_blob, &entries);
+            ++count;
+          }
+        }
+        Serialize_UINT32(count, &checkpoint);
+        checkpoint.append(entries);
+      };
+  Serialize_UINT32(kCheckpointVersion, &checkpoint);
+  Serialize_UINT32(reset_count, &checkpoint);
+  Serialize_UINT32(restart_count, &checkpoint);
+  Serialize_TPM_HANDLE(next_virtual_handle_, &checkpoint);
+  serialize_handles(virtual_object_handles_);
+  serialize_handles(session_handles_);
+  Serialize_UINT32(object_aliases_.size(), &checkpoint);
+  for (const auto& item : object_aliases_) {
+    Serialize_TPM_HANDLE(item.first, &checkpoint);
+    Serialize_TPM_HANDLE(item.second, &checkpoint);
+  }
+  Serialize_UINT32(external_context_index_.size(), &checkpoint);
+  for (const auto& item : external_context_index_) {
+    const ContextMapping& mapping = context_mappings_[item.second];
+    SerializeBlob(mapping.external_context, &checkpoint);
+    SerializeBlob(mapping.actual_context, &checkpoint);
+  }
+  if (!base::ImportantFileWriter::WriteFileAtomically(checkpoint_file_,
+                                                      checkpoint)) {
+    LOG(ERROR) << "Failed to write checkpoint.";
+  }
+}
+
 void ResourceManager::SendCommand(const std::string& command,
                                   const ResponseCallback& callback) {
   callback.Run(SendCommandAndWait(command));
@@ -176,6 +321,12 @@ std::string ResourceManager::SendCommandAndWait(const std::string& command) {
         CleanupFlushedHandle(command_info.session_handles[i]);
       }
     }
+    // Cleanup any objects the command flushed, e.g. a completed sequence.
+    for (size_t i = 0; i < command_info.handles.size(); ++i) {
+      if (command_info.invalidated_handles & (1 << i)) {
+        CleanupFlushedHandle(command_info.handles[i]);
+      }
+    }
     // On a successful context save we need to cache the context data in case it
     // needs to be virtualized later.
     if (command_info.code == TPM_CC_ContextSave) {
@@ -184,8 +335,13 @@ std::string ResourceManager::SendCommandAndWait(const std::string& command) {
     // Process all the output handles, which is loosely the inverse of the input
     // handle processing. E.g. virtualize handles.
     std::vector<TPM_HANDLE> virtual_handles;
-    for (auto handle : response_info.handles) {
-      virtual_handles.push_back(ProcessOutputHandle(handle));
+    if (command_info.code == TPM_CC_Load && response_info.handles.size() == 1) {
+      virtual_handles.push_back(
+          ProcessLoadOutputHandle(command_info, response_info));
+    } else {
+      for (auto handle : response_info.handles) {
+        virtual_handles.push_back(ProcessOutputHandle(handle));
+      }
     }
     response = ReplaceHandles(response, virtual_handles);
   }
@@ -209,11 +365,13 @@ bool ResourceManager::ChooseSessionToEvict(
     LOG(WARNING) << "No sessions to evict.";
     return false;
   }
-  // Choose the candidate with the earliest |time_of_last_use|.
+  // Choose the candidate with the earliest |time_of_last_use|. Ties are broken
+  // by handle because |session_handles_| is unordered.
   auto oldest_iter = std::min_element(
       candidates.begin(), candidates.end(), [this](TPM_HANDLE a, TPM_HANDLE b) {
-        return (session_handles_[a].time_of_last_use <
-                session_handles_[b].time_of_last_use);
+        const base::TimeTicks& a_time = session_handles_[a].time_of_last_use;
+        const base::TimeTicks& b_time = session_handles_[b].time_of_last_use;
+        return (a_time < b_time || (a_time == b_time && a < b));
       });
   *session_to_evict = *oldest_iter;
   return true;
@@ -221,8 +379,25 @@ bool ResourceManager::ChooseSessionToEvict(
 
 void ResourceManager::CleanupFlushedHandle(TPM_HANDLE flushed_handle) {
   if (IsObjectHandle(flushed_handle)) {
+    // An alias only holds a reference to an object owned by another handle.
+    auto alias_iter = object_aliases_.find(flushed_handle);
+    if (alias_iter != object_aliases_.end()) {
+      --virtual_object_handles_[alias_iter->second].alias_count;
+      object_aliases_.erase(alias_iter);
+      VLOG(1) << "CLEANUP_ALIAS: " << std::hex << flushed_handle;
+      return;
+    }
     // For transient object handles, remove both the actual and virtual handles.
     if (virtual_object_handles_.count(flushed_handle) > 0) {
+      if (virtual_object_handles_[flushed_handle].alias_count > 0) {
+        PromoteObjectAlias(flushed_handle);
+        return;
+      }
+      const std::string& load_key =
+          virtual_object_handles_[flushed_handle].load_key;
+      if (!load_key.empty()) {
+        loaded_objects_.erase(load_key);
+      }
       tpm_object_handles_.erase(
           virtual_object_handles_[flushed_handle].tpm_handle);
       virtual_object_handles_.erase(flushed_handle);
@@ -235,12 +410,9 @@ void ResourceManager::CleanupFlushedHandle(TPM_HANDLE flushed_handle) {
     // For session handles, remove the handle and any associated context data.
     HandleInfo& info = iter->second;
     if (!info.is_loaded) {
-      std::string actual_context_data;
-      Serialize_TPMS_CONTEXT(info.context, &actual_context_data);
-      if (actual_context_to_external_.count(actual_context_data) > 0) {
-        external_context_to_actual_.erase(
-            actual_context_to_external_[actual_context_data]);
-        actual_context_to_external_.erase(actual_context_data);
+      size_t index = FindContextMappingByActual(info.context_blob);
+      if (index != kNoContextMapping) {
+        RemoveContextMapping(index);
       }
     }
     session_handles_.erase(flushed_handle);
@@ -257,10 +429,35 @@ TPM_HANDLE ResourceManager::CreateVirtualHandle() {
     } else {
       ++next_virtual_handle_;
     }
-  } while (virtual_object_handles_.count(handle) > 0);
+  } while (virtual_object_handles_.count(handle) > 0 ||
+           object_aliases_.count(handle) > 0);
   return handle;
 }
 
+std::string ResourceManager::GetLoadKey(const MessageInfo& command_info,
+                                        const MessageInfo& response_info) {
+  // If session encryption is used the private blob or name differ on each
+  // Load, so such objects are never shared.
+  std::string command_parameters = command_info.parameter_data;
+  TPM2B_PRIVATE in_private;
+  std::string private_blob;
+  if (Parse_TPM2B_PRIVATE(&command_parameters, &in_private, &private_blob) !=
+      TPM_RC_SUCCESS) {
+    return std::string();
+  }
+  std::string response_parameters = response_info.parameter_data;
+  TPM2B_NAME name;
+  std::string name_blob;
+  if (Parse_TPM2B_NAME(&response_parameters, &name, &name_blob) !=
+          TPM_RC_SUCCESS ||
+      name.size == 0) {
+    return std::string();
+  }
+  std::string load_key;
+  Serialize_TPM_HANDLE(ResolveObjectAlias(command_info.handles[0]), &load_key);
+  return load_key + name_blob + private_blob;
+}
+
 TPM_RC ResourceManager::EnsureSessionIsLoaded(const MessageInfo& command_info,
                                               TPM_HANDLE session_handle) {
   // A password authorization can skip all this.
@@ -284,11 +481,15 @@ TPM_RC ResourceManager::EnsureSessionIsLoaded(const MessageInfo& command_info,
 }
 
 void ResourceManager::EvictObjects(const MessageInfo& command_info) {
+  std::vector<TPM_HANDLE> handles_to_retain;
+  for (auto handle : command_info.handles) {
+    handles_to_retain.push_back(ResolveObjectAlias(handle));
+  }
   for (auto& item : virtual_object_handles_) {
     HandleInfo& info = item.second;
     if (!info.is_loaded ||
-        std::find(command_info.handles.begin(), command_info.handles.end(),
-                  item.first) != command_info.handles.end()) {
+        std::find(handles_to_retain.begin(), handles_to_retain.end(),
+                  item.first) != handles_to_retain.end()) {
       continue;
     }
     TPM_RC result = SaveContext(command_info, &info);
@@ -342,17 +543,19 @@ void ResourceManager::FixContextGap(const MessageInfo& command_info) {
       sessions_to_ungap.push_back(item.first);
     }
   }
-  // Sort by |time_of_create|.
+  // Sort by |time_of_create|, then by handle.
   std::sort(sessions_to_ungap.begin(), sessions_to_ungap.end(),
             [this](TPM_HANDLE a, TPM_HANDLE b) {
-              return (session_handles_[a].time_of_create <
-                      session_handles_[b].time_of_create);
+              const base::TimeTicks& a_time =
+                  session_handles_[a].time_of_create;
+              const base::TimeTicks& b_time =
+                  session_handles_[b].time_of_create;
+              return (a_time < b_time || (a_time == b_time && a < b));
             });
   for (auto handle : sessions_to_ungap) {
     HandleInfo& info = session_handles_[handle];
     // Loading and re-saving allows the TPM to assign a new context counter.
-    std::string old_context_blob;
-    Serialize_TPMS_CONTEXT(info.context, &old_context_blob);
+    std::string old_context_blob = info.context_blob;
     TPM_RC result = LoadContext(command_info, &info);
     if (result != TPM_RC_SUCCESS) {
       LOG(WARNING) << "Failed to un-gap session (load): "
@@ -366,16 +569,13 @@ void ResourceManager::FixContextGap(const MessageInfo& command_info) {
       continue;
     }
     // If this context is one that we're tracking for external use, update it.
-    auto iter = actual_context_to_external_.find(old_context_blob);
-    if (iter == actual_context_to_external_.end()) {
+    size_t index = FindContextMappingByActual(old_context_blob);
+    if (index == kNoContextMapping) {
       continue;
     }
-    std::string new_context_blob;
-    Serialize_TPMS_CONTEXT(info.context, &new_context_blob);
-    const std::string& external_context_blob = iter->second;
-    actual_context_to_external_[new_context_blob] = external_context_blob;
-    external_context_to_actual_[external_context_blob] = new_context_blob;
-    actual_context_to_external_.erase(old_context_blob);
+    std::string external_context_blob =
+        context_mappings_[index].external_context;
+    AddContextMapping(external_context_blob, info.context_blob);
   }
 }
 
@@ -435,11 +635,70 @@ void ResourceManager::FlushSession(const MessageInfo& command_info) {
 
 std::string ResourceManager::GetActualContextFromExternalContext(
     const std::string& external_context) {
-  auto iter = external_context_to_actual_.find(external_context);
-  if (iter == external_context_to_actual_.end()) {
+  size_t index = FindContextMappingByExternal(external_context);
+  if (index == kNoContextMapping) {
     return external_context;
   }
-  return iter->second;
+  return context_mappings_[index].actual_context;
+}
+
+void ResourceManager::AddContextMapping(const std::string& external_context,
+                                        const std::string& actual_context) {
+  size_t index = FindContextMappingByExternal(external_context);
+  if (index != kNoContextMapping) {
+    RemoveContextMapping(index);
+  }
+  index = FindContextMappingByActual(actual_context);
+  if (index != kNoContextMapping) {
+    RemoveContextMapping(index);
+  }
+  if (free_context_mappings_.empty()) {
+    index = context_mappings_.size();
+    context_mappings_.emplace_back();
+  } else {
+    index = free_context_mappings_.back();
+    free_context_mappings_.pop_back();
+  }
+  ContextMapping& mapping = context_mappings_[index];
+  mapping.external_context = external_context;
+  mapping.actual_context = actual_context;
+  external_context_index_.emplace(ContextDigest(external_context), index);
+  actual_context_index_.emplace(ContextDigest(actual_context), index);
+}
+
+size_t ResourceManager::FindContextMappingByActual(
+    const std::string& actual_context) const {
+  auto range = actual_context_index_.equal_range(ContextDigest(actual_context));
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    if (context_mappings_[iter->second].actual_context == actual_context) {
+      return iter->second;
+    }
+  }
+  return kNoContextMapping;
+}
+
+size_t ResourceManager::FindContextMappingByExternal(
+    const std::string& external_context) const {
+  auto range =
+      external_context_index_.equal_range(ContextDigest(external_context));
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    if (context_mappings_[iter->second].external_context == external_context) {
+      return iter->second;
+    }
+  }
+  return kNoContextMapping;
+}
+
+void ResourceManager::RemoveContextMapping(size_t index) {
+  ContextMapping& mapping = context_mappings_[index];
+  RemoveFromContextIndex(ContextDigest(mapping.external_context), index,
+                         &external_context_index_);
+  RemoveFromContextIndex(ContextDigest(mapping.actual_context), index,
+                         &actual_context_index_);
+  // Release the blob storage, contexts can be several KB.
+  std::string().swap(mapping.external_context);
+  std::string().swap(mapping.actual_context);
+  free_context_mappings_.push_back(index);
 }
 
 bool ResourceManager::IsObjectHandle(TPM_HANDLE handle) const {
@@ -454,11 +713,18 @@ bool ResourceManager::IsSessionHandle(TPM_HANDLE handle) const {
 TPM_RC ResourceManager::LoadContext(const MessageInfo& command_info,
                                     HandleInfo* handle_info) {
   CHECK(!handle_info->is_loaded);
-  TPM_RC result = TPM_RC_SUCCESS;
+  std::string mutable_context_blob = handle_info->context_blob;
+  TPMS_CONTEXT context;
+  TPM_RC result = Parse_TPMS_CONTEXT(&mutable_context_blob, &context, nullptr);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << __func__
+               << ": Failed to parse context: " << GetErrorString(result);
+    return result;
+  }
   int attempts = 0;
   while (attempts++ < kMaxCommandAttempts) {
     result = factory_.GetTpm()->ContextLoadSync(
-        handle_info->context, &handle_info->tpm_handle, nullptr);
+        context, &handle_info->tpm_handle, nullptr);
     if (!FixWarnings(command_info, result)) {
       break;
     }
@@ -506,11 +772,13 @@ TPM_RC ResourceManager::ParseCommand(const std::string& command,
   if (result != TPM_RC_SUCCESS) {
     return MakeError(result, FROM_HERE);
   }
-  if (command_info->code < TPM_CC_FIRST || command_info->code > TPM_CC_LAST) {
+  const TpmCommandInfo* info = GetCommandInfo(command_info->code);
+  if (!info) {
     return MakeError(TPM_RC_COMMAND_CODE, FROM_HERE);
   }
+  command_info->invalidated_handles = info->invalidated_handles;
 
-  size_t number_of_handles = GetNumberOfRequestHandles(command_info->code);
+  size_t number_of_handles = info->request_handles;
   command_info->handles = ExtractHandlesFromBuffer(number_of_handles, &buffer);
   if (number_of_handles != command_info->handles.size()) {
     return MakeError(TPM_RC_SIZE, FROM_HERE);
@@ -664,20 +932,19 @@ void ResourceManager::ProcessExternalContextSave(
   auto iter = session_handles_.find(saved_handle);
   if (iter != session_handles_.end()) {
     iter->second.is_loaded = false;
-    iter->second.context = context;
+    iter->second.context_blob = context_blob;
   } else {
     // Unknown handle? Not anymore.
     LOG(WARNING) << "Context for unknown handle.";
     HandleInfo new_handle_info;
     new_handle_info.Init(saved_handle);
     new_handle_info.is_loaded = false;
-    new_handle_info.context = context;
+    new_handle_info.context_blob = context_blob;
     session_handles_[saved_handle] = new_handle_info;
   }
   // Use the original context data as the 'external' context data. If this gets
   // virtualized, only the 'actual' context data will change.
-  external_context_to_actual_[context_blob] = context_blob;
-  actual_context_to_external_[context_blob] = context_blob;
+  AddContextMapping(context_blob, context_blob);
 }
 
 std::string ResourceManager::ProcessFlushContext(
@@ -692,6 +959,13 @@ std::string ResourceManager::ProcessFlushContext(
   TPM_HANDLE handle = handles[0];
   TPM_HANDLE actual_handle = handle;
   if (IsObjectHandle(handle)) {
+    // A shared object stays loaded while other handles refer to it.
+    if (object_aliases_.count(handle) > 0 ||
+        (virtual_object_handles_.count(handle) > 0 &&
+         virtual_object_handles_[handle].alias_count > 0)) {
+      CleanupFlushedHandle(handle);
+      return CreateErrorResponse(TPM_RC_SUCCESS);
+    }
     auto iter = virtual_object_handles_.find(handle);
     if (iter == virtual_object_handles_.end()) {
       return CreateErrorResponse(MakeError(TPM_RC_HANDLE, FROM_HERE));
@@ -733,7 +1007,8 @@ TPM_RC ResourceManager::ProcessInputHandle(const MessageInfo& command_info,
     *actual_handle = virtual_handle;
     return TPM_RC_SUCCESS;
   }
-  auto handle_iter = virtual_object_handles_.find(virtual_handle);
+  TPM_HANDLE object_handle = ResolveObjectAlias(virtual_handle);
+  auto handle_iter = virtual_object_handles_.find(object_handle);
   if (handle_iter == virtual_object_handles_.end()) {
     return MakeError(TPM_RC_HANDLE, FROM_HERE);
   }
@@ -743,7 +1018,7 @@ TPM_RC ResourceManager::ProcessInputHandle(const MessageInfo& command_info,
     if (result != TPM_RC_SUCCESS) {
       return result;
     }
-    tpm_object_handles_[handle_info.tpm_handle] = virtual_handle;
+    tpm_object_handles_[handle_info.tpm_handle] = object_handle;
     VLOG(1) << "RELOAD_OBJECT: " << std::hex << virtual_handle;
   }
   VLOG(1) << "INPUT_HANDLE_REPLACE: " << std::hex << virtual_handle << " -> "
@@ -784,6 +1059,85 @@ TPM_HANDLE ResourceManager::ProcessOutputHandle(TPM_HANDLE handle) {
   return virtual_handle_iter->second;
 }
 
+TPM_HANDLE ResourceManager::ProcessLoadOutputHandle(
+    const MessageInfo& command_info,
+    const MessageInfo& response_info) {
+  TPM_HANDLE handle = response_info.handles[0];
+  std::string load_key = GetLoadKey(command_info, response_info);
+  if (load_key.empty() || !IsObjectHandle(handle)) {
+    return ProcessOutputHandle(handle);
+  }
+  auto iter = loaded_objects_.find(load_key);
+  if (iter == loaded_objects_.end()) {
+    TPM_HANDLE virtual_handle = ProcessOutputHandle(handle);
+    virtual_object_handles_[virtual_handle].load_key = load_key;
+    loaded_objects_[load_key] = virtual_handle;
+    return virtual_handle;
+  }
+  // The same blob is already loaded; keep only one copy in the TPM.
+  TPM_RC result = factory_.GetTpm()->FlushContextSync(handle, nullptr);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(WARNING) << "Failed to flush duplicate object: "
+                 << GetErrorString(result);
+    return ProcessOutputHandle(handle);
+  }
+  TPM_HANDLE alias = CreateVirtualHandle();
+  object_aliases_[alias] = iter->second;
+  ++virtual_object_handles_[iter->second].alias_count;
+  VLOG(1) << "OUTPUT_HANDLE_ALIAS: " << std::hex << handle << " -> "
+          << std::hex << alias << " (" << iter->second << ")";
+  return alias;
+}
+
+void ResourceManager::PromoteObjectAlias(TPM_HANDLE virtual_handle) {
+  TPM_HANDLE new_owner = 0;
+  for (auto& item : object_aliases_) {
+    if (item.second != virtual_handle) {
+      continue;
+    }
+    if (new_owner == 0) {
+      new_owner = item.first;
+    } else {
+      item.second = new_owner;
+    }
+  }
+  CHECK_NE(new_owner, 0u);
+  object_aliases_.erase(new_owner);
+  HandleInfo info = virtual_object_handles_[virtual_handle];
+  virtual_object_handles_.erase(virtual_handle);
+  --info.alias_count;
+  if (info.is_loaded) {
+    tpm_object_handles_[info.tpm_handle] = new_owner;
+  }
+  if (!info.load_key.empty()) {
+    loaded_objects_[info.load_key] = new_owner;
+  }
+  virtual_object_handles_[new_owner] = info;
+  VLOG(1) << "PROMOTE_ALIAS: " << std::hex << new_owner;
+}
+
+TPM_HANDLE ResourceManager::ResolveObjectAlias(
+    TPM_HANDLE virtual_handle) const {
+  auto iter = object_aliases_.find(virtual_handle);
+  if (iter == object_aliases_.end()) {
+    return virtual_handle;
+  }
+  return iter->second;
+}
+
+bool ResourceManager::ReadTpmCounters(UINT32* reset_count,
+                                      UINT32* restart_count) {
+  TPMS_TIME_INFO time_info;
+  TPM_RC result = factory_.GetTpm()->ReadClockSync(&time_info, nullptr);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(WARNING) << "Failed to read TPM clock: " << GetErrorString(result);
+    return false;
+  }
+  *reset_count = time_info.clock_info.reset_count;
+  *restart_count = time_info.clock_info.restart_count;
+  return true;
+}
+
 std::string ResourceManager::ReplaceHandles(
     const std::string& message,
     const std::vector<TPM_HANDLE>& new_handles) {
@@ -797,17 +1151,123 @@ std::string ResourceManager::ReplaceHandles(
                                  handles_blob);
 }
 
+bool ResourceManager::RestoreCheckpoint() {
+  std::string checkpoint;
+  if (!base::ReadFileToString(checkpoint_file_, &checkpoint)) {
+    return false;
+  }
+  UINT32 version = 0;
+  UINT32 reset_count = 0;
+  UINT32 restart_count = 0;
+  TPM_HANDLE next_virtual_handle = 0;
+  if (Parse_UINT32(&checkpoint, &version, nullptr) != TPM_RC_SUCCESS ||
+      version != kCheckpointVersion ||
+      Parse_UINT32(&checkpoint, &reset_count, nullptr) != TPM_RC_SUCCESS ||
+      Parse_UINT32(&checkpoint, &restart_count, nullptr) != TPM_RC_SUCCESS ||
+      Parse_TPM_HANDLE(&checkpoint, &next_virtual_handle, nullptr) !=
+          TPM_RC_SUCCESS) {
+    LOG(WARNING) << "Ignoring invalid checkpoint.";
+    return false;
+  }
+  // Saved contexts do not survive a TPM reset or restart.
+  UINT32 tpm_reset_count = 0;
+  UINT32 tpm_restart_count = 0;
+  if (!ReadTpmCounters(&tpm_reset_count, &tpm_restart_count)) {
+    return false;
+  }
+  if (reset_count != tpm_reset_count || restart_count != tpm_restart_count) {
+    LOG(INFO) << "Ignoring checkpoint from before TPM reset or restart.";
+    return false;
+  }
+  // Sessions keep their TPM handle while saved; objects get a new one when they
+  // are next loaded.
+  auto parse_handles =
+      [&checkpoint](bool is_session,
+                    std::unordered_map<TPM_HANDLE, HandleInfo>* handles) {
+        UINT32 count = 0;
+        if (Parse_UINT32(&checkpoint, &count, nullptr) != TPM_RC_SUCCESS) {
+          return false;
+        }
+        for (UINT32 i = 0; i < count; ++i) {
+          TPM_HANDLE handle = 0;
+          HandleInfo info;
+          if (Parse_TPM_HANDLE(&checkpoint, &handle, nullptr) !=
+                  TPM_RC_SUCCESS ||
+              !ParseBlob(&checkpoint, &info.context_blob)) {
+            return false;
+          }
+          info.Init(is_session ? handle : 0);
+          info.is_loaded = false;
+          (*handles)[handle] = info;
+        }
+        return true;
+      };
+  std::unordered_map<TPM_HANDLE, HandleInfo> objects;
+  std::unordered_map<TPM_HANDLE, HandleInfo> sessions;
+  std::unordered_map<TPM_HANDLE, TPM_HANDLE> aliases;
+  std::vector<ContextMapping> mappings;
+  UINT32 alias_count = 0;
+  UINT32 mapping_count = 0;
+  if (!parse_handles(false, &objects) || !parse_handles(true, &sessions) ||
+      Parse_UINT32(&checkpoint, &alias_count, nullptr) != TPM_RC_SUCCESS) {
+    LOG(WARNING) << "Ignoring invalid checkpoint.";
+    return false;
+  }
+  for (UINT32 i = 0; i < alias_count; ++i) {
+    TPM_HANDLE alias = 0;
+    TPM_HANDLE owner = 0;
+    if (Parse_TPM_HANDLE(&checkpoint, &alias, nullptr) != TPM_RC_SUCCESS ||
+        Parse_TPM_HANDLE(&checkpoint, &owner, nullptr) != TPM_RC_SUCCESS) {
+      LOG(WARNING) << "Ignoring invalid checkpoint.";
+      return false;
+    }
+    // Objects that could not be saved are not in the checkpoint.
+    auto owner_iter = objects.find(owner);
+    if (owner_iter != objects.end()) {
+      aliases[alias] = owner;
+      ++owner_iter->second.alias_count;
+    }
+  }
+  if (Parse_UINT32(&checkpoint, &mapping_count, nullptr) != TPM_RC_SUCCESS) {
+    LOG(WARNING) << "Ignoring invalid checkpoint.";
+    return false;
+  }
+  for (UINT32 i = 0; i < mapping_count; ++i) {
+    ContextMapping mapping;
+    if (!ParseBlob(&checkpoint, &mapping.external_context) ||
+        !ParseBlob(&checkpoint, &mapping.actual_context)) {
+      LOG(WARNING) << "Ignoring invalid checkpoint.";
+      return false;
+    }
+    mappings.push_back(mapping);
+  }
+  if (!checkpoint.empty()) {
+    LOG(WARNING) << "Ignoring invalid checkpoint.";
+    return false;
+  }
+  next_virtual_handle_ = next_virtual_handle;
+  virtual_object_handles_.swap(objects);
+  session_handles_.swap(sessions);
+  object_aliases_.swap(aliases);
+  for (const auto& mapping : mappings) {
+    AddContextMapping(mapping.external_context, mapping.actual_context);
+  }
+  return true;
+}
+
 TPM_RC ResourceManager::SaveContext(const MessageInfo& command_info,
                                     HandleInfo* handle_info) {
   CHECK(handle_info->is_loaded);
   TPM_RC result = TPM_RC_SUCCESS;
+  TPMS_CONTEXT context;
+  memset(&context, 0, sizeof(TPMS_CONTEXT));
   int attempts = 0;
   while (attempts++ < kMaxCommandAttempts) {
     std::string tpm_handle_name;
     Serialize_TPM_HANDLE(handle_info->tpm_handle, &tpm_handle_name);
     result = factory_.GetTpm()->ContextSaveSync(handle_info->tpm_handle,
-                                                tpm_handle_name,
-                                                &handle_info->context, nullptr);
+                                                tpm_handle_name, &context,
+                                                nullptr);
     if (!FixWarnings(command_info, result)) {
       break;
     }
@@ -817,13 +1277,20 @@ TPM_RC ResourceManager::SaveContext(const MessageInfo& command_info,
                << ": Failed to load context: " << GetErrorString(result);
     return result;
   }
+  std::string context_blob;
+  result = Serialize_TPMS_CONTEXT(context, &context_blob);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << __func__
+               << ": Failed to serialize context: " << GetErrorString(result);
+    return result;
+  }
+  handle_info->context_blob.swap(context_blob);
   handle_info->is_loaded = false;
   return result;
 }
 
-ResourceManager::HandleInfo::HandleInfo() : is_loaded(false), tpm_handle(0) {
-  memset(&context, 0, sizeof(TPMS_CONTEXT));
-}
+ResourceManager::HandleInfo::HandleInfo()
+    : is_loaded(false), tpm_handle(0), alias_count(0) {}
 
 void ResourceManager::HandleInfo::Init(TPM_HANDLE handle) {
   tpm_handle = handle;
@@ -19,11 +19,12 @@
 
 #include "trunks/command_transceiver.h"
 
-#include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include <base/files/file_path.h>
 #include <base/location.h>
 #include <base/macros.h>
 #include <base/time/time.h>
@@ -48,6 +49,12 @@ namespace trunks {
 // is supported but does not return until the callback has been called. Keeping
 // ResourceManager synchronous simplifies the code and improves readability.
 // This class works well with a BackgroundCommandTransceiver.
+//
+// When a key blob that is already loaded is loaded again under the same
+// parent, the new TPM object is flushed right away and the caller gets an alias
+// virtual handle for the existing object. The object is only flushed once its
+// last handle is flushed. The Load itself still goes to the TPM so the parent
+// authorization is checked and authorization sessions stay in sync.
 class ResourceManager : public CommandTransceiver {
  public:
   // The given |factory| will be used to create objects so mocks can be easily
@@ -59,8 +66,26 @@ class ResourceManager : public CommandTransceiver {
                   CommandTransceiver* next_transceiver);
   ~ResourceManager() override;
 
+  // Enables checkpointing to |checkpoint_file|, which should be on a tmpfs so
+  // it does not outlive a reboot. Must be called before Initialize().
+  void set_checkpoint_file(const base::FilePath& checkpoint_file) {
+    checkpoint_file_ = checkpoint_file;
+  }
+
+  // Starts up the TPM and flushes existing transient objects and sessions. If
+  // checkpointing is enabled and a checkpoint from a previous instance exists,
+  // its objects and sessions are restored instead of flushed so that handles
+  // given out by that instance remain valid. Restored contexts are only loaded
+  // when they are first used. A checkpoint is discarded if the TPM has been
+  // reset or restarted since it was written.
   void Initialize();
 
+  // Saves the context of every loaded object and session and writes them, the
+  // virtual handle mappings and the external context mappings to the
+  // checkpoint file. Does nothing if checkpointing is not enabled. This is
+  // intended for a clean shutdown; no commands should follow.
+  void Checkpoint();
+
   // CommandTransceiver methods.
   void SendCommand(const std::string& command,
                    const ResponseCallback& callback) override;
@@ -75,6 +100,8 @@ class ResourceManager : public CommandTransceiver {
     std::vector<TPM_HANDLE> session_handles;
     std::vector<bool> session_continued;
     std::string parameter_data;
+    // Bit i is set if |handles[i]| is flushed by a successful command.
+    uint8_t invalidated_handles = 0;
   };
 
   struct HandleInfo {
@@ -85,14 +112,56 @@ class ResourceManager : public CommandTransceiver {
     bool is_loaded;
     // Valid only if |is_loaded| is true.
     TPM_HANDLE tpm_handle;
-    // Valid only if |is_loaded| is false.
-    TPMS_CONTEXT context;
+    // The serialized TPMS_CONTEXT. Valid only if |is_loaded| is false. This is
+    // kept serialized because a TPMS_CONTEXT reserves MAX_CONTEXT_SIZE bytes
+    // while actual contexts are much smaller.
+    std::string context_blob;
     // Time when the handle is create.
     base::TimeTicks time_of_create;
     // Time when the handle was last used.
     base::TimeTicks time_of_last_use;
+    // For a loaded key, the key in |loaded_objects_|. Empty otherwise.
+    std::string load_key;
+    // The number of alias handles in |object_aliases_| for this object.
+    size_t alias_count;
+  };
+
+  // Associates an external context blob given to a caller with the actual
+  // context blob which must be loaded in its place.
+  struct ContextMapping {
+    std::string external_context;
+    std::string actual_context;
   };
 
+  // A multimap from a 64-bit context digest to indices in |context_mappings_|.
+  // Digests may collide so candidates must be verified against the full blob.
+  typedef std::unordered_multimap<uint64_t, size_t> ContextIndex;
+
+  // Tracks |external_context| as being backed by |actual_context|, replacing
+  // any mapping of either blob.
+  void AddContextMapping(const std::string& external_context,
+                         const std::string& actual_context);
+
+  // Reads the TPM reset and restart counters. Returns true on success.
+  bool ReadTpmCounters(UINT32* reset_count, UINT32* restart_count);
+
+  // Reads the checkpoint file and restores its state. Returns false, having
+  // restored nothing, if there is no valid checkpoint for the current TPM
+  // power cycle.
+  bool RestoreCheckpoint();
+
+  // Finds the mapping whose actual context is |actual_context|. Returns the
+  // index in |context_mappings_| or kNoContextMapping.
+  size_t FindContextMappingByActual(const std::string& actual_context) const;
+
+  // Finds the mapping whose external context is |external_context|. Returns
+  // the index in |context_mappings_| or kNoContextMapping.
+  size_t FindContextMappingByExternal(
+      const std::string& external_context) const;
+
+  // Removes the mapping at |index| and releases its slot.
+  void RemoveContextMapping(size_t index);
+
   // Chooses an appropriate session for eviction (or flush) which is not one of
   // |sessions_to_retain| and assigns it to |session_to_evict|. Returns true on
   // success.
@@ -106,6 +175,12 @@ class ResourceManager : public CommandTransceiver {
   // valid handle is flushed and re-used.
   TPM_HANDLE CreateVirtualHandle();
 
+  // Returns the key identifying the object loaded by a successful Load command
+  // in |loaded_objects_|: the parent, the object name and the private blob.
+  // Returns an empty string if the messages cannot be parsed.
+  std::string GetLoadKey(const MessageInfo& command_info,
+                         const MessageInfo& response_info);
+
   // Given a session handle, ensures the session is loaded in the TPM.
   TPM_RC EnsureSessionIsLoaded(const MessageInfo& command_info,
                                TPM_HANDLE session_handle);
@@ -199,6 +274,20 @@ class ResourceManager : public CommandTransceiver {
   // a new one if necessary.
   TPM_HANDLE ProcessOutputHandle(TPM_HANDLE object_handle);
 
+  // Like ProcessOutputHandle but for the object created by a successful Load
+  // command. If the same blob is already loaded, the new TPM object is flushed
+  // and an alias of the existing object is returned.
+  TPM_HANDLE ProcessLoadOutputHandle(const MessageInfo& command_info,
+                                     const MessageInfo& response_info);
+
+  // Makes one of the aliases of |virtual_handle| the handle that owns the
+  // object, so |virtual_handle| can be released.
+  void PromoteObjectAlias(TPM_HANDLE virtual_handle);
+
+  // Returns the virtual handle that owns the object of |virtual_handle|. This
+  // is |virtual_handle| unless it is an alias.
+  TPM_HANDLE ResolveObjectAlias(TPM_HANDLE virtual_handle) const;
+
   // Replaces all handles in a given |message| with |new_handles| and returns
   // the resulting modified message. The modified message is guaranteed to have
   // the same length as the input message.
@@ -211,18 +300,31 @@ class ResourceManager : public CommandTransceiver {
 
   const TrunksFactory& factory_;
   CommandTransceiver* next_transceiver_ = nullptr;
+  // Where state is checkpointed across restarts. Empty if disabled.
+  base::FilePath checkpoint_file_;
   TPM_HANDLE next_virtual_handle_ = TRANSIENT_FIRST;
 
   // A mapping of known virtual handles to corresponding HandleInfo.
-  std::map<TPM_HANDLE, HandleInfo> virtual_object_handles_;
+  std::unordered_map<TPM_HANDLE, HandleInfo> virtual_object_handles_;
   // A mapping of loaded tpm object handles to the corresponding virtual handle.
-  std::map<TPM_HANDLE, TPM_HANDLE> tpm_object_handles_;
+  std::unordered_map<TPM_HANDLE, TPM_HANDLE> tpm_object_handles_;
+  // A mapping of alias virtual handles to the virtual handle in
+  // |virtual_object_handles_| that owns the object.
+  std::unordered_map<TPM_HANDLE, TPM_HANDLE> object_aliases_;
+  // A mapping of load keys (see GetLoadKey) to the virtual handle that owns the
+  // loaded object.
+  std::unordered_map<std::string, TPM_HANDLE> loaded_objects_;
   // A mapping of known session handles to corresponding HandleInfo.
-  std::map<TPM_HANDLE, HandleInfo> session_handles_;
-  // A mapping of external context blobs to current context blobs.
-  std::map<std::string, std::string> external_context_to_actual_;
-  // A mapping of actual context blobs to external context blobs.
-  std::map<std::string, std::string> actual_context_to_external_;
+  std::unordered_map<TPM_HANDLE, HandleInfo> session_handles_;
+  // The external to actual context mappings. Each blob is stored once here and
+  // referenced by index from the digest indices below. Unused slots are listed
+  // in |free_context_mappings_| for reuse.
+  std::vector<ContextMapping> context_mappings_;
+  std::vector<size_t> free_context_mappings_;
+  // Indices of |context_mappings_| keyed by digest of the external context.
+  ContextIndex external_context_index_;
+  // Indices of |context_mappings_| keyed by digest of the actual context.
+  ContextIndex actual_context_index_;
 
   // The set of warnings already handled in the context of a FixWarnings() call.
   // Tracking this allows us to avoid re-entrance.
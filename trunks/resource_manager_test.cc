@@ -20,6 +20,8 @@
 #include <vector>
 
 #include <base/bind.h>
+#include <base/files/file_util.h>
+#include <base/files/scoped_temp_dir.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -162,6 +164,59 @@ class ResourceManagerTest : public testing::Test {
     return virtual_handle;
   }
 
+  // Loads a key with the given |private_blob| and |name| under
+  // PERSISTENT_FIRST. The TPM assigns |handle| to the new object. Returns the
+  // virtual handle given to the caller.
+  TPM_HANDLE LoadBlob(TPM_HANDLE handle,
+                      const std::string& private_blob,
+                      const std::string& name) {
+    std::vector<TPM_HANDLE> input_handles = {PERSISTENT_FIRST};
+    std::string parameters;
+    Serialize_TPM2B_PRIVATE(Make_TPM2B_PRIVATE(private_blob), &parameters);
+    // The public area is not parsed by the resource manager.
+    parameters.append("public");
+    std::string command = CreateCommand(TPM_CC_Load, input_handles,
+                                        kNoAuthorization, parameters);
+    std::string name_parameter;
+    Serialize_TPM2B_NAME(Make_TPM2B_NAME(name), &name_parameter);
+    std::vector<TPM_HANDLE> output_handles = {handle};
+    std::string response = CreateResponse(TPM_RC_SUCCESS, output_handles,
+                                          kNoAuthorization, name_parameter);
+    EXPECT_CALL(transceiver_, SendCommandAndWait(command))
+        .WillOnce(Return(response));
+    std::string actual_response = resource_manager_.SendCommandAndWait(command);
+    std::string handle_blob = StripHeader(actual_response);
+    TPM_HANDLE virtual_handle;
+    CHECK_EQ(TPM_RC_SUCCESS,
+             Parse_TPM_HANDLE(&handle_blob, &virtual_handle, NULL));
+    return virtual_handle;
+  }
+
+  // Sends a Sign command for |virtual_handle| and expects the resource manager
+  // to use |tpm_handle|.
+  void ExpectSignWithHandle(TPM_HANDLE virtual_handle, TPM_HANDLE tpm_handle) {
+    std::vector<TPM_HANDLE> input_handles = {virtual_handle};
+    std::string command = CreateCommand(TPM_CC_Sign, input_handles,
+                                        kNoAuthorization, kNoParameters);
+    std::vector<TPM_HANDLE> expected_input_handles = {tpm_handle};
+    std::string expected_command = CreateCommand(
+        TPM_CC_Sign, expected_input_handles, kNoAuthorization, kNoParameters);
+    std::string response = CreateResponse(TPM_RC_SUCCESS, kNoHandles,
+                                          kNoAuthorization, kNoParameters);
+    EXPECT_CALL(transceiver_, SendCommandAndWait(expected_command))
+        .WillOnce(Return(response));
+    EXPECT_EQ(response, resource_manager_.SendCommandAndWait(command));
+  }
+
+  // Sends a FlushContext command for |virtual_handle|.
+  std::string FlushHandle(TPM_HANDLE virtual_handle) {
+    std::string parameters;
+    Serialize_TPM_HANDLE(virtual_handle, &parameters);
+    std::string command = CreateCommand(TPM_CC_FlushContext, kNoHandles,
+                                        kNoAuthorization, parameters);
+    return resource_manager_.SendCommandAndWait(command);
+  }
+
   // Causes the resource manager to evict existing object handles.
   void EvictObjects() {
     std::string command = CreateCommand(TPM_CC_Startup, kNoHandles,
@@ -330,6 +385,39 @@ TEST_F(ResourceManagerTest, VirtualHandleCleanup) {
   EXPECT_EQ(response, actual_response);
 }
 
+TEST_F(ResourceManagerTest, SequenceHandleCleanup) {
+  TPM_HANDLE tpm_handle = kArbitraryObjectHandle;
+  TPM_HANDLE virtual_handle = LoadHandle(tpm_handle);
+  std::vector<TPM_HANDLE> input_handles = {virtual_handle};
+  std::string command = CreateCommand(TPM_CC_SequenceComplete, input_handles,
+                                      kNoAuthorization, kNoParameters);
+  std::vector<TPM_HANDLE> expected_input_handles = {tpm_handle};
+  std::string expected_command =
+      CreateCommand(TPM_CC_SequenceComplete, expected_input_handles,
+                    kNoAuthorization, kNoParameters);
+  std::string response = CreateResponse(TPM_RC_SUCCESS, kNoHandles,
+                                        kNoAuthorization, kNoParameters);
+  EXPECT_CALL(transceiver_, SendCommandAndWait(expected_command))
+      .WillOnce(Return(response));
+  std::string actual_response = resource_manager_.SendCommandAndWait(command);
+  EXPECT_EQ(response, actual_response);
+  // The TPM flushes a completed sequence so |virtual_handle| is gone too.
+  command = CreateCommand(TPM_CC_Sign, input_handles, kNoAuthorization,
+                          kNoParameters);
+  response = CreateErrorResponse(TPM_RC_HANDLE | kResourceManagerTpmErrorBase);
+  actual_response = resource_manager_.SendCommandAndWait(command);
+  EXPECT_EQ(response, actual_response);
+}
+
+TEST_F(ResourceManagerTest, UnassignedCommandCode) {
+  std::string command =
+      CreateCommand(0x123, kNoHandles, kNoAuthorization, kNoParameters);
+  std::string response =
+      CreateErrorResponse(TPM_RC_COMMAND_CODE | kResourceManagerTpmErrorBase);
+  std::string actual_response = resource_manager_.SendCommandAndWait(command);
+  EXPECT_EQ(response, actual_response);
+}
+
 TEST_F(ResourceManagerTest, VirtualHandleLoadBeforeUse) {
   TPM_HANDLE tpm_handle = kArbitraryObjectHandle;
   TPM_HANDLE virtual_handle = LoadHandle(tpm_handle);
@@ -693,6 +781,160 @@ TEST_F(ResourceManagerTest, ExternalContext) {
   EXPECT_EQ(context_load_response, actual_response);
 }
 
+TEST_F(ResourceManagerTest, ExternalContextFlushed) {
+  StartSession(kArbitrarySessionHandle);
+  // Do an external context save.
+  std::vector<TPM_HANDLE> handles = {kArbitrarySessionHandle};
+  std::string context_save = CreateCommand(TPM_CC_ContextSave, handles,
+                                           kNoAuthorization, kNoParameters);
+  std::string context_parameter1 = CreateContextParameter(1);
+  std::string context_save_response1 = CreateResponse(
+      TPM_RC_SUCCESS, kNoHandles, kNoAuthorization, context_parameter1);
+  EXPECT_CALL(transceiver_, SendCommandAndWait(context_save))
+      .WillOnce(Return(context_save_response1));
+  std::string actual_response =
+      resource_manager_.SendCommandAndWait(context_save);
+  EXPECT_EQ(context_save_response1, actual_response);
+
+  // Invoke a context gap (which will cause context1 to be mapped to context2).
+  EXPECT_CALL(tpm_, ContextLoadSync(_, _, _)).WillOnce(Return(TPM_RC_SUCCESS));
+  EXPECT_CALL(tpm_, ContextSaveSync(kArbitrarySessionHandle, _, _, _))
+      .WillOnce(DoAll(SetArgumentPointee<2>(CreateContext(2)),
+                      Return(TPM_RC_SUCCESS)));
+  std::string command = CreateCommand(TPM_CC_Startup, kNoHandles,
+                                      kNoAuthorization, kNoParameters);
+  std::string success_response = CreateResponse(
+      TPM_RC_SUCCESS, kNoHandles, kNoAuthorization, kNoParameters);
+  EXPECT_CALL(transceiver_, SendCommandAndWait(command))
+      .WillOnce(Return(CreateErrorResponse(TPM_RC_CONTEXT_GAP)))
+      .WillOnce(Return(success_response));
+  actual_response = resource_manager_.SendCommandAndWait(command);
+  EXPECT_EQ(success_response, actual_response);
+
+  // Flush the session, this should drop the context mapping.
+  std::string parameters;
+  Serialize_TPM_HANDLE(kArbitrarySessionHandle, &parameters);
+  std::string flush = CreateCommand(TPM_CC_FlushContext, kNoHandles,
+                                    kNoAuthorization, parameters);
+  EXPECT_CALL(transceiver_, SendCommandAndWait(flush))
+      .WillOnce(Return(success_response));
+  actual_response = resource_manager_.SendCommandAndWait(flush);
+  EXPECT_EQ(success_response, actual_response);
+
+  // Loading external context1 now passes it through unmodified.
+  std::string context_load1 = CreateCommand(
+      TPM_CC_ContextLoad, kNoHandles, kNoAuthorization, context_parameter1);
+  std::string context_load_response =
+      CreateResponse(TPM_RC_SUCCESS, handles, kNoAuthorization, kNoParameters);
+  EXPECT_CALL(transceiver_, SendCommandAndWait(context_load1))
+      .WillOnce(Return(context_load_response));
+  actual_response = resource_manager_.SendCommandAndWait(context_load1);
+  EXPECT_EQ(context_load_response, actual_response);
+}
+
+TEST_F(ResourceManagerTest, CheckpointAndRestore) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath checkpoint_file = temp_dir.path().Append("checkpoint");
+  resource_manager_.set_checkpoint_file(checkpoint_file);
+  TPM_HANDLE virtual_handle = LoadHandle(kArbitraryObjectHandle);
+  StartSession(kArbitrarySessionHandle);
+  TPMS_TIME_INFO time_info;
+  memset(&time_info, 0, sizeof(time_info));
+  time_info.clock_info.reset_count = 1;
+  time_info.clock_info.restart_count = 2;
+  EXPECT_CALL(tpm_, ReadClockSync(_, _))
+      .WillRepeatedly(
+          DoAll(SetArgumentPointee<0>(time_info), Return(TPM_RC_SUCCESS)));
+  // Loaded objects are saved and flushed, loaded sessions are only saved.
+  EXPECT_CALL(tpm_, ContextSaveSync(kArbitraryObjectHandle, _, _, _))
+      .WillOnce(DoAll(SetArgumentPointee<2>(CreateContext(1)),
+                      Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(tpm_, FlushContextSync(kArbitraryObjectHandle, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  EXPECT_CALL(tpm_, ContextSaveSync(kArbitrarySessionHandle, _, _, _))
+      .WillOnce(DoAll(SetArgumentPointee<2>(CreateContext(2)),
+                      Return(TPM_RC_SUCCESS)));
+  resource_manager_.Checkpoint();
+  ASSERT_TRUE(base::PathExists(checkpoint_file));
+  // A new resource manager picks up where the first one left off.
+  ResourceManager restored_manager(factory_, &transceiver_);
+  restored_manager.set_checkpoint_file(checkpoint_file);
+  TPMS_CAPABILITY_DATA no_handles;
+  memset(&no_handles, 0, sizeof(no_handles));
+  EXPECT_CALL(tpm_, GetCapabilitySync(TPM_CAP_HANDLES, _, _, _, _, _))
+      .WillRepeatedly(DoAll(SetArgumentPointee<3>(NO),
+                            SetArgumentPointee<4>(no_handles),
+                            Return(TPM_RC_SUCCESS)));
+  restored_manager.Initialize();
+  EXPECT_FALSE(base::PathExists(checkpoint_file));
+  TPM_HANDLE new_tpm_handle = kArbitraryObjectHandle + 1;
+  std::vector<TPM_HANDLE> input_handles = {virtual_handle};
+  std::string command = CreateCommand(
+      TPM_CC_Sign, input_handles,
+      CreateCommandAuthorization(kArbitrarySessionHandle,
+                                 true),  // continue_session
+      kNoParameters);
+  std::vector<TPM_HANDLE> expected_input_handles = {new_tpm_handle};
+  std::string expected_command = CreateCommand(
+      TPM_CC_Sign, expected_input_handles,
+      CreateCommandAuthorization(kArbitrarySessionHandle,
+                                 true),  // continue_session
+      kNoParameters);
+  std::string response =
+      CreateResponse(TPM_RC_SUCCESS, kNoHandles,
+                     CreateResponseAuthorization(true),  // continue_session
+                     kNoParameters);
+  EXPECT_CALL(tpm_, ContextLoadSync(Field(&TPMS_CONTEXT::sequence, Eq(1u)),
+                                    _, _))
+      .WillOnce(DoAll(SetArgumentPointee<1>(new_tpm_handle),
+                      Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(tpm_, ContextLoadSync(Field(&TPMS_CONTEXT::sequence, Eq(2u)),
+                                    _, _))
+      .WillOnce(DoAll(SetArgumentPointee<1>(kArbitrarySessionHandle),
+                      Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(transceiver_, SendCommandAndWait(expected_command))
+      .WillOnce(Return(response));
+  EXPECT_EQ(response, restored_manager.SendCommandAndWait(command));
+}
+
+TEST_F(ResourceManagerTest, CheckpointDiscardedAfterTpmReset) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath checkpoint_file = temp_dir.path().Append("checkpoint");
+  resource_manager_.set_checkpoint_file(checkpoint_file);
+  TPM_HANDLE virtual_handle = LoadHandle(kArbitraryObjectHandle);
+  TPMS_TIME_INFO time_info;
+  memset(&time_info, 0, sizeof(time_info));
+  TPMS_TIME_INFO time_info_after_reset = time_info;
+  time_info_after_reset.clock_info.reset_count = 1;
+  EXPECT_CALL(tpm_, ReadClockSync(_, _))
+      .WillOnce(DoAll(SetArgumentPointee<0>(time_info), Return(TPM_RC_SUCCESS)))
+      .WillOnce(DoAll(SetArgumentPointee<0>(time_info_after_reset),
+                      Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(tpm_, ContextSaveSync(kArbitraryObjectHandle, _, _, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  EXPECT_CALL(tpm_, FlushContextSync(kArbitraryObjectHandle, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  resource_manager_.Checkpoint();
+  ResourceManager restored_manager(factory_, &transceiver_);
+  restored_manager.set_checkpoint_file(checkpoint_file);
+  TPMS_CAPABILITY_DATA no_handles;
+  memset(&no_handles, 0, sizeof(no_handles));
+  EXPECT_CALL(tpm_, GetCapabilitySync(TPM_CAP_HANDLES, _, _, _, _, _))
+      .WillRepeatedly(DoAll(SetArgumentPointee<3>(NO),
+                            SetArgumentPointee<4>(no_handles),
+                            Return(TPM_RC_SUCCESS)));
+  restored_manager.Initialize();
+  EXPECT_FALSE(base::PathExists(checkpoint_file));
+  std::vector<TPM_HANDLE> input_handles = {virtual_handle};
+  std::string command = CreateCommand(TPM_CC_Sign, input_handles,
+                                      kNoAuthorization, kNoParameters);
+  std::string response =
+      CreateErrorResponse(TPM_RC_HANDLE | kResourceManagerTpmErrorBase);
+  EXPECT_EQ(response, restored_manager.SendCommandAndWait(command));
+}
+
 TEST_F(ResourceManagerTest, NestedFailures) {
   // The scenario being tested is when a command results in a warning to be
   // handled by the resource manager, and in the process of handling the first
@@ -764,6 +1006,80 @@ TEST_F(ResourceManagerTest, ReentrantFixGap) {
   EXPECT_EQ(error_response, response);
 }
 
+TEST_F(ResourceManagerTest, SharedLoadedObject) {
+  TPM_HANDLE tpm_handle = kArbitraryObjectHandle;
+  TPM_HANDLE duplicate_tpm_handle = kArbitraryObjectHandle + 1;
+  TPM_HANDLE virtual_handle = LoadBlob(tpm_handle, "private", "name");
+  // Loading the same blob again keeps only the first TPM object.
+  EXPECT_CALL(tpm_, FlushContextSync(duplicate_tpm_handle, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  TPM_HANDLE alias = LoadBlob(duplicate_tpm_handle, "private", "name");
+  EXPECT_NE(virtual_handle, alias);
+  ExpectSignWithHandle(alias, tpm_handle);
+  ExpectSignWithHandle(virtual_handle, tpm_handle);
+}
+
+TEST_F(ResourceManagerTest, SharedLoadedObjectFlush) {
+  TPM_HANDLE tpm_handle = kArbitraryObjectHandle;
+  TPM_HANDLE virtual_handle = LoadBlob(tpm_handle, "private", "name");
+  EXPECT_CALL(tpm_, FlushContextSync(kArbitraryObjectHandle + 1, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  TPM_HANDLE alias = LoadBlob(kArbitraryObjectHandle + 1, "private", "name");
+  // Flushing the first handle does not reach the TPM while the alias is open.
+  std::string success_response = CreateErrorResponse(TPM_RC_SUCCESS);
+  EXPECT_EQ(success_response, FlushHandle(virtual_handle));
+  ExpectSignWithHandle(alias, tpm_handle);
+  // The flushed handle is gone.
+  std::vector<TPM_HANDLE> input_handles = {virtual_handle};
+  std::string command = CreateCommand(TPM_CC_Sign, input_handles,
+                                      kNoAuthorization, kNoParameters);
+  EXPECT_EQ(CreateErrorResponse(TPM_RC_HANDLE | kResourceManagerTpmErrorBase),
+            resource_manager_.SendCommandAndWait(command));
+  // Flushing the last handle flushes the object.
+  std::string expected_parameters;
+  Serialize_TPM_HANDLE(tpm_handle, &expected_parameters);
+  std::string expected_command = CreateCommand(
+      TPM_CC_FlushContext, kNoHandles, kNoAuthorization, expected_parameters);
+  std::string response = CreateResponse(TPM_RC_SUCCESS, kNoHandles,
+                                        kNoAuthorization, kNoParameters);
+  EXPECT_CALL(transceiver_, SendCommandAndWait(expected_command))
+      .WillOnce(Return(response));
+  EXPECT_EQ(response, FlushHandle(alias));
+  // A new load of the blob creates a new object.
+  TPM_HANDLE new_handle =
+      LoadBlob(kArbitraryObjectHandle + 2, "private", "name");
+  ExpectSignWithHandle(new_handle, kArbitraryObjectHandle + 2);
+}
+
+TEST_F(ResourceManagerTest, SharedLoadedObjectEvicted) {
+  TPM_HANDLE virtual_handle =
+      LoadBlob(kArbitraryObjectHandle, "private", "name");
+  EXPECT_CALL(tpm_, FlushContextSync(kArbitraryObjectHandle + 1, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  TPM_HANDLE alias = LoadBlob(kArbitraryObjectHandle + 1, "private", "name");
+  EvictObjects();
+  testing::Mock::VerifyAndClearExpectations(&tpm_);
+  testing::Mock::VerifyAndClearExpectations(&transceiver_);
+  // Both handles are restored with one ContextLoad.
+  TPM_HANDLE new_tpm_handle = kArbitraryObjectHandle + 2;
+  EXPECT_CALL(tpm_, ContextLoadSync(_, _, _))
+      .WillOnce(DoAll(SetArgumentPointee<1>(new_tpm_handle),
+                      Return(TPM_RC_SUCCESS)));
+  ExpectSignWithHandle(alias, new_tpm_handle);
+  ExpectSignWithHandle(virtual_handle, new_tpm_handle);
+}
+
+TEST_F(ResourceManagerTest, DifferentBlobsNotShared) {
+  TPM_HANDLE virtual_handle =
+      LoadBlob(kArbitraryObjectHandle, "private", "name");
+  // Same name but a different private blob, e.g. after an auth change.
+  TPM_HANDLE other_handle =
+      LoadBlob(kArbitraryObjectHandle + 1, "private2", "name");
+  EXPECT_NE(virtual_handle, other_handle);
+  ExpectSignWithHandle(virtual_handle, kArbitraryObjectHandle);
+  ExpectSignWithHandle(other_handle, kArbitraryObjectHandle + 1);
+}
+
 TEST_F(ResourceManagerTest, PasswordAuthorization) {
   std::string command =
       CreateCommand(TPM_CC_Startup, kNoHandles,
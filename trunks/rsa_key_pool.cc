@@ -0,0 +1,100 @@
+//
+// Copyright (C) 2015 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/rsa_key_pool.h"
+
+namespace trunks {
+
+bool RsaKeyPool::KeyTemplate::operator<(const KeyTemplate& other) const {
+  if (key_type != other.key_type) {
+    return key_type < other.key_type;
+  }
+  if (modulus_bits != other.modulus_bits) {
+    return modulus_bits < other.modulus_bits;
+  }
+  return public_exponent < other.public_exponent;
+}
+
+RsaKeyPool::RsaKeyPool() {}
+
+RsaKeyPool::~RsaKeyPool() {}
+
+void RsaKeyPool::Configure(size_t size, base::TimeDelta idle_time) {
+  base::AutoLock lock(lock_);
+  size_ = size;
+  idle_time_ = idle_time;
+  if (size_ == 0) {
+    keys_.clear();
+  }
+}
+
+bool RsaKeyPool::IsEnabled() {
+  base::AutoLock lock(lock_);
+  return size_ > 0;
+}
+
+void RsaKeyPool::AddTemplate(const KeyTemplate& key_template) {
+  base::AutoLock lock(lock_);
+  keys_[key_template];
+}
+
+bool RsaKeyPool::TakeKey(const KeyTemplate& key_template, PooledKey* key) {
+  base::AutoLock lock(lock_);
+  if (size_ == 0) {
+    return false;
+  }
+  last_request_time_ = base::TimeTicks::Now();
+  std::deque<PooledKey>& keys = keys_[key_template];
+  if (keys.empty()) {
+    return false;
+  }
+  *key = keys.front();
+  keys.pop_front();
+  return true;
+}
+
+bool RsaKeyPool::GetTemplateToFill(KeyTemplate* key_template) {
+  base::AutoLock lock(lock_);
+  if (size_ == 0 ||
+      base::TimeTicks::Now() - last_request_time_ < idle_time_) {
+    return false;
+  }
+  for (const auto& item : keys_) {
+    if (item.second.size() < size_) {
+      *key_template = item.first;
+      return true;
+    }
+  }
+  return false;
+}
+
+void RsaKeyPool::AddKey(const KeyTemplate& key_template, const PooledKey& key) {
+  base::AutoLock lock(lock_);
+  std::deque<PooledKey>& keys = keys_[key_template];
+  if (keys.size() >= size_) {
+    return;
+  }
+  keys.push_back(key);
+}
+
+void RsaKeyPool::Clear() {
+  base::AutoLock lock(lock_);
+  for (auto& item : keys_) {
+    item.second.clear();
+  }
+}
+
+}  // namespace trunks
@@ -0,0 +1,108 @@
+//
+// Copyright (C) 2015 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef TRUNKS_RSA_KEY_POOL_H_
+#define TRUNKS_RSA_KEY_POOL_H_
+
+#include <deque>
+#include <map>
+#include <string>
+
+#include <base/macros.h>
+#include <base/synchronization/lock.h>
+#include <base/time/time.h>
+
+#include "trunks/tpm_utility.h"
+#include "trunks/trunks_export.h"
+
+namespace trunks {
+
+// RsaKeyPool holds RSA keys that were generated ahead of time so that
+// CreateRSAKeyPair does not have to wait for the TPM to find primes on the
+// request path. Pooled keys are created under the RSA SRK with a random
+// temporary authorization value, which is replaced by the caller's when the
+// key is handed out. Only requests without a policy, policy-only authorization
+// or creation PCR are served from the pool.
+//
+// Pooled keys are kept in memory only. Changing the authorization value of a
+// key creates a new private blob, but the old blob can still be loaded with the
+// temporary value, so neither may outlive the pool entry.
+//
+// A single instance is owned by a TrunksFactory. The pool is disabled until
+// Configure() is called, and is filled by calling TpmUtility::FillRSAKeyPool
+// from an idle task. This class is thread-safe.
+class TRUNKS_EXPORT RsaKeyPool {
+ public:
+  // The parameters a pooled key must match to serve a request.
+  struct KeyTemplate {
+    TpmUtility::AsymmetricKeyUsage key_type;
+    int modulus_bits;
+    uint32_t public_exponent;
+
+    bool operator<(const KeyTemplate& other) const;
+  };
+
+  struct PooledKey {
+    // A key blob in the BlobParser format.
+    std::string key_blob;
+    // A creation blob in the BlobParser format.
+    std::string creation_blob;
+    // The temporary authorization value of the key.
+    std::string auth_value;
+  };
+
+  RsaKeyPool();
+  ~RsaKeyPool();
+
+  // Enables the pool. Up to |size| keys are kept for each template, and new
+  // keys are only generated once no key has been requested for |idle_time|. A
+  // |size| of zero disables the pool and drops every pooled key.
+  void Configure(size_t size, base::TimeDelta idle_time);
+
+  // Returns true if the pool has been enabled.
+  bool IsEnabled();
+
+  // Adds a template to keep keys for. Templates of requests that could not be
+  // served from the pool are added automatically.
+  void AddTemplate(const KeyTemplate& key_template);
+
+  // Removes a key matching |key_template| from the pool. Returns true and
+  // fills |key| if there was one. Every call restarts the idle timer.
+  bool TakeKey(const KeyTemplate& key_template, PooledKey* key);
+
+  // Returns true and fills |key_template| if the pool has been idle for long
+  // enough and has a template that is short of keys.
+  bool GetTemplateToFill(KeyTemplate* key_template);
+
+  // Adds a newly generated key for |key_template|.
+  void AddKey(const KeyTemplate& key_template, const PooledKey& key);
+
+  // Drops every pooled key, e.g. after the TPM has been cleared.
+  void Clear();
+
+ private:
+  base::Lock lock_;
+  size_t size_ = 0;
+  base::TimeDelta idle_time_;
+  base::TimeTicks last_request_time_;
+  std::map<KeyTemplate, std::deque<PooledKey>> keys_;
+
+  DISALLOW_COPY_AND_ASSIGN(RsaKeyPool);
+};
+
+}  // namespace trunks
+
+#endif  // TRUNKS_RSA_KEY_POOL_H_
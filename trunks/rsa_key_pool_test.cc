@@ -0,0 +1,129 @@
+//
+// Copyright (C) 2015 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/rsa_key_pool.h"
+
+#include <base/time/time.h>
+#include <gtest/gtest.h>
+
+namespace trunks {
+
+class RsaKeyPoolTest : public testing::Test {
+ public:
+  void SetUp() override {
+    key_template_ = {TpmUtility::AsymmetricKeyUsage::kSignKey, 2048, 0x10001};
+    key_.key_blob = "key_blob";
+    key_.creation_blob = "creation_blob";
+    key_.auth_value = "auth_value";
+  }
+
+ protected:
+  RsaKeyPool pool_;
+  RsaKeyPool::KeyTemplate key_template_;
+  RsaKeyPool::PooledKey key_;
+};
+
+TEST_F(RsaKeyPoolTest, DisabledByDefault) {
+  EXPECT_FALSE(pool_.IsEnabled());
+  pool_.AddKey(key_template_, key_);
+  RsaKeyPool::PooledKey key;
+  EXPECT_FALSE(pool_.TakeKey(key_template_, &key));
+  pool_.AddTemplate(key_template_);
+  RsaKeyPool::KeyTemplate key_template;
+  EXPECT_FALSE(pool_.GetTemplateToFill(&key_template));
+}
+
+TEST_F(RsaKeyPoolTest, TakeKey) {
+  pool_.Configure(2, base::TimeDelta());
+  EXPECT_TRUE(pool_.IsEnabled());
+  pool_.AddKey(key_template_, key_);
+  RsaKeyPool::PooledKey key;
+  ASSERT_TRUE(pool_.TakeKey(key_template_, &key));
+  EXPECT_EQ(key_.key_blob, key.key_blob);
+  EXPECT_EQ(key_.creation_blob, key.creation_blob);
+  EXPECT_EQ(key_.auth_value, key.auth_value);
+  // A key is handed out only once.
+  EXPECT_FALSE(pool_.TakeKey(key_template_, &key));
+}
+
+TEST_F(RsaKeyPoolTest, TemplatesDoNotMix) {
+  pool_.Configure(2, base::TimeDelta());
+  pool_.AddKey(key_template_, key_);
+  RsaKeyPool::KeyTemplate other_template = key_template_;
+  other_template.modulus_bits = 1024;
+  RsaKeyPool::PooledKey key;
+  EXPECT_FALSE(pool_.TakeKey(other_template, &key));
+  other_template = key_template_;
+  other_template.key_type = TpmUtility::AsymmetricKeyUsage::kDecryptKey;
+  EXPECT_FALSE(pool_.TakeKey(other_template, &key));
+  EXPECT_TRUE(pool_.TakeKey(key_template_, &key));
+}
+
+TEST_F(RsaKeyPoolTest, SizeLimit) {
+  pool_.Configure(1, base::TimeDelta());
+  pool_.AddKey(key_template_, key_);
+  RsaKeyPool::PooledKey extra_key = key_;
+  extra_key.key_blob = "extra_key_blob";
+  pool_.AddKey(key_template_, extra_key);
+  RsaKeyPool::PooledKey key;
+  ASSERT_TRUE(pool_.TakeKey(key_template_, &key));
+  EXPECT_EQ(key_.key_blob, key.key_blob);
+  EXPECT_FALSE(pool_.TakeKey(key_template_, &key));
+}
+
+TEST_F(RsaKeyPoolTest, GetTemplateToFill) {
+  pool_.Configure(1, base::TimeDelta());
+  RsaKeyPool::KeyTemplate key_template;
+  EXPECT_FALSE(pool_.GetTemplateToFill(&key_template));
+  // A request that misses the pool adds its template.
+  pool_.AddTemplate(key_template_);
+  ASSERT_TRUE(pool_.GetTemplateToFill(&key_template));
+  EXPECT_EQ(key_template_.modulus_bits, key_template.modulus_bits);
+  pool_.AddKey(key_template_, key_);
+  EXPECT_FALSE(pool_.GetTemplateToFill(&key_template));
+}
+
+TEST_F(RsaKeyPoolTest, FillWaitsForIdleTime) {
+  pool_.Configure(1, base::TimeDelta::FromDays(1));
+  RsaKeyPool::PooledKey key;
+  EXPECT_FALSE(pool_.TakeKey(key_template_, &key));
+  pool_.AddTemplate(key_template_);
+  RsaKeyPool::KeyTemplate key_template;
+  EXPECT_FALSE(pool_.GetTemplateToFill(&key_template));
+}
+
+TEST_F(RsaKeyPoolTest, Clear) {
+  pool_.Configure(2, base::TimeDelta());
+  pool_.AddKey(key_template_, key_);
+  pool_.Clear();
+  RsaKeyPool::PooledKey key;
+  EXPECT_FALSE(pool_.TakeKey(key_template_, &key));
+  // The template is kept so the pool is refilled.
+  RsaKeyPool::KeyTemplate key_template;
+  EXPECT_TRUE(pool_.GetTemplateToFill(&key_template));
+}
+
+TEST_F(RsaKeyPoolTest, DisablingDropsKeys) {
+  pool_.Configure(2, base::TimeDelta());
+  pool_.AddKey(key_template_, key_);
+  pool_.Configure(0, base::TimeDelta());
+  EXPECT_FALSE(pool_.IsEnabled());
+  pool_.Configure(2, base::TimeDelta());
+  RsaKeyPool::PooledKey key;
+  EXPECT_FALSE(pool_.TakeKey(key_template_, &key));
+}
+
+}  // namespace trunks
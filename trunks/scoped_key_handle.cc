@@ -69,6 +69,7 @@ TPM_HANDLE ScopedKeyHandle::get() const {
 
 void ScopedKeyHandle::FlushHandleContext(TPM_HANDLE handle) {
   TPM_RC result = TPM_RC_SUCCESS;
+  factory_.GetObjectCache()->RemoveObject(handle);
   result = factory_.GetTpm()->FlushContextSync(handle, nullptr);
   if (result) {
     LOG(WARNING) << "Error closing handle: " << handle << " : "
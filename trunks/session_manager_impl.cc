@@ -144,20 +144,30 @@ TPM_RC SessionManagerImpl::StartSession(
 
 TPM_RC SessionManagerImpl::EncryptSalt(const std::string& salt,
                                        std::string* encrypted_salt) {
-  TPM2B_NAME out_name;
-  TPM2B_NAME qualified_name;
-  TPM2B_PUBLIC public_data;
-  public_data.public_area.unique.rsa.size = 0;
-  TPM_RC result = factory_.GetTpm()->ReadPublicSync(
-      kSaltingKey, "" /*object_handle_name (not used)*/, &public_data,
-      &out_name, &qualified_name, nullptr /*authorization_delegate*/);
-  if (result != TPM_RC_SUCCESS) {
-    LOG(ERROR) << "Error fetching salting key public info: "
-               << GetErrorString(result);
-    return result;
+  TPMT_PUBLIC salting_key_public;
+  TpmObjectCache* object_cache = factory_.GetObjectCache();
+  if (!object_cache->GetObject(kSaltingKey, &salting_key_public, nullptr)) {
+    TPM2B_NAME out_name;
+    out_name.size = 0;
+    TPM2B_NAME qualified_name;
+    TPM2B_PUBLIC public_data;
+    public_data.public_area.unique.rsa.size = 0;
+    TPM_RC result = factory_.GetTpm()->ReadPublicSync(
+        kSaltingKey, "" /*object_handle_name (not used)*/, &public_data,
+        &out_name, &qualified_name, nullptr /*authorization_delegate*/);
+    if (result != TPM_RC_SUCCESS) {
+      LOG(ERROR) << "Error fetching salting key public info: "
+                 << GetErrorString(result);
+      return result;
+    }
+    salting_key_public = public_data.public_area;
+    if (out_name.size > 0) {
+      object_cache->SetObject(kSaltingKey, salting_key_public,
+                              StringFrom_TPM2B_NAME(out_name));
+    }
   }
-  if (public_data.public_area.type != TPM_ALG_RSA ||
-      public_data.public_area.unique.rsa.size != 256) {
+  if (salting_key_public.type != TPM_ALG_RSA ||
+      salting_key_public.unique.rsa.size != 256) {
     LOG(ERROR) << "Invalid salting key attributes.";
     return TRUNKS_RC_SESSION_SETUP_ERROR;
   }
@@ -169,8 +179,8 @@ TPM_RC SessionManagerImpl::EncryptSalt(const std::string& salt,
   }
   BN_set_word(salting_key_rsa->e, kWellKnownExponent);
   salting_key_rsa->n =
-      BN_bin2bn(public_data.public_area.unique.rsa.buffer,
-                public_data.public_area.unique.rsa.size, nullptr);
+      BN_bin2bn(salting_key_public.unique.rsa.buffer,
+                salting_key_public.unique.rsa.size, nullptr);
   if (!salting_key_rsa->n) {
     LOG(ERROR) << "Error setting public area of rsa key: " << GetOpenSSLError();
     return TRUNKS_RC_SESSION_SETUP_ERROR;
@@ -0,0 +1,297 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/tpm_event_log.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+
+#include <base/logging.h>
+#include <base/posix/eintr_wrapper.h>
+#include <base/stl_util.h>
+
+namespace {
+
+// TCG PC Client Platform Firmware Profile, section 9.4.5.1.
+const uint32_t kEventNoAction = 0x3;
+const char kSpecIdSignature[] = "Spec ID Event03";
+const uint8_t kSpecVersionMajor = 2;
+const uint8_t kSpecVersionMinor = 0;
+const uint8_t kSpecErrata = 0;
+// UINTN is 64 bits.
+const uint8_t kUintnSize = 2;
+// pcrIndex, eventType, a SHA-1 digest and eventSize.
+const size_t kEventHeaderSize = 4 + 4 + SHA1_DIGEST_SIZE + 4;
+// Generous, a Spec ID event with every supported algorithm is far smaller.
+const uint32_t kMaxSpecIdSize = 1024;
+
+// Event log fields are little-endian, unlike TPM structures.
+void AppendUint8(uint8_t value, std::string* buffer) {
+  buffer->push_back(static_cast<char>(value));
+}
+
+void AppendUint16(uint16_t value, std::string* buffer) {
+  AppendUint8(value & 0xff, buffer);
+  AppendUint8(value >> 8, buffer);
+}
+
+void AppendUint32(uint32_t value, std::string* buffer) {
+  AppendUint16(value & 0xffff, buffer);
+  AppendUint16(value >> 16, buffer);
+}
+
+// Reads a little-endian value at |*offset| in |buffer| and advances |*offset|.
+// Returns false if |buffer| is too short.
+bool ReadUint16(const std::string& buffer, size_t* offset, uint16_t* value) {
+  if (buffer.size() < *offset + 2) {
+    return false;
+  }
+  *value = static_cast<uint8_t>(buffer[*offset]) |
+           (static_cast<uint8_t>(buffer[*offset + 1]) << 8);
+  *offset += 2;
+  return true;
+}
+
+bool ReadUint32(const std::string& buffer, size_t* offset, uint32_t* value) {
+  uint16_t low = 0;
+  uint16_t high = 0;
+  if (!ReadUint16(buffer, offset, &low) || !ReadUint16(buffer, offset, &high)) {
+    return false;
+  }
+  *value = low | (static_cast<uint32_t>(high) << 16);
+  return true;
+}
+
+// Reads exactly |size| bytes at |offset| in |fd|. Returns true on success.
+bool ReadAt(int fd, off_t offset, size_t size, std::string* data) {
+  data->resize(size);
+  ssize_t result =
+      HANDLE_EINTR(pread(fd, base::string_as_array(data), size, offset));
+  return result == static_cast<ssize_t>(size);
+}
+
+// Returns the digest size of |hash_alg|, or zero if it is not supported.
+uint16_t GetDigestSize(trunks::TPMI_ALG_HASH hash_alg) {
+  switch (hash_alg) {
+    case trunks::TPM_ALG_SHA1:
+      return SHA1_DIGEST_SIZE;
+    case trunks::TPM_ALG_SHA256:
+      return SHA256_DIGEST_SIZE;
+    case trunks::TPM_ALG_SHA384:
+      return SHA384_DIGEST_SIZE;
+    case trunks::TPM_ALG_SHA512:
+      return SHA512_DIGEST_SIZE;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+namespace trunks {
+
+TpmEventLog::TpmEventLog() {}
+
+TpmEventLog::~TpmEventLog() {
+  if (fd_.is_valid() && unsynced_events_ > 0) {
+    Sync();
+  }
+}
+
+bool TpmEventLog::Open(const base::FilePath& path, size_t sync_interval) {
+  base::ScopedFD fd(HANDLE_EINTR(
+      open(path.value().c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC,
+           S_IRUSR | S_IWUSR)));
+  if (!fd.is_valid()) {
+    PLOG(ERROR) << __func__ << ": Failed to open " << path.value();
+    return false;
+  }
+  struct stat file_info;
+  if (fstat(fd.get(), &file_info) < 0) {
+    PLOG(ERROR) << __func__ << ": Failed to stat " << path.value();
+    return false;
+  }
+  fd_ = std::move(fd);
+  algorithms_.clear();
+  if (file_info.st_size > 0 && !ReadHeader()) {
+    LOG(ERROR) << __func__ << ": Not appending to " << path.value()
+               << ", it does not start with a valid Spec ID event.";
+    fd_.reset();
+    return false;
+  }
+  sync_interval_ = sync_interval;
+  unsynced_events_ = 0;
+  return true;
+}
+
+bool TpmEventLog::MatchesAlgorithms(const TPML_DIGEST_VALUES& digests) const {
+  if (algorithms_.empty()) {
+    return true;
+  }
+  if (digests.count != algorithms_.size()) {
+    return false;
+  }
+  for (uint32_t i = 0; i < digests.count; ++i) {
+    if (std::find(algorithms_.begin(), algorithms_.end(),
+                  digests.digests[i].hash_alg) == algorithms_.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TpmEventLog::AppendEvent(uint32_t pcr_index,
+                              uint32_t event_type,
+                              const TPML_DIGEST_VALUES& digests,
+                              const std::string& event_data) {
+  if (!fd_.is_valid()) {
+    LOG(ERROR) << __func__ << ": Event log is not open.";
+    return false;
+  }
+  if (digests.count == 0 || digests.count > HASH_COUNT) {
+    LOG(ERROR) << __func__ << ": Bad digest count " << digests.count;
+    return false;
+  }
+  // Every event must be replayable against every bank in the Spec ID event.
+  if (!MatchesAlgorithms(digests)) {
+    LOG(ERROR) << __func__
+               << ": Digests do not match the algorithms of the event log.";
+    return false;
+  }
+  std::string event;
+  if (algorithms_.empty()) {
+    // The Spec ID event uses the SHA-1 event format with a zero digest.
+    std::string spec_id(kSpecIdSignature, sizeof(kSpecIdSignature));
+    AppendUint32(0, &spec_id);  // platformClass
+    AppendUint8(kSpecVersionMinor, &spec_id);
+    AppendUint8(kSpecVersionMajor, &spec_id);
+    AppendUint8(kSpecErrata, &spec_id);
+    AppendUint8(kUintnSize, &spec_id);
+    AppendUint32(digests.count, &spec_id);
+    for (uint32_t i = 0; i < digests.count; ++i) {
+      AppendUint16(digests.digests[i].hash_alg, &spec_id);
+      AppendUint16(GetDigestSize(digests.digests[i].hash_alg), &spec_id);
+    }
+    AppendUint8(0, &spec_id);  // vendorInfoSize
+    AppendUint32(0, &event);
+    AppendUint32(kEventNoAction, &event);
+    event.append(SHA1_DIGEST_SIZE, 0);
+    AppendUint32(spec_id.size(), &event);
+    event.append(spec_id);
+  }
+  AppendUint32(pcr_index, &event);
+  AppendUint32(event_type, &event);
+  AppendUint32(digests.count, &event);
+  for (uint32_t i = 0; i < digests.count; ++i) {
+    const TPMT_HA& digest = digests.digests[i];
+    uint16_t digest_size = GetDigestSize(digest.hash_alg);
+    if (digest_size == 0) {
+      LOG(ERROR) << __func__ << ": Unsupported digest algorithm "
+                 << digest.hash_alg;
+      return false;
+    }
+    AppendUint16(digest.hash_alg, &event);
+    event.append(reinterpret_cast<const char*>(&digest.digest), digest_size);
+  }
+  AppendUint32(event_data.size(), &event);
+  event.append(event_data);
+  if (!Write(event)) {
+    return false;
+  }
+  if (algorithms_.empty()) {
+    for (uint32_t i = 0; i < digests.count; ++i) {
+      algorithms_.push_back(digests.digests[i].hash_alg);
+    }
+  }
+  ++unsynced_events_;
+  if (sync_interval_ > 0 && unsynced_events_ >= sync_interval_) {
+    return Sync();
+  }
+  return true;
+}
+
+bool TpmEventLog::Sync() {
+  if (!fd_.is_valid()) {
+    return false;
+  }
+  if (HANDLE_EINTR(fdatasync(fd_.get())) < 0) {
+    PLOG(ERROR) << __func__ << ": Failed to sync event log";
+    return false;
+  }
+  unsynced_events_ = 0;
+  return true;
+}
+
+bool TpmEventLog::ReadHeader() {
+  std::string header;
+  if (!ReadAt(fd_.get(), 0, kEventHeaderSize, &header)) {
+    return false;
+  }
+  size_t offset = 0;
+  uint32_t pcr_index = 0;
+  uint32_t event_type = 0;
+  uint32_t event_size = 0;
+  ReadUint32(header, &offset, &pcr_index);
+  ReadUint32(header, &offset, &event_type);
+  offset += SHA1_DIGEST_SIZE;
+  ReadUint32(header, &offset, &event_size);
+  if (event_type != kEventNoAction || event_size < sizeof(kSpecIdSignature) ||
+      event_size > kMaxSpecIdSize) {
+    return false;
+  }
+  std::string spec_id;
+  if (!ReadAt(fd_.get(), kEventHeaderSize, event_size, &spec_id) ||
+      spec_id.compare(0, sizeof(kSpecIdSignature), kSpecIdSignature,
+                      sizeof(kSpecIdSignature)) != 0) {
+    return false;
+  }
+  // Skip platformClass, the version, errata and uintnSize.
+  offset = sizeof(kSpecIdSignature) + 4 + 4;
+  uint32_t count = 0;
+  if (!ReadUint32(spec_id, &offset, &count) || count == 0 ||
+      count > HASH_COUNT) {
+    return false;
+  }
+  std::vector<TPMI_ALG_HASH> algorithms;
+  for (uint32_t i = 0; i < count; ++i) {
+    uint16_t hash_alg = 0;
+    uint16_t digest_size = 0;
+    if (!ReadUint16(spec_id, &offset, &hash_alg) ||
+        !ReadUint16(spec_id, &offset, &digest_size) ||
+        GetDigestSize(hash_alg) == 0 ||
+        GetDigestSize(hash_alg) != digest_size) {
+      return false;
+    }
+    algorithms.push_back(hash_alg);
+  }
+  algorithms_.swap(algorithms);
+  return true;
+}
+
+bool TpmEventLog::Write(const std::string& data) {
+  ssize_t written = HANDLE_EINTR(write(fd_.get(), data.data(), data.size()));
+  if (written != static_cast<ssize_t>(data.size())) {
+    PLOG(ERROR) << __func__ << ": Failed to write event log";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace trunks
@@ -0,0 +1,92 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef TRUNKS_TPM_EVENT_LOG_H_
+#define TRUNKS_TPM_EVENT_LOG_H_
+
+#include <string>
+#include <vector>
+
+#include <base/files/file_path.h>
+#include <base/files/scoped_file.h>
+#include <base/macros.h>
+
+#include "trunks/tpm_generated.h"
+#include "trunks/trunks_export.h"
+
+namespace trunks {
+
+// TpmEventLog appends measurements to an event log in the crypto-agile format
+// of the TCG PC Client Platform Firmware Profile, so that standard tools can
+// replay the log against the PCR banks. A new log starts with the Spec ID
+// event, which lists the digest algorithms of the first event appended; every
+// event must then carry a digest for exactly those algorithms, so callers pass
+// one for each allocated PCR bank. An existing log is only appended to if its
+// Spec ID event can be read. The file is synced every |sync_interval| events
+// and when the log is closed. This class is not thread-safe.
+//
+// Example Usage:
+//
+// TpmEventLog event_log;
+// event_log.Open(base::FilePath("/run/measurements.log"), 64);
+// utility->ExtendPCRs(events, nullptr, &event_log);
+class TRUNKS_EXPORT TpmEventLog {
+ public:
+  TpmEventLog();
+  // Syncs any events not yet synced.
+  ~TpmEventLog();
+
+  // Opens the log at |path| for appending, creating it if it does not exist.
+  // A |sync_interval| of zero syncs only on Sync() and when the log is closed.
+  // Returns false if the log cannot be opened or an existing log does not
+  // start with a valid Spec ID event.
+  bool Open(const base::FilePath& path, size_t sync_interval);
+
+  // Returns true if |digests| covers exactly the algorithms of the log's Spec
+  // ID event, or if the log has no events yet.
+  bool MatchesAlgorithms(const TPML_DIGEST_VALUES& digests) const;
+
+  // Appends a TCG_PCR_EVENT2 recording that |digests| of |event_data| were
+  // extended into |pcr_index|. Fails if MatchesAlgorithms(|digests|) does not
+  // hold. Returns true on success.
+  bool AppendEvent(uint32_t pcr_index,
+                   uint32_t event_type,
+                   const TPML_DIGEST_VALUES& digests,
+                   const std::string& event_data);
+
+  // Flushes appended events to storage. Returns true on success.
+  bool Sync();
+
+ private:
+  // Reads the digest algorithms from the Spec ID event at the start of the log
+  // into |algorithms_|. Returns true on success.
+  bool ReadHeader();
+
+  // Writes |data| at the end of the log. Returns true on success.
+  bool Write(const std::string& data);
+
+  base::ScopedFD fd_;
+  // The algorithms listed in the Spec ID event. Empty if the log has none yet.
+  std::vector<TPMI_ALG_HASH> algorithms_;
+  size_t sync_interval_ = 0;
+  size_t unsynced_events_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(TpmEventLog);
+};
+
+}  // namespace trunks
+
+#endif  // TRUNKS_TPM_EVENT_LOG_H_
@@ -0,0 +1,145 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/tpm_event_log.h"
+
+#include <string.h>
+
+#include <string>
+
+#include <base/files/file_util.h>
+#include <base/files/scoped_temp_dir.h>
+#include <base/strings/string_number_conversions.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+// The Spec ID event for a log with only SHA-256 digests.
+const char kSpecIdEventHex[] =
+    "00000000"                                  // pcrIndex
+    "03000000"                                  // eventType=EV_NO_ACTION
+    "0000000000000000000000000000000000000000"  // digest
+    "21000000"                                  // eventSize
+    "53706563204944204576656E74303300"          // signature
+    "00000000"                                  // platformClass
+    "00020002"                                  // version, errata, uintnSize
+    "01000000"                                  // numberOfAlgorithms
+    "0B002000"                                  // TPM_ALG_SHA256, 32 bytes
+    "00";                                       // vendorInfoSize
+
+// An EV_IPL event of "abc" in PCR 3.
+const char kEventHex[] =
+    "03000000"  // pcrIndex
+    "0D000000"  // eventType
+    "01000000"  // digest count
+    "0B00"      // TPM_ALG_SHA256
+    "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA"
+    "03000000"  // eventSize
+    "616263";
+
+}  // namespace
+
+namespace trunks {
+
+class TpmEventLogTest : public testing::Test {
+ public:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    log_path_ = temp_dir_.path().Append("event_log");
+    memset(&digests_, 0, sizeof(digests_));
+    digests_.count = 1;
+    digests_.digests[0].hash_alg = TPM_ALG_SHA256;
+    memset(digests_.digests[0].digest.sha256, 0xAA, SHA256_DIGEST_SIZE);
+  }
+
+ protected:
+  std::string ReadLogHex() {
+    std::string log;
+    EXPECT_TRUE(base::ReadFileToString(log_path_, &log));
+    return base::HexEncode(log.data(), log.size());
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath log_path_;
+  TPML_DIGEST_VALUES digests_;
+};
+
+TEST_F(TpmEventLogTest, AppendEvent) {
+  TpmEventLog event_log;
+  ASSERT_TRUE(event_log.Open(log_path_, 1));
+  EXPECT_TRUE(event_log.AppendEvent(3, 0xD, digests_, "abc"));
+  EXPECT_EQ(std::string(kSpecIdEventHex) + kEventHex, ReadLogHex());
+}
+
+TEST_F(TpmEventLogTest, ReopenAppends) {
+  {
+    TpmEventLog event_log;
+    ASSERT_TRUE(event_log.Open(log_path_, 0));
+    EXPECT_TRUE(event_log.AppendEvent(3, 0xD, digests_, "abc"));
+  }
+  TpmEventLog event_log;
+  ASSERT_TRUE(event_log.Open(log_path_, 0));
+  EXPECT_TRUE(event_log.AppendEvent(3, 0xD, digests_, "abc"));
+  EXPECT_TRUE(event_log.Sync());
+  EXPECT_EQ(std::string(kSpecIdEventHex) + kEventHex + kEventHex,
+            ReadLogHex());
+}
+
+TEST_F(TpmEventLogTest, UnsupportedDigest) {
+  TpmEventLog event_log;
+  ASSERT_TRUE(event_log.Open(log_path_, 0));
+  digests_.digests[0].hash_alg = TPM_ALG_SM3_256;
+  EXPECT_FALSE(event_log.AppendEvent(3, 0xD, digests_, "abc"));
+}
+
+TEST_F(TpmEventLogTest, ReopenWithDifferentAlgorithms) {
+  {
+    TpmEventLog event_log;
+    ASSERT_TRUE(event_log.Open(log_path_, 0));
+    EXPECT_TRUE(event_log.AppendEvent(3, 0xD, digests_, "abc"));
+  }
+  TpmEventLog event_log;
+  ASSERT_TRUE(event_log.Open(log_path_, 0));
+  TPML_DIGEST_VALUES digests = digests_;
+  digests.count = 2;
+  digests.digests[1].hash_alg = TPM_ALG_SHA1;
+  EXPECT_FALSE(event_log.MatchesAlgorithms(digests));
+  EXPECT_FALSE(event_log.AppendEvent(3, 0xD, digests, "abc"));
+  digests.digests[0].hash_alg = TPM_ALG_SHA1;
+  digests.count = 1;
+  EXPECT_FALSE(event_log.AppendEvent(3, 0xD, digests, "abc"));
+  EXPECT_TRUE(event_log.MatchesAlgorithms(digests_));
+  EXPECT_TRUE(event_log.Sync());
+  EXPECT_EQ(std::string(kSpecIdEventHex) + kEventHex, ReadLogHex());
+}
+
+TEST_F(TpmEventLogTest, InvalidHeader) {
+  ASSERT_EQ(3, base::WriteFile(log_path_, "abc", 3));
+  TpmEventLog event_log;
+  EXPECT_FALSE(event_log.Open(log_path_, 0));
+  EXPECT_FALSE(event_log.AppendEvent(3, 0xD, digests_, "abc"));
+  std::string log;
+  EXPECT_TRUE(base::ReadFileToString(log_path_, &log));
+  EXPECT_EQ("abc", log);
+}
+
+TEST_F(TpmEventLogTest, NotOpen) {
+  TpmEventLog event_log;
+  EXPECT_FALSE(event_log.AppendEvent(3, 0xD, digests_, "abc"));
+  EXPECT_FALSE(event_log.Sync());
+}
+
+}  // namespace trunks
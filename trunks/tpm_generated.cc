@@ -18,6 +18,7 @@
 
 #include "trunks/tpm_generated.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -26,7 +27,6 @@
 #include <base/logging.h>
 #include <base/macros.h>
 #include <base/stl_util.h>
-#include <base/strings/string_number_conversions.h>
 #include <base/sys_byteorder.h>
 #include <crypto/secure_hash.h>
 
@@ -34,458 +34,313 @@
 #include "trunks/command_transceiver.h"
 #include "trunks/error_codes.h"
 
+// The marshaling functions run for every field of every command, so their
+// per-function traces are compiled in only when TRUNKS_MARSHALING_VLOG is
+// defined. Use SetTpmTraceHook() to trace whole commands.
+#if defined(TRUNKS_MARSHALING_VLOG)
+#define MARSHALING_VLOG(verbose_level) VLOG(verbose_level)
+#else
+#define MARSHALING_VLOG(verbose_level) EAT_STREAM_PARAMETERS
+#endif
+
 namespace trunks {
 
+namespace {
+
+// Indexed by |command_code - TPM_CC_FIRST|. Entries for unassigned command
+// codes are zero.
+constexpr TpmCommandInfo kCommandInfo[] = {
+    {TPM_CC_NV_UndefineSpaceSpecial, 2, 0, false, false, false, 0x01,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_EvictControl, 2, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_HierarchyControl, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_NV_UndefineSpace, 2, 0, false, false, false, 0x02,
+     TpmCommandLatency::kMedium},
+    {},
+    {TPM_CC_ChangeEPS, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kLong},
+    {TPM_CC_ChangePPS, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kLong},
+    {TPM_CC_Clear, 1, 0, false, false, false, 0x00, TpmCommandLatency::kLong},
+    {TPM_CC_ClearControl, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_ClockSet, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_HierarchyChangeAuth, 1, 0, true, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_NV_DefineSpace, 1, 0, true, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_PCR_Allocate, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_PCR_SetAuthPolicy, 2, 0, true, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_PP_Commands, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_SetPrimaryPolicy, 1, 0, true, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_FieldUpgradeStart, 2, 0, true, false, false, 0x00,
+     TpmCommandLatency::kLong},
+    {TPM_CC_ClockRateAdjust, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_CreatePrimary, 1, 1, true, true, false, 0x00,
+     TpmCommandLatency::kLong},
+    {TPM_CC_NV_GlobalWriteLock, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_GetCommandAuditDigest, 2, 0, true, true, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_NV_Increment, 2, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_NV_SetBits, 2, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_NV_Extend, 2, 0, true, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_NV_Write, 2, 0, true, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_NV_WriteLock, 2, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_DictionaryAttackLockReset, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_DictionaryAttackParameters, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_NV_ChangeAuth, 1, 0, true, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_PCR_Event, 1, 0, true, false, false, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_PCR_Reset, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_SequenceComplete, 1, 0, true, true, false, 0x01,
+     TpmCommandLatency::kShort},
+    {TPM_CC_SetAlgorithmSet, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_SetCommandCodeAuditStatus, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_FieldUpgradeData, 0, 0, true, false, false, 0x00,
+     TpmCommandLatency::kLong},
+    {TPM_CC_IncrementalSelfTest, 0, 0, false, false, false, 0x00,
+     TpmCommandLatency::kLong},
+    {TPM_CC_SelfTest, 0, 0, false, false, false, 0x00,
+     TpmCommandLatency::kLong},
+    {TPM_CC_Startup, 0, 0, false, false, false, 0x00, TpmCommandLatency::kLong},
+    {TPM_CC_Shutdown, 0, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_StirRandom, 0, 0, true, false, false, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_ActivateCredential, 2, 0, true, true, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_Certify, 2, 0, true, true, true, 0x00, TpmCommandLatency::kMedium},
+    {TPM_CC_PolicyNV, 3, 0, true, false, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_CertifyCreation, 2, 0, true, true, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_Duplicate, 2, 0, true, true, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_GetTime, 2, 0, true, true, true, 0x00, TpmCommandLatency::kMedium},
+    {TPM_CC_GetSessionAuditDigest, 3, 0, true, true, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_NV_Read, 2, 0, false, true, true, 0x00, TpmCommandLatency::kShort},
+    {TPM_CC_NV_ReadLock, 2, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_ObjectChangeAuth, 2, 0, true, true, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_PolicySecret, 2, 0, true, true, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_Rewrap, 2, 0, true, true, true, 0x00, TpmCommandLatency::kMedium},
+    {TPM_CC_Create, 1, 0, true, true, true, 0x00, TpmCommandLatency::kLong},
+    {TPM_CC_ECDH_ZGen, 1, 0, true, true, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_HMAC, 1, 0, true, true, true, 0x00, TpmCommandLatency::kShort},
+    {TPM_CC_Import, 1, 0, true, true, true, 0x00, TpmCommandLatency::kMedium},
+    {TPM_CC_Load, 1, 1, true, true, false, 0x00, TpmCommandLatency::kMedium},
+    {TPM_CC_Quote, 1, 0, true, true, true, 0x00, TpmCommandLatency::kMedium},
+    {TPM_CC_RSA_Decrypt, 1, 0, true, true, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {},
+    {TPM_CC_HMAC_Start, 1, 1, true, false, false, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_SequenceUpdate, 1, 0, true, false, false, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_Sign, 1, 0, true, false, true, 0x00, TpmCommandLatency::kMedium},
+    {TPM_CC_Unseal, 1, 0, false, true, true, 0x00, TpmCommandLatency::kShort},
+    {},
+    {TPM_CC_PolicySigned, 2, 0, true, true, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_ContextLoad, 0, 1, false, false, false, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_ContextSave, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_ECDH_KeyGen, 1, 0, false, true, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_EncryptDecrypt, 1, 0, false, true, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_FlushContext, 0, 0, false, false, false, 0x00,
+     TpmCommandLatency::kShort},
+    {},
+    {TPM_CC_LoadExternal, 0, 1, true, true, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_MakeCredential, 1, 0, true, true, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_NV_ReadPublic, 1, 0, false, true, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_PolicyAuthorize, 1, 0, true, false, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_PolicyAuthValue, 1, 0, false, false, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_PolicyCommandCode, 1, 0, false, false, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_PolicyCounterTimer, 1, 0, true, false, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_PolicyCpHash, 1, 0, true, false, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_PolicyLocality, 1, 0, false, false, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_PolicyNameHash, 1, 0, true, false, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_PolicyOR, 1, 0, false, false, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_PolicyTicket, 1, 0, true, false, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_ReadPublic, 1, 0, false, true, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_RSA_Encrypt, 1, 0, true, true, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {},
+    {TPM_CC_StartAuthSession, 2, 1, true, true, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_VerifySignature, 1, 0, true, false, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_ECC_Parameters, 0, 0, false, false, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_FirmwareRead, 0, 0, false, true, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_GetCapability, 0, 0, false, false, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_GetRandom, 0, 0, false, true, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_GetTestResult, 0, 0, false, true, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_Hash, 0, 0, true, true, true, 0x00, TpmCommandLatency::kShort},
+    {TPM_CC_PCR_Read, 0, 0, false, false, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_PolicyPCR, 1, 0, true, false, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_PolicyRestart, 1, 0, false, false, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_ReadClock, 0, 0, false, false, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_PCR_Extend, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_PCR_SetAuthValue, 1, 0, true, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_NV_Certify, 3, 0, true, true, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_EventSequenceComplete, 2, 0, true, false, false, 0x02,
+     TpmCommandLatency::kShort},
+    {TPM_CC_HashSequenceStart, 0, 1, true, false, false, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_PolicyPhysicalPresence, 1, 0, false, false, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_PolicyDuplicationSelect, 1, 0, true, false, true, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_PolicyGetDigest, 1, 0, false, true, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_TestParms, 0, 0, false, false, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_Commit, 1, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_PolicyPassword, 1, 0, false, false, true, 0x00,
+     TpmCommandLatency::kShort},
+    {TPM_CC_ZGen_2Phase, 1, 0, true, true, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_EC_Ephemeral, 0, 0, false, false, false, 0x00,
+     TpmCommandLatency::kMedium},
+    {TPM_CC_PolicyNvWritten, 1, 0, false, false, true, 0x00,
+     TpmCommandLatency::kMedium},
+};
+static_assert(arraysize(kCommandInfo) == TPM_CC_LAST - TPM_CC_FIRST + 1,
+              "kCommandInfo must cover every command code.");
+
+}  // namespace
+
+const TpmCommandInfo* GetCommandInfo(TPM_CC command_code) {
+  if (command_code < TPM_CC_FIRST || command_code > TPM_CC_LAST) {
+    return nullptr;
+  }
+  const TpmCommandInfo* info = &kCommandInfo[command_code - TPM_CC_FIRST];
+  if (info->code != command_code) {
+    return nullptr;
+  }
+  return info;
+}
+
 size_t GetNumberOfRequestHandles(TPM_CC command_code) {
-  switch (command_code) {
-    case TPM_CC_Startup:
-      return 0;
-    case TPM_CC_Shutdown:
-      return 0;
-    case TPM_CC_SelfTest:
-      return 0;
-    case TPM_CC_IncrementalSelfTest:
-      return 0;
-    case TPM_CC_GetTestResult:
-      return 0;
-    case TPM_CC_StartAuthSession:
-      return 2;
-    case TPM_CC_PolicyRestart:
-      return 1;
-    case TPM_CC_Create:
-      return 1;
-    case TPM_CC_Load:
-      return 1;
-    case TPM_CC_LoadExternal:
-      return 0;
-    case TPM_CC_ReadPublic:
-      return 1;
-    case TPM_CC_ActivateCredential:
-      return 2;
-    case TPM_CC_MakeCredential:
-      return 1;
-    case TPM_CC_Unseal:
-      return 1;
-    case TPM_CC_ObjectChangeAuth:
-      return 2;
-    case TPM_CC_Duplicate:
-      return 2;
-    case TPM_CC_Rewrap:
-      return 2;
-    case TPM_CC_Import:
-      return 1;
-    case TPM_CC_RSA_Encrypt:
-      return 1;
-    case TPM_CC_RSA_Decrypt:
-      return 1;
-    case TPM_CC_ECDH_KeyGen:
-      return 1;
-    case TPM_CC_ECDH_ZGen:
-      return 1;
-    case TPM_CC_ECC_Parameters:
-      return 0;
-    case TPM_CC_ZGen_2Phase:
-      return 1;
-    case TPM_CC_EncryptDecrypt:
-      return 1;
-    case TPM_CC_Hash:
-      return 0;
-    case TPM_CC_HMAC:
-      return 1;
-    case TPM_CC_GetRandom:
-      return 0;
-    case TPM_CC_StirRandom:
-      return 0;
-    case TPM_CC_HMAC_Start:
-      return 1;
-    case TPM_CC_HashSequenceStart:
-      return 0;
-    case TPM_CC_SequenceUpdate:
-      return 1;
-    case TPM_CC_SequenceComplete:
-      return 1;
-    case TPM_CC_EventSequenceComplete:
-      return 2;
-    case TPM_CC_Certify:
-      return 2;
-    case TPM_CC_CertifyCreation:
-      return 2;
-    case TPM_CC_Quote:
-      return 1;
-    case TPM_CC_GetSessionAuditDigest:
-      return 3;
-    case TPM_CC_GetCommandAuditDigest:
-      return 2;
-    case TPM_CC_GetTime:
-      return 2;
-    case TPM_CC_Commit:
-      return 1;
-    case TPM_CC_EC_Ephemeral:
-      return 0;
-    case TPM_CC_VerifySignature:
-      return 1;
-    case TPM_CC_Sign:
-      return 1;
-    case TPM_CC_SetCommandCodeAuditStatus:
-      return 1;
-    case TPM_CC_PCR_Extend:
-      return 1;
-    case TPM_CC_PCR_Event:
-      return 1;
-    case TPM_CC_PCR_Read:
-      return 0;
-    case TPM_CC_PCR_Allocate:
-      return 1;
-    case TPM_CC_PCR_SetAuthPolicy:
-      return 2;
-    case TPM_CC_PCR_SetAuthValue:
-      return 1;
-    case TPM_CC_PCR_Reset:
-      return 1;
-    case TPM_CC_PolicySigned:
-      return 2;
-    case TPM_CC_PolicySecret:
-      return 2;
-    case TPM_CC_PolicyTicket:
-      return 1;
-    case TPM_CC_PolicyOR:
-      return 1;
-    case TPM_CC_PolicyPCR:
-      return 1;
-    case TPM_CC_PolicyLocality:
-      return 1;
-    case TPM_CC_PolicyNV:
-      return 3;
-    case TPM_CC_PolicyCounterTimer:
-      return 1;
-    case TPM_CC_PolicyCommandCode:
-      return 1;
-    case TPM_CC_PolicyPhysicalPresence:
-      return 1;
-    case TPM_CC_PolicyCpHash:
-      return 1;
-    case TPM_CC_PolicyNameHash:
-      return 1;
-    case TPM_CC_PolicyDuplicationSelect:
-      return 1;
-    case TPM_CC_PolicyAuthorize:
-      return 1;
-    case TPM_CC_PolicyAuthValue:
-      return 1;
-    case TPM_CC_PolicyPassword:
-      return 1;
-    case TPM_CC_PolicyGetDigest:
-      return 1;
-    case TPM_CC_PolicyNvWritten:
-      return 1;
-    case TPM_CC_CreatePrimary:
-      return 1;
-    case TPM_CC_HierarchyControl:
-      return 1;
-    case TPM_CC_SetPrimaryPolicy:
-      return 1;
-    case TPM_CC_ChangePPS:
-      return 1;
-    case TPM_CC_ChangeEPS:
-      return 1;
-    case TPM_CC_Clear:
-      return 1;
-    case TPM_CC_ClearControl:
-      return 1;
-    case TPM_CC_HierarchyChangeAuth:
-      return 1;
-    case TPM_CC_DictionaryAttackLockReset:
-      return 1;
-    case TPM_CC_DictionaryAttackParameters:
-      return 1;
-    case TPM_CC_PP_Commands:
-      return 1;
-    case TPM_CC_SetAlgorithmSet:
-      return 1;
-    case TPM_CC_FieldUpgradeStart:
-      return 2;
-    case TPM_CC_FieldUpgradeData:
-      return 0;
-    case TPM_CC_FirmwareRead:
-      return 0;
-    case TPM_CC_ContextSave:
-      return 1;
-    case TPM_CC_ContextLoad:
-      return 0;
-    case TPM_CC_FlushContext:
-      return 0;
-    case TPM_CC_EvictControl:
-      return 2;
-    case TPM_CC_ReadClock:
-      return 0;
-    case TPM_CC_ClockSet:
-      return 1;
-    case TPM_CC_ClockRateAdjust:
-      return 1;
-    case TPM_CC_GetCapability:
-      return 0;
-    case TPM_CC_TestParms:
-      return 0;
-    case TPM_CC_NV_DefineSpace:
-      return 1;
-    case TPM_CC_NV_UndefineSpace:
-      return 2;
-    case TPM_CC_NV_UndefineSpaceSpecial:
-      return 2;
-    case TPM_CC_NV_ReadPublic:
-      return 1;
-    case TPM_CC_NV_Write:
-      return 2;
-    case TPM_CC_NV_Increment:
-      return 2;
-    case TPM_CC_NV_Extend:
-      return 2;
-    case TPM_CC_NV_SetBits:
-      return 2;
-    case TPM_CC_NV_WriteLock:
-      return 2;
-    case TPM_CC_NV_GlobalWriteLock:
-      return 1;
-    case TPM_CC_NV_Read:
-      return 2;
-    case TPM_CC_NV_ReadLock:
-      return 2;
-    case TPM_CC_NV_ChangeAuth:
-      return 1;
-    case TPM_CC_NV_Certify:
-      return 3;
-    default:
-      LOG(WARNING) << "Unknown command code: " << command_code;
+  const TpmCommandInfo* info = GetCommandInfo(command_code);
+  if (!info) {
+    LOG(WARNING) << "Unknown command code: " << command_code;
+    return 0;
   }
-  return 0;
+  return info->request_handles;
 }
 
 size_t GetNumberOfResponseHandles(TPM_CC command_code) {
-  switch (command_code) {
-    case TPM_CC_Startup:
-      return 0;
-    case TPM_CC_Shutdown:
-      return 0;
-    case TPM_CC_SelfTest:
-      return 0;
-    case TPM_CC_IncrementalSelfTest:
-      return 0;
-    case TPM_CC_GetTestResult:
-      return 0;
-    case TPM_CC_StartAuthSession:
-      return 1;
-    case TPM_CC_PolicyRestart:
-      return 0;
-    case TPM_CC_Create:
-      return 0;
-    case TPM_CC_Load:
-      return 1;
-    case TPM_CC_LoadExternal:
-      return 1;
-    case TPM_CC_ReadPublic:
-      return 0;
-    case TPM_CC_ActivateCredential:
-      return 0;
-    case TPM_CC_MakeCredential:
-      return 0;
-    case TPM_CC_Unseal:
-      return 0;
-    case TPM_CC_ObjectChangeAuth:
-      return 0;
-    case TPM_CC_Duplicate:
-      return 0;
-    case TPM_CC_Rewrap:
-      return 0;
-    case TPM_CC_Import:
-      return 0;
-    case TPM_CC_RSA_Encrypt:
-      return 0;
-    case TPM_CC_RSA_Decrypt:
-      return 0;
-    case TPM_CC_ECDH_KeyGen:
-      return 0;
-    case TPM_CC_ECDH_ZGen:
-      return 0;
-    case TPM_CC_ECC_Parameters:
-      return 0;
-    case TPM_CC_ZGen_2Phase:
-      return 0;
-    case TPM_CC_EncryptDecrypt:
-      return 0;
-    case TPM_CC_Hash:
-      return 0;
-    case TPM_CC_HMAC:
-      return 0;
-    case TPM_CC_GetRandom:
-      return 0;
-    case TPM_CC_StirRandom:
-      return 0;
-    case TPM_CC_HMAC_Start:
-      return 1;
-    case TPM_CC_HashSequenceStart:
-      return 1;
-    case TPM_CC_SequenceUpdate:
-      return 0;
-    case TPM_CC_SequenceComplete:
-      return 0;
-    case TPM_CC_EventSequenceComplete:
-      return 0;
-    case TPM_CC_Certify:
-      return 0;
-    case TPM_CC_CertifyCreation:
-      return 0;
-    case TPM_CC_Quote:
-      return 0;
-    case TPM_CC_GetSessionAuditDigest:
-      return 0;
-    case TPM_CC_GetCommandAuditDigest:
-      return 0;
-    case TPM_CC_GetTime:
-      return 0;
-    case TPM_CC_Commit:
-      return 0;
-    case TPM_CC_EC_Ephemeral:
-      return 0;
-    case TPM_CC_VerifySignature:
-      return 0;
-    case TPM_CC_Sign:
-      return 0;
-    case TPM_CC_SetCommandCodeAuditStatus:
-      return 0;
-    case TPM_CC_PCR_Extend:
-      return 0;
-    case TPM_CC_PCR_Event:
-      return 0;
-    case TPM_CC_PCR_Read:
-      return 0;
-    case TPM_CC_PCR_Allocate:
-      return 0;
-    case TPM_CC_PCR_SetAuthPolicy:
-      return 0;
-    case TPM_CC_PCR_SetAuthValue:
-      return 0;
-    case TPM_CC_PCR_Reset:
-      return 0;
-    case TPM_CC_PolicySigned:
-      return 0;
-    case TPM_CC_PolicySecret:
-      return 0;
-    case TPM_CC_PolicyTicket:
-      return 0;
-    case TPM_CC_PolicyOR:
-      return 0;
-    case TPM_CC_PolicyPCR:
-      return 0;
-    case TPM_CC_PolicyLocality:
-      return 0;
-    case TPM_CC_PolicyNV:
-      return 0;
-    case TPM_CC_PolicyCounterTimer:
-      return 0;
-    case TPM_CC_PolicyCommandCode:
-      return 0;
-    case TPM_CC_PolicyPhysicalPresence:
-      return 0;
-    case TPM_CC_PolicyCpHash:
-      return 0;
-    case TPM_CC_PolicyNameHash:
-      return 0;
-    case TPM_CC_PolicyDuplicationSelect:
-      return 0;
-    case TPM_CC_PolicyAuthorize:
-      return 0;
-    case TPM_CC_PolicyAuthValue:
-      return 0;
-    case TPM_CC_PolicyPassword:
-      return 0;
-    case TPM_CC_PolicyGetDigest:
-      return 0;
-    case TPM_CC_PolicyNvWritten:
-      return 0;
-    case TPM_CC_CreatePrimary:
-      return 1;
-    case TPM_CC_HierarchyControl:
-      return 0;
-    case TPM_CC_SetPrimaryPolicy:
-      return 0;
-    case TPM_CC_ChangePPS:
-      return 0;
-    case TPM_CC_ChangeEPS:
-      return 0;
-    case TPM_CC_Clear:
-      return 0;
-    case TPM_CC_ClearControl:
-      return 0;
-    case TPM_CC_HierarchyChangeAuth:
-      return 0;
-    case TPM_CC_DictionaryAttackLockReset:
-      return 0;
-    case TPM_CC_DictionaryAttackParameters:
-      return 0;
-    case TPM_CC_PP_Commands:
-      return 0;
-    case TPM_CC_SetAlgorithmSet:
-      return 0;
-    case TPM_CC_FieldUpgradeStart:
-      return 0;
-    case TPM_CC_FieldUpgradeData:
-      return 0;
-    case TPM_CC_FirmwareRead:
-      return 0;
-    case TPM_CC_ContextSave:
-      return 0;
-    case TPM_CC_ContextLoad:
-      return 1;
-    case TPM_CC_FlushContext:
-      return 0;
-    case TPM_CC_EvictControl:
-      return 0;
-    case TPM_CC_ReadClock:
-      return 0;
-    case TPM_CC_ClockSet:
-      return 0;
-    case TPM_CC_ClockRateAdjust:
-      return 0;
-    case TPM_CC_GetCapability:
-      return 0;
-    case TPM_CC_TestParms:
-      return 0;
-    case TPM_CC_NV_DefineSpace:
-      return 0;
-    case TPM_CC_NV_UndefineSpace:
-      return 0;
-    case TPM_CC_NV_UndefineSpaceSpecial:
-      return 0;
-    case TPM_CC_NV_ReadPublic:
-      return 0;
-    case TPM_CC_NV_Write:
-      return 0;
-    case TPM_CC_NV_Increment:
-      return 0;
-    case TPM_CC_NV_Extend:
-      return 0;
-    case TPM_CC_NV_SetBits:
-      return 0;
-    case TPM_CC_NV_WriteLock:
-      return 0;
-    case TPM_CC_NV_GlobalWriteLock:
-      return 0;
-    case TPM_CC_NV_Read:
-      return 0;
-    case TPM_CC_NV_ReadLock:
-      return 0;
-    case TPM_CC_NV_ChangeAuth:
-      return 0;
-    case TPM_CC_NV_Certify:
-      return 0;
-    default:
-      LOG(WARNING) << "Unknown command code: " << command_code;
+  const TpmCommandInfo* info = GetCommandInfo(command_code);
+  if (!info) {
+    LOG(WARNING) << "Unknown command code: " << command_code;
+    return 0;
+  }
+  return info->response_handles;
+}
+
+namespace {
+
+std::atomic<TpmTraceHook> g_trace_hook(nullptr);
+
+// Reports a TpmTraceEvent when it goes out of scope if a trace hook was
+// installed when it was constructed.
+class ScopedTpmTrace {
+ public:
+  ScopedTpmTrace(TpmTraceEvent::Stage stage, TPM_CC command_code)
+      : hook_(g_trace_hook.load(std::memory_order_relaxed)) {
+    if (hook_) {
+      event_.stage = stage;
+      event_.command_code = command_code;
+      start_time_ = base::TimeTicks::Now();
+    }
+  }
+
+  ~ScopedTpmTrace() {
+    if (hook_) {
+      event_.elapsed = base::TimeTicks::Now() - start_time_;
+      hook_(event_);
+    }
+  }
+
+  void set_data(const std::string* data) {
+    event_.data = data;
+    event_.size = data->size();
+  }
+
+  void set_response_code(TPM_RC response_code) {
+    event_.response_code = response_code;
   }
-  return 0;
+
+ private:
+  const TpmTraceHook hook_;
+  TpmTraceEvent event_ = {};
+  base::TimeTicks start_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedTpmTrace);
+};
+
+}  // namespace
+
+void SetTpmTraceHook(TpmTraceHook hook) {
+  g_trace_hook.store(hook, std::memory_order_relaxed);
 }
 
 TPM_RC Serialize_uint8_t(const uint8_t& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   uint8_t value_net = value;
   switch (sizeof(uint8_t)) {
     case 2:
@@ -508,7 +363,7 @@ TPM_RC Serialize_uint8_t(const uint8_t& value, std::string* buffer) {
 TPM_RC Parse_uint8_t(std::string* buffer,
                      uint8_t* value,
                      std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   if (buffer->size() < sizeof(uint8_t))
     return TPM_RC_INSUFFICIENT;
   uint8_t value_net = 0;
@@ -534,7 +389,7 @@ TPM_RC Parse_uint8_t(std::string* buffer,
 }
 
 TPM_RC Serialize_int8_t(const int8_t& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   int8_t value_net = value;
   switch (sizeof(int8_t)) {
     case 2:
@@ -557,7 +412,7 @@ TPM_RC Serialize_int8_t(const int8_t& value, std::string* buffer) {
 TPM_RC Parse_int8_t(std::string* buffer,
                     int8_t* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   if (buffer->size() < sizeof(int8_t))
     return TPM_RC_INSUFFICIENT;
   int8_t value_net = 0;
@@ -583,7 +438,7 @@ TPM_RC Parse_int8_t(std::string* buffer,
 }
 
 TPM_RC Serialize_int(const int& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   int value_net = value;
   switch (sizeof(int)) {
     case 2:
@@ -604,7 +459,7 @@ TPM_RC Serialize_int(const int& value, std::string* buffer) {
 }
 
 TPM_RC Parse_int(std::string* buffer, int* value, std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   if (buffer->size() < sizeof(int))
     return TPM_RC_INSUFFICIENT;
   int value_net = 0;
@@ -630,7 +485,7 @@ TPM_RC Parse_int(std::string* buffer, int* value, std::string* value_bytes) {
 }
 
 TPM_RC Serialize_uint16_t(const uint16_t& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   uint16_t value_net = value;
   switch (sizeof(uint16_t)) {
     case 2:
@@ -653,7 +508,7 @@ TPM_RC Serialize_uint16_t(const uint16_t& value, std::string* buffer) {
 TPM_RC Parse_uint16_t(std::string* buffer,
                       uint16_t* value,
                       std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   if (buffer->size() < sizeof(uint16_t))
     return TPM_RC_INSUFFICIENT;
   uint16_t value_net = 0;
@@ -679,7 +534,7 @@ TPM_RC Parse_uint16_t(std::string* buffer,
 }
 
 TPM_RC Serialize_int16_t(const int16_t& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   int16_t value_net = value;
   switch (sizeof(int16_t)) {
     case 2:
@@ -702,7 +557,7 @@ TPM_RC Serialize_int16_t(const int16_t& value, std::string* buffer) {
 TPM_RC Parse_int16_t(std::string* buffer,
                      int16_t* value,
                      std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   if (buffer->size() < sizeof(int16_t))
     return TPM_RC_INSUFFICIENT;
   int16_t value_net = 0;
@@ -728,7 +583,7 @@ TPM_RC Parse_int16_t(std::string* buffer,
 }
 
 TPM_RC Serialize_uint32_t(const uint32_t& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   uint32_t value_net = value;
   switch (sizeof(uint32_t)) {
     case 2:
@@ -751,7 +606,7 @@ TPM_RC Serialize_uint32_t(const uint32_t& value, std::string* buffer) {
 TPM_RC Parse_uint32_t(std::string* buffer,
                       uint32_t* value,
                       std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   if (buffer->size() < sizeof(uint32_t))
     return TPM_RC_INSUFFICIENT;
   uint32_t value_net = 0;
@@ -777,7 +632,7 @@ TPM_RC Parse_uint32_t(std::string* buffer,
 }
 
 TPM_RC Serialize_int32_t(const int32_t& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   int32_t value_net = value;
   switch (sizeof(int32_t)) {
     case 2:
@@ -800,7 +655,7 @@ TPM_RC Serialize_int32_t(const int32_t& value, std::string* buffer) {
 TPM_RC Parse_int32_t(std::string* buffer,
                      int32_t* value,
                      std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   if (buffer->size() < sizeof(int32_t))
     return TPM_RC_INSUFFICIENT;
   int32_t value_net = 0;
@@ -826,7 +681,7 @@ TPM_RC Parse_int32_t(std::string* buffer,
 }
 
 TPM_RC Serialize_uint64_t(const uint64_t& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   uint64_t value_net = value;
   switch (sizeof(uint64_t)) {
     case 2:
@@ -849,7 +704,7 @@ TPM_RC Serialize_uint64_t(const uint64_t& value, std::string* buffer) {
 TPM_RC Parse_uint64_t(std::string* buffer,
                       uint64_t* value,
                       std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   if (buffer->size() < sizeof(uint64_t))
     return TPM_RC_INSUFFICIENT;
   uint64_t value_net = 0;
@@ -875,7 +730,7 @@ TPM_RC Parse_uint64_t(std::string* buffer,
 }
 
 TPM_RC Serialize_int64_t(const int64_t& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   int64_t value_net = value;
   switch (sizeof(int64_t)) {
     case 2:
@@ -898,7 +753,7 @@ TPM_RC Serialize_int64_t(const int64_t& value, std::string* buffer) {
 TPM_RC Parse_int64_t(std::string* buffer,
                      int64_t* value,
                      std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   if (buffer->size() < sizeof(int64_t))
     return TPM_RC_INSUFFICIENT;
   int64_t value_net = 0;
@@ -924,210 +779,210 @@ TPM_RC Parse_int64_t(std::string* buffer,
 }
 
 TPM_RC Serialize_UINT8(const UINT8& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_uint8_t(value, buffer);
 }
 
 TPM_RC Parse_UINT8(std::string* buffer,
                    UINT8* value,
                    std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_uint8_t(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_BYTE(const BYTE& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_uint8_t(value, buffer);
 }
 
 TPM_RC Parse_BYTE(std::string* buffer, BYTE* value, std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_uint8_t(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_INT8(const INT8& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_int8_t(value, buffer);
 }
 
 TPM_RC Parse_INT8(std::string* buffer, INT8* value, std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_int8_t(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_BOOL(const BOOL& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_int(value, buffer);
 }
 
 TPM_RC Parse_BOOL(std::string* buffer, BOOL* value, std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_int(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_UINT16(const UINT16& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_uint16_t(value, buffer);
 }
 
 TPM_RC Parse_UINT16(std::string* buffer,
                     UINT16* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_uint16_t(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_INT16(const INT16& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_int16_t(value, buffer);
 }
 
 TPM_RC Parse_INT16(std::string* buffer,
                    INT16* value,
                    std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_int16_t(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_UINT32(const UINT32& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_uint32_t(value, buffer);
 }
 
 TPM_RC Parse_UINT32(std::string* buffer,
                     UINT32* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_uint32_t(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_INT32(const INT32& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_int32_t(value, buffer);
 }
 
 TPM_RC Parse_INT32(std::string* buffer,
                    INT32* value,
                    std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_int32_t(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_UINT64(const UINT64& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_uint64_t(value, buffer);
 }
 
 TPM_RC Parse_UINT64(std::string* buffer,
                     UINT64* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_uint64_t(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_INT64(const INT64& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_int64_t(value, buffer);
 }
 
 TPM_RC Parse_INT64(std::string* buffer,
                    INT64* value,
                    std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_int64_t(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_ALGORITHM_ID(const TPM_ALGORITHM_ID& value,
                                   std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_ALGORITHM_ID(std::string* buffer,
                               TPM_ALGORITHM_ID* value,
                               std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_MODIFIER_INDICATOR(const TPM_MODIFIER_INDICATOR& value,
                                         std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_MODIFIER_INDICATOR(std::string* buffer,
                                     TPM_MODIFIER_INDICATOR* value,
                                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_AUTHORIZATION_SIZE(const TPM_AUTHORIZATION_SIZE& value,
                                         std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_AUTHORIZATION_SIZE(std::string* buffer,
                                     TPM_AUTHORIZATION_SIZE* value,
                                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_PARAMETER_SIZE(const TPM_PARAMETER_SIZE& value,
                                     std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_PARAMETER_SIZE(std::string* buffer,
                                 TPM_PARAMETER_SIZE* value,
                                 std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_KEY_SIZE(const TPM_KEY_SIZE& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT16(value, buffer);
 }
 
 TPM_RC Parse_TPM_KEY_SIZE(std::string* buffer,
                           TPM_KEY_SIZE* value,
                           std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT16(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_KEY_BITS(const TPM_KEY_BITS& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT16(value, buffer);
 }
 
 TPM_RC Parse_TPM_KEY_BITS(std::string* buffer,
                           TPM_KEY_BITS* value,
                           std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT16(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_HANDLE(const TPM_HANDLE& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_HANDLE(std::string* buffer,
                         TPM_HANDLE* value,
                         std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM2B_DIGEST(const TPM2B_DIGEST& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -1150,7 +1005,7 @@ TPM_RC Parse_TPM2B_DIGEST(std::string* buffer,
                           TPM2B_DIGEST* value,
                           std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -1184,71 +1039,71 @@ std::string StringFrom_TPM2B_DIGEST(const TPM2B_DIGEST& tpm2b) {
 }
 
 TPM_RC Serialize_TPM2B_NONCE(const TPM2B_NONCE& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM2B_DIGEST(value, buffer);
 }
 
 TPM_RC Parse_TPM2B_NONCE(std::string* buffer,
                          TPM2B_NONCE* value,
                          std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM2B_DIGEST(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM2B_AUTH(const TPM2B_AUTH& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM2B_DIGEST(value, buffer);
 }
 
 TPM_RC Parse_TPM2B_AUTH(std::string* buffer,
                         TPM2B_AUTH* value,
                         std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM2B_DIGEST(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM2B_OPERAND(const TPM2B_OPERAND& value,
                                std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM2B_DIGEST(value, buffer);
 }
 
 TPM_RC Parse_TPM2B_OPERAND(std::string* buffer,
                            TPM2B_OPERAND* value,
                            std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM2B_DIGEST(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_ALG_ID(const TPM_ALG_ID& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT16(value, buffer);
 }
 
 TPM_RC Parse_TPM_ALG_ID(std::string* buffer,
                         TPM_ALG_ID* value,
                         std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT16(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ALG_HASH(const TPMI_ALG_HASH& value,
                                std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ALG_HASH(std::string* buffer,
                            TPMI_ALG_HASH* value,
                            std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMS_SCHEME_SIGHASH(const TPMS_SCHEME_SIGHASH& value,
                                      std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash_alg, buffer);
   if (result) {
@@ -1261,7 +1116,7 @@ TPM_RC Parse_TPMS_SCHEME_SIGHASH(std::string* buffer,
                                  TPMS_SCHEME_SIGHASH* value,
                                  std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash_alg, value_bytes);
   if (result) {
@@ -1272,913 +1127,913 @@ TPM_RC Parse_TPMS_SCHEME_SIGHASH(std::string* buffer,
 
 TPM_RC Serialize_TPMS_SCHEME_HMAC(const TPMS_SCHEME_HMAC& value,
                                   std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPMS_SCHEME_SIGHASH(value, buffer);
 }
 
 TPM_RC Parse_TPMS_SCHEME_HMAC(std::string* buffer,
                               TPMS_SCHEME_HMAC* value,
                               std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPMS_SCHEME_SIGHASH(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMS_SCHEME_RSASSA(const TPMS_SCHEME_RSASSA& value,
                                     std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPMS_SCHEME_SIGHASH(value, buffer);
 }
 
 TPM_RC Parse_TPMS_SCHEME_RSASSA(std::string* buffer,
                                 TPMS_SCHEME_RSASSA* value,
                                 std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPMS_SCHEME_SIGHASH(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMS_SCHEME_RSAPSS(const TPMS_SCHEME_RSAPSS& value,
                                     std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPMS_SCHEME_SIGHASH(value, buffer);
 }
 
 TPM_RC Parse_TPMS_SCHEME_RSAPSS(std::string* buffer,
                                 TPMS_SCHEME_RSAPSS* value,
                                 std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPMS_SCHEME_SIGHASH(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMS_SCHEME_ECDSA(const TPMS_SCHEME_ECDSA& value,
                                    std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPMS_SCHEME_SIGHASH(value, buffer);
 }
 
 TPM_RC Parse_TPMS_SCHEME_ECDSA(std::string* buffer,
                                TPMS_SCHEME_ECDSA* value,
                                std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPMS_SCHEME_SIGHASH(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMS_SCHEME_SM2(const TPMS_SCHEME_SM2& value,
                                  std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPMS_SCHEME_SIGHASH(value, buffer);
 }
 
 TPM_RC Parse_TPMS_SCHEME_SM2(std::string* buffer,
                              TPMS_SCHEME_SM2* value,
                              std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPMS_SCHEME_SIGHASH(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMS_SCHEME_ECSCHNORR(const TPMS_SCHEME_ECSCHNORR& value,
                                        std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPMS_SCHEME_SIGHASH(value, buffer);
 }
 
 TPM_RC Parse_TPMS_SCHEME_ECSCHNORR(std::string* buffer,
                                    TPMS_SCHEME_ECSCHNORR* value,
                                    std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPMS_SCHEME_SIGHASH(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_YES_NO(const TPMI_YES_NO& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_BYTE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_YES_NO(std::string* buffer,
                          TPMI_YES_NO* value,
                          std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_BYTE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_DH_OBJECT(const TPMI_DH_OBJECT& value,
                                 std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_DH_OBJECT(std::string* buffer,
                             TPMI_DH_OBJECT* value,
                             std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_DH_PERSISTENT(const TPMI_DH_PERSISTENT& value,
                                     std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_DH_PERSISTENT(std::string* buffer,
                                 TPMI_DH_PERSISTENT* value,
                                 std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_DH_ENTITY(const TPMI_DH_ENTITY& value,
                                 std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_DH_ENTITY(std::string* buffer,
                             TPMI_DH_ENTITY* value,
                             std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_DH_PCR(const TPMI_DH_PCR& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_DH_PCR(std::string* buffer,
                          TPMI_DH_PCR* value,
                          std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_SH_AUTH_SESSION(const TPMI_SH_AUTH_SESSION& value,
                                       std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_SH_AUTH_SESSION(std::string* buffer,
                                   TPMI_SH_AUTH_SESSION* value,
                                   std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_SH_HMAC(const TPMI_SH_HMAC& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_SH_HMAC(std::string* buffer,
                           TPMI_SH_HMAC* value,
                           std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_SH_POLICY(const TPMI_SH_POLICY& value,
                                 std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_SH_POLICY(std::string* buffer,
                             TPMI_SH_POLICY* value,
                             std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_DH_CONTEXT(const TPMI_DH_CONTEXT& value,
                                  std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_DH_CONTEXT(std::string* buffer,
                              TPMI_DH_CONTEXT* value,
                              std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_RH_HIERARCHY(const TPMI_RH_HIERARCHY& value,
                                    std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_RH_HIERARCHY(std::string* buffer,
                                TPMI_RH_HIERARCHY* value,
                                std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_RH_ENABLES(const TPMI_RH_ENABLES& value,
                                  std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_RH_ENABLES(std::string* buffer,
                              TPMI_RH_ENABLES* value,
                              std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_RH_HIERARCHY_AUTH(const TPMI_RH_HIERARCHY_AUTH& value,
                                         std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_RH_HIERARCHY_AUTH(std::string* buffer,
                                     TPMI_RH_HIERARCHY_AUTH* value,
                                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_RH_PLATFORM(const TPMI_RH_PLATFORM& value,
                                   std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_RH_PLATFORM(std::string* buffer,
                               TPMI_RH_PLATFORM* value,
                               std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_RH_OWNER(const TPMI_RH_OWNER& value,
                                std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_RH_OWNER(std::string* buffer,
                            TPMI_RH_OWNER* value,
                            std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_RH_ENDORSEMENT(const TPMI_RH_ENDORSEMENT& value,
                                      std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_RH_ENDORSEMENT(std::string* buffer,
                                  TPMI_RH_ENDORSEMENT* value,
                                  std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_RH_PROVISION(const TPMI_RH_PROVISION& value,
                                    std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_RH_PROVISION(std::string* buffer,
                                TPMI_RH_PROVISION* value,
                                std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_RH_CLEAR(const TPMI_RH_CLEAR& value,
                                std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_RH_CLEAR(std::string* buffer,
                            TPMI_RH_CLEAR* value,
                            std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_RH_NV_AUTH(const TPMI_RH_NV_AUTH& value,
                                  std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_RH_NV_AUTH(std::string* buffer,
                              TPMI_RH_NV_AUTH* value,
                              std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_RH_LOCKOUT(const TPMI_RH_LOCKOUT& value,
                                  std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_RH_LOCKOUT(std::string* buffer,
                              TPMI_RH_LOCKOUT* value,
                              std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_RH_NV_INDEX(const TPMI_RH_NV_INDEX& value,
                                   std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_RH_NV_INDEX(std::string* buffer,
                               TPMI_RH_NV_INDEX* value,
                               std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ALG_ASYM(const TPMI_ALG_ASYM& value,
                                std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ALG_ASYM(std::string* buffer,
                            TPMI_ALG_ASYM* value,
                            std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ALG_SYM(const TPMI_ALG_SYM& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ALG_SYM(std::string* buffer,
                           TPMI_ALG_SYM* value,
                           std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ALG_SYM_OBJECT(const TPMI_ALG_SYM_OBJECT& value,
                                      std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ALG_SYM_OBJECT(std::string* buffer,
                                  TPMI_ALG_SYM_OBJECT* value,
                                  std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ALG_SYM_MODE(const TPMI_ALG_SYM_MODE& value,
                                    std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ALG_SYM_MODE(std::string* buffer,
                                TPMI_ALG_SYM_MODE* value,
                                std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ALG_KDF(const TPMI_ALG_KDF& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ALG_KDF(std::string* buffer,
                           TPMI_ALG_KDF* value,
                           std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ALG_SIG_SCHEME(const TPMI_ALG_SIG_SCHEME& value,
                                      std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ALG_SIG_SCHEME(std::string* buffer,
                                  TPMI_ALG_SIG_SCHEME* value,
                                  std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ECC_KEY_EXCHANGE(const TPMI_ECC_KEY_EXCHANGE& value,
                                        std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ECC_KEY_EXCHANGE(std::string* buffer,
                                    TPMI_ECC_KEY_EXCHANGE* value,
                                    std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_ST(const TPM_ST& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT16(value, buffer);
 }
 
 TPM_RC Parse_TPM_ST(std::string* buffer,
                     TPM_ST* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT16(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ST_COMMAND_TAG(const TPMI_ST_COMMAND_TAG& value,
                                      std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ST(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ST_COMMAND_TAG(std::string* buffer,
                                  TPMI_ST_COMMAND_TAG* value,
                                  std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ST(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ST_ATTEST(const TPMI_ST_ATTEST& value,
                                 std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ST(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ST_ATTEST(std::string* buffer,
                             TPMI_ST_ATTEST* value,
                             std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ST(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_AES_KEY_BITS(const TPMI_AES_KEY_BITS& value,
                                    std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_KEY_BITS(value, buffer);
 }
 
 TPM_RC Parse_TPMI_AES_KEY_BITS(std::string* buffer,
                                TPMI_AES_KEY_BITS* value,
                                std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_KEY_BITS(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_SM4_KEY_BITS(const TPMI_SM4_KEY_BITS& value,
                                    std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_KEY_BITS(value, buffer);
 }
 
 TPM_RC Parse_TPMI_SM4_KEY_BITS(std::string* buffer,
                                TPMI_SM4_KEY_BITS* value,
                                std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_KEY_BITS(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ALG_KEYEDHASH_SCHEME(
     const TPMI_ALG_KEYEDHASH_SCHEME& value,
     std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ALG_KEYEDHASH_SCHEME(std::string* buffer,
                                        TPMI_ALG_KEYEDHASH_SCHEME* value,
                                        std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ALG_ASYM_SCHEME(const TPMI_ALG_ASYM_SCHEME& value,
                                       std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ALG_ASYM_SCHEME(std::string* buffer,
                                   TPMI_ALG_ASYM_SCHEME* value,
                                   std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ALG_RSA_SCHEME(const TPMI_ALG_RSA_SCHEME& value,
                                      std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ALG_RSA_SCHEME(std::string* buffer,
                                  TPMI_ALG_RSA_SCHEME* value,
                                  std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ALG_RSA_DECRYPT(const TPMI_ALG_RSA_DECRYPT& value,
                                       std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ALG_RSA_DECRYPT(std::string* buffer,
                                   TPMI_ALG_RSA_DECRYPT* value,
                                   std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_RSA_KEY_BITS(const TPMI_RSA_KEY_BITS& value,
                                    std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_KEY_BITS(value, buffer);
 }
 
 TPM_RC Parse_TPMI_RSA_KEY_BITS(std::string* buffer,
                                TPMI_RSA_KEY_BITS* value,
                                std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_KEY_BITS(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ALG_ECC_SCHEME(const TPMI_ALG_ECC_SCHEME& value,
                                      std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ALG_ECC_SCHEME(std::string* buffer,
                                  TPMI_ALG_ECC_SCHEME* value,
                                  std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_ECC_CURVE(const TPM_ECC_CURVE& value,
                                std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT16(value, buffer);
 }
 
 TPM_RC Parse_TPM_ECC_CURVE(std::string* buffer,
                            TPM_ECC_CURVE* value,
                            std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT16(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ECC_CURVE(const TPMI_ECC_CURVE& value,
                                 std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ECC_CURVE(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ECC_CURVE(std::string* buffer,
                             TPMI_ECC_CURVE* value,
                             std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ECC_CURVE(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMI_ALG_PUBLIC(const TPMI_ALG_PUBLIC& value,
                                  std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_ALG_ID(value, buffer);
 }
 
 TPM_RC Parse_TPMI_ALG_PUBLIC(std::string* buffer,
                              TPMI_ALG_PUBLIC* value,
                              std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_ALG_ID(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMA_ALGORITHM(const TPMA_ALGORITHM& value,
                                 std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPMA_ALGORITHM(std::string* buffer,
                             TPMA_ALGORITHM* value,
                             std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMA_OBJECT(const TPMA_OBJECT& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPMA_OBJECT(std::string* buffer,
                          TPMA_OBJECT* value,
                          std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMA_SESSION(const TPMA_SESSION& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT8(value, buffer);
 }
 
 TPM_RC Parse_TPMA_SESSION(std::string* buffer,
                           TPMA_SESSION* value,
                           std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT8(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMA_LOCALITY(const TPMA_LOCALITY& value,
                                std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT8(value, buffer);
 }
 
 TPM_RC Parse_TPMA_LOCALITY(std::string* buffer,
                            TPMA_LOCALITY* value,
                            std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT8(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMA_PERMANENT(const TPMA_PERMANENT& value,
                                 std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPMA_PERMANENT(std::string* buffer,
                             TPMA_PERMANENT* value,
                             std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMA_STARTUP_CLEAR(const TPMA_STARTUP_CLEAR& value,
                                     std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPMA_STARTUP_CLEAR(std::string* buffer,
                                 TPMA_STARTUP_CLEAR* value,
                                 std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMA_MEMORY(const TPMA_MEMORY& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPMA_MEMORY(std::string* buffer,
                          TPMA_MEMORY* value,
                          std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_CC(const TPM_CC& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_CC(std::string* buffer,
                     TPM_CC* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMA_CC(const TPMA_CC& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_CC(value, buffer);
 }
 
 TPM_RC Parse_TPMA_CC(std::string* buffer,
                      TPMA_CC* value,
                      std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_CC(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_NV_INDEX(const TPM_NV_INDEX& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_NV_INDEX(std::string* buffer,
                           TPM_NV_INDEX* value,
                           std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPMA_NV(const TPMA_NV& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPMA_NV(std::string* buffer,
                      TPMA_NV* value,
                      std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_SPEC(const TPM_SPEC& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_SPEC(std::string* buffer,
                       TPM_SPEC* value,
                       std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_GENERATED(const TPM_GENERATED& value,
                                std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_GENERATED(std::string* buffer,
                            TPM_GENERATED* value,
                            std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_RC(const TPM_RC& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_RC(std::string* buffer,
                     TPM_RC* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_CLOCK_ADJUST(const TPM_CLOCK_ADJUST& value,
                                   std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_INT8(value, buffer);
 }
 
 TPM_RC Parse_TPM_CLOCK_ADJUST(std::string* buffer,
                               TPM_CLOCK_ADJUST* value,
                               std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_INT8(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_EO(const TPM_EO& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT16(value, buffer);
 }
 
 TPM_RC Parse_TPM_EO(std::string* buffer,
                     TPM_EO* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT16(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_SU(const TPM_SU& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT16(value, buffer);
 }
 
 TPM_RC Parse_TPM_SU(std::string* buffer,
                     TPM_SU* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT16(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_SE(const TPM_SE& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT8(value, buffer);
 }
 
 TPM_RC Parse_TPM_SE(std::string* buffer,
                     TPM_SE* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT8(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_CAP(const TPM_CAP& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_CAP(std::string* buffer,
                      TPM_CAP* value,
                      std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_PT(const TPM_PT& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_PT(std::string* buffer,
                     TPM_PT* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_PT_PCR(const TPM_PT_PCR& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_PT_PCR(std::string* buffer,
                         TPM_PT_PCR* value,
                         std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_PS(const TPM_PS& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_PS(std::string* buffer,
                     TPM_PS* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_HT(const TPM_HT& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT8(value, buffer);
 }
 
 TPM_RC Parse_TPM_HT(std::string* buffer,
                     TPM_HT* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT8(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_RH(const TPM_RH& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_UINT32(value, buffer);
 }
 
 TPM_RC Parse_TPM_RH(std::string* buffer,
                     TPM_RH* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_UINT32(buffer, value, value_bytes);
 }
 
 TPM_RC Serialize_TPM_HC(const TPM_HC& value, std::string* buffer) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Serialize_TPM_HANDLE(value, buffer);
 }
 
 TPM_RC Parse_TPM_HC(std::string* buffer,
                     TPM_HC* value,
                     std::string* value_bytes) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return Parse_TPM_HANDLE(buffer, value, value_bytes);
 }
 
@@ -2186,7 +2041,7 @@ TPM_RC Serialize_TPMS_ALGORITHM_DESCRIPTION(
     const TPMS_ALGORITHM_DESCRIPTION& value,
     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM_ALG_ID(value.alg, buffer);
   if (result) {
@@ -2204,7 +2059,7 @@ TPM_RC Parse_TPMS_ALGORITHM_DESCRIPTION(std::string* buffer,
                                         TPMS_ALGORITHM_DESCRIPTION* value,
                                         std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM_ALG_ID(buffer, &value->alg, value_bytes);
   if (result) {
@@ -2222,7 +2077,7 @@ TPM_RC Serialize_TPMU_HA(const TPMU_HA& value,
                          TPMI_ALG_HASH selector,
                          std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_SHA384) {
     if (arraysize(value.sha384) < SHA384_DIGEST_SIZE) {
@@ -2295,7 +2150,7 @@ TPM_RC Parse_TPMU_HA(std::string* buffer,
                      TPMU_HA* value,
                      std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_SHA384) {
     if (arraysize(value->sha384) < SHA384_DIGEST_SIZE) {
@@ -2365,7 +2220,7 @@ TPM_RC Parse_TPMU_HA(std::string* buffer,
 
 TPM_RC Serialize_TPMT_HA(const TPMT_HA& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash_alg, buffer);
   if (result) {
@@ -2383,7 +2238,7 @@ TPM_RC Parse_TPMT_HA(std::string* buffer,
                      TPMT_HA* value,
                      std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash_alg, value_bytes);
   if (result) {
@@ -2399,7 +2254,7 @@ TPM_RC Parse_TPMT_HA(std::string* buffer,
 
 TPM_RC Serialize_TPM2B_DATA(const TPM2B_DATA& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -2422,7 +2277,7 @@ TPM_RC Parse_TPM2B_DATA(std::string* buffer,
                         TPM2B_DATA* value,
                         std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -2457,7 +2312,7 @@ std::string StringFrom_TPM2B_DATA(const TPM2B_DATA& tpm2b) {
 
 TPM_RC Serialize_TPM2B_EVENT(const TPM2B_EVENT& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -2480,7 +2335,7 @@ TPM_RC Parse_TPM2B_EVENT(std::string* buffer,
                          TPM2B_EVENT* value,
                          std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -2516,7 +2371,7 @@ std::string StringFrom_TPM2B_EVENT(const TPM2B_EVENT& tpm2b) {
 TPM_RC Serialize_TPM2B_MAX_BUFFER(const TPM2B_MAX_BUFFER& value,
                                   std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -2539,7 +2394,7 @@ TPM_RC Parse_TPM2B_MAX_BUFFER(std::string* buffer,
                               TPM2B_MAX_BUFFER* value,
                               std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -2575,7 +2430,7 @@ std::string StringFrom_TPM2B_MAX_BUFFER(const TPM2B_MAX_BUFFER& tpm2b) {
 TPM_RC Serialize_TPM2B_MAX_NV_BUFFER(const TPM2B_MAX_NV_BUFFER& value,
                                      std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -2598,7 +2453,7 @@ TPM_RC Parse_TPM2B_MAX_NV_BUFFER(std::string* buffer,
                                  TPM2B_MAX_NV_BUFFER* value,
                                  std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -2634,7 +2489,7 @@ std::string StringFrom_TPM2B_MAX_NV_BUFFER(const TPM2B_MAX_NV_BUFFER& tpm2b) {
 TPM_RC Serialize_TPM2B_TIMEOUT(const TPM2B_TIMEOUT& value,
                                std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -2657,7 +2512,7 @@ TPM_RC Parse_TPM2B_TIMEOUT(std::string* buffer,
                            TPM2B_TIMEOUT* value,
                            std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -2692,7 +2547,7 @@ std::string StringFrom_TPM2B_TIMEOUT(const TPM2B_TIMEOUT& tpm2b) {
 
 TPM_RC Serialize_TPM2B_IV(const TPM2B_IV& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -2715,7 +2570,7 @@ TPM_RC Parse_TPM2B_IV(std::string* buffer,
                       TPM2B_IV* value,
                       std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -2750,7 +2605,7 @@ std::string StringFrom_TPM2B_IV(const TPM2B_IV& tpm2b) {
 
 TPM_RC Serialize_TPM2B_NAME(const TPM2B_NAME& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -2773,7 +2628,7 @@ TPM_RC Parse_TPM2B_NAME(std::string* buffer,
                         TPM2B_NAME* value,
                         std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -2809,7 +2664,7 @@ std::string StringFrom_TPM2B_NAME(const TPM2B_NAME& tpm2b) {
 TPM_RC Serialize_TPMS_PCR_SELECT(const TPMS_PCR_SELECT& value,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT8(value.sizeof_select, buffer);
   if (result) {
@@ -2832,7 +2687,7 @@ TPM_RC Parse_TPMS_PCR_SELECT(std::string* buffer,
                              TPMS_PCR_SELECT* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT8(buffer, &value->sizeof_select, value_bytes);
   if (result) {
@@ -2854,7 +2709,7 @@ TPM_RC Parse_TPMS_PCR_SELECT(std::string* buffer,
 TPM_RC Serialize_TPMS_PCR_SELECTION(const TPMS_PCR_SELECTION& value,
                                     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash, buffer);
   if (result) {
@@ -2882,7 +2737,7 @@ TPM_RC Parse_TPMS_PCR_SELECTION(std::string* buffer,
                                 TPMS_PCR_SELECTION* value,
                                 std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash, value_bytes);
   if (result) {
@@ -2909,7 +2764,7 @@ TPM_RC Parse_TPMS_PCR_SELECTION(std::string* buffer,
 TPM_RC Serialize_TPMT_TK_CREATION(const TPMT_TK_CREATION& value,
                                   std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM_ST(value.tag, buffer);
   if (result) {
@@ -2932,7 +2787,7 @@ TPM_RC Parse_TPMT_TK_CREATION(std::string* buffer,
                               TPMT_TK_CREATION* value,
                               std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM_ST(buffer, &value->tag, value_bytes);
   if (result) {
@@ -2954,7 +2809,7 @@ TPM_RC Parse_TPMT_TK_CREATION(std::string* buffer,
 TPM_RC Serialize_TPMT_TK_VERIFIED(const TPMT_TK_VERIFIED& value,
                                   std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM_ST(value.tag, buffer);
   if (result) {
@@ -2977,7 +2832,7 @@ TPM_RC Parse_TPMT_TK_VERIFIED(std::string* buffer,
                               TPMT_TK_VERIFIED* value,
                               std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM_ST(buffer, &value->tag, value_bytes);
   if (result) {
@@ -2998,7 +2853,7 @@ TPM_RC Parse_TPMT_TK_VERIFIED(std::string* buffer,
 
 TPM_RC Serialize_TPMT_TK_AUTH(const TPMT_TK_AUTH& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_RH_HIERARCHY(value.hierarchy, buffer);
   if (result) {
@@ -3016,7 +2871,7 @@ TPM_RC Parse_TPMT_TK_AUTH(std::string* buffer,
                           TPMT_TK_AUTH* value,
                           std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_RH_HIERARCHY(buffer, &value->hierarchy, value_bytes);
   if (result) {
@@ -3033,7 +2888,7 @@ TPM_RC Parse_TPMT_TK_AUTH(std::string* buffer,
 TPM_RC Serialize_TPMT_TK_HASHCHECK(const TPMT_TK_HASHCHECK& value,
                                    std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM_ST(value.tag, buffer);
   if (result) {
@@ -3056,7 +2911,7 @@ TPM_RC Parse_TPMT_TK_HASHCHECK(std::string* buffer,
                                TPMT_TK_HASHCHECK* value,
                                std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM_ST(buffer, &value->tag, value_bytes);
   if (result) {
@@ -3078,7 +2933,7 @@ TPM_RC Parse_TPMT_TK_HASHCHECK(std::string* buffer,
 TPM_RC Serialize_TPMS_ALG_PROPERTY(const TPMS_ALG_PROPERTY& value,
                                    std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM_ALG_ID(value.alg, buffer);
   if (result) {
@@ -3096,7 +2951,7 @@ TPM_RC Parse_TPMS_ALG_PROPERTY(std::string* buffer,
                                TPMS_ALG_PROPERTY* value,
                                std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM_ALG_ID(buffer, &value->alg, value_bytes);
   if (result) {
@@ -3113,7 +2968,7 @@ TPM_RC Parse_TPMS_ALG_PROPERTY(std::string* buffer,
 TPM_RC Serialize_TPMS_TAGGED_PROPERTY(const TPMS_TAGGED_PROPERTY& value,
                                       std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM_PT(value.property, buffer);
   if (result) {
@@ -3131,7 +2986,7 @@ TPM_RC Parse_TPMS_TAGGED_PROPERTY(std::string* buffer,
                                   TPMS_TAGGED_PROPERTY* value,
                                   std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM_PT(buffer, &value->property, value_bytes);
   if (result) {
@@ -3148,7 +3003,7 @@ TPM_RC Parse_TPMS_TAGGED_PROPERTY(std::string* buffer,
 TPM_RC Serialize_TPMS_TAGGED_PCR_SELECT(const TPMS_TAGGED_PCR_SELECT& value,
                                         std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM_PT(value.tag, buffer);
   if (result) {
@@ -3176,7 +3031,7 @@ TPM_RC Parse_TPMS_TAGGED_PCR_SELECT(std::string* buffer,
                                     TPMS_TAGGED_PCR_SELECT* value,
                                     std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM_PT(buffer, &value->tag, value_bytes);
   if (result) {
@@ -3202,7 +3057,7 @@ TPM_RC Parse_TPMS_TAGGED_PCR_SELECT(std::string* buffer,
 
 TPM_RC Serialize_TPML_CC(const TPML_CC& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT32(value.count, buffer);
   if (result) {
@@ -3225,7 +3080,7 @@ TPM_RC Parse_TPML_CC(std::string* buffer,
                      TPML_CC* value,
                      std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT32(buffer, &value->count, value_bytes);
   if (result) {
@@ -3246,7 +3101,7 @@ TPM_RC Parse_TPML_CC(std::string* buffer,
 
 TPM_RC Serialize_TPML_CCA(const TPML_CCA& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT32(value.count, buffer);
   if (result) {
@@ -3269,7 +3124,7 @@ TPM_RC Parse_TPML_CCA(std::string* buffer,
                       TPML_CCA* value,
                       std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT32(buffer, &value->count, value_bytes);
   if (result) {
@@ -3290,7 +3145,7 @@ TPM_RC Parse_TPML_CCA(std::string* buffer,
 
 TPM_RC Serialize_TPML_ALG(const TPML_ALG& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT32(value.count, buffer);
   if (result) {
@@ -3313,7 +3168,7 @@ TPM_RC Parse_TPML_ALG(std::string* buffer,
                       TPML_ALG* value,
                       std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT32(buffer, &value->count, value_bytes);
   if (result) {
@@ -3334,7 +3189,7 @@ TPM_RC Parse_TPML_ALG(std::string* buffer,
 
 TPM_RC Serialize_TPML_HANDLE(const TPML_HANDLE& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT32(value.count, buffer);
   if (result) {
@@ -3357,7 +3212,7 @@ TPM_RC Parse_TPML_HANDLE(std::string* buffer,
                          TPML_HANDLE* value,
                          std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT32(buffer, &value->count, value_bytes);
   if (result) {
@@ -3378,7 +3233,7 @@ TPM_RC Parse_TPML_HANDLE(std::string* buffer,
 
 TPM_RC Serialize_TPML_DIGEST(const TPML_DIGEST& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT32(value.count, buffer);
   if (result) {
@@ -3401,7 +3256,7 @@ TPM_RC Parse_TPML_DIGEST(std::string* buffer,
                          TPML_DIGEST* value,
                          std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT32(buffer, &value->count, value_bytes);
   if (result) {
@@ -3423,7 +3278,7 @@ TPM_RC Parse_TPML_DIGEST(std::string* buffer,
 TPM_RC Serialize_TPML_DIGEST_VALUES(const TPML_DIGEST_VALUES& value,
                                     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT32(value.count, buffer);
   if (result) {
@@ -3446,7 +3301,7 @@ TPM_RC Parse_TPML_DIGEST_VALUES(std::string* buffer,
                                 TPML_DIGEST_VALUES* value,
                                 std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT32(buffer, &value->count, value_bytes);
   if (result) {
@@ -3468,7 +3323,7 @@ TPM_RC Parse_TPML_DIGEST_VALUES(std::string* buffer,
 TPM_RC Serialize_TPM2B_DIGEST_VALUES(const TPM2B_DIGEST_VALUES& value,
                                      std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -3491,7 +3346,7 @@ TPM_RC Parse_TPM2B_DIGEST_VALUES(std::string* buffer,
                                  TPM2B_DIGEST_VALUES* value,
                                  std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -3527,7 +3382,7 @@ std::string StringFrom_TPM2B_DIGEST_VALUES(const TPM2B_DIGEST_VALUES& tpm2b) {
 TPM_RC Serialize_TPML_PCR_SELECTION(const TPML_PCR_SELECTION& value,
                                     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT32(value.count, buffer);
   if (result) {
@@ -3550,7 +3405,7 @@ TPM_RC Parse_TPML_PCR_SELECTION(std::string* buffer,
                                 TPML_PCR_SELECTION* value,
                                 std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT32(buffer, &value->count, value_bytes);
   if (result) {
@@ -3573,7 +3428,7 @@ TPM_RC Parse_TPML_PCR_SELECTION(std::string* buffer,
 TPM_RC Serialize_TPML_ALG_PROPERTY(const TPML_ALG_PROPERTY& value,
                                    std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT32(value.count, buffer);
   if (result) {
@@ -3596,7 +3451,7 @@ TPM_RC Parse_TPML_ALG_PROPERTY(std::string* buffer,
                                TPML_ALG_PROPERTY* value,
                                std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT32(buffer, &value->count, value_bytes);
   if (result) {
@@ -3619,7 +3474,7 @@ TPM_RC Parse_TPML_ALG_PROPERTY(std::string* buffer,
 TPM_RC Serialize_TPML_TAGGED_TPM_PROPERTY(const TPML_TAGGED_TPM_PROPERTY& value,
                                           std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT32(value.count, buffer);
   if (result) {
@@ -3642,7 +3497,7 @@ TPM_RC Parse_TPML_TAGGED_TPM_PROPERTY(std::string* buffer,
                                       TPML_TAGGED_TPM_PROPERTY* value,
                                       std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT32(buffer, &value->count, value_bytes);
   if (result) {
@@ -3665,7 +3520,7 @@ TPM_RC Parse_TPML_TAGGED_TPM_PROPERTY(std::string* buffer,
 TPM_RC Serialize_TPML_TAGGED_PCR_PROPERTY(const TPML_TAGGED_PCR_PROPERTY& value,
                                           std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT32(value.count, buffer);
   if (result) {
@@ -3688,7 +3543,7 @@ TPM_RC Parse_TPML_TAGGED_PCR_PROPERTY(std::string* buffer,
                                       TPML_TAGGED_PCR_PROPERTY* value,
                                       std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT32(buffer, &value->count, value_bytes);
   if (result) {
@@ -3711,7 +3566,7 @@ TPM_RC Parse_TPML_TAGGED_PCR_PROPERTY(std::string* buffer,
 TPM_RC Serialize_TPML_ECC_CURVE(const TPML_ECC_CURVE& value,
                                 std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT32(value.count, buffer);
   if (result) {
@@ -3734,7 +3589,7 @@ TPM_RC Parse_TPML_ECC_CURVE(std::string* buffer,
                             TPML_ECC_CURVE* value,
                             std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT32(buffer, &value->count, value_bytes);
   if (result) {
@@ -3757,7 +3612,7 @@ TPM_RC Serialize_TPMU_CAPABILITIES(const TPMU_CAPABILITIES& value,
                                    TPM_CAP selector,
                                    std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_CAP_PCRS) {
     result = Serialize_TPML_PCR_SELECTION(value.assigned_pcr, buffer);
@@ -3829,7 +3684,7 @@ TPM_RC Parse_TPMU_CAPABILITIES(std::string* buffer,
                                TPMU_CAPABILITIES* value,
                                std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_CAP_PCRS) {
     result =
@@ -3902,7 +3757,7 @@ TPM_RC Parse_TPMU_CAPABILITIES(std::string* buffer,
 TPM_RC Serialize_TPMS_CAPABILITY_DATA(const TPMS_CAPABILITY_DATA& value,
                                       std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM_CAP(value.capability, buffer);
   if (result) {
@@ -3920,7 +3775,7 @@ TPM_RC Parse_TPMS_CAPABILITY_DATA(std::string* buffer,
                                   TPMS_CAPABILITY_DATA* value,
                                   std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM_CAP(buffer, &value->capability, value_bytes);
   if (result) {
@@ -3938,7 +3793,7 @@ TPM_RC Parse_TPMS_CAPABILITY_DATA(std::string* buffer,
 TPM_RC Serialize_TPMS_CLOCK_INFO(const TPMS_CLOCK_INFO& value,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT64(value.clock, buffer);
   if (result) {
@@ -3966,7 +3821,7 @@ TPM_RC Parse_TPMS_CLOCK_INFO(std::string* buffer,
                              TPMS_CLOCK_INFO* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT64(buffer, &value->clock, value_bytes);
   if (result) {
@@ -3993,7 +3848,7 @@ TPM_RC Parse_TPMS_CLOCK_INFO(std::string* buffer,
 TPM_RC Serialize_TPMS_TIME_INFO(const TPMS_TIME_INFO& value,
                                 std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT64(value.time, buffer);
   if (result) {
@@ -4011,7 +3866,7 @@ TPM_RC Parse_TPMS_TIME_INFO(std::string* buffer,
                             TPMS_TIME_INFO* value,
                             std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT64(buffer, &value->time, value_bytes);
   if (result) {
@@ -4028,7 +3883,7 @@ TPM_RC Parse_TPMS_TIME_INFO(std::string* buffer,
 TPM_RC Serialize_TPMS_TIME_ATTEST_INFO(const TPMS_TIME_ATTEST_INFO& value,
                                        std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMS_TIME_INFO(value.time, buffer);
   if (result) {
@@ -4046,7 +3901,7 @@ TPM_RC Parse_TPMS_TIME_ATTEST_INFO(std::string* buffer,
                                    TPMS_TIME_ATTEST_INFO* value,
                                    std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMS_TIME_INFO(buffer, &value->time, value_bytes);
   if (result) {
@@ -4063,7 +3918,7 @@ TPM_RC Parse_TPMS_TIME_ATTEST_INFO(std::string* buffer,
 TPM_RC Serialize_TPMS_CERTIFY_INFO(const TPMS_CERTIFY_INFO& value,
                                    std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM2B_NAME(value.name, buffer);
   if (result) {
@@ -4081,7 +3936,7 @@ TPM_RC Parse_TPMS_CERTIFY_INFO(std::string* buffer,
                                TPMS_CERTIFY_INFO* value,
                                std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM2B_NAME(buffer, &value->name, value_bytes);
   if (result) {
@@ -4098,7 +3953,7 @@ TPM_RC Parse_TPMS_CERTIFY_INFO(std::string* buffer,
 TPM_RC Serialize_TPMS_QUOTE_INFO(const TPMS_QUOTE_INFO& value,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPML_PCR_SELECTION(value.pcr_select, buffer);
   if (result) {
@@ -4116,7 +3971,7 @@ TPM_RC Parse_TPMS_QUOTE_INFO(std::string* buffer,
                              TPMS_QUOTE_INFO* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPML_PCR_SELECTION(buffer, &value->pcr_select, value_bytes);
   if (result) {
@@ -4133,7 +3988,7 @@ TPM_RC Parse_TPMS_QUOTE_INFO(std::string* buffer,
 TPM_RC Serialize_TPMS_COMMAND_AUDIT_INFO(const TPMS_COMMAND_AUDIT_INFO& value,
                                          std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT64(value.audit_counter, buffer);
   if (result) {
@@ -4161,7 +4016,7 @@ TPM_RC Parse_TPMS_COMMAND_AUDIT_INFO(std::string* buffer,
                                      TPMS_COMMAND_AUDIT_INFO* value,
                                      std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT64(buffer, &value->audit_counter, value_bytes);
   if (result) {
@@ -4188,7 +4043,7 @@ TPM_RC Parse_TPMS_COMMAND_AUDIT_INFO(std::string* buffer,
 TPM_RC Serialize_TPMS_SESSION_AUDIT_INFO(const TPMS_SESSION_AUDIT_INFO& value,
                                          std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_YES_NO(value.exclusive_session, buffer);
   if (result) {
@@ -4206,7 +4061,7 @@ TPM_RC Parse_TPMS_SESSION_AUDIT_INFO(std::string* buffer,
                                      TPMS_SESSION_AUDIT_INFO* value,
                                      std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_YES_NO(buffer, &value->exclusive_session, value_bytes);
   if (result) {
@@ -4223,7 +4078,7 @@ TPM_RC Parse_TPMS_SESSION_AUDIT_INFO(std::string* buffer,
 TPM_RC Serialize_TPMS_CREATION_INFO(const TPMS_CREATION_INFO& value,
                                     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM2B_NAME(value.object_name, buffer);
   if (result) {
@@ -4241,7 +4096,7 @@ TPM_RC Parse_TPMS_CREATION_INFO(std::string* buffer,
                                 TPMS_CREATION_INFO* value,
                                 std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM2B_NAME(buffer, &value->object_name, value_bytes);
   if (result) {
@@ -4258,7 +4113,7 @@ TPM_RC Parse_TPMS_CREATION_INFO(std::string* buffer,
 TPM_RC Serialize_TPMS_NV_CERTIFY_INFO(const TPMS_NV_CERTIFY_INFO& value,
                                       std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM2B_NAME(value.index_name, buffer);
   if (result) {
@@ -4281,7 +4136,7 @@ TPM_RC Parse_TPMS_NV_CERTIFY_INFO(std::string* buffer,
                                   TPMS_NV_CERTIFY_INFO* value,
                                   std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM2B_NAME(buffer, &value->index_name, value_bytes);
   if (result) {
@@ -4304,7 +4159,7 @@ TPM_RC Serialize_TPMU_ATTEST(const TPMU_ATTEST& value,
                              TPMI_ST_ATTEST selector,
                              std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ST_ATTEST_SESSION_AUDIT) {
     result = Serialize_TPMS_SESSION_AUDIT_INFO(value.session_audit, buffer);
@@ -4362,7 +4217,7 @@ TPM_RC Parse_TPMU_ATTEST(std::string* buffer,
                          TPMU_ATTEST* value,
                          std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ST_ATTEST_SESSION_AUDIT) {
     result = Parse_TPMS_SESSION_AUDIT_INFO(buffer, &value->session_audit,
@@ -4419,7 +4274,7 @@ TPM_RC Parse_TPMU_ATTEST(std::string* buffer,
 
 TPM_RC Serialize_TPMS_ATTEST(const TPMS_ATTEST& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM_GENERATED(value.magic, buffer);
   if (result) {
@@ -4462,7 +4317,7 @@ TPM_RC Parse_TPMS_ATTEST(std::string* buffer,
                          TPMS_ATTEST* value,
                          std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM_GENERATED(buffer, &value->magic, value_bytes);
   if (result) {
@@ -4504,7 +4359,7 @@ TPM_RC Parse_TPMS_ATTEST(std::string* buffer,
 
 TPM_RC Serialize_TPM2B_ATTEST(const TPM2B_ATTEST& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -4527,7 +4382,7 @@ TPM_RC Parse_TPM2B_ATTEST(std::string* buffer,
                           TPM2B_ATTEST* value,
                           std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -4564,7 +4419,7 @@ std::string StringFrom_TPM2B_ATTEST(const TPM2B_ATTEST& tpm2b) {
 TPM_RC Serialize_TPMS_AUTH_COMMAND(const TPMS_AUTH_COMMAND& value,
                                    std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_SH_AUTH_SESSION(value.session_handle, buffer);
   if (result) {
@@ -4592,7 +4447,7 @@ TPM_RC Parse_TPMS_AUTH_COMMAND(std::string* buffer,
                                TPMS_AUTH_COMMAND* value,
                                std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result =
       Parse_TPMI_SH_AUTH_SESSION(buffer, &value->session_handle, value_bytes);
@@ -4620,7 +4475,7 @@ TPM_RC Parse_TPMS_AUTH_COMMAND(std::string* buffer,
 TPM_RC Serialize_TPMS_AUTH_RESPONSE(const TPMS_AUTH_RESPONSE& value,
                                     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM2B_NONCE(value.nonce, buffer);
   if (result) {
@@ -4643,7 +4498,7 @@ TPM_RC Parse_TPMS_AUTH_RESPONSE(std::string* buffer,
                                 TPMS_AUTH_RESPONSE* value,
                                 std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM2B_NONCE(buffer, &value->nonce, value_bytes);
   if (result) {
@@ -4666,7 +4521,7 @@ TPM_RC Serialize_TPMU_SYM_KEY_BITS(const TPMU_SYM_KEY_BITS& value,
                                    TPMI_ALG_SYM selector,
                                    std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_NULL) {
     // Do nothing.
@@ -4700,7 +4555,7 @@ TPM_RC Parse_TPMU_SYM_KEY_BITS(std::string* buffer,
                                TPMU_SYM_KEY_BITS* value,
                                std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_NULL) {
     // Do nothing.
@@ -4733,7 +4588,7 @@ TPM_RC Serialize_TPMU_SYM_MODE(const TPMU_SYM_MODE& value,
                                TPMI_ALG_SYM selector,
                                std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_NULL) {
     // Do nothing.
@@ -4764,7 +4619,7 @@ TPM_RC Parse_TPMU_SYM_MODE(std::string* buffer,
                            TPMU_SYM_MODE* value,
                            std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_NULL) {
     // Do nothing.
@@ -4794,7 +4649,7 @@ TPM_RC Serialize_TPMU_SYM_DETAILS(const TPMU_SYM_DETAILS& value,
                                   TPMI_ALG_SYM selector,
                                   std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return result;
 }
 
@@ -4803,13 +4658,13 @@ TPM_RC Parse_TPMU_SYM_DETAILS(std::string* buffer,
                               TPMU_SYM_DETAILS* value,
                               std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
   return result;
 }
 
 TPM_RC Serialize_TPMT_SYM_DEF(const TPMT_SYM_DEF& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_SYM(value.algorithm, buffer);
   if (result) {
@@ -4837,7 +4692,7 @@ TPM_RC Parse_TPMT_SYM_DEF(std::string* buffer,
                           TPMT_SYM_DEF* value,
                           std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_SYM(buffer, &value->algorithm, value_bytes);
   if (result) {
@@ -4867,7 +4722,7 @@ TPM_RC Parse_TPMT_SYM_DEF(std::string* buffer,
 TPM_RC Serialize_TPMT_SYM_DEF_OBJECT(const TPMT_SYM_DEF_OBJECT& value,
                                      std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_SYM_OBJECT(value.algorithm, buffer);
   if (result) {
@@ -4895,7 +4750,7 @@ TPM_RC Parse_TPMT_SYM_DEF_OBJECT(std::string* buffer,
                                  TPMT_SYM_DEF_OBJECT* value,
                                  std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_SYM_OBJECT(buffer, &value->algorithm, value_bytes);
   if (result) {
@@ -4925,7 +4780,7 @@ TPM_RC Parse_TPMT_SYM_DEF_OBJECT(std::string* buffer,
 TPM_RC Serialize_TPM2B_SYM_KEY(const TPM2B_SYM_KEY& value,
                                std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -4948,7 +4803,7 @@ TPM_RC Parse_TPM2B_SYM_KEY(std::string* buffer,
                            TPM2B_SYM_KEY* value,
                            std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -4984,7 +4839,7 @@ std::string StringFrom_TPM2B_SYM_KEY(const TPM2B_SYM_KEY& tpm2b) {
 TPM_RC Serialize_TPMS_SYMCIPHER_PARMS(const TPMS_SYMCIPHER_PARMS& value,
                                       std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMT_SYM_DEF_OBJECT(value.sym, buffer);
   if (result) {
@@ -4997,7 +4852,7 @@ TPM_RC Parse_TPMS_SYMCIPHER_PARMS(std::string* buffer,
                                   TPMS_SYMCIPHER_PARMS* value,
                                   std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMT_SYM_DEF_OBJECT(buffer, &value->sym, value_bytes);
   if (result) {
@@ -5009,7 +4864,7 @@ TPM_RC Parse_TPMS_SYMCIPHER_PARMS(std::string* buffer,
 TPM_RC Serialize_TPM2B_SENSITIVE_DATA(const TPM2B_SENSITIVE_DATA& value,
                                       std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -5032,7 +4887,7 @@ TPM_RC Parse_TPM2B_SENSITIVE_DATA(std::string* buffer,
                                   TPM2B_SENSITIVE_DATA* value,
                                   std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -5068,7 +4923,7 @@ std::string StringFrom_TPM2B_SENSITIVE_DATA(const TPM2B_SENSITIVE_DATA& tpm2b) {
 TPM_RC Serialize_TPMS_SENSITIVE_CREATE(const TPMS_SENSITIVE_CREATE& value,
                                        std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM2B_AUTH(value.user_auth, buffer);
   if (result) {
@@ -5086,7 +4941,7 @@ TPM_RC Parse_TPMS_SENSITIVE_CREATE(std::string* buffer,
                                    TPMS_SENSITIVE_CREATE* value,
                                    std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM2B_AUTH(buffer, &value->user_auth, value_bytes);
   if (result) {
@@ -5103,7 +4958,7 @@ TPM_RC Parse_TPMS_SENSITIVE_CREATE(std::string* buffer,
 TPM_RC Serialize_TPM2B_SENSITIVE_CREATE(const TPM2B_SENSITIVE_CREATE& value,
                                         std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   std::string field_bytes;
   result = Serialize_TPMS_SENSITIVE_CREATE(value.sensitive, &field_bytes);
@@ -5123,7 +4978,7 @@ TPM_RC Parse_TPM2B_SENSITIVE_CREATE(std::string* buffer,
                                     TPM2B_SENSITIVE_CREATE* value,
                                     std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -5148,7 +5003,7 @@ TPM2B_SENSITIVE_CREATE Make_TPM2B_SENSITIVE_CREATE(
 TPM_RC Serialize_TPMS_SCHEME_XOR(const TPMS_SCHEME_XOR& value,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash_alg, buffer);
   if (result) {
@@ -5166,7 +5021,7 @@ TPM_RC Parse_TPMS_SCHEME_XOR(std::string* buffer,
                              TPMS_SCHEME_XOR* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash_alg, value_bytes);
   if (result) {
@@ -5184,7 +5039,7 @@ TPM_RC Serialize_TPMU_SCHEME_KEYEDHASH(const TPMU_SCHEME_KEYEDHASH& value,
                                        TPMI_ALG_KEYEDHASH_SCHEME selector,
                                        std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_NULL) {
     // Do nothing.
@@ -5211,7 +5066,7 @@ TPM_RC Parse_TPMU_SCHEME_KEYEDHASH(std::string* buffer,
                                    TPMU_SCHEME_KEYEDHASH* value,
                                    std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_NULL) {
     // Do nothing.
@@ -5236,7 +5091,7 @@ TPM_RC Parse_TPMU_SCHEME_KEYEDHASH(std::string* buffer,
 TPM_RC Serialize_TPMT_KEYEDHASH_SCHEME(const TPMT_KEYEDHASH_SCHEME& value,
                                        std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_KEYEDHASH_SCHEME(value.scheme, buffer);
   if (result) {
@@ -5254,7 +5109,7 @@ TPM_RC Parse_TPMT_KEYEDHASH_SCHEME(std::string* buffer,
                                    TPMT_KEYEDHASH_SCHEME* value,
                                    std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_KEYEDHASH_SCHEME(buffer, &value->scheme, value_bytes);
   if (result) {
@@ -5272,7 +5127,7 @@ TPM_RC Parse_TPMT_KEYEDHASH_SCHEME(std::string* buffer,
 TPM_RC Serialize_TPMS_SCHEME_ECDAA(const TPMS_SCHEME_ECDAA& value,
                                    std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash_alg, buffer);
   if (result) {
@@ -5290,7 +5145,7 @@ TPM_RC Parse_TPMS_SCHEME_ECDAA(std::string* buffer,
                                TPMS_SCHEME_ECDAA* value,
                                std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash_alg, value_bytes);
   if (result) {
@@ -5308,7 +5163,7 @@ TPM_RC Serialize_TPMU_SIG_SCHEME(const TPMU_SIG_SCHEME& value,
                                  TPMI_ALG_SIG_SCHEME selector,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_HMAC) {
     result = Serialize_TPMS_SCHEME_HMAC(value.hmac, buffer);
@@ -5370,7 +5225,7 @@ TPM_RC Parse_TPMU_SIG_SCHEME(std::string* buffer,
                              TPMU_SIG_SCHEME* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_HMAC) {
     result = Parse_TPMS_SCHEME_HMAC(buffer, &value->hmac, value_bytes);
@@ -5431,7 +5286,7 @@ TPM_RC Parse_TPMU_SIG_SCHEME(std::string* buffer,
 TPM_RC Serialize_TPMT_SIG_SCHEME(const TPMT_SIG_SCHEME& value,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_SIG_SCHEME(value.scheme, buffer);
   if (result) {
@@ -5449,7 +5304,7 @@ TPM_RC Parse_TPMT_SIG_SCHEME(std::string* buffer,
                              TPMT_SIG_SCHEME* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_SIG_SCHEME(buffer, &value->scheme, value_bytes);
   if (result) {
@@ -5467,7 +5322,7 @@ TPM_RC Parse_TPMT_SIG_SCHEME(std::string* buffer,
 TPM_RC Serialize_TPMS_SCHEME_OAEP(const TPMS_SCHEME_OAEP& value,
                                   std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash_alg, buffer);
   if (result) {
@@ -5480,7 +5335,7 @@ TPM_RC Parse_TPMS_SCHEME_OAEP(std::string* buffer,
                               TPMS_SCHEME_OAEP* value,
                               std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash_alg, value_bytes);
   if (result) {
@@ -5492,7 +5347,7 @@ TPM_RC Parse_TPMS_SCHEME_OAEP(std::string* buffer,
 TPM_RC Serialize_TPMS_SCHEME_ECDH(const TPMS_SCHEME_ECDH& value,
                                   std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash_alg, buffer);
   if (result) {
@@ -5505,7 +5360,7 @@ TPM_RC Parse_TPMS_SCHEME_ECDH(std::string* buffer,
                               TPMS_SCHEME_ECDH* value,
                               std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash_alg, value_bytes);
   if (result) {
@@ -5517,7 +5372,7 @@ TPM_RC Parse_TPMS_SCHEME_ECDH(std::string* buffer,
 TPM_RC Serialize_TPMS_SCHEME_MGF1(const TPMS_SCHEME_MGF1& value,
                                   std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash_alg, buffer);
   if (result) {
@@ -5530,7 +5385,7 @@ TPM_RC Parse_TPMS_SCHEME_MGF1(std::string* buffer,
                               TPMS_SCHEME_MGF1* value,
                               std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash_alg, value_bytes);
   if (result) {
@@ -5543,7 +5398,7 @@ TPM_RC Serialize_TPMS_SCHEME_KDF1_SP800_56a(
     const TPMS_SCHEME_KDF1_SP800_56a& value,
     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash_alg, buffer);
   if (result) {
@@ -5556,7 +5411,7 @@ TPM_RC Parse_TPMS_SCHEME_KDF1_SP800_56a(std::string* buffer,
                                         TPMS_SCHEME_KDF1_SP800_56a* value,
                                         std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash_alg, value_bytes);
   if (result) {
@@ -5568,7 +5423,7 @@ TPM_RC Parse_TPMS_SCHEME_KDF1_SP800_56a(std::string* buffer,
 TPM_RC Serialize_TPMS_SCHEME_KDF2(const TPMS_SCHEME_KDF2& value,
                                   std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash_alg, buffer);
   if (result) {
@@ -5581,7 +5436,7 @@ TPM_RC Parse_TPMS_SCHEME_KDF2(std::string* buffer,
                               TPMS_SCHEME_KDF2* value,
                               std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash_alg, value_bytes);
   if (result) {
@@ -5594,7 +5449,7 @@ TPM_RC Serialize_TPMS_SCHEME_KDF1_SP800_108(
     const TPMS_SCHEME_KDF1_SP800_108& value,
     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash_alg, buffer);
   if (result) {
@@ -5607,7 +5462,7 @@ TPM_RC Parse_TPMS_SCHEME_KDF1_SP800_108(std::string* buffer,
                                         TPMS_SCHEME_KDF1_SP800_108* value,
                                         std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash_alg, value_bytes);
   if (result) {
@@ -5620,7 +5475,7 @@ TPM_RC Serialize_TPMU_KDF_SCHEME(const TPMU_KDF_SCHEME& value,
                                  TPMI_ALG_KDF selector,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_KDF1_SP800_56a) {
     result = Serialize_TPMS_SCHEME_KDF1_SP800_56a(value.kdf1_sp800_56a, buffer);
@@ -5661,7 +5516,7 @@ TPM_RC Parse_TPMU_KDF_SCHEME(std::string* buffer,
                              TPMU_KDF_SCHEME* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_KDF1_SP800_56a) {
     result = Parse_TPMS_SCHEME_KDF1_SP800_56a(buffer, &value->kdf1_sp800_56a,
@@ -5702,7 +5557,7 @@ TPM_RC Parse_TPMU_KDF_SCHEME(std::string* buffer,
 TPM_RC Serialize_TPMT_KDF_SCHEME(const TPMT_KDF_SCHEME& value,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_KDF(value.scheme, buffer);
   if (result) {
@@ -5720,7 +5575,7 @@ TPM_RC Parse_TPMT_KDF_SCHEME(std::string* buffer,
                              TPMT_KDF_SCHEME* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_KDF(buffer, &value->scheme, value_bytes);
   if (result) {
@@ -5739,7 +5594,7 @@ TPM_RC Serialize_TPMU_ASYM_SCHEME(const TPMU_ASYM_SCHEME& value,
                                   TPMI_ALG_ASYM_SCHEME selector,
                                   std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_RSAES) {
     // Do nothing.
@@ -5812,7 +5667,7 @@ TPM_RC Parse_TPMU_ASYM_SCHEME(std::string* buffer,
                               TPMU_ASYM_SCHEME* value,
                               std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_RSAES) {
     // Do nothing.
@@ -5884,7 +5739,7 @@ TPM_RC Parse_TPMU_ASYM_SCHEME(std::string* buffer,
 TPM_RC Serialize_TPMT_ASYM_SCHEME(const TPMT_ASYM_SCHEME& value,
                                   std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_ASYM_SCHEME(value.scheme, buffer);
   if (result) {
@@ -5902,7 +5757,7 @@ TPM_RC Parse_TPMT_ASYM_SCHEME(std::string* buffer,
                               TPMT_ASYM_SCHEME* value,
                               std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_ASYM_SCHEME(buffer, &value->scheme, value_bytes);
   if (result) {
@@ -5920,7 +5775,7 @@ TPM_RC Parse_TPMT_ASYM_SCHEME(std::string* buffer,
 TPM_RC Serialize_TPMT_RSA_SCHEME(const TPMT_RSA_SCHEME& value,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_RSA_SCHEME(value.scheme, buffer);
   if (result) {
@@ -5938,7 +5793,7 @@ TPM_RC Parse_TPMT_RSA_SCHEME(std::string* buffer,
                              TPMT_RSA_SCHEME* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_RSA_SCHEME(buffer, &value->scheme, value_bytes);
   if (result) {
@@ -5956,7 +5811,7 @@ TPM_RC Parse_TPMT_RSA_SCHEME(std::string* buffer,
 TPM_RC Serialize_TPMT_RSA_DECRYPT(const TPMT_RSA_DECRYPT& value,
                                   std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_RSA_DECRYPT(value.scheme, buffer);
   if (result) {
@@ -5974,7 +5829,7 @@ TPM_RC Parse_TPMT_RSA_DECRYPT(std::string* buffer,
                               TPMT_RSA_DECRYPT* value,
                               std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_RSA_DECRYPT(buffer, &value->scheme, value_bytes);
   if (result) {
@@ -5992,7 +5847,7 @@ TPM_RC Parse_TPMT_RSA_DECRYPT(std::string* buffer,
 TPM_RC Serialize_TPM2B_PUBLIC_KEY_RSA(const TPM2B_PUBLIC_KEY_RSA& value,
                                       std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -6015,7 +5870,7 @@ TPM_RC Parse_TPM2B_PUBLIC_KEY_RSA(std::string* buffer,
                                   TPM2B_PUBLIC_KEY_RSA* value,
                                   std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -6051,7 +5906,7 @@ std::string StringFrom_TPM2B_PUBLIC_KEY_RSA(const TPM2B_PUBLIC_KEY_RSA& tpm2b) {
 TPM_RC Serialize_TPM2B_PRIVATE_KEY_RSA(const TPM2B_PRIVATE_KEY_RSA& value,
                                        std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -6074,7 +5929,7 @@ TPM_RC Parse_TPM2B_PRIVATE_KEY_RSA(std::string* buffer,
                                    TPM2B_PRIVATE_KEY_RSA* value,
                                    std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -6111,7 +5966,7 @@ std::string StringFrom_TPM2B_PRIVATE_KEY_RSA(
 TPM_RC Serialize_TPM2B_ECC_PARAMETER(const TPM2B_ECC_PARAMETER& value,
                                      std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -6134,7 +5989,7 @@ TPM_RC Parse_TPM2B_ECC_PARAMETER(std::string* buffer,
                                  TPM2B_ECC_PARAMETER* value,
                                  std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -6170,7 +6025,7 @@ std::string StringFrom_TPM2B_ECC_PARAMETER(const TPM2B_ECC_PARAMETER& tpm2b) {
 TPM_RC Serialize_TPMS_ECC_POINT(const TPMS_ECC_POINT& value,
                                 std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM2B_ECC_PARAMETER(value.x, buffer);
   if (result) {
@@ -6188,7 +6043,7 @@ TPM_RC Parse_TPMS_ECC_POINT(std::string* buffer,
                             TPMS_ECC_POINT* value,
                             std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM2B_ECC_PARAMETER(buffer, &value->x, value_bytes);
   if (result) {
@@ -6205,7 +6060,7 @@ TPM_RC Parse_TPMS_ECC_POINT(std::string* buffer,
 TPM_RC Serialize_TPM2B_ECC_POINT(const TPM2B_ECC_POINT& value,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   std::string field_bytes;
   result = Serialize_TPMS_ECC_POINT(value.point, &field_bytes);
@@ -6225,7 +6080,7 @@ TPM_RC Parse_TPM2B_ECC_POINT(std::string* buffer,
                              TPM2B_ECC_POINT* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -6249,7 +6104,7 @@ TPM2B_ECC_POINT Make_TPM2B_ECC_POINT(const TPMS_ECC_POINT& inner) {
 TPM_RC Serialize_TPMT_ECC_SCHEME(const TPMT_ECC_SCHEME& value,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_ECC_SCHEME(value.scheme, buffer);
   if (result) {
@@ -6267,7 +6122,7 @@ TPM_RC Parse_TPMT_ECC_SCHEME(std::string* buffer,
                              TPMT_ECC_SCHEME* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_ECC_SCHEME(buffer, &value->scheme, value_bytes);
   if (result) {
@@ -6286,7 +6141,7 @@ TPM_RC Serialize_TPMS_ALGORITHM_DETAIL_ECC(
     const TPMS_ALGORITHM_DETAIL_ECC& value,
     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM_ECC_CURVE(value.curve_id, buffer);
   if (result) {
@@ -6349,7 +6204,7 @@ TPM_RC Parse_TPMS_ALGORITHM_DETAIL_ECC(std::string* buffer,
                                        TPMS_ALGORITHM_DETAIL_ECC* value,
                                        std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM_ECC_CURVE(buffer, &value->curve_id, value_bytes);
   if (result) {
@@ -6411,7 +6266,7 @@ TPM_RC Parse_TPMS_ALGORITHM_DETAIL_ECC(std::string* buffer,
 TPM_RC Serialize_TPMS_SIGNATURE_RSASSA(const TPMS_SIGNATURE_RSASSA& value,
                                        std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash, buffer);
   if (result) {
@@ -6429,7 +6284,7 @@ TPM_RC Parse_TPMS_SIGNATURE_RSASSA(std::string* buffer,
                                    TPMS_SIGNATURE_RSASSA* value,
                                    std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash, value_bytes);
   if (result) {
@@ -6446,7 +6301,7 @@ TPM_RC Parse_TPMS_SIGNATURE_RSASSA(std::string* buffer,
 TPM_RC Serialize_TPMS_SIGNATURE_RSAPSS(const TPMS_SIGNATURE_RSAPSS& value,
                                        std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash, buffer);
   if (result) {
@@ -6464,7 +6319,7 @@ TPM_RC Parse_TPMS_SIGNATURE_RSAPSS(std::string* buffer,
                                    TPMS_SIGNATURE_RSAPSS* value,
                                    std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash, value_bytes);
   if (result) {
@@ -6481,7 +6336,7 @@ TPM_RC Parse_TPMS_SIGNATURE_RSAPSS(std::string* buffer,
 TPM_RC Serialize_TPMS_SIGNATURE_ECDSA(const TPMS_SIGNATURE_ECDSA& value,
                                       std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_HASH(value.hash, buffer);
   if (result) {
@@ -6504,7 +6359,7 @@ TPM_RC Parse_TPMS_SIGNATURE_ECDSA(std::string* buffer,
                                   TPMS_SIGNATURE_ECDSA* value,
                                   std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_HASH(buffer, &value->hash, value_bytes);
   if (result) {
@@ -6527,7 +6382,7 @@ TPM_RC Serialize_TPMU_SIGNATURE(const TPMU_SIGNATURE& value,
                                 TPMI_ALG_SIG_SCHEME selector,
                                 std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_HMAC) {
     result = Serialize_TPMT_HA(value.hmac, buffer);
@@ -6589,7 +6444,7 @@ TPM_RC Parse_TPMU_SIGNATURE(std::string* buffer,
                             TPMU_SIGNATURE* value,
                             std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_HMAC) {
     result = Parse_TPMT_HA(buffer, &value->hmac, value_bytes);
@@ -6649,7 +6504,7 @@ TPM_RC Parse_TPMU_SIGNATURE(std::string* buffer,
 TPM_RC Serialize_TPMT_SIGNATURE(const TPMT_SIGNATURE& value,
                                 std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_SIG_SCHEME(value.sig_alg, buffer);
   if (result) {
@@ -6667,7 +6522,7 @@ TPM_RC Parse_TPMT_SIGNATURE(std::string* buffer,
                             TPMT_SIGNATURE* value,
                             std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_SIG_SCHEME(buffer, &value->sig_alg, value_bytes);
   if (result) {
@@ -6685,7 +6540,7 @@ TPM_RC Parse_TPMT_SIGNATURE(std::string* buffer,
 TPM_RC Serialize_TPM2B_ENCRYPTED_SECRET(const TPM2B_ENCRYPTED_SECRET& value,
                                         std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -6708,7 +6563,7 @@ TPM_RC Parse_TPM2B_ENCRYPTED_SECRET(std::string* buffer,
                                     TPM2B_ENCRYPTED_SECRET* value,
                                     std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -6745,7 +6600,7 @@ std::string StringFrom_TPM2B_ENCRYPTED_SECRET(
 TPM_RC Serialize_TPMS_KEYEDHASH_PARMS(const TPMS_KEYEDHASH_PARMS& value,
                                       std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMT_KEYEDHASH_SCHEME(value.scheme, buffer);
   if (result) {
@@ -6758,7 +6613,7 @@ TPM_RC Parse_TPMS_KEYEDHASH_PARMS(std::string* buffer,
                                   TPMS_KEYEDHASH_PARMS* value,
                                   std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMT_KEYEDHASH_SCHEME(buffer, &value->scheme, value_bytes);
   if (result) {
@@ -6770,7 +6625,7 @@ TPM_RC Parse_TPMS_KEYEDHASH_PARMS(std::string* buffer,
 TPM_RC Serialize_TPMS_ASYM_PARMS(const TPMS_ASYM_PARMS& value,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMT_SYM_DEF_OBJECT(value.symmetric, buffer);
   if (result) {
@@ -6788,7 +6643,7 @@ TPM_RC Parse_TPMS_ASYM_PARMS(std::string* buffer,
                              TPMS_ASYM_PARMS* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMT_SYM_DEF_OBJECT(buffer, &value->symmetric, value_bytes);
   if (result) {
@@ -6805,7 +6660,7 @@ TPM_RC Parse_TPMS_ASYM_PARMS(std::string* buffer,
 TPM_RC Serialize_TPMS_RSA_PARMS(const TPMS_RSA_PARMS& value,
                                 std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMT_SYM_DEF_OBJECT(value.symmetric, buffer);
   if (result) {
@@ -6833,7 +6688,7 @@ TPM_RC Parse_TPMS_RSA_PARMS(std::string* buffer,
                             TPMS_RSA_PARMS* value,
                             std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMT_SYM_DEF_OBJECT(buffer, &value->symmetric, value_bytes);
   if (result) {
@@ -6860,7 +6715,7 @@ TPM_RC Parse_TPMS_RSA_PARMS(std::string* buffer,
 TPM_RC Serialize_TPMS_ECC_PARMS(const TPMS_ECC_PARMS& value,
                                 std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMT_SYM_DEF_OBJECT(value.symmetric, buffer);
   if (result) {
@@ -6888,7 +6743,7 @@ TPM_RC Parse_TPMS_ECC_PARMS(std::string* buffer,
                             TPMS_ECC_PARMS* value,
                             std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMT_SYM_DEF_OBJECT(buffer, &value->symmetric, value_bytes);
   if (result) {
@@ -6916,7 +6771,7 @@ TPM_RC Serialize_TPMU_PUBLIC_PARMS(const TPMU_PUBLIC_PARMS& value,
                                    TPMI_ALG_PUBLIC selector,
                                    std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_KEYEDHASH) {
     result = Serialize_TPMS_KEYEDHASH_PARMS(value.keyed_hash_detail, buffer);
@@ -6953,7 +6808,7 @@ TPM_RC Parse_TPMU_PUBLIC_PARMS(std::string* buffer,
                                TPMU_PUBLIC_PARMS* value,
                                std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_KEYEDHASH) {
     result = Parse_TPMS_KEYEDHASH_PARMS(buffer, &value->keyed_hash_detail,
@@ -6990,7 +6845,7 @@ TPM_RC Parse_TPMU_PUBLIC_PARMS(std::string* buffer,
 TPM_RC Serialize_TPMT_PUBLIC_PARMS(const TPMT_PUBLIC_PARMS& value,
                                    std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_PUBLIC(value.type, buffer);
   if (result) {
@@ -7008,7 +6863,7 @@ TPM_RC Parse_TPMT_PUBLIC_PARMS(std::string* buffer,
                                TPMT_PUBLIC_PARMS* value,
                                std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_PUBLIC(buffer, &value->type, value_bytes);
   if (result) {
@@ -7027,7 +6882,7 @@ TPM_RC Serialize_TPMU_PUBLIC_ID(const TPMU_PUBLIC_ID& value,
                                 TPMI_ALG_PUBLIC selector,
                                 std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_KEYEDHASH) {
     result = Serialize_TPM2B_DIGEST(value.keyed_hash, buffer);
@@ -7064,7 +6919,7 @@ TPM_RC Parse_TPMU_PUBLIC_ID(std::string* buffer,
                             TPMU_PUBLIC_ID* value,
                             std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_KEYEDHASH) {
     result = Parse_TPM2B_DIGEST(buffer, &value->keyed_hash, value_bytes);
@@ -7098,7 +6953,7 @@ TPM_RC Parse_TPMU_PUBLIC_ID(std::string* buffer,
 
 TPM_RC Serialize_TPMT_PUBLIC(const TPMT_PUBLIC& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_PUBLIC(value.type, buffer);
   if (result) {
@@ -7136,7 +6991,7 @@ TPM_RC Parse_TPMT_PUBLIC(std::string* buffer,
                          TPMT_PUBLIC* value,
                          std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_PUBLIC(buffer, &value->type, value_bytes);
   if (result) {
@@ -7174,7 +7029,7 @@ TPM_RC Parse_TPMT_PUBLIC(std::string* buffer,
 
 TPM_RC Serialize_TPM2B_PUBLIC(const TPM2B_PUBLIC& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   std::string field_bytes;
   result = Serialize_TPMT_PUBLIC(value.public_area, &field_bytes);
@@ -7194,7 +7049,7 @@ TPM_RC Parse_TPM2B_PUBLIC(std::string* buffer,
                           TPM2B_PUBLIC* value,
                           std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -7219,7 +7074,7 @@ TPM_RC Serialize_TPM2B_PRIVATE_VENDOR_SPECIFIC(
     const TPM2B_PRIVATE_VENDOR_SPECIFIC& value,
     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -7242,7 +7097,7 @@ TPM_RC Parse_TPM2B_PRIVATE_VENDOR_SPECIFIC(std::string* buffer,
                                            TPM2B_PRIVATE_VENDOR_SPECIFIC* value,
                                            std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -7281,7 +7136,7 @@ TPM_RC Serialize_TPMU_SENSITIVE_COMPOSITE(const TPMU_SENSITIVE_COMPOSITE& value,
                                           TPMI_ALG_PUBLIC selector,
                                           std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_KEYEDHASH) {
     result = Serialize_TPM2B_SENSITIVE_DATA(value.bits, buffer);
@@ -7318,7 +7173,7 @@ TPM_RC Parse_TPMU_SENSITIVE_COMPOSITE(std::string* buffer,
                                       TPMU_SENSITIVE_COMPOSITE* value,
                                       std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   if (selector == TPM_ALG_KEYEDHASH) {
     result = Parse_TPM2B_SENSITIVE_DATA(buffer, &value->bits, value_bytes);
@@ -7353,7 +7208,7 @@ TPM_RC Parse_TPMU_SENSITIVE_COMPOSITE(std::string* buffer,
 TPM_RC Serialize_TPMT_SENSITIVE(const TPMT_SENSITIVE& value,
                                 std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_ALG_PUBLIC(value.sensitive_type, buffer);
   if (result) {
@@ -7382,7 +7237,7 @@ TPM_RC Parse_TPMT_SENSITIVE(std::string* buffer,
                             TPMT_SENSITIVE* value,
                             std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_ALG_PUBLIC(buffer, &value->sensitive_type, value_bytes);
   if (result) {
@@ -7410,7 +7265,7 @@ TPM_RC Parse_TPMT_SENSITIVE(std::string* buffer,
 TPM_RC Serialize_TPM2B_SENSITIVE(const TPM2B_SENSITIVE& value,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   std::string field_bytes;
   result = Serialize_TPMT_SENSITIVE(value.sensitive_area, &field_bytes);
@@ -7430,7 +7285,7 @@ TPM_RC Parse_TPM2B_SENSITIVE(std::string* buffer,
                              TPM2B_SENSITIVE* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -7453,7 +7308,7 @@ TPM2B_SENSITIVE Make_TPM2B_SENSITIVE(const TPMT_SENSITIVE& inner) {
 
 TPM_RC Serialize__PRIVATE(const _PRIVATE& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM2B_DIGEST(value.integrity_outer, buffer);
   if (result) {
@@ -7476,7 +7331,7 @@ TPM_RC Parse__PRIVATE(std::string* buffer,
                       _PRIVATE* value,
                       std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM2B_DIGEST(buffer, &value->integrity_outer, value_bytes);
   if (result) {
@@ -7498,7 +7353,7 @@ TPM_RC Parse__PRIVATE(std::string* buffer,
 TPM_RC Serialize_TPM2B_PRIVATE(const TPM2B_PRIVATE& value,
                                std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -7521,7 +7376,7 @@ TPM_RC Parse_TPM2B_PRIVATE(std::string* buffer,
                            TPM2B_PRIVATE* value,
                            std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -7556,7 +7411,7 @@ std::string StringFrom_TPM2B_PRIVATE(const TPM2B_PRIVATE& tpm2b) {
 
 TPM_RC Serialize__ID_OBJECT(const _ID_OBJECT& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM2B_DIGEST(value.integrity_hmac, buffer);
   if (result) {
@@ -7574,7 +7429,7 @@ TPM_RC Parse__ID_OBJECT(std::string* buffer,
                         _ID_OBJECT* value,
                         std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM2B_DIGEST(buffer, &value->integrity_hmac, value_bytes);
   if (result) {
@@ -7591,7 +7446,7 @@ TPM_RC Parse__ID_OBJECT(std::string* buffer,
 TPM_RC Serialize_TPM2B_ID_OBJECT(const TPM2B_ID_OBJECT& value,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -7614,7 +7469,7 @@ TPM_RC Parse_TPM2B_ID_OBJECT(std::string* buffer,
                              TPM2B_ID_OBJECT* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -7650,7 +7505,7 @@ std::string StringFrom_TPM2B_ID_OBJECT(const TPM2B_ID_OBJECT& tpm2b) {
 TPM_RC Serialize_TPMS_NV_PUBLIC(const TPMS_NV_PUBLIC& value,
                                 std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPMI_RH_NV_INDEX(value.nv_index, buffer);
   if (result) {
@@ -7683,7 +7538,7 @@ TPM_RC Parse_TPMS_NV_PUBLIC(std::string* buffer,
                             TPMS_NV_PUBLIC* value,
                             std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPMI_RH_NV_INDEX(buffer, &value->nv_index, value_bytes);
   if (result) {
@@ -7715,7 +7570,7 @@ TPM_RC Parse_TPMS_NV_PUBLIC(std::string* buffer,
 TPM_RC Serialize_TPM2B_NV_PUBLIC(const TPM2B_NV_PUBLIC& value,
                                  std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   std::string field_bytes;
   result = Serialize_TPMS_NV_PUBLIC(value.nv_public, &field_bytes);
@@ -7735,7 +7590,7 @@ TPM_RC Parse_TPM2B_NV_PUBLIC(std::string* buffer,
                              TPM2B_NV_PUBLIC* value,
                              std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -7759,7 +7614,7 @@ TPM2B_NV_PUBLIC Make_TPM2B_NV_PUBLIC(const TPMS_NV_PUBLIC& inner) {
 TPM_RC Serialize_TPM2B_CONTEXT_SENSITIVE(const TPM2B_CONTEXT_SENSITIVE& value,
                                          std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -7782,7 +7637,7 @@ TPM_RC Parse_TPM2B_CONTEXT_SENSITIVE(std::string* buffer,
                                      TPM2B_CONTEXT_SENSITIVE* value,
                                      std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -7819,7 +7674,7 @@ std::string StringFrom_TPM2B_CONTEXT_SENSITIVE(
 TPM_RC Serialize_TPMS_CONTEXT_DATA(const TPMS_CONTEXT_DATA& value,
                                    std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPM2B_DIGEST(value.integrity, buffer);
   if (result) {
@@ -7837,7 +7692,7 @@ TPM_RC Parse_TPMS_CONTEXT_DATA(std::string* buffer,
                                TPMS_CONTEXT_DATA* value,
                                std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPM2B_DIGEST(buffer, &value->integrity, value_bytes);
   if (result) {
@@ -7855,7 +7710,7 @@ TPM_RC Parse_TPMS_CONTEXT_DATA(std::string* buffer,
 TPM_RC Serialize_TPM2B_CONTEXT_DATA(const TPM2B_CONTEXT_DATA& value,
                                     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT16(value.size, buffer);
   if (result) {
@@ -7878,7 +7733,7 @@ TPM_RC Parse_TPM2B_CONTEXT_DATA(std::string* buffer,
                                 TPM2B_CONTEXT_DATA* value,
                                 std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -7913,7 +7768,7 @@ std::string StringFrom_TPM2B_CONTEXT_DATA(const TPM2B_CONTEXT_DATA& tpm2b) {
 
 TPM_RC Serialize_TPMS_CONTEXT(const TPMS_CONTEXT& value, std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_UINT64(value.sequence, buffer);
   if (result) {
@@ -7941,7 +7796,7 @@ TPM_RC Parse_TPMS_CONTEXT(std::string* buffer,
                           TPMS_CONTEXT* value,
                           std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT64(buffer, &value->sequence, value_bytes);
   if (result) {
@@ -7968,7 +7823,7 @@ TPM_RC Parse_TPMS_CONTEXT(std::string* buffer,
 TPM_RC Serialize_TPMS_CREATION_DATA(const TPMS_CREATION_DATA& value,
                                     std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Serialize_TPML_PCR_SELECTION(value.pcr_select, buffer);
   if (result) {
@@ -8011,7 +7866,7 @@ TPM_RC Parse_TPMS_CREATION_DATA(std::string* buffer,
                                 TPMS_CREATION_DATA* value,
                                 std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_TPML_PCR_SELECTION(buffer, &value->pcr_select, value_bytes);
   if (result) {
@@ -8053,7 +7908,7 @@ TPM_RC Parse_TPMS_CREATION_DATA(std::string* buffer,
 TPM_RC Serialize_TPM2B_CREATION_DATA(const TPM2B_CREATION_DATA& value,
                                      std::string* buffer) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   std::string field_bytes;
   result = Serialize_TPMS_CREATION_DATA(value.creation_data, &field_bytes);
@@ -8073,7 +7928,7 @@ TPM_RC Parse_TPM2B_CREATION_DATA(std::string* buffer,
                                  TPM2B_CREATION_DATA* value,
                                  std::string* value_bytes) {
   TPM_RC result = TPM_RC_SUCCESS;
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
 
   result = Parse_UINT16(buffer, &value->size, value_bytes);
   if (result) {
@@ -8098,7 +7953,8 @@ TPM_RC Tpm::SerializeCommand_Startup(
     const TPM_SU& startup_type,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Startup);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -8160,16 +8016,16 @@ TPM_RC Tpm::SerializeCommand_Startup(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_Startup(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Startup);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -8190,6 +8046,7 @@ TPM_RC Tpm::ParseResponse_Startup(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -8289,7 +8146,8 @@ TPM_RC Tpm::SerializeCommand_Shutdown(
     const TPM_SU& shutdown_type,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Shutdown);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -8351,16 +8209,16 @@ TPM_RC Tpm::SerializeCommand_Shutdown(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_Shutdown(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Shutdown);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -8381,6 +8239,7 @@ TPM_RC Tpm::ParseResponse_Shutdown(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -8480,7 +8339,8 @@ TPM_RC Tpm::SerializeCommand_SelfTest(
     const TPMI_YES_NO& full_test,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_SelfTest);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -8542,16 +8402,16 @@ TPM_RC Tpm::SerializeCommand_SelfTest(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_SelfTest(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_SelfTest);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -8572,6 +8432,7 @@ TPM_RC Tpm::ParseResponse_SelfTest(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -8671,7 +8532,9 @@ TPM_RC Tpm::SerializeCommand_IncrementalSelfTest(
     const TPML_ALG& to_test,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_IncrementalSelfTest);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -8733,8 +8596,7 @@ TPM_RC Tpm::SerializeCommand_IncrementalSelfTest(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -8742,8 +8604,10 @@ TPM_RC Tpm::ParseResponse_IncrementalSelfTest(
     const std::string& response,
     TPML_ALG* to_do_list,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_IncrementalSelfTest);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -8764,6 +8628,7 @@ TPM_RC Tpm::ParseResponse_IncrementalSelfTest(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -8874,7 +8739,8 @@ TPM_RC Tpm::IncrementalSelfTestSync(
 TPM_RC Tpm::SerializeCommand_GetTestResult(
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_GetTestResult);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -8928,8 +8794,7 @@ TPM_RC Tpm::SerializeCommand_GetTestResult(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -8938,8 +8803,9 @@ TPM_RC Tpm::ParseResponse_GetTestResult(
     TPM2B_MAX_BUFFER* out_data,
     TPM_RC* test_result,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_GetTestResult);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -8960,6 +8826,7 @@ TPM_RC Tpm::ParseResponse_GetTestResult(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -9092,7 +8959,9 @@ TPM_RC Tpm::SerializeCommand_StartAuthSession(
     const TPMI_ALG_HASH& auth_hash,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_StartAuthSession);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -9210,8 +9079,7 @@ TPM_RC Tpm::SerializeCommand_StartAuthSession(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -9220,8 +9088,9 @@ TPM_RC Tpm::ParseResponse_StartAuthSession(
     TPMI_SH_AUTH_SESSION* session_handle,
     TPM2B_NONCE* nonce_tpm,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_StartAuthSession);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -9242,6 +9111,7 @@ TPM_RC Tpm::ParseResponse_StartAuthSession(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -9393,7 +9263,8 @@ TPM_RC Tpm::SerializeCommand_PolicyRestart(
     const std::string& session_handle_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PolicyRestart);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -9455,16 +9326,16 @@ TPM_RC Tpm::SerializeCommand_PolicyRestart(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyRestart(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyRestart);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -9485,6 +9356,7 @@ TPM_RC Tpm::ParseResponse_PolicyRestart(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -9592,7 +9464,8 @@ TPM_RC Tpm::SerializeCommand_Create(
     const TPML_PCR_SELECTION& creation_pcr,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Create);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -9694,8 +9567,7 @@ TPM_RC Tpm::SerializeCommand_Create(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -9707,8 +9579,9 @@ TPM_RC Tpm::ParseResponse_Create(
     TPM2B_DIGEST* creation_hash,
     TPMT_TK_CREATION* creation_ticket,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Create);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -9729,6 +9602,7 @@ TPM_RC Tpm::ParseResponse_Create(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -9897,7 +9771,8 @@ TPM_RC Tpm::SerializeCommand_Load(
     const TPM2B_PUBLIC& in_public,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Load);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -9983,8 +9858,7 @@ TPM_RC Tpm::SerializeCommand_Load(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -9992,8 +9866,9 @@ TPM_RC Tpm::ParseResponse_Load(const std::string& response,
                                TPM_HANDLE* object_handle,
                                TPM2B_NAME* name,
                                AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Load);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -10014,6 +9889,7 @@ TPM_RC Tpm::ParseResponse_Load(const std::string& response,
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -10152,7 +10028,8 @@ TPM_RC Tpm::SerializeCommand_LoadExternal(
     const TPMI_RH_HIERARCHY& hierarchy,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_LoadExternal);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -10238,8 +10115,7 @@ TPM_RC Tpm::SerializeCommand_LoadExternal(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -10248,8 +10124,9 @@ TPM_RC Tpm::ParseResponse_LoadExternal(
     TPM_HANDLE* object_handle,
     TPM2B_NAME* name,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_LoadExternal);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -10270,6 +10147,7 @@ TPM_RC Tpm::ParseResponse_LoadExternal(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -10403,7 +10281,8 @@ TPM_RC Tpm::SerializeCommand_ReadPublic(
     const std::string& object_handle_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_ReadPublic);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -10465,8 +10344,7 @@ TPM_RC Tpm::SerializeCommand_ReadPublic(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -10476,8 +10354,9 @@ TPM_RC Tpm::ParseResponse_ReadPublic(
     TPM2B_NAME* name,
     TPM2B_NAME* qualified_name,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ReadPublic);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -10498,6 +10377,7 @@ TPM_RC Tpm::ParseResponse_ReadPublic(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -10640,7 +10520,9 @@ TPM_RC Tpm::SerializeCommand_ActivateCredential(
     const TPM2B_ENCRYPTED_SECRET& secret,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_ActivateCredential);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -10734,8 +10616,7 @@ TPM_RC Tpm::SerializeCommand_ActivateCredential(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -10743,8 +10624,10 @@ TPM_RC Tpm::ParseResponse_ActivateCredential(
     const std::string& response,
     TPM2B_DIGEST* cert_info,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_ActivateCredential);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -10765,6 +10648,7 @@ TPM_RC Tpm::ParseResponse_ActivateCredential(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -10904,7 +10788,8 @@ TPM_RC Tpm::SerializeCommand_MakeCredential(
     const TPM2B_NAME& object_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_MakeCredential);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -10990,8 +10875,7 @@ TPM_RC Tpm::SerializeCommand_MakeCredential(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -11000,8 +10884,9 @@ TPM_RC Tpm::ParseResponse_MakeCredential(
     TPM2B_ID_OBJECT* credential_blob,
     TPM2B_ENCRYPTED_SECRET* secret,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_MakeCredential);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -11022,6 +10907,7 @@ TPM_RC Tpm::ParseResponse_MakeCredential(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -11160,7 +11046,8 @@ TPM_RC Tpm::SerializeCommand_Unseal(
     const std::string& item_handle_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Unseal);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -11222,8 +11109,7 @@ TPM_RC Tpm::SerializeCommand_Unseal(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -11231,8 +11117,9 @@ TPM_RC Tpm::ParseResponse_Unseal(
     const std::string& response,
     TPM2B_SENSITIVE_DATA* out_data,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Unseal);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -11253,6 +11140,7 @@ TPM_RC Tpm::ParseResponse_Unseal(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -11379,7 +11267,9 @@ TPM_RC Tpm::SerializeCommand_ObjectChangeAuth(
     const TPM2B_AUTH& new_auth,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_ObjectChangeAuth);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -11465,8 +11355,7 @@ TPM_RC Tpm::SerializeCommand_ObjectChangeAuth(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -11474,8 +11363,9 @@ TPM_RC Tpm::ParseResponse_ObjectChangeAuth(
     const std::string& response,
     TPM2B_PRIVATE* out_private,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ObjectChangeAuth);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -11496,6 +11386,7 @@ TPM_RC Tpm::ParseResponse_ObjectChangeAuth(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -11635,7 +11526,8 @@ TPM_RC Tpm::SerializeCommand_Duplicate(
     const TPMT_SYM_DEF_OBJECT& symmetric_alg,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Duplicate);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -11729,8 +11621,7 @@ TPM_RC Tpm::SerializeCommand_Duplicate(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -11740,8 +11631,9 @@ TPM_RC Tpm::ParseResponse_Duplicate(
     TPM2B_PRIVATE* duplicate,
     TPM2B_ENCRYPTED_SECRET* out_sym_seed,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Duplicate);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -11762,6 +11654,7 @@ TPM_RC Tpm::ParseResponse_Duplicate(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -11920,7 +11813,8 @@ TPM_RC Tpm::SerializeCommand_Rewrap(
     const TPM2B_ENCRYPTED_SECRET& in_sym_seed,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Rewrap);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -12022,8 +11916,7 @@ TPM_RC Tpm::SerializeCommand_Rewrap(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -12032,8 +11925,9 @@ TPM_RC Tpm::ParseResponse_Rewrap(
     TPM2B_PRIVATE* out_duplicate,
     TPM2B_ENCRYPTED_SECRET* out_sym_seed,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Rewrap);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -12054,6 +11948,7 @@ TPM_RC Tpm::ParseResponse_Rewrap(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -12202,7 +12097,8 @@ TPM_RC Tpm::SerializeCommand_Import(
     const TPMT_SYM_DEF_OBJECT& symmetric_alg,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Import);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -12312,8 +12208,7 @@ TPM_RC Tpm::SerializeCommand_Import(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -12321,8 +12216,9 @@ TPM_RC Tpm::ParseResponse_Import(
     const std::string& response,
     TPM2B_PRIVATE* out_private,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Import);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -12343,6 +12239,7 @@ TPM_RC Tpm::ParseResponse_Import(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -12481,7 +12378,8 @@ TPM_RC Tpm::SerializeCommand_RSA_Encrypt(
     const TPM2B_DATA& label,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_RSA_Encrypt);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -12575,8 +12473,7 @@ TPM_RC Tpm::SerializeCommand_RSA_Encrypt(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -12584,8 +12481,9 @@ TPM_RC Tpm::ParseResponse_RSA_Encrypt(
     const std::string& response,
     TPM2B_PUBLIC_KEY_RSA* out_data,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_RSA_Encrypt);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -12606,6 +12504,7 @@ TPM_RC Tpm::ParseResponse_RSA_Encrypt(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -12740,7 +12639,8 @@ TPM_RC Tpm::SerializeCommand_RSA_Decrypt(
     const TPM2B_DATA& label,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_RSA_Decrypt);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -12834,8 +12734,7 @@ TPM_RC Tpm::SerializeCommand_RSA_Decrypt(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -12843,8 +12742,9 @@ TPM_RC Tpm::ParseResponse_RSA_Decrypt(
     const std::string& response,
     TPM2B_PUBLIC_KEY_RSA* message,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_RSA_Decrypt);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -12865,6 +12765,7 @@ TPM_RC Tpm::ParseResponse_RSA_Decrypt(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -12996,7 +12897,8 @@ TPM_RC Tpm::SerializeCommand_ECDH_KeyGen(
     const std::string& key_handle_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_ECDH_KeyGen);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -13058,8 +12960,7 @@ TPM_RC Tpm::SerializeCommand_ECDH_KeyGen(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -13068,8 +12969,9 @@ TPM_RC Tpm::ParseResponse_ECDH_KeyGen(
     TPM2B_ECC_POINT* z_point,
     TPM2B_ECC_POINT* pub_point,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ECDH_KeyGen);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -13090,6 +12992,7 @@ TPM_RC Tpm::ParseResponse_ECDH_KeyGen(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -13222,7 +13125,8 @@ TPM_RC Tpm::SerializeCommand_ECDH_ZGen(
     const TPM2B_ECC_POINT& in_point,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_ECDH_ZGen);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -13300,8 +13204,7 @@ TPM_RC Tpm::SerializeCommand_ECDH_ZGen(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -13309,8 +13212,9 @@ TPM_RC Tpm::ParseResponse_ECDH_ZGen(
     const std::string& response,
     TPM2B_ECC_POINT* out_point,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ECDH_ZGen);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -13331,6 +13235,7 @@ TPM_RC Tpm::ParseResponse_ECDH_ZGen(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -13455,7 +13360,8 @@ TPM_RC Tpm::SerializeCommand_ECC_Parameters(
     const TPMI_ECC_CURVE& curve_id,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_ECC_Parameters);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -13517,8 +13423,7 @@ TPM_RC Tpm::SerializeCommand_ECC_Parameters(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -13526,8 +13431,9 @@ TPM_RC Tpm::ParseResponse_ECC_Parameters(
     const std::string& response,
     TPMS_ALGORITHM_DETAIL_ECC* parameters,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ECC_Parameters);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -13548,6 +13454,7 @@ TPM_RC Tpm::ParseResponse_ECC_Parameters(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -13661,7 +13568,8 @@ TPM_RC Tpm::SerializeCommand_ZGen_2Phase(
     const UINT16& counter,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_ZGen_2Phase);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -13763,8 +13671,7 @@ TPM_RC Tpm::SerializeCommand_ZGen_2Phase(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -13773,8 +13680,9 @@ TPM_RC Tpm::ParseResponse_ZGen_2Phase(
     TPM2B_ECC_POINT* out_z1,
     TPM2B_ECC_POINT* out_z2,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ZGen_2Phase);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -13795,6 +13703,7 @@ TPM_RC Tpm::ParseResponse_ZGen_2Phase(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -13940,7 +13849,8 @@ TPM_RC Tpm::SerializeCommand_EncryptDecrypt(
     const TPM2B_MAX_BUFFER& in_data,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_EncryptDecrypt);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -14034,8 +13944,7 @@ TPM_RC Tpm::SerializeCommand_EncryptDecrypt(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -14044,8 +13953,9 @@ TPM_RC Tpm::ParseResponse_EncryptDecrypt(
     TPM2B_MAX_BUFFER* out_data,
     TPM2B_IV* iv_out,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_EncryptDecrypt);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -14066,6 +13976,7 @@ TPM_RC Tpm::ParseResponse_EncryptDecrypt(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -14208,7 +14119,8 @@ TPM_RC Tpm::SerializeCommand_Hash(
     const TPMI_RH_HIERARCHY& hierarchy,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Hash);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -14294,8 +14206,7 @@ TPM_RC Tpm::SerializeCommand_Hash(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -14303,8 +14214,9 @@ TPM_RC Tpm::ParseResponse_Hash(const std::string& response,
                                TPM2B_DIGEST* out_hash,
                                TPMT_TK_HASHCHECK* validation,
                                AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Hash);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -14325,6 +14237,7 @@ TPM_RC Tpm::ParseResponse_Hash(const std::string& response,
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -14460,7 +14373,8 @@ TPM_RC Tpm::SerializeCommand_HMAC(
     const TPMI_ALG_HASH& hash_alg,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_HMAC);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -14546,16 +14460,16 @@ TPM_RC Tpm::SerializeCommand_HMAC(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_HMAC(const std::string& response,
                                TPM2B_DIGEST* out_hmac,
                                AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_HMAC);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -14576,6 +14490,7 @@ TPM_RC Tpm::ParseResponse_HMAC(const std::string& response,
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -14702,7 +14617,8 @@ TPM_RC Tpm::SerializeCommand_GetRandom(
     const UINT16& bytes_requested,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_GetRandom);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -14764,8 +14680,7 @@ TPM_RC Tpm::SerializeCommand_GetRandom(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -14773,8 +14688,9 @@ TPM_RC Tpm::ParseResponse_GetRandom(
     const std::string& response,
     TPM2B_DIGEST* random_bytes,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_GetRandom);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -14795,6 +14711,7 @@ TPM_RC Tpm::ParseResponse_GetRandom(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -14915,7 +14832,8 @@ TPM_RC Tpm::SerializeCommand_StirRandom(
     const TPM2B_SENSITIVE_DATA& in_data,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_StirRandom);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -14985,16 +14903,16 @@ TPM_RC Tpm::SerializeCommand_StirRandom(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_StirRandom(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_StirRandom);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -15015,6 +14933,7 @@ TPM_RC Tpm::ParseResponse_StirRandom(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -15117,7 +15036,8 @@ TPM_RC Tpm::SerializeCommand_HMAC_Start(
     const TPMI_ALG_HASH& hash_alg,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_HMAC_Start);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -15203,8 +15123,7 @@ TPM_RC Tpm::SerializeCommand_HMAC_Start(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -15212,8 +15131,9 @@ TPM_RC Tpm::ParseResponse_HMAC_Start(
     const std::string& response,
     TPMI_DH_OBJECT* sequence_handle,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_HMAC_Start);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -15234,6 +15154,7 @@ TPM_RC Tpm::ParseResponse_HMAC_Start(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -15349,7 +15270,9 @@ TPM_RC Tpm::SerializeCommand_HashSequenceStart(
     const TPMI_ALG_HASH& hash_alg,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_HashSequenceStart);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -15427,8 +15350,7 @@ TPM_RC Tpm::SerializeCommand_HashSequenceStart(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -15436,8 +15358,9 @@ TPM_RC Tpm::ParseResponse_HashSequenceStart(
     const std::string& response,
     TPMI_DH_OBJECT* sequence_handle,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_HashSequenceStart);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -15458,6 +15381,7 @@ TPM_RC Tpm::ParseResponse_HashSequenceStart(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -15573,7 +15497,8 @@ TPM_RC Tpm::SerializeCommand_SequenceUpdate(
     const TPM2B_MAX_BUFFER& buffer,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_SequenceUpdate);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -15651,16 +15576,16 @@ TPM_RC Tpm::SerializeCommand_SequenceUpdate(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_SequenceUpdate(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_SequenceUpdate);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -15681,6 +15606,7 @@ TPM_RC Tpm::ParseResponse_SequenceUpdate(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -15790,7 +15716,9 @@ TPM_RC Tpm::SerializeCommand_SequenceComplete(
     const TPMI_RH_HIERARCHY& hierarchy,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_SequenceComplete);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -15876,8 +15804,7 @@ TPM_RC Tpm::SerializeCommand_SequenceComplete(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -15886,8 +15813,9 @@ TPM_RC Tpm::ParseResponse_SequenceComplete(
     TPM2B_DIGEST* result,
     TPMT_TK_HASHCHECK* validation,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_SequenceComplete);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -15908,6 +15836,7 @@ TPM_RC Tpm::ParseResponse_SequenceComplete(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -16051,7 +15980,9 @@ TPM_RC Tpm::SerializeCommand_EventSequenceComplete(
     const TPM2B_MAX_BUFFER& buffer,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_EventSequenceComplete);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -16137,8 +16068,7 @@ TPM_RC Tpm::SerializeCommand_EventSequenceComplete(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -16146,8 +16076,10 @@ TPM_RC Tpm::ParseResponse_EventSequenceComplete(
     const std::string& response,
     TPML_DIGEST_VALUES* results,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_EventSequenceComplete);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -16168,6 +16100,7 @@ TPM_RC Tpm::ParseResponse_EventSequenceComplete(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -16294,7 +16227,8 @@ TPM_RC Tpm::SerializeCommand_Certify(
     const TPMT_SIG_SCHEME& in_scheme,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Certify);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -16388,8 +16322,7 @@ TPM_RC Tpm::SerializeCommand_Certify(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -16398,8 +16331,9 @@ TPM_RC Tpm::ParseResponse_Certify(
     TPM2B_ATTEST* certify_info,
     TPMT_SIGNATURE* signature,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Certify);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -16420,6 +16354,7 @@ TPM_RC Tpm::ParseResponse_Certify(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -16567,7 +16502,9 @@ TPM_RC Tpm::SerializeCommand_CertifyCreation(
     const TPMT_TK_CREATION& creation_ticket,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_CertifyCreation);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -16677,8 +16614,7 @@ TPM_RC Tpm::SerializeCommand_CertifyCreation(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -16687,8 +16623,9 @@ TPM_RC Tpm::ParseResponse_CertifyCreation(
     TPM2B_ATTEST* certify_info,
     TPMT_SIGNATURE* signature,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_CertifyCreation);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -16709,6 +16646,7 @@ TPM_RC Tpm::ParseResponse_CertifyCreation(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -16860,7 +16798,8 @@ TPM_RC Tpm::SerializeCommand_Quote(
     const TPML_PCR_SELECTION& pcrselect,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Quote);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -16954,8 +16893,7 @@ TPM_RC Tpm::SerializeCommand_Quote(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -16963,8 +16901,9 @@ TPM_RC Tpm::ParseResponse_Quote(const std::string& response,
                                 TPM2B_ATTEST* quoted,
                                 TPMT_SIGNATURE* signature,
                                 AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Quote);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -16985,6 +16924,7 @@ TPM_RC Tpm::ParseResponse_Quote(const std::string& response,
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -17129,7 +17069,9 @@ TPM_RC Tpm::SerializeCommand_GetSessionAuditDigest(
     const TPMT_SIG_SCHEME& in_scheme,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_GetSessionAuditDigest);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -17233,8 +17175,7 @@ TPM_RC Tpm::SerializeCommand_GetSessionAuditDigest(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -17243,8 +17184,10 @@ TPM_RC Tpm::ParseResponse_GetSessionAuditDigest(
     TPM2B_ATTEST* audit_info,
     TPMT_SIGNATURE* signature,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_GetSessionAuditDigest);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -17265,6 +17208,7 @@ TPM_RC Tpm::ParseResponse_GetSessionAuditDigest(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -17419,7 +17363,9 @@ TPM_RC Tpm::SerializeCommand_GetCommandAuditDigest(
     const TPMT_SIG_SCHEME& in_scheme,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_GetCommandAuditDigest);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -17513,8 +17459,7 @@ TPM_RC Tpm::SerializeCommand_GetCommandAuditDigest(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -17523,8 +17468,10 @@ TPM_RC Tpm::ParseResponse_GetCommandAuditDigest(
     TPM2B_ATTEST* audit_info,
     TPMT_SIGNATURE* signature,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_GetCommandAuditDigest);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -17545,6 +17492,7 @@ TPM_RC Tpm::ParseResponse_GetCommandAuditDigest(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -17693,7 +17641,8 @@ TPM_RC Tpm::SerializeCommand_GetTime(
     const TPMT_SIG_SCHEME& in_scheme,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_GetTime);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -17789,8 +17738,7 @@ TPM_RC Tpm::SerializeCommand_GetTime(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -17799,8 +17747,9 @@ TPM_RC Tpm::ParseResponse_GetTime(
     TPM2B_ATTEST* time_info,
     TPMT_SIGNATURE* signature,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_GetTime);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -17821,6 +17770,7 @@ TPM_RC Tpm::ParseResponse_GetTime(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -17968,7 +17918,8 @@ TPM_RC Tpm::SerializeCommand_Commit(
     const TPM2B_ECC_PARAMETER& y2,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Commit);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -18062,8 +18013,7 @@ TPM_RC Tpm::SerializeCommand_Commit(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -18075,8 +18025,9 @@ TPM_RC Tpm::ParseResponse_Commit(
     TPM2B_ECC_POINT* e,
     UINT16* counter,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Commit);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -18097,6 +18048,7 @@ TPM_RC Tpm::ParseResponse_Commit(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -18247,7 +18199,8 @@ TPM_RC Tpm::SerializeCommand_EC_Ephemeral(
     const TPMI_ECC_CURVE& curve_id,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_EC_Ephemeral);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -18317,8 +18270,7 @@ TPM_RC Tpm::SerializeCommand_EC_Ephemeral(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -18328,8 +18280,9 @@ TPM_RC Tpm::ParseResponse_EC_Ephemeral(
     TPM2B_ECC_POINT* q,
     UINT16* counter,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_EC_Ephemeral);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -18350,6 +18303,7 @@ TPM_RC Tpm::ParseResponse_EC_Ephemeral(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -18477,7 +18431,9 @@ TPM_RC Tpm::SerializeCommand_VerifySignature(
     const TPMT_SIGNATURE& signature,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_VerifySignature);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -18563,8 +18519,7 @@ TPM_RC Tpm::SerializeCommand_VerifySignature(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -18572,8 +18527,9 @@ TPM_RC Tpm::ParseResponse_VerifySignature(
     const std::string& response,
     TPMT_TK_VERIFIED* validation,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_VerifySignature);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -18594,6 +18550,7 @@ TPM_RC Tpm::ParseResponse_VerifySignature(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -18715,7 +18672,8 @@ TPM_RC Tpm::SerializeCommand_Sign(
     const TPMT_TK_HASHCHECK& validation,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Sign);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -18809,16 +18767,16 @@ TPM_RC Tpm::SerializeCommand_Sign(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_Sign(const std::string& response,
                                TPMT_SIGNATURE* signature,
                                AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Sign);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -18839,6 +18797,7 @@ TPM_RC Tpm::ParseResponse_Sign(const std::string& response,
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -18960,7 +18919,9 @@ TPM_RC Tpm::SerializeCommand_SetCommandCodeAuditStatus(
     const TPML_CC& clear_list,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_SetCommandCodeAuditStatus);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -19046,16 +19007,17 @@ TPM_RC Tpm::SerializeCommand_SetCommandCodeAuditStatus(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_SetCommandCodeAuditStatus(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_SetCommandCodeAuditStatus);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -19076,6 +19038,7 @@ TPM_RC Tpm::ParseResponse_SetCommandCodeAuditStatus(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -19194,7 +19157,8 @@ TPM_RC Tpm::SerializeCommand_PCR_Extend(
     const TPML_DIGEST_VALUES& digests,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PCR_Extend);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -19264,16 +19228,16 @@ TPM_RC Tpm::SerializeCommand_PCR_Extend(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PCR_Extend(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PCR_Extend);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -19294,6 +19258,7 @@ TPM_RC Tpm::ParseResponse_PCR_Extend(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -19399,7 +19364,8 @@ TPM_RC Tpm::SerializeCommand_PCR_Event(
     const TPM2B_EVENT& event_data,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PCR_Event);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -19477,8 +19443,7 @@ TPM_RC Tpm::SerializeCommand_PCR_Event(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -19486,8 +19451,9 @@ TPM_RC Tpm::ParseResponse_PCR_Event(
     const std::string& response,
     TPML_DIGEST_VALUES* digests,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PCR_Event);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -19508,6 +19474,7 @@ TPM_RC Tpm::ParseResponse_PCR_Event(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -19621,7 +19588,8 @@ TPM_RC Tpm::SerializeCommand_PCR_Read(
     const TPML_PCR_SELECTION& pcr_selection_in,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PCR_Read);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -19683,8 +19651,7 @@ TPM_RC Tpm::SerializeCommand_PCR_Read(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -19694,8 +19661,9 @@ TPM_RC Tpm::ParseResponse_PCR_Read(
     TPML_PCR_SELECTION* pcr_selection_out,
     TPML_DIGEST* pcr_values,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PCR_Read);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -19716,6 +19684,7 @@ TPM_RC Tpm::ParseResponse_PCR_Read(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -19842,7 +19811,8 @@ TPM_RC Tpm::SerializeCommand_PCR_Allocate(
     const TPML_PCR_SELECTION& pcr_allocation,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PCR_Allocate);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -19912,8 +19882,7 @@ TPM_RC Tpm::SerializeCommand_PCR_Allocate(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -19924,8 +19893,9 @@ TPM_RC Tpm::ParseResponse_PCR_Allocate(
     UINT32* size_needed,
     UINT32* size_available,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PCR_Allocate);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -19946,6 +19916,7 @@ TPM_RC Tpm::ParseResponse_PCR_Allocate(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -20089,7 +20060,9 @@ TPM_RC Tpm::SerializeCommand_PCR_SetAuthPolicy(
     const TPMI_ALG_HASH& policy_digest,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_PCR_SetAuthPolicy);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -20183,16 +20156,16 @@ TPM_RC Tpm::SerializeCommand_PCR_SetAuthPolicy(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PCR_SetAuthPolicy(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PCR_SetAuthPolicy);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -20213,6 +20186,7 @@ TPM_RC Tpm::ParseResponse_PCR_SetAuthPolicy(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -20330,7 +20304,9 @@ TPM_RC Tpm::SerializeCommand_PCR_SetAuthValue(
     const TPM2B_DIGEST& auth,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_PCR_SetAuthValue);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -20408,16 +20384,16 @@ TPM_RC Tpm::SerializeCommand_PCR_SetAuthValue(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PCR_SetAuthValue(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PCR_SetAuthValue);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -20438,6 +20414,7 @@ TPM_RC Tpm::ParseResponse_PCR_SetAuthValue(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -20546,7 +20523,8 @@ TPM_RC Tpm::SerializeCommand_PCR_Reset(
     const std::string& pcr_handle_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PCR_Reset);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -20608,16 +20586,16 @@ TPM_RC Tpm::SerializeCommand_PCR_Reset(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PCR_Reset(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PCR_Reset);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -20638,6 +20616,7 @@ TPM_RC Tpm::ParseResponse_PCR_Reset(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -20747,7 +20726,8 @@ TPM_RC Tpm::SerializeCommand_PolicySigned(
     const TPMT_SIGNATURE& auth,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PolicySigned);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -20865,8 +20845,7 @@ TPM_RC Tpm::SerializeCommand_PolicySigned(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -20875,8 +20854,9 @@ TPM_RC Tpm::ParseResponse_PolicySigned(
     TPM2B_TIMEOUT* timeout,
     TPMT_TK_AUTH* policy_ticket,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicySigned);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -20897,6 +20877,7 @@ TPM_RC Tpm::ParseResponse_PolicySigned(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -21052,7 +21033,8 @@ TPM_RC Tpm::SerializeCommand_PolicySecret(
     const INT32& expiration,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PolicySecret);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -21162,8 +21144,7 @@ TPM_RC Tpm::SerializeCommand_PolicySecret(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -21172,8 +21153,9 @@ TPM_RC Tpm::ParseResponse_PolicySecret(
     TPM2B_TIMEOUT* timeout,
     TPMT_TK_AUTH* policy_ticket,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicySecret);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -21194,6 +21176,7 @@ TPM_RC Tpm::ParseResponse_PolicySecret(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -21346,7 +21329,8 @@ TPM_RC Tpm::SerializeCommand_PolicyTicket(
     const TPMT_TK_AUTH& ticket,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PolicyTicket);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -21456,16 +21440,16 @@ TPM_RC Tpm::SerializeCommand_PolicyTicket(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyTicket(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyTicket);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -21486,6 +21470,7 @@ TPM_RC Tpm::ParseResponse_PolicyTicket(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -21601,7 +21586,8 @@ TPM_RC Tpm::SerializeCommand_PolicyOR(
     const TPML_DIGEST& p_hash_list,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PolicyOR);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -21671,16 +21657,16 @@ TPM_RC Tpm::SerializeCommand_PolicyOR(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyOR(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyOR);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -21701,6 +21687,7 @@ TPM_RC Tpm::ParseResponse_PolicyOR(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -21809,7 +21796,8 @@ TPM_RC Tpm::SerializeCommand_PolicyPCR(
     const TPML_PCR_SELECTION& pcrs,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PolicyPCR);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -21895,16 +21883,16 @@ TPM_RC Tpm::SerializeCommand_PolicyPCR(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyPCR(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyPCR);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -21925,6 +21913,7 @@ TPM_RC Tpm::ParseResponse_PolicyPCR(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -22034,7 +22023,8 @@ TPM_RC Tpm::SerializeCommand_PolicyLocality(
     const TPMA_LOCALITY& locality,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PolicyLocality);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -22104,16 +22094,16 @@ TPM_RC Tpm::SerializeCommand_PolicyLocality(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyLocality(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyLocality);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -22134,6 +22124,7 @@ TPM_RC Tpm::ParseResponse_PolicyLocality(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -22248,7 +22239,8 @@ TPM_RC Tpm::SerializeCommand_PolicyNV(
     const TPM_EO& operation,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PolicyNV);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -22358,16 +22350,16 @@ TPM_RC Tpm::SerializeCommand_PolicyNV(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyNV(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyNV);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -22388,6 +22380,7 @@ TPM_RC Tpm::ParseResponse_PolicyNV(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -22511,7 +22504,9 @@ TPM_RC Tpm::SerializeCommand_PolicyCounterTimer(
     const TPM_EO& operation,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_PolicyCounterTimer);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -22605,16 +22600,17 @@ TPM_RC Tpm::SerializeCommand_PolicyCounterTimer(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyCounterTimer(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_PolicyCounterTimer);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -22635,6 +22631,7 @@ TPM_RC Tpm::ParseResponse_PolicyCounterTimer(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -22750,7 +22747,9 @@ TPM_RC Tpm::SerializeCommand_PolicyCommandCode(
     const TPM_CC& code,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_PolicyCommandCode);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -22820,16 +22819,16 @@ TPM_RC Tpm::SerializeCommand_PolicyCommandCode(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyCommandCode(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyCommandCode);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -22850,6 +22849,7 @@ TPM_RC Tpm::ParseResponse_PolicyCommandCode(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -22960,7 +22960,9 @@ TPM_RC Tpm::SerializeCommand_PolicyPhysicalPresence(
     const std::string& policy_session_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_PolicyPhysicalPresence);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -23022,16 +23024,17 @@ TPM_RC Tpm::SerializeCommand_PolicyPhysicalPresence(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyPhysicalPresence(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_PolicyPhysicalPresence);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -23052,6 +23055,7 @@ TPM_RC Tpm::ParseResponse_PolicyPhysicalPresence(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -23160,7 +23164,8 @@ TPM_RC Tpm::SerializeCommand_PolicyCpHash(
     const TPM2B_DIGEST& cp_hash_a,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PolicyCpHash);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -23238,16 +23243,16 @@ TPM_RC Tpm::SerializeCommand_PolicyCpHash(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyCpHash(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyCpHash);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -23268,6 +23273,7 @@ TPM_RC Tpm::ParseResponse_PolicyCpHash(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -23375,7 +23381,8 @@ TPM_RC Tpm::SerializeCommand_PolicyNameHash(
     const TPM2B_DIGEST& name_hash,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PolicyNameHash);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -23453,16 +23460,16 @@ TPM_RC Tpm::SerializeCommand_PolicyNameHash(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyNameHash(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyNameHash);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -23483,6 +23490,7 @@ TPM_RC Tpm::ParseResponse_PolicyNameHash(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -23593,7 +23601,9 @@ TPM_RC Tpm::SerializeCommand_PolicyDuplicationSelect(
     const TPMI_YES_NO& include_object,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_PolicyDuplicationSelect);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -23687,16 +23697,17 @@ TPM_RC Tpm::SerializeCommand_PolicyDuplicationSelect(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyDuplicationSelect(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_PolicyDuplicationSelect);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -23717,6 +23728,7 @@ TPM_RC Tpm::ParseResponse_PolicyDuplicationSelect(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -23836,7 +23848,9 @@ TPM_RC Tpm::SerializeCommand_PolicyAuthorize(
     const TPMT_TK_VERIFIED& check_ticket,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_PolicyAuthorize);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -23938,16 +23952,16 @@ TPM_RC Tpm::SerializeCommand_PolicyAuthorize(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyAuthorize(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyAuthorize);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -23968,6 +23982,7 @@ TPM_RC Tpm::ParseResponse_PolicyAuthorize(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -24082,7 +24097,9 @@ TPM_RC Tpm::SerializeCommand_PolicyAuthValue(
     const std::string& policy_session_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_PolicyAuthValue);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -24144,16 +24161,16 @@ TPM_RC Tpm::SerializeCommand_PolicyAuthValue(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyAuthValue(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyAuthValue);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -24174,6 +24191,7 @@ TPM_RC Tpm::ParseResponse_PolicyAuthValue(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -24278,7 +24296,8 @@ TPM_RC Tpm::SerializeCommand_PolicyPassword(
     const std::string& policy_session_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PolicyPassword);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -24340,16 +24359,16 @@ TPM_RC Tpm::SerializeCommand_PolicyPassword(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyPassword(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyPassword);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -24370,6 +24389,7 @@ TPM_RC Tpm::ParseResponse_PolicyPassword(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -24473,7 +24493,9 @@ TPM_RC Tpm::SerializeCommand_PolicyGetDigest(
     const std::string& policy_session_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_PolicyGetDigest);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -24535,8 +24557,7 @@ TPM_RC Tpm::SerializeCommand_PolicyGetDigest(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -24544,8 +24565,9 @@ TPM_RC Tpm::ParseResponse_PolicyGetDigest(
     const std::string& response,
     TPM2B_DIGEST* policy_digest,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyGetDigest);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -24566,6 +24588,7 @@ TPM_RC Tpm::ParseResponse_PolicyGetDigest(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -24692,7 +24715,9 @@ TPM_RC Tpm::SerializeCommand_PolicyNvWritten(
     const TPMI_YES_NO& written_set,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_PolicyNvWritten);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -24762,16 +24787,16 @@ TPM_RC Tpm::SerializeCommand_PolicyNvWritten(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PolicyNvWritten(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PolicyNvWritten);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -24792,6 +24817,7 @@ TPM_RC Tpm::ParseResponse_PolicyNvWritten(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -24904,7 +24930,8 @@ TPM_RC Tpm::SerializeCommand_CreatePrimary(
     const TPML_PCR_SELECTION& creation_pcr,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_CreatePrimary);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -25006,8 +25033,7 @@ TPM_RC Tpm::SerializeCommand_CreatePrimary(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -25020,8 +25046,9 @@ TPM_RC Tpm::ParseResponse_CreatePrimary(
     TPMT_TK_CREATION* creation_ticket,
     TPM2B_NAME* name,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_CreatePrimary);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -25042,6 +25069,7 @@ TPM_RC Tpm::ParseResponse_CreatePrimary(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -25218,7 +25246,9 @@ TPM_RC Tpm::SerializeCommand_HierarchyControl(
     const TPMI_YES_NO& state,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_HierarchyControl);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -25296,16 +25326,16 @@ TPM_RC Tpm::SerializeCommand_HierarchyControl(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_HierarchyControl(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_HierarchyControl);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -25326,6 +25356,7 @@ TPM_RC Tpm::ParseResponse_HierarchyControl(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -25440,7 +25471,9 @@ TPM_RC Tpm::SerializeCommand_SetPrimaryPolicy(
     const TPMI_ALG_HASH& hash_alg,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_SetPrimaryPolicy);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -25526,16 +25559,16 @@ TPM_RC Tpm::SerializeCommand_SetPrimaryPolicy(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_SetPrimaryPolicy(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_SetPrimaryPolicy);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -25556,6 +25589,7 @@ TPM_RC Tpm::ParseResponse_SetPrimaryPolicy(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -25668,7 +25702,8 @@ TPM_RC Tpm::SerializeCommand_ChangePPS(
     const std::string& auth_handle_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_ChangePPS);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -25730,16 +25765,16 @@ TPM_RC Tpm::SerializeCommand_ChangePPS(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_ChangePPS(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ChangePPS);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -25760,6 +25795,7 @@ TPM_RC Tpm::ParseResponse_ChangePPS(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -25862,7 +25898,8 @@ TPM_RC Tpm::SerializeCommand_ChangeEPS(
     const std::string& auth_handle_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_ChangeEPS);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -25924,16 +25961,16 @@ TPM_RC Tpm::SerializeCommand_ChangeEPS(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_ChangeEPS(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ChangeEPS);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -25954,6 +25991,7 @@ TPM_RC Tpm::ParseResponse_ChangeEPS(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -26056,7 +26094,8 @@ TPM_RC Tpm::SerializeCommand_Clear(
     const std::string& auth_handle_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_Clear);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -26118,15 +26157,15 @@ TPM_RC Tpm::SerializeCommand_Clear(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_Clear(const std::string& response,
                                 AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_Clear);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -26147,6 +26186,7 @@ TPM_RC Tpm::ParseResponse_Clear(const std::string& response,
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -26250,7 +26290,8 @@ TPM_RC Tpm::SerializeCommand_ClearControl(
     const TPMI_YES_NO& disable,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_ClearControl);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -26320,16 +26361,16 @@ TPM_RC Tpm::SerializeCommand_ClearControl(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_ClearControl(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ClearControl);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -26350,6 +26391,7 @@ TPM_RC Tpm::ParseResponse_ClearControl(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -26455,7 +26497,9 @@ TPM_RC Tpm::SerializeCommand_HierarchyChangeAuth(
     const TPM2B_AUTH& new_auth,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_HierarchyChangeAuth);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -26533,16 +26577,17 @@ TPM_RC Tpm::SerializeCommand_HierarchyChangeAuth(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_HierarchyChangeAuth(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_HierarchyChangeAuth);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -26563,6 +26608,7 @@ TPM_RC Tpm::ParseResponse_HierarchyChangeAuth(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -26673,7 +26719,9 @@ TPM_RC Tpm::SerializeCommand_DictionaryAttackLockReset(
     const std::string& lock_handle_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_DictionaryAttackLockReset);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -26735,16 +26783,17 @@ TPM_RC Tpm::SerializeCommand_DictionaryAttackLockReset(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_DictionaryAttackLockReset(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_DictionaryAttackLockReset);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -26765,6 +26814,7 @@ TPM_RC Tpm::ParseResponse_DictionaryAttackLockReset(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -26877,7 +26927,9 @@ TPM_RC Tpm::SerializeCommand_DictionaryAttackParameters(
     const UINT32& lockout_recovery,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_DictionaryAttackParameters);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -26963,16 +27015,17 @@ TPM_RC Tpm::SerializeCommand_DictionaryAttackParameters(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_DictionaryAttackParameters(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_DictionaryAttackParameters);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -26993,6 +27046,7 @@ TPM_RC Tpm::ParseResponse_DictionaryAttackParameters(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -27112,7 +27166,8 @@ TPM_RC Tpm::SerializeCommand_PP_Commands(
     const TPML_CC& clear_list,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_PP_Commands);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -27190,16 +27245,16 @@ TPM_RC Tpm::SerializeCommand_PP_Commands(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_PP_Commands(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_PP_Commands);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -27220,6 +27275,7 @@ TPM_RC Tpm::ParseResponse_PP_Commands(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -27327,7 +27383,9 @@ TPM_RC Tpm::SerializeCommand_SetAlgorithmSet(
     const UINT32& algorithm_set,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_SetAlgorithmSet);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -27397,16 +27455,16 @@ TPM_RC Tpm::SerializeCommand_SetAlgorithmSet(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_SetAlgorithmSet(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_SetAlgorithmSet);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -27427,6 +27485,7 @@ TPM_RC Tpm::ParseResponse_SetAlgorithmSet(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -27539,7 +27598,9 @@ TPM_RC Tpm::SerializeCommand_FieldUpgradeStart(
     const TPMT_SIGNATURE& manifest_signature,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_FieldUpgradeStart);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -27634,16 +27695,16 @@ TPM_RC Tpm::SerializeCommand_FieldUpgradeStart(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_FieldUpgradeStart(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_FieldUpgradeStart);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -27664,6 +27725,7 @@ TPM_RC Tpm::ParseResponse_FieldUpgradeStart(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -27779,7 +27841,9 @@ TPM_RC Tpm::SerializeCommand_FieldUpgradeData(
     const TPM2B_MAX_BUFFER& fu_data,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_FieldUpgradeData);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -27849,8 +27913,7 @@ TPM_RC Tpm::SerializeCommand_FieldUpgradeData(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -27859,8 +27922,9 @@ TPM_RC Tpm::ParseResponse_FieldUpgradeData(
     TPMT_HA* next_digest,
     TPMT_HA* first_digest,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_FieldUpgradeData);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -27881,6 +27945,7 @@ TPM_RC Tpm::ParseResponse_FieldUpgradeData(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -27999,7 +28064,8 @@ TPM_RC Tpm::SerializeCommand_FirmwareRead(
     const UINT32& sequence_number,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_FirmwareRead);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -28061,8 +28127,7 @@ TPM_RC Tpm::SerializeCommand_FirmwareRead(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -28070,8 +28135,9 @@ TPM_RC Tpm::ParseResponse_FirmwareRead(
     const std::string& response,
     TPM2B_MAX_BUFFER* fu_data,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_FirmwareRead);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -28092,6 +28158,7 @@ TPM_RC Tpm::ParseResponse_FirmwareRead(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -28213,7 +28280,8 @@ TPM_RC Tpm::SerializeCommand_ContextSave(
     const std::string& save_handle_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_ContextSave);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -28275,8 +28343,7 @@ TPM_RC Tpm::SerializeCommand_ContextSave(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -28284,8 +28351,9 @@ TPM_RC Tpm::ParseResponse_ContextSave(
     const std::string& response,
     TPMS_CONTEXT* context,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ContextSave);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -28306,6 +28374,7 @@ TPM_RC Tpm::ParseResponse_ContextSave(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -28415,7 +28484,8 @@ TPM_RC Tpm::SerializeCommand_ContextLoad(
     const TPMS_CONTEXT& context,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_ContextLoad);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -28477,8 +28547,7 @@ TPM_RC Tpm::SerializeCommand_ContextLoad(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -28486,8 +28555,9 @@ TPM_RC Tpm::ParseResponse_ContextLoad(
     const std::string& response,
     TPMI_DH_CONTEXT* loaded_handle,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ContextLoad);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -28508,6 +28578,7 @@ TPM_RC Tpm::ParseResponse_ContextLoad(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -28616,7 +28687,8 @@ TPM_RC Tpm::SerializeCommand_FlushContext(
     const TPMI_DH_CONTEXT& flush_handle,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_FlushContext);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -28678,16 +28750,16 @@ TPM_RC Tpm::SerializeCommand_FlushContext(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_FlushContext(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_FlushContext);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -28708,6 +28780,7 @@ TPM_RC Tpm::ParseResponse_FlushContext(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -28811,7 +28884,8 @@ TPM_RC Tpm::SerializeCommand_EvictControl(
     const TPMI_DH_PERSISTENT& persistent_handle,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_EvictControl);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -28890,16 +28964,16 @@ TPM_RC Tpm::SerializeCommand_EvictControl(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_EvictControl(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_EvictControl);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -28920,6 +28994,7 @@ TPM_RC Tpm::ParseResponse_EvictControl(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -29028,7 +29103,8 @@ TPM_RC Tpm::EvictControlSync(const TPMI_RH_PROVISION& auth,
 TPM_RC Tpm::SerializeCommand_ReadClock(
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_ReadClock);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -29082,8 +29158,7 @@ TPM_RC Tpm::SerializeCommand_ReadClock(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -29091,8 +29166,9 @@ TPM_RC Tpm::ParseResponse_ReadClock(
     const std::string& response,
     TPMS_TIME_INFO* current_time,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ReadClock);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -29113,6 +29189,7 @@ TPM_RC Tpm::ParseResponse_ReadClock(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -29218,7 +29295,8 @@ TPM_RC Tpm::SerializeCommand_ClockSet(
     const UINT64& new_time,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_ClockSet);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -29288,16 +29366,16 @@ TPM_RC Tpm::SerializeCommand_ClockSet(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_ClockSet(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ClockSet);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -29318,6 +29396,7 @@ TPM_RC Tpm::ParseResponse_ClockSet(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -29423,7 +29502,9 @@ TPM_RC Tpm::SerializeCommand_ClockRateAdjust(
     const TPM_CLOCK_ADJUST& rate_adjust,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_ClockRateAdjust);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -29493,16 +29574,16 @@ TPM_RC Tpm::SerializeCommand_ClockRateAdjust(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_ClockRateAdjust(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_ClockRateAdjust);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -29523,6 +29604,7 @@ TPM_RC Tpm::ParseResponse_ClockRateAdjust(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -29630,7 +29712,8 @@ TPM_RC Tpm::SerializeCommand_GetCapability(
     const UINT32& property_count,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_GetCapability);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -29708,8 +29791,7 @@ TPM_RC Tpm::SerializeCommand_GetCapability(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -29718,8 +29800,9 @@ TPM_RC Tpm::ParseResponse_GetCapability(
     TPMI_YES_NO* more_data,
     TPMS_CAPABILITY_DATA* capability_data,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_GetCapability);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -29740,6 +29823,7 @@ TPM_RC Tpm::ParseResponse_GetCapability(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -29860,7 +29944,8 @@ TPM_RC Tpm::SerializeCommand_TestParms(
     const TPMT_PUBLIC_PARMS& parameters,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_TestParms);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -29922,16 +30007,16 @@ TPM_RC Tpm::SerializeCommand_TestParms(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_TestParms(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_TestParms);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -29952,6 +30037,7 @@ TPM_RC Tpm::ParseResponse_TestParms(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -30054,7 +30140,8 @@ TPM_RC Tpm::SerializeCommand_NV_DefineSpace(
     const TPM2B_NV_PUBLIC& public_info,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_NV_DefineSpace);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -30140,16 +30227,16 @@ TPM_RC Tpm::SerializeCommand_NV_DefineSpace(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_NV_DefineSpace(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_NV_DefineSpace);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -30170,6 +30257,7 @@ TPM_RC Tpm::ParseResponse_NV_DefineSpace(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -30281,7 +30369,9 @@ TPM_RC Tpm::SerializeCommand_NV_UndefineSpace(
     const std::string& nv_index_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_NV_UndefineSpace);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -30351,16 +30441,16 @@ TPM_RC Tpm::SerializeCommand_NV_UndefineSpace(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_NV_UndefineSpace(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_NV_UndefineSpace);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -30381,6 +30471,7 @@ TPM_RC Tpm::ParseResponse_NV_UndefineSpace(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -30495,7 +30586,9 @@ TPM_RC Tpm::SerializeCommand_NV_UndefineSpaceSpecial(
     const std::string& platform_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_NV_UndefineSpaceSpecial);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -30565,16 +30658,17 @@ TPM_RC Tpm::SerializeCommand_NV_UndefineSpaceSpecial(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_NV_UndefineSpaceSpecial(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_NV_UndefineSpaceSpecial);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -30595,6 +30689,7 @@ TPM_RC Tpm::ParseResponse_NV_UndefineSpaceSpecial(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -30708,7 +30803,8 @@ TPM_RC Tpm::SerializeCommand_NV_ReadPublic(
     const std::string& nv_index_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_NV_ReadPublic);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -30770,8 +30866,7 @@ TPM_RC Tpm::SerializeCommand_NV_ReadPublic(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -30780,8 +30875,9 @@ TPM_RC Tpm::ParseResponse_NV_ReadPublic(
     TPM2B_NV_PUBLIC* nv_public,
     TPM2B_NAME* nv_name,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_NV_ReadPublic);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -30802,6 +30898,7 @@ TPM_RC Tpm::ParseResponse_NV_ReadPublic(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -30937,7 +31034,8 @@ TPM_RC Tpm::SerializeCommand_NV_Write(
     const UINT16& offset,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_NV_Write);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -31031,16 +31129,16 @@ TPM_RC Tpm::SerializeCommand_NV_Write(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_NV_Write(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_NV_Write);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -31061,6 +31159,7 @@ TPM_RC Tpm::ParseResponse_NV_Write(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -31175,7 +31274,8 @@ TPM_RC Tpm::SerializeCommand_NV_Increment(
     const std::string& nv_index_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_NV_Increment);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -31245,16 +31345,16 @@ TPM_RC Tpm::SerializeCommand_NV_Increment(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_NV_Increment(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_NV_Increment);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -31275,6 +31375,7 @@ TPM_RC Tpm::ParseResponse_NV_Increment(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -31386,7 +31487,8 @@ TPM_RC Tpm::SerializeCommand_NV_Extend(
     const TPM2B_MAX_NV_BUFFER& data,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_NV_Extend);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -31472,16 +31574,16 @@ TPM_RC Tpm::SerializeCommand_NV_Extend(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_NV_Extend(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_NV_Extend);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -31502,6 +31604,7 @@ TPM_RC Tpm::ParseResponse_NV_Extend(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -31615,7 +31718,8 @@ TPM_RC Tpm::SerializeCommand_NV_SetBits(
     const UINT64& bits,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_NV_SetBits);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -31693,16 +31797,16 @@ TPM_RC Tpm::SerializeCommand_NV_SetBits(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_NV_SetBits(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_NV_SetBits);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -31723,6 +31827,7 @@ TPM_RC Tpm::ParseResponse_NV_SetBits(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -31835,7 +31940,8 @@ TPM_RC Tpm::SerializeCommand_NV_WriteLock(
     const std::string& nv_index_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_NV_WriteLock);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -31905,16 +32011,16 @@ TPM_RC Tpm::SerializeCommand_NV_WriteLock(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_NV_WriteLock(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_NV_WriteLock);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -31935,6 +32041,7 @@ TPM_RC Tpm::ParseResponse_NV_WriteLock(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -32043,7 +32150,9 @@ TPM_RC Tpm::SerializeCommand_NV_GlobalWriteLock(
     const std::string& auth_handle_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand,
+                       TPM_CC_NV_GlobalWriteLock);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -32105,16 +32214,17 @@ TPM_RC Tpm::SerializeCommand_NV_GlobalWriteLock(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_NV_GlobalWriteLock(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse,
+                       TPM_CC_NV_GlobalWriteLock);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -32135,6 +32245,7 @@ TPM_RC Tpm::ParseResponse_NV_GlobalWriteLock(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -32245,7 +32356,8 @@ TPM_RC Tpm::SerializeCommand_NV_Read(
     const UINT16& offset,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_NV_Read);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -32331,8 +32443,7 @@ TPM_RC Tpm::SerializeCommand_NV_Read(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -32340,8 +32451,9 @@ TPM_RC Tpm::ParseResponse_NV_Read(
     const std::string& response,
     TPM2B_MAX_NV_BUFFER* data,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_NV_Read);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -32362,6 +32474,7 @@ TPM_RC Tpm::ParseResponse_NV_Read(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -32497,7 +32610,8 @@ TPM_RC Tpm::SerializeCommand_NV_ReadLock(
     const std::string& nv_index_name,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_NV_ReadLock);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -32567,16 +32681,16 @@ TPM_RC Tpm::SerializeCommand_NV_ReadLock(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_NV_ReadLock(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_NV_ReadLock);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -32597,6 +32711,7 @@ TPM_RC Tpm::ParseResponse_NV_ReadLock(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -32706,7 +32821,8 @@ TPM_RC Tpm::SerializeCommand_NV_ChangeAuth(
     const TPM2B_AUTH& new_auth,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_NV_ChangeAuth);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -32784,16 +32900,16 @@ TPM_RC Tpm::SerializeCommand_NV_ChangeAuth(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
 TPM_RC Tpm::ParseResponse_NV_ChangeAuth(
     const std::string& response,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_NV_ChangeAuth);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -32814,6 +32930,7 @@ TPM_RC Tpm::ParseResponse_NV_ChangeAuth(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -32927,7 +33044,8 @@ TPM_RC Tpm::SerializeCommand_NV_Certify(
     const UINT16& offset,
     std::string* serialized_command,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kSerializeCommand, TPM_CC_NV_Certify);
   TPM_RC rc = TPM_RC_SUCCESS;
   TPMI_ST_COMMAND_TAG tag = TPM_ST_NO_SESSIONS;
   UINT32 command_size = 10;  // Header size.
@@ -33045,8 +33163,7 @@ TPM_RC Tpm::SerializeCommand_NV_Certify(
                         handle_section_bytes + authorization_size_bytes +
                         authorization_section_bytes + parameter_section_bytes;
   CHECK(serialized_command->size() == command_size) << "Command size mismatch!";
-  VLOG(2) << "Command: " << base::HexEncode(serialized_command->data(),
-                                            serialized_command->size());
+  trace.set_data(serialized_command);
   return TPM_RC_SUCCESS;
 }
 
@@ -33055,8 +33172,9 @@ TPM_RC Tpm::ParseResponse_NV_Certify(
     TPM2B_ATTEST* certify_info,
     TPMT_SIGNATURE* signature,
     AuthorizationDelegate* authorization_delegate) {
-  VLOG(3) << __func__;
-  VLOG(2) << "Response: " << base::HexEncode(response.data(), response.size());
+  MARSHALING_VLOG(3) << __func__;
+  ScopedTpmTrace trace(TpmTraceEvent::kParseResponse, TPM_CC_NV_Certify);
+  trace.set_data(&response);
   TPM_RC rc = TPM_RC_SUCCESS;
   std::string buffer(response);
   TPM_ST tag;
@@ -33077,6 +33195,7 @@ TPM_RC Tpm::ParseResponse_NV_Certify(
   if (rc != TPM_RC_SUCCESS) {
     return rc;
   }
+  trace.set_response_code(response_code);
   if (response_size != response.size()) {
     return TPM_RC_SIZE;
   }
@@ -33223,4 +33342,10 @@ TPM_RC Tpm::NV_CertifySync(const TPMI_DH_OBJECT& sign_handle,
   return rc;
 }
 
+std::vector<std::string> Tpm::SendCommandsAndWait(
+    const std::vector<std::string>& commands) {
+  VLOG(1) << __func__ << ": " << commands.size() << " commands";
+  return transceiver_->SendCommandsAndWait(commands);
+}
+
 }  // namespace trunks
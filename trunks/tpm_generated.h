@@ -20,9 +20,11 @@
 #define TRUNKS_TPM_GENERATED_H_
 
 #include <string>
+#include <vector>
 
 #include <base/callback_forward.h>
 #include <base/macros.h>
+#include <base/time/time.h>
 
 #include "trunks/trunks_export.h"
 
@@ -1652,9 +1654,70 @@ struct TPM2B_CREATION_DATA {
   TPMS_CREATION_DATA creation_data;
 };
 
+// How long a command typically keeps the TPM busy.
+enum class TpmCommandLatency : uint8_t {
+  // Bookkeeping, reads and symmetric operations on small inputs.
+  kShort,
+  // Operations with a loaded asymmetric key, and everything else that is
+  // neither short nor long, e.g. HierarchyControl and NV writes.
+  kMedium,
+  // Key generation, seed changes (Clear, ChangeEPS, ChangePPS), self tests,
+  // Startup and field upgrades.
+  kLong,
+};
+
+// Static facts about a TPM command.
+struct TpmCommandInfo {
+  TPM_CC code;
+  uint8_t request_handles;
+  uint8_t response_handles;
+  // Whether the first command or response parameter is a TPM2B, i.e. whether
+  // it can be encrypted by a session.
+  bool command_encryption_possible;
+  bool response_encryption_possible;
+  // Whether the command leaves objects, NV indexes, PCRs, the clock and
+  // hierarchy settings unchanged. Session state may still change.
+  bool read_only;
+  // Bit i is set if request handle i is flushed when the command succeeds.
+  uint8_t invalidated_handles;
+  TpmCommandLatency latency;
+};
+
+// Returns the entry for |command_code| or nullptr if the command is unknown.
+TRUNKS_EXPORT const TpmCommandInfo* GetCommandInfo(TPM_CC command_code);
 TRUNKS_EXPORT size_t GetNumberOfRequestHandles(TPM_CC command_code);
 TRUNKS_EXPORT size_t GetNumberOfResponseHandles(TPM_CC command_code);
 
+// Describes the marshaling of one command or response by the Tpm class.
+struct TpmTraceEvent {
+  enum Stage {
+    // Tpm::SerializeCommand_*.
+    kSerializeCommand,
+    // Tpm::ParseResponse_*.
+    kParseResponse,
+  };
+  Stage stage;
+  TPM_CC command_code;
+  // The serialized command or the response, or nullptr if the command could
+  // not be serialized. Valid only while the hook runs.
+  const std::string* data;
+  // The size of |data| in bytes, or zero if |data| is nullptr.
+  size_t size;
+  // The response code in the response header, or TPM_RC_SUCCESS if it could
+  // not be parsed or |stage| is kSerializeCommand.
+  TPM_RC response_code;
+  // Time spent in the serialize or parse function.
+  base::TimeDelta elapsed;
+};
+
+typedef void (*TpmTraceHook)(const TpmTraceEvent& event);
+
+// Installs |hook| to be called after every command is serialized and every
+// response is parsed, or removes the hook if |hook| is nullptr. The hook runs
+// on the calling thread. Without a hook, tracing costs one atomic load per
+// serialize or parse call.
+TRUNKS_EXPORT void SetTpmTraceHook(TpmTraceHook hook);
+
 TRUNKS_EXPORT TPM_RC Serialize_uint8_t(const uint8_t& value,
                                        std::string* buffer);
 
@@ -3352,6 +3415,13 @@ class TRUNKS_EXPORT Tpm {
   explicit Tpm(CommandTransceiver* transceiver) : transceiver_(transceiver) {}
   virtual ~Tpm() {}
 
+  // Sends each of the serialized |commands| and returns the responses in the
+  // same order. The transceiver may keep several commands in flight, so the
+  // commands must not depend on each other's responses, e.g. through session
+  // nonces.
+  virtual std::vector<std::string> SendCommandsAndWait(
+      const std::vector<std::string>& commands);
+
   typedef base::Callback<void(TPM_RC response_code)> StartupResponse;
   static TPM_RC SerializeCommand_Startup(
       const TPM_SU& startup_type,
@@ -16,10 +16,16 @@
 
 // Note: These tests are not generated. They test generated code.
 
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
 #include <base/bind.h>
 #include <base/callback.h>
 #include <base/message_loop/message_loop.h>
 #include <base/run_loop.h>
+#include <base/time/time.h>
 #include <gtest/gtest.h>
 
 #include "trunks/mock_authorization_delegate.h"
@@ -89,6 +95,34 @@ TEST(GeneratorTest, ParseBufferOverflow) {
             Parse_TPM2B_MAX_BUFFER(&malformed2, &tmp, nullptr));
 }
 
+TEST(GeneratorTest, CommandInfo) {
+  for (TPM_CC code = TPM_CC_FIRST; code <= TPM_CC_LAST; ++code) {
+    const TpmCommandInfo* info = GetCommandInfo(code);
+    if (info) {
+      EXPECT_EQ(code, info->code);
+      EXPECT_EQ(info->request_handles, GetNumberOfRequestHandles(code));
+      EXPECT_EQ(info->response_handles, GetNumberOfResponseHandles(code));
+    }
+  }
+  EXPECT_FALSE(GetCommandInfo(TPM_CC_FIRST - 1));
+  EXPECT_FALSE(GetCommandInfo(TPM_CC_LAST + 1));
+  EXPECT_FALSE(GetCommandInfo(0x123));
+  const TpmCommandInfo* create = GetCommandInfo(TPM_CC_Create);
+  ASSERT_TRUE(create);
+  EXPECT_EQ(1u, create->request_handles);
+  EXPECT_TRUE(create->command_encryption_possible);
+  EXPECT_EQ(TpmCommandLatency::kLong, create->latency);
+  const TpmCommandInfo* sequence_complete =
+      GetCommandInfo(TPM_CC_EventSequenceComplete);
+  ASSERT_TRUE(sequence_complete);
+  EXPECT_EQ(0x02, sequence_complete->invalidated_handles);
+  EXPECT_FALSE(sequence_complete->read_only);
+  const TpmCommandInfo* pcr_read = GetCommandInfo(TPM_CC_PCR_Read);
+  ASSERT_TRUE(pcr_read);
+  EXPECT_TRUE(pcr_read->read_only);
+  EXPECT_EQ(TpmCommandLatency::kShort, pcr_read->latency);
+}
+
 TEST(GeneratorTest, SynchronousCommand) {
   // A hand-rolled TPM2_Startup command.
   std::string expected_command(
@@ -135,6 +169,72 @@ TEST(GeneratorTest, SynchronousCommandWithError) {
   EXPECT_EQ(TPM_RC_FAILURE, tpm.StartupSync(TPM_SU_CLEAR, &authorization));
 }
 
+std::vector<TpmTraceEvent> g_trace_events;
+
+void RecordTraceEvent(const TpmTraceEvent& event) {
+  g_trace_events.push_back(event);
+  // |data| is only valid while the hook runs.
+  g_trace_events.back().data = nullptr;
+}
+
+void IgnoreTraceEvent(const TpmTraceEvent& event) {}
+
+TEST(GeneratorTest, TraceHook) {
+  std::string command_response(
+      "\x80\x01"           // tag=TPM_ST_NO_SESSIONS
+      "\x00\x00\x00\x0A"   // size=10
+      "\x00\x00\x01\x01",  // code=TPM_RC_FAILURE
+      10);
+  StrictMock<MockCommandTransceiver> transceiver;
+  EXPECT_CALL(transceiver, SendCommandAndWait(_))
+      .Times(2)
+      .WillRepeatedly(Return(command_response));
+  Tpm tpm(&transceiver);
+  g_trace_events.clear();
+  SetTpmTraceHook(&RecordTraceEvent);
+  EXPECT_EQ(TPM_RC_FAILURE, tpm.StartupSync(TPM_SU_CLEAR, nullptr));
+  SetTpmTraceHook(nullptr);
+  EXPECT_EQ(TPM_RC_FAILURE, tpm.StartupSync(TPM_SU_CLEAR, nullptr));
+  ASSERT_EQ(2u, g_trace_events.size());
+  EXPECT_EQ(TpmTraceEvent::kSerializeCommand, g_trace_events[0].stage);
+  EXPECT_EQ(TPM_CC_Startup, g_trace_events[0].command_code);
+  EXPECT_EQ(12u, g_trace_events[0].size);
+  EXPECT_EQ(TPM_RC_SUCCESS, g_trace_events[0].response_code);
+  EXPECT_EQ(TpmTraceEvent::kParseResponse, g_trace_events[1].stage);
+  EXPECT_EQ(TPM_CC_Startup, g_trace_events[1].command_code);
+  EXPECT_EQ(10u, g_trace_events[1].size);
+  EXPECT_EQ(TPM_RC_FAILURE, g_trace_events[1].response_code);
+}
+
+// Reports the cost of marshaling a large command with and without a trace
+// hook. Run it with --gtest_also_run_disabled_tests, and build with
+// -DTRUNKS_MARSHALING_VLOG to include the per-function traces.
+TEST(GeneratorTest, DISABLED_MarshalingBenchmark) {
+  const int kIterations = 10000;
+  TPM2B_MAX_BUFFER data =
+      Make_TPM2B_MAX_BUFFER(std::string(MAX_DIGEST_BUFFER, 'A'));
+  for (TpmTraceHook hook : {static_cast<TpmTraceHook>(nullptr),
+                            &IgnoreTraceEvent}) {
+    SetTpmTraceHook(hook);
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kIterations; ++i) {
+      std::string command;
+      ASSERT_EQ(TPM_RC_SUCCESS,
+                Tpm::SerializeCommand_Hash(data, TPM_ALG_SHA256, TPM_RH_NULL,
+                                           &command, nullptr));
+      // Skip the header to parse the data parameter.
+      command.erase(0, 10);
+      TPM2B_MAX_BUFFER parsed;
+      ASSERT_EQ(TPM_RC_SUCCESS,
+                Parse_TPM2B_MAX_BUFFER(&command, &parsed, nullptr));
+    }
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+    printf("%s hook: %.2f us per command\n", hook ? "With" : "Without",
+           elapsed.InMicrosecondsF() / kIterations);
+  }
+  SetTpmTraceHook(nullptr);
+}
+
 TEST(GeneratorTest, SynchronousCommandResponseTest) {
   std::string auth_in(10, 'A');
   std::string auth_out(10, 'B');
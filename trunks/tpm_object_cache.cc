@@ -0,0 +1,168 @@
+//
+// Copyright (C) 2015 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/tpm_object_cache.h"
+
+namespace trunks {
+
+TpmObjectCache::TpmObjectCache() {}
+
+TpmObjectCache::~TpmObjectCache() {}
+
+bool TpmObjectCache::GetNVPublicArea(uint32_t index,
+                                     TPMS_NV_PUBLIC* public_area) {
+  base::AutoLock lock(lock_);
+  auto it = nv_public_areas_.find(index);
+  if (it == nv_public_areas_.end()) {
+    return false;
+  }
+  *public_area = it->second;
+  return true;
+}
+
+void TpmObjectCache::SetNVPublicArea(uint32_t index,
+                                     const TPMS_NV_PUBLIC& public_area) {
+  base::AutoLock lock(lock_);
+  nv_public_areas_[index] = public_area;
+}
+
+void TpmObjectCache::UpdateNVAttributes(uint32_t index, TPMA_NV attributes) {
+  base::AutoLock lock(lock_);
+  auto it = nv_public_areas_.find(index);
+  if (it != nv_public_areas_.end()) {
+    it->second.attributes |= attributes;
+  }
+}
+
+void TpmObjectCache::RemoveNVPublicArea(uint32_t index) {
+  base::AutoLock lock(lock_);
+  nv_public_areas_.erase(index);
+}
+
+bool TpmObjectCache::GetObject(TPM_HANDLE handle,
+                               TPMT_PUBLIC* public_area,
+                               std::string* name) {
+  base::AutoLock lock(lock_);
+  auto it = objects_.find(handle);
+  if (it == objects_.end()) {
+    return false;
+  }
+  if (public_area) {
+    *public_area = it->second.public_area;
+  }
+  if (name) {
+    *name = it->second.name;
+  }
+  return true;
+}
+
+void TpmObjectCache::SetObject(TPM_HANDLE handle,
+                               const TPMT_PUBLIC& public_area,
+                               const std::string& name) {
+  if (handle < PERSISTENT_FIRST || handle > PERSISTENT_LAST) {
+    return;
+  }
+  base::AutoLock lock(lock_);
+  ObjectInfo& info = objects_[handle];
+  info.public_area = public_area;
+  info.name = name;
+}
+
+void TpmObjectCache::RemoveObject(TPM_HANDLE handle) {
+  base::AutoLock lock(lock_);
+  objects_.erase(handle);
+}
+
+void TpmObjectCache::SetSealedObjectCacheSize(size_t size) {
+  base::AutoLock lock(lock_);
+  sealed_object_cache_size_ = size;
+}
+
+bool TpmObjectCache::GetSealedObject(const std::string& blob_digest,
+                                     TPM_HANDLE* handle) {
+  base::AutoLock lock(lock_);
+  for (auto it = sealed_objects_.begin(); it != sealed_objects_.end(); ++it) {
+    if (it->blob_digest == blob_digest) {
+      *handle = it->handle;
+      ++it->pin_count;
+      sealed_objects_.splice(sealed_objects_.begin(), sealed_objects_, it);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TpmObjectCache::AddSealedObject(const std::string& blob_digest,
+                                     TPM_HANDLE handle,
+                                     std::vector<TPM_HANDLE>* evicted) {
+  base::AutoLock lock(lock_);
+  if (sealed_object_cache_size_ == 0) {
+    return false;
+  }
+  // Another thread may have loaded the same blob in the meantime and may still
+  // be using its handle, so that one is kept.
+  for (const auto& sealed_object : sealed_objects_) {
+    if (sealed_object.blob_digest == blob_digest) {
+      return false;
+    }
+  }
+  sealed_objects_.push_front({blob_digest, handle, 1});
+  EvictSealedObjects(evicted);
+  return true;
+}
+
+void TpmObjectCache::ReleaseSealedObject(const std::string& blob_digest,
+                                         TPM_HANDLE handle,
+                                         std::vector<TPM_HANDLE>* evicted) {
+  base::AutoLock lock(lock_);
+  for (auto& sealed_object : sealed_objects_) {
+    if (sealed_object.blob_digest == blob_digest &&
+        sealed_object.handle == handle) {
+      --sealed_object.pin_count;
+      break;
+    }
+  }
+  EvictSealedObjects(evicted);
+}
+
+void TpmObjectCache::RemoveSealedObject(const std::string& blob_digest) {
+  base::AutoLock lock(lock_);
+  sealed_objects_.remove_if([&blob_digest](const SealedObject& sealed_object) {
+    return sealed_object.blob_digest == blob_digest;
+  });
+}
+
+void TpmObjectCache::EvictSealedObjects(std::vector<TPM_HANDLE>* evicted) {
+  lock_.AssertAcquired();
+  auto it = sealed_objects_.end();
+  while (sealed_objects_.size() > sealed_object_cache_size_ &&
+         it != sealed_objects_.begin()) {
+    --it;
+    if (it->pin_count == 0) {
+      evicted->push_back(it->handle);
+      it = sealed_objects_.erase(it);
+    }
+  }
+}
+
+void TpmObjectCache::Clear() {
+  base::AutoLock lock(lock_);
+  nv_public_areas_.clear();
+  objects_.clear();
+  sealed_objects_.clear();
+}
+
+}  // namespace trunks
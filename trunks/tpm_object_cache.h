@@ -0,0 +1,141 @@
+//
+// Copyright (C) 2015 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef TRUNKS_TPM_OBJECT_CACHE_H_
+#define TRUNKS_TPM_OBJECT_CACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <base/macros.h>
+#include <base/synchronization/lock.h>
+
+#include "trunks/tpm_generated.h"
+#include "trunks/trunks_export.h"
+
+namespace trunks {
+
+// TpmObjectCache remembers the public areas and names of NV spaces and
+// objects so that clients don't need a NV_ReadPublic or ReadPublic round trip
+// every time they need them. A single instance is owned by a TrunksFactory and
+// shared by all the objects it creates. This class is thread-safe.
+//
+// Only objects at persistent handles are cached. A transient handle can be
+// flushed by any client of trunksd and then reused for another object, and
+// nothing here would notice, so transient objects are always read from the
+// TPM. A persistent object only changes through EvictControl or a TPM clear,
+// and its entry must be removed when that happens. NV public areas change as
+// spaces are written and locked; the owner of the cache is expected to keep
+// them up to date through UpdateNVAttributes.
+//
+// The cache can also keep sealed data objects loaded, keyed by a digest of
+// their blob, so that unsealing the same blob again costs a ReadPublic, to
+// confirm the handle still holds that object, and an Unseal. A sealed object
+// is pinned from the time it is looked up or added until it is released, and
+// a pinned object is never handed out for flushing, so one thread cannot
+// flush a handle another thread is unsealing with. This is disabled until
+// SetSealedObjectCacheSize() is called.
+class TRUNKS_EXPORT TpmObjectCache {
+ public:
+  TpmObjectCache();
+  ~TpmObjectCache();
+
+  // Looks up the cached public area of the NV space at |index|. Returns true
+  // and fills |public_area| if the space is cached.
+  bool GetNVPublicArea(uint32_t index, TPMS_NV_PUBLIC* public_area);
+  // Caches |public_area| for the NV space at |index|.
+  void SetNVPublicArea(uint32_t index, const TPMS_NV_PUBLIC& public_area);
+  // Sets |attributes| in the cached public area of |index|, if any.
+  void UpdateNVAttributes(uint32_t index, TPMA_NV attributes);
+  // Drops the cached public area of |index|.
+  void RemoveNVPublicArea(uint32_t index);
+
+  // Looks up the cached public area and name of the object at |handle|.
+  // Returns true and fills |public_area| and |name| if the object is cached.
+  // Either output may be null.
+  bool GetObject(TPM_HANDLE handle,
+                 TPMT_PUBLIC* public_area,
+                 std::string* name);
+  // Caches |public_area| and |name| for the object at |handle|. Does nothing
+  // if |handle| is not a persistent handle.
+  void SetObject(TPM_HANDLE handle,
+                 const TPMT_PUBLIC& public_area,
+                 const std::string& name);
+  // Drops the cached entry for |handle|. Must be called when a persistent
+  // object is evicted, since the handle may be reused.
+  void RemoveObject(TPM_HANDLE handle);
+
+  // Keeps up to |size| sealed objects loaded, more only while they are
+  // pinned. A |size| of zero disables the sealed object cache.
+  void SetSealedObjectCacheSize(size_t size);
+  // Looks up the handle of the loaded sealed object for a blob with digest
+  // |blob_digest|. Returns true, fills |handle| and pins the object if it is
+  // cached; the caller must then call ReleaseSealedObject().
+  bool GetSealedObject(const std::string& blob_digest, TPM_HANDLE* handle);
+  // Caches |handle| as the loaded object for |blob_digest| and pins it; the
+  // caller must then call ReleaseSealedObject(). Returns false if the sealed
+  // object cache is disabled or already holds an object for |blob_digest|, in
+  // which case the caller still owns |handle|. Unpinned least recently used
+  // objects pushed out of the cache are added to |evicted|; the caller must
+  // flush them.
+  bool AddSealedObject(const std::string& blob_digest,
+                       TPM_HANDLE handle,
+                       std::vector<TPM_HANDLE>* evicted);
+  // Unpins the sealed object at |handle| for |blob_digest|. Objects that no
+  // longer fit in the cache are added to |evicted|; the caller must flush
+  // them.
+  void ReleaseSealedObject(const std::string& blob_digest,
+                           TPM_HANDLE handle,
+                           std::vector<TPM_HANDLE>* evicted);
+  // Drops the cached sealed object for |blob_digest| without flushing it.
+  void RemoveSealedObject(const std::string& blob_digest);
+
+  // Drops every cached entry, e.g. after the TPM has been cleared.
+  void Clear();
+
+ private:
+  struct ObjectInfo {
+    TPMT_PUBLIC public_area;
+    std::string name;
+  };
+
+  struct SealedObject {
+    std::string blob_digest;
+    TPM_HANDLE handle;
+    // The number of callers using |handle|.
+    int pin_count;
+  };
+
+  // Removes unpinned least recently used sealed objects, adding them to
+  // |evicted|, until the cache fits its size or only pinned objects are left.
+  // |lock_| must be held.
+  void EvictSealedObjects(std::vector<TPM_HANDLE>* evicted);
+
+  base::Lock lock_;
+  std::map<uint32_t, TPMS_NV_PUBLIC> nv_public_areas_;
+  std::map<TPM_HANDLE, ObjectInfo> objects_;
+  size_t sealed_object_cache_size_ = 0;
+  // Most recently used first.
+  std::list<SealedObject> sealed_objects_;
+
+  DISALLOW_COPY_AND_ASSIGN(TpmObjectCache);
+};
+
+}  // namespace trunks
+
+#endif  // TRUNKS_TPM_OBJECT_CACHE_H_
@@ -0,0 +1,165 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/tpm_object_cache.h"
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "trunks/tpm_constants.h"
+
+namespace trunks {
+
+class TpmObjectCacheTest : public testing::Test {
+ public:
+  void SetUp() override {
+    memset(&public_area_, 0, sizeof(public_area_));
+    public_area_.type = TPM_ALG_RSA;
+    memset(&nv_public_area_, 0, sizeof(nv_public_area_));
+    nv_public_area_.nv_index = NV_INDEX_FIRST + 1;
+    nv_public_area_.attributes = TPMA_NV_OWNERWRITE;
+  }
+
+ protected:
+  TpmObjectCache cache_;
+  TPMT_PUBLIC public_area_;
+  TPMS_NV_PUBLIC nv_public_area_;
+};
+
+TEST_F(TpmObjectCacheTest, PersistentObject) {
+  cache_.SetObject(PERSISTENT_FIRST, public_area_, "name");
+  TPMT_PUBLIC public_area;
+  std::string name;
+  EXPECT_TRUE(cache_.GetObject(PERSISTENT_FIRST, &public_area, &name));
+  EXPECT_EQ(TPM_ALG_RSA, public_area.type);
+  EXPECT_EQ("name", name);
+  EXPECT_TRUE(cache_.GetObject(PERSISTENT_FIRST, nullptr, nullptr));
+  EXPECT_FALSE(cache_.GetObject(PERSISTENT_FIRST + 1, nullptr, nullptr));
+}
+
+TEST_F(TpmObjectCacheTest, TransientObjectIsNotCached) {
+  cache_.SetObject(TRANSIENT_FIRST, public_area_, "name");
+  EXPECT_FALSE(cache_.GetObject(TRANSIENT_FIRST, nullptr, nullptr));
+}
+
+TEST_F(TpmObjectCacheTest, EvictedObjectIsReplaced) {
+  cache_.SetObject(PERSISTENT_FIRST, public_area_, "name");
+  cache_.RemoveObject(PERSISTENT_FIRST);
+  EXPECT_FALSE(cache_.GetObject(PERSISTENT_FIRST, nullptr, nullptr));
+  public_area_.type = TPM_ALG_ECC;
+  cache_.SetObject(PERSISTENT_FIRST, public_area_, "new_name");
+  TPMT_PUBLIC public_area;
+  std::string name;
+  EXPECT_TRUE(cache_.GetObject(PERSISTENT_FIRST, &public_area, &name));
+  EXPECT_EQ(TPM_ALG_ECC, public_area.type);
+  EXPECT_EQ("new_name", name);
+}
+
+TEST_F(TpmObjectCacheTest, NVPublicArea) {
+  uint32_t index = nv_public_area_.nv_index;
+  TPMS_NV_PUBLIC public_area;
+  EXPECT_FALSE(cache_.GetNVPublicArea(index, &public_area));
+  cache_.SetNVPublicArea(index, nv_public_area_);
+  cache_.UpdateNVAttributes(index, TPMA_NV_WRITTEN);
+  ASSERT_TRUE(cache_.GetNVPublicArea(index, &public_area));
+  EXPECT_EQ(TPMA_NV_OWNERWRITE | TPMA_NV_WRITTEN, public_area.attributes);
+  cache_.RemoveNVPublicArea(index);
+  EXPECT_FALSE(cache_.GetNVPublicArea(index, &public_area));
+  // Updating a space that isn't cached doesn't add it.
+  cache_.UpdateNVAttributes(index, TPMA_NV_WRITTEN);
+  EXPECT_FALSE(cache_.GetNVPublicArea(index, &public_area));
+}
+
+TEST_F(TpmObjectCacheTest, SealedObjectsDisabledByDefault) {
+  std::vector<TPM_HANDLE> evicted;
+  EXPECT_FALSE(cache_.AddSealedObject("digest", TRANSIENT_FIRST, &evicted));
+  EXPECT_TRUE(evicted.empty());
+  TPM_HANDLE handle;
+  EXPECT_FALSE(cache_.GetSealedObject("digest", &handle));
+}
+
+TEST_F(TpmObjectCacheTest, SealedObjectEviction) {
+  cache_.SetSealedObjectCacheSize(2);
+  std::vector<TPM_HANDLE> evicted;
+  EXPECT_TRUE(cache_.AddSealedObject("digest1", TRANSIENT_FIRST, &evicted));
+  cache_.ReleaseSealedObject("digest1", TRANSIENT_FIRST, &evicted);
+  EXPECT_TRUE(cache_.AddSealedObject("digest2", TRANSIENT_FIRST + 1, &evicted));
+  cache_.ReleaseSealedObject("digest2", TRANSIENT_FIRST + 1, &evicted);
+  EXPECT_TRUE(evicted.empty());
+  // Using digest1 makes digest2 the least recently used.
+  TPM_HANDLE handle;
+  EXPECT_TRUE(cache_.GetSealedObject("digest1", &handle));
+  EXPECT_EQ(TRANSIENT_FIRST, handle);
+  cache_.ReleaseSealedObject("digest1", TRANSIENT_FIRST, &evicted);
+  EXPECT_TRUE(cache_.AddSealedObject("digest3", TRANSIENT_FIRST + 2, &evicted));
+  ASSERT_EQ(1u, evicted.size());
+  EXPECT_EQ(TRANSIENT_FIRST + 1, evicted[0]);
+  EXPECT_FALSE(cache_.GetSealedObject("digest2", &handle));
+}
+
+TEST_F(TpmObjectCacheTest, PinnedSealedObjectNotEvicted) {
+  cache_.SetSealedObjectCacheSize(1);
+  std::vector<TPM_HANDLE> evicted;
+  EXPECT_TRUE(cache_.AddSealedObject("digest1", TRANSIENT_FIRST, &evicted));
+  // digest1 is still in use, so the cache grows past its size for now.
+  EXPECT_TRUE(cache_.AddSealedObject("digest2", TRANSIENT_FIRST + 1, &evicted));
+  EXPECT_TRUE(evicted.empty());
+  cache_.ReleaseSealedObject("digest2", TRANSIENT_FIRST + 1, &evicted);
+  EXPECT_TRUE(evicted.empty());
+  // Once released, the least recently used digest1 goes.
+  cache_.ReleaseSealedObject("digest1", TRANSIENT_FIRST, &evicted);
+  ASSERT_EQ(1u, evicted.size());
+  EXPECT_EQ(TRANSIENT_FIRST, evicted[0]);
+  TPM_HANDLE handle;
+  EXPECT_FALSE(cache_.GetSealedObject("digest1", &handle));
+  EXPECT_TRUE(cache_.GetSealedObject("digest2", &handle));
+}
+
+TEST_F(TpmObjectCacheTest, DuplicateSealedObjectKept) {
+  cache_.SetSealedObjectCacheSize(2);
+  std::vector<TPM_HANDLE> evicted;
+  EXPECT_TRUE(cache_.AddSealedObject("digest", TRANSIENT_FIRST, &evicted));
+  // A second load of the same blob leaves the first in place, since another
+  // caller may be using it. The second handle stays with its caller.
+  EXPECT_FALSE(cache_.AddSealedObject("digest", TRANSIENT_FIRST + 1, &evicted));
+  EXPECT_TRUE(evicted.empty());
+  TPM_HANDLE handle;
+  EXPECT_TRUE(cache_.GetSealedObject("digest", &handle));
+  EXPECT_EQ(TRANSIENT_FIRST, handle);
+  cache_.RemoveSealedObject("digest");
+  EXPECT_FALSE(cache_.GetSealedObject("digest", &handle));
+}
+
+TEST_F(TpmObjectCacheTest, Clear) {
+  cache_.SetObject(PERSISTENT_FIRST, public_area_, "name");
+  cache_.SetNVPublicArea(nv_public_area_.nv_index, nv_public_area_);
+  cache_.SetSealedObjectCacheSize(1);
+  std::vector<TPM_HANDLE> evicted;
+  cache_.AddSealedObject("digest", TRANSIENT_FIRST, &evicted);
+  cache_.Clear();
+  EXPECT_FALSE(cache_.GetObject(PERSISTENT_FIRST, nullptr, nullptr));
+  TPMS_NV_PUBLIC nv_public_area;
+  EXPECT_FALSE(
+      cache_.GetNVPublicArea(nv_public_area_.nv_index, &nv_public_area));
+  TPM_HANDLE handle;
+  EXPECT_FALSE(cache_.GetSealedObject("digest", &handle));
+}
+
+}  // namespace trunks
@@ -0,0 +1,350 @@
+//
+// Copyright (C) 2015 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/tpm_tis_spi.h"
+
+#include <endian.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <base/callback.h>
+#include <base/logging.h>
+#include <base/threading/platform_thread.h>
+
+#include "trunks/error_codes.h"
+
+namespace {
+
+// Assorted TPM2 registers for interface type FIFO.
+const uint32_t kTpmAccessReg = 0;
+const uint32_t kTpmStsReg = 0x18;
+const uint32_t kTpmDataFifoReg = 0x24;
+const uint32_t kTpmDidVidReg = 0xf00;
+const uint32_t kTpmRidReg = 0xf04;
+
+// Locality management bits (in kTpmAccessReg)
+enum TpmAccessBits {
+  tpmRegValidSts = (1 << 7),
+  activeLocality = (1 << 5),
+  requestUse = (1 << 1),
+  tpmEstablishment = (1 << 0),
+};
+
+enum TpmStsBits {
+  tpmFamilyShift = 26,
+  tpmFamilyMask = ((1 << 2) - 1),  // 2 bits wide
+  tpmFamilyTPM2 = 1,
+  resetEstablishmentBit = (1 << 25),
+  commandCancel = (1 << 24),
+  burstCountShift = 8,
+  burstCountMask = ((1 << 16) - 1),  // 16 bits wide
+  stsValid = (1 << 7),
+  commandReady = (1 << 6),
+  tpmGo = (1 << 5),
+  dataAvail = (1 << 4),
+  Expect = (1 << 3),
+  selfTestDone = (1 << 2),
+  responseRetry = (1 << 1),
+};
+
+// The response header is fixed to six bytes, the total response size is
+// stored in network order in the last four bytes of the header.
+const size_t kResponseHeaderSize = 6;
+// A response with the minimum required header and contents can not be less
+// than 10 bytes long.
+const size_t kMinResponseSize = 10;
+
+// Status polling starts at kMinPollInterval and doubles on each miss up to
+// kMaxPollInterval. Most commands complete within the first few polls.
+const int64_t kMinPollIntervalMicroseconds = 50;
+const int64_t kMaxPollIntervalMicroseconds = 10000;
+const int64_t kStatusTimeoutMilliseconds = 10000;
+
+}  // namespace
+
+namespace trunks {
+
+const size_t TpmTisSpi::kMaxFrameSize;
+
+TpmTisSpi::TpmTisSpi() : locality_(0) {}
+
+TpmTisSpi::~TpmTisSpi() {}
+
+base::TimeTicks TpmTisSpi::Now() {
+  return base::TimeTicks::Now();
+}
+
+void TpmTisSpi::Sleep(base::TimeDelta delay) {
+  base::PlatformThread::Sleep(delay);
+}
+
+bool TpmTisSpi::ReadReg(uint32_t reg_number, size_t bytes, void* buffer) {
+  return SpiRead(reg_number + locality_ * 0x10000, bytes,
+                 reinterpret_cast<uint8_t*>(buffer));
+}
+
+bool TpmTisSpi::WriteReg(uint32_t reg_number,
+                         size_t bytes,
+                         const void* buffer) {
+  return SpiWrite(reg_number + locality_ * 0x10000, bytes,
+                  reinterpret_cast<const uint8_t*>(buffer));
+}
+
+bool TpmTisSpi::ReadTpmSts(uint32_t* status) {
+  return ReadReg(kTpmStsReg, sizeof(*status), status);
+}
+
+bool TpmTisSpi::WriteTpmSts(uint32_t status) {
+  return WriteReg(kTpmStsReg, sizeof(status), &status);
+}
+
+bool TpmTisSpi::InitTpm() {
+  uint32_t did_vid, status;
+  uint8_t cmd;
+
+  if (!ReadReg(kTpmDidVidReg, sizeof(did_vid), &did_vid)) {
+    LOG(ERROR) << "failed to read did_vid";
+    return false;
+  }
+
+  uint16_t vid = did_vid & 0xffff;
+  if ((vid != 0x15d1) && (vid != 0x1ae0)) {
+    LOG(ERROR) << "unknown did_vid: 0x" << std::hex << did_vid;
+    return false;
+  }
+
+  // Try claiming locality zero.
+  ReadReg(kTpmAccessReg, sizeof(cmd), &cmd);
+  // tpmEstablishment can be either set or not.
+  if ((cmd & ~tpmEstablishment) != tpmRegValidSts) {
+    LOG(ERROR) << "invalid reset status: 0x" << std::hex << (unsigned)cmd;
+    return false;
+  }
+  cmd = requestUse;
+  WriteReg(kTpmAccessReg, sizeof(cmd), &cmd);
+  ReadReg(kTpmAccessReg, sizeof(cmd), &cmd);
+  if ((cmd & ~tpmEstablishment) != (tpmRegValidSts | activeLocality)) {
+    LOG(ERROR) << "failed to claim locality, status: 0x" << std::hex
+               << (unsigned)cmd;
+    return false;
+  }
+
+  ReadTpmSts(&status);
+  if (((status >> tpmFamilyShift) & tpmFamilyMask) != tpmFamilyTPM2) {
+    LOG(ERROR) << "unexpected TPM family value, status: 0x" << std::hex
+               << status;
+    return false;
+  }
+  ReadReg(kTpmRidReg, sizeof(cmd), &cmd);
+  LOG(INFO) << "Connected to device vid:did:rid of " << std::hex
+            << (did_vid & 0xffff) << ":" << (did_vid >> 16) << ":"
+            << (unsigned)cmd;
+  return true;
+}
+
+bool TpmTisSpi::WaitForStatus(uint32_t status_mask,
+                              uint32_t status_expected,
+                              base::TimeDelta timeout) {
+  uint32_t status;
+  base::TimeTicks deadline = Now() + timeout;
+  base::TimeDelta delay =
+      base::TimeDelta::FromMicroseconds(kMinPollIntervalMicroseconds);
+  const base::TimeDelta max_delay =
+      base::TimeDelta::FromMicroseconds(kMaxPollIntervalMicroseconds);
+
+  while (true) {
+    if (!ReadTpmSts(&status)) {
+      return false;
+    }
+    if ((status & status_mask) == status_expected) {
+      return true;
+    }
+    if (Now() >= deadline) {
+      LOG(ERROR) << "failed to get expected status " << std::hex
+                 << status_expected << ", last status " << status;
+      return false;
+    }
+    Sleep(delay);
+    delay = std::min(delay * 2, max_delay);
+  }
+}
+
+bool TpmTisSpi::WaitForBurstCount(size_t* burst_count) {
+  uint32_t status;
+  base::TimeTicks deadline =
+      Now() + base::TimeDelta::FromMilliseconds(kStatusTimeoutMilliseconds);
+  base::TimeDelta delay =
+      base::TimeDelta::FromMicroseconds(kMinPollIntervalMicroseconds);
+  const base::TimeDelta max_delay =
+      base::TimeDelta::FromMicroseconds(kMaxPollIntervalMicroseconds);
+
+  while (true) {
+    if (!ReadTpmSts(&status)) {
+      return false;
+    }
+    *burst_count = (status >> burstCountShift) & burstCountMask;
+    if (*burst_count) {
+      return true;
+    }
+    if (Now() >= deadline) {
+      LOG(ERROR) << "timed out waiting for non-zero burst count";
+      return false;
+    }
+    Sleep(delay);
+    delay = std::min(delay * 2, max_delay);
+  }
+}
+
+bool TpmTisSpi::WriteFifo(const uint8_t* data, size_t bytes) {
+  size_t handled_so_far = 0;
+  while (handled_so_far < bytes) {
+    size_t burst_count;
+    if (!WaitForBurstCount(&burst_count)) {
+      return false;
+    }
+    size_t burst_end = std::min(bytes, handled_so_far + burst_count);
+    while (handled_so_far < burst_end) {
+      size_t transaction_size =
+          std::min(burst_end - handled_so_far, kMaxFrameSize);
+      if (!WriteReg(kTpmDataFifoReg, transaction_size,
+                    data + handled_so_far)) {
+        return false;
+      }
+      handled_so_far += transaction_size;
+    }
+  }
+  return true;
+}
+
+bool TpmTisSpi::ReadFifo(uint8_t* data, size_t bytes) {
+  size_t handled_so_far = 0;
+  while (handled_so_far < bytes) {
+    size_t burst_count;
+    if (!WaitForBurstCount(&burst_count)) {
+      return false;
+    }
+    size_t burst_end = std::min(bytes, handled_so_far + burst_count);
+    while (handled_so_far < burst_end) {
+      size_t transaction_size =
+          std::min(burst_end - handled_so_far, kMaxFrameSize);
+      if (!ReadReg(kTpmDataFifoReg, transaction_size,
+                   data + handled_so_far)) {
+        return false;
+      }
+      handled_so_far += transaction_size;
+    }
+  }
+  return true;
+}
+
+void TpmTisSpi::SendCommand(const std::string& command,
+                            const ResponseCallback& callback) {
+  callback.Run(SendCommandAndWait(command));
+}
+
+std::string TpmTisSpi::SendCommandAndWait(const std::string& command) {
+  std::string response;
+  TPM_RC result = SendCommandInternal(command, &response);
+  if (result != TPM_RC_SUCCESS) {
+    response = CreateErrorResponse(result);
+  }
+  return response;
+}
+
+TPM_RC TpmTisSpi::SendCommandInternal(const std::string& command,
+                                      std::string* response) {
+  const base::TimeDelta timeout =
+      base::TimeDelta::FromMilliseconds(kStatusTimeoutMilliseconds);
+
+  if (!WriteTpmSts(commandReady)) {
+    return TRUNKS_RC_WRITE_ERROR;
+  }
+
+  // No need to wait for the sts.Expect bit to be set, let's just write the
+  // command into FIFO, one burst at a time.
+  if (!WriteFifo(reinterpret_cast<const uint8_t*>(command.data()),
+                 command.size())) {
+    LOG(ERROR) << "failed to write command to FIFO";
+    return TRUNKS_RC_WRITE_ERROR;
+  }
+
+  // And tell the device it can start processing it.
+  if (!WriteTpmSts(tpmGo)) {
+    return TRUNKS_RC_WRITE_ERROR;
+  }
+
+  uint32_t expected_status_bits = stsValid | dataAvail;
+  if (!WaitForStatus(expected_status_bits, expected_status_bits, timeout)) {
+    return TRUNKS_RC_READ_ERROR;
+  }
+
+  // The response is ready, let's read it. First we read the header, to see
+  // how much data to expect.
+  uint8_t data_header[kResponseHeaderSize];
+  if (!ReadFifo(data_header, sizeof(data_header))) {
+    return TRUNKS_RC_READ_ERROR;
+  }
+
+  uint32_t payload_size;
+  memcpy(&payload_size, data_header + 2, sizeof(payload_size));
+  payload_size = be32toh(payload_size);
+  if ((payload_size < kMinResponseSize) ||
+      (payload_size > MAX_RESPONSE_SIZE)) {
+    // Something must be wrong...
+    LOG(ERROR) << "Bad total payload size value: " << payload_size;
+    return TRUNKS_RC_READ_ERROR;
+  }
+  VLOG(1) << "Total payload size " << payload_size;
+
+  // Let's read all but the last byte in the FIFO to make sure the status
+  // register is showing correct flow control bits: 'more data' until the last
+  // byte and then 'no more data' once the last byte is read.
+  response->resize(payload_size);
+  memcpy(&(*response)[0], data_header, sizeof(data_header));
+  uint8_t* payload = reinterpret_cast<uint8_t*>(&(*response)[0]);
+  size_t last_byte = payload_size - 1;
+  if (!ReadFifo(payload + sizeof(data_header),
+                last_byte - sizeof(data_header))) {
+    return TRUNKS_RC_READ_ERROR;
+  }
+
+  // Verify that there is still data to come.
+  uint32_t status;
+  if (!ReadTpmSts(&status) ||
+      (status & expected_status_bits) != expected_status_bits) {
+    LOG(ERROR) << "unexpected status 0x" << std::hex << status;
+    return TRUNKS_RC_READ_ERROR;
+  }
+
+  // Now, read the last byte of the payload.
+  if (!ReadReg(kTpmDataFifoReg, sizeof(uint8_t), payload + last_byte)) {
+    return TRUNKS_RC_READ_ERROR;
+  }
+
+  // Verify that 'data available' is not asserted any more.
+  if (!ReadTpmSts(&status) ||
+      (status & expected_status_bits) != stsValid) {
+    LOG(ERROR) << "unexpected status 0x" << std::hex << status;
+    return TRUNKS_RC_READ_ERROR;
+  }
+
+  // Move the TPM back to idle state.
+  WriteTpmSts(commandReady);
+  return TPM_RC_SUCCESS;
+}
+
+}  // namespace trunks
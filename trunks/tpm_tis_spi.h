@@ -0,0 +1,105 @@
+//
+// Copyright (C) 2015 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef TRUNKS_TPM_TIS_SPI_H_
+#define TRUNKS_TPM_TIS_SPI_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include <base/macros.h>
+#include <base/time/time.h>
+
+#include "trunks/command_transceiver.h"
+#include "trunks/tpm_generated.h"
+#include "trunks/trunks_export.h"
+
+namespace trunks {
+
+// TpmTisSpi implements the FIFO interface described in the TCG issued "TPM
+// Profile (PTP) Specification Revision 00.43" on top of an abstract SPI bus.
+// Locality management, status polling, burst count handling and FIFO
+// transfers live here; derived classes only need to provide single SPI
+// register transactions (including SPI flow control) by implementing SpiRead
+// and SpiWrite.
+class TRUNKS_EXPORT TpmTisSpi : public CommandTransceiver {
+ public:
+  TpmTisSpi();
+  ~TpmTisSpi() override;
+
+  // CommandTransceiver methods. Commands are executed synchronously, the
+  // asynchronous SendCommand calls |callback| before returning.
+  void SendCommand(const std::string& command,
+                   const ResponseCallback& callback) override;
+  std::string SendCommandAndWait(const std::string& command) override;
+
+  // The largest payload a single SPI frame can carry: the size field of the
+  // SPI frame header is 6 bits wide.
+  static const size_t kMaxFrameSize = 64;
+
+ protected:
+  // Reads |bytes| (at most kMaxFrameSize) from the TPM address |addr| into
+  // |buffer| in a single SPI transaction. Returns true on success.
+  virtual bool SpiRead(uint32_t addr, size_t bytes, uint8_t* buffer) = 0;
+  // Writes |bytes| (at most kMaxFrameSize) from |buffer| to the TPM address
+  // |addr| in a single SPI transaction. Returns true on success.
+  virtual bool SpiWrite(uint32_t addr, size_t bytes, const uint8_t* buffer) = 0;
+
+  // Time source and delay used for status polling. These are virtual so that
+  // tests can run against a simulated clock.
+  virtual base::TimeTicks Now();
+  virtual void Sleep(base::TimeDelta delay);
+
+  // Verifies the device ID, claims locality zero and checks that the device
+  // reports a TPM2 family. Expected to be called from Init() of derived
+  // classes once the bus is up. Returns true on success.
+  bool InitTpm();
+
+ private:
+  // Read/write a TPM register of the current locality, where 'bytes' is the
+  // width of the register. Return true on success, false on failure.
+  bool ReadReg(uint32_t reg_number, size_t bytes, void* buffer);
+  bool WriteReg(uint32_t reg_number, size_t bytes, const void* buffer);
+  // TPM Status Register is going to be accessed a lot, let's have dedicated
+  // accessors for it.
+  bool ReadTpmSts(uint32_t* status);
+  bool WriteTpmSts(uint32_t status);
+  // Polls the status register until (status & |status_mask|) equals
+  // |status_expected| or |timeout| expires. The polling interval starts short
+  // and backs off exponentially, so fast commands are picked up quickly
+  // without hammering the bus during slow ones.
+  bool WaitForStatus(uint32_t status_mask,
+                     uint32_t status_expected,
+                     base::TimeDelta timeout);
+  // Waits for a non-zero burst count and returns it in |burst_count|.
+  bool WaitForBurstCount(size_t* burst_count);
+  // Transfers |bytes| to/from the data FIFO. Each time the burst count is
+  // read, the full burst is moved with back to back SPI frames before the
+  // status register is consulted again.
+  bool WriteFifo(const uint8_t* data, size_t bytes);
+  bool ReadFifo(uint8_t* data, size_t bytes);
+  TPM_RC SendCommandInternal(const std::string& command,
+                             std::string* response);
+
+  unsigned locality_;
+
+  DISALLOW_COPY_AND_ASSIGN(TpmTisSpi);
+};
+
+}  // namespace trunks
+
+#endif  // TRUNKS_TPM_TIS_SPI_H_
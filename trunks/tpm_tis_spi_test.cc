@@ -0,0 +1,269 @@
+//
+// Copyright (C) 2015 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/tpm_tis_spi.h"
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include <base/bind.h>
+#include <gtest/gtest.h>
+
+#include "trunks/error_codes.h"
+
+namespace {
+
+const uint32_t kAccessReg = 0;
+const uint32_t kStsReg = 0x18;
+const uint32_t kFifoReg = 0x24;
+const uint32_t kDidVidReg = 0xf00;
+const uint32_t kRidReg = 0xf04;
+
+const uint32_t kStsValid = 1 << 7;
+const uint32_t kCommandReady = 1 << 6;
+const uint32_t kTpmGo = 1 << 5;
+const uint32_t kDataAvail = 1 << 4;
+const uint32_t kFamilyTpm2 = 1 << 26;
+
+void Assign(std::string* to, const std::string& from) {
+  *to = from;
+}
+
+// A software model of the TIS register file of a TPM sitting behind SPI.
+// Every SPI transaction is counted, and the clock only advances when the
+// driver sleeps.
+class FakeTisSpi : public trunks::TpmTisSpi {
+ public:
+  FakeTisSpi()
+      : burst_count_(trunks::TpmTisSpi::kMaxFrameSize * 4),
+        busy_polls_(0),
+        access_(0x80),
+        polls_left_(0),
+        response_offset_(0),
+        read_frames_(0),
+        write_frames_(0) {}
+  ~FakeTisSpi() override {}
+
+  bool Init() override { return InitTpm(); }
+
+  void set_response(const std::string& response) { response_ = response; }
+  void set_burst_count(size_t burst_count) { burst_count_ = burst_count; }
+  // The number of status reads after tpmGo before dataAvail is reported.
+  void set_busy_polls(int busy_polls) { busy_polls_ = busy_polls; }
+
+  const std::string& command() const { return command_; }
+  int read_frames() const { return read_frames_; }
+  int write_frames() const { return write_frames_; }
+  const std::vector<base::TimeDelta>& sleeps() const { return sleeps_; }
+  base::TimeDelta elapsed() const { return now_ - base::TimeTicks(); }
+
+ protected:
+  bool SpiRead(uint32_t addr, size_t bytes, uint8_t* buffer) override {
+    EXPECT_LE(bytes, kMaxFrameSize);
+    read_frames_++;
+    switch (addr) {
+      case kAccessReg:
+        memcpy(buffer, &access_, bytes);
+        return true;
+      case kStsReg: {
+        uint32_t status = Status();
+        memcpy(buffer, &status, bytes);
+        return true;
+      }
+      case kFifoReg:
+        if (!DataAvailable() || response_.size() - response_offset_ < bytes)
+          return false;
+        memcpy(buffer, response_.data() + response_offset_, bytes);
+        response_offset_ += bytes;
+        return true;
+      case kDidVidReg: {
+        uint32_t did_vid = 0x0028 << 16 | 0x1ae0;
+        memcpy(buffer, &did_vid, bytes);
+        return true;
+      }
+      case kRidReg:
+        memset(buffer, 0, bytes);
+        return true;
+    }
+    return false;
+  }
+
+  bool SpiWrite(uint32_t addr, size_t bytes, const uint8_t* buffer) override {
+    EXPECT_LE(bytes, kMaxFrameSize);
+    write_frames_++;
+    switch (addr) {
+      case kAccessReg:
+        access_ = 0x80 | 0x20;
+        return true;
+      case kStsReg: {
+        uint32_t status;
+        memcpy(&status, buffer, sizeof(status));
+        if (status & kCommandReady) {
+          command_.clear();
+          response_offset_ = 0;
+        }
+        if (status & kTpmGo)
+          polls_left_ = busy_polls_;
+        return true;
+      }
+      case kFifoReg:
+        command_.append(reinterpret_cast<const char*>(buffer), bytes);
+        return true;
+    }
+    return false;
+  }
+
+  base::TimeTicks Now() override { return now_; }
+  void Sleep(base::TimeDelta delay) override {
+    sleeps_.push_back(delay);
+    now_ += delay;
+  }
+
+ private:
+  bool DataAvailable() const {
+    return polls_left_ == 0 && response_offset_ < response_.size();
+  }
+
+  uint32_t Status() {
+    uint32_t status = kFamilyTpm2 | kStsValid |
+                      static_cast<uint32_t>(burst_count_) << 8;
+    if (polls_left_ > 0) {
+      polls_left_--;
+      return kFamilyTpm2 | kStsValid;
+    }
+    if (DataAvailable())
+      status |= kDataAvail;
+    return status;
+  }
+
+  size_t burst_count_;
+  int busy_polls_;
+  uint8_t access_;
+  int polls_left_;
+  std::string command_;
+  std::string response_;
+  size_t response_offset_;
+  int read_frames_;
+  int write_frames_;
+  base::TimeTicks now_;
+  std::vector<base::TimeDelta> sleeps_;
+};
+
+// Builds a response of |size| bytes with a valid header.
+std::string MakeResponse(uint32_t size) {
+  std::string response(size, 'r');
+  response[0] = 0x80;
+  response[1] = 0x01;
+  for (int i = 0; i < 4; i++)
+    response[2 + i] = (size >> (8 * (3 - i))) & 0xff;
+  return response;
+}
+
+}  // namespace
+
+namespace trunks {
+
+class TpmTisSpiTest : public testing::Test {
+ public:
+  TpmTisSpiTest() {}
+  ~TpmTisSpiTest() override {}
+
+  void SetUp() override { ASSERT_TRUE(tpm_.Init()); }
+
+ protected:
+  FakeTisSpi tpm_;
+};
+
+TEST_F(TpmTisSpiTest, SendCommandAndWait) {
+  std::string command(20, 'c');
+  std::string response = MakeResponse(30);
+  tpm_.set_response(response);
+  EXPECT_EQ(response, tpm_.SendCommandAndWait(command));
+  EXPECT_EQ(command, tpm_.command());
+}
+
+TEST_F(TpmTisSpiTest, SendCommandRunsCallback) {
+  std::string response = MakeResponse(10);
+  tpm_.set_response(response);
+  std::string output;
+  tpm_.SendCommand("command", base::Bind(Assign, &output));
+  EXPECT_EQ(response, output);
+}
+
+TEST_F(TpmTisSpiTest, FullBurstTransfers) {
+  // With a 256 byte burst count, a 1000 byte command needs four status reads
+  // and 16 back to back FIFO frames, rather than one status read per frame.
+  std::string command(1000, 'c');
+  tpm_.set_response(MakeResponse(10));
+  int writes_before = tpm_.write_frames();
+  int reads_before = tpm_.read_frames();
+  tpm_.SendCommandAndWait(command);
+  EXPECT_EQ(command, tpm_.command());
+  // commandReady + 16 FIFO frames + tpmGo + final commandReady.
+  EXPECT_EQ(19, tpm_.write_frames() - writes_before);
+  // 4 burst count reads for the command, then wait status, burst count and
+  // header, burst count and body, status, last byte, status.
+  EXPECT_EQ(12, tpm_.read_frames() - reads_before);
+}
+
+TEST_F(TpmTisSpiTest, SmallBurstCount) {
+  std::string command(100, 'c');
+  std::string response = MakeResponse(100);
+  tpm_.set_burst_count(7);
+  tpm_.set_response(response);
+  EXPECT_EQ(response, tpm_.SendCommandAndWait(command));
+  EXPECT_EQ(command, tpm_.command());
+}
+
+TEST_F(TpmTisSpiTest, FastCommandDoesNotSleepLong) {
+  tpm_.set_busy_polls(3);
+  std::string response = MakeResponse(10);
+  tpm_.set_response(response);
+  EXPECT_EQ(response, tpm_.SendCommandAndWait("command"));
+  ASSERT_EQ(3u, tpm_.sleeps().size());
+  EXPECT_LT(tpm_.elapsed(), base::TimeDelta::FromMilliseconds(1));
+}
+
+TEST_F(TpmTisSpiTest, PollingBacksOff) {
+  tpm_.set_busy_polls(20);
+  tpm_.set_response(MakeResponse(10));
+  tpm_.SendCommandAndWait("command");
+  const std::vector<base::TimeDelta>& sleeps = tpm_.sleeps();
+  ASSERT_EQ(20u, sleeps.size());
+  for (size_t i = 1; i < sleeps.size(); i++) {
+    EXPECT_GE(sleeps[i], sleeps[i - 1]);
+  }
+  EXPECT_LE(sleeps.back(), base::TimeDelta::FromMilliseconds(10));
+}
+
+TEST_F(TpmTisSpiTest, Timeout) {
+  tpm_.set_busy_polls(1000000);
+  tpm_.set_response(MakeResponse(10));
+  std::string response = tpm_.SendCommandAndWait("command");
+  EXPECT_EQ(CreateErrorResponse(TRUNKS_RC_READ_ERROR), response);
+  EXPECT_GE(tpm_.elapsed(), base::TimeDelta::FromSeconds(10));
+  EXPECT_LT(tpm_.elapsed(), base::TimeDelta::FromSeconds(11));
+}
+
+TEST_F(TpmTisSpiTest, BadResponseSize) {
+  tpm_.set_response(MakeResponse(8));
+  EXPECT_EQ(CreateErrorResponse(TRUNKS_RC_READ_ERROR),
+            tpm_.SendCommandAndWait("command"));
+}
+
+}  // namespace trunks
@@ -17,12 +17,15 @@
 #ifndef TRUNKS_TPM_UTILITY_H_
 #define TRUNKS_TPM_UTILITY_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include <base/callback.h>
 #include <base/macros.h>
 
 #include "trunks/hmac_session.h"
+#include "trunks/tpm_event_log.h"
 #include "trunks/tpm_generated.h"
 #include "trunks/trunks_export.h"
 
@@ -42,6 +45,37 @@ class TRUNKS_EXPORT TpmUtility {
  public:
   enum AsymmetricKeyUsage { kDecryptKey, kSignKey, kDecryptAndSignKey };
 
+  // Opaque state of an in-progress streaming signature. Instances are created
+  // by SignStreamBegin and may only be passed back to the TpmUtility that
+  // created them.
+  class SignStream {
+   public:
+    virtual ~SignStream() {}
+  };
+
+  // An external RSA key for ImportRSAKeys. The fields have the same meaning as
+  // the arguments of ImportRSAKey.
+  struct RSAKeyImport {
+    AsymmetricKeyUsage key_type;
+    std::string modulus;
+    uint32_t public_exponent;
+    std::string prime_factor;
+    std::string password;
+  };
+
+  // Called by ImportRSAKeys with the number of keys handled so far and the
+  // total number of keys.
+  using ImportProgressCallback = base::Callback<void(size_t, size_t)>;
+
+  // A measurement for ExtendPCRs.
+  struct PCREvent {
+    int pcr_index;
+    // The TCG event type recorded in the event log, e.g. EV_IPL (0xD).
+    uint32_t event_type;
+    // The measured data. Each PCR bank is extended with its digest of this.
+    std::string event_data;
+  };
+
   TpmUtility() {}
   virtual ~TpmUtility() {}
 
@@ -81,8 +115,11 @@ class TRUNKS_EXPORT TpmUtility {
   virtual TPM_RC StirRandom(const std::string& entropy_data,
                             AuthorizationDelegate* delegate) = 0;
 
-  // This method returns |num_bytes| of random data generated by the tpm.
-  // |delegate| specifies an optional authorization delegate to be used.
+  // This method returns |num_bytes| of random data generated by the tpm. If
+  // the factory's HmacDrbg has been configured the data comes from the DRBG,
+  // which is seeded with TPM random data as needed; otherwise every byte is
+  // read from the tpm. |delegate| specifies an optional authorization delegate
+  // to be used for the tpm calls.
   virtual TPM_RC GenerateRandom(size_t num_bytes,
                                 AuthorizationDelegate* delegate,
                                 std::string* random_data) = 0;
@@ -95,6 +132,19 @@ class TRUNKS_EXPORT TpmUtility {
                            const std::string& extend_data,
                            AuthorizationDelegate* delegate) = 0;
 
+  // Extends the PCR of each of |events|, in order, in every allocated PCR bank
+  // with that bank's digest of the event data. Each event carries a digest for
+  // every bank that has any PCR allocated. The PCR_Extend commands are
+  // streamed without waiting for each response, so |delegate| must not depend
+  // on earlier responses; an HMAC session cannot be used. If |delegate| is
+  // null the empty password is used. If |event_log| is not null, every event
+  // that was extended is appended to it; nothing is extended if the log was
+  // started with a different set of banks. Returns the error of the first
+  // event that failed.
+  virtual TPM_RC ExtendPCRs(const std::vector<PCREvent>& events,
+                            AuthorizationDelegate* delegate,
+                            TpmEventLog* event_log) = 0;
+
   // This method reads the pcr specified by |pcr_index| and returns its value
   // in |pcr_value|. NOTE: it assumes we are using SHA256 as our hash alg.
   virtual TPM_RC ReadPCR(int pcr_index, std::string* pcr_value) = 0;
@@ -126,9 +176,11 @@ class TRUNKS_EXPORT TpmUtility {
   // This method takes an unrestricted signing key referenced by |key_handle|
   // and uses it to sign the hash of |plaintext|. The signature produced is
   // returned using the |signature| argument. |scheme| is used to specify the
-  // signature scheme used. By default it is TPM_ALG_RSASSA, but TPM_ALG_RSAPPS
-  // can be specified. |hash_alg| is the algorithm used in the signing
-  // operation. It is by default TPM_ALG_SHA256.
+  // signature scheme used. For RSA keys it is by default TPM_ALG_RSASSA, but
+  // TPM_ALG_RSAPPS can be specified. ECC keys must be on the NIST P-256 curve
+  // and only support TPM_ALG_ECDSA, which is also their default; the signature
+  // is the raw r and s values, 32 bytes each. |hash_alg| is the algorithm used
+  // in the signing operation. It is by default TPM_ALG_SHA256.
   // |delegate| is an AuthorizationDelegate used to authorize this command.
   virtual TPM_RC Sign(TPM_HANDLE key_handle,
                       TPM_ALG_ID scheme,
@@ -137,12 +189,55 @@ class TRUNKS_EXPORT TpmUtility {
                       AuthorizationDelegate* delegate,
                       std::string* signature) = 0;
 
+  // This method signs each of the precomputed |digests| with the unrestricted
+  // signing key |key_handle|. |scheme|, |hash_alg| and |delegate| have the
+  // same meaning as for Sign. The key is validated once for the whole batch,
+  // which makes this much cheaper than calling Sign repeatedly. On return
+  // |signatures| and |results| have one entry per digest; a failed item has
+  // an empty signature and its error code in |results|; a digest whose size
+  // does not match |hash_alg| fails with SAPI_RC_BAD_SIZE. Returns
+  // TPM_RC_SUCCESS if every digest was signed, otherwise the first error.
+  virtual TPM_RC SignBatch(TPM_HANDLE key_handle,
+                           TPM_ALG_ID scheme,
+                           TPM_ALG_ID hash_alg,
+                           const std::vector<std::string>& digests,
+                           AuthorizationDelegate* delegate,
+                           std::vector<std::string>* signatures,
+                           std::vector<TPM_RC>* results) = 0;
+
+  // These methods sign the hash of a plaintext that is fed in pieces, so the
+  // memory used stays constant regardless of the size of the input.
+  // SignStreamBegin validates |key_handle| and sets up |stream|; |scheme|,
+  // |hash_alg| and |delegate| have the same meaning as for Sign, and
+  // |delegate| must remain valid until the stream is finished or destroyed.
+  // When |use_tpm_hash_sequence| is false the data is hashed in software.
+  // When it is true the data is hashed by the TPM with a hash sequence and
+  // the resulting hashcheck ticket is passed to the sign command; this is
+  // slower but is required to sign with a restricted key.
+  virtual TPM_RC SignStreamBegin(TPM_HANDLE key_handle,
+                                 TPM_ALG_ID scheme,
+                                 TPM_ALG_ID hash_alg,
+                                 bool use_tpm_hash_sequence,
+                                 AuthorizationDelegate* delegate,
+                                 std::unique_ptr<SignStream>* stream) = 0;
+
+  // Feeds the next piece of plaintext |data| into |stream|.
+  virtual TPM_RC SignStreamUpdate(SignStream* stream,
+                                  const std::string& data) = 0;
+
+  // Completes the hash of |stream| and signs it. The signature is returned
+  // in |signature|. The stream can not be used afterwards.
+  virtual TPM_RC SignStreamFinish(SignStream* stream,
+                                  std::string* signature) = 0;
+
   // This method verifies that the signature produced on the plaintext was
   // performed by |key_handle|. |scheme| and |hash| refer to the signature
   // scheme used to sign the hash of |plaintext| and produce the signature.
   // This value is by default TPM_ALG_RSASSA with TPM_ALG_SHA256 but can take
   // the value of TPM_ALG_RSAPPS with other hash algorithms supported by the
-  // tpm. Returns TPM_RC_SUCCESS when the signature is correct.
+  // tpm. For ECC keys the scheme is TPM_ALG_ECDSA and |signature| is in the
+  // format produced by Sign. Returns TPM_RC_SUCCESS when the signature is
+  // correct.
   // |delegate| specifies an optional authorization delegate to be used.
   virtual TPM_RC Verify(TPM_HANDLE key_handle,
                         TPM_ALG_ID scheme,
@@ -151,6 +246,13 @@ class TRUNKS_EXPORT TpmUtility {
                         const std::string& signature,
                         AuthorizationDelegate* delegate) = 0;
 
+  // This method enables or disables running the public key operations of
+  // AsymmetricEncrypt and Verify in software with the public area of the key,
+  // instead of sending RSA_Encrypt and VerifySignature to the TPM. The results
+  // match those of the TPM commands. Keys that carry their own scheme always
+  // use the TPM. Disabled by default.
+  virtual void SetSoftwarePublicKeyOperations(bool enabled) = 0;
+
   // This method is used to check if a key was created in the TPM. |key_handle|
   // refers to a loaded Tpm2.0 object, and |creation_blob| is the blob
   // generated when the object was created. Returns TPM_RC_SUCCESS iff the
@@ -181,6 +283,19 @@ class TRUNKS_EXPORT TpmUtility {
                               AuthorizationDelegate* delegate,
                               std::string* key_blob) = 0;
 
+  // Imports every key in |keys| like ImportRSAKey. The software wrapping of
+  // the keys runs on worker threads while the calling thread sends the Import
+  // commands to the TPM in order. |progress|, if not null, is run on the
+  // calling thread after each key. On return |results| and |key_blobs| hold
+  // the result and key blob of each key, in the order of |keys|. Returns
+  // TPM_RC_SUCCESS if every key was imported and otherwise the error of the
+  // first key that failed.
+  virtual TPM_RC ImportRSAKeys(const std::vector<RSAKeyImport>& keys,
+                               AuthorizationDelegate* delegate,
+                               const ImportProgressCallback& progress,
+                               std::vector<TPM_RC>* results,
+                               std::vector<std::string>* key_blobs) = 0;
+
   // This method uses the TPM to generates an RSA key of type |key_type|.
   // |modulus_bits| is used to specify the size of the modulus, and
   // |public_exponent| specifies the exponent of the key. After this function
@@ -207,6 +322,27 @@ class TRUNKS_EXPORT TpmUtility {
                                   std::string* key_blob,
                                   std::string* creation_blob) = 0;
 
+  // This method uses the TPM to generate an ECC key of type |key_type| on the
+  // NIST P-256 curve. The key is a child of the ECC storage root key; LoadKey
+  // picks the parent from the type of the key blob. The other arguments have
+  // the same meaning as for CreateRSAKeyPair.
+  virtual TPM_RC CreateECCKeyPair(AsymmetricKeyUsage key_type,
+                                  const std::string& password,
+                                  const std::string& policy_digest,
+                                  bool use_only_policy_authorization,
+                                  int creation_pcr_index,
+                                  AuthorizationDelegate* delegate,
+                                  std::string* key_blob,
+                                  std::string* creation_blob) = 0;
+
+  // This method generates one key for the factory's RsaKeyPool if the pool is
+  // enabled, has been idle for long enough and is short of keys. It does
+  // nothing and returns TPM_RC_SUCCESS otherwise, so it can be called
+  // periodically from an idle task. While the pool has keys for a template,
+  // CreateRSAKeyPair serves requests without a policy, policy-only
+  // authorization or creation PCR from it.
+  virtual TPM_RC FillRSAKeyPool() = 0;
+
   // This method loads a pregenerated TPM key into the TPM. |key_blob| contains
   // the blob returned by a key creation function. The loaded key's handle is
   // returned using |key_handle|.
@@ -16,25 +16,39 @@
 
 #include "trunks/tpm_utility_impl.h"
 
+#include <algorithm>
 #include <memory>
+#include <utility>
 
+#include <base/bind.h>
 #include <base/logging.h>
 #include <base/sha1.h>
 #include <base/stl_util.h>
+#include <base/synchronization/waitable_event.h>
+#include <base/sys_info.h>
+#include <base/threading/thread.h>
 #include <crypto/openssl_util.h>
 #include <crypto/secure_hash.h>
 #include <crypto/sha2.h>
 #include <openssl/aes.h>
+#include <openssl/bn.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
 #include <openssl/rand.h>
+#include <openssl/rsa.h>
+#include <openssl/sha.h>
 
 #include "trunks/authorization_delegate.h"
 #include "trunks/blob_parser.h"
 #include "trunks/error_codes.h"
 #include "trunks/hmac_authorization_delegate.h"
+#include "trunks/hmac_drbg.h"
 #include "trunks/hmac_session.h"
 #include "trunks/policy_session.h"
+#include "trunks/rsa_key_pool.h"
 #include "trunks/scoped_key_handle.h"
 #include "trunks/tpm_constants.h"
+#include "trunks/tpm_object_cache.h"
 #include "trunks/tpm_state.h"
 #include "trunks/trunks_factory.h"
 
@@ -45,6 +59,12 @@ const char kWellKnownPassword[] = "cros-password";
 const size_t kMaxPasswordLength = 32;
 // The below maximum is defined in TPM 2.0 Library Spec Part 2 Section 13.1
 const uint32_t kMaxNVSpaceIndex = (1 << 24) - 1;
+// The most worker threads ImportRSAKeys uses to prepare keys.
+const size_t kMaxImportThreads = 4;
+// The size of a NIST P-256 coordinate, and of each half of an ECDSA signature.
+const size_t kECCP256ParameterSize = 32;
+// The RSA public exponent used when a public area specifies 0.
+const uint32_t kDefaultRSAExponent = 0x10001;
 
 // Returns a serialized representation of the unmodified handle. This is useful
 // for predefined handle values, like TPM_RH_OWNER. For details on what types of
@@ -68,10 +88,212 @@ std::string HashString(const std::string& plaintext,
   return std::string();
 }
 
+// Stores the result of |task| in |result| and signals |event|.
+void RunAndSignal(const base::Callback<trunks::TPM_RC()>& task,
+                  trunks::TPM_RC* result,
+                  base::WaitableEvent* event) {
+  *result = task.Run();
+  event->Signal();
+}
+
+// Returns |parameter| as a big-endian value of kECCP256ParameterSize bytes.
+std::string PadECCParameter(const trunks::TPM2B_ECC_PARAMETER& parameter) {
+  std::string value = trunks::StringFrom_TPM2B_ECC_PARAMETER(parameter);
+  if (value.size() < kECCP256ParameterSize) {
+    value.insert(0, kECCP256ParameterSize - value.size(), 0);
+  }
+  return value;
+}
+
+// Returns the size of a |hash_alg| digest, or zero if |hash_alg| is not a
+// known hash algorithm.
+size_t GetDigestSize(trunks::TPM_ALG_ID hash_alg) {
+  switch (hash_alg) {
+    case trunks::TPM_ALG_SHA1:
+      return SHA1_DIGEST_SIZE;
+    case trunks::TPM_ALG_SHA256:
+      return SHA256_DIGEST_SIZE;
+    case trunks::TPM_ALG_SHA384:
+      return SHA384_DIGEST_SIZE;
+    case trunks::TPM_ALG_SHA512:
+      return SHA512_DIGEST_SIZE;
+  }
+  return 0;
+}
+
+// Returns the OpenSSL digest for |hash_alg|, or nullptr if it has none.
+const EVP_MD* GetOpenSSLDigest(trunks::TPM_ALG_ID hash_alg) {
+  switch (hash_alg) {
+    case trunks::TPM_ALG_SHA1:
+      return EVP_sha1();
+    case trunks::TPM_ALG_SHA256:
+      return EVP_sha256();
+  }
+  return nullptr;
+}
+
+// Returns the OpenSSL digest for a PCR bank of |hash_alg|, or nullptr if it
+// has none.
+const EVP_MD* GetPCRBankDigest(trunks::TPM_ALG_ID hash_alg) {
+  switch (hash_alg) {
+    case trunks::TPM_ALG_SHA1:
+      return EVP_sha1();
+    case trunks::TPM_ALG_SHA256:
+      return EVP_sha256();
+    case trunks::TPM_ALG_SHA384:
+      return EVP_sha384();
+    case trunks::TPM_ALG_SHA512:
+      return EVP_sha512();
+  }
+  return nullptr;
+}
+
+// Creates an OpenSSL public key from the |public_area| of an RSA key. Returns
+// nullptr on failure.
+bssl::UniquePtr<EVP_PKEY> CreateRSAPublicKey(
+    const trunks::TPMT_PUBLIC& public_area) {
+  bssl::UniquePtr<RSA> rsa(RSA_new());
+  if (!rsa) {
+    return nullptr;
+  }
+  rsa->e = BN_new();
+  if (!rsa->e) {
+    return nullptr;
+  }
+  uint32_t exponent = public_area.parameters.rsa_detail.exponent;
+  BN_set_word(rsa->e, exponent ? exponent : kDefaultRSAExponent);
+  rsa->n = BN_bin2bn(public_area.unique.rsa.buffer, public_area.unique.rsa.size,
+                     nullptr);
+  if (!rsa->n) {
+    return nullptr;
+  }
+  bssl::UniquePtr<EVP_PKEY> key(EVP_PKEY_new());
+  if (!key || !EVP_PKEY_set1_RSA(key.get(), rsa.get())) {
+    return nullptr;
+  }
+  return key;
+}
+
+// Encrypts |plaintext| with the key in |public_area| like TPM2_RSA_Encrypt
+// with |scheme| and an empty label.
+trunks::TPM_RC SoftwareRSAEncrypt(const trunks::TPMT_PUBLIC& public_area,
+                                  const trunks::TPMT_RSA_DECRYPT& scheme,
+                                  const std::string& plaintext,
+                                  std::string* ciphertext) {
+  bssl::UniquePtr<EVP_PKEY> key = CreateRSAPublicKey(public_area);
+  if (!key) {
+    LOG(ERROR) << __func__ << ": Error creating RSA public key.";
+    return trunks::TPM_RC_FAILURE;
+  }
+  bssl::UniquePtr<EVP_PKEY_CTX> context(EVP_PKEY_CTX_new(key.get(), nullptr));
+  if (!context || !EVP_PKEY_encrypt_init(context.get())) {
+    LOG(ERROR) << __func__ << ": Error setting up encrypt context.";
+    return trunks::TPM_RC_FAILURE;
+  }
+  if (scheme.scheme == trunks::TPM_ALG_OAEP) {
+    const EVP_MD* digest = GetOpenSSLDigest(scheme.details.oaep.hash_alg);
+    if (!EVP_PKEY_CTX_set_rsa_padding(context.get(), RSA_PKCS1_OAEP_PADDING) ||
+        !EVP_PKEY_CTX_set_rsa_oaep_md(context.get(), digest) ||
+        !EVP_PKEY_CTX_set_rsa_mgf1_md(context.get(), digest)) {
+      LOG(ERROR) << __func__ << ": Error setting up OAEP padding.";
+      return trunks::TPM_RC_FAILURE;
+    }
+  } else if (!EVP_PKEY_CTX_set_rsa_padding(context.get(), RSA_PKCS1_PADDING)) {
+    LOG(ERROR) << __func__ << ": Error setting up PKCS#1 padding.";
+    return trunks::TPM_RC_FAILURE;
+  }
+  size_t out_length = EVP_PKEY_size(key.get());
+  ciphertext->resize(out_length);
+  if (!EVP_PKEY_encrypt(
+          context.get(),
+          reinterpret_cast<uint8_t*>(base::string_as_array(ciphertext)),
+          &out_length, reinterpret_cast<const uint8_t*>(plaintext.data()),
+          plaintext.size())) {
+    // The plaintext does not fit the key and padding, which the TPM reports
+    // as TPM_RC_VALUE.
+    ERR_clear_error();
+    ciphertext->clear();
+    LOG(ERROR) << __func__ << ": Plaintext too large for key.";
+    return trunks::TPM_RC_VALUE;
+  }
+  ciphertext->resize(out_length);
+  return trunks::TPM_RC_SUCCESS;
+}
+
+// Verifies |signature| over |digest| with the key in |public_area| like
+// TPM2_VerifySignature. For RSAPSS any salt length is accepted, as on the TPM.
+trunks::TPM_RC SoftwareVerifySignature(const trunks::TPMT_PUBLIC& public_area,
+                                       trunks::TPM_ALG_ID scheme,
+                                       trunks::TPM_ALG_ID hash_alg,
+                                       const std::string& digest,
+                                       const std::string& signature) {
+  bssl::UniquePtr<EVP_PKEY> key = CreateRSAPublicKey(public_area);
+  if (!key) {
+    LOG(ERROR) << __func__ << ": Error creating RSA public key.";
+    return trunks::TPM_RC_FAILURE;
+  }
+  bssl::UniquePtr<EVP_PKEY_CTX> context(EVP_PKEY_CTX_new(key.get(), nullptr));
+  if (!context || !EVP_PKEY_verify_init(context.get()) ||
+      !EVP_PKEY_CTX_set_signature_md(context.get(),
+                                     GetOpenSSLDigest(hash_alg))) {
+    LOG(ERROR) << __func__ << ": Error setting up verify context.";
+    return trunks::TPM_RC_FAILURE;
+  }
+  if (scheme == trunks::TPM_ALG_RSAPSS) {
+    if (!EVP_PKEY_CTX_set_rsa_padding(context.get(), RSA_PKCS1_PSS_PADDING) ||
+        !EVP_PKEY_CTX_set_rsa_pss_saltlen(context.get(), -2)) {
+      LOG(ERROR) << __func__ << ": Error setting up PSS padding.";
+      return trunks::TPM_RC_FAILURE;
+    }
+  } else if (!EVP_PKEY_CTX_set_rsa_padding(context.get(), RSA_PKCS1_PADDING)) {
+    LOG(ERROR) << __func__ << ": Error setting up PKCS#1 padding.";
+    return trunks::TPM_RC_FAILURE;
+  }
+  if (EVP_PKEY_verify(context.get(),
+                      reinterpret_cast<const uint8_t*>(signature.data()),
+                      signature.size(),
+                      reinterpret_cast<const uint8_t*>(digest.data()),
+                      digest.size()) != 1) {
+    ERR_clear_error();
+    return trunks::TPM_RC_SIGNATURE;
+  }
+  return trunks::TPM_RC_SUCCESS;
+}
+
 }  // namespace
 
 namespace trunks {
 
+// The state behind a TpmUtility::SignStream. Exactly one of the software hash
+// contexts or the TPM hash sequence is in use, depending on how the stream
+// was started.
+struct SignStreamImpl : public TpmUtility::SignStream {
+  explicit SignStreamImpl(Tpm* tpm) : tpm(tpm) {}
+
+  ~SignStreamImpl() override {
+    // An unfinished TPM hash sequence occupies an object slot until flushed.
+    if (sequence_handle != 0) {
+      tpm->FlushContextSync(sequence_handle, nullptr);
+    }
+  }
+
+  Tpm* tpm;
+  TPM_HANDLE key_handle = 0;
+  std::string key_name;
+  TPMT_SIG_SCHEME in_scheme;
+  TPM_ALG_ID hash_alg = TPM_ALG_NULL;
+  AuthorizationDelegate* delegate = nullptr;
+  bool finished = false;
+  SHA_CTX sha1_context;
+  SHA256_CTX sha256_context;
+  TPMI_DH_OBJECT sequence_handle = 0;
+  // The hierarchy of the hashcheck ticket requested from SequenceComplete.
+  TPMI_RH_HIERARCHY ticket_hierarchy = TPM_RH_NULL;
+  // Data not yet sent to the TPM hash sequence, never more than
+  // MAX_DIGEST_BUFFER bytes.
+  std::string pending;
+};
+
 TpmUtilityImpl::TpmUtilityImpl(const TrunksFactory& factory)
     : factory_(factory) {
   crypto::EnsureOpenSSLInit();
@@ -120,8 +342,13 @@ TPM_RC TpmUtilityImpl::Clear() {
   if (result) {
     LOG(ERROR) << __func__
                << ": Failed to clear the TPM: " << GetErrorString(result);
+    return result;
   }
-  return result;
+  // Persistent objects and NV spaces of the owner hierarchy are gone, and so
+  // is the SRK that pooled keys were created under.
+  factory_.GetObjectCache()->Clear();
+  factory_.GetRsaKeyPool()->Clear();
+  return TPM_RC_SUCCESS;
 }
 
 void TpmUtilityImpl::Shutdown() {
@@ -322,13 +549,48 @@ TPM_RC TpmUtilityImpl::StirRandom(const std::string& entropy_data,
                                   AuthorizationDelegate* delegate) {
   std::string digest = crypto::SHA256HashString(entropy_data);
   TPM2B_SENSITIVE_DATA random_bytes = Make_TPM2B_SENSITIVE_DATA(digest);
-  return factory_.GetTpm()->StirRandomSync(random_bytes, delegate);
+  TPM_RC result = factory_.GetTpm()->StirRandomSync(random_bytes, delegate);
+  if (result == TPM_RC_SUCCESS) {
+    factory_.GetDrbg()->AddInput(digest);
+  }
+  return result;
 }
 
 TPM_RC TpmUtilityImpl::GenerateRandom(size_t num_bytes,
                                       AuthorizationDelegate* delegate,
                                       std::string* random_data) {
   CHECK(random_data);
+  HmacDrbg* drbg = factory_.GetDrbg();
+  if (!drbg->IsEnabled()) {
+    return GetRandomFromTpm(num_bytes, delegate, random_data);
+  }
+  std::string seed;
+  TPM_RC result;
+  if (drbg->NeedsReseed()) {
+    result = GetRandomFromTpm(HmacDrbg::kSeedSize, delegate, &seed);
+    if (result != TPM_RC_SUCCESS) {
+      return result;
+    }
+  }
+  if (drbg->Generate(num_bytes, seed, random_data)) {
+    return TPM_RC_SUCCESS;
+  }
+  // Another thread used up the seed or reconfigured the DRBG in the meantime.
+  if (seed.empty()) {
+    result = GetRandomFromTpm(HmacDrbg::kSeedSize, delegate, &seed);
+    if (result != TPM_RC_SUCCESS) {
+      return result;
+    }
+    if (drbg->Generate(num_bytes, seed, random_data)) {
+      return TPM_RC_SUCCESS;
+    }
+  }
+  return GetRandomFromTpm(num_bytes, delegate, random_data);
+}
+
+TPM_RC TpmUtilityImpl::GetRandomFromTpm(size_t num_bytes,
+                                        AuthorizationDelegate* delegate,
+                                        std::string* random_data) {
   size_t bytes_left = num_bytes;
   random_data->clear();
   TPM_RC rc;
@@ -369,6 +631,117 @@ TPM_RC TpmUtilityImpl::ExtendPCR(int pcr_index,
                                            delegate);
 }
 
+TPM_RC TpmUtilityImpl::ExtendPCRs(const std::vector<PCREvent>& events,
+                                  AuthorizationDelegate* delegate,
+                                  TpmEventLog* event_log) {
+  if (events.empty()) {
+    return TPM_RC_SUCCESS;
+  }
+  TPMI_YES_NO more_data = YES;
+  TPMS_CAPABILITY_DATA capability_data;
+  TPM_RC result = factory_.GetTpm()->GetCapabilitySync(
+      TPM_CAP_PCRS, 0 /*property (not used)*/, 1 /*property_count*/, &more_data,
+      &capability_data, nullptr /*authorization_delegate*/);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << __func__
+               << ": Error querying PCRs: " << GetErrorString(result);
+    return result;
+  }
+  // Every event carries a digest for every allocated bank, so the log replays
+  // against all of them. The TPM ignores digests for banks where the PCR
+  // itself isn't allocated.
+  const TPML_PCR_SELECTION& assigned = capability_data.data.assigned_pcr;
+  std::vector<TPMI_ALG_HASH> banks;
+  for (uint32_t i = 0; i < assigned.count && i < HASH_COUNT; ++i) {
+    const TPMS_PCR_SELECTION& bank = assigned.pcr_selections[i];
+    for (uint8_t j = 0; j < bank.sizeof_select && j < PCR_SELECT_MAX; ++j) {
+      if (bank.pcr_select[j]) {
+        banks.push_back(bank.hash);
+        break;
+      }
+    }
+  }
+  if (banks.empty()) {
+    LOG(ERROR) << __func__ << ": No PCR banks are allocated.";
+    return TPM_RC_FAILURE;
+  }
+  std::unique_ptr<AuthorizationDelegate> empty_password_delegate =
+      factory_.GetPasswordAuthorization("");
+  if (!delegate) {
+    delegate = empty_password_delegate.get();
+  }
+  // Hash and serialize everything first so the commands go out back to back.
+  std::vector<TPML_DIGEST_VALUES> event_digests(events.size());
+  std::vector<std::string> commands(events.size());
+  for (size_t i = 0; i < events.size(); ++i) {
+    int pcr_index = events[i].pcr_index;
+    if (pcr_index < 0 || pcr_index >= IMPLEMENTATION_PCR) {
+      LOG(ERROR) << __func__ << ": Using a PCR index that isn't implemented.";
+      return TPM_RC_FAILURE;
+    }
+    TPML_DIGEST_VALUES& digests = event_digests[i];
+    memset(&digests, 0, sizeof(digests));
+    for (TPMI_ALG_HASH bank : banks) {
+      const EVP_MD* md = GetPCRBankDigest(bank);
+      if (!md) {
+        LOG(ERROR) << __func__ << ": Unsupported PCR bank: " << bank;
+        return TPM_RC_FAILURE;
+      }
+      TPMT_HA& digest = digests.digests[digests.count++];
+      digest.hash_alg = bank;
+      const std::string& data = events[i].event_data;
+      if (!EVP_Digest(data.data(), data.size(),
+                      reinterpret_cast<unsigned char*>(&digest.digest),
+                      nullptr, md, nullptr)) {
+        LOG(ERROR) << __func__ << ": Error computing PCR digest.";
+        return TPM_RC_FAILURE;
+      }
+    }
+    TPM_HANDLE pcr_handle = HR_PCR + pcr_index;
+    result = Tpm::SerializeCommand_PCR_Extend(pcr_handle,
+                                              NameFromHandle(pcr_handle),
+                                              digests, &commands[i], delegate);
+    if (result != TPM_RC_SUCCESS) {
+      LOG(ERROR) << __func__ << ": Error serializing PCR_Extend: "
+                 << GetErrorString(result);
+      return result;
+    }
+  }
+  // Don't extend anything that couldn't be logged.
+  if (event_log && !event_log->MatchesAlgorithms(event_digests[0])) {
+    LOG(ERROR) << __func__
+               << ": The event log was started with different PCR banks.";
+    return TPM_RC_FAILURE;
+  }
+  std::vector<std::string> responses =
+      factory_.GetTpm()->SendCommandsAndWait(commands);
+  if (responses.size() != commands.size()) {
+    LOG(ERROR) << __func__ << ": Missing PCR_Extend responses.";
+    return TPM_RC_FAILURE;
+  }
+  TPM_RC first_error = TPM_RC_SUCCESS;
+  for (size_t i = 0; i < events.size(); ++i) {
+    result = Tpm::ParseResponse_PCR_Extend(responses[i], delegate);
+    if (result != TPM_RC_SUCCESS) {
+      LOG(ERROR) << __func__ << ": Error extending PCR "
+                 << events[i].pcr_index << ": " << GetErrorString(result);
+      if (first_error == TPM_RC_SUCCESS) {
+        first_error = result;
+      }
+      continue;
+    }
+    // Log every event that reached the PCRs, even after a failure, so the log
+    // can still be replayed.
+    if (event_log &&
+        !event_log->AppendEvent(events[i].pcr_index, events[i].event_type,
+                                event_digests[i], events[i].event_data) &&
+        first_error == TPM_RC_SUCCESS) {
+      first_error = TPM_RC_FAILURE;
+    }
+  }
+  return first_error;
+}
+
 TPM_RC TpmUtilityImpl::ReadPCR(int pcr_index, std::string* pcr_value) {
   TPML_PCR_SELECTION pcr_select_in;
   uint32_t pcr_update_counter;
@@ -441,6 +814,11 @@ TPM_RC TpmUtilityImpl::AsymmetricEncrypt(TPM_HANDLE key_handle,
                << ": Cannot use RSAES for encryption with a restricted key";
     return SAPI_RC_BAD_PARAMETER;
   }
+  if (software_public_key_operations_ &&
+      public_area.parameters.rsa_detail.scheme.scheme == TPM_ALG_NULL &&
+      (in_scheme.scheme == TPM_ALG_RSAES || GetOpenSSLDigest(hash_alg))) {
+    return SoftwareRSAEncrypt(public_area, in_scheme, plaintext, ciphertext);
+  }
   std::string key_name;
   result = ComputeKeyName(public_area, &key_name);
   if (result != TPM_RC_SUCCESS) {
@@ -538,19 +916,7 @@ TPM_RC TpmUtilityImpl::Sign(TPM_HANDLE key_handle,
                             AuthorizationDelegate* delegate,
                             std::string* signature) {
   TPMT_SIG_SCHEME in_scheme;
-  if (hash_alg == TPM_ALG_NULL) {
-    hash_alg = TPM_ALG_SHA256;
-  }
-  if (scheme == TPM_ALG_RSAPSS) {
-    in_scheme.scheme = TPM_ALG_RSAPSS;
-    in_scheme.details.rsapss.hash_alg = hash_alg;
-  } else if (scheme == TPM_ALG_RSASSA || scheme == TPM_ALG_NULL) {
-    in_scheme.scheme = TPM_ALG_RSASSA;
-    in_scheme.details.rsassa.hash_alg = hash_alg;
-  } else {
-    LOG(ERROR) << __func__ << ": Invalid Signing scheme used.";
-    return SAPI_RC_BAD_PARAMETER;
-  }
+  std::string key_name;
   TPM_RC result;
   if (delegate == nullptr) {
     result = SAPI_RC_INVALID_SESSIONS;
@@ -559,55 +925,219 @@ TPM_RC TpmUtilityImpl::Sign(TPM_HANDLE key_handle,
                << GetErrorString(result);
     return result;
   }
-  TPMT_PUBLIC public_area;
-  result = GetKeyPublicArea(key_handle, &public_area);
+  result = PrepareSign(key_handle, scheme, false /* allow_restricted */,
+                       &hash_alg, &in_scheme, &key_name, nullptr);
   if (result) {
-    LOG(ERROR) << __func__ << ": Error finding public area for: " << key_handle;
     return result;
-  } else if (public_area.type != TPM_ALG_RSA) {
-    LOG(ERROR) << __func__ << ": Key handle given is not an RSA key";
-    return SAPI_RC_BAD_PARAMETER;
-  } else if ((public_area.object_attributes & kSign) == 0) {
-    LOG(ERROR) << __func__ << ": Key handle given is not a signging key";
-    return SAPI_RC_BAD_PARAMETER;
-  } else if ((public_area.object_attributes & kRestricted) != 0) {
-    LOG(ERROR) << __func__ << ": Key handle references a restricted key";
-    return SAPI_RC_BAD_PARAMETER;
   }
+  std::string digest = HashString(plaintext, hash_alg);
+  TPMT_TK_HASHCHECK validation;
+  validation.tag = TPM_ST_HASHCHECK;
+  validation.hierarchy = TPM_RH_NULL;
+  validation.digest.size = 0;
+  return SignDigest(key_handle, key_name, digest, in_scheme, validation,
+                    delegate, signature);
+}
 
+TPM_RC TpmUtilityImpl::SignBatch(TPM_HANDLE key_handle,
+                                 TPM_ALG_ID scheme,
+                                 TPM_ALG_ID hash_alg,
+                                 const std::vector<std::string>& digests,
+                                 AuthorizationDelegate* delegate,
+                                 std::vector<std::string>* signatures,
+                                 std::vector<TPM_RC>* results) {
+  TPMT_SIG_SCHEME in_scheme;
   std::string key_name;
-  result = ComputeKeyName(public_area, &key_name);
+  TPM_RC result;
+  if (delegate == nullptr) {
+    result = SAPI_RC_INVALID_SESSIONS;
+    LOG(ERROR) << __func__
+               << ": This method needs a valid authorization delegate: "
+               << GetErrorString(result);
+    return result;
+  }
+  result = PrepareSign(key_handle, scheme, false /* allow_restricted */,
+                       &hash_alg, &in_scheme, &key_name, nullptr);
   if (result) {
-    LOG(ERROR) << __func__ << ": Error computing key name for: " << key_handle;
     return result;
   }
-  std::string digest = HashString(plaintext, hash_alg);
-  TPM2B_DIGEST tpm_digest = Make_TPM2B_DIGEST(digest);
-  TPMT_SIGNATURE signature_out;
   TPMT_TK_HASHCHECK validation;
   validation.tag = TPM_ST_HASHCHECK;
   validation.hierarchy = TPM_RH_NULL;
   validation.digest.size = 0;
-  result =
-      factory_.GetTpm()->SignSync(key_handle, key_name, tpm_digest, in_scheme,
-                                  validation, &signature_out, delegate);
-  if (result) {
+  signatures->clear();
+  signatures->resize(digests.size());
+  results->assign(digests.size(), TPM_RC_SUCCESS);
+  TPM_RC first_error = TPM_RC_SUCCESS;
+  // The commands are issued back to back: each one carries the session nonce
+  // returned by the previous response, so they can't be sent concurrently.
+  size_t digest_size = GetDigestSize(hash_alg);
+  for (size_t i = 0; i < digests.size(); ++i) {
+    if (digests[i].size() != digest_size) {
+      LOG(ERROR) << __func__ << ": Digest " << i << " has the wrong size for "
+                 << "hash algorithm " << hash_alg << ": " << digests[i].size();
+      result = SAPI_RC_BAD_SIZE;
+    } else {
+      result = SignDigest(key_handle, key_name, digests[i], in_scheme,
+                          validation, delegate, &(*signatures)[i]);
+    }
+    if (result) {
+      (*signatures)[i].clear();
+      (*results)[i] = result;
+      if (first_error == TPM_RC_SUCCESS) {
+        first_error = result;
+      }
+    }
+  }
+  return first_error;
+}
+
+TPM_RC TpmUtilityImpl::SignStreamBegin(TPM_HANDLE key_handle,
+                                       TPM_ALG_ID scheme,
+                                       TPM_ALG_ID hash_alg,
+                                       bool use_tpm_hash_sequence,
+                                       AuthorizationDelegate* delegate,
+                                       std::unique_ptr<SignStream>* stream) {
+  TPM_RC result;
+  if (delegate == nullptr) {
+    result = SAPI_RC_INVALID_SESSIONS;
     LOG(ERROR) << __func__
-               << ": Error signing digest: " << GetErrorString(result);
+               << ": This method needs a valid authorization delegate: "
+               << GetErrorString(result);
     return result;
   }
-  if (scheme == TPM_ALG_RSAPSS) {
-    signature->resize(signature_out.signature.rsapss.sig.size);
-    signature->assign(
-        StringFrom_TPM2B_PUBLIC_KEY_RSA(signature_out.signature.rsapss.sig));
+  std::unique_ptr<SignStreamImpl> impl(new SignStreamImpl(factory_.GetTpm()));
+  bool restricted = false;
+  result = PrepareSign(key_handle, scheme, use_tpm_hash_sequence, &hash_alg,
+                       &impl->in_scheme, &impl->key_name, &restricted);
+  if (result) {
+    return result;
+  }
+  impl->key_handle = key_handle;
+  impl->hash_alg = hash_alg;
+  impl->delegate = delegate;
+  if (use_tpm_hash_sequence) {
+    // Only a restricted key checks the ticket, and it needs one from its own
+    // hierarchy. TpmUtility keeps keys under the storage root keys, which
+    // are in the owner hierarchy. Other keys get a null ticket, so signing
+    // still works if the owner hierarchy has been disabled.
+    if (restricted) {
+      impl->ticket_hierarchy = TPM_RH_OWNER;
+    }
+    TPM2B_AUTH sequence_auth = Make_TPM2B_DIGEST("");
+    result = factory_.GetTpm()->HashSequenceStartSync(
+        sequence_auth, hash_alg, &impl->sequence_handle, nullptr);
+    if (result) {
+      LOG(ERROR) << __func__ << ": Error starting hash sequence: "
+                 << GetErrorString(result);
+      impl->sequence_handle = 0;
+      return result;
+    }
+  } else if (hash_alg == TPM_ALG_SHA1) {
+    SHA1_Init(&impl->sha1_context);
+  } else if (hash_alg == TPM_ALG_SHA256) {
+    SHA256_Init(&impl->sha256_context);
   } else {
-    signature->resize(signature_out.signature.rsassa.sig.size);
-    signature->assign(
-        StringFrom_TPM2B_PUBLIC_KEY_RSA(signature_out.signature.rsassa.sig));
+    LOG(ERROR) << __func__ << ": Unsupported hash algorithm: " << hash_alg;
+    return SAPI_RC_BAD_PARAMETER;
+  }
+  stream->reset(impl.release());
+  return TPM_RC_SUCCESS;
+}
+
+TPM_RC TpmUtilityImpl::SignStreamUpdate(SignStream* stream,
+                                        const std::string& data) {
+  SignStreamImpl* impl = static_cast<SignStreamImpl*>(stream);
+  if (impl == nullptr || impl->finished) {
+    LOG(ERROR) << __func__ << ": Invalid sign stream.";
+    return SAPI_RC_BAD_PARAMETER;
+  }
+  if (impl->sequence_handle == 0) {
+    if (impl->hash_alg == TPM_ALG_SHA1) {
+      SHA1_Update(&impl->sha1_context, data.data(), data.size());
+    } else {
+      SHA256_Update(&impl->sha256_context, data.data(), data.size());
+    }
+    return TPM_RC_SUCCESS;
+  }
+  // Only whole MAX_DIGEST_BUFFER chunks are sent, the remainder waits for
+  // the next update or goes out with SequenceComplete.
+  size_t offset = 0;
+  while (offset < data.size()) {
+    size_t chunk_size = std::min(data.size() - offset,
+                                 MAX_DIGEST_BUFFER - impl->pending.size());
+    impl->pending.append(data, offset, chunk_size);
+    offset += chunk_size;
+    if (impl->pending.size() == MAX_DIGEST_BUFFER) {
+      TPM_RC result = FlushSignStreamBuffer(impl);
+      if (result) {
+        return result;
+      }
+    }
   }
   return TPM_RC_SUCCESS;
 }
 
+TPM_RC TpmUtilityImpl::SignStreamFinish(SignStream* stream,
+                                        std::string* signature) {
+  SignStreamImpl* impl = static_cast<SignStreamImpl*>(stream);
+  if (impl == nullptr || impl->finished) {
+    LOG(ERROR) << __func__ << ": Invalid sign stream.";
+    return SAPI_RC_BAD_PARAMETER;
+  }
+  impl->finished = true;
+  std::string digest;
+  TPMT_TK_HASHCHECK validation;
+  if (impl->sequence_handle == 0) {
+    if (impl->hash_alg == TPM_ALG_SHA1) {
+      unsigned char sha1[SHA_DIGEST_LENGTH];
+      SHA1_Final(sha1, &impl->sha1_context);
+      digest.assign(reinterpret_cast<char*>(sha1), sizeof(sha1));
+    } else {
+      unsigned char sha256[SHA256_DIGEST_LENGTH];
+      SHA256_Final(sha256, &impl->sha256_context);
+      digest.assign(reinterpret_cast<char*>(sha256), sizeof(sha256));
+    }
+    validation.tag = TPM_ST_HASHCHECK;
+    validation.hierarchy = TPM_RH_NULL;
+    validation.digest.size = 0;
+  } else {
+    std::unique_ptr<AuthorizationDelegate> sequence_delegate =
+        factory_.GetPasswordAuthorization("");
+    TPM2B_DIGEST tpm_digest;
+    TPM_RC result = factory_.GetTpm()->SequenceCompleteSync(
+        impl->sequence_handle, "", Make_TPM2B_MAX_BUFFER(impl->pending),
+        impl->ticket_hierarchy, &tpm_digest, &validation,
+        sequence_delegate.get());
+    if (result) {
+      LOG(ERROR) << __func__ << ": Error completing hash sequence: "
+                 << GetErrorString(result);
+      return result;
+    }
+    // SequenceComplete flushes the sequence object.
+    impl->sequence_handle = 0;
+    impl->pending.clear();
+    digest = StringFrom_TPM2B_DIGEST(tpm_digest);
+  }
+  return SignDigest(impl->key_handle, impl->key_name, digest, impl->in_scheme,
+                    validation, impl->delegate, signature);
+}
+
+TPM_RC TpmUtilityImpl::FlushSignStreamBuffer(SignStreamImpl* stream) {
+  std::unique_ptr<AuthorizationDelegate> sequence_delegate =
+      factory_.GetPasswordAuthorization("");
+  TPM_RC result = factory_.GetTpm()->SequenceUpdateSync(
+      stream->sequence_handle, "", Make_TPM2B_MAX_BUFFER(stream->pending),
+      sequence_delegate.get());
+  if (result) {
+    LOG(ERROR) << __func__ << ": Error updating hash sequence: "
+               << GetErrorString(result);
+    return result;
+  }
+  stream->pending.clear();
+  return TPM_RC_SUCCESS;
+}
+
 TPM_RC TpmUtilityImpl::Verify(TPM_HANDLE key_handle,
                               TPM_ALG_ID scheme,
                               TPM_ALG_ID hash_alg,
@@ -619,8 +1149,9 @@ TPM_RC TpmUtilityImpl::Verify(TPM_HANDLE key_handle,
   if (return_code) {
     LOG(ERROR) << __func__ << ": Error finding public area for: " << key_handle;
     return return_code;
-  } else if (public_area.type != TPM_ALG_RSA) {
-    LOG(ERROR) << __func__ << ": Key handle given is not an RSA key";
+  } else if (public_area.type != TPM_ALG_RSA &&
+             public_area.type != TPM_ALG_ECC) {
+    LOG(ERROR) << __func__ << ": Key handle given is not an RSA or ECC key";
     return SAPI_RC_BAD_PARAMETER;
   } else if ((public_area.object_attributes & kSign) == 0) {
     LOG(ERROR) << __func__ << ": Key handle given is not a signing key";
@@ -635,7 +1166,24 @@ TPM_RC TpmUtilityImpl::Verify(TPM_HANDLE key_handle,
   }
 
   TPMT_SIGNATURE signature_in;
-  if (scheme == TPM_ALG_RSAPSS) {
+  if (public_area.type == TPM_ALG_ECC) {
+    if (public_area.parameters.ecc_detail.curve_id != TPM_ECC_NIST_P256) {
+      LOG(ERROR) << __func__ << ": Only NIST P-256 ECC keys are supported";
+      return SAPI_RC_BAD_PARAMETER;
+    } else if (scheme != TPM_ALG_ECDSA && scheme != TPM_ALG_NULL) {
+      LOG(ERROR) << __func__ << ": Invalid scheme used to verify signature.";
+      return SAPI_RC_BAD_PARAMETER;
+    } else if (signature.size() != 2 * kECCP256ParameterSize) {
+      LOG(WARNING) << __func__ << ": Malformed ECDSA signature.";
+      return TPM_RC_SIGNATURE;
+    }
+    signature_in.sig_alg = TPM_ALG_ECDSA;
+    signature_in.signature.ecdsa.hash = hash_alg;
+    signature_in.signature.ecdsa.signature_r = Make_TPM2B_ECC_PARAMETER(
+        signature.substr(0, kECCP256ParameterSize));
+    signature_in.signature.ecdsa.signature_s = Make_TPM2B_ECC_PARAMETER(
+        signature.substr(kECCP256ParameterSize));
+  } else if (scheme == TPM_ALG_RSAPSS) {
     signature_in.sig_alg = TPM_ALG_RSAPSS;
     signature_in.signature.rsapss.hash = hash_alg;
     signature_in.signature.rsapss.sig = Make_TPM2B_PUBLIC_KEY_RSA(signature);
@@ -647,9 +1195,21 @@ TPM_RC TpmUtilityImpl::Verify(TPM_HANDLE key_handle,
     LOG(ERROR) << __func__ << ": Invalid scheme used to verify signature.";
     return SAPI_RC_BAD_PARAMETER;
   }
+  std::string digest = HashString(plaintext, hash_alg);
+  if (software_public_key_operations_ && public_area.type == TPM_ALG_RSA &&
+      public_area.parameters.rsa_detail.scheme.scheme == TPM_ALG_NULL &&
+      GetOpenSSLDigest(hash_alg)) {
+    // The TPMT_TK_VERIFIED ticket is not returned to callers, so the result
+    // is the same without the TPM.
+    return_code = SoftwareVerifySignature(public_area, signature_in.sig_alg,
+                                          hash_alg, digest, signature);
+    if (return_code == TPM_RC_SIGNATURE) {
+      LOG(WARNING) << __func__ << ": Incorrect signature for given digest.";
+    }
+    return return_code;
+  }
   std::string key_name;
   TPMT_TK_VERIFIED verified;
-  std::string digest = HashString(plaintext, hash_alg);
   TPM2B_DIGEST tpm_digest = Make_TPM2B_DIGEST(digest);
   return_code = factory_.GetTpm()->VerifySignatureSync(
       key_handle, key_name, tpm_digest, signature_in, &verified, delegate);
@@ -664,6 +1224,10 @@ TPM_RC TpmUtilityImpl::Verify(TPM_HANDLE key_handle,
   return TPM_RC_SUCCESS;
 }
 
+void TpmUtilityImpl::SetSoftwarePublicKeyOperations(bool enabled) {
+  software_public_key_operations_ = enabled;
+}
+
 TPM_RC TpmUtilityImpl::CertifyCreation(TPM_HANDLE key_handle,
                                        const std::string& creation_blob) {
   TPM2B_CREATION_DATA creation_data;
@@ -767,9 +1331,96 @@ TPM_RC TpmUtilityImpl::ImportRSAKey(AsymmetricKeyUsage key_type,
                << GetErrorString(result);
     return result;
   }
+  RSAKeyImport key = {key_type, modulus, public_exponent, prime_factor,
+                      password};
+  PreparedImport prepared;
+  result = PrepareRSAKeyImport(key, &prepared);
+  if (result != TPM_RC_SUCCESS) {
+    return result;
+  }
+  return SendKeyImport(parent_name, prepared, delegate, key_blob);
+}
+
+TPM_RC TpmUtilityImpl::ImportRSAKeys(const std::vector<RSAKeyImport>& keys,
+                                     AuthorizationDelegate* delegate,
+                                     const ImportProgressCallback& progress,
+                                     std::vector<TPM_RC>* results,
+                                     std::vector<std::string>* key_blobs) {
+  CHECK(results);
+  CHECK(key_blobs);
+  TPM_RC result;
+  if (delegate == nullptr) {
+    result = SAPI_RC_INVALID_SESSIONS;
+    LOG(ERROR) << __func__
+               << ": This method needs a valid authorization delegate: "
+               << GetErrorString(result);
+    return result;
+  }
+  std::string parent_name;
+  result = GetKeyName(kRSAStorageRootKey, &parent_name);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << __func__ << ": Error getting Key name for RSA-SRK: "
+               << GetErrorString(result);
+    return result;
+  }
+  results->assign(keys.size(), TPM_RC_SUCCESS);
+  key_blobs->assign(keys.size(), std::string());
+  // Keys are handed to the workers round-robin and imported in order, so the
+  // TPM is kept busy as long as the workers stay ahead of it.
+  size_t num_workers = std::min<size_t>(
+      std::min<size_t>(base::SysInfo::NumberOfProcessors(), kMaxImportThreads),
+      keys.size());
+  std::vector<std::unique_ptr<base::Thread>> workers;
+  for (size_t i = 0; i < num_workers; ++i) {
+    std::unique_ptr<base::Thread> worker(new base::Thread("trunks_import"));
+    if (!worker->Start()) {
+      LOG(WARNING) << __func__ << ": Failed to start import thread.";
+      break;
+    }
+    workers.push_back(std::move(worker));
+  }
+  std::vector<PreparedImport> prepared(keys.size());
+  std::vector<std::unique_ptr<base::WaitableEvent>> prepared_events;
+  if (!workers.empty()) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      prepared_events.emplace_back(new base::WaitableEvent(
+          base::WaitableEvent::ResetPolicy::MANUAL,
+          base::WaitableEvent::InitialState::NOT_SIGNALED));
+      workers[i % workers.size()]->task_runner()->PostTask(
+          FROM_HERE,
+          base::Bind(&RunAndSignal,
+                     base::Bind(&TpmUtilityImpl::PrepareRSAKeyImport,
+                                base::Unretained(this), base::ConstRef(keys[i]),
+                                &prepared[i]),
+                     &(*results)[i], prepared_events[i].get()));
+    }
+  }
+  TPM_RC first_error = TPM_RC_SUCCESS;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (workers.empty()) {
+      (*results)[i] = PrepareRSAKeyImport(keys[i], &prepared[i]);
+    } else {
+      prepared_events[i]->Wait();
+    }
+    if ((*results)[i] == TPM_RC_SUCCESS) {
+      (*results)[i] = SendKeyImport(parent_name, prepared[i], delegate,
+                                    &(*key_blobs)[i]);
+    }
+    if ((*results)[i] != TPM_RC_SUCCESS && first_error == TPM_RC_SUCCESS) {
+      first_error = (*results)[i];
+    }
+    if (!progress.is_null()) {
+      progress.Run(i + 1, keys.size());
+    }
+  }
+  return first_error;
+}
+
+TPM_RC TpmUtilityImpl::PrepareRSAKeyImport(const RSAKeyImport& key,
+                                           PreparedImport* prepared) {
   TPMT_PUBLIC public_area = CreateDefaultPublicArea(TPM_ALG_RSA);
   public_area.object_attributes = kUserWithAuth | kNoDA;
-  switch (key_type) {
+  switch (key.key_type) {
     case AsymmetricKeyUsage::kDecryptKey:
       public_area.object_attributes |= kDecrypt;
       break;
@@ -780,37 +1431,46 @@ TPM_RC TpmUtilityImpl::ImportRSAKey(AsymmetricKeyUsage key_type,
       public_area.object_attributes |= (kSign | kDecrypt);
       break;
   }
-  public_area.parameters.rsa_detail.key_bits = modulus.size() * 8;
-  public_area.parameters.rsa_detail.exponent = public_exponent;
-  public_area.unique.rsa = Make_TPM2B_PUBLIC_KEY_RSA(modulus);
-  TPM2B_DATA encryption_key;
-  encryption_key.size = kAesKeySize;
-  CHECK_EQ(RAND_bytes(encryption_key.buffer, encryption_key.size), 1)
+  public_area.parameters.rsa_detail.key_bits = key.modulus.size() * 8;
+  public_area.parameters.rsa_detail.exponent = key.public_exponent;
+  public_area.unique.rsa = Make_TPM2B_PUBLIC_KEY_RSA(key.modulus);
+  prepared->encryption_key.size = kAesKeySize;
+  CHECK_EQ(RAND_bytes(prepared->encryption_key.buffer,
+                      prepared->encryption_key.size),
+           1)
       << "Error generating a cryptographically random Aes Key.";
-  TPM2B_PUBLIC public_data = Make_TPM2B_PUBLIC(public_area);
-  TPM2B_ENCRYPTED_SECRET in_sym_seed = Make_TPM2B_ENCRYPTED_SECRET("");
-  TPMT_SYM_DEF_OBJECT symmetric_alg;
-  symmetric_alg.algorithm = TPM_ALG_AES;
-  symmetric_alg.key_bits.aes = kAesKeySize * 8;
-  symmetric_alg.mode.aes = TPM_ALG_CFB;
+  prepared->public_data = Make_TPM2B_PUBLIC(public_area);
   TPMT_SENSITIVE in_sensitive;
   in_sensitive.sensitive_type = TPM_ALG_RSA;
-  in_sensitive.auth_value = Make_TPM2B_DIGEST(password);
+  in_sensitive.auth_value = Make_TPM2B_DIGEST(key.password);
   in_sensitive.seed_value = Make_TPM2B_DIGEST("");
-  in_sensitive.sensitive.rsa = Make_TPM2B_PRIVATE_KEY_RSA(prime_factor);
-  TPM2B_PRIVATE private_data;
-  result = EncryptPrivateData(in_sensitive, public_area, &private_data,
-                              &encryption_key);
+  in_sensitive.sensitive.rsa = Make_TPM2B_PRIVATE_KEY_RSA(key.prime_factor);
+  TPM_RC result = EncryptPrivateData(in_sensitive, public_area,
+                                     &prepared->private_data,
+                                     &prepared->encryption_key);
   if (result != TPM_RC_SUCCESS) {
     LOG(ERROR) << __func__ << ": Error creating encrypted private struct: "
                << GetErrorString(result);
     return result;
   }
+  return TPM_RC_SUCCESS;
+}
+
+TPM_RC TpmUtilityImpl::SendKeyImport(const std::string& parent_name,
+                                     const PreparedImport& prepared,
+                                     AuthorizationDelegate* delegate,
+                                     std::string* key_blob) {
+  TPM2B_ENCRYPTED_SECRET in_sym_seed = Make_TPM2B_ENCRYPTED_SECRET("");
+  TPMT_SYM_DEF_OBJECT symmetric_alg;
+  symmetric_alg.algorithm = TPM_ALG_AES;
+  symmetric_alg.key_bits.aes = kAesKeySize * 8;
+  symmetric_alg.mode.aes = TPM_ALG_CFB;
   TPM2B_PRIVATE tpm_private_data;
   tpm_private_data.size = 0;
-  result = factory_.GetTpm()->ImportSync(
-      kRSAStorageRootKey, parent_name, encryption_key, public_data,
-      private_data, in_sym_seed, symmetric_alg, &tpm_private_data, delegate);
+  TPM_RC result = factory_.GetTpm()->ImportSync(
+      kRSAStorageRootKey, parent_name, prepared.encryption_key,
+      prepared.public_data, prepared.private_data, in_sym_seed, symmetric_alg,
+      &tpm_private_data, delegate);
   if (result != TPM_RC_SUCCESS) {
     LOG(ERROR) << __func__
                << ": Error importing key: " << GetErrorString(result);
@@ -818,7 +1478,7 @@ TPM_RC TpmUtilityImpl::ImportRSAKey(AsymmetricKeyUsage key_type,
   }
   if (key_blob) {
     if (!factory_.GetBlobParser()->SerializeKeyBlob(
-            public_data, tpm_private_data, key_blob)) {
+            prepared.public_data, tpm_private_data, key_blob)) {
       return SAPI_RC_BAD_TCTI_STRUCTURE;
     }
   }
@@ -836,22 +1496,175 @@ TPM_RC TpmUtilityImpl::CreateRSAKeyPair(AsymmetricKeyUsage key_type,
                                         std::string* key_blob,
                                         std::string* creation_blob) {
   CHECK(key_blob);
-  TPM_RC result;
   if (delegate == nullptr) {
-    result = SAPI_RC_INVALID_SESSIONS;
+    TPM_RC result = SAPI_RC_INVALID_SESSIONS;
     LOG(ERROR) << __func__
                << ": This method needs a valid authorization delegate: "
                << GetErrorString(result);
     return result;
   }
+  // Pooled keys are created without a policy or creation PCR, and allow
+  // authorization with their authorization value (userWithAuth).
+  if (policy_digest.empty() && !use_only_policy_authorization &&
+      creation_pcr_index == kNoCreationPCR &&
+      TakePooledRSAKey(key_type, modulus_bits, public_exponent, password,
+                       delegate, key_blob, creation_blob)) {
+    return TPM_RC_SUCCESS;
+  }
+  return GenerateRSAKeyPair(key_type, modulus_bits, public_exponent, password,
+                            policy_digest, use_only_policy_authorization,
+                            creation_pcr_index, delegate, key_blob,
+                            creation_blob);
+}
+
+TPM_RC TpmUtilityImpl::CreateECCKeyPair(AsymmetricKeyUsage key_type,
+                                        const std::string& password,
+                                        const std::string& policy_digest,
+                                        bool use_only_policy_authorization,
+                                        int creation_pcr_index,
+                                        AuthorizationDelegate* delegate,
+                                        std::string* key_blob,
+                                        std::string* creation_blob) {
+  CHECK(key_blob);
+  if (delegate == nullptr) {
+    TPM_RC result = SAPI_RC_INVALID_SESSIONS;
+    LOG(ERROR) << __func__
+               << ": This method needs a valid authorization delegate: "
+               << GetErrorString(result);
+    return result;
+  }
+  TPMT_PUBLIC public_area = CreateDefaultPublicArea(TPM_ALG_ECC);
+  public_area.parameters.ecc_detail.symmetric.algorithm = TPM_ALG_NULL;
+  public_area.parameters.ecc_detail.scheme.scheme = TPM_ALG_NULL;
+  return CreateKeyPair(kECCStorageRootKey, public_area, key_type, password,
+                       policy_digest, use_only_policy_authorization,
+                       creation_pcr_index, delegate, key_blob, creation_blob);
+}
+
+TPM_RC TpmUtilityImpl::FillRSAKeyPool() {
+  RsaKeyPool* pool = factory_.GetRsaKeyPool();
+  RsaKeyPool::KeyTemplate key_template;
+  if (!pool->GetTemplateToFill(&key_template)) {
+    return TPM_RC_SUCCESS;
+  }
+  std::unique_ptr<HmacSession> session = factory_.GetHmacSession();
+  TPM_RC result = StartSession(session.get());
+  if (result != TPM_RC_SUCCESS) {
+    return result;
+  }
+  // The temporary authorization value only has to be unguessable until the
+  // key is handed out.
+  RsaKeyPool::PooledKey key;
+  key.auth_value.resize(SHA256_DIGEST_SIZE);
+  CHECK_EQ(RAND_bytes(reinterpret_cast<unsigned char*>(
+                          base::string_as_array(&key.auth_value)),
+                      key.auth_value.size()),
+           1)
+      << "Error generating a cryptographically random authorization value.";
+  result = GenerateRSAKeyPair(
+      key_template.key_type, key_template.modulus_bits,
+      key_template.public_exponent, key.auth_value,
+      std::string(),  // policy_digest
+      false,          // use_only_policy_authorization
+      kNoCreationPCR, session->GetDelegate(), &key.key_blob,
+      &key.creation_blob);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << __func__
+               << ": Error creating pooled key: " << GetErrorString(result);
+    return result;
+  }
+  pool->AddKey(key_template, key);
+  return TPM_RC_SUCCESS;
+}
+
+bool TpmUtilityImpl::TakePooledRSAKey(AsymmetricKeyUsage key_type,
+                                      int modulus_bits,
+                                      uint32_t public_exponent,
+                                      const std::string& password,
+                                      AuthorizationDelegate* delegate,
+                                      std::string* key_blob,
+                                      std::string* creation_blob) {
+  RsaKeyPool* pool = factory_.GetRsaKeyPool();
+  if (!pool->IsEnabled()) {
+    return false;
+  }
+  RsaKeyPool::KeyTemplate key_template;
+  key_template.key_type = key_type;
+  key_template.modulus_bits = modulus_bits;
+  key_template.public_exponent = public_exponent;
+  RsaKeyPool::PooledKey key;
+  if (!pool->TakeKey(key_template, &key)) {
+    // Make sure this template is available next time.
+    pool->AddTemplate(key_template);
+    return false;
+  }
+  TPM_HANDLE key_handle;
+  TPM_RC result = LoadKey(key.key_blob, delegate, &key_handle);
+  if (result != TPM_RC_SUCCESS) {
+    // The key is most likely from before the TPM was cleared.
+    LOG(WARNING) << __func__
+                 << ": Discarding pooled key: " << GetErrorString(result);
+    return false;
+  }
+  ScopedKeyHandle scoped_key(factory_, key_handle);
+  // An encrypted session keeps |password| off the bus.
+  std::unique_ptr<HmacSession> session = factory_.GetHmacSession();
+  result = session->StartUnboundSession(true /* enable_encryption */);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(WARNING) << __func__ << ": Error starting unbound session: "
+                 << GetErrorString(result);
+    return false;
+  }
+  session->SetEntityAuthorizationValue(key.auth_value);
+  result = ChangeKeyAuthorizationData(key_handle, password,
+                                      session->GetDelegate(), key_blob);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(WARNING) << __func__
+                 << ": Discarding pooled key: " << GetErrorString(result);
+    return false;
+  }
+  if (creation_blob) {
+    *creation_blob = key.creation_blob;
+  }
+  return true;
+}
+
+TPM_RC TpmUtilityImpl::GenerateRSAKeyPair(AsymmetricKeyUsage key_type,
+                                          int modulus_bits,
+                                          uint32_t public_exponent,
+                                          const std::string& password,
+                                          const std::string& policy_digest,
+                                          bool use_only_policy_authorization,
+                                          int creation_pcr_index,
+                                          AuthorizationDelegate* delegate,
+                                          std::string* key_blob,
+                                          std::string* creation_blob) {
+  TPMT_PUBLIC public_area = CreateDefaultPublicArea(TPM_ALG_RSA);
+  public_area.parameters.rsa_detail.key_bits = modulus_bits;
+  public_area.parameters.rsa_detail.exponent = public_exponent;
+  return CreateKeyPair(kRSAStorageRootKey, public_area, key_type, password,
+                       policy_digest, use_only_policy_authorization,
+                       creation_pcr_index, delegate, key_blob, creation_blob);
+}
+
+TPM_RC TpmUtilityImpl::CreateKeyPair(TPMI_DH_OBJECT parent_handle,
+                                     TPMT_PUBLIC public_area,
+                                     AsymmetricKeyUsage key_type,
+                                     const std::string& password,
+                                     const std::string& policy_digest,
+                                     bool use_only_policy_authorization,
+                                     int creation_pcr_index,
+                                     AuthorizationDelegate* delegate,
+                                     std::string* key_blob,
+                                     std::string* creation_blob) {
+  TPM_RC result;
   std::string parent_name;
-  result = GetKeyName(kRSAStorageRootKey, &parent_name);
+  result = GetKeyName(parent_handle, &parent_name);
   if (result != TPM_RC_SUCCESS) {
-    LOG(ERROR) << __func__ << ": Error getting Key name for RSA-SRK: "
+    LOG(ERROR) << __func__ << ": Error getting Key name for SRK: "
                << GetErrorString(result);
     return result;
   }
-  TPMT_PUBLIC public_area = CreateDefaultPublicArea(TPM_ALG_RSA);
   public_area.auth_policy = Make_TPM2B_DIGEST(policy_digest);
   public_area.object_attributes |=
       (kSensitiveDataOrigin | kUserWithAuth | kNoDA);
@@ -870,8 +1683,6 @@ TPM_RC TpmUtilityImpl::CreateRSAKeyPair(AsymmetricKeyUsage key_type,
     public_area.object_attributes |= kAdminWithPolicy;
     public_area.object_attributes &= (~kUserWithAuth);
   }
-  public_area.parameters.rsa_detail.key_bits = modulus_bits;
-  public_area.parameters.rsa_detail.exponent = public_exponent;
   TPML_PCR_SELECTION creation_pcrs = {};
   if (creation_pcr_index == kNoCreationPCR) {
     creation_pcrs.count = 0;
@@ -901,12 +1712,12 @@ TPM_RC TpmUtilityImpl::CreateRSAKeyPair(AsymmetricKeyUsage key_type,
   TPM2B_DIGEST creation_hash;
   TPMT_TK_CREATION creation_ticket;
   result = factory_.GetTpm()->CreateSync(
-      kRSAStorageRootKey, parent_name, sensitive_create,
+      parent_handle, parent_name, sensitive_create,
       Make_TPM2B_PUBLIC(public_area), outside_info, creation_pcrs, &out_private,
       &out_public, &creation_data, &creation_hash, &creation_ticket, delegate);
   if (result != TPM_RC_SUCCESS) {
     LOG(ERROR) << __func__
-               << ": Error creating RSA key: " << GetErrorString(result);
+               << ": Error creating key: " << GetErrorString(result);
     return result;
   }
   if (!factory_.GetBlobParser()->SerializeKeyBlob(out_public, out_private,
@@ -934,24 +1745,29 @@ TPM_RC TpmUtilityImpl::LoadKey(const std::string& key_blob,
                << GetErrorString(result);
     return result;
   }
+  TPM2B_PUBLIC in_public = {};
+  TPM2B_PRIVATE in_private;
+  if (!factory_.GetBlobParser()->ParseKeyBlob(key_blob, &in_public,
+                                              &in_private)) {
+    return SAPI_RC_BAD_TCTI_STRUCTURE;
+  }
+  // ECC keys are created under the ECC SRK and everything else under the RSA
+  // SRK.
+  TPMI_DH_OBJECT parent_handle = (in_public.public_area.type == TPM_ALG_ECC)
+                                     ? kECCStorageRootKey
+                                     : kRSAStorageRootKey;
   std::string parent_name;
-  result = GetKeyName(kRSAStorageRootKey, &parent_name);
+  result = GetKeyName(parent_handle, &parent_name);
   if (result != TPM_RC_SUCCESS) {
     LOG(ERROR) << __func__
                << ": Error getting parent key name: " << GetErrorString(result);
     return result;
   }
-  TPM2B_PUBLIC in_public;
-  TPM2B_PRIVATE in_private;
-  if (!factory_.GetBlobParser()->ParseKeyBlob(key_blob, &in_public,
-                                              &in_private)) {
-    return SAPI_RC_BAD_TCTI_STRUCTURE;
-  }
   TPM2B_NAME key_name;
   key_name.size = 0;
-  result =
-      factory_.GetTpm()->LoadSync(kRSAStorageRootKey, parent_name, in_private,
-                                  in_public, key_handle, &key_name, delegate);
+  result = factory_.GetTpm()->LoadSync(parent_handle, parent_name, in_private,
+                                       in_public, key_handle, &key_name,
+                                       delegate);
   if (result != TPM_RC_SUCCESS) {
     LOG(ERROR) << __func__ << ": Error loading key: " << GetErrorString(result);
     return result;
@@ -961,6 +1777,9 @@ TPM_RC TpmUtilityImpl::LoadKey(const std::string& key_blob,
 
 TPM_RC TpmUtilityImpl::GetKeyName(TPM_HANDLE handle, std::string* name) {
   CHECK(name);
+  if (factory_.GetObjectCache()->GetObject(handle, nullptr, name)) {
+    return TPM_RC_SUCCESS;
+  }
   TPM_RC result;
   TPMT_PUBLIC public_data;
   result = GetKeyPublicArea(handle, &public_data);
@@ -981,6 +1800,9 @@ TPM_RC TpmUtilityImpl::GetKeyName(TPM_HANDLE handle, std::string* name) {
 TPM_RC TpmUtilityImpl::GetKeyPublicArea(TPM_HANDLE handle,
                                         TPMT_PUBLIC* public_data) {
   CHECK(public_data);
+  if (factory_.GetObjectCache()->GetObject(handle, public_data, nullptr)) {
+    return TPM_RC_SUCCESS;
+  }
   TPM2B_NAME out_name;
   TPM2B_PUBLIC public_area;
   TPM2B_NAME qualified_name;
@@ -993,6 +1815,10 @@ TPM_RC TpmUtilityImpl::GetKeyPublicArea(TPM_HANDLE handle,
     return return_code;
   }
   *public_data = public_area.public_area;
+  std::string name;
+  if (ComputeKeyName(*public_data, &name) == TPM_RC_SUCCESS) {
+    factory_.GetObjectCache()->SetObject(handle, *public_data, name);
+  }
   return TPM_RC_SUCCESS;
 }
 
@@ -1064,7 +1890,38 @@ TPM_RC TpmUtilityImpl::UnsealData(const std::string& sealed_data,
                << GetErrorString(result);
     return result;
   }
+  // The name follows from the blob, so the TPM does not have to be asked.
+  TPM2B_PUBLIC public_info = {};
+  TPM2B_PRIVATE private_info;
+  if (!factory_.GetBlobParser()->ParseKeyBlob(sealed_data, &public_info,
+                                              &private_info)) {
+    return SAPI_RC_BAD_TCTI_STRUCTURE;
+  }
+  std::string object_name;
+  result = ComputeKeyName(public_info.public_area, &object_name);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << __func__
+               << ": Error computing object name: " << GetErrorString(result);
+    return result;
+  }
+  TpmObjectCache* cache = factory_.GetObjectCache();
+  std::string blob_digest = crypto::SHA256HashString(sealed_data);
   TPM_HANDLE object_handle;
+  if (cache->GetSealedObject(blob_digest, &object_handle)) {
+    // A cached handle is only used while it still names this blob's object.
+    // Once the object is gone its virtual handle can be handed out again, e.g.
+    // after trunksd restarts, and may then refer to another process's object.
+    std::string loaded_name;
+    if (GetKeyName(object_handle, &loaded_name) == TPM_RC_SUCCESS &&
+        loaded_name == object_name) {
+      result =
+          UnsealObject(object_handle, object_name, delegate, unsealed_data);
+      ReleaseSealedObject(blob_digest, object_handle);
+      return result;
+    }
+    // The handle is not ours anymore, so it must not be flushed either.
+    cache->RemoveSealedObject(blob_digest);
+  }
   std::unique_ptr<AuthorizationDelegate> password_delegate =
       factory_.GetPasswordAuthorization("");
   result = LoadKey(sealed_data, password_delegate.get(), &object_handle);
@@ -1073,17 +1930,41 @@ TPM_RC TpmUtilityImpl::UnsealData(const std::string& sealed_data,
                << ": Error loading sealed object: " << GetErrorString(result);
     return result;
   }
+  // If the blob is already cached by another thread, |sealed_object| is only
+  // used for this call and flushed afterwards.
   ScopedKeyHandle sealed_object(factory_, object_handle);
-  std::string object_name;
-  result = GetKeyName(sealed_object.get(), &object_name);
-  if (result != TPM_RC_SUCCESS) {
-    LOG(ERROR) << __func__
-               << ": Error getting object name: " << GetErrorString(result);
-    return result;
+  std::vector<TPM_HANDLE> evicted;
+  bool cached = cache->AddSealedObject(blob_digest, object_handle, &evicted);
+  if (cached) {
+    sealed_object.release();
+  }
+  for (TPM_HANDLE handle : evicted) {
+    ScopedKeyHandle evicted_object(factory_, handle);
+  }
+  result = UnsealObject(object_handle, object_name, delegate, unsealed_data);
+  if (cached) {
+    ReleaseSealedObject(blob_digest, object_handle);
+  }
+  return result;
+}
+
+void TpmUtilityImpl::ReleaseSealedObject(const std::string& blob_digest,
+                                         TPM_HANDLE object_handle) {
+  std::vector<TPM_HANDLE> evicted;
+  factory_.GetObjectCache()->ReleaseSealedObject(blob_digest, object_handle,
+                                                 &evicted);
+  for (TPM_HANDLE handle : evicted) {
+    ScopedKeyHandle evicted_object(factory_, handle);
   }
+}
+
+TPM_RC TpmUtilityImpl::UnsealObject(TPM_HANDLE object_handle,
+                                    const std::string& object_name,
+                                    AuthorizationDelegate* delegate,
+                                    std::string* unsealed_data) {
   TPM2B_SENSITIVE_DATA out_data;
-  result = factory_.GetTpm()->UnsealSync(sealed_object.get(), object_name,
-                                         &out_data, delegate);
+  TPM_RC result = factory_.GetTpm()->UnsealSync(object_handle, object_name,
+                                                &out_data, delegate);
   if (result != TPM_RC_SUCCESS) {
     LOG(ERROR) << __func__
                << ": Error unsealing object: " << GetErrorString(result);
@@ -1186,7 +2067,7 @@ TPM_RC TpmUtilityImpl::DefineNVSpace(uint32_t index,
                << GetErrorString(result);
     return result;
   }
-  nvram_public_area_map_[index] = public_data;
+  factory_.GetObjectCache()->SetNVPublicArea(index, public_data);
   return TPM_RC_SUCCESS;
 }
 
@@ -1220,7 +2101,7 @@ TPM_RC TpmUtilityImpl::DestroyNVSpace(uint32_t index,
                << GetErrorString(result);
     return result;
   }
-  nvram_public_area_map_.erase(index);
+  factory_.GetObjectCache()->RemoveNVPublicArea(index);
   return TPM_RC_SUCCESS;
 }
 
@@ -1249,7 +2130,6 @@ TPM_RC TpmUtilityImpl::LockNVSpace(uint32_t index,
     auth_target = TPM_RH_OWNER;
     auth_target_name = NameFromHandle(TPM_RH_OWNER);
   }
-  auto it = nvram_public_area_map_.find(index);
   if (lock_read) {
     result = factory_.GetTpm()->NV_ReadLockSync(auth_target, auth_target_name,
                                                 nv_index, nv_name, delegate);
@@ -1258,9 +2138,7 @@ TPM_RC TpmUtilityImpl::LockNVSpace(uint32_t index,
                  << GetErrorString(result);
       return result;
     }
-    if (it != nvram_public_area_map_.end()) {
-      it->second.attributes |= TPMA_NV_READLOCKED;
-    }
+    factory_.GetObjectCache()->UpdateNVAttributes(index, TPMA_NV_READLOCKED);
   }
   if (lock_write) {
     result = factory_.GetTpm()->NV_WriteLockSync(auth_target, auth_target_name,
@@ -1270,9 +2148,7 @@ TPM_RC TpmUtilityImpl::LockNVSpace(uint32_t index,
                  << GetErrorString(result);
       return result;
     }
-    if (it != nvram_public_area_map_.end()) {
-      it->second.attributes |= TPMA_NV_WRITELOCKED;
-    }
+    factory_.GetObjectCache()->UpdateNVAttributes(index, TPMA_NV_WRITELOCKED);
   }
   return TPM_RC_SUCCESS;
 }
@@ -1323,10 +2199,7 @@ TPM_RC TpmUtilityImpl::WriteNVSpace(uint32_t index,
                << GetErrorString(result);
     return result;
   }
-  auto it = nvram_public_area_map_.find(index);
-  if (it != nvram_public_area_map_.end()) {
-    it->second.attributes |= TPMA_NV_WRITTEN;
-  }
+  factory_.GetObjectCache()->UpdateNVAttributes(index, TPMA_NV_WRITTEN);
   return TPM_RC_SUCCESS;
 }
 
@@ -1407,9 +2280,7 @@ TPM_RC TpmUtilityImpl::GetNVSpacePublicArea(uint32_t index,
                << GetErrorString(result);
     return result;
   }
-  auto it = nvram_public_area_map_.find(index);
-  if (it != nvram_public_area_map_.end()) {
-    *public_data = it->second;
+  if (factory_.GetObjectCache()->GetNVPublicArea(index, public_data)) {
     return TPM_RC_SUCCESS;
   }
   TPM2B_NAME nvram_name;
@@ -1425,7 +2296,7 @@ TPM_RC TpmUtilityImpl::GetNVSpacePublicArea(uint32_t index,
     return result;
   }
   *public_data = public_area.nv_public;
-  nvram_public_area_map_[index] = public_area.nv_public;
+  factory_.GetObjectCache()->SetNVPublicArea(index, public_area.nv_public);
   return TPM_RC_SUCCESS;
 }
 
@@ -1554,6 +2425,7 @@ TPM_RC TpmUtilityImpl::CreateStorageRootKeys(
         LOG(ERROR) << __func__ << ": " << GetErrorString(result);
         return result;
       }
+      factory_.GetObjectCache()->RemoveObject(kRSAStorageRootKey);
       LOG(INFO) << __func__ << ": Created RSA SRK.";
     } else {
       LOG(INFO) << __func__ << ": Skip RSA SRK because it already exists.";
@@ -1597,6 +2469,7 @@ TPM_RC TpmUtilityImpl::CreateStorageRootKeys(
         LOG(ERROR) << __func__ << ": " << GetErrorString(result);
         return result;
       }
+      factory_.GetObjectCache()->RemoveObject(kECCStorageRootKey);
       LOG(INFO) << __func__ << ": Created ECC SRK.";
     } else {
       LOG(INFO) << __func__ << ": Skip ECC SRK because it already exists.";
@@ -1680,6 +2553,7 @@ TPM_RC TpmUtilityImpl::CreateSaltingKey(const std::string& owner_password) {
     LOG(ERROR) << __func__ << ": " << GetErrorString(result);
     return result;
   }
+  factory_.GetObjectCache()->RemoveObject(kSaltingKey);
   return TPM_RC_SUCCESS;
 }
 
@@ -1736,6 +2610,102 @@ TPM_RC TpmUtilityImpl::DisablePlatformHierarchy(
       authorization);
 }
 
+TPM_RC TpmUtilityImpl::PrepareSign(TPM_HANDLE key_handle,
+                                   TPM_ALG_ID scheme,
+                                   bool allow_restricted,
+                                   TPM_ALG_ID* hash_alg,
+                                   TPMT_SIG_SCHEME* in_scheme,
+                                   std::string* key_name,
+                                   bool* restricted) {
+  if (*hash_alg == TPM_ALG_NULL) {
+    *hash_alg = TPM_ALG_SHA256;
+  }
+  if (scheme != TPM_ALG_NULL && scheme != TPM_ALG_RSASSA &&
+      scheme != TPM_ALG_RSAPSS && scheme != TPM_ALG_ECDSA) {
+    LOG(ERROR) << __func__ << ": Invalid Signing scheme used.";
+    return SAPI_RC_BAD_PARAMETER;
+  }
+  TPMT_PUBLIC public_area;
+  TPM_RC result = GetKeyPublicArea(key_handle, &public_area);
+  if (result) {
+    LOG(ERROR) << __func__ << ": Error finding public area for: " << key_handle;
+    return result;
+  }
+  if (public_area.type == TPM_ALG_ECC) {
+    if (public_area.parameters.ecc_detail.curve_id != TPM_ECC_NIST_P256) {
+      LOG(ERROR) << __func__ << ": Only NIST P-256 ECC keys are supported";
+      return SAPI_RC_BAD_PARAMETER;
+    }
+    if (scheme != TPM_ALG_ECDSA && scheme != TPM_ALG_NULL) {
+      LOG(ERROR) << __func__ << ": Invalid Signing scheme used.";
+      return SAPI_RC_BAD_PARAMETER;
+    }
+    in_scheme->scheme = TPM_ALG_ECDSA;
+    in_scheme->details.ecdsa.hash_alg = *hash_alg;
+  } else if (public_area.type != TPM_ALG_RSA) {
+    LOG(ERROR) << __func__ << ": Key handle given is not an RSA or ECC key";
+    return SAPI_RC_BAD_PARAMETER;
+  } else if (scheme == TPM_ALG_RSAPSS) {
+    in_scheme->scheme = TPM_ALG_RSAPSS;
+    in_scheme->details.rsapss.hash_alg = *hash_alg;
+  } else if (scheme == TPM_ALG_RSASSA || scheme == TPM_ALG_NULL) {
+    in_scheme->scheme = TPM_ALG_RSASSA;
+    in_scheme->details.rsassa.hash_alg = *hash_alg;
+  } else {
+    LOG(ERROR) << __func__ << ": Invalid Signing scheme used.";
+    return SAPI_RC_BAD_PARAMETER;
+  }
+  if ((public_area.object_attributes & kSign) == 0) {
+    LOG(ERROR) << __func__ << ": Key handle given is not a signging key";
+    return SAPI_RC_BAD_PARAMETER;
+  } else if (!allow_restricted &&
+             (public_area.object_attributes & kRestricted) != 0) {
+    LOG(ERROR) << __func__ << ": Key handle references a restricted key";
+    return SAPI_RC_BAD_PARAMETER;
+  }
+  if (restricted) {
+    *restricted = (public_area.object_attributes & kRestricted) != 0;
+  }
+
+  result = ComputeKeyName(public_area, key_name);
+  if (result) {
+    LOG(ERROR) << __func__ << ": Error computing key name for: " << key_handle;
+    return result;
+  }
+  return TPM_RC_SUCCESS;
+}
+
+TPM_RC TpmUtilityImpl::SignDigest(TPM_HANDLE key_handle,
+                                  const std::string& key_name,
+                                  const std::string& digest,
+                                  const TPMT_SIG_SCHEME& in_scheme,
+                                  const TPMT_TK_HASHCHECK& validation,
+                                  AuthorizationDelegate* delegate,
+                                  std::string* signature) {
+  TPM2B_DIGEST tpm_digest = Make_TPM2B_DIGEST(digest);
+  TPMT_SIGNATURE signature_out;
+  TPM_RC result =
+      factory_.GetTpm()->SignSync(key_handle, key_name, tpm_digest, in_scheme,
+                                  validation, &signature_out, delegate);
+  if (result) {
+    LOG(ERROR) << __func__
+               << ": Error signing digest: " << GetErrorString(result);
+    return result;
+  }
+  if (in_scheme.scheme == TPM_ALG_ECDSA) {
+    signature->assign(
+        PadECCParameter(signature_out.signature.ecdsa.signature_r) +
+        PadECCParameter(signature_out.signature.ecdsa.signature_s));
+  } else if (in_scheme.scheme == TPM_ALG_RSAPSS) {
+    signature->assign(
+        StringFrom_TPM2B_PUBLIC_KEY_RSA(signature_out.signature.rsapss.sig));
+  } else {
+    signature->assign(
+        StringFrom_TPM2B_PUBLIC_KEY_RSA(signature_out.signature.rsassa.sig));
+  }
+  return TPM_RC_SUCCESS;
+}
+
 TPM_RC TpmUtilityImpl::ComputeKeyName(const TPMT_PUBLIC& public_area,
                                       std::string* object_name) {
   CHECK(object_name);
@@ -19,7 +19,7 @@
 
 #include "trunks/tpm_utility.h"
 
-#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -31,6 +31,7 @@
 namespace trunks {
 
 class AuthorizationDelegate;
+struct SignStreamImpl;
 class TrunksFactory;
 
 // A default implementation of TpmUtility.
@@ -56,6 +57,9 @@ class TRUNKS_EXPORT TpmUtilityImpl : public TpmUtility {
   TPM_RC ExtendPCR(int pcr_index,
                    const std::string& extend_data,
                    AuthorizationDelegate* delegate) override;
+  TPM_RC ExtendPCRs(const std::vector<PCREvent>& events,
+                    AuthorizationDelegate* delegate,
+                    TpmEventLog* event_log) override;
   TPM_RC ReadPCR(int pcr_index, std::string* pcr_value) override;
   TPM_RC AsymmetricEncrypt(TPM_HANDLE key_handle,
                            TPM_ALG_ID scheme,
@@ -75,12 +79,29 @@ class TRUNKS_EXPORT TpmUtilityImpl : public TpmUtility {
               const std::string& plaintext,
               AuthorizationDelegate* delegate,
               std::string* signature) override;
+  TPM_RC SignBatch(TPM_HANDLE key_handle,
+                   TPM_ALG_ID scheme,
+                   TPM_ALG_ID hash_alg,
+                   const std::vector<std::string>& digests,
+                   AuthorizationDelegate* delegate,
+                   std::vector<std::string>* signatures,
+                   std::vector<TPM_RC>* results) override;
+  TPM_RC SignStreamBegin(TPM_HANDLE key_handle,
+                         TPM_ALG_ID scheme,
+                         TPM_ALG_ID hash_alg,
+                         bool use_tpm_hash_sequence,
+                         AuthorizationDelegate* delegate,
+                         std::unique_ptr<SignStream>* stream) override;
+  TPM_RC SignStreamUpdate(SignStream* stream,
+                          const std::string& data) override;
+  TPM_RC SignStreamFinish(SignStream* stream, std::string* signature) override;
   TPM_RC Verify(TPM_HANDLE key_handle,
                 TPM_ALG_ID scheme,
                 TPM_ALG_ID hash_alg,
                 const std::string& plaintext,
                 const std::string& signature,
                 AuthorizationDelegate* delegate) override;
+  void SetSoftwarePublicKeyOperations(bool enabled) override;
   TPM_RC CertifyCreation(TPM_HANDLE key_handle,
                          const std::string& creation_blob) override;
   TPM_RC ChangeKeyAuthorizationData(TPM_HANDLE key_handle,
@@ -94,6 +115,11 @@ class TRUNKS_EXPORT TpmUtilityImpl : public TpmUtility {
                       const std::string& password,
                       AuthorizationDelegate* delegate,
                       std::string* key_blob) override;
+  TPM_RC ImportRSAKeys(const std::vector<RSAKeyImport>& keys,
+                       AuthorizationDelegate* delegate,
+                       const ImportProgressCallback& progress,
+                       std::vector<TPM_RC>* results,
+                       std::vector<std::string>* key_blobs) override;
   TPM_RC CreateRSAKeyPair(AsymmetricKeyUsage key_type,
                           int modulus_bits,
                           uint32_t public_exponent,
@@ -104,6 +130,15 @@ class TRUNKS_EXPORT TpmUtilityImpl : public TpmUtility {
                           AuthorizationDelegate* delegate,
                           std::string* key_blob,
                           std::string* creation_blob) override;
+  TPM_RC CreateECCKeyPair(AsymmetricKeyUsage key_type,
+                          const std::string& password,
+                          const std::string& policy_digest,
+                          bool use_only_policy_authorization,
+                          int creation_pcr_index,
+                          AuthorizationDelegate* delegate,
+                          std::string* key_blob,
+                          std::string* creation_blob) override;
+  TPM_RC FillRSAKeyPool() override;
   TPM_RC LoadKey(const std::string& key_blob,
                  AuthorizationDelegate* delegate,
                  TPM_HANDLE* key_handle) override;
@@ -160,7 +195,7 @@ class TRUNKS_EXPORT TpmUtilityImpl : public TpmUtility {
   friend class TpmUtilityTest;
 
   const TrunksFactory& factory_;
-  std::map<uint32_t, TPMS_NV_PUBLIC> nvram_public_area_map_;
+  bool software_public_key_operations_ = false;
 
   // This method sets a known owner password in the TPM_RH_OWNER hierarchy.
   TPM_RC SetKnownOwnerPassword(const std::string& known_owner_password);
@@ -191,6 +226,111 @@ class TRUNKS_EXPORT TpmUtilityImpl : public TpmUtility {
   // platform |authorization|.
   TPM_RC DisablePlatformHierarchy(AuthorizationDelegate* authorization);
 
+  // Reads |num_bytes| of random data from the TPM, one TPM2_GetRandom call per
+  // digest-sized chunk.
+  TPM_RC GetRandomFromTpm(size_t num_bytes,
+                          AuthorizationDelegate* delegate,
+                          std::string* random_data);
+
+  // Checks that |key_handle| is a signing key usable with |scheme| and
+  // |hash_alg|, and fills |in_scheme| and |key_name| for the Sign command.
+  // RSA keys accept TPM_ALG_RSASSA or TPM_ALG_RSAPSS, NIST P-256 ECC keys
+  // accept TPM_ALG_ECDSA, and TPM_ALG_NULL selects RSASSA or ECDSA by key
+  // type. Other key types and curves are rejected. Restricted keys are only
+  // accepted if |allow_restricted| is set. |hash_alg| is updated with the
+  // default algorithm if it is TPM_ALG_NULL. If |restricted| is not null, it is
+  // set to whether the key is restricted.
+  TPM_RC PrepareSign(TPM_HANDLE key_handle,
+                     TPM_ALG_ID scheme,
+                     bool allow_restricted,
+                     TPM_ALG_ID* hash_alg,
+                     TPMT_SIG_SCHEME* in_scheme,
+                     std::string* key_name,
+                     bool* restricted);
+
+  // Signs |digest| with |key_handle| and extracts the raw signature bytes into
+  // |signature|. |validation| is the hashcheck ticket for |digest|.
+  TPM_RC SignDigest(TPM_HANDLE key_handle,
+                    const std::string& key_name,
+                    const std::string& digest,
+                    const TPMT_SIG_SCHEME& in_scheme,
+                    const TPMT_TK_HASHCHECK& validation,
+                    AuthorizationDelegate* delegate,
+                    std::string* signature);
+
+  // The inputs of an Import command, prepared in software.
+  struct PreparedImport {
+    TPM2B_DATA encryption_key;
+    TPM2B_PUBLIC public_data;
+    TPM2B_PRIVATE private_data;
+  };
+
+  // Builds the public area of |key| and wraps its private part with a new
+  // random key. This does not talk to the TPM and may run on any thread.
+  TPM_RC PrepareRSAKeyImport(const RSAKeyImport& key,
+                             PreparedImport* prepared);
+
+  // Imports |prepared| under the RSA SRK, whose name is |parent_name|, and
+  // fills |key_blob| if it is not null.
+  TPM_RC SendKeyImport(const std::string& parent_name,
+                       const PreparedImport& prepared,
+                       AuthorizationDelegate* delegate,
+                       std::string* key_blob);
+
+  // Unseals the loaded sealed object at |object_handle|, whose name is
+  // |object_name|, into |unsealed_data|.
+  TPM_RC UnsealObject(TPM_HANDLE object_handle,
+                      const std::string& object_name,
+                      AuthorizationDelegate* delegate,
+                      std::string* unsealed_data);
+
+  // Unpins the cached sealed object at |object_handle| for |blob_digest| and
+  // flushes any objects that no longer fit in the cache.
+  void ReleaseSealedObject(const std::string& blob_digest,
+                           TPM_HANDLE object_handle);
+
+  // Sends the pending data of a TPM hash sequence |stream| to the TPM.
+  TPM_RC FlushSignStreamBuffer(SignStreamImpl* stream);
+
+  // Creates a key from |public_area|, whose algorithm parameters must already
+  // be filled in, under the storage root key |parent_handle|. The other
+  // parameters are the same as for CreateRSAKeyPair.
+  TPM_RC CreateKeyPair(TPMI_DH_OBJECT parent_handle,
+                       TPMT_PUBLIC public_area,
+                       AsymmetricKeyUsage key_type,
+                       const std::string& password,
+                       const std::string& policy_digest,
+                       bool use_only_policy_authorization,
+                       int creation_pcr_index,
+                       AuthorizationDelegate* delegate,
+                       std::string* key_blob,
+                       std::string* creation_blob);
+
+  // Creates an RSA key in the TPM. The parameters are the same as for
+  // CreateRSAKeyPair, which may instead use a pooled key.
+  TPM_RC GenerateRSAKeyPair(AsymmetricKeyUsage key_type,
+                            int modulus_bits,
+                            uint32_t public_exponent,
+                            const std::string& password,
+                            const std::string& policy_digest,
+                            bool use_only_policy_authorization,
+                            int creation_pcr_index,
+                            AuthorizationDelegate* delegate,
+                            std::string* key_blob,
+                            std::string* creation_blob);
+
+  // Takes a key matching |key_type|, |modulus_bits| and |public_exponent| from
+  // the RsaKeyPool and changes its authorization value to |password|.
+  // |delegate| authorizes use of the RSA SRK. Returns true on success; on
+  // failure the caller should generate a new key.
+  bool TakePooledRSAKey(AsymmetricKeyUsage key_type,
+                        int modulus_bits,
+                        uint32_t public_exponent,
+                        const std::string& password,
+                        AuthorizationDelegate* delegate,
+                        std::string* key_blob,
+                        std::string* creation_blob);
+
   // Given a public area, this method computes the object name. Following
   // TPM2.0 Specification Part 1 section 16,
   // object_name = HashAlg || Hash(public_area);
@@ -14,26 +14,37 @@
 // limitations under the License.
 //
 
+#include <base/bind.h>
+#include <base/files/file_path.h>
+#include <base/files/file_util.h>
+#include <base/files/scoped_temp_dir.h>
+#include <base/sha1.h>
 #include <base/stl_util.h>
 #include <crypto/sha2.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <openssl/aes.h>
+#include <openssl/bn.h>
+#include <openssl/rsa.h>
 
 #include "trunks/error_codes.h"
 #include "trunks/hmac_authorization_delegate.h"
+#include "trunks/hmac_drbg.h"
 #include "trunks/mock_authorization_delegate.h"
 #include "trunks/mock_blob_parser.h"
 #include "trunks/mock_hmac_session.h"
 #include "trunks/mock_policy_session.h"
 #include "trunks/mock_tpm.h"
 #include "trunks/mock_tpm_state.h"
+#include "trunks/rsa_key_pool.h"
+#include "trunks/scoped_key_handle.h"
 #include "trunks/tpm_constants.h"
 #include "trunks/tpm_utility_impl.h"
 #include "trunks/trunks_factory_for_test.h"
 
 using testing::_;
 using testing::DoAll;
+using testing::InvokeWithoutArgs;
 using testing::NiceMock;
 using testing::Return;
 using testing::SaveArg;
@@ -59,16 +70,18 @@ class TpmUtilityTest : public testing::Test {
     return utility_.ComputeKeyName(public_area, object_name);
   }
 
+  TPMT_PUBLIC CreateDefaultPublicArea(TPM_ALG_ID key_alg) {
+    return utility_.CreateDefaultPublicArea(key_alg);
+  }
+
   void SetNVRAMMap(uint32_t index, const TPMS_NV_PUBLIC& public_area) {
-    utility_.nvram_public_area_map_[index] = public_area;
+    factory_.GetObjectCache()->SetNVPublicArea(index, public_area);
   }
 
   TPM_RC GetNVRAMMap(uint32_t index, TPMS_NV_PUBLIC* public_area) {
-    auto it = utility_.nvram_public_area_map_.find(index);
-    if (it == utility_.nvram_public_area_map_.end()) {
+    if (!factory_.GetObjectCache()->GetNVPublicArea(index, public_area)) {
       return TPM_RC_FAILURE;
     }
-    *public_area = it->second;
     return TPM_RC_SUCCESS;
   }
 
@@ -124,6 +137,28 @@ class TpmUtilityTest : public testing::Test {
     }
   }
 
+  // Generates an RSA key in software and makes |key_handle| refer to its public
+  // half, with the given |object_attributes| and no scheme of its own.
+  bssl::UniquePtr<RSA> SetupSoftwareKey(TPM_HANDLE key_handle,
+                                        TPMA_OBJECT object_attributes) {
+    bssl::UniquePtr<RSA> rsa(RSA_new());
+    bssl::UniquePtr<BIGNUM> exponent(BN_new());
+    CHECK(BN_set_word(exponent.get(), RSA_F4));
+    CHECK(RSA_generate_key_ex(rsa.get(), 1024, exponent.get(), nullptr));
+    TPM2B_PUBLIC public_area;
+    memset(&public_area, 0, sizeof(public_area));
+    public_area.public_area.type = TPM_ALG_RSA;
+    public_area.public_area.object_attributes = object_attributes;
+    public_area.public_area.parameters.rsa_detail.scheme.scheme = TPM_ALG_NULL;
+    public_area.public_area.unique.rsa.size =
+        BN_bn2bin(rsa->n, public_area.public_area.unique.rsa.buffer);
+    EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+    utility_.SetSoftwarePublicKeyOperations(true);
+    return rsa;
+  }
+
   void SetExistingPCRSExpectation(bool has_sha1_pcrs, bool has_sha256_pcrs) {
     TPMS_CAPABILITY_DATA capability_data = {};
     TPML_PCR_SELECTION& pcrs = capability_data.data.assigned_pcr;
@@ -404,6 +439,60 @@ TEST_F(TpmUtilityTest, GenerateRandomFails) {
             utility_.GenerateRandom(num_bytes, nullptr, &random_data));
 }
 
+TEST_F(TpmUtilityTest, GenerateRandomFromDrbg) {
+  factory_.GetDrbg()->Configure(2, false);
+  TPM2B_DIGEST large_random = Make_TPM2B_DIGEST(std::string(32, 'a'));
+  TPM2B_DIGEST small_random = Make_TPM2B_DIGEST(std::string(16, 'b'));
+  // The seed is read from the TPM once per reseed interval, and requests of
+  // any size are served locally in between.
+  EXPECT_CALL(mock_tpm_, GetRandomSync(HmacDrbg::kSeedSize, _, nullptr))
+      .Times(2)
+      .WillRepeatedly(
+          DoAll(SetArgPointee<1>(large_random), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, GetRandomSync(16, _, nullptr))
+      .Times(2)
+      .WillRepeatedly(
+          DoAll(SetArgPointee<1>(small_random), Return(TPM_RC_SUCCESS)));
+  std::string random_data1;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.GenerateRandom(1000, nullptr, &random_data1));
+  EXPECT_EQ(1000u, random_data1.size());
+  std::string random_data2;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.GenerateRandom(32, nullptr, &random_data2));
+  EXPECT_NE(random_data1.substr(0, 32), random_data2);
+  std::string random_data3;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.GenerateRandom(32, nullptr, &random_data3));
+  EXPECT_NE(random_data2, random_data3);
+}
+
+TEST_F(TpmUtilityTest, GenerateRandomFromDrbgPredictionResistance) {
+  factory_.GetDrbg()->Configure(100, true);
+  TPM2B_DIGEST large_random = Make_TPM2B_DIGEST(std::string(32, 'a'));
+  TPM2B_DIGEST small_random = Make_TPM2B_DIGEST(std::string(16, 'b'));
+  // Every request reads a new seed from the TPM.
+  EXPECT_CALL(mock_tpm_, GetRandomSync(HmacDrbg::kSeedSize, _, nullptr))
+      .Times(2)
+      .WillRepeatedly(
+          DoAll(SetArgPointee<1>(large_random), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, GetRandomSync(16, _, nullptr))
+      .Times(2)
+      .WillRepeatedly(
+          DoAll(SetArgPointee<1>(small_random), Return(TPM_RC_SUCCESS)));
+  std::string random_data;
+  EXPECT_EQ(TPM_RC_SUCCESS, utility_.GenerateRandom(8, nullptr, &random_data));
+  EXPECT_EQ(TPM_RC_SUCCESS, utility_.GenerateRandom(8, nullptr, &random_data));
+}
+
+TEST_F(TpmUtilityTest, GenerateRandomFromDrbgSeedFails) {
+  factory_.GetDrbg()->Configure(100, false);
+  EXPECT_CALL(mock_tpm_, GetRandomSync(_, _, nullptr))
+      .WillOnce(Return(TPM_RC_FAILURE));
+  std::string random_data;
+  EXPECT_EQ(TPM_RC_FAILURE, utility_.GenerateRandom(8, nullptr, &random_data));
+}
+
 TEST_F(TpmUtilityTest, ExtendPCRSuccess) {
   TPM_HANDLE pcr_handle = HR_PCR + 1;
   TPML_DIGEST_VALUES digests;
@@ -432,6 +521,152 @@ TEST_F(TpmUtilityTest, ExtendPCRBadParam) {
   EXPECT_EQ(TPM_RC_FAILURE, utility_.ExtendPCR(-1, "test digest", nullptr));
 }
 
+TEST_F(TpmUtilityTest, ExtendPCRsSuccess) {
+  SetExistingPCRSExpectation(true, true);
+  std::vector<std::string> commands;
+  EXPECT_CALL(mock_tpm_, SendCommandsAndWait(_))
+      .WillOnce(DoAll(SaveArg<0>(&commands),
+                      Return(std::vector<std::string>(
+                          2, CreateErrorResponse(TPM_RC_SUCCESS)))));
+  EXPECT_CALL(mock_tpm_, PCR_ExtendSync(_, _, _, _)).Times(0);
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath log_path = temp_dir.path().Append("event_log");
+  std::vector<TpmUtility::PCREvent> events = {{1, 0xD, "event 1"},
+                                              {2, 0xD, "event 2"}};
+  {
+    TpmEventLog event_log;
+    ASSERT_TRUE(event_log.Open(log_path, 0));
+    EXPECT_EQ(TPM_RC_SUCCESS, utility_.ExtendPCRs(events, nullptr, &event_log));
+  }
+  EXPECT_EQ(2u, commands.size());
+  std::string log;
+  ASSERT_TRUE(base::ReadFileToString(log_path, &log));
+  // A Spec ID event for two banks, then each event with both digests. Events
+  // start with the PCR index, event type and digest count.
+  const size_t kSpecIdEventSize = 69;
+  const size_t kEventSize = 12 + 2 + SHA256_DIGEST_SIZE + 2 + SHA1_DIGEST_SIZE +
+                            4 + events[0].event_data.size();
+  EXPECT_EQ(kSpecIdEventSize + 2 * kEventSize, log.size());
+  for (const auto& event : events) {
+    EXPECT_NE(std::string::npos,
+              log.find(crypto::SHA256HashString(event.event_data)));
+    EXPECT_NE(std::string::npos,
+              log.find(base::SHA1HashString(event.event_data)));
+  }
+}
+
+TEST_F(TpmUtilityTest, ExtendPCRsPartialFailure) {
+  SetExistingPCRSExpectation(false, true);
+  std::vector<std::string> responses = {CreateErrorResponse(TPM_RC_FAILURE),
+                                        CreateErrorResponse(TPM_RC_SUCCESS)};
+  EXPECT_CALL(mock_tpm_, SendCommandsAndWait(_)).WillOnce(Return(responses));
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath log_path = temp_dir.path().Append("event_log");
+  std::vector<TpmUtility::PCREvent> events = {{1, 0xD, "event 1"},
+                                              {2, 0xD, "event 2"}};
+  {
+    TpmEventLog event_log;
+    ASSERT_TRUE(event_log.Open(log_path, 1));
+    EXPECT_EQ(TPM_RC_FAILURE, utility_.ExtendPCRs(events, nullptr, &event_log));
+  }
+  // Only the event that reached the PCR is logged.
+  std::string log;
+  ASSERT_TRUE(base::ReadFileToString(log_path, &log));
+  EXPECT_EQ(std::string::npos, log.find("event 1"));
+  EXPECT_NE(std::string::npos, log.find("event 2"));
+}
+
+TEST_F(TpmUtilityTest, ExtendPCRsPartiallyAllocatedBank) {
+  // SHA-1 only has PCR 0 allocated, yet every event is still logged with a
+  // SHA-1 digest so the log replays against that bank.
+  TPMS_CAPABILITY_DATA capability_data = {};
+  TPML_PCR_SELECTION& pcrs = capability_data.data.assigned_pcr;
+  PopulatePCRSelection(true, true, true, &pcrs);
+  pcrs.pcr_selections[1].pcr_select[0] = 0x01;
+  EXPECT_CALL(mock_tpm_, GetCapabilitySync(TPM_CAP_PCRS, _, _, _, _, _))
+      .WillOnce(
+          DoAll(SetArgPointee<4>(capability_data), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, SendCommandsAndWait(_))
+      .WillOnce(Return(
+          std::vector<std::string>(1, CreateErrorResponse(TPM_RC_SUCCESS))));
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath log_path = temp_dir.path().Append("event_log");
+  std::vector<TpmUtility::PCREvent> events = {{1, 0xD, "event 1"}};
+  {
+    TpmEventLog event_log;
+    ASSERT_TRUE(event_log.Open(log_path, 0));
+    EXPECT_EQ(TPM_RC_SUCCESS, utility_.ExtendPCRs(events, nullptr, &event_log));
+  }
+  std::string log;
+  ASSERT_TRUE(base::ReadFileToString(log_path, &log));
+  EXPECT_NE(std::string::npos, log.find(crypto::SHA256HashString("event 1")));
+  EXPECT_NE(std::string::npos, log.find(base::SHA1HashString("event 1")));
+}
+
+TEST_F(TpmUtilityTest, ExtendPCRsEmptyBankSkipped) {
+  TPMS_CAPABILITY_DATA capability_data = {};
+  PopulatePCRSelection(true, true, true, &capability_data.data.assigned_pcr);
+  EXPECT_CALL(mock_tpm_, GetCapabilitySync(TPM_CAP_PCRS, _, _, _, _, _))
+      .WillOnce(
+          DoAll(SetArgPointee<4>(capability_data), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, SendCommandsAndWait(_))
+      .WillOnce(Return(
+          std::vector<std::string>(1, CreateErrorResponse(TPM_RC_SUCCESS))));
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath log_path = temp_dir.path().Append("event_log");
+  std::vector<TpmUtility::PCREvent> events = {{1, 0xD, "event 1"}};
+  {
+    TpmEventLog event_log;
+    ASSERT_TRUE(event_log.Open(log_path, 0));
+    EXPECT_EQ(TPM_RC_SUCCESS, utility_.ExtendPCRs(events, nullptr, &event_log));
+  }
+  std::string log;
+  ASSERT_TRUE(base::ReadFileToString(log_path, &log));
+  EXPECT_NE(std::string::npos, log.find(crypto::SHA256HashString("event 1")));
+  EXPECT_EQ(std::string::npos, log.find(base::SHA1HashString("event 1")));
+}
+
+TEST_F(TpmUtilityTest, ExtendPCRsLogBanksMismatch) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath log_path = temp_dir.path().Append("event_log");
+  std::vector<TpmUtility::PCREvent> events = {{1, 0xD, "event 1"}};
+  // Start the log while only SHA-256 is allocated.
+  SetExistingPCRSExpectation(false, true);
+  EXPECT_CALL(mock_tpm_, SendCommandsAndWait(_))
+      .WillOnce(Return(
+          std::vector<std::string>(1, CreateErrorResponse(TPM_RC_SUCCESS))));
+  {
+    TpmEventLog event_log;
+    ASSERT_TRUE(event_log.Open(log_path, 0));
+    EXPECT_EQ(TPM_RC_SUCCESS, utility_.ExtendPCRs(events, nullptr, &event_log));
+  }
+  // The log can't describe a SHA-1 bank, so nothing is extended.
+  SetExistingPCRSExpectation(true, true);
+  EXPECT_CALL(mock_tpm_, SendCommandsAndWait(_)).Times(0);
+  TpmEventLog event_log;
+  ASSERT_TRUE(event_log.Open(log_path, 0));
+  EXPECT_EQ(TPM_RC_FAILURE, utility_.ExtendPCRs(events, nullptr, &event_log));
+}
+
+TEST_F(TpmUtilityTest, ExtendPCRsBadParam) {
+  SetExistingPCRSExpectation(false, true);
+  EXPECT_CALL(mock_tpm_, SendCommandsAndWait(_)).Times(0);
+  std::vector<TpmUtility::PCREvent> events = {{-1, 0xD, "event"}};
+  EXPECT_EQ(TPM_RC_FAILURE, utility_.ExtendPCRs(events, nullptr, nullptr));
+}
+
+TEST_F(TpmUtilityTest, ExtendPCRsCapabilityFail) {
+  EXPECT_CALL(mock_tpm_, GetCapabilitySync(TPM_CAP_PCRS, _, _, _, _, _))
+      .WillOnce(Return(TPM_RC_FAILURE));
+  std::vector<TpmUtility::PCREvent> events = {{1, 0xD, "event"}};
+  EXPECT_EQ(TPM_RC_FAILURE, utility_.ExtendPCRs(events, nullptr, nullptr));
+}
+
 TEST_F(TpmUtilityTest, ReadPCRSuccess) {
   // The |pcr_index| is chosen to match the structure for |pcr_select|.
   // If you change |pcr_index|, remember to change |pcr_select|.
@@ -488,6 +723,51 @@ TEST_F(TpmUtilityTest, AsymmetricEncryptSuccess) {
   EXPECT_EQ(0, ciphertext.compare(output_ciphertext));
 }
 
+TEST_F(TpmUtilityTest, AsymmetricEncryptSoftware) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  bssl::UniquePtr<RSA> rsa = SetupSoftwareKey(key_handle, kDecrypt);
+  EXPECT_CALL(mock_tpm_, RSA_EncryptSync(_, _, _, _, _, _, _)).Times(0);
+  std::string plaintext("plaintext");
+  std::string ciphertext;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.AsymmetricEncrypt(key_handle, TPM_ALG_OAEP, TPM_ALG_SHA1,
+                                       plaintext, nullptr, &ciphertext));
+  std::string decrypted(RSA_size(rsa.get()), 0);
+  int length = RSA_private_decrypt(
+      ciphertext.size(), reinterpret_cast<const uint8_t*>(ciphertext.data()),
+      reinterpret_cast<uint8_t*>(base::string_as_array(&decrypted)), rsa.get(),
+      RSA_PKCS1_OAEP_PADDING);
+  ASSERT_GT(length, 0);
+  decrypted.resize(length);
+  EXPECT_EQ(plaintext, decrypted);
+  // The TPM rejects plaintext that does not fit; so does the software path.
+  std::string large_plaintext(RSA_size(rsa.get()), 'a');
+  EXPECT_EQ(TPM_RC_VALUE,
+            utility_.AsymmetricEncrypt(key_handle, TPM_ALG_OAEP, TPM_ALG_SHA1,
+                                       large_plaintext, nullptr, &ciphertext));
+}
+
+TEST_F(TpmUtilityTest, AsymmetricEncryptSoftwareKeyScheme) {
+  TPM_HANDLE key_handle;
+  TPM2B_PUBLIC public_area;
+  public_area.public_area.type = TPM_ALG_RSA;
+  public_area.public_area.object_attributes = kDecrypt;
+  public_area.public_area.auth_policy.size = 0;
+  public_area.public_area.unique.rsa.size = 0;
+  public_area.public_area.parameters.rsa_detail.scheme.scheme = TPM_ALG_OAEP;
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillRepeatedly(
+          DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  // Keys with a scheme of their own are always left to the TPM.
+  EXPECT_CALL(mock_tpm_, RSA_EncryptSync(key_handle, _, _, _, _, _, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  utility_.SetSoftwarePublicKeyOperations(true);
+  std::string ciphertext;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.AsymmetricEncrypt(key_handle, TPM_ALG_NULL, TPM_ALG_NULL,
+                                       "plaintext", nullptr, &ciphertext));
+}
+
 TEST_F(TpmUtilityTest, AsymmetricEncryptFail) {
   TPM_HANDLE key_handle;
   std::string plaintext;
@@ -703,6 +983,49 @@ TEST_F(TpmUtilityTest, AsymmetricDecryptSchemeForward) {
   EXPECT_EQ(scheme.scheme, TPM_ALG_RSAES);
 }
 
+TEST_F(TpmUtilityTest, KeyPublicAreaIsCachedAcrossInstances) {
+  TPM_HANDLE key_handle = kRSAStorageRootKey;
+  TPM2B_PUBLIC public_area;
+  public_area.public_area = CreateDefaultPublicArea(TPM_ALG_RSA);
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  std::string name;
+  EXPECT_EQ(TPM_RC_SUCCESS, utility_.GetKeyName(key_handle, &name));
+  std::string expected_name;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            ComputeKeyName(public_area.public_area, &expected_name));
+  EXPECT_EQ(expected_name, name);
+  // A second utility from the same factory doesn't read the key again.
+  TpmUtilityImpl other_utility(factory_);
+  TPMT_PUBLIC other_public_area;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            other_utility.GetKeyPublicArea(key_handle, &other_public_area));
+  EXPECT_EQ(public_area.public_area.type, other_public_area.type);
+  std::string other_name;
+  EXPECT_EQ(TPM_RC_SUCCESS, other_utility.GetKeyName(key_handle, &other_name));
+  EXPECT_EQ(expected_name, other_name);
+}
+
+TEST_F(TpmUtilityTest, TransientKeyIsNotCached) {
+  // Another client may flush the handle and load a different key at it.
+  TPM_HANDLE key_handle = TRANSIENT_FIRST;
+  TPM2B_PUBLIC public_area;
+  public_area.public_area = CreateDefaultPublicArea(TPM_ALG_RSA);
+  TPM2B_PUBLIC other_public_area;
+  other_public_area.public_area = CreateDefaultPublicArea(TPM_ALG_ECC);
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)))
+      .WillOnce(
+          DoAll(SetArgPointee<2>(other_public_area), Return(TPM_RC_SUCCESS)));
+  TPMT_PUBLIC public_data;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.GetKeyPublicArea(key_handle, &public_data));
+  EXPECT_EQ(TPM_ALG_RSA, public_data.type);
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.GetKeyPublicArea(key_handle, &public_data));
+  EXPECT_EQ(TPM_ALG_ECC, public_data.type);
+}
+
 TEST_F(TpmUtilityTest, SignSuccess) {
   TPM_HANDLE key_handle;
   std::string password("password");
@@ -885,6 +1208,256 @@ TEST_F(TpmUtilityTest, SignSchemeForward) {
   EXPECT_EQ(scheme.details.rsapss.hash_alg, TPM_ALG_SHA1);
 }
 
+TEST_F(TpmUtilityTest, SignBatchValidatesKeyOnce) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  TPM2B_PUBLIC public_area;
+  public_area.public_area.type = TPM_ALG_RSA;
+  public_area.public_area.object_attributes = kSign;
+  public_area.public_area.auth_policy.size = 0;
+  public_area.public_area.unique.rsa.size = 0;
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  TPMT_SIGNATURE signature_out;
+  signature_out.signature.rsassa.sig.size = 2;
+  signature_out.signature.rsassa.sig.buffer[0] = 'h';
+  signature_out.signature.rsassa.sig.buffer[1] = 'i';
+  EXPECT_CALL(mock_tpm_, SignSync(key_handle, _, _, _, _, _,
+                                  &mock_authorization_delegate_))
+      .WillOnce(DoAll(SetArgPointee<5>(signature_out), Return(TPM_RC_SUCCESS)))
+      .WillOnce(Return(TPM_RC_FAILURE))
+      .WillOnce(DoAll(SetArgPointee<5>(signature_out), Return(TPM_RC_SUCCESS)));
+  std::vector<std::string> digests(3, std::string(32, 'a'));
+  std::vector<std::string> signatures;
+  std::vector<TPM_RC> results;
+  EXPECT_EQ(TPM_RC_FAILURE,
+            utility_.SignBatch(key_handle, TPM_ALG_NULL, TPM_ALG_NULL, digests,
+                               &mock_authorization_delegate_, &signatures,
+                               &results));
+  ASSERT_EQ(3u, signatures.size());
+  ASSERT_EQ(3u, results.size());
+  EXPECT_EQ("hi", signatures[0]);
+  EXPECT_EQ(TPM_RC_SUCCESS, results[0]);
+  EXPECT_EQ("", signatures[1]);
+  EXPECT_EQ(TPM_RC_FAILURE, results[1]);
+  EXPECT_EQ("hi", signatures[2]);
+  EXPECT_EQ(TPM_RC_SUCCESS, results[2]);
+}
+
+TEST_F(TpmUtilityTest, SignBatchBadDigestSize) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  TPM2B_PUBLIC public_area;
+  public_area.public_area.type = TPM_ALG_RSA;
+  public_area.public_area.object_attributes = kSign;
+  public_area.public_area.auth_policy.size = 0;
+  public_area.public_area.unique.rsa.size = 0;
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  TPMT_SIGNATURE signature_out;
+  signature_out.signature.rsassa.sig.size = 2;
+  signature_out.signature.rsassa.sig.buffer[0] = 'h';
+  signature_out.signature.rsassa.sig.buffer[1] = 'i';
+  EXPECT_CALL(mock_tpm_, SignSync(key_handle, _, _, _, _, _,
+                                  &mock_authorization_delegate_))
+      .WillOnce(DoAll(SetArgPointee<5>(signature_out), Return(TPM_RC_SUCCESS)));
+  // A SHA-1 sized digest and one too large for a TPM2B_DIGEST.
+  std::vector<std::string> digests = {std::string(20, 'a'),
+                                      std::string(32, 'a'),
+                                      std::string(100, 'a')};
+  std::vector<std::string> signatures;
+  std::vector<TPM_RC> results;
+  EXPECT_EQ(SAPI_RC_BAD_SIZE,
+            utility_.SignBatch(key_handle, TPM_ALG_NULL, TPM_ALG_SHA256,
+                               digests, &mock_authorization_delegate_,
+                               &signatures, &results));
+  ASSERT_EQ(3u, results.size());
+  EXPECT_EQ(SAPI_RC_BAD_SIZE, results[0]);
+  EXPECT_EQ(TPM_RC_SUCCESS, results[1]);
+  EXPECT_EQ("hi", signatures[1]);
+  EXPECT_EQ(SAPI_RC_BAD_SIZE, results[2]);
+}
+
+TEST_F(TpmUtilityTest, SignBatchBadKey) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  TPM2B_PUBLIC public_area;
+  public_area.public_area.type = TPM_ALG_RSA;
+  public_area.public_area.object_attributes = kDecrypt;
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, SignSync(_, _, _, _, _, _, _)).Times(0);
+  std::vector<std::string> digests(3, std::string(32, 'a'));
+  std::vector<std::string> signatures;
+  std::vector<TPM_RC> results;
+  EXPECT_EQ(SAPI_RC_BAD_PARAMETER,
+            utility_.SignBatch(key_handle, TPM_ALG_NULL, TPM_ALG_NULL, digests,
+                               &mock_authorization_delegate_, &signatures,
+                               &results));
+}
+
+TEST_F(TpmUtilityTest, SignStreamSoftwareHash) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  TPM2B_PUBLIC public_area;
+  public_area.public_area.type = TPM_ALG_RSA;
+  public_area.public_area.object_attributes = kSign;
+  public_area.public_area.auth_policy.size = 0;
+  public_area.public_area.unique.rsa.size = 0;
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillRepeatedly(
+          DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  TPMT_SIGNATURE signature_out;
+  signature_out.signature.rsassa.sig.size = 2;
+  signature_out.signature.rsassa.sig.buffer[0] = 'h';
+  signature_out.signature.rsassa.sig.buffer[1] = 'i';
+  TPM2B_DIGEST tpm_digest;
+  EXPECT_CALL(mock_tpm_, HashSequenceStartSync(_, _, _, _)).Times(0);
+  EXPECT_CALL(mock_tpm_, SignSync(key_handle, _, _, _, _, _,
+                                  &mock_authorization_delegate_))
+      .WillOnce(DoAll(SaveArg<2>(&tpm_digest), SetArgPointee<5>(signature_out),
+                      Return(TPM_RC_SUCCESS)));
+  std::unique_ptr<TpmUtility::SignStream> stream;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.SignStreamBegin(key_handle, TPM_ALG_NULL, TPM_ALG_NULL,
+                                     false, &mock_authorization_delegate_,
+                                     &stream));
+  EXPECT_EQ(TPM_RC_SUCCESS, utility_.SignStreamUpdate(stream.get(), "plain"));
+  EXPECT_EQ(TPM_RC_SUCCESS, utility_.SignStreamUpdate(stream.get(), "text"));
+  std::string signature;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.SignStreamFinish(stream.get(), &signature));
+  EXPECT_EQ("hi", signature);
+  EXPECT_EQ(crypto::SHA256HashString("plaintext"),
+            StringFrom_TPM2B_DIGEST(tpm_digest));
+  EXPECT_EQ(SAPI_RC_BAD_PARAMETER,
+            utility_.SignStreamFinish(stream.get(), &signature));
+}
+
+TEST_F(TpmUtilityTest, SignStreamRestrictedKeyNeedsHashSequence) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  TPM2B_PUBLIC public_area;
+  public_area.public_area.type = TPM_ALG_RSA;
+  public_area.public_area.object_attributes = kSign | kRestricted;
+  public_area.public_area.auth_policy.size = 0;
+  public_area.public_area.unique.rsa.size = 0;
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillRepeatedly(
+          DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  std::unique_ptr<TpmUtility::SignStream> stream;
+  EXPECT_EQ(SAPI_RC_BAD_PARAMETER,
+            utility_.SignStreamBegin(key_handle, TPM_ALG_NULL, TPM_ALG_NULL,
+                                     false, &mock_authorization_delegate_,
+                                     &stream));
+  EXPECT_EQ(nullptr, stream.get());
+}
+
+TEST_F(TpmUtilityTest, SignStreamHashSequence) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  TPMI_DH_OBJECT sequence_handle = TRANSIENT_FIRST + 5;
+  TPM2B_PUBLIC public_area;
+  public_area.public_area.type = TPM_ALG_RSA;
+  public_area.public_area.object_attributes = kSign | kRestricted;
+  public_area.public_area.auth_policy.size = 0;
+  public_area.public_area.unique.rsa.size = 0;
+  // The key's public area is read only once.
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, HashSequenceStartSync(_, TPM_ALG_SHA256, _, _))
+      .WillOnce(
+          DoAll(SetArgPointee<2>(sequence_handle), Return(TPM_RC_SUCCESS)));
+  // 2500 bytes in total: two full buffers are sent with SequenceUpdate and
+  // the remaining 452 bytes with SequenceComplete.
+  EXPECT_CALL(mock_tpm_, SequenceUpdateSync(sequence_handle, _, _, _))
+      .Times(2)
+      .WillRepeatedly(Return(TPM_RC_SUCCESS));
+  TPM2B_MAX_BUFFER last_buffer;
+  TPMT_TK_HASHCHECK ticket;
+  ticket.tag = TPM_ST_HASHCHECK;
+  ticket.hierarchy = TPM_RH_OWNER;
+  ticket.digest = Make_TPM2B_DIGEST("ticket");
+  EXPECT_CALL(mock_tpm_, SequenceCompleteSync(sequence_handle, _, _,
+                                              TPM_RH_OWNER, _, _, _))
+      .WillOnce(DoAll(SaveArg<2>(&last_buffer),
+                      SetArgPointee<4>(Make_TPM2B_DIGEST("digest")),
+                      SetArgPointee<5>(ticket), Return(TPM_RC_SUCCESS)));
+  TPMT_SIGNATURE signature_out;
+  signature_out.signature.rsassa.sig.size = 0;
+  TPMT_TK_HASHCHECK validation;
+  EXPECT_CALL(mock_tpm_, SignSync(key_handle, _, _, _, _, _, _))
+      .WillOnce(DoAll(SaveArg<4>(&validation), SetArgPointee<5>(signature_out),
+                      Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, FlushContextSync(_, _)).Times(0);
+  std::unique_ptr<TpmUtility::SignStream> stream;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.SignStreamBegin(key_handle, TPM_ALG_NULL, TPM_ALG_NULL,
+                                     true, &mock_authorization_delegate_,
+                                     &stream));
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.SignStreamUpdate(stream.get(), std::string(1500, 'a')));
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.SignStreamUpdate(stream.get(), std::string(1000, 'b')));
+  std::string signature;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.SignStreamFinish(stream.get(), &signature));
+  EXPECT_EQ(452, last_buffer.size);
+  EXPECT_EQ(TPM_RH_OWNER, validation.hierarchy);
+  EXPECT_EQ("ticket", StringFrom_TPM2B_DIGEST(validation.digest));
+}
+
+TEST_F(TpmUtilityTest, SignStreamHashSequenceNullTicket) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  TPMI_DH_OBJECT sequence_handle = TRANSIENT_FIRST + 5;
+  TPM2B_PUBLIC public_area;
+  public_area.public_area.type = TPM_ALG_RSA;
+  public_area.public_area.object_attributes = kSign;
+  public_area.public_area.auth_policy.size = 0;
+  public_area.public_area.unique.rsa.size = 0;
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillRepeatedly(
+          DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, HashSequenceStartSync(_, _, _, _))
+      .WillOnce(
+          DoAll(SetArgPointee<2>(sequence_handle), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, SequenceCompleteSync(sequence_handle, _, _,
+                                              TPM_RH_NULL, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<4>(Make_TPM2B_DIGEST("digest")),
+                      Return(TPM_RC_SUCCESS)));
+  TPMT_SIGNATURE signature_out;
+  signature_out.signature.rsassa.sig.size = 0;
+  EXPECT_CALL(mock_tpm_, SignSync(key_handle, _, _, _, _, _, _))
+      .WillOnce(
+          DoAll(SetArgPointee<5>(signature_out), Return(TPM_RC_SUCCESS)));
+  std::unique_ptr<TpmUtility::SignStream> stream;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.SignStreamBegin(key_handle, TPM_ALG_NULL, TPM_ALG_NULL,
+                                     true, &mock_authorization_delegate_,
+                                     &stream));
+  std::string signature;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.SignStreamFinish(stream.get(), &signature));
+}
+
+TEST_F(TpmUtilityTest, SignStreamFlushesAbandonedSequence) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  TPMI_DH_OBJECT sequence_handle = TRANSIENT_FIRST + 5;
+  TPM2B_PUBLIC public_area;
+  public_area.public_area.type = TPM_ALG_RSA;
+  public_area.public_area.object_attributes = kSign;
+  public_area.public_area.auth_policy.size = 0;
+  public_area.public_area.unique.rsa.size = 0;
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillRepeatedly(
+          DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, HashSequenceStartSync(_, _, _, _))
+      .WillOnce(
+          DoAll(SetArgPointee<2>(sequence_handle), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, FlushContextSync(sequence_handle, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  std::unique_ptr<TpmUtility::SignStream> stream;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.SignStreamBegin(key_handle, TPM_ALG_NULL, TPM_ALG_NULL,
+                                     true, &mock_authorization_delegate_,
+                                     &stream));
+  stream.reset();
+}
+
 TEST_F(TpmUtilityTest, VerifySuccess) {
   TPM_HANDLE key_handle;
   std::string digest(32, 'a');
@@ -919,6 +1492,42 @@ TEST_F(TpmUtilityTest, VerifyFail) {
                             signature, nullptr));
 }
 
+TEST_F(TpmUtilityTest, VerifySoftware) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  bssl::UniquePtr<RSA> rsa = SetupSoftwareKey(key_handle, kSign);
+  EXPECT_CALL(mock_tpm_, VerifySignatureSync(_, _, _, _, _, _)).Times(0);
+  std::string plaintext("plaintext");
+  std::string digest = crypto::SHA256HashString(plaintext);
+  std::string signature(RSA_size(rsa.get()), 0);
+  unsigned int signature_length = 0;
+  ASSERT_TRUE(RSA_sign(
+      NID_sha256, reinterpret_cast<const uint8_t*>(digest.data()),
+      digest.size(),
+      reinterpret_cast<uint8_t*>(base::string_as_array(&signature)),
+      &signature_length, rsa.get()));
+  signature.resize(signature_length);
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.Verify(key_handle, TPM_ALG_RSASSA, TPM_ALG_SHA256,
+                            plaintext, signature, nullptr));
+  EXPECT_EQ(TPM_RC_SIGNATURE,
+            utility_.Verify(key_handle, TPM_ALG_RSASSA, TPM_ALG_SHA256,
+                            "other plaintext", signature, nullptr));
+  EXPECT_EQ(TPM_RC_SIGNATURE,
+            utility_.Verify(key_handle, TPM_ALG_RSAPSS, TPM_ALG_SHA256,
+                            plaintext, signature, nullptr));
+}
+
+TEST_F(TpmUtilityTest, VerifySoftwareDisabled) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  SetupSoftwareKey(key_handle, kSign);
+  utility_.SetSoftwarePublicKeyOperations(false);
+  EXPECT_CALL(mock_tpm_, VerifySignatureSync(key_handle, _, _, _, _, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.Verify(key_handle, TPM_ALG_RSASSA, TPM_ALG_SHA256,
+                            "plaintext", "signature", nullptr));
+}
+
 TEST_F(TpmUtilityTest, VerifyBadParams1) {
   TPM_HANDLE key_handle;
   std::string digest(32, 'a');
@@ -955,6 +1564,7 @@ TEST_F(TpmUtilityTest, VerifyBadParams3) {
   std::string signature;
   TPM2B_PUBLIC public_area;
   public_area.public_area.type = TPM_ALG_ECC;
+  public_area.public_area.parameters.ecc_detail.curve_id = TPM_ECC_NIST_P384;
   public_area.public_area.object_attributes = kSign;
   EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
       .WillRepeatedly(
@@ -1034,6 +1644,96 @@ TEST_F(TpmUtilityTest, VerifySchemeForward) {
   EXPECT_EQ(signature_in.signature.rsassa.hash, TPM_ALG_SHA1);
 }
 
+TEST_F(TpmUtilityTest, SignECCSuccess) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  std::string digest(32, 'a');
+  TPM2B_PUBLIC public_area;
+  public_area.public_area = CreateDefaultPublicArea(TPM_ALG_ECC);
+  public_area.public_area.object_attributes = kSign;
+  public_area.public_area.parameters.ecc_detail.scheme.scheme = TPM_ALG_NULL;
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillRepeatedly(
+          DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  // The TPM may strip leading zeros from r and s.
+  TPMT_SIGNATURE signature_out;
+  signature_out.sig_alg = TPM_ALG_ECDSA;
+  signature_out.signature.ecdsa.signature_r =
+      Make_TPM2B_ECC_PARAMETER(std::string(31, 'r'));
+  signature_out.signature.ecdsa.signature_s =
+      Make_TPM2B_ECC_PARAMETER(std::string(32, 's'));
+  TPMT_SIG_SCHEME scheme;
+  EXPECT_CALL(mock_tpm_, SignSync(key_handle, _, _, _, _, _,
+                                  &mock_authorization_delegate_))
+      .WillOnce(DoAll(SaveArg<3>(&scheme), SetArgPointee<5>(signature_out),
+                      Return(TPM_RC_SUCCESS)));
+  std::string signature;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.Sign(key_handle, TPM_ALG_NULL, TPM_ALG_NULL, digest,
+                          &mock_authorization_delegate_, &signature));
+  EXPECT_EQ(TPM_ALG_ECDSA, scheme.scheme);
+  EXPECT_EQ(TPM_ALG_SHA256, scheme.details.ecdsa.hash_alg);
+  EXPECT_EQ(std::string(1, '\0') + std::string(31, 'r') + std::string(32, 's'),
+            signature);
+}
+
+TEST_F(TpmUtilityTest, SignECCBadCurve) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  std::string digest(32, 'a');
+  TPM2B_PUBLIC public_area;
+  public_area.public_area = CreateDefaultPublicArea(TPM_ALG_ECC);
+  public_area.public_area.object_attributes = kSign;
+  public_area.public_area.parameters.ecc_detail.curve_id = TPM_ECC_NIST_P384;
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillRepeatedly(
+          DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, SignSync(_, _, _, _, _, _, _)).Times(0);
+  std::string signature;
+  EXPECT_EQ(SAPI_RC_BAD_PARAMETER,
+            utility_.Sign(key_handle, TPM_ALG_ECDSA, TPM_ALG_NULL, digest,
+                          &mock_authorization_delegate_, &signature));
+}
+
+TEST_F(TpmUtilityTest, VerifyECCSuccess) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  std::string digest(32, 'a');
+  std::string signature = std::string(32, 'r') + std::string(32, 's');
+  TPM2B_PUBLIC public_area;
+  public_area.public_area = CreateDefaultPublicArea(TPM_ALG_ECC);
+  public_area.public_area.object_attributes = kSign;
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillRepeatedly(
+          DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  TPMT_SIGNATURE signature_in;
+  EXPECT_CALL(mock_tpm_, VerifySignatureSync(key_handle, _, _, _, _, _))
+      .WillOnce(DoAll(SaveArg<3>(&signature_in), Return(TPM_RC_SUCCESS)));
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.Verify(key_handle, TPM_ALG_ECDSA, TPM_ALG_NULL, digest,
+                            signature, nullptr));
+  EXPECT_EQ(TPM_ALG_ECDSA, signature_in.sig_alg);
+  EXPECT_EQ(TPM_ALG_SHA256, signature_in.signature.ecdsa.hash);
+  EXPECT_EQ(std::string(32, 'r'),
+            StringFrom_TPM2B_ECC_PARAMETER(
+                signature_in.signature.ecdsa.signature_r));
+  EXPECT_EQ(std::string(32, 's'),
+            StringFrom_TPM2B_ECC_PARAMETER(
+                signature_in.signature.ecdsa.signature_s));
+}
+
+TEST_F(TpmUtilityTest, VerifyECCBadSignatureSize) {
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  std::string digest(32, 'a');
+  TPM2B_PUBLIC public_area;
+  public_area.public_area = CreateDefaultPublicArea(TPM_ALG_ECC);
+  public_area.public_area.object_attributes = kSign;
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(key_handle, _, _, _, _, _))
+      .WillRepeatedly(
+          DoAll(SetArgPointee<2>(public_area), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, VerifySignatureSync(_, _, _, _, _, _)).Times(0);
+  EXPECT_EQ(TPM_RC_SIGNATURE,
+            utility_.Verify(key_handle, TPM_ALG_NULL, TPM_ALG_NULL, digest,
+                            std::string(63, 'x'), nullptr));
+}
+
 TEST_F(TpmUtilityTest, CertifyCreationSuccess) {
   TPM_HANDLE key_handle = 42;
   std::string creation_blob;
@@ -1230,6 +1930,72 @@ TEST_F(TpmUtilityTest, ImportRSAKeyParserFail) {
                                   &mock_authorization_delegate_, &key_blob));
 }
 
+void RecordImportProgress(std::vector<size_t>* progress,
+                          size_t done,
+                          size_t total) {
+  EXPECT_EQ(3u, total);
+  progress->push_back(done);
+}
+
+TEST_F(TpmUtilityTest, ImportRSAKeysSuccess) {
+  std::vector<TpmUtility::RSAKeyImport> keys;
+  for (char c : {'a', 'b', 'c'}) {
+    keys.push_back({TpmUtility::AsymmetricKeyUsage::kSignKey,
+                    std::string(256, c), 0x10001, std::string(128, c), ""});
+  }
+  TPM2B_PUBLIC public_data[3];
+  EXPECT_CALL(mock_tpm_, ImportSync(kRSAStorageRootKey, _, _, _, _, _, _, _,
+                                    &mock_authorization_delegate_))
+      .WillOnce(DoAll(SaveArg<3>(&public_data[0]), Return(TPM_RC_SUCCESS)))
+      .WillOnce(DoAll(SaveArg<3>(&public_data[1]), Return(TPM_RC_SUCCESS)))
+      .WillOnce(DoAll(SaveArg<3>(&public_data[2]), Return(TPM_RC_SUCCESS)));
+  std::vector<size_t> progress;
+  std::vector<TPM_RC> results;
+  std::vector<std::string> key_blobs;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.ImportRSAKeys(keys, &mock_authorization_delegate_,
+                                   base::Bind(&RecordImportProgress, &progress),
+                                   &results, &key_blobs));
+  EXPECT_EQ(std::vector<size_t>({1, 2, 3}), progress);
+  EXPECT_EQ(std::vector<TPM_RC>(3, TPM_RC_SUCCESS), results);
+  EXPECT_EQ(3u, key_blobs.size());
+  // The keys are imported in order.
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(keys[i].modulus, StringFrom_TPM2B_PUBLIC_KEY_RSA(
+                                   public_data[i].public_area.unique.rsa));
+  }
+}
+
+TEST_F(TpmUtilityTest, ImportRSAKeysPartialFailure) {
+  std::vector<TpmUtility::RSAKeyImport> keys(
+      3, {TpmUtility::AsymmetricKeyUsage::kDecryptKey, std::string(256, 'a'),
+          0x10001, std::string(128, 'b'), ""});
+  EXPECT_CALL(mock_tpm_, ImportSync(_, _, _, _, _, _, _, _, _))
+      .WillOnce(Return(TPM_RC_SUCCESS))
+      .WillOnce(Return(TPM_RC_FAILURE))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  std::vector<size_t> progress;
+  std::vector<TPM_RC> results;
+  std::vector<std::string> key_blobs;
+  EXPECT_EQ(TPM_RC_FAILURE,
+            utility_.ImportRSAKeys(keys, &mock_authorization_delegate_,
+                                   base::Bind(&RecordImportProgress, &progress),
+                                   &results, &key_blobs));
+  EXPECT_EQ(3u, progress.size());
+  EXPECT_EQ(
+      std::vector<TPM_RC>({TPM_RC_SUCCESS, TPM_RC_FAILURE, TPM_RC_SUCCESS}),
+      results);
+}
+
+TEST_F(TpmUtilityTest, ImportRSAKeysBadDelegate) {
+  std::vector<TPM_RC> results;
+  std::vector<std::string> key_blobs;
+  EXPECT_EQ(SAPI_RC_INVALID_SESSIONS,
+            utility_.ImportRSAKeys({}, nullptr,
+                                   TpmUtility::ImportProgressCallback(),
+                                   &results, &key_blobs));
+}
+
 TEST_F(TpmUtilityTest, CreateRSAKeyPairSuccess) {
   TPM2B_PUBLIC public_area;
   TPML_PCR_SELECTION creation_pcrs;
@@ -1353,6 +2119,128 @@ TEST_F(TpmUtilityTest, CreateRSAKeyPairCreationParserFail) {
                 &mock_authorization_delegate_, &key_blob, &creation_blob));
 }
 
+TEST_F(TpmUtilityTest, CreateRSAKeyPairFromPool) {
+  RsaKeyPool* pool = factory_.GetRsaKeyPool();
+  pool->Configure(1, base::TimeDelta());
+  RsaKeyPool::KeyTemplate key_template = {
+      TpmUtility::AsymmetricKeyUsage::kDecryptKey, 2048, 0x10001};
+  RsaKeyPool::PooledKey pooled_key;
+  pooled_key.key_blob = "pooled_key_blob";
+  pooled_key.creation_blob = "pooled_creation_blob";
+  pooled_key.auth_value = "temporary_auth";
+  pool->AddKey(key_template, pooled_key);
+  TPM_HANDLE key_handle = TPM_RH_FIRST;
+  TPM2B_AUTH new_auth;
+  EXPECT_CALL(mock_tpm_, LoadSync(kRSAStorageRootKey, _, _, _, _, _,
+                                  &mock_authorization_delegate_))
+      .WillOnce(DoAll(SetArgPointee<4>(key_handle), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_hmac_session_, GetDelegate())
+      .WillRepeatedly(Return(&mock_authorization_delegate_));
+  EXPECT_CALL(mock_hmac_session_,
+              SetEntityAuthorizationValue(pooled_key.auth_value));
+  EXPECT_CALL(mock_tpm_, ObjectChangeAuthSync(key_handle, _, _, _, _, _,
+                                              &mock_authorization_delegate_))
+      .WillOnce(DoAll(SaveArg<4>(&new_auth), Return(TPM_RC_SUCCESS)));
+  // Only the second request needs a new key.
+  EXPECT_CALL(mock_tpm_, CreateSyncShort(kRSAStorageRootKey, _, _, _, _, _, _,
+                                         _, _, &mock_authorization_delegate_))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  std::string key_blob;
+  std::string creation_blob;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.CreateRSAKeyPair(
+                TpmUtility::AsymmetricKeyUsage::kDecryptKey, 2048, 0x10001,
+                "password", "", false, kNoCreationPCR,
+                &mock_authorization_delegate_, &key_blob, &creation_blob));
+  EXPECT_EQ("password", StringFrom_TPM2B_DIGEST(new_auth));
+  EXPECT_EQ("pooled_creation_blob", creation_blob);
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.CreateRSAKeyPair(
+                TpmUtility::AsymmetricKeyUsage::kDecryptKey, 2048, 0x10001,
+                "password", "", false, kNoCreationPCR,
+                &mock_authorization_delegate_, &key_blob, &creation_blob));
+}
+
+TEST_F(TpmUtilityTest, FillRSAKeyPool) {
+  RsaKeyPool* pool = factory_.GetRsaKeyPool();
+  // Nothing happens while the pool is disabled.
+  EXPECT_EQ(TPM_RC_SUCCESS, utility_.FillRSAKeyPool());
+  pool->Configure(1, base::TimeDelta());
+  RsaKeyPool::KeyTemplate key_template = {
+      TpmUtility::AsymmetricKeyUsage::kSignKey, 2048, 0x10001};
+  pool->AddTemplate(key_template);
+  TPM2B_SENSITIVE_CREATE sensitive_create;
+  EXPECT_CALL(mock_hmac_session_, GetDelegate())
+      .WillRepeatedly(Return(&mock_authorization_delegate_));
+  EXPECT_CALL(mock_tpm_, CreateSyncShort(kRSAStorageRootKey, _, _, _, _, _, _,
+                                         _, _, &mock_authorization_delegate_))
+      .WillOnce(DoAll(SaveArg<1>(&sensitive_create), Return(TPM_RC_SUCCESS)));
+  EXPECT_EQ(TPM_RC_SUCCESS, utility_.FillRSAKeyPool());
+  // The pool is full now.
+  EXPECT_EQ(TPM_RC_SUCCESS, utility_.FillRSAKeyPool());
+  RsaKeyPool::PooledKey pooled_key;
+  ASSERT_TRUE(pool->TakeKey(key_template, &pooled_key));
+  EXPECT_EQ(static_cast<size_t>(SHA256_DIGEST_SIZE),
+            pooled_key.auth_value.size());
+  EXPECT_EQ(pooled_key.auth_value,
+            StringFrom_TPM2B_DIGEST(sensitive_create.sensitive.user_auth));
+}
+
+TEST_F(TpmUtilityTest, CreateRSAKeyPairPolicyOnlyBypassesPool) {
+  RsaKeyPool* pool = factory_.GetRsaKeyPool();
+  pool->Configure(1, base::TimeDelta());
+  RsaKeyPool::KeyTemplate key_template = {
+      TpmUtility::AsymmetricKeyUsage::kSignKey, 2048, 0x10001};
+  RsaKeyPool::PooledKey pooled_key;
+  pooled_key.key_blob = "pooled_key_blob";
+  pooled_key.auth_value = "temporary_auth";
+  pool->AddKey(key_template, pooled_key);
+  // Pooled keys have userWithAuth set, so a fresh key must be created.
+  TPM2B_PUBLIC public_area;
+  EXPECT_CALL(mock_tpm_, LoadSync(_, _, _, _, _, _, _)).Times(0);
+  EXPECT_CALL(mock_tpm_, CreateSyncShort(kRSAStorageRootKey, _, _, _, _, _, _,
+                                         _, _, &mock_authorization_delegate_))
+      .WillOnce(DoAll(SaveArg<2>(&public_area), Return(TPM_RC_SUCCESS)));
+  std::string key_blob;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.CreateRSAKeyPair(
+                TpmUtility::AsymmetricKeyUsage::kSignKey, 2048, 0x10001,
+                "password", "", true /* use_only_policy_authorization */,
+                kNoCreationPCR, &mock_authorization_delegate_, &key_blob,
+                nullptr));
+  EXPECT_EQ(public_area.public_area.object_attributes & kUserWithAuth, 0u);
+  // The pooled key is still available.
+  EXPECT_TRUE(pool->TakeKey(key_template, &pooled_key));
+}
+
+TEST_F(TpmUtilityTest, CreateECCKeyPairSuccess) {
+  TPM2B_PUBLIC public_area;
+  EXPECT_CALL(mock_tpm_, CreateSyncShort(kECCStorageRootKey, _, _, _, _, _, _,
+                                         _, _, &mock_authorization_delegate_))
+      .WillOnce(DoAll(SaveArg<2>(&public_area), Return(TPM_RC_SUCCESS)));
+  std::string key_blob;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.CreateECCKeyPair(
+                TpmUtility::AsymmetricKeyUsage::kSignKey, "password", "", false,
+                kNoCreationPCR, &mock_authorization_delegate_, &key_blob,
+                nullptr));
+  EXPECT_EQ(TPM_ALG_ECC, public_area.public_area.type);
+  EXPECT_EQ(TPM_ECC_NIST_P256,
+            public_area.public_area.parameters.ecc_detail.curve_id);
+  EXPECT_EQ(TPM_ALG_NULL,
+            public_area.public_area.parameters.ecc_detail.scheme.scheme);
+  EXPECT_EQ(kSign, public_area.public_area.object_attributes & kSign);
+  EXPECT_EQ(0u, public_area.public_area.object_attributes & kDecrypt);
+}
+
+TEST_F(TpmUtilityTest, CreateECCKeyPairBadDelegate) {
+  std::string key_blob;
+  EXPECT_EQ(SAPI_RC_INVALID_SESSIONS,
+            utility_.CreateECCKeyPair(TpmUtility::AsymmetricKeyUsage::kSignKey,
+                                      "password", "", false, kNoCreationPCR,
+                                      nullptr, &key_blob, nullptr));
+}
+
 TEST_F(TpmUtilityTest, LoadKeySuccess) {
   TPM_HANDLE key_handle = TPM_RH_FIRST;
   TPM_HANDLE loaded_handle;
@@ -1393,6 +2281,19 @@ TEST_F(TpmUtilityTest, LoadKeyParserFail) {
       utility_.LoadKey(key_blob, &mock_authorization_delegate_, &key_handle));
 }
 
+TEST_F(TpmUtilityTest, LoadKeyECC) {
+  TPM2B_PUBLIC public_area;
+  public_area.public_area = CreateDefaultPublicArea(TPM_ALG_ECC);
+  EXPECT_CALL(mock_blob_parser_, ParseKeyBlob(_, _, _))
+      .WillOnce(DoAll(SetArgPointee<1>(public_area), Return(true)));
+  EXPECT_CALL(mock_tpm_, LoadSync(kECCStorageRootKey, _, _, _, _, _,
+                                  &mock_authorization_delegate_))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  TPM_HANDLE key_handle;
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.LoadKey("", &mock_authorization_delegate_, &key_handle));
+}
+
 TEST_F(TpmUtilityTest, SealedDataSuccess) {
   std::string data_to_seal("seal_data");
   std::string sealed_data;
@@ -1501,6 +2402,177 @@ TEST_F(TpmUtilityTest, UnsealObjectFailure) {
                                 &unsealed_data));
 }
 
+TEST_F(TpmUtilityTest, UnsealDataNameFromBlob) {
+  TPM2B_PUBLIC public_info = Make_TPM2B_PUBLIC(
+      CreateDefaultPublicArea(TPM_ALG_KEYEDHASH));
+  std::string object_name;
+  ASSERT_EQ(TPM_RC_SUCCESS,
+            ComputeKeyName(public_info.public_area, &object_name));
+  EXPECT_CALL(mock_blob_parser_, ParseKeyBlob("sealed_data", _, _))
+      .WillRepeatedly(DoAll(SetArgPointee<1>(public_info), Return(true)));
+  std::string unsealed_data;
+  TPM_HANDLE object_handle = 42;
+  EXPECT_CALL(mock_tpm_, LoadSync(_, _, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<4>(object_handle), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(object_handle, _, _, _, _, _))
+      .Times(0);
+  EXPECT_CALL(mock_tpm_, UnsealSync(object_handle, object_name, _, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  EXPECT_CALL(mock_tpm_, FlushContextSync(object_handle, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.UnsealData("sealed_data", &mock_authorization_delegate_,
+                                &unsealed_data));
+}
+
+TEST_F(TpmUtilityTest, UnsealDataBadBlob) {
+  EXPECT_CALL(mock_blob_parser_, ParseKeyBlob(_, _, _)).WillOnce(Return(false));
+  EXPECT_CALL(mock_tpm_, UnsealSync(_, _, _, _)).Times(0);
+  std::string unsealed_data;
+  EXPECT_EQ(SAPI_RC_BAD_TCTI_STRUCTURE,
+            utility_.UnsealData("sealed_data", &mock_authorization_delegate_,
+                                &unsealed_data));
+}
+
+TEST_F(TpmUtilityTest, UnsealDataCached) {
+  factory_.GetObjectCache()->SetSealedObjectCacheSize(1);
+  TPM2B_PUBLIC public_info = Make_TPM2B_PUBLIC(
+      CreateDefaultPublicArea(TPM_ALG_KEYEDHASH));
+  EXPECT_CALL(mock_blob_parser_, ParseKeyBlob("sealed_data", _, _))
+      .WillRepeatedly(DoAll(SetArgPointee<1>(public_info), Return(true)));
+  std::string tpm_unsealed_data("password");
+  std::string unsealed_data;
+  TPM_HANDLE object_handle = 42;
+  EXPECT_CALL(mock_tpm_, LoadSync(_, _, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<4>(object_handle), Return(TPM_RC_SUCCESS)));
+  // The cached handle is checked before it is used again.
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(object_handle, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<2>(public_info), Return(TPM_RC_SUCCESS)));
+  TPM2B_SENSITIVE_DATA out_data = Make_TPM2B_SENSITIVE_DATA(tpm_unsealed_data);
+  EXPECT_CALL(mock_tpm_, UnsealSync(object_handle, _, _, _))
+      .Times(2)
+      .WillRepeatedly(
+          DoAll(SetArgPointee<2>(out_data), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, FlushContextSync(_, _)).Times(0);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(TPM_RC_SUCCESS,
+              utility_.UnsealData("sealed_data", &mock_authorization_delegate_,
+                                  &unsealed_data));
+    EXPECT_EQ(tpm_unsealed_data, unsealed_data);
+  }
+}
+
+TEST_F(TpmUtilityTest, UnsealDataCachedObjectGone) {
+  factory_.GetObjectCache()->SetSealedObjectCacheSize(1);
+  std::string unsealed_data;
+  TPM_HANDLE object_handle1 = 42;
+  TPM_HANDLE object_handle2 = 43;
+  EXPECT_CALL(mock_tpm_, LoadSync(_, _, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<4>(object_handle1), Return(TPM_RC_SUCCESS)))
+      .WillOnce(
+          DoAll(SetArgPointee<4>(object_handle2), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(object_handle1, _, _, _, _, _))
+      .WillOnce(Return(TPM_RC_HANDLE + kResourceManagerTpmErrorBase));
+  EXPECT_CALL(mock_tpm_, UnsealSync(object_handle1, _, _, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  EXPECT_CALL(mock_tpm_, UnsealSync(object_handle2, _, _, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  EXPECT_CALL(mock_tpm_, FlushContextSync(_, _)).Times(0);
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.UnsealData("sealed_data", &mock_authorization_delegate_,
+                                &unsealed_data));
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.UnsealData("sealed_data", &mock_authorization_delegate_,
+                                &unsealed_data));
+  TPM_HANDLE cached_handle = 0;
+  EXPECT_TRUE(factory_.GetObjectCache()->GetSealedObject(
+      crypto::SHA256HashString("sealed_data"), &cached_handle));
+  EXPECT_EQ(object_handle2, cached_handle);
+}
+
+TEST_F(TpmUtilityTest, UnsealDataCachedHandleReused) {
+  factory_.GetObjectCache()->SetSealedObjectCacheSize(1);
+  TPM2B_PUBLIC public_info = Make_TPM2B_PUBLIC(
+      CreateDefaultPublicArea(TPM_ALG_KEYEDHASH));
+  EXPECT_CALL(mock_blob_parser_, ParseKeyBlob("sealed_data", _, _))
+      .WillRepeatedly(DoAll(SetArgPointee<1>(public_info), Return(true)));
+  // After a restart the virtual handle names some other object.
+  TPM2B_PUBLIC other_public_info = Make_TPM2B_PUBLIC(
+      CreateDefaultPublicArea(TPM_ALG_RSA));
+  std::string unsealed_data;
+  TPM_HANDLE object_handle1 = 42;
+  TPM_HANDLE object_handle2 = 43;
+  EXPECT_CALL(mock_tpm_, LoadSync(_, _, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<4>(object_handle1), Return(TPM_RC_SUCCESS)))
+      .WillOnce(
+          DoAll(SetArgPointee<4>(object_handle2), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(object_handle1, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<2>(other_public_info),
+                      Return(TPM_RC_SUCCESS)));
+  // The other object is neither unsealed nor flushed.
+  EXPECT_CALL(mock_tpm_, UnsealSync(object_handle1, _, _, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  EXPECT_CALL(mock_tpm_, UnsealSync(object_handle2, _, _, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  EXPECT_CALL(mock_tpm_, FlushContextSync(_, _)).Times(0);
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.UnsealData("sealed_data", &mock_authorization_delegate_,
+                                &unsealed_data));
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.UnsealData("sealed_data", &mock_authorization_delegate_,
+                                &unsealed_data));
+}
+
+TEST_F(TpmUtilityTest, UnsealDataCachedByOtherThread) {
+  TpmObjectCache* cache = factory_.GetObjectCache();
+  cache->SetSealedObjectCacheSize(1);
+  std::string blob_digest = crypto::SHA256HashString("sealed_data");
+  std::string unsealed_data;
+  TPM_HANDLE other_handle = 42;
+  TPM_HANDLE object_handle = 43;
+  // Another thread caches the same blob while this one loads it, and is still
+  // using its handle.
+  auto add_other_handle = [cache, blob_digest, other_handle]() {
+    std::vector<TPM_HANDLE> evicted;
+    EXPECT_TRUE(cache->AddSealedObject(blob_digest, other_handle, &evicted));
+  };
+  EXPECT_CALL(mock_tpm_, LoadSync(_, _, _, _, _, _, _))
+      .WillOnce(DoAll(InvokeWithoutArgs(add_other_handle),
+                      SetArgPointee<4>(object_handle), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, UnsealSync(object_handle, _, _, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  // Only this call's own handle is flushed.
+  EXPECT_CALL(mock_tpm_, FlushContextSync(object_handle, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  EXPECT_CALL(mock_tpm_, FlushContextSync(other_handle, _)).Times(0);
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.UnsealData("sealed_data", &mock_authorization_delegate_,
+                                &unsealed_data));
+  TPM_HANDLE cached_handle = 0;
+  EXPECT_TRUE(cache->GetSealedObject(blob_digest, &cached_handle));
+  EXPECT_EQ(other_handle, cached_handle);
+}
+
+TEST_F(TpmUtilityTest, UnsealDataCacheEviction) {
+  factory_.GetObjectCache()->SetSealedObjectCacheSize(1);
+  std::string unsealed_data;
+  TPM_HANDLE object_handle1 = 42;
+  TPM_HANDLE object_handle2 = 43;
+  EXPECT_CALL(mock_tpm_, LoadSync(_, _, _, _, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<4>(object_handle1), Return(TPM_RC_SUCCESS)))
+      .WillOnce(
+          DoAll(SetArgPointee<4>(object_handle2), Return(TPM_RC_SUCCESS)));
+  EXPECT_CALL(mock_tpm_, FlushContextSync(object_handle1, _))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  EXPECT_CALL(mock_tpm_, FlushContextSync(object_handle2, _)).Times(0);
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.UnsealData("sealed_data1", &mock_authorization_delegate_,
+                                &unsealed_data));
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            utility_.UnsealData("sealed_data2", &mock_authorization_delegate_,
+                                &unsealed_data));
+}
+
 TEST_F(TpmUtilityTest, StartSessionSuccess) {
   EXPECT_CALL(mock_hmac_session_, StartUnboundSession(true))
       .WillOnce(Return(TPM_RC_SUCCESS));
@@ -52,16 +52,22 @@
         'blob_parser.cc',
         'error_codes.cc',
         'hmac_authorization_delegate.cc',
+        'hmac_drbg.cc',
         'hmac_session_impl.cc',
         'password_authorization_delegate.cc',
         'policy_session_impl.cc',
+        'rsa_key_pool.cc',
         'session_manager_impl.cc',
         'scoped_key_handle.cc',
+        'tpm_event_log.cc',
         'tpm_generated.cc',
+        'tpm_object_cache.cc',
         'tpm_state_impl.cc',
+        'tpm_tis_spi.cc',
         'tpm_utility_impl.cc',
         'trunks_factory_impl.cc',
         'trunks_dbus_proxy.cc',
+        'trunks_socket_proxy.cc',
       ],
       'dependencies': [
         'interface_proto',
@@ -119,6 +125,7 @@
         'tpm_handle.cc',
         'tpm_simulator_handle.cc',
         'trunks_dbus_service.cc',
+        'trunks_socket_service.cc',
       ],
       'dependencies': [
         'interface_proto',
@@ -160,15 +167,21 @@
           'sources': [
             'background_command_transceiver_test.cc',
             'hmac_authorization_delegate_test.cc',
+            'hmac_drbg_test.cc',
             'hmac_session_test.cc',
             'password_authorization_delegate_test.cc',
             'policy_session_test.cc',
             'resource_manager_test.cc',
+            'rsa_key_pool_test.cc',
             'scoped_key_handle_test.cc',
             'session_manager_test.cc',
+            'tpm_event_log_test.cc',
             'tpm_generated_test.cc',
+            'tpm_object_cache_test.cc',
             'tpm_state_test.cc',
+            'tpm_tis_spi_test.cc',
             'tpm_utility_test.cc',
+            'trunks_socket_service_test.cc',
             'trunks_testrunner.cc',
           ],
           'dependencies': [
@@ -30,51 +30,65 @@
 
 namespace {
 
-// Implements ITrunksClient and forwards response data to a ResponseCallback.
+// Implements ITrunksClient and forwards response data to a callback.
 class ResponseObserver : public android::trunks::BnTrunksClient {
  public:
-  explicit ResponseObserver(
-      const trunks::CommandTransceiver::ResponseCallback& callback)
-      : callback_(callback) {}
+  using Callback = base::Callback<void(const std::vector<uint8_t>&)>;
+
+  explicit ResponseObserver(const Callback& callback) : callback_(callback) {}
 
   // ITrunksClient interface.
   android::binder::Status OnCommandResponse(
       const std::vector<uint8_t>& response_proto_data) override {
-    trunks::SendCommandResponse response_proto;
-    if (!response_proto.ParseFromArray(response_proto_data.data(),
-                                       response_proto_data.size())) {
-      LOG(ERROR) << "TrunksBinderProxy: Bad response data.";
-      callback_.Run(
-          trunks::CreateErrorResponse(trunks::SAPI_RC_MALFORMED_RESPONSE));
-    }
-    callback_.Run(response_proto.response());
+    callback_.Run(response_proto_data);
     return android::binder::Status::ok();
   }
 
  private:
-  trunks::CommandTransceiver::ResponseCallback callback_;
+  Callback callback_;
 };
 
 }  // namespace
 
 namespace trunks {
 
+constexpr size_t TrunksBinderProxy::kMaxCommandsInFlight;
+
+TrunksBinderProxy::TrunksBinderProxy(android::trunks::ITrunks* binder)
+    : trunks_service_(binder) {}
+
 bool TrunksBinderProxy::Init() {
-  android::sp<android::IBinder> service_binder =
-      android::BinderWrapper::GetOrCreateInstance()->GetService(
-          kTrunksServiceName);
-  if (!service_binder.get()) {
-    LOG(ERROR) << "TrunksBinderProxy: Trunks service does not exist.";
-    return false;
+  if (!trunks_service_.get()) {
+    android::sp<android::IBinder> service_binder =
+        android::BinderWrapper::GetOrCreateInstance()->GetService(
+            kTrunksServiceName);
+    if (!service_binder.get()) {
+      LOG(ERROR) << "TrunksBinderProxy: Trunks service does not exist.";
+      return false;
+    }
+    trunks_service_ = new android::trunks::BpTrunks(service_binder);
   }
-  trunks_service_ = new android::trunks::BpTrunks(service_binder);
+  response_observer_ = new ResponseObserver(base::Bind(
+      &TrunksBinderProxy::OnResponse, weak_factory_.GetWeakPtr()));
   return true;
 }
 
 void TrunksBinderProxy::SendCommand(const std::string& command,
                                     const ResponseCallback& callback) {
+  // Commands sent while others are queued wait their turn.
+  if (in_flight_.size() >= kMaxCommandsInFlight || !queued_commands_.empty()) {
+    queued_commands_.push(std::make_pair(command, callback));
+    return;
+  }
+  SendCommandInternal(command, callback);
+}
+
+void TrunksBinderProxy::SendCommandInternal(const std::string& command,
+                                            const ResponseCallback& callback) {
+  uint64_t request_id = next_request_id_++;
   SendCommandRequest command_proto;
   command_proto.set_command(command);
+  command_proto.set_request_id(request_id);
   std::vector<uint8_t> command_proto_data;
   command_proto_data.resize(command_proto.ByteSize());
   if (!command_proto.SerializeToArray(command_proto_data.data(),
@@ -83,16 +97,68 @@ void TrunksBinderProxy::SendCommand(const std::string& command,
     callback.Run(CreateErrorResponse(TRUNKS_RC_IPC_ERROR));
     return;
   }
-  android::sp<ResponseObserver> observer(new ResponseObserver(callback));
+  in_flight_[request_id] = callback;
   android::binder::Status status =
-      trunks_service_->SendCommand(command_proto_data, observer);
+      trunks_service_->SendCommand(command_proto_data, response_observer_);
   if (!status.isOk()) {
     LOG(ERROR) << "TrunksBinderProxy: Binder error: " << status.toString8();
+    in_flight_.erase(request_id);
     callback.Run(CreateErrorResponse(TRUNKS_RC_IPC_ERROR));
     return;
   }
 }
 
+void TrunksBinderProxy::SendQueuedCommands() {
+  while (!queued_commands_.empty() &&
+         in_flight_.size() < kMaxCommandsInFlight) {
+    std::pair<std::string, ResponseCallback> next = queued_commands_.front();
+    queued_commands_.pop();
+    SendCommandInternal(next.first, next.second);
+  }
+}
+
+void TrunksBinderProxy::OnResponse(
+    const std::vector<uint8_t>& response_proto_data) {
+  // Callbacks may destroy this object.
+  base::WeakPtr<TrunksBinderProxy> weak_this = weak_factory_.GetWeakPtr();
+  SendCommandResponse response_proto;
+  if (!response_proto.ParseFromArray(response_proto_data.data(),
+                                     response_proto_data.size())) {
+    // There is no telling which command this answers, so none of the commands
+    // in flight can be trusted to get its own response.
+    LOG(ERROR) << "TrunksBinderProxy: Bad response data.";
+    std::map<uint64_t, ResponseCallback> failed_commands;
+    failed_commands.swap(in_flight_);
+    for (const auto& item : failed_commands) {
+      item.second.Run(CreateErrorResponse(SAPI_RC_MALFORMED_RESPONSE));
+    }
+    if (weak_this) {
+      SendQueuedCommands();
+    }
+    return;
+  }
+  if (in_flight_.empty()) {
+    LOG(ERROR) << "TrunksBinderProxy: Unexpected response.";
+    return;
+  }
+  // A response without a request ID answers the oldest command; a service
+  // that does not echo IDs completes commands in order.
+  auto iter = in_flight_.begin();
+  if (response_proto.has_request_id()) {
+    iter = in_flight_.find(response_proto.request_id());
+    if (iter == in_flight_.end()) {
+      LOG(ERROR) << "TrunksBinderProxy: Unknown request ID.";
+      return;
+    }
+  }
+  ResponseCallback callback = iter->second;
+  in_flight_.erase(iter);
+  callback.Run(response_proto.response());
+  if (weak_this) {
+    SendQueuedCommands();
+  }
+}
+
 std::string TrunksBinderProxy::SendCommandAndWait(const std::string& command) {
   SendCommandRequest command_proto;
   command_proto.set_command(command);
@@ -17,11 +17,17 @@
 #ifndef TRUNKS_TRUNKS_BINDER_PROXY_H_
 #define TRUNKS_TRUNKS_BINDER_PROXY_H_
 
+#include <map>
+#include <queue>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <base/macros.h>
+#include <base/memory/weak_ptr.h>
 
 #include "android/trunks/ITrunks.h"
+#include "android/trunks/ITrunksClient.h"
 #include "trunks/command_transceiver.h"
 #include "trunks/trunks_export.h"
 
@@ -30,9 +36,21 @@ namespace trunks {
 // TrunksBinderProxy is a CommandTransceiver implementation that forwards all
 // commands to the trunksd binder daemon. See TrunksBinderService for details on
 // how the commands are handled once they reach trunksd.
+//
+// Asynchronous commands are tagged with a request ID and up to
+// kMaxCommandsInFlight of them are outstanding at once, so callers can prepare
+// the next command while trunksd executes the previous ones. Further commands
+// are queued and sent in order as responses arrive. Responses are matched by
+// request ID and may arrive in any order. A response that cannot be parsed
+// cannot be matched, so it fails every command in flight.
 class TRUNKS_EXPORT TrunksBinderProxy : public CommandTransceiver {
  public:
+  static constexpr size_t kMaxCommandsInFlight = 4;
+
   TrunksBinderProxy() = default;
+  // Sends commands to |binder| instead of looking up trunksd. Does not take
+  // ownership. This should only be used for testing.
+  explicit TrunksBinderProxy(android::trunks::ITrunks* binder);
   ~TrunksBinderProxy() override = default;
 
   // Initializes the client. Returns true on success.
@@ -45,8 +63,28 @@ class TRUNKS_EXPORT TrunksBinderProxy : public CommandTransceiver {
   std::string SendCommandAndWait(const std::string& command) override;
 
  private:
+  // Assigns a request ID to |command| and sends it to trunksd.
+  void SendCommandInternal(const std::string& command,
+                           const ResponseCallback& callback);
+
+  // Sends queued commands while there is room in the in-flight window. Must not
+  // be called before the callback of a completed command has run, since a
+  // failed send runs the queued command's callback right away.
+  void SendQueuedCommands();
+
+  // Handles a serialized SendCommandResponse from trunksd.
+  void OnResponse(const std::vector<uint8_t>& response_proto_data);
+
   android::sp<android::trunks::ITrunks> trunks_service_;
+  // Receives the responses to all asynchronous commands.
+  android::sp<android::trunks::ITrunksClient> response_observer_;
+  uint64_t next_request_id_ = 1;
+  // Callbacks for commands sent to trunksd, keyed by request ID.
+  std::map<uint64_t, ResponseCallback> in_flight_;
+  std::queue<std::pair<std::string, ResponseCallback>> queued_commands_;
 
+  // Declared last so weak pointers are invalidated first on destruction.
+  base::WeakPtrFactory<TrunksBinderProxy> weak_factory_{this};
   DISALLOW_COPY_AND_ASSIGN(TrunksBinderProxy);
 };
 
@@ -0,0 +1,206 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/trunks_binder_proxy.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <base/bind.h>
+#include <gtest/gtest.h>
+
+#include "android/trunks/BnTrunks.h"
+#include "trunks/error_codes.h"
+#include "interface.pb.h"
+
+namespace {
+
+using Responses = std::vector<std::pair<std::string, std::string>>;
+
+// Records |response| under |tag| so tests can check which callback ran when.
+void RecordResponse(Responses* responses,
+                    const std::string& tag,
+                    const std::string& response) {
+  responses->push_back(std::make_pair(tag, response));
+}
+
+// A trunksd stand-in which keeps the requests it receives so that tests can
+// answer them in any order.
+class FakeTrunks : public android::trunks::BnTrunks {
+ public:
+  FakeTrunks() = default;
+  ~FakeTrunks() override = default;
+
+  // ITrunks interface.
+  android::binder::Status SendCommand(
+      const std::vector<uint8_t>& command,
+      const android::sp<android::trunks::ITrunksClient>& client) override {
+    if (fail_sends_) {
+      return android::binder::Status::fromExceptionCode(
+          android::binder::Status::EX_ILLEGAL_STATE);
+    }
+    trunks::SendCommandRequest request;
+    EXPECT_TRUE(request.ParseFromArray(command.data(), command.size()));
+    requests_.push_back(request);
+    client_ = client;
+    return android::binder::Status::ok();
+  }
+  android::binder::Status SendCommandAndWait(
+      const std::vector<uint8_t>& command,
+      std::vector<uint8_t>* response) override {
+    return android::binder::Status::ok();
+  }
+
+  // Sends |response| to the client, tagged with |request_id| unless it is
+  // zero.
+  void Respond(uint64_t request_id, const std::string& response) {
+    trunks::SendCommandResponse response_proto;
+    response_proto.set_response(response);
+    if (request_id) {
+      response_proto.set_request_id(request_id);
+    }
+    std::vector<uint8_t> data(response_proto.ByteSize());
+    ASSERT_TRUE(response_proto.SerializeToArray(data.data(), data.size()));
+    RespondWithData(data);
+  }
+
+  void RespondWithData(const std::vector<uint8_t>& data) {
+    ASSERT_TRUE(client_.get());
+    client_->OnCommandResponse(data);
+  }
+
+  const std::vector<trunks::SendCommandRequest>& requests() const {
+    return requests_;
+  }
+  void set_fail_sends(bool fail_sends) { fail_sends_ = fail_sends; }
+
+ private:
+  std::vector<trunks::SendCommandRequest> requests_;
+  android::sp<android::trunks::ITrunksClient> client_;
+  bool fail_sends_ = false;
+};
+
+}  // namespace
+
+namespace trunks {
+
+class TrunksBinderProxyTest : public testing::Test {
+ public:
+  void SetUp() override {
+    fake_trunks_ = new FakeTrunks();
+    proxy_.reset(new TrunksBinderProxy(fake_trunks_.get()));
+    ASSERT_TRUE(proxy_->Init());
+  }
+
+  // Sends |command| and records its response under the same name.
+  void Send(const std::string& command) {
+    proxy_->SendCommand(command,
+                        base::Bind(&RecordResponse, &responses_, command));
+  }
+
+ protected:
+  android::sp<FakeTrunks> fake_trunks_;
+  std::unique_ptr<TrunksBinderProxy> proxy_;
+  Responses responses_;
+};
+
+TEST_F(TrunksBinderProxyTest, ResponsesMatchedByRequestId) {
+  Send("command1");
+  Send("command2");
+  ASSERT_EQ(2u, fake_trunks_->requests().size());
+  uint64_t id1 = fake_trunks_->requests()[0].request_id();
+  uint64_t id2 = fake_trunks_->requests()[1].request_id();
+  EXPECT_NE(id1, id2);
+  fake_trunks_->Respond(id2, "response2");
+  fake_trunks_->Respond(id1, "response1");
+  ASSERT_EQ(2u, responses_.size());
+  EXPECT_EQ(std::make_pair(std::string("command2"), std::string("response2")),
+            responses_[0]);
+  EXPECT_EQ(std::make_pair(std::string("command1"), std::string("response1")),
+            responses_[1]);
+}
+
+TEST_F(TrunksBinderProxyTest, ResponseWithoutRequestIdAnswersOldest) {
+  Send("command1");
+  Send("command2");
+  fake_trunks_->Respond(0, "response1");
+  ASSERT_EQ(1u, responses_.size());
+  EXPECT_EQ("command1", responses_[0].first);
+  EXPECT_EQ("response1", responses_[0].second);
+}
+
+TEST_F(TrunksBinderProxyTest, UnknownRequestIdIsIgnored) {
+  Send("command1");
+  uint64_t id = fake_trunks_->requests()[0].request_id();
+  fake_trunks_->Respond(id + 100, "bogus");
+  EXPECT_TRUE(responses_.empty());
+  fake_trunks_->Respond(id, "response1");
+  ASSERT_EQ(1u, responses_.size());
+  EXPECT_EQ("response1", responses_[0].second);
+}
+
+TEST_F(TrunksBinderProxyTest, BadResponseFailsAllInFlight) {
+  Send("command1");
+  Send("command2");
+  uint64_t id1 = fake_trunks_->requests()[0].request_id();
+  fake_trunks_->RespondWithData({0xFF, 0xFF, 0xFF});
+  ASSERT_EQ(2u, responses_.size());
+  std::string error = CreateErrorResponse(SAPI_RC_MALFORMED_RESPONSE);
+  EXPECT_EQ(error, responses_[0].second);
+  EXPECT_EQ(error, responses_[1].second);
+  // A late response to a failed command is dropped.
+  fake_trunks_->Respond(id1, "response1");
+  EXPECT_EQ(2u, responses_.size());
+  // The proxy keeps working for new commands.
+  Send("command3");
+  fake_trunks_->Respond(fake_trunks_->requests().back().request_id(),
+                        "response3");
+  ASSERT_EQ(3u, responses_.size());
+  EXPECT_EQ("response3", responses_[2].second);
+}
+
+TEST_F(TrunksBinderProxyTest, QueuedCommandsSentInOrder) {
+  for (size_t i = 0; i < TrunksBinderProxy::kMaxCommandsInFlight + 2; ++i) {
+    Send("command" + std::to_string(i));
+  }
+  ASSERT_EQ(TrunksBinderProxy::kMaxCommandsInFlight,
+            fake_trunks_->requests().size());
+  fake_trunks_->Respond(fake_trunks_->requests()[0].request_id(), "response");
+  ASSERT_EQ(TrunksBinderProxy::kMaxCommandsInFlight + 1,
+            fake_trunks_->requests().size());
+  EXPECT_EQ("command" + std::to_string(TrunksBinderProxy::kMaxCommandsInFlight),
+            fake_trunks_->requests().back().command());
+}
+
+TEST_F(TrunksBinderProxyTest, ResponseRunsBeforeQueuedFailures) {
+  for (size_t i = 0; i < TrunksBinderProxy::kMaxCommandsInFlight + 1; ++i) {
+    Send("command" + std::to_string(i));
+  }
+  // The queued command fails to send once the window opens; its error must
+  // not overtake the response that opened the window.
+  fake_trunks_->set_fail_sends(true);
+  fake_trunks_->Respond(fake_trunks_->requests()[0].request_id(), "response");
+  ASSERT_EQ(2u, responses_.size());
+  EXPECT_EQ("command0", responses_[0].first);
+  EXPECT_EQ("response", responses_[0].second);
+  EXPECT_EQ("command" + std::to_string(TrunksBinderProxy::kMaxCommandsInFlight),
+            responses_[1].first);
+  EXPECT_EQ(CreateErrorResponse(TRUNKS_RC_IPC_ERROR), responses_[1].second);
+}
+
+}  // namespace trunks
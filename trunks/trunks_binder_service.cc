@@ -28,23 +28,24 @@
 
 namespace {
 
-// If |command| is a valid command protobuf, provides the |command_data| and
-// returns true. Otherwise, returns false.
+// Parses |command| into |request_proto|. Returns true if it is a valid command
+// protobuf.
 bool ParseCommandProto(const std::vector<uint8_t>& command,
-                       std::string* command_data) {
-  trunks::SendCommandRequest request_proto;
-  if (!request_proto.ParseFromArray(command.data(), command.size()) ||
-      !request_proto.has_command() || request_proto.command().empty()) {
-    return false;
-  }
-  *command_data = request_proto.command();
-  return true;
+                       trunks::SendCommandRequest* request_proto) {
+  return request_proto->ParseFromArray(command.data(), command.size()) &&
+         request_proto->has_command() && !request_proto->command().empty();
 }
 
-void CreateResponseProto(const std::string& data,
+// Creates a response protobuf for |request_proto| carrying |data|. The request
+// ID, if any, is echoed so the client can match the response.
+void CreateResponseProto(const trunks::SendCommandRequest& request_proto,
+                         const std::string& data,
                          std::vector<uint8_t>* response) {
   trunks::SendCommandResponse response_proto;
   response_proto.set_response(data);
+  if (request_proto.has_request_id()) {
+    response_proto.set_request_id(request_proto.request_id());
+  }
   response->resize(response_proto.ByteSize());
   CHECK(response_proto.SerializeToArray(response->data(), response->size()))
       << "TrunksBinderService: Failed to serialize protobuf.";
@@ -70,6 +71,14 @@ int TrunksBinderService::OnInit() {
   return brillo::Daemon::OnInit();
 }
 
+void TrunksBinderService::InitForTesting() {
+  binder_ = new BinderServiceInternal(this);
+}
+
+android::trunks::ITrunks* TrunksBinderService::GetITrunks() {
+  return binder_.get();
+}
+
 TrunksBinderService::BinderServiceInternal::BinderServiceInternal(
     TrunksBinderService* service)
     : service_(service) {}
@@ -77,11 +86,17 @@ TrunksBinderService::BinderServiceInternal::BinderServiceInternal(
 android::binder::Status TrunksBinderService::BinderServiceInternal::SendCommand(
     const std::vector<uint8_t>& command,
     const android::sp<android::trunks::ITrunksClient>& client) {
+  // The transceiver may complete commands in any order; the request ID lets
+  // the client match each response.
+  SendCommandRequest request_proto;
+  bool valid = ParseCommandProto(command, &request_proto);
+  // The callback only needs the request ID, so move the command out first.
+  std::string command_data;
+  command_data.swap(*request_proto.mutable_command());
   auto callback =
       base::Bind(&TrunksBinderService::BinderServiceInternal::OnResponse,
-                 GetWeakPtr(), client);
-  std::string command_data;
-  if (!ParseCommandProto(command, &command_data)) {
+                 GetWeakPtr(), client, request_proto);
+  if (!valid) {
     LOG(ERROR) << "TrunksBinderService: Bad command data.";
     callback.Run(CreateErrorResponse(SAPI_RC_BAD_PARAMETER));
     return android::binder::Status::ok();
@@ -92,9 +107,10 @@ android::binder::Status TrunksBinderService::BinderServiceInternal::SendCommand(
 
 void TrunksBinderService::BinderServiceInternal::OnResponse(
     const android::sp<android::trunks::ITrunksClient>& client,
+    const SendCommandRequest& request_proto,
     const std::string& response) {
   std::vector<uint8_t> binder_response;
-  CreateResponseProto(response, &binder_response);
+  CreateResponseProto(request_proto, response, &binder_response);
   android::binder::Status status = client->OnCommandResponse(binder_response);
   if (!status.isOk()) {
     LOG(ERROR) << "TrunksBinderService: Failed to send response to client: "
@@ -106,14 +122,17 @@ android::binder::Status
 TrunksBinderService::BinderServiceInternal::SendCommandAndWait(
     const std::vector<uint8_t>& command,
     std::vector<uint8_t>* response) {
-  std::string command_data;
-  if (!ParseCommandProto(command, &command_data)) {
+  SendCommandRequest request_proto;
+  if (!ParseCommandProto(command, &request_proto)) {
     LOG(ERROR) << "TrunksBinderService: Bad command data.";
-    CreateResponseProto(CreateErrorResponse(SAPI_RC_BAD_PARAMETER), response);
+    CreateResponseProto(request_proto,
+                        CreateErrorResponse(SAPI_RC_BAD_PARAMETER), response);
     return android::binder::Status::ok();
   }
-  CreateResponseProto(service_->transceiver_->SendCommandAndWait(command_data),
-                      response);
+  CreateResponseProto(
+      request_proto,
+      service_->transceiver_->SendCommandAndWait(request_proto.command()),
+      response);
   return android::binder::Status::ok();
 }
 
@@ -23,6 +23,7 @@
 
 #include "android/trunks/BnTrunks.h"
 #include "trunks/command_transceiver.h"
+#include "interface.pb.h"
 
 namespace trunks {
 
@@ -45,6 +46,13 @@ class TrunksBinderService : public brillo::Daemon {
     transceiver_ = transceiver;
   }
 
+  // Does basic setup but does not register with the binder subsystem.
+  void InitForTesting();
+
+  // Returns the binder interface. Callers do not take ownership. This should
+  // only be used for testing.
+  android::trunks::ITrunks* GetITrunks();
+
  protected:
   int OnInit() override;
 
@@ -64,7 +72,9 @@ class TrunksBinderService : public brillo::Daemon {
         std::vector<uint8_t>* response) override;
 
    private:
+    // Sends |response| to |client| as the answer to |request_proto|.
     void OnResponse(const android::sp<android::trunks::ITrunksClient>& client,
+                    const SendCommandRequest& request_proto,
                     const std::string& response);
 
     base::WeakPtr<BinderServiceInternal> GetWeakPtr() {
@@ -0,0 +1,144 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/trunks_binder_service.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <base/bind.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "android/trunks/BnTrunksClient.h"
+#include "trunks/error_codes.h"
+#include "trunks/mock_command_transceiver.h"
+#include "trunks/trunks_binder_proxy.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::Return;
+using testing::StrictMock;
+
+namespace {
+
+void Assign(std::string* to, const std::string& from) {
+  *to = from;
+}
+
+// Keeps the last response delivered by the service.
+class FakeTrunksClient : public android::trunks::BnTrunksClient {
+ public:
+  FakeTrunksClient() = default;
+  ~FakeTrunksClient() override = default;
+
+  // ITrunksClient interface.
+  android::binder::Status OnCommandResponse(
+      const std::vector<uint8_t>& response_proto_data) override {
+    EXPECT_TRUE(response_.ParseFromArray(response_proto_data.data(),
+                                         response_proto_data.size()));
+    return android::binder::Status::ok();
+  }
+
+  const trunks::SendCommandResponse& response() const { return response_; }
+
+ private:
+  trunks::SendCommandResponse response_;
+};
+
+}  // namespace
+
+namespace trunks {
+
+// A test fixture to exercise both proxy and service layers.
+class TrunksBinderServiceTest : public testing::Test {
+ public:
+  void SetUp() override {
+    service_.set_transceiver(&mock_transceiver_);
+    service_.InitForTesting();
+    proxy_.reset(new TrunksBinderProxy(service_.GetITrunks()));
+    ASSERT_TRUE(proxy_->Init());
+  }
+
+  // Saves each command's callback so the test can complete them in any order.
+  void SaveCallback(const std::string& command,
+                    const CommandTransceiver::ResponseCallback& callback) {
+    callbacks_.push_back(callback);
+  }
+
+  // Sends a serialized SendCommandRequest straight to the service.
+  void SendRequest(const SendCommandRequest& request,
+                   const android::sp<FakeTrunksClient>& client) {
+    std::vector<uint8_t> data(request.ByteSize());
+    ASSERT_TRUE(request.SerializeToArray(data.data(), data.size()));
+    EXPECT_TRUE(service_.GetITrunks()->SendCommand(data, client).isOk());
+  }
+
+ protected:
+  StrictMock<MockCommandTransceiver> mock_transceiver_;
+  TrunksBinderService service_;
+  std::unique_ptr<TrunksBinderProxy> proxy_;
+  std::vector<CommandTransceiver::ResponseCallback> callbacks_;
+};
+
+TEST_F(TrunksBinderServiceTest, ResponsesMatchedByRequestId) {
+  EXPECT_CALL(mock_transceiver_, SendCommand(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke(this, &TrunksBinderServiceTest::SaveCallback));
+  std::string response1;
+  std::string response2;
+  proxy_->SendCommand("command1", base::Bind(&Assign, &response1));
+  proxy_->SendCommand("command2", base::Bind(&Assign, &response2));
+  ASSERT_EQ(2u, callbacks_.size());
+  // The transceiver completes the commands out of order.
+  callbacks_[1].Run("response2");
+  callbacks_[0].Run("response1");
+  EXPECT_EQ("response1", response1);
+  EXPECT_EQ("response2", response2);
+}
+
+TEST_F(TrunksBinderServiceTest, RequestIdIsEchoed) {
+  EXPECT_CALL(mock_transceiver_, SendCommand("command", _))
+      .WillOnce(Invoke(this, &TrunksBinderServiceTest::SaveCallback));
+  android::sp<FakeTrunksClient> client = new FakeTrunksClient();
+  SendCommandRequest request;
+  request.set_command("command");
+  request.set_request_id(42);
+  SendRequest(request, client);
+  ASSERT_EQ(1u, callbacks_.size());
+  callbacks_[0].Run("response");
+  EXPECT_EQ(42u, client->response().request_id());
+  EXPECT_EQ("response", client->response().response());
+}
+
+TEST_F(TrunksBinderServiceTest, BadCommandKeepsRequestId) {
+  android::sp<FakeTrunksClient> client = new FakeTrunksClient();
+  SendCommandRequest request;
+  request.set_request_id(42);
+  SendRequest(request, client);
+  EXPECT_EQ(42u, client->response().request_id());
+  EXPECT_EQ(CreateErrorResponse(SAPI_RC_BAD_PARAMETER),
+            client->response().response());
+}
+
+TEST_F(TrunksBinderServiceTest, SendCommandAndWait) {
+  EXPECT_CALL(mock_transceiver_, SendCommandAndWait("command"))
+      .WillOnce(Return("response"));
+  EXPECT_EQ("response", proxy_->SendCommandAndWait("command"));
+}
+
+}  // namespace trunks
@@ -35,6 +35,7 @@
 #include "trunks/tpm_utility.h"
 #include "trunks/trunks_client_test.h"
 #include "trunks/trunks_factory_impl.h"
+#include "trunks/trunks_socket_proxy.h"
 
 namespace {
 
@@ -56,6 +57,8 @@ void PrintUsage() {
   puts("  --startup - Performs startup and self-tests.");
   puts("  --status - Prints TPM status information.");
   puts("  --stress_test - Runs some basic stress tests.");
+  puts("  --socket=<path> - Talks to trunksd over its socket at <path>");
+  puts("                    instead of D-Bus. Use with other options.");
   puts("  --read_pcr --index=<N> - Reads a PCR and prints the value.");
   puts("  --extend_pcr --index=<N> --value=<value> - Extends a PCR.");
 }
@@ -170,7 +173,17 @@ int main(int argc, char** argv) {
     return 0;
   }
 
-  TrunksFactoryImpl factory;
+  std::unique_ptr<trunks::TrunksSocketProxy> socket_proxy;
+  std::unique_ptr<TrunksFactoryImpl> factory_impl;
+  if (cl->HasSwitch("socket")) {
+    socket_proxy.reset(
+        new trunks::TrunksSocketProxy(cl->GetSwitchValuePath("socket")));
+    CHECK(socket_proxy->Init()) << "Failed to connect to trunksd socket.";
+    factory_impl.reset(new TrunksFactoryImpl(socket_proxy.get()));
+  } else {
+    factory_impl.reset(new TrunksFactoryImpl());
+  }
+  TrunksFactoryImpl& factory = *factory_impl;
   CHECK(factory.Initialize()) << "Failed to initialize trunks factory.";
 
   if (cl->HasSwitch("status")) {
@@ -199,6 +212,11 @@ int main(int argc, char** argv) {
       LOG(ERROR) << "Error running RNGtest.";
       return -1;
     }
+    LOG(INFO) << "Running ECC key tests.";
+    if (!test.EccSignTest()) {
+      LOG(ERROR) << "Error running EccSignTest.";
+      return -1;
+    }
     LOG(INFO) << "Running RSA key tests.";
     if (!test.SignTest()) {
       LOG(ERROR) << "Error running SignTest.";
@@ -208,6 +226,10 @@ int main(int argc, char** argv) {
       LOG(ERROR) << "Error running DecryptTest.";
       return -1;
     }
+    if (!test.SoftwarePublicKeyTest()) {
+      LOG(ERROR) << "Error running SoftwarePublicKeyTest.";
+      return -1;
+    }
     if (!test.ImportTest()) {
       LOG(ERROR) << "Error running ImportTest.";
       return -1;
@@ -265,6 +287,14 @@ int main(int argc, char** argv) {
       LOG(ERROR) << "Error running ManySessionsTest.";
       return -1;
     }
+    if (!test.BulkImportTest()) {
+      LOG(ERROR) << "Error running BulkImportTest.";
+      return -1;
+    }
+    if (!test.PCRExtendTest()) {
+      LOG(ERROR) << "Error running PCRExtendTest.";
+      return -1;
+    }
     return 0;
   }
   if (cl->HasSwitch("read_pcr") && cl->HasSwitch("index")) {
@@ -23,8 +23,10 @@
 #include <vector>
 
 #include <base/callback.h>
+#include <base/files/scoped_temp_dir.h>
 #include <base/logging.h>
 #include <base/stl_util.h>
+#include <base/time/time.h>
 #include <brillo/bind_lambda.h>
 #include <crypto/openssl_util.h>
 #include <crypto/sha2.h>
@@ -41,6 +43,7 @@
 #include "trunks/policy_session.h"
 #include "trunks/scoped_key_handle.h"
 #include "trunks/tpm_constants.h"
+#include "trunks/tpm_event_log.h"
 #include "trunks/tpm_generated.h"
 #include "trunks/tpm_state.h"
 #include "trunks/tpm_utility.h"
@@ -139,6 +142,54 @@ bool TrunksClientTest::SignTest() {
   return true;
 }
 
+bool TrunksClientTest::EccSignTest() {
+  std::unique_ptr<TpmUtility> utility = factory_.GetTpmUtility();
+  std::unique_ptr<HmacSession> session = factory_.GetHmacSession();
+  if (utility->StartSession(session.get()) != TPM_RC_SUCCESS) {
+    LOG(ERROR) << "Error starting hmac session.";
+    return false;
+  }
+  std::string key_authorization("sign");
+  std::string key_blob;
+  TPM_RC result = utility->CreateECCKeyPair(
+      TpmUtility::AsymmetricKeyUsage::kSignKey, key_authorization, "",
+      false,  // use_only_policy_authorization
+      kNoCreationPCR, session->GetDelegate(), &key_blob, nullptr);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << "Error creating ECC signing key: " << GetErrorString(result);
+    return false;
+  }
+  TPM_HANDLE signing_key;
+  result = utility->LoadKey(key_blob, session->GetDelegate(), &signing_key);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << "Error loading ECC signing key: " << GetErrorString(result);
+    return false;
+  }
+  ScopedKeyHandle scoped_key(factory_, signing_key);
+  session->SetEntityAuthorizationValue(key_authorization);
+  std::string signature;
+  result =
+      utility->Sign(signing_key, TPM_ALG_ECDSA, TPM_ALG_NULL,
+                    std::string(32, 'a'), session->GetDelegate(), &signature);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << "Error using ECC key to sign: " << GetErrorString(result);
+    return false;
+  }
+  result = utility->Verify(signing_key, TPM_ALG_ECDSA, TPM_ALG_NULL,
+                           std::string(32, 'a'), signature, nullptr);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << "Error using ECC key to verify: " << GetErrorString(result);
+    return false;
+  }
+  result = utility->Verify(signing_key, TPM_ALG_ECDSA, TPM_ALG_NULL,
+                           std::string(32, 'b'), signature, nullptr);
+  if (result == TPM_RC_SUCCESS) {
+    LOG(ERROR) << "ECC signature verified over the wrong digest.";
+    return false;
+  }
+  return true;
+}
+
 bool TrunksClientTest::DecryptTest() {
   std::unique_ptr<TpmUtility> utility = factory_.GetTpmUtility();
   std::unique_ptr<HmacSession> session = factory_.GetHmacSession();
@@ -166,6 +217,103 @@ bool TrunksClientTest::DecryptTest() {
                                      session.get());
 }
 
+bool TrunksClientTest::SoftwarePublicKeyTest() {
+  std::unique_ptr<TpmUtility> utility = factory_.GetTpmUtility();
+  std::unique_ptr<HmacSession> session = factory_.GetHmacSession();
+  if (utility->StartSession(session.get()) != TPM_RC_SUCCESS) {
+    LOG(ERROR) << "Error starting hmac session.";
+    return false;
+  }
+  std::string key_authorization("software");
+  std::string sign_key_blob;
+  TPM_RC result = utility->CreateRSAKeyPair(
+      TpmUtility::AsymmetricKeyUsage::kSignKey, 2048, 0x10001,
+      key_authorization, "", false,  // use_only_policy_authorization
+      kNoCreationPCR, session->GetDelegate(), &sign_key_blob, nullptr);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << "Error creating signing key: " << GetErrorString(result);
+    return false;
+  }
+  TPM_HANDLE signing_key;
+  result =
+      utility->LoadKey(sign_key_blob, session->GetDelegate(), &signing_key);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << "Error loading signing key: " << GetErrorString(result);
+    return false;
+  }
+  ScopedKeyHandle scoped_signing_key(factory_, signing_key);
+  session->SetEntityAuthorizationValue(key_authorization);
+  std::string plaintext("plaintext");
+  for (TPM_ALG_ID scheme : {TPM_ALG_RSASSA, TPM_ALG_RSAPSS}) {
+    std::string signature;
+    result = utility->Sign(signing_key, scheme, TPM_ALG_SHA256, plaintext,
+                           session->GetDelegate(), &signature);
+    if (result != TPM_RC_SUCCESS) {
+      LOG(ERROR) << "Error using key to sign: " << GetErrorString(result);
+      return false;
+    }
+    std::string bad_signature(signature);
+    bad_signature[0] ^= 1;
+    for (bool software : {false, true}) {
+      utility->SetSoftwarePublicKeyOperations(software);
+      result = utility->Verify(signing_key, scheme, TPM_ALG_SHA256, plaintext,
+                               signature, nullptr);
+      if (result != TPM_RC_SUCCESS) {
+        LOG(ERROR) << "Error verifying (software=" << software
+                   << "): " << GetErrorString(result);
+        return false;
+      }
+      result = utility->Verify(signing_key, scheme, TPM_ALG_SHA256, plaintext,
+                               bad_signature, nullptr);
+      if (result == TPM_RC_SUCCESS) {
+        LOG(ERROR) << "Bad signature verified (software=" << software << ").";
+        return false;
+      }
+    }
+  }
+  utility->SetSoftwarePublicKeyOperations(false);
+  std::string decrypt_key_blob;
+  result = utility->CreateRSAKeyPair(
+      TpmUtility::AsymmetricKeyUsage::kDecryptKey, 2048, 0x10001,
+      key_authorization, "", false,  // use_only_policy_authorization
+      kNoCreationPCR, session->GetDelegate(), &decrypt_key_blob, nullptr);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << "Error creating decrypt key: " << GetErrorString(result);
+    return false;
+  }
+  TPM_HANDLE decrypt_key;
+  result =
+      utility->LoadKey(decrypt_key_blob, session->GetDelegate(), &decrypt_key);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << "Error loading decrypt key: " << GetErrorString(result);
+    return false;
+  }
+  ScopedKeyHandle scoped_decrypt_key(factory_, decrypt_key);
+  utility->SetSoftwarePublicKeyOperations(true);
+  for (TPM_ALG_ID scheme : {TPM_ALG_OAEP, TPM_ALG_RSAES}) {
+    std::string ciphertext;
+    result = utility->AsymmetricEncrypt(decrypt_key, scheme, TPM_ALG_SHA256,
+                                        plaintext, nullptr, &ciphertext);
+    if (result != TPM_RC_SUCCESS) {
+      LOG(ERROR) << "Error encrypting in software: " << GetErrorString(result);
+      return false;
+    }
+    std::string decrypted;
+    result = utility->AsymmetricDecrypt(decrypt_key, scheme, TPM_ALG_SHA256,
+                                        ciphertext, session->GetDelegate(),
+                                        &decrypted);
+    if (result != TPM_RC_SUCCESS) {
+      LOG(ERROR) << "Error using key to decrypt: " << GetErrorString(result);
+      return false;
+    }
+    if (decrypted != plaintext) {
+      LOG(ERROR) << "Plaintext changed after encrypt + decrypt.";
+      return false;
+    }
+  }
+  return true;
+}
+
 bool TrunksClientTest::ImportTest() {
   std::unique_ptr<TpmUtility> utility = factory_.GetTpmUtility();
   std::unique_ptr<HmacSession> session = factory_.GetHmacSession();
@@ -951,6 +1099,93 @@ bool TrunksClientTest::ManyKeysTest() {
   return true;
 }
 
+bool TrunksClientTest::BulkImportTest() {
+  const size_t kNumKeys = 500;
+  std::unique_ptr<TpmUtility> utility = factory_.GetTpmUtility();
+  std::unique_ptr<AuthorizationDelegate> delegate =
+      factory_.GetPasswordAuthorization("");
+  // Generating keys is not what is being measured, so every import uses the
+  // same key material. Each import still gets its own wrapping key.
+  std::string modulus;
+  std::string prime_factor;
+  GenerateRSAKeyPair(&modulus, &prime_factor, nullptr);
+  std::vector<TpmUtility::RSAKeyImport> keys(
+      kNumKeys, {TpmUtility::AsymmetricKeyUsage::kSignKey, modulus, 0x10001,
+                 prime_factor, ""});
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (const auto& key : keys) {
+    TPM_RC result = utility->ImportRSAKey(
+        key.key_type, key.modulus, key.public_exponent, key.prime_factor,
+        key.password, delegate.get(), nullptr);
+    if (result != TPM_RC_SUCCESS) {
+      LOG(ERROR) << "ImportRSAKey: " << GetErrorString(result);
+      return false;
+    }
+  }
+  base::TimeDelta serial_time = base::TimeTicks::Now() - start;
+  start = base::TimeTicks::Now();
+  std::vector<TPM_RC> results;
+  std::vector<std::string> key_blobs;
+  TPM_RC result = utility->ImportRSAKeys(
+      keys, delegate.get(), TpmUtility::ImportProgressCallback(), &results,
+      &key_blobs);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << "ImportRSAKeys: " << GetErrorString(result);
+    return false;
+  }
+  base::TimeDelta batch_time = base::TimeTicks::Now() - start;
+  LOG(INFO) << "Imported " << kNumKeys << " keys one at a time in "
+            << serial_time.InMilliseconds() << " ms ("
+            << kNumKeys / serial_time.InSecondsF() << " keys/s), in a batch in "
+            << batch_time.InMilliseconds() << " ms ("
+            << kNumKeys / batch_time.InSecondsF() << " keys/s).";
+  return true;
+}
+
+bool TrunksClientTest::PCRExtendTest() {
+  const size_t kNumEvents = 1000;
+  // The debug PCR, which is not used for measured boot.
+  const int kPCRIndex = 16;
+  // EV_IPL, as used for files measured after boot.
+  const uint32_t kEventType = 0xD;
+  std::unique_ptr<TpmUtility> utility = factory_.GetTpmUtility();
+  std::vector<TpmUtility::PCREvent> events;
+  for (size_t i = 0; i < kNumEvents; ++i) {
+    events.push_back({kPCRIndex, kEventType,
+                      crypto::SHA256HashString(std::to_string(i))});
+  }
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (const auto& event : events) {
+    TPM_RC result = utility->ExtendPCR(kPCRIndex, event.event_data, nullptr);
+    if (result != TPM_RC_SUCCESS) {
+      LOG(ERROR) << "ExtendPCR: " << GetErrorString(result);
+      return false;
+    }
+  }
+  base::TimeDelta serial_time = base::TimeTicks::Now() - start;
+  base::ScopedTempDir temp_dir;
+  TpmEventLog event_log;
+  if (!temp_dir.CreateUniqueTempDir() ||
+      !event_log.Open(temp_dir.path().Append("event_log"), 64)) {
+    LOG(ERROR) << "Error creating event log.";
+    return false;
+  }
+  start = base::TimeTicks::Now();
+  TPM_RC result = utility->ExtendPCRs(events, nullptr, &event_log);
+  if (result != TPM_RC_SUCCESS) {
+    LOG(ERROR) << "ExtendPCRs: " << GetErrorString(result);
+    return false;
+  }
+  base::TimeDelta batch_time = base::TimeTicks::Now() - start;
+  LOG(INFO) << "Extended " << kNumEvents << " events one at a time in "
+            << serial_time.InMilliseconds() << " ms ("
+            << kNumEvents / serial_time.InSecondsF()
+            << " events/s), in a batch with an event log in "
+            << batch_time.InMilliseconds() << " ms ("
+            << kNumEvents / batch_time.InSecondsF() << " events/s).";
+  return true;
+}
+
 bool TrunksClientTest::ManySessionsTest() {
   const size_t kNumSessions = 20;
   std::unique_ptr<TpmUtility> utility = factory_.GetTpmUtility();
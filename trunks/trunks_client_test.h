@@ -47,10 +47,18 @@ class TrunksClientTest {
   // use it to sign arbitrary data.
   bool SignTest();
 
+  // This test verifies that we can create a P-256 ECC signing key and use it to
+  // sign and verify with ECDSA.
+  bool EccSignTest();
+
   // This test verfifies that we can create an unrestricted RSA decryption key
   // and use it to encrypt and decrypt arbitrary data.
   bool DecryptTest();
 
+  // This test verifies that RSA public key operations performed in software
+  // give the same results as the TPM.
+  bool SoftwarePublicKeyTest();
+
   // This test verifies that we can import a RSA key into the TPM and use it
   // to encrypt and decrypt some data.
   bool ImportTest();
@@ -100,6 +108,14 @@ class TrunksClientTest {
   // This test uses many sessions simultaneously.
   bool ManySessionsTest();
 
+  // This test imports many keys one at a time and then with ImportRSAKeys,
+  // and logs the import rate of both.
+  bool BulkImportTest();
+
+  // This test extends a PCR with many events one at a time and then with
+  // ExtendPCRs and an event log, and logs the event rate of both.
+  bool PCRExtendTest();
+
  private:
   // This method verifies that plaintext == decrypt(encrypt(plaintext)) using
   // a given key.
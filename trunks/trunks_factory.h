@@ -24,9 +24,12 @@
 
 #include "trunks/authorization_delegate.h"
 #include "trunks/blob_parser.h"
+#include "trunks/hmac_drbg.h"
 #include "trunks/hmac_session.h"
 #include "trunks/policy_session.h"
+#include "trunks/rsa_key_pool.h"
 #include "trunks/session_manager.h"
+#include "trunks/tpm_object_cache.h"
 #include "trunks/tpm_state.h"
 #include "trunks/tpm_utility.h"
 #include "trunks/trunks_export.h"
@@ -72,6 +75,21 @@ class TRUNKS_EXPORT TrunksFactory {
   // Returns a BlobParser instance. The caller takes ownership.
   virtual std::unique_ptr<BlobParser> GetBlobParser() const = 0;
 
+  // Returns the object metadata cache shared by all objects created by this
+  // factory. The caller does not take ownership. All calls to this method on a
+  // given TrunksFactory instance will return the same value.
+  virtual TpmObjectCache* GetObjectCache() const = 0;
+
+  // Returns the pool of pre-generated RSA keys shared by all objects created by
+  // this factory. The caller does not take ownership. All calls to this method
+  // on a given TrunksFactory instance will return the same value.
+  virtual RsaKeyPool* GetRsaKeyPool() const = 0;
+
+  // Returns the software random bit generator shared by all objects created by
+  // this factory. The caller does not take ownership. All calls to this method
+  // on a given TrunksFactory instance will return the same value.
+  virtual HmacDrbg* GetDrbg() const = 0;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(TrunksFactory);
 };
@@ -154,6 +154,12 @@ class TpmUtilityForwarder : public TpmUtility {
     return target_->ExtendPCR(pcr_index, extend_data, delegate);
   }
 
+  TPM_RC ExtendPCRs(const std::vector<PCREvent>& events,
+                    AuthorizationDelegate* delegate,
+                    TpmEventLog* event_log) override {
+    return target_->ExtendPCRs(events, delegate, event_log);
+  }
+
   TPM_RC ReadPCR(int pcr_index, std::string* pcr_value) override {
     return target_->ReadPCR(pcr_index, pcr_value);
   }
@@ -188,6 +194,36 @@ class TpmUtilityForwarder : public TpmUtility {
                          signature);
   }
 
+  TPM_RC SignBatch(TPM_HANDLE key_handle,
+                   TPM_ALG_ID scheme,
+                   TPM_ALG_ID hash_alg,
+                   const std::vector<std::string>& digests,
+                   AuthorizationDelegate* delegate,
+                   std::vector<std::string>* signatures,
+                   std::vector<TPM_RC>* results) override {
+    return target_->SignBatch(key_handle, scheme, hash_alg, digests, delegate,
+                              signatures, results);
+  }
+
+  TPM_RC SignStreamBegin(TPM_HANDLE key_handle,
+                         TPM_ALG_ID scheme,
+                         TPM_ALG_ID hash_alg,
+                         bool use_tpm_hash_sequence,
+                         AuthorizationDelegate* delegate,
+                         std::unique_ptr<SignStream>* stream) override {
+    return target_->SignStreamBegin(key_handle, scheme, hash_alg,
+                                    use_tpm_hash_sequence, delegate, stream);
+  }
+
+  TPM_RC SignStreamUpdate(SignStream* stream,
+                          const std::string& data) override {
+    return target_->SignStreamUpdate(stream, data);
+  }
+
+  TPM_RC SignStreamFinish(SignStream* stream, std::string* signature) override {
+    return target_->SignStreamFinish(stream, signature);
+  }
+
   TPM_RC Verify(TPM_HANDLE key_handle,
                 TPM_ALG_ID scheme,
                 TPM_ALG_ID hash_alg,
@@ -198,6 +234,10 @@ class TpmUtilityForwarder : public TpmUtility {
                            delegate);
   }
 
+  void SetSoftwarePublicKeyOperations(bool enabled) override {
+    target_->SetSoftwarePublicKeyOperations(enabled);
+  }
+
   TPM_RC CertifyCreation(TPM_HANDLE key_handle,
                          const std::string& creation_blob) override {
     return target_->CertifyCreation(key_handle, creation_blob);
@@ -222,6 +262,15 @@ class TpmUtilityForwarder : public TpmUtility {
                                  prime_factor, password, delegate, key_blob);
   }
 
+  TPM_RC ImportRSAKeys(const std::vector<RSAKeyImport>& keys,
+                       AuthorizationDelegate* delegate,
+                       const ImportProgressCallback& progress,
+                       std::vector<TPM_RC>* results,
+                       std::vector<std::string>* key_blobs) override {
+    return target_->ImportRSAKeys(keys, delegate, progress, results,
+                                  key_blobs);
+  }
+
   TPM_RC CreateRSAKeyPair(AsymmetricKeyUsage key_type,
                           int modulus_bits,
                           uint32_t public_exponent,
@@ -238,6 +287,21 @@ class TpmUtilityForwarder : public TpmUtility {
         creation_blob);
   }
 
+  TPM_RC CreateECCKeyPair(AsymmetricKeyUsage key_type,
+                          const std::string& password,
+                          const std::string& policy_digest,
+                          bool use_only_policy_authorization,
+                          int creation_pcr_index,
+                          AuthorizationDelegate* delegate,
+                          std::string* key_blob,
+                          std::string* creation_blob) override {
+    return target_->CreateECCKeyPair(
+        key_type, password, policy_digest, use_only_policy_authorization,
+        creation_pcr_index, delegate, key_blob, creation_blob);
+  }
+
+  TPM_RC FillRSAKeyPool() override { return target_->FillRSAKeyPool(); }
+
   TPM_RC LoadKey(const std::string& key_blob,
                  AuthorizationDelegate* delegate,
                  TPM_HANDLE* key_handle) override {
@@ -550,7 +614,13 @@ TrunksFactoryForTest::TrunksFactoryForTest()
       default_trial_session_(new NiceMock<MockPolicySession>()),
       trial_session_(default_trial_session_.get()),
       default_blob_parser_(new NiceMock<MockBlobParser>()),
-      blob_parser_(default_blob_parser_.get()) {}
+      blob_parser_(default_blob_parser_.get()),
+      default_object_cache_(new TpmObjectCache()),
+      object_cache_(default_object_cache_.get()),
+      default_rsa_key_pool_(new RsaKeyPool()),
+      rsa_key_pool_(default_rsa_key_pool_.get()),
+      default_drbg_(new HmacDrbg()),
+      drbg_(default_drbg_.get()) {}
 
 TrunksFactoryForTest::~TrunksFactoryForTest() {}
 
@@ -594,4 +664,16 @@ std::unique_ptr<BlobParser> TrunksFactoryForTest::GetBlobParser() const {
   return base::MakeUnique<BlobParserForwarder>(blob_parser_);
 }
 
+TpmObjectCache* TrunksFactoryForTest::GetObjectCache() const {
+  return object_cache_;
+}
+
+RsaKeyPool* TrunksFactoryForTest::GetRsaKeyPool() const {
+  return rsa_key_pool_;
+}
+
+HmacDrbg* TrunksFactoryForTest::GetDrbg() const {
+  return drbg_;
+}
+
 }  // namespace trunks
@@ -71,6 +71,9 @@ class TRUNKS_EXPORT TrunksFactoryForTest : public TrunksFactory {
   std::unique_ptr<PolicySession> GetPolicySession() const override;
   std::unique_ptr<PolicySession> GetTrialSession() const override;
   std::unique_ptr<BlobParser> GetBlobParser() const override;
+  TpmObjectCache* GetObjectCache() const override;
+  RsaKeyPool* GetRsaKeyPool() const override;
+  HmacDrbg* GetDrbg() const override;
 
   // Mutators to inject custom mocks.
   void set_tpm(Tpm* tpm) { tpm_ = tpm; }
@@ -101,6 +104,16 @@ class TRUNKS_EXPORT TrunksFactoryForTest : public TrunksFactory {
 
   void set_blob_parser(BlobParser* blob_parser) { blob_parser_ = blob_parser; }
 
+  void set_object_cache(TpmObjectCache* object_cache) {
+    object_cache_ = object_cache;
+  }
+
+  void set_rsa_key_pool(RsaKeyPool* rsa_key_pool) {
+    rsa_key_pool_ = rsa_key_pool;
+  }
+
+  void set_drbg(HmacDrbg* drbg) { drbg_ = drbg; }
+
  private:
   std::unique_ptr<MockTpm> default_tpm_;
   Tpm* tpm_;
@@ -121,6 +134,12 @@ class TRUNKS_EXPORT TrunksFactoryForTest : public TrunksFactory {
   PolicySession* trial_session_;
   std::unique_ptr<MockBlobParser> default_blob_parser_;
   BlobParser* blob_parser_;
+  std::unique_ptr<TpmObjectCache> default_object_cache_;
+  TpmObjectCache* object_cache_;
+  std::unique_ptr<RsaKeyPool> default_rsa_key_pool_;
+  RsaKeyPool* rsa_key_pool_;
+  std::unique_ptr<HmacDrbg> default_drbg_;
+  HmacDrbg* drbg_;
 
   DISALLOW_COPY_AND_ASSIGN(TrunksFactoryForTest);
 };
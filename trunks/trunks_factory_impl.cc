@@ -42,10 +42,16 @@ TrunksFactoryImpl::TrunksFactoryImpl() {
   default_transceiver_.reset(new TrunksDBusProxy());
 #endif
   transceiver_ = default_transceiver_.get();
+  object_cache_.reset(new TpmObjectCache());
+  rsa_key_pool_.reset(new RsaKeyPool());
+  drbg_.reset(new HmacDrbg());
 }
 
 TrunksFactoryImpl::TrunksFactoryImpl(CommandTransceiver* transceiver) {
   transceiver_ = transceiver;
+  object_cache_.reset(new TpmObjectCache());
+  rsa_key_pool_.reset(new RsaKeyPool());
+  drbg_.reset(new HmacDrbg());
 }
 
 TrunksFactoryImpl::~TrunksFactoryImpl() {}
@@ -104,4 +110,16 @@ std::unique_ptr<BlobParser> TrunksFactoryImpl::GetBlobParser() const {
   return base::MakeUnique<BlobParser>();
 }
 
+TpmObjectCache* TrunksFactoryImpl::GetObjectCache() const {
+  return object_cache_.get();
+}
+
+RsaKeyPool* TrunksFactoryImpl::GetRsaKeyPool() const {
+  return rsa_key_pool_.get();
+}
+
+HmacDrbg* TrunksFactoryImpl::GetDrbg() const {
+  return drbg_.get();
+}
+
 }  // namespace trunks
@@ -61,11 +61,17 @@ class TRUNKS_EXPORT TrunksFactoryImpl : public TrunksFactory {
   std::unique_ptr<PolicySession> GetPolicySession() const override;
   std::unique_ptr<PolicySession> GetTrialSession() const override;
   std::unique_ptr<BlobParser> GetBlobParser() const override;
+  TpmObjectCache* GetObjectCache() const override;
+  RsaKeyPool* GetRsaKeyPool() const override;
+  HmacDrbg* GetDrbg() const override;
 
  private:
   std::unique_ptr<CommandTransceiver> default_transceiver_;
   CommandTransceiver* transceiver_;
   std::unique_ptr<Tpm> tpm_;
+  std::unique_ptr<TpmObjectCache> object_cache_;
+  std::unique_ptr<RsaKeyPool> rsa_key_pool_;
+  std::unique_ptr<HmacDrbg> drbg_;
   bool initialized_ = false;
 
   DISALLOW_COPY_AND_ASSIGN(TrunksFactoryImpl);
@@ -14,56 +14,28 @@
 // limitations under the License.
 //
 
-#include <algorithm>
-#include <ctime>
-#include <string>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <base/logging.h>
 
-#include "trunks/tpm_generated.h"
 #include "trunks/trunks_ftdi_spi.h"
 
-// Assorted TPM2 registers for interface type FIFO.
-#define TPM_ACCESS_REG 0
-#define TPM_STS_REG 0x18
-#define TPM_DATA_FIFO_REG 0x24
-#define TPM_DID_VID_REG 0xf00
-#define TPM_RID_REG 0xf04
-
-namespace trunks {
-
-// Locality management bits (in TPM_ACCESS_REG)
-enum TpmAccessBits {
-  tpmRegValidSts = (1 << 7),
-  activeLocality = (1 << 5),
-  requestUse = (1 << 1),
-  tpmEstablishment = (1 << 0),
-};
-
-enum TpmStsBits {
-  tpmFamilyShift = 26,
-  tpmFamilyMask = ((1 << 2) - 1),  // 2 bits wide
-  tpmFamilyTPM2 = 1,
-  resetEstablishmentBit = (1 << 25),
-  commandCancel = (1 << 24),
-  burstCountShift = 8,
-  burstCountMask = ((1 << 16) - 1),  // 16 bits wide
-  stsValid = (1 << 7),
-  commandReady = (1 << 6),
-  tpmGo = (1 << 5),
-  dataAvail = (1 << 4),
-  Expect = (1 << 3),
-  selfTestDone = (1 << 2),
-  responseRetry = (1 << 1),
-};
+namespace {
 
 // SPI frame header for TPM transactions is 4 bytes in size, it is described
 // in section "6.4.6 Spi Bit Protocol" of the TCG issued "TPM Profile (PTP)
 // Specification Revision 00.43.
-struct SpiFrameHeader {
-  unsigned char body[4];
-};
+const size_t kSpiFrameHeaderSize = 4;
+
+// Upper bound on the number of single byte polls while the TPM holds the bus
+// in the SPI flow control wait state.
+const int kMaxFlowControlPolls = 1000;
+
+}  // namespace
+
+namespace trunks {
 
 TrunksFtdiSpi::~TrunksFtdiSpi() {
   if (mpsse_)
@@ -72,35 +44,21 @@ TrunksFtdiSpi::~TrunksFtdiSpi() {
   mpsse_ = NULL;
 }
 
-bool TrunksFtdiSpi::ReadTpmSts(uint32_t* status) {
-  return FtdiReadReg(TPM_STS_REG, sizeof(*status), status);
-}
-
-bool TrunksFtdiSpi::WriteTpmSts(uint32_t status) {
-  return FtdiWriteReg(TPM_STS_REG, sizeof(status), &status);
-}
-
-void TrunksFtdiSpi::StartTransaction(bool read_write,
+// static
+void TrunksFtdiSpi::BuildFrameHeader(bool read_write,
                                      size_t bytes,
-                                     unsigned addr) {
-  unsigned char* response;
-  SpiFrameHeader header;
-
-  usleep(10000);  // give it 10 ms. TODO(vbendeb): remove this once
-                  // cr50 SPS TPM driver performance is fixed.
-
+                                     uint32_t addr,
+                                     uint8_t* header) {
   // The first byte of the frame header encodes the transaction type (read or
   // write) and size (set to lenth - 1).
-  header.body[0] = (read_write ? 0x80 : 0) | 0x40 | (bytes - 1);
+  header[0] = (read_write ? 0x80 : 0) | 0x40 | (bytes - 1);
 
   // The rest of the frame header is the internal address in the TPM
   for (int i = 0; i < 3; i++)
-    header.body[i + 1] = (addr >> (8 * (2 - i))) & 0xff;
-
-  Start(mpsse_);
-
-  response = Transfer(mpsse_, header.body, sizeof(header.body));
+    header[i + 1] = (addr >> (8 * (2 - i))) & 0xff;
+}
 
+bool TrunksFtdiSpi::WaitForFlowControl() {
   // The TCG TPM over SPI specification itroduces the notion of SPI flow
   // control (Section "6.4.5 Flow Control" of the TCG issued "TPM Profile
   // (PTP) Specification Revision 00.43).
@@ -111,56 +69,101 @@ void TrunksFtdiSpi::StartTransaction(bool read_write,
   // this case the master is supposed to start polling the line, byte at time,
   // until the last bit in the received byte (transferred during the last
   // clock of the byte) is set to 1.
-  while (!(response[3] & 1)) {
-    unsigned char* poll_state;
-
-    poll_state = Read(mpsse_, 1);
-    response[3] = *poll_state;
+  for (int i = 0; i < kMaxFlowControlPolls; i++) {
+    uint8_t* poll_state = Read(mpsse_, 1);
+    if (!poll_state)
+      return false;
+    bool ready = *poll_state & 1;
     free(poll_state);
+    if (ready)
+      return true;
   }
-  free(response);
+  LOG(ERROR) << "TPM did not leave SPI wait state";
+  return false;
 }
 
-bool TrunksFtdiSpi::FtdiWriteReg(unsigned reg_number,
-                                 size_t bytes,
-                                 const void* buffer) {
-  if (!mpsse_)
+bool TrunksFtdiSpi::SpiWrite(uint32_t addr,
+                             size_t bytes,
+                             const uint8_t* buffer) {
+  uint8_t header[kSpiFrameHeaderSize];
+
+  if (!mpsse_ || !bytes || bytes > kMaxFrameSize)
     return false;
 
-  StartTransaction(false, bytes, reg_number + locality_ * 0x10000);
-  Write(mpsse_, buffer, bytes);
+  BuildFrameHeader(false, bytes, addr, header);
+  Start(mpsse_);
+  uint8_t* response = Transfer(mpsse_, header, sizeof(header));
+  if (!response) {
+    Stop(mpsse_);
+    return false;
+  }
+  // The write payload can't be sent speculatively along with the header:
+  // the TPM ignores MOSI while it stalls the transaction.
+  bool ready = (response[kSpiFrameHeaderSize - 1] & 1) || WaitForFlowControl();
+  free(response);
+  bool success = ready && Write(mpsse_, buffer, bytes) == MPSSE_OK;
   Stop(mpsse_);
-  return true;
+  return success;
 }
 
-bool TrunksFtdiSpi::FtdiReadReg(unsigned reg_number,
-                                size_t bytes,
-                                void* buffer) {
-  unsigned char* value;
+bool TrunksFtdiSpi::SpiRead(uint32_t addr, size_t bytes, uint8_t* buffer) {
+  // The header and the read payload are clocked out in a single MPSSE
+  // transfer, saving a USB round trip per register access in the common case
+  // where the TPM doesn't insert wait states.
+  uint8_t frame[kSpiFrameHeaderSize + kMaxFrameSize];
 
-  if (!mpsse_)
+  if (!mpsse_ || !bytes || bytes > kMaxFrameSize)
     return false;
 
-  StartTransaction(true, bytes, reg_number + locality_ * 0x10000);
-  value = Read(mpsse_, bytes);
-  if (buffer)
-    memcpy(buffer, value, bytes);
-  free(value);
-  Stop(mpsse_);
-  return true;
-}
+  BuildFrameHeader(true, bytes, addr, frame);
+  size_t frame_size = kSpiFrameHeaderSize + bytes;
+  memset(frame + kSpiFrameHeaderSize, 0, bytes);
+  Start(mpsse_);
+  uint8_t* response = Transfer(mpsse_, frame, frame_size);
+  if (!response) {
+    Stop(mpsse_);
+    return false;
+  }
 
-size_t TrunksFtdiSpi::GetBurstCount(void) {
-  uint32_t status;
+  // While stalling, the TPM returns zero bytes; the first byte with the last
+  // bit set ends the wait state and the payload follows it.
+  size_t data_offset = kSpiFrameHeaderSize;
+  if (!(response[kSpiFrameHeaderSize - 1] & 1)) {
+    while (data_offset < frame_size && !(response[data_offset] & 1))
+      data_offset++;
+    if (data_offset == frame_size) {
+      // Still stalled after the whole frame.
+      if (!WaitForFlowControl()) {
+        free(response);
+        Stop(mpsse_);
+        return false;
+      }
+    }
+    data_offset++;
+  }
+
+  size_t received = 0;
+  if (data_offset < frame_size) {
+    received = frame_size - data_offset;
+    memcpy(buffer, response + data_offset, received);
+  }
+  free(response);
 
-  ReadTpmSts(&status);
-  return (size_t)((status >> burstCountShift) & burstCountMask);
+  bool success = true;
+  if (received < bytes) {
+    uint8_t* value = Read(mpsse_, bytes - received);
+    if (value) {
+      memcpy(buffer + received, value, bytes - received);
+      free(value);
+    } else {
+      success = false;
+    }
+  }
+  Stop(mpsse_);
+  return success;
 }
 
 bool TrunksFtdiSpi::Init() {
-  uint32_t did_vid, status;
-  uint8_t cmd;
-
   if (mpsse_)
     return true;
 
@@ -173,173 +176,7 @@ bool TrunksFtdiSpi::Init() {
   usleep(100000);
   PinHigh(mpsse_, GPIOL0);
 
-  FtdiReadReg(TPM_DID_VID_REG, sizeof(did_vid), &did_vid);
-
-  uint16_t vid = did_vid & 0xffff;
-  if ((vid != 0x15d1) && (vid != 0x1ae0)) {
-    LOG(ERROR) << "unknown did_vid: 0x" << std::hex << did_vid;
-    return false;
-  }
-
-  // Try claiming locality zero.
-  FtdiReadReg(TPM_ACCESS_REG, sizeof(cmd), &cmd);
-  // tpmEstablishment can be either set or not.
-  if ((cmd & ~tpmEstablishment) != tpmRegValidSts) {
-    LOG(ERROR) << "invalid reset status: 0x" << std::hex << (unsigned)cmd;
-    return false;
-  }
-  cmd = requestUse;
-  FtdiWriteReg(TPM_ACCESS_REG, sizeof(cmd), &cmd);
-  FtdiReadReg(TPM_ACCESS_REG, sizeof(cmd), &cmd);
-  if ((cmd & ~tpmEstablishment) != (tpmRegValidSts | activeLocality)) {
-    LOG(ERROR) << "failed to claim locality, status: 0x" << std::hex
-               << (unsigned)cmd;
-    return false;
-  }
-
-  ReadTpmSts(&status);
-  if (((status >> tpmFamilyShift) & tpmFamilyMask) != tpmFamilyTPM2) {
-    LOG(ERROR) << "unexpected TPM family value, status: 0x" << std::hex
-               << status;
-    return false;
-  }
-  FtdiReadReg(TPM_RID_REG, sizeof(cmd), &cmd);
-  printf("Connected to device vid:did:rid of %4.4x:%4.4x:%2.2x\n",
-         did_vid & 0xffff, did_vid >> 16, cmd);
-
-  return true;
-}
-
-void TrunksFtdiSpi::SendCommand(const std::string& command,
-                                const ResponseCallback& callback) {
-  printf("%s invoked\n", __func__);
-}
-
-bool TrunksFtdiSpi::WaitForStatus(uint32_t statusMask,
-                                  uint32_t statusExpected,
-                                  int timeout_ms) {
-  uint32_t status;
-  time_t target_time;
-
-  target_time = time(NULL) + timeout_ms / 1000;
-  do {
-    usleep(10000);  // 10 ms polling period.
-    if (time(NULL) >= target_time) {
-      LOG(ERROR) << "failed to get expected status " << std::hex
-                 << statusExpected;
-      return false;
-    }
-    ReadTpmSts(&status);
-  } while ((status & statusMask) != statusExpected);
-  return true;
-}
-
-std::string TrunksFtdiSpi::SendCommandAndWait(const std::string& command) {
-  uint32_t status;
-  uint32_t expected_status_bits;
-  size_t transaction_size, handled_so_far(0);
-
-  std::string rv("");
-
-  if (!mpsse_) {
-    LOG(ERROR) << "attempt to use an uninitialized FTDI TPM!";
-    return rv;
-  }
-
-  WriteTpmSts(commandReady);
-
-  // No need to wait for the sts.Expect bit to be set, at least with the
-  // 15d1:001b device, let's just write the command into FIFO, not exceeding
-  // the minimum of the two values - burst_count and 64 (which is the protocol
-  // limitation)
-  do {
-    transaction_size = std::min(
-        std::min(command.size() - handled_so_far, GetBurstCount()), (size_t)64);
-
-    if (transaction_size) {
-      LOG(INFO) << "will transfer " << transaction_size << " bytes";
-      FtdiWriteReg(TPM_DATA_FIFO_REG, transaction_size,
-                   command.c_str() + handled_so_far);
-      handled_so_far += transaction_size;
-    }
-  } while (handled_so_far != command.size());
-
-  // And tell the device it can start processing it.
-  WriteTpmSts(tpmGo);
-
-  expected_status_bits = stsValid | dataAvail;
-  if (!WaitForStatus(expected_status_bits, expected_status_bits))
-    return rv;
-
-  // The response is ready, let's read it.
-  // First we read the FIFO payload header, to see how much data to expect.
-  // The header size is fixed to six bytes, the total payload size is stored
-  // in network order in the last four bytes of the header.
-  char data_header[6];
-
-  // Let's read the header first.
-  FtdiReadReg(TPM_DATA_FIFO_REG, sizeof(data_header), data_header);
-
-  // Figure out the total payload size.
-  uint32_t payload_size;
-  memcpy(&payload_size, data_header + 2, sizeof(payload_size));
-  payload_size = be32toh(payload_size);
-  // A FIFO message with the minimum required header and contents can not be
-  // less than 10 bytes long. It also should never be more than 4096 bytes
-  // long.
-  if ((payload_size < 10) || (payload_size > MAX_RESPONSE_SIZE)) {
-    // Something must be wrong...
-    LOG(ERROR) << "Bad total payload size value: " << payload_size;
-    return rv;
-  }
-
-  LOG(INFO) << "Total payload size " << payload_size;
-
-  // Let's read all but the last byte in the FIFO to make sure the status
-  // register is showing correct flow control bits: 'more data' until the last
-  // byte and then 'no more data' once the last byte is read.
-  handled_so_far = 0;
-  payload_size = payload_size - sizeof(data_header) - 1;
-  // Allow room for the last byte too.
-  uint8_t* payload = new uint8_t[payload_size + 1];
-  do {
-    transaction_size = std::min(
-        std::min(payload_size - handled_so_far, GetBurstCount()), (size_t)64);
-
-    if (transaction_size) {
-      FtdiReadReg(TPM_DATA_FIFO_REG, transaction_size,
-                  payload + handled_so_far);
-      handled_so_far += transaction_size;
-    }
-  } while (handled_so_far != payload_size);
-
-  // Verify that there is still data to come.
-  ReadTpmSts(&status);
-  if ((status & expected_status_bits) != expected_status_bits) {
-    LOG(ERROR) << "unexpected status 0x" << std::hex << status;
-    delete[] payload;
-    return rv;
-  }
-
-  // Now, read the last byte of the payload.
-  FtdiReadReg(TPM_DATA_FIFO_REG, sizeof(uint8_t), payload + payload_size);
-
-  // Verify that 'data available' is not asseretd any more.
-  ReadTpmSts(&status);
-  if ((status & expected_status_bits) != stsValid) {
-    LOG(ERROR) << "unexpected status 0x" << std::hex << status;
-    delete[] payload;
-    return rv;
-  }
-
-  rv = std::string(data_header, sizeof(data_header)) +
-       std::string(reinterpret_cast<char*>(payload), payload_size + 1);
-
-  /* Move the TPM back to idle state. */
-  WriteTpmSts(commandReady);
-
-  delete[] payload;
-  return rv;
+  return InitTpm();
 }
 
 }  // namespace trunks
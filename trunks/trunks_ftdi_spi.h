@@ -27,51 +27,42 @@
 #if defined SPI_OVER_FTDI
 
 #include "trunks/ftdi/mpsse.h"
+#include "trunks/tpm_tis_spi.h"
 
 namespace trunks {
 
 // TrunksFtdiSpi is a CommandTransceiver implementation that forwards all
-// commands to the SPI over FTDI interface directly to a TPM chip.
-class TRUNKS_EXPORT TrunksFtdiSpi : public CommandTransceiver {
+// commands to the SPI over FTDI interface directly to a TPM chip. The TIS
+// protocol is handled by TpmTisSpi, this class only moves SPI frames through
+// the MPSSE engine.
+class TRUNKS_EXPORT TrunksFtdiSpi : public TpmTisSpi {
  public:
-  TrunksFtdiSpi() : mpsse_(NULL), locality_(0) {}
+  TrunksFtdiSpi() : mpsse_(NULL) {}
   ~TrunksFtdiSpi() override;
 
   // CommandTransceiver methods.
   bool Init() override;
-  void SendCommand(const std::string& command,
-                   const ResponseCallback& callback) override;
-  std::string SendCommandAndWait(const std::string& command) override;
+
+ protected:
+  // TpmTisSpi methods.
+  bool SpiRead(uint32_t addr, size_t bytes, uint8_t* buffer) override;
+  bool SpiWrite(uint32_t addr, size_t bytes, const uint8_t* buffer) override;
 
  private:
   struct mpsse_context* mpsse_;
-  unsigned locality_;  // Set at initialization.
-
-  // Read a TPM register into the passed in buffer, where 'bytes' the width of
-  // the register. Return true on success, false on failure.
-  bool FtdiReadReg(unsigned reg_number, size_t bytes, void* buffer);
-  // Write a TPM register from the passed in buffer, where 'bytes' the width of
-  // the register. Return true on success, false on failure.
-  bool FtdiWriteReg(unsigned reg_number, size_t bytes, const void* buffer);
-  // Generate a proper SPI frame for read/write transaction, read_write set to
-  // true for read transactions, the size of the transaction is passed as
-  // 'bytes', addr is the internal TPM address space address (accounting for
-  // locality).
-  //
-  // Note that this function is expected to be called when the SPI bus is idle
-  // (CS deasserted), and will assert the CS before transmitting.
-  void StartTransaction(bool read_write, size_t bytes, unsigned addr);
-  // TPM Status Register is going to be accessed a lot, let's have dedicated
-  // accessors for it,
-  bool ReadTpmSts(uint32_t* status);
-  bool WriteTpmSts(uint32_t status);
-  // Poll status register until the required value is read or the timeout
-  // expires.
-  bool WaitForStatus(uint32_t statusMask,
-                     uint32_t statusExpected,
-                     int timeout_ms = 10000);
-  // Retrieve current value of the burst count field.
-  size_t GetBurstCount(void);
+
+  // Generate a proper SPI frame header for read/write transaction into
+  // |header|, read_write set to true for read transactions, the size of the
+  // transaction is passed as 'bytes', addr is the internal TPM address space
+  // address (accounting for locality).
+  static void BuildFrameHeader(bool read_write,
+                               size_t bytes,
+                               uint32_t addr,
+                               uint8_t* header);
+  // Clocks single bytes until the TPM signals the end of the SPI flow control
+  // wait state. Expected to be called with CS asserted. Returns true once the
+  // TPM is ready, false if it never becomes ready.
+  bool WaitForFlowControl();
 
   DISALLOW_COPY_AND_ASSIGN(TrunksFtdiSpi);
 };
@@ -0,0 +1,170 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/trunks_socket_proxy.h"
+
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include <utility>
+
+#include <base/logging.h>
+#include <base/posix/eintr_wrapper.h>
+#include <base/sys_byteorder.h>
+
+#include "trunks/error_codes.h"
+
+namespace {
+
+// The offset of the size field in a TPM message header and the header size.
+const size_t kSizeOffset = 2;
+const size_t kHeaderSize = 10;
+
+// Use the same five minute timeout as the D-Bus proxy because some commands on
+// some TPM hardware can take a very long time.
+const time_t kReceiveTimeoutSeconds = 5 * 60;
+
+}  // namespace
+
+namespace trunks {
+
+const size_t TrunksSocketProxy::kMaxCommandsInFlight;
+
+bool IsCompleteTpmMessage(const std::string& message) {
+  if (message.size() < kHeaderSize) {
+    return false;
+  }
+  uint32_t size = 0;
+  memcpy(&size, message.data() + kSizeOffset, sizeof(size));
+  return base::NetToHost32(size) == message.size();
+}
+
+TrunksSocketProxy::TrunksSocketProxy(const base::FilePath& socket_path)
+    : socket_path_(socket_path) {}
+
+TrunksSocketProxy::TrunksSocketProxy(base::ScopedFD fd) : fd_(std::move(fd)) {}
+
+TrunksSocketProxy::~TrunksSocketProxy() {}
+
+bool TrunksSocketProxy::Init() {
+  base::AutoLock lock(lock_);
+  if (fd_.is_valid()) {
+    return true;
+  }
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path_.value().size() >= sizeof(address.sun_path)) {
+    LOG(ERROR) << "TrunksSocketProxy: Socket path too long.";
+    return false;
+  }
+  strncpy(address.sun_path, socket_path_.value().c_str(),
+          sizeof(address.sun_path) - 1);
+  base::ScopedFD fd(socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0));
+  if (!fd.is_valid()) {
+    PLOG(ERROR) << "TrunksSocketProxy: Failed to create socket";
+    return false;
+  }
+  if (HANDLE_EINTR(connect(fd.get(),
+                           reinterpret_cast<struct sockaddr*>(&address),
+                           sizeof(address))) < 0) {
+    PLOG(ERROR) << "TrunksSocketProxy: Failed to connect to "
+                << socket_path_.value();
+    return false;
+  }
+  struct timeval timeout = {kReceiveTimeoutSeconds, 0};
+  if (setsockopt(fd.get(), SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                 sizeof(timeout)) < 0) {
+    PLOG(WARNING) << "TrunksSocketProxy: Failed to set receive timeout";
+  }
+  fd_ = std::move(fd);
+  return true;
+}
+
+void TrunksSocketProxy::SendCommand(const std::string& command,
+                                    const ResponseCallback& callback) {
+  callback.Run(SendCommandAndWait(command));
+}
+
+std::string TrunksSocketProxy::SendCommandAndWait(const std::string& command) {
+  base::AutoLock lock(lock_);
+  if (!SendLocked(command)) {
+    return CreateErrorResponse(TRUNKS_RC_IPC_ERROR);
+  }
+  return ReceiveLocked();
+}
+
+std::vector<std::string> TrunksSocketProxy::SendCommandsAndWait(
+    const std::vector<std::string>& commands) {
+  base::AutoLock lock(lock_);
+  std::vector<std::string> responses;
+  responses.reserve(commands.size());
+  size_t num_sent = 0;
+  while (responses.size() < commands.size()) {
+    // Keep the window full. Once the connection fails every remaining command
+    // gets an error response from ReceiveLocked().
+    while (num_sent < commands.size() &&
+           num_sent - responses.size() < kMaxCommandsInFlight &&
+           SendLocked(commands[num_sent])) {
+      ++num_sent;
+    }
+    responses.push_back(ReceiveLocked());
+  }
+  return responses;
+}
+
+bool TrunksSocketProxy::SendLocked(const std::string& command) {
+  if (!fd_.is_valid()) {
+    LOG(ERROR) << "TrunksSocketProxy: Not connected.";
+    return false;
+  }
+  ssize_t sent = HANDLE_EINTR(
+      send(fd_.get(), command.data(), command.size(), MSG_NOSIGNAL));
+  if (sent != static_cast<ssize_t>(command.size())) {
+    PLOG(ERROR) << "TrunksSocketProxy: Failed to send command";
+    fd_.reset();
+    return false;
+  }
+  return true;
+}
+
+std::string TrunksSocketProxy::ReceiveLocked() {
+  if (!fd_.is_valid()) {
+    return CreateErrorResponse(TRUNKS_RC_IPC_ERROR);
+  }
+  std::string response(kMaxSocketMessageSize, 0);
+  ssize_t received =
+      HANDLE_EINTR(recv(fd_.get(), &response[0], response.size(), MSG_TRUNC));
+  if (received <= 0) {
+    PLOG_IF(ERROR, received < 0) << "TrunksSocketProxy: Failed to receive";
+    fd_.reset();
+    return CreateErrorResponse(SAPI_RC_NO_RESPONSE_RECEIVED);
+  }
+  if (received > static_cast<ssize_t>(response.size())) {
+    LOG(ERROR) << "TrunksSocketProxy: Response too large.";
+    return CreateErrorResponse(SAPI_RC_MALFORMED_RESPONSE);
+  }
+  response.resize(received);
+  if (!IsCompleteTpmMessage(response)) {
+    LOG(ERROR) << "TrunksSocketProxy: Bad response size.";
+    return CreateErrorResponse(SAPI_RC_MALFORMED_RESPONSE);
+  }
+  return response;
+}
+
+}  // namespace trunks
@@ -0,0 +1,87 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef TRUNKS_TRUNKS_SOCKET_PROXY_H_
+#define TRUNKS_TRUNKS_SOCKET_PROXY_H_
+
+#include <string>
+#include <vector>
+
+#include <base/files/file_path.h>
+#include <base/files/scoped_file.h>
+#include <base/macros.h>
+#include <base/synchronization/lock.h>
+
+#include "trunks/command_transceiver.h"
+#include "trunks/trunks_export.h"
+
+namespace trunks {
+
+// The largest message accepted on a trunksd socket. TPM commands and responses
+// are bounded by MAX_COMMAND_SIZE and MAX_RESPONSE_SIZE.
+constexpr size_t kMaxSocketMessageSize = 4096;
+
+// Returns true if the size field in the header of |message| matches the length
+// of |message|.
+TRUNKS_EXPORT bool IsCompleteTpmMessage(const std::string& message);
+
+// TrunksSocketProxy is a CommandTransceiver implementation that sends raw
+// commands to trunksd over a Unix socket. See TrunksSocketService for the
+// other end. Concurrent callers are serialized, so an instance may be shared by
+// multiple threads. Only SendCommandsAndWait has more than one command in
+// flight, and never more than kMaxCommandsInFlight. If a command
+// fails at the socket level the connection is closed and all later commands
+// fail, since the response stream can no longer be trusted.
+class TRUNKS_EXPORT TrunksSocketProxy : public CommandTransceiver {
+ public:
+  // Connects to the socket at |socket_path| when Init() is called.
+  explicit TrunksSocketProxy(const base::FilePath& socket_path);
+  // Uses |fd|, an already connected SOCK_SEQPACKET socket.
+  explicit TrunksSocketProxy(base::ScopedFD fd);
+  ~TrunksSocketProxy() override;
+
+  // Connects to trunksd. Returns true on success.
+  bool Init() override;
+
+  // CommandTransceiver methods. SendCommand runs |callback| before returning.
+  void SendCommand(const std::string& command,
+                   const ResponseCallback& callback) override;
+  std::string SendCommandAndWait(const std::string& command) override;
+  std::vector<std::string> SendCommandsAndWait(
+      const std::vector<std::string>& commands) override;
+
+  // Bounds the responses queued in the socket, since trunksd drops a client
+  // whose receive buffer is full.
+  static const size_t kMaxCommandsInFlight = 16;
+
+ private:
+  // Sends |command| without waiting for the response. Returns false and
+  // closes the connection on failure. Must be called with |lock_| held.
+  bool SendLocked(const std::string& command);
+  // Receives the next response, or returns an error response. Must be called
+  // with |lock_| held.
+  std::string ReceiveLocked();
+
+  base::FilePath socket_path_;
+  base::Lock lock_;
+  base::ScopedFD fd_;
+
+  DISALLOW_COPY_AND_ASSIGN(TrunksSocketProxy);
+};
+
+}  // namespace trunks
+
+#endif  // TRUNKS_TRUNKS_SOCKET_PROXY_H_
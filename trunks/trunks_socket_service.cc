@@ -0,0 +1,185 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/trunks_socket_service.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <utility>
+
+#include <base/bind.h>
+#include <base/logging.h>
+#include <base/posix/eintr_wrapper.h>
+
+#include "trunks/error_codes.h"
+#include "trunks/trunks_socket_proxy.h"
+
+namespace trunks {
+
+TrunksSocketService::TrunksSocketService() {}
+
+TrunksSocketService::~TrunksSocketService() {}
+
+bool TrunksSocketService::Listen(const base::FilePath& socket_path) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path.value().size() >= sizeof(address.sun_path)) {
+    LOG(ERROR) << "TrunksSocketService: Socket path too long.";
+    return false;
+  }
+  strncpy(address.sun_path, socket_path.value().c_str(),
+          sizeof(address.sun_path) - 1);
+  base::ScopedFD fd(
+      socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0));
+  if (!fd.is_valid()) {
+    PLOG(ERROR) << "TrunksSocketService: Failed to create socket";
+    return false;
+  }
+  // Remove a socket left behind by a previous instance.
+  unlink(socket_path.value().c_str());
+  if (bind(fd.get(), reinterpret_cast<struct sockaddr*>(&address),
+           sizeof(address)) < 0) {
+    PLOG(ERROR) << "TrunksSocketService: Failed to bind "
+                << socket_path.value();
+    return false;
+  }
+  // Like the D-Bus interface, the socket is open to every local user.
+  if (chmod(socket_path.value().c_str(), 0666) < 0) {
+    PLOG(ERROR) << "TrunksSocketService: Failed to set socket permissions";
+    return false;
+  }
+  if (listen(fd.get(), SOMAXCONN) < 0) {
+    PLOG(ERROR) << "TrunksSocketService: Failed to listen";
+    return false;
+  }
+  if (!base::MessageLoopForIO::current()->WatchFileDescriptor(
+          fd.get(), true, base::MessageLoopForIO::WATCH_READ, &listen_watcher_,
+          this)) {
+    LOG(ERROR) << "TrunksSocketService: Failed to watch socket.";
+    return false;
+  }
+  listen_fd_ = std::move(fd);
+  return true;
+}
+
+bool TrunksSocketService::AddClient(base::ScopedFD fd) {
+  std::unique_ptr<Client> client(new Client);
+  socklen_t credentials_size = sizeof(client->credentials);
+  if (getsockopt(fd.get(), SOL_SOCKET, SO_PEERCRED, &client->credentials,
+                 &credentials_size) < 0) {
+    PLOG(ERROR) << "TrunksSocketService: Failed to get peer credentials";
+    return false;
+  }
+  if (!base::MessageLoopForIO::current()->WatchFileDescriptor(
+          fd.get(), true, base::MessageLoopForIO::WATCH_READ, &client->watcher,
+          this)) {
+    LOG(ERROR) << "TrunksSocketService: Failed to watch client.";
+    return false;
+  }
+  client->id = next_client_id_++;
+  client->fd = std::move(fd);
+  VLOG(1) << "TrunksSocketService: Client connected, pid "
+          << client->credentials.pid << " uid " << client->credentials.uid;
+  int client_fd = client->fd.get();
+  clients_[client_fd] = std::move(client);
+  return true;
+}
+
+void TrunksSocketService::OnFileCanReadWithoutBlocking(int fd) {
+  if (fd == listen_fd_.get()) {
+    AcceptClient();
+    return;
+  }
+  auto iter = clients_.find(fd);
+  if (iter != clients_.end()) {
+    ReadCommand(iter->second.get());
+  }
+}
+
+void TrunksSocketService::AcceptClient() {
+  base::ScopedFD fd(HANDLE_EINTR(
+      accept4(listen_fd_.get(), nullptr, nullptr, SOCK_CLOEXEC)));
+  if (!fd.is_valid()) {
+    PLOG_IF(ERROR, errno != EAGAIN && errno != EWOULDBLOCK)
+        << "TrunksSocketService: Failed to accept";
+    return;
+  }
+  AddClient(std::move(fd));
+}
+
+void TrunksSocketService::ReadCommand(Client* client) {
+  int fd = client->fd.get();
+  std::string command(kMaxSocketMessageSize, 0);
+  ssize_t received = HANDLE_EINTR(
+      recv(fd, &command[0], command.size(), MSG_DONTWAIT | MSG_TRUNC));
+  if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+    return;
+  }
+  if (received <= 0) {
+    PLOG_IF(ERROR, received < 0) << "TrunksSocketService: Failed to receive";
+    RemoveClient(fd);
+    return;
+  }
+  if (received > static_cast<ssize_t>(command.size())) {
+    LOG(ERROR) << "TrunksSocketService: Command too large.";
+    SendResponse(fd, client->id, CreateErrorResponse(SAPI_RC_BAD_PARAMETER));
+    return;
+  }
+  command.resize(received);
+  if (!IsCompleteTpmMessage(command)) {
+    LOG(ERROR) << "TrunksSocketService: Invalid command.";
+    SendResponse(fd, client->id, CreateErrorResponse(SAPI_RC_BAD_PARAMETER));
+    return;
+  }
+  transceiver_->SendCommand(
+      command, base::Bind(&TrunksSocketService::SendResponse, GetWeakPtr(), fd,
+                          client->id));
+}
+
+void TrunksSocketService::SendResponse(int fd,
+                                       uint64_t id,
+                                       const std::string& response) {
+  auto iter = clients_.find(fd);
+  if (iter == clients_.end() || iter->second->id != id) {
+    VLOG(1) << "TrunksSocketService: Dropping response for a closed client.";
+    return;
+  }
+  // A client has at most TrunksSocketProxy::kMaxCommandsInFlight responses
+  // pending, so a full socket buffer means the client is misbehaving.
+  ssize_t sent = HANDLE_EINTR(send(fd, response.data(), response.size(),
+                                   MSG_DONTWAIT | MSG_NOSIGNAL));
+  if (sent != static_cast<ssize_t>(response.size())) {
+    PLOG(ERROR) << "TrunksSocketService: Failed to send response";
+    RemoveClient(fd);
+  }
+}
+
+void TrunksSocketService::RemoveClient(int fd) {
+  auto iter = clients_.find(fd);
+  if (iter == clients_.end()) {
+    return;
+  }
+  VLOG(1) << "TrunksSocketService: Client disconnected, pid "
+          << iter->second->credentials.pid;
+  clients_.erase(iter);
+}
+
+}  // namespace trunks
@@ -0,0 +1,113 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef TRUNKS_TRUNKS_SOCKET_SERVICE_H_
+#define TRUNKS_TRUNKS_SOCKET_SERVICE_H_
+
+#include <sys/socket.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <base/files/file_path.h>
+#include <base/files/scoped_file.h>
+#include <base/macros.h>
+#include <base/memory/weak_ptr.h>
+#include <base/message_loop/message_loop.h>
+
+#include "trunks/command_transceiver.h"
+
+namespace trunks {
+
+// TrunksSocketService accepts TPM commands on a SOCK_SEQPACKET Unix socket.
+// Every message on the socket is exactly one raw TPM command or response, so
+// the size field of the TPM header is the only framing. This avoids the
+// protobuf wrapping and broker hop of the D-Bus and Binder interfaces. The
+// peer credentials of each client are read with SO_PEERCRED when it connects.
+//
+// Commands from one client may be pipelined; responses are sent in the order
+// the transceiver produces them. All methods must be called on the thread that
+// runs the current MessageLoopForIO.
+//
+// Example Usage:
+//
+// TrunksSocketService socket_service;
+// socket_service.Listen(base::FilePath("/run/trunksd.sock"));
+// socket_service.set_transceiver(&my_transceiver);
+class TrunksSocketService : public base::MessageLoopForIO::Watcher {
+ public:
+  TrunksSocketService();
+  ~TrunksSocketService() override;
+
+  // The |transceiver| will be the target of all incoming TPM commands. This
+  // class does not take ownership of |transceiver|.
+  void set_transceiver(CommandTransceiver* transceiver) {
+    transceiver_ = transceiver;
+  }
+
+  // Creates a socket at |socket_path|, replacing any stale socket, and starts
+  // accepting clients. Returns true on success.
+  bool Listen(const base::FilePath& socket_path);
+
+  // Starts serving commands from |fd|, which must be one end of a connected
+  // SOCK_SEQPACKET Unix socket. Returns true on success.
+  bool AddClient(base::ScopedFD fd);
+
+  // base::MessageLoopForIO::Watcher methods.
+  void OnFileCanReadWithoutBlocking(int fd) override;
+  void OnFileCanWriteWithoutBlocking(int fd) override {}
+
+ private:
+  struct Client {
+    // Identifies the client across fd reuse.
+    uint64_t id;
+    base::ScopedFD fd;
+    struct ucred credentials;
+    base::MessageLoopForIO::FileDescriptorWatcher watcher;
+  };
+
+  // Accepts a pending connection on |listen_fd_|.
+  void AcceptClient();
+
+  // Reads one command from |client| and forwards it to |transceiver_|.
+  void ReadCommand(Client* client);
+
+  // Sends |response| to the client on |fd|, if it is still client |id|.
+  void SendResponse(int fd, uint64_t id, const std::string& response);
+
+  // Closes the connection to the client on |fd|.
+  void RemoveClient(int fd);
+
+  base::WeakPtr<TrunksSocketService> GetWeakPtr() {
+    return weak_factory_.GetWeakPtr();
+  }
+
+  CommandTransceiver* transceiver_ = nullptr;
+  base::ScopedFD listen_fd_;
+  base::MessageLoopForIO::FileDescriptorWatcher listen_watcher_;
+  // Clients keyed by file descriptor.
+  std::map<int, std::unique_ptr<Client>> clients_;
+  uint64_t next_client_id_ = 0;
+
+  // Declared last so weak pointers are invalidated first on destruction.
+  base::WeakPtrFactory<TrunksSocketService> weak_factory_{this};
+  DISALLOW_COPY_AND_ASSIGN(TrunksSocketService);
+};
+
+}  // namespace trunks
+
+#endif  // TRUNKS_TRUNKS_SOCKET_SERVICE_H_
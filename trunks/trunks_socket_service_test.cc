@@ -0,0 +1,232 @@
+//
+// Copyright (C) 2016 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "trunks/trunks_socket_service.h"
+
+#include <sys/socket.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <base/bind.h>
+#include <base/files/scoped_temp_dir.h>
+#include <base/synchronization/waitable_event.h>
+#include <base/threading/thread.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "trunks/error_codes.h"
+#include "trunks/mock_command_transceiver.h"
+#include "trunks/trunks_socket_proxy.h"
+
+using testing::_;
+using testing::InSequence;
+using testing::Invoke;
+using testing::StrictMock;
+using testing::WithArgs;
+
+namespace {
+
+// A hand-rolled TPM2_Startup command.
+const char kStartupCommand[] =
+    "\x80\x01"          // tag=TPM_ST_NO_SESSIONS
+    "\x00\x00\x00\x0C"  // size=12
+    "\x00\x00\x01\x44"  // code=TPM_CC_Startup
+    "\x00\x00";         // param=TPM_SU_CLEAR
+
+void Assign(std::string* to, const std::string& from) {
+  *to = from;
+}
+
+void RunAndSignal(const base::Closure& task, base::WaitableEvent* event) {
+  task.Run();
+  event->Signal();
+}
+
+}  // namespace
+
+namespace trunks {
+
+// The service runs on its own IO thread so the blocking proxy can be used from
+// the test thread.
+class TrunksSocketServiceTest : public testing::Test {
+ public:
+  TrunksSocketServiceTest()
+      : command_(kStartupCommand, sizeof(kStartupCommand) - 1),
+        response_(CreateErrorResponse(TPM_RC_SUCCESS)),
+        service_thread_("socket_service") {}
+  ~TrunksSocketServiceTest() override {}
+
+  void SetUp() override {
+    ASSERT_TRUE(service_thread_.StartWithOptions(
+        base::Thread::Options(base::MessageLoop::TYPE_IO, 0)));
+    RunOnServiceThread(base::Bind(&TrunksSocketServiceTest::CreateService,
+                                  base::Unretained(this)));
+  }
+
+  void TearDown() override {
+    RunOnServiceThread(base::Bind(&TrunksSocketServiceTest::DestroyService,
+                                  base::Unretained(this)));
+    service_thread_.Stop();
+  }
+
+ protected:
+  void RunOnServiceThread(const base::Closure& task) {
+    base::WaitableEvent done(base::WaitableEvent::ResetPolicy::MANUAL,
+                             base::WaitableEvent::InitialState::NOT_SIGNALED);
+    service_thread_.task_runner()->PostTask(
+        FROM_HERE, base::Bind(&RunAndSignal, task, &done));
+    done.Wait();
+  }
+
+  void CreateService() {
+    service_.reset(new TrunksSocketService());
+    service_->set_transceiver(&transceiver_);
+  }
+
+  void DestroyService() { service_.reset(); }
+
+  void Listen(const base::FilePath& path, bool* result) {
+    *result = service_->Listen(path);
+  }
+
+  void AddClient(int fd, bool* result) {
+    *result = service_->AddClient(base::ScopedFD(fd));
+  }
+
+  // Returns a proxy connected to |service_| through a socket pair.
+  std::unique_ptr<TrunksSocketProxy> CreateConnectedProxy() {
+    int fds[2];
+    CHECK_EQ(0, socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds));
+    bool result = false;
+    RunOnServiceThread(base::Bind(&TrunksSocketServiceTest::AddClient,
+                                  base::Unretained(this), fds[0], &result));
+    EXPECT_TRUE(result);
+    std::unique_ptr<TrunksSocketProxy> proxy(
+        new TrunksSocketProxy(base::ScopedFD(fds[1])));
+    EXPECT_TRUE(proxy->Init());
+    return proxy;
+  }
+
+  void ExpectCommand(const std::string& command, const std::string& response) {
+    EXPECT_CALL(transceiver_, SendCommand(command, _))
+        .WillOnce(WithArgs<1>(Invoke(
+            [response](const CommandTransceiver::ResponseCallback& callback) {
+              callback.Run(response);
+            })));
+  }
+
+  std::string command_;
+  std::string response_;
+  StrictMock<MockCommandTransceiver> transceiver_;
+  base::Thread service_thread_;
+  std::unique_ptr<TrunksSocketService> service_;
+};
+
+TEST_F(TrunksSocketServiceTest, SendCommandAndWait) {
+  std::unique_ptr<TrunksSocketProxy> proxy = CreateConnectedProxy();
+  ExpectCommand(command_, response_);
+  EXPECT_EQ(response_, proxy->SendCommandAndWait(command_));
+}
+
+TEST_F(TrunksSocketServiceTest, SendCommand) {
+  std::unique_ptr<TrunksSocketProxy> proxy = CreateConnectedProxy();
+  ExpectCommand(command_, response_);
+  std::string output;
+  proxy->SendCommand(command_, base::Bind(Assign, &output));
+  EXPECT_EQ(response_, output);
+}
+
+TEST_F(TrunksSocketServiceTest, MultipleClients) {
+  std::unique_ptr<TrunksSocketProxy> proxy1 = CreateConnectedProxy();
+  std::unique_ptr<TrunksSocketProxy> proxy2 = CreateConnectedProxy();
+  std::string response2 = CreateErrorResponse(TPM_RC_FAILURE);
+  ExpectCommand(command_, response_);
+  EXPECT_EQ(response_, proxy1->SendCommandAndWait(command_));
+  ExpectCommand(command_, response2);
+  EXPECT_EQ(response2, proxy2->SendCommandAndWait(command_));
+}
+
+TEST_F(TrunksSocketServiceTest, SendCommandsAndWait) {
+  std::unique_ptr<TrunksSocketProxy> proxy = CreateConnectedProxy();
+  // More commands than the proxy keeps in flight, each with its own response.
+  std::vector<std::string> commands;
+  std::vector<std::string> responses;
+  InSequence sequence;
+  for (size_t i = 0; i < 2 * TrunksSocketProxy::kMaxCommandsInFlight + 1;
+       ++i) {
+    commands.push_back(command_);
+    responses.push_back(CreateErrorResponse(TPM_RC_FAILURE + i));
+    ExpectCommand(command_, responses.back());
+  }
+  EXPECT_EQ(responses, proxy->SendCommandsAndWait(commands));
+}
+
+TEST_F(TrunksSocketServiceTest, InvalidCommand) {
+  std::unique_ptr<TrunksSocketProxy> proxy = CreateConnectedProxy();
+  // The size field does not match, so |transceiver_| is never called.
+  std::string command = command_ + "extra";
+  EXPECT_EQ(CreateErrorResponse(SAPI_RC_BAD_PARAMETER),
+            proxy->SendCommandAndWait(command));
+  // The connection is still usable.
+  ExpectCommand(command_, response_);
+  EXPECT_EQ(response_, proxy->SendCommandAndWait(command_));
+}
+
+TEST_F(TrunksSocketServiceTest, ServiceGone) {
+  std::unique_ptr<TrunksSocketProxy> proxy = CreateConnectedProxy();
+  RunOnServiceThread(base::Bind(&TrunksSocketServiceTest::DestroyService,
+                                base::Unretained(this)));
+  EXPECT_EQ(CreateErrorResponse(TRUNKS_RC_IPC_ERROR),
+            proxy->SendCommandAndWait(command_));
+  // Later commands fail without touching the socket.
+  EXPECT_EQ(CreateErrorResponse(TRUNKS_RC_IPC_ERROR),
+            proxy->SendCommandAndWait(command_));
+}
+
+TEST_F(TrunksSocketServiceTest, Listen) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath path = temp_dir.path().Append("trunksd.sock");
+  bool result = false;
+  RunOnServiceThread(base::Bind(&TrunksSocketServiceTest::Listen,
+                                base::Unretained(this), path, &result));
+  ASSERT_TRUE(result);
+  TrunksSocketProxy proxy(path);
+  ASSERT_TRUE(proxy.Init());
+  ExpectCommand(command_, response_);
+  EXPECT_EQ(response_, proxy.SendCommandAndWait(command_));
+}
+
+TEST_F(TrunksSocketServiceTest, ProxyNotConnected) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  TrunksSocketProxy proxy(temp_dir.path().Append("missing.sock"));
+  EXPECT_FALSE(proxy.Init());
+  EXPECT_EQ(CreateErrorResponse(TRUNKS_RC_IPC_ERROR),
+            proxy.SendCommandAndWait(command_));
+}
+
+TEST(TrunksSocketProxyTest, IsCompleteTpmMessage) {
+  EXPECT_TRUE(IsCompleteTpmMessage(CreateErrorResponse(TPM_RC_SUCCESS)));
+  EXPECT_FALSE(IsCompleteTpmMessage(""));
+  EXPECT_FALSE(IsCompleteTpmMessage(std::string("\x80\x01\x00\x00\x00", 5)));
+  EXPECT_FALSE(
+      IsCompleteTpmMessage(CreateErrorResponse(TPM_RC_SUCCESS) + "extra"));
+}
+
+}  // namespace trunks
@@ -16,6 +16,8 @@
 
 #include <sysexits.h>
 
+#include <memory>
+
 #include <base/at_exit.h>
 #include <base/bind.h>
 #include <base/command_line.h>
@@ -35,6 +37,7 @@
 #endif
 #include "trunks/trunks_factory_impl.h"
 #include "trunks/trunks_ftdi_spi.h"
+#include "trunks/trunks_socket_service.h"
 
 namespace {
 
@@ -87,7 +90,7 @@ int main(int argc, char** argv) {
 #endif
 
   // Chain together command transceivers:
-  //   [IPC] --> BackgroundCommandTransceiver
+  //   [IPC or socket] --> BackgroundCommandTransceiver
   //         --> ResourceManager
   //         --> TpmHandle
   //         --> [TPM]
@@ -103,6 +106,15 @@ int main(int argc, char** argv) {
   }
   CHECK(low_level_transceiver->Init())
       << "Error initializing TPM communication.";
+  // Raw commands may also be accepted on a Unix socket, which bypasses the
+  // protobuf wrapping of the IPC service. The socket is created before
+  // dropping privileges so a stale socket can be replaced.
+  std::unique_ptr<trunks::TrunksSocketService> socket_service;
+  if (cl->HasSwitch("socket")) {
+    socket_service.reset(new trunks::TrunksSocketService());
+    CHECK(socket_service->Listen(cl->GetSwitchValuePath("socket")))
+        << "Error listening on socket.";
+  }
   // This needs to be *after* opening the TPM handle and *before* starting the
   // background thread.
   InitMinijailSandbox();
@@ -111,12 +123,26 @@ int main(int argc, char** argv) {
   trunks::TrunksFactoryImpl factory(low_level_transceiver);
   CHECK(factory.Initialize()) << "Failed to initialize trunks factory.";
   trunks::ResourceManager resource_manager(factory, low_level_transceiver);
+  if (cl->HasSwitch("checkpoint_file")) {
+    resource_manager.set_checkpoint_file(
+        cl->GetSwitchValuePath("checkpoint_file"));
+  }
   background_thread.task_runner()->PostNonNestableTask(
       FROM_HERE, base::Bind(&trunks::ResourceManager::Initialize,
                             base::Unretained(&resource_manager)));
   trunks::BackgroundCommandTransceiver background_transceiver(
       &resource_manager, background_thread.task_runner());
   service.set_transceiver(&background_transceiver);
+  if (socket_service) {
+    socket_service->set_transceiver(&background_transceiver);
+  }
   LOG(INFO) << "Trunks service started.";
-  return service.Run();
+  int exit_code = service.Run();
+  // Save loaded contexts so a restarted trunksd can pick up where this one
+  // left off. Stopping the thread waits for the checkpoint to be written.
+  background_thread.task_runner()->PostNonNestableTask(
+      FROM_HERE, base::Bind(&trunks::ResourceManager::Checkpoint,
+                            base::Unretained(&resource_manager)));
+  background_thread.Stop();
+  return exit_code;
 }